@@ -0,0 +1,194 @@
+/*!
+    \file  main.c
+    \brief main routine of the dual ADC stream benchmark
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include "systick.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_adc_stream.h"
+#include "n200_timer.h"
+
+#define FRAME_SAMPLES       512U
+#define MEASURE_MS          1000U
+
+static const uint8_t adc0_channels[4] = {ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_2, ADC_CHANNEL_3};
+static const uint8_t adc1_channels[4] = {ADC_CHANNEL_4, ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_7};
+/* two frames, filled with 32-bit DMA words in the sync modes */
+static uint32_t adc_buffer[FRAME_SAMPLES];
+adc_stream_struct adc_stream;
+volatile uint32_t adc_mean;
+
+void rcu_config(void);
+void gpio_config(void);
+void eclic_config(void);
+void adc_frame_process(adc_stream_struct *stream, const uint16_t *frame, uint32_t scans);
+uint32_t adc_stream_measure(const char *name, uint32_t mode, uint32_t channel_num);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    /* system clocks configuration */
+    rcu_config();
+    /* GPIO configuration */
+    gpio_config();
+    /* eclic configuration */
+    eclic_config();
+    /* configure COM port */
+    gd_eval_com_init(EVAL_COM0);
+
+    while(1){
+        /* one ADC on PA0, the pair on PA0 in turn, the pair scanning PA0..PA3 and PA4..PA7 */
+        adc_stream_measure("ADC0 alone", ADC_MODE_FREE, 1U);
+        adc_stream_measure("follow-up fast", ADC_DAUL_REGULAL_FOLLOWUP_FAST, 1U);
+        adc_stream_measure("regular parallel", ADC_DAUL_REGULAL_PARALLEL, 4U);
+        printf("\r\n ***********************************\r\n");
+        delay_1ms(1000);
+    }
+}
+
+/*!
+    \brief      run the ADC stream back to back in one mode and print the
+                effective sample rate
+    \param[in]  name: name of the mode in the report
+    \param[in]  mode: ADC_MODE_FREE or ADC_DAUL_REGULAL_xxx
+    \param[in]  channel_num: channels per ADC
+    \param[out] none
+    \retval     samples per second
+*/
+uint32_t adc_stream_measure(const char *name, uint32_t mode, uint32_t channel_num)
+{
+    adc_stream_parameter_struct adc_stream_para;
+    uint32_t scan_size = (ADC_MODE_FREE == mode) ? channel_num : (2U * channel_num);
+    uint64_t start, elapsed, samples;
+    uint32_t frames, rate;
+
+    adc_stream_para.adc_periph  = ADC0;
+    adc_stream_para.mode        = mode;
+    adc_stream_para.channels    = adc0_channels;
+    adc_stream_para.channels1   = adc1_channels;
+    adc_stream_para.channel_num = channel_num;
+    adc_stream_para.sample_time = ADC_SAMPLETIME_1POINT5;
+    adc_stream_para.trigger     = ADC0_1_EXTTRIG_REGULAR_NONE;
+    adc_stream_para.buffer      = (uint16_t *)adc_buffer;
+    adc_stream_para.scans       = FRAME_SAMPLES / scan_size;
+    adc_stream_para.callback    = adc_frame_process;
+    adc_stream_para.user_data   = NULL;
+    if(ERROR == adc_stream_init(&adc_stream, &adc_stream_para)){
+        printf("\r\n %s: configuration error \r\n", name);
+        return 0U;
+    }
+
+    adc_stream_start(&adc_stream);
+    start = get_timer_value();
+    delay_1ms(MEASURE_MS);
+    frames = adc_stream.frames;
+    elapsed = get_timer_value() - start;
+    adc_stream_stop(&adc_stream);
+
+    samples = (uint64_t)frames * FRAME_SAMPLES;
+    rate = (uint32_t)((samples * TIMER_FREQ) / elapsed);
+    printf("\r\n %s: %u samples/s, %u overruns \r\n", name, (unsigned)rate, (unsigned)adc_stream.overrun);
+
+    return rate;
+}
+
+/*!
+    \brief      average a frame, standing for the processing of the samples
+    \param[in]  stream: ADC stream the frame belongs to
+    \param[in]  frame: scans sets of interleaved samples
+    \param[in]  scans: number of scans in the frame
+    \param[out] none
+    \retval     none
+*/
+void adc_frame_process(adc_stream_struct *stream, const uint16_t *frame, uint32_t scans)
+{
+    uint32_t count = scans * stream->scan_size;
+    uint32_t sum = 0U;
+    uint32_t i;
+
+    for(i = 0U; i < count; i++){
+        sum += frame[i];
+    }
+    adc_mean = sum / count;
+}
+
+/*!
+    \brief      configure the different system clocks
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void rcu_config(void)
+{
+    /* enable GPIOA clock */
+    rcu_periph_clock_enable(RCU_GPIOA);
+    /* enable ADC0 and ADC1 clock */
+    rcu_periph_clock_enable(RCU_ADC0);
+    rcu_periph_clock_enable(RCU_ADC1);
+    /* enable DMA0 clock */
+    rcu_periph_clock_enable(RCU_DMA0);
+    /* config ADC clock, 13.5MHz at most */
+    rcu_adc_clock_config(RCU_CKADC_CKAPB2_DIV8);
+}
+
+/*!
+    \brief      configure the GPIO peripheral
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gpio_config(void)
+{
+    /* config the GPIO as analog mode */
+    gpio_init(GPIOA, GPIO_MODE_AIN, GPIO_OSPEED_50MHZ, GPIO_PIN_0|GPIO_PIN_1|GPIO_PIN_2|GPIO_PIN_3|
+                                                       GPIO_PIN_4|GPIO_PIN_5|GPIO_PIN_6|GPIO_PIN_7);
+}
+
+/**
+    \brief      configure the nested vectored interrupt controller
+    \param[in]  none
+    \param[out] none
+    \retval     none
+  */
+void eclic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_irq_enable(DMA0_Channel0_IRQn, 2, 0);
+}
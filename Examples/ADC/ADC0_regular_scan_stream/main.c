@@ -0,0 +1,228 @@
+/*!
+    \file  main.c
+    \brief main routine of the ADC0 regular scan stream
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include "systick.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_adc_stream.h"
+
+#define CHANNEL_NUM         8U
+#define SCANS               16U
+
+static const uint8_t adc_channels[CHANNEL_NUM] = {
+    ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_2, ADC_CHANNEL_3,
+    ADC_CHANNEL_4, ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_7
+};
+static uint16_t adc_buffer[2U * SCANS * CHANNEL_NUM];
+adc_stream_struct adc_stream;
+volatile uint16_t adc_average[CHANNEL_NUM];
+
+void rcu_config(void);
+void gpio_config(void);
+void eclic_config(void);
+void timer_config(void);
+void adc_config(void);
+void adc_frame_process(adc_stream_struct *stream, const uint16_t *frame, uint32_t scans);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    uint32_t i;
+
+    /* system clocks configuration */
+    rcu_config();
+    /* GPIO configuration */
+    gpio_config();
+    /* eclic configuration */
+    eclic_config();
+    /* TIMER configuration */
+    timer_config();
+    /* ADC stream configuration */
+    adc_config();
+    /* configure COM port */
+    gd_eval_com_init(EVAL_COM0);
+
+    /* start the stream, then the timer that triggers the scans */
+    adc_stream_start(&adc_stream);
+    timer_enable(TIMER1);
+
+    while(1){
+        delay_1ms(1000);
+        for(i = 0U; i < CHANNEL_NUM; i++){
+            printf("\r\n ADC0 channel %d average = %d \r\n", (int)i, adc_average[i]);
+        }
+        printf("\r\n frames = %d, overruns = %d \r\n", (int)adc_stream.frames, (int)adc_stream.overrun);
+        printf("\r\n ***********************************\r\n");
+    }
+}
+
+/*!
+    \brief      average the samples of every channel in a frame
+    \param[in]  stream: ADC stream the frame belongs to
+    \param[in]  frame: scans sets of interleaved samples
+    \param[in]  scans: number of scans in the frame
+    \param[out] none
+    \retval     none
+*/
+void adc_frame_process(adc_stream_struct *stream, const uint16_t *frame, uint32_t scans)
+{
+    uint16_t samples[SCANS];
+    uint32_t sum, i, j;
+
+    for(i = 0U; i < CHANNEL_NUM; i++){
+        adc_stream_channel_get(stream, frame, i, samples);
+        sum = 0U;
+        for(j = 0U; j < scans; j++){
+            sum += samples[j];
+        }
+        adc_average[i] = (uint16_t)(sum / scans);
+    }
+}
+
+/*!
+    \brief      configure the different system clocks
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void rcu_config(void)
+{
+    /* enable GPIOA clock */
+    rcu_periph_clock_enable(RCU_GPIOA);
+    /* enable ADC0 clock */
+    rcu_periph_clock_enable(RCU_ADC0);
+    /* enable DMA0 clock */
+    rcu_periph_clock_enable(RCU_DMA0);
+    /* enable timer1 clock */
+    rcu_periph_clock_enable(RCU_TIMER1);
+    /* config ADC clock */
+    rcu_adc_clock_config(RCU_CKADC_CKAPB2_DIV8);
+}
+
+/*!
+    \brief      configure the GPIO peripheral
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gpio_config(void)
+{
+    /* config the GPIO as analog mode */
+    gpio_init(GPIOA, GPIO_MODE_AIN, GPIO_OSPEED_50MHZ, GPIO_PIN_0|GPIO_PIN_1|GPIO_PIN_2|GPIO_PIN_3|
+                                                       GPIO_PIN_4|GPIO_PIN_5|GPIO_PIN_6|GPIO_PIN_7);
+}
+
+/*!
+    \brief      configure the TIMER peripheral, a compare event every 50us
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void timer_config(void)
+{
+    timer_oc_parameter_struct timer_ocintpara;
+    timer_parameter_struct timer_initpara;
+
+    /* deinit a timer */
+    timer_deinit(TIMER1);
+    /* initialize TIMER init parameter struct */
+    timer_struct_para_init(&timer_initpara);
+    /* TIMER1 configuration, 1MHz counter clock and 20kHz update rate */
+    timer_initpara.prescaler         = 107;
+    timer_initpara.alignedmode       = TIMER_COUNTER_EDGE;
+    timer_initpara.counterdirection  = TIMER_COUNTER_UP;
+    timer_initpara.period            = 49;
+    timer_initpara.clockdivision     = TIMER_CKDIV_DIV1;
+    timer_initpara.repetitioncounter = 0;
+    timer_init(TIMER1, &timer_initpara);
+
+    /* CH1 configuration in PWM mode1 */
+    timer_channel_output_struct_para_init(&timer_ocintpara);
+    timer_ocintpara.ocpolarity  = TIMER_OC_POLARITY_HIGH;
+    timer_ocintpara.outputstate = TIMER_CCX_ENABLE;
+    timer_channel_output_config(TIMER1, TIMER_CH_1, &timer_ocintpara);
+
+    timer_channel_output_pulse_value_config(TIMER1, TIMER_CH_1, 25);
+    timer_channel_output_mode_config(TIMER1, TIMER_CH_1, TIMER_OC_MODE_PWM1);
+    timer_channel_output_shadow_config(TIMER1, TIMER_CH_1, TIMER_OC_SHADOW_DISABLE);
+}
+
+/*!
+    \brief      configure the ADC stream
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void adc_config(void)
+{
+    adc_stream_parameter_struct adc_stream_para;
+
+    /* reset ADC */
+    adc_deinit(ADC0);
+    /* eight channels scanned on each TIMER1 CH1 compare event */
+    adc_stream_para.adc_periph  = ADC0;
+    adc_stream_para.mode        = ADC_MODE_FREE;
+    adc_stream_para.channels    = adc_channels;
+    adc_stream_para.channels1   = NULL;
+    adc_stream_para.channel_num = CHANNEL_NUM;
+    adc_stream_para.sample_time = ADC_SAMPLETIME_55POINT5;
+    adc_stream_para.trigger     = ADC0_1_EXTTRIG_REGULAR_T1_CH1;
+    adc_stream_para.buffer      = adc_buffer;
+    adc_stream_para.scans       = SCANS;
+    adc_stream_para.callback    = adc_frame_process;
+    adc_stream_para.user_data   = NULL;
+    if(ERROR == adc_stream_init(&adc_stream, &adc_stream_para)){
+        while(1){
+        }
+    }
+}
+
+/**
+    \brief      configure the nested vectored interrupt controller
+    \param[in]  none
+    \param[out] none
+    \retval     none
+  */
+void eclic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_irq_enable(DMA0_Channel0_IRQn, 2, 0);
+}
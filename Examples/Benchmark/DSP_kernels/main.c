@@ -0,0 +1,255 @@
+/*!
+    \file  main.c
+    \brief DSP kernel benchmark demo
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_bench.h"
+#include "gd32vf103_dsp.h"
+
+#define BENCH_RUNS              50U                         /* samples taken per region */
+#define BENCH_BLOCK             256U                        /* samples per block */
+#define BENCH_FIR_TAPS          32U                         /* taps of the FIR filters */
+#define BENCH_BIQUAD_STAGES     4U                          /* sections of the biquad cascades */
+
+/* timing regions, in report order */
+typedef enum
+{
+    REGION_FIR_Q15 = 0,
+    REGION_FIR_Q31,
+    REGION_BIQUAD_Q15,
+    REGION_BIQUAD_Q31,
+    REGION_MOVING_AVERAGE,
+    REGION_CIC,
+    REGION_RMS,
+    REGION_FFT,
+    REGION_COUNT
+}region_enum;
+
+bench_region_struct region[REGION_COUNT];
+/* copy of the report, readable with a debugger */
+char bench_result[1024];
+
+q15_t in15[BENCH_BLOCK], out15[BENCH_BLOCK];
+q31_t in31[BENCH_BLOCK], out31[BENCH_BLOCK];
+q15_t fir15_coeffs[BENCH_FIR_TAPS], fir15_state[2U * BENCH_FIR_TAPS];
+q31_t fir31_coeffs[BENCH_FIR_TAPS], fir31_state[2U * BENCH_FIR_TAPS];
+q15_t biquad15_coeffs[BENCH_BIQUAD_STAGES * DSP_BIQUAD_COEFF_NUM], biquad15_state[BENCH_BIQUAD_STAGES * DSP_BIQUAD_STATE_NUM];
+q31_t biquad31_coeffs[BENCH_BIQUAD_STAGES * DSP_BIQUAD_COEFF_NUM], biquad31_state[BENCH_BIQUAD_STAGES * DSP_BIQUAD_STATE_NUM];
+q15_t average_window[16];
+q15_t fft_data[2U * BENCH_BLOCK];
+
+/* fill the inputs and the coefficients */
+void bench_data_init(void);
+/* time the FIR filters */
+void bench_fir(void);
+/* time the biquad cascades */
+void bench_biquad(void);
+/* time the moving average and the CIC decimator */
+void bench_decimation(void);
+/* time the RMS and the FFT */
+void bench_analysis(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    bench_sink_struct sink;
+
+    gd_eval_com_init(EVAL_COM0);
+
+    /* measure the cost of an empty region before anything else */
+    bench_init();
+    bench_region_init(&region[REGION_FIR_Q15], "fir_q15");
+    bench_region_init(&region[REGION_FIR_Q31], "fir_q31");
+    bench_region_init(&region[REGION_BIQUAD_Q15], "biquad_q15");
+    bench_region_init(&region[REGION_BIQUAD_Q31], "biquad_q31");
+    bench_region_init(&region[REGION_MOVING_AVERAGE], "moving_avg_q15");
+    bench_region_init(&region[REGION_CIC], "cic_q15");
+    bench_region_init(&region[REGION_RMS], "rms_q15");
+    bench_region_init(&region[REGION_FFT], "fft_q15");
+
+    bench_data_init();
+    bench_fir();
+    bench_biquad();
+    bench_decimation();
+    bench_analysis();
+
+    /* print the table on the COM port and keep a copy in RAM */
+    bench_sink_usart_init(&sink, EVAL_COM0);
+    bench_report(&sink, region, REGION_COUNT);
+    bench_sink_buffer_init(&sink, bench_result, sizeof(bench_result));
+    bench_report(&sink, region, REGION_COUNT);
+
+    while(1){
+    }
+}
+
+/*!
+    \brief      fill the inputs with noise and the coefficients with a smoothing
+                filter; the values do not change the timing of the kernels
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_data_init(void)
+{
+    uint32_t seed = 12345U;
+    uint32_t i;
+
+    for(i = 0U; i < BENCH_BLOCK; i++){
+        seed = (seed * 1103515245U) + 12345U;
+        in31[i] = (q31_t)seed >> 1;
+        in15[i] = (q15_t)(in31[i] >> 16);
+    }
+    for(i = 0U; i < BENCH_FIR_TAPS; i++){
+        fir15_coeffs[i] = (q15_t)(32768U / BENCH_FIR_TAPS);
+        fir31_coeffs[i] = (q31_t)(0x80000000U / BENCH_FIR_TAPS);
+    }
+    /* b0 = 0.25, b1 = 0.5, b2 = 0.25, a1 = -0.5, a2 = 0.25 with one headroom bit */
+    for(i = 0U; i < BENCH_BIQUAD_STAGES; i++){
+        biquad15_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 0U] = 4096;
+        biquad15_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 1U] = 8192;
+        biquad15_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 2U] = 4096;
+        biquad15_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 3U] = -8192;
+        biquad15_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 4U] = 4096;
+        biquad31_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 0U] = 0x10000000;
+        biquad31_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 1U] = 0x20000000;
+        biquad31_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 2U] = 0x10000000;
+        biquad31_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 3U] = -0x20000000;
+        biquad31_coeffs[(DSP_BIQUAD_COEFF_NUM * i) + 4U] = 0x10000000;
+    }
+}
+
+/*!
+    \brief      time the FIR filters on a block
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_fir(void)
+{
+    dsp_fir_q15_struct fir15;
+    dsp_fir_q31_struct fir31;
+    uint32_t i;
+
+    dsp_fir_q15_init(&fir15, fir15_coeffs, fir15_state, BENCH_FIR_TAPS);
+    dsp_fir_q31_init(&fir31, fir31_coeffs, fir31_state, BENCH_FIR_TAPS);
+    for(i = 0U; i < BENCH_RUNS; i++){
+        bench_region_start(&region[REGION_FIR_Q15]);
+        dsp_fir_q15(&fir15, in15, out15, BENCH_BLOCK);
+        bench_region_stop(&region[REGION_FIR_Q15]);
+        bench_region_start(&region[REGION_FIR_Q31]);
+        dsp_fir_q31(&fir31, in31, out31, BENCH_BLOCK);
+        bench_region_stop(&region[REGION_FIR_Q31]);
+    }
+}
+
+/*!
+    \brief      time the biquad cascades on a block
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_biquad(void)
+{
+    dsp_biquad_q15_struct biquad15;
+    dsp_biquad_q31_struct biquad31;
+    uint32_t i;
+
+    dsp_biquad_q15_init(&biquad15, biquad15_coeffs, biquad15_state, BENCH_BIQUAD_STAGES, 1U);
+    dsp_biquad_q31_init(&biquad31, biquad31_coeffs, biquad31_state, BENCH_BIQUAD_STAGES, 1U);
+    for(i = 0U; i < BENCH_RUNS; i++){
+        bench_region_start(&region[REGION_BIQUAD_Q15]);
+        dsp_biquad_q15(&biquad15, in15, out15, BENCH_BLOCK);
+        bench_region_stop(&region[REGION_BIQUAD_Q15]);
+        bench_region_start(&region[REGION_BIQUAD_Q31]);
+        dsp_biquad_q31(&biquad31, in31, out31, BENCH_BLOCK);
+        bench_region_stop(&region[REGION_BIQUAD_Q31]);
+    }
+}
+
+/*!
+    \brief      time the moving average over 16 samples and a third order CIC
+                decimating by 8 on a block
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_decimation(void)
+{
+    dsp_moving_average_q15_struct average;
+    dsp_cic_q15_struct cic;
+    uint32_t i;
+
+    dsp_moving_average_q15_init(&average, average_window, 16U);
+    dsp_cic_q15_init(&cic, 3U, 8U);
+    for(i = 0U; i < BENCH_RUNS; i++){
+        bench_region_start(&region[REGION_MOVING_AVERAGE]);
+        dsp_moving_average_q15(&average, in15, out15, BENCH_BLOCK);
+        bench_region_stop(&region[REGION_MOVING_AVERAGE]);
+        bench_region_start(&region[REGION_CIC]);
+        (void)dsp_cic_q15(&cic, in15, out15, BENCH_BLOCK);
+        bench_region_stop(&region[REGION_CIC]);
+    }
+}
+
+/*!
+    \brief      time the RMS of a block and a FFT of as many points
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_analysis(void)
+{
+    uint32_t i, j;
+
+    for(i = 0U; i < BENCH_RUNS; i++){
+        bench_region_start(&region[REGION_RMS]);
+        out15[0] = dsp_rms_q15(in15, BENCH_BLOCK);
+        bench_region_stop(&region[REGION_RMS]);
+
+        for(j = 0U; j < BENCH_BLOCK; j++){
+            fft_data[2U * j] = in15[j];
+            fft_data[(2U * j) + 1U] = 0;
+        }
+        bench_region_start(&region[REGION_FFT]);
+        (void)dsp_fft_q15(fft_data, BENCH_BLOCK);
+        bench_region_stop(&region[REGION_FFT]);
+    }
+}
@@ -0,0 +1,199 @@
+/*!
+    \file  main.c
+    \brief driver hot path benchmark demo
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_bench.h"
+#include "drv_usb_core.h"
+
+#define BENCH_RUNS              100U                        /* samples taken per region */
+#define BENCH_CRC_WORDS         256U                        /* words per CRC block */
+#define BENCH_USB_PACKET        64U                         /* bytes per USB packet */
+#define BENCH_FLASH_PAGE        ((uint32_t)0x0801FC00U)     /* last 1KB page of the flash, erased by the demo */
+
+/* timing regions, in report order */
+typedef enum
+{
+    REGION_USB_TXFIFO = 0,
+    REGION_CRC_BLOCK,
+    REGION_GPIO_INIT,
+    REGION_FMC_WORD,
+    REGION_COUNT
+}region_enum;
+
+bench_region_struct region[REGION_COUNT];
+/* copy of the report, readable with a debugger */
+char bench_result[1024];
+
+uint32_t crc_data[BENCH_CRC_WORDS];
+uint8_t usb_packet[BENCH_USB_PACKET];
+usb_core_basic usb_basic;
+usb_core_regs usb_regs;
+
+/* time usb_txfifo_write with a full speed bulk packet */
+void bench_usb_txfifo(void);
+/* time crc_block_data_calculate with a block of words */
+void bench_crc_block(void);
+/* time gpio_init for one pin */
+void bench_gpio_init(void);
+/* time fmc_word_program in an erased page */
+void bench_fmc_word(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    bench_sink_struct sink;
+
+    gd_eval_com_init(EVAL_COM0);
+
+    /* measure the cost of an empty region before anything else */
+    bench_init();
+    bench_region_init(&region[REGION_USB_TXFIFO], "usb_txfifo_write");
+    bench_region_init(&region[REGION_CRC_BLOCK], "crc_block");
+    bench_region_init(&region[REGION_GPIO_INIT], "gpio_init");
+    bench_region_init(&region[REGION_FMC_WORD], "fmc_word_program");
+
+    bench_usb_txfifo();
+    bench_crc_block();
+    bench_gpio_init();
+    bench_fmc_word();
+
+    /* print the table on the COM port and keep a copy in RAM */
+    bench_sink_usart_init(&sink, EVAL_COM0);
+    bench_report(&sink, region, REGION_COUNT);
+    bench_sink_buffer_init(&sink, bench_result, sizeof(bench_result));
+    bench_report(&sink, region, REGION_COUNT);
+
+    while(1){
+    }
+}
+
+/*!
+    \brief      time usb_txfifo_write with a full speed bulk packet
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_usb_txfifo(void)
+{
+    uint32_t i;
+
+    /* the FIFO is written over the AHB, the USB clock only has to run */
+    rcu_usb_clock_config(RCU_CKUSB_CKPLL_DIV2_5);
+    rcu_periph_clock_enable(RCU_USBFS);
+    usb_basic_init(&usb_basic, &usb_regs, USB_CORE_ENUM_FS);
+
+    for(i = 0U; i < BENCH_USB_PACKET; i++){
+        usb_packet[i] = (uint8_t)i;
+    }
+    for(i = 0U; i < BENCH_RUNS; i++){
+        bench_region_start(&region[REGION_USB_TXFIFO]);
+        usb_txfifo_write(&usb_regs, usb_packet, 1U, BENCH_USB_PACKET);
+        bench_region_stop(&region[REGION_USB_TXFIFO]);
+        usb_txfifo_flush(&usb_regs, 1U);
+    }
+}
+
+/*!
+    \brief      time crc_block_data_calculate with a block of words
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_crc_block(void)
+{
+    uint32_t i;
+
+    rcu_periph_clock_enable(RCU_CRC);
+    for(i = 0U; i < BENCH_CRC_WORDS; i++){
+        crc_data[i] = i * 0x9E3779B9U;
+    }
+    for(i = 0U; i < BENCH_RUNS; i++){
+        crc_data_register_reset();
+        bench_region_start(&region[REGION_CRC_BLOCK]);
+        crc_block_data_calculate(crc_data, BENCH_CRC_WORDS);
+        bench_region_stop(&region[REGION_CRC_BLOCK]);
+    }
+}
+
+/*!
+    \brief      time gpio_init for one pin
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_gpio_init(void)
+{
+    uint32_t i;
+
+    /* alternate between the LED3 and LED4 pins, nothing else is wired to them */
+    rcu_periph_clock_enable(LED3_GPIO_CLK);
+    for(i = 0U; i < BENCH_RUNS; i++){
+        bench_region_start(&region[REGION_GPIO_INIT]);
+        gpio_init(LED3_GPIO_PORT, GPIO_MODE_OUT_PP, GPIO_OSPEED_50MHZ, (0U == (i & 1U)) ? LED3_PIN : LED4_PIN);
+        bench_region_stop(&region[REGION_GPIO_INIT]);
+    }
+}
+
+/*!
+    \brief      time fmc_word_program in an erased page
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_fmc_word(void)
+{
+    uint32_t i;
+
+    fmc_unlock();
+    fmc_flag_clear(FMC_FLAG_END);
+    fmc_flag_clear(FMC_FLAG_WPERR);
+    fmc_flag_clear(FMC_FLAG_PGERR);
+    fmc_page_erase(BENCH_FLASH_PAGE);
+    fmc_flag_clear(FMC_FLAG_END);
+
+    for(i = 0U; i < BENCH_RUNS; i++){
+        bench_region_start(&region[REGION_FMC_WORD]);
+        fmc_word_program(BENCH_FLASH_PAGE + (i * 4U), i);
+        bench_region_stop(&region[REGION_FMC_WORD]);
+        fmc_flag_clear(FMC_FLAG_END);
+    }
+    fmc_lock();
+}
@@ -0,0 +1,185 @@
+/*!
+    \file  main.c
+    \brief main routine of the CAN filter compiler demo
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_can_filter.h"
+
+#define SWEEP_FIRST         0x0F0U                          /* first standard identifier sent */
+#define SWEEP_LAST          0x13FU                          /* last standard identifier sent */
+
+/* identifiers the node listens to */
+static const can_filter_id_struct filter_ids[] = {
+    {CAN0, CAN_FF_STANDARD, 0x100U, 0x10FU, CAN_FIFO0},
+    {CAN0, CAN_FF_STANDARD, 0x123U, 0x123U, CAN_FIFO1},
+    {CAN0, CAN_FF_STANDARD, 0x130U, 0x131U, CAN_FIFO1},
+    {CAN0, CAN_FF_EXTENDED, 0x18FF0000U, 0x18FF00FFU, CAN_FIFO0},
+    {CAN1, CAN_FF_STANDARD, 0x300U, 0x37FU, CAN_FIFO0},
+};
+static can_filter_plan_struct filter_plan;
+static can_filter_report_struct filter_report;
+
+void led_config(void);
+void can_loopback_init(void);
+uint32_t can_sweep(uint32_t *fifo0, uint32_t *fifo1);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    uint32_t fifo0 = 0U, fifo1 = 0U, sent;
+
+    /* enable CAN clock */
+    rcu_periph_clock_enable(RCU_CAN0);
+    rcu_periph_clock_enable(RCU_CAN1);
+    /* configure USART */
+    gd_eval_com_init(EVAL_COM0);
+    /* configure leds */
+    led_config();
+    gd_eval_led_off(LED1);
+    gd_eval_led_off(LED2);
+
+    can_loopback_init();
+    /* compile the identifier list into banks and load them */
+    if(SUCCESS != can_filter_compile(&filter_plan, filter_ids, sizeof(filter_ids) / sizeof(filter_ids[0]))){
+        printf("\r\n filter compile failed \r\n");
+        while(1);
+    }
+    can_filter_apply(&filter_plan);
+    can_filter_report(&filter_plan, &filter_report);
+    printf("\r\n CAN0 banks = %d, CAN1 banks = %d from bank %d \r\n", (int)filter_plan.bank_num[0],
+           (int)filter_plan.bank_num[1], (int)filter_plan.can1_start_bank);
+    printf("\r\n CAN0 standard: %d requested, %d accepted \r\n", (int)filter_report.requested[0][0],
+           (int)filter_report.accepted[0][0]);
+
+    /* send every identifier of the sweep to itself and count what the filters let through */
+    sent = can_sweep(&fifo0, &fifo1);
+    printf("\r\n %d frames sent, %d in FIFO0, %d in FIFO1 \r\n", (int)sent, (int)fifo0, (int)fifo1);
+    if((16U == fifo0) && (3U == fifo1)){
+        gd_eval_led_on(LED1);
+    }else{
+        gd_eval_led_on(LED2);
+    }
+    while(1);
+}
+
+/*!
+    \brief      send the identifiers of the sweep on CAN0 in loopback and count
+                the frames that reach each FIFO
+    \param[in]  none
+    \param[out] fifo0: frames received in FIFO0
+    \param[out] fifo1: frames received in FIFO1
+    \retval     number of frames sent
+*/
+uint32_t can_sweep(uint32_t *fifo0, uint32_t *fifo1)
+{
+    can_trasnmit_message_struct transmit_message;
+    can_receive_message_struct receive_message;
+    uint32_t id, timeout, sent = 0U;
+    uint8_t mailbox;
+
+    can_struct_para_init(CAN_TX_MESSAGE_STRUCT, &transmit_message);
+    can_struct_para_init(CAN_RX_MESSAGE_STRUCT, &receive_message);
+    transmit_message.tx_ft = CAN_FT_DATA;
+    transmit_message.tx_ff = CAN_FF_STANDARD;
+    transmit_message.tx_dlen = 1U;
+
+    for(id = SWEEP_FIRST; id <= SWEEP_LAST; id++){
+        transmit_message.tx_sfid = id;
+        transmit_message.tx_data[0] = (uint8_t)id;
+        mailbox = can_message_transmit(CAN0, &transmit_message);
+        timeout = 0xFFFFU;
+        while((CAN_TRANSMIT_OK != can_transmit_states(CAN0, mailbox)) && (0U != timeout)){
+            timeout--;
+        }
+        sent++;
+        /* the looped back frame is filtered right after the transmission */
+        while(0U != can_receive_message_length_get(CAN0, CAN_FIFO0)){
+            can_message_receive(CAN0, CAN_FIFO0, &receive_message);
+            (*fifo0)++;
+        }
+        while(0U != can_receive_message_length_get(CAN0, CAN_FIFO1)){
+            can_message_receive(CAN0, CAN_FIFO1, &receive_message);
+            (*fifo1)++;
+        }
+    }
+
+    return sent;
+}
+
+/*!
+    \brief      initialize CAN0 in silent loopback mode at 125kbps
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_loopback_init(void)
+{
+    can_parameter_struct can_parameter;
+
+    can_struct_para_init(CAN_INIT_STRUCT, &can_parameter);
+    can_deinit(CAN0);
+    can_deinit(CAN1);
+
+    can_parameter.time_triggered = DISABLE;
+    can_parameter.auto_bus_off_recovery = DISABLE;
+    can_parameter.auto_wake_up = DISABLE;
+    can_parameter.no_auto_retrans = DISABLE;
+    can_parameter.rec_fifo_overwrite = DISABLE;
+    can_parameter.trans_fifo_order = DISABLE;
+    can_parameter.working_mode = CAN_SILENT_LOOPBACK_MODE;
+    can_parameter.resync_jump_width = CAN_BT_SJW_1TQ;
+    can_parameter.time_segment_1 = CAN_BT_BS1_5TQ;
+    can_parameter.time_segment_2 = CAN_BT_BS2_3TQ;
+    can_parameter.prescaler = 48;
+    can_init(CAN0, &can_parameter);
+}
+
+/*!
+    \brief      configure the leds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void led_config(void)
+{
+    gd_eval_led_init(LED1);
+    gd_eval_led_init(LED2);
+}
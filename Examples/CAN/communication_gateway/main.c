@@ -0,0 +1,268 @@
+/*!
+    \file  main.c
+    \brief CAN0 to CAN1 gateway with a routing table
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_can_filter.h"
+#include "gd32vf103_can_gateway.h"
+
+#define ROUTE_NUM           4U                              /* routes of the gateway */
+#define RING_SIZE           16U                             /* frames waiting for a mailbox, per CAN */
+
+/* the filters only take the identifiers of the routes */
+static const can_filter_id_struct filter_ids[] = {
+    {CAN0, CAN_FF_STANDARD, 0x100U, 0x1FFU, CAN_FIFO0},
+    {CAN0, CAN_FF_STANDARD, 0x7DFU, 0x7DFU, CAN_FIFO1},
+    {CAN1, CAN_FF_STANDARD, 0x300U, 0x3FFU, CAN_FIFO0},
+    {CAN1, CAN_FF_STANDARD, 0x7E8U, 0x7EFU, CAN_FIFO1},
+};
+static can_filter_plan_struct filter_plan;
+static can_gateway_route_struct routes[ROUTE_NUM];
+static can_gateway_frame_struct can0_ring[RING_SIZE];
+static can_gateway_frame_struct can1_ring[RING_SIZE];
+can_gateway_struct can_gateway;
+
+void led_config(void);
+void can_gpio_config(void);
+void can_network_init(void);
+void gateway_config(void);
+void clic_config(void);
+void route_set(can_gateway_route_struct *route, uint32_t src_periph, uint32_t id, uint32_t mask,
+               uint32_t new_id, uint32_t new_mask);
+void stats_print(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    uint32_t start;
+
+    /* configure USART */
+    gd_eval_com_init(EVAL_COM0);
+    /* configure leds */
+    led_config();
+    gd_eval_led_off(LED1);
+    gd_eval_led_off(LED2);
+
+    can_gpio_config();
+    can_network_init();
+    gateway_config();
+    clic_config();
+    printf("\r\n CAN gateway running \r\n");
+
+    /* the frames are forwarded in the interrupts, the main loop only reports */
+    start = (uint32_t)get_cycle_value();
+    while(1){
+        if(can_gateway.clock <= ((uint32_t)get_cycle_value() - start)){
+            start += can_gateway.clock;
+            gd_eval_led_toggle(LED1);
+            stats_print();
+        }
+    }
+}
+
+/*!
+    \brief      print the counters and the latencies of the routes
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void stats_print(void)
+{
+    can_gateway_stats_struct stats;
+    uint32_t i;
+
+    for(i = 0U; i < ROUTE_NUM; i++){
+        can_gateway_stats_get(&can_gateway, i, &stats);
+        printf("\r\n route %d: %d forwarded, dropped %d rate %d busy %d error, latency %d/%d/%d ns",
+               (int)i, (int)stats.forwarded, (int)stats.dropped_rate, (int)stats.dropped_busy,
+               (int)stats.dropped_error, (int)stats.latency_min_ns, (int)stats.latency_avg_ns,
+               (int)stats.latency_max_ns);
+        if(0U != (stats.dropped_rate + stats.dropped_busy + stats.dropped_error)){
+            gd_eval_led_on(LED2);
+        }
+    }
+    printf("\r\n");
+}
+
+/*!
+    \brief      configure the GPIO of CAN0 and CAN1
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_gpio_config(void)
+{
+    /* enable CAN clock */
+    rcu_periph_clock_enable(RCU_CAN0);
+    rcu_periph_clock_enable(RCU_CAN1);
+    rcu_periph_clock_enable(RCU_GPIOB);
+    rcu_periph_clock_enable(RCU_GPIOD);
+    rcu_periph_clock_enable(RCU_AF);
+
+    /* configure CAN0 GPIO */
+    gpio_init(GPIOD, GPIO_MODE_IPU, GPIO_OSPEED_50MHZ, GPIO_PIN_0);
+    gpio_init(GPIOD, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_1);
+    gpio_pin_remap_config(GPIO_CAN0_FULL_REMAP, ENABLE);
+
+    /* configure CAN1 GPIO */
+    gpio_init(GPIOB, GPIO_MODE_IPU, GPIO_OSPEED_50MHZ, GPIO_PIN_5);
+    gpio_init(GPIOB, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_6);
+    gpio_pin_remap_config(GPIO_CAN1_REMAP, ENABLE);
+}
+
+/*!
+    \brief      initialize CAN0 and CAN1 in normal mode at 500kbps and their filters
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_network_init(void)
+{
+    can_parameter_struct can_parameter;
+
+    can_struct_para_init(CAN_INIT_STRUCT, &can_parameter);
+    can_deinit(CAN0);
+    can_deinit(CAN1);
+
+    can_parameter.time_triggered = DISABLE;
+    can_parameter.auto_bus_off_recovery = ENABLE;
+    can_parameter.auto_wake_up = DISABLE;
+    can_parameter.no_auto_retrans = DISABLE;
+    can_parameter.rec_fifo_overwrite = DISABLE;
+    can_parameter.trans_fifo_order = ENABLE;
+    can_parameter.working_mode = CAN_NORMAL_MODE;
+    can_parameter.resync_jump_width = CAN_BT_SJW_1TQ;
+    can_parameter.time_segment_1 = CAN_BT_BS1_5TQ;
+    can_parameter.time_segment_2 = CAN_BT_BS2_3TQ;
+    can_parameter.prescaler = 12;
+    can_init(CAN0, &can_parameter);
+    can_init(CAN1, &can_parameter);
+
+    if(SUCCESS == can_filter_compile(&filter_plan, filter_ids, sizeof(filter_ids) / sizeof(filter_ids[0]))){
+        can_filter_apply(&filter_plan);
+    }
+}
+
+/*!
+    \brief      fill the standard identifier fields of a route, without a rate limit
+    \param[in]  route: route
+    \param[in]  src_periph: CAN the frames come from
+    \param[in]  id, mask: identifiers matched
+    \param[in]  new_id, new_mask: identifier bits replaced on the other CAN
+    \param[out] none
+    \retval     none
+*/
+void route_set(can_gateway_route_struct *route, uint32_t src_periph, uint32_t id, uint32_t mask,
+               uint32_t new_id, uint32_t new_mask)
+{
+    route->src_periph = src_periph;
+    route->ff = (uint8_t)CAN_FF_STANDARD;
+    route->id = id;
+    route->mask = mask;
+    route->new_id = new_id;
+    route->new_mask = new_mask;
+    route->rate = 0U;
+    route->burst = 0U;
+}
+
+/*!
+    \brief      set up the routes and start the gateway
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gateway_config(void)
+{
+    can_gateway_parameter_struct gateway_parameter;
+
+    /* 0x100-0x1FF from CAN0 to CAN1 as they are */
+    route_set(&routes[0], CAN0, 0x100U, 0x700U, 0x000U, 0x000U);
+    /* diagnostic requests from CAN0, at most 10 per second with bursts of 4 */
+    route_set(&routes[1], CAN0, 0x7DFU, 0x7FFU, 0x000U, 0x000U);
+    routes[1].rate = 10U;
+    routes[1].burst = 4U;
+    /* 0x300-0x3FF from CAN1 to CAN0 as 0x500-0x5FF */
+    route_set(&routes[2], CAN1, 0x300U, 0x700U, 0x500U, 0x700U);
+    /* diagnostic responses from CAN1 as they are */
+    route_set(&routes[3], CAN1, 0x7E8U, 0x7F8U, 0x000U, 0x000U);
+
+    gateway_parameter.routes = routes;
+    gateway_parameter.route_num = ROUTE_NUM;
+    gateway_parameter.tx_buffer[0] = can0_ring;
+    gateway_parameter.tx_size[0] = RING_SIZE;
+    gateway_parameter.tx_buffer[1] = can1_ring;
+    gateway_parameter.tx_size[1] = RING_SIZE;
+    if(SUCCESS != can_gateway_init(&can_gateway, &gateway_parameter)){
+        printf("\r\n CAN gateway init failed \r\n");
+        while(1);
+    }
+}
+
+/*!
+    \brief      configure the nested vectored interrupt controller
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void clic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_priority_group_set(ECLIC_PRIGROUP_LEVEL3_PRIO1);
+    /* one level for all CAN interrupts, they must not preempt each other */
+    eclic_irq_enable(CAN0_TX_IRQn, 2, 0);
+    eclic_irq_enable(CAN0_RX0_IRQn, 2, 0);
+    eclic_irq_enable(CAN0_RX1_IRQn, 2, 0);
+    eclic_irq_enable(CAN1_TX_IRQn, 2, 0);
+    eclic_irq_enable(CAN1_RX0_IRQn, 2, 0);
+    eclic_irq_enable(CAN1_RX1_IRQn, 2, 0);
+}
+
+/*!
+    \brief      configure the leds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void led_config(void)
+{
+    gd_eval_led_init(LED1);
+    gd_eval_led_init(LED2);
+}
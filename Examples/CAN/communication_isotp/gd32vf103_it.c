@@ -0,0 +1,88 @@
+/*!
+    \file  gd32vf103_it.c
+    \brief interrupt service routines
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_it.h"
+#include "gd32vf103_can_isotp.h"
+
+extern can_isotp_struct isotp_can0;
+extern can_isotp_struct isotp_can1;
+
+/*!
+    \brief      this function handles CAN0 TX exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void CAN0_TX_IRQHandler(void)
+{
+    /* retire the sent mailboxes and load the next frames */
+    can_isotp_tx_irq_handler(&isotp_can0);
+}
+
+/*!
+    \brief      this function handles CAN0 RX0 exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void CAN0_RX0_IRQHandler(void)
+{
+    /* hand the frames of FIFO0 to the sessions */
+    can_isotp_rx_irq_handler(&isotp_can0, CAN_FIFO0);
+}
+
+/*!
+    \brief      this function handles CAN1 TX exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void CAN1_TX_IRQHandler(void)
+{
+    /* retire the sent mailboxes and load the next frames */
+    can_isotp_tx_irq_handler(&isotp_can1);
+}
+
+/*!
+    \brief      this function handles CAN1 RX0 exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void CAN1_RX0_IRQHandler(void)
+{
+    /* hand the frames of FIFO0 to the sessions */
+    can_isotp_rx_irq_handler(&isotp_can1, CAN_FIFO0);
+}
@@ -0,0 +1,310 @@
+/*!
+    \file  main.c
+    \brief ISO-TP transfer between CAN0 and CAN1
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_can_filter.h"
+#include "gd32vf103_can_isotp.h"
+
+#define REQUEST_SIZE        4096U                           /* bytes of the request sent by CAN0 */
+
+/* CAN0 receives the response on 0x7E8, CAN1 the request on 0x7E0 */
+static const can_filter_id_struct filter_ids[] = {
+    {CAN0, CAN_FF_STANDARD, 0x7E8U, 0x7E8U, CAN_FIFO0},
+    {CAN1, CAN_FF_STANDARD, 0x7E0U, 0x7E0U, CAN_FIFO0},
+};
+static const uint8_t response[2] = {0x76U, 0x01U};
+static can_filter_plan_struct filter_plan;
+static uint8_t request[REQUEST_SIZE];
+static uint8_t request_buffer[REQUEST_SIZE];
+static uint8_t response_buffer[8];
+static can_isotp_session_struct tester_session;
+static can_isotp_session_struct ecu_session;
+static volatile uint32_t response_len;
+static volatile can_isotp_result_enum response_result;
+static volatile FlagStatus response_flag;
+can_isotp_struct isotp_can0;
+can_isotp_struct isotp_can1;
+
+void led_config(void);
+void can_gpio_config(void);
+void can_network_init(void);
+void isotp_config(void);
+void clic_config(void);
+void ecu_request_received(can_isotp_struct *isotp, can_isotp_session_struct *session,
+                          uint32_t len, can_isotp_result_enum result);
+void tester_response_received(can_isotp_struct *isotp, can_isotp_session_struct *session,
+                              uint32_t len, can_isotp_result_enum result);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    uint32_t i, start, cycles;
+
+    /* configure USART */
+    gd_eval_com_init(EVAL_COM0);
+    /* configure leds */
+    led_config();
+    gd_eval_led_off(LED1);
+    gd_eval_led_off(LED2);
+
+    for(i = 0U; i < REQUEST_SIZE; i++){
+        request[i] = (uint8_t)(i + (i >> 8));
+    }
+    can_gpio_config();
+    can_network_init();
+    isotp_config();
+    clic_config();
+
+    /* CAN0 sends the request, CAN1 answers once all of it has arrived */
+    response_flag = RESET;
+    start = get_cycle_value();
+    if(SUCCESS != can_isotp_transmit(&isotp_can0, &tester_session, request, REQUEST_SIZE)){
+        printf("\r\n ISO-TP transmit refused \r\n");
+        while(1);
+    }
+    while(RESET == response_flag){
+        /* separation times and timeouts */
+        can_isotp_poll(&isotp_can0);
+        can_isotp_poll(&isotp_can1);
+    }
+    cycles = get_cycle_value() - start;
+
+    printf("\r\n %d byte request, response %02x %02x in %d us \r\n", (int)REQUEST_SIZE,
+           response_buffer[0], response_buffer[1], (int)(cycles / (isotp_can0.clock / 1000000U)));
+    if((CAN_ISOTP_OK == response_result) && (sizeof(response) == response_len)
+       && (response[0] == response_buffer[0])){
+        gd_eval_led_on(LED1);
+    }else{
+        printf("\r\n ISO-TP transfer failed, result %d \r\n", (int)response_result);
+        gd_eval_led_on(LED2);
+    }
+    while(1);
+}
+
+/*!
+    \brief      receive callback of CAN1, checks the request and sends the response
+    \param[in]  isotp: ISO-TP driver of CAN1
+    \param[in]  session: session that received the request
+    \param[in]  len: bytes received
+    \param[in]  result: outcome of the reception
+    \param[out] none
+    \retval     none
+*/
+void ecu_request_received(can_isotp_struct *isotp, can_isotp_session_struct *session,
+                          uint32_t len, can_isotp_result_enum result)
+{
+    uint32_t i;
+    uint8_t status = 0x01U;
+
+    if((CAN_ISOTP_OK != result) || (REQUEST_SIZE != len)){
+        status = 0x00U;
+    }else{
+        for(i = 0U; i < len; i++){
+            if(request[i] != session->rx_buffer[i]){
+                status = 0x00U;
+                break;
+            }
+        }
+    }
+    if(0x00U == status){
+        can_isotp_transmit(isotp, session, &status, 1U);
+    }else{
+        can_isotp_transmit(isotp, session, response, sizeof(response));
+    }
+}
+
+/*!
+    \brief      receive callback of CAN0, flags the response to the main loop
+    \param[in]  isotp: ISO-TP driver of CAN0
+    \param[in]  session: session that received the response
+    \param[in]  len: bytes received
+    \param[in]  result: outcome of the reception
+    \param[out] none
+    \retval     none
+*/
+void tester_response_received(can_isotp_struct *isotp, can_isotp_session_struct *session,
+                              uint32_t len, can_isotp_result_enum result)
+{
+    response_len = len;
+    response_result = result;
+    response_flag = SET;
+}
+
+/*!
+    \brief      configure the GPIO of CAN0 and CAN1
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_gpio_config(void)
+{
+    /* enable CAN clock */
+    rcu_periph_clock_enable(RCU_CAN0);
+    rcu_periph_clock_enable(RCU_CAN1);
+    rcu_periph_clock_enable(RCU_GPIOB);
+    rcu_periph_clock_enable(RCU_GPIOD);
+    rcu_periph_clock_enable(RCU_AF);
+
+    /* configure CAN0 GPIO */
+    gpio_init(GPIOD, GPIO_MODE_IPU, GPIO_OSPEED_50MHZ, GPIO_PIN_0);
+    gpio_init(GPIOD, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_1);
+    gpio_pin_remap_config(GPIO_CAN0_FULL_REMAP, ENABLE);
+
+    /* configure CAN1 GPIO */
+    gpio_init(GPIOB, GPIO_MODE_IPU, GPIO_OSPEED_50MHZ, GPIO_PIN_5);
+    gpio_init(GPIOB, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_6);
+    gpio_pin_remap_config(GPIO_CAN1_REMAP, ENABLE);
+}
+
+/*!
+    \brief      initialize CAN0 and CAN1 in normal mode at 500kbps and their filters
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_network_init(void)
+{
+    can_parameter_struct can_parameter;
+
+    can_struct_para_init(CAN_INIT_STRUCT, &can_parameter);
+    can_deinit(CAN0);
+    can_deinit(CAN1);
+
+    can_parameter.time_triggered = DISABLE;
+    can_parameter.auto_bus_off_recovery = DISABLE;
+    can_parameter.auto_wake_up = DISABLE;
+    can_parameter.no_auto_retrans = DISABLE;
+    can_parameter.rec_fifo_overwrite = DISABLE;
+    can_parameter.trans_fifo_order = ENABLE;
+    can_parameter.working_mode = CAN_NORMAL_MODE;
+    can_parameter.resync_jump_width = CAN_BT_SJW_1TQ;
+    can_parameter.time_segment_1 = CAN_BT_BS1_5TQ;
+    can_parameter.time_segment_2 = CAN_BT_BS2_3TQ;
+    can_parameter.prescaler = 12;
+    can_init(CAN0, &can_parameter);
+    can_init(CAN1, &can_parameter);
+
+    if(SUCCESS == can_filter_compile(&filter_plan, filter_ids, sizeof(filter_ids) / sizeof(filter_ids[0]))){
+        can_filter_apply(&filter_plan);
+    }
+}
+
+/*!
+    \brief      set up one session on each CAN and start the ISO-TP drivers
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void isotp_config(void)
+{
+    can_isotp_parameter_struct isotp_parameter;
+
+    /* the tester on CAN0 takes the response in one flow */
+    tester_session.tx_id = 0x7E0U;
+    tester_session.rx_id = 0x7E8U;
+    tester_session.ff = (uint8_t)CAN_FF_STANDARD;
+    tester_session.block_size = 0U;
+    tester_session.st_min = 0U;
+    tester_session.padding = 0xCCU;
+    tester_session.rx_buffer = response_buffer;
+    tester_session.rx_size = sizeof(response_buffer);
+    tester_session.tx_callback = NULL;
+    tester_session.rx_callback = tester_response_received;
+    tester_session.user_data = NULL;
+
+    /* the ECU on CAN1 asks for blocks of 16 frames without a separation time */
+    ecu_session.tx_id = 0x7E8U;
+    ecu_session.rx_id = 0x7E0U;
+    ecu_session.ff = (uint8_t)CAN_FF_STANDARD;
+    ecu_session.block_size = 16U;
+    ecu_session.st_min = 0U;
+    ecu_session.padding = 0xCCU;
+    ecu_session.rx_buffer = request_buffer;
+    ecu_session.rx_size = sizeof(request_buffer);
+    ecu_session.tx_callback = NULL;
+    ecu_session.rx_callback = ecu_request_received;
+    ecu_session.user_data = NULL;
+
+    isotp_parameter.timeout_ms = 0U;
+    isotp_parameter.session_num = 1U;
+    isotp_parameter.can_periph = CAN0;
+    isotp_parameter.sessions = &tester_session;
+    if(SUCCESS != can_isotp_init(&isotp_can0, &isotp_parameter)){
+        printf("\r\n CAN0 ISO-TP init failed \r\n");
+        while(1);
+    }
+    isotp_parameter.can_periph = CAN1;
+    isotp_parameter.sessions = &ecu_session;
+    if(SUCCESS != can_isotp_init(&isotp_can1, &isotp_parameter)){
+        printf("\r\n CAN1 ISO-TP init failed \r\n");
+        while(1);
+    }
+}
+
+/*!
+    \brief      configure the nested vectored interrupt controller
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void clic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_priority_group_set(ECLIC_PRIGROUP_LEVEL3_PRIO1);
+    /* one level for all CAN interrupts, they must not preempt each other */
+    eclic_irq_enable(CAN0_TX_IRQn, 2, 0);
+    eclic_irq_enable(CAN0_RX0_IRQn, 2, 0);
+    eclic_irq_enable(CAN1_TX_IRQn, 2, 0);
+    eclic_irq_enable(CAN1_RX0_IRQn, 2, 0);
+}
+
+/*!
+    \brief      configure the leds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void led_config(void)
+{
+    gd_eval_led_init(LED1);
+    gd_eval_led_init(LED2);
+}
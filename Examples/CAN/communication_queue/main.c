@@ -0,0 +1,221 @@
+/*!
+    \file  main.c
+    \brief CAN queues with priority ordered mailboxes
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_can_filter.h"
+#include "gd32vf103_can_queue.h"
+
+#define BURST_FRAMES        48U                             /* frames submitted in one burst */
+
+/* standard identifiers into FIFO0, extended ones into FIFO1 */
+static const can_filter_id_struct filter_ids[] = {
+    {CAN0, CAN_FF_STANDARD, 0x000U, 0x7FFU, CAN_FIFO0},
+    {CAN0, CAN_FF_EXTENDED, 0x00000000U, 0x1FFFFFFFU, CAN_FIFO1},
+};
+static can_filter_plan_struct filter_plan;
+static can_queue_slot_struct tx_slots[64];
+static can_queue_frame_struct rx0_ring[64];
+static can_queue_frame_struct rx1_ring[16];
+can_queue_struct can_queue;
+
+void led_config(void);
+void can_loopback_init(void);
+void can_queue_config(void);
+void clic_config(void);
+uint32_t can_burst(uint32_t *ordered);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    uint32_t received, ordered = 0U;
+
+    /* enable CAN clock */
+    rcu_periph_clock_enable(RCU_CAN0);
+    /* configure USART */
+    gd_eval_com_init(EVAL_COM0);
+    /* configure leds */
+    led_config();
+    gd_eval_led_off(LED1);
+    gd_eval_led_off(LED2);
+
+    can_loopback_init();
+    can_queue_config();
+    clic_config();
+
+    /* submit a burst from the lowest to the highest priority and read back what looped back */
+    received = can_burst(&ordered);
+    printf("\r\n %d frames received, %d in identifier order, %d stopped mailboxes \r\n", (int)received,
+           (int)ordered, (int)can_queue.tx_stopped);
+    printf("\r\n dropped: TX %d, RX0 %d, RX1 %d, overrun: RX0 %d, RX1 %d \r\n", (int)can_queue.tx_dropped,
+           (int)can_queue.rx_dropped[0], (int)can_queue.rx_dropped[1], (int)can_queue.rx_overrun[0],
+           (int)can_queue.rx_overrun[1]);
+    if((BURST_FRAMES == received) && (0U == can_queue.tx_failed)){
+        gd_eval_led_on(LED1);
+    }else{
+        gd_eval_led_on(LED2);
+    }
+    while(1);
+}
+
+/*!
+    \brief      send a burst of standard frames of rising priority and receive
+                them through the FIFO0 ring
+    \param[in]  none
+    \param[out] ordered: frames received with an identifier not below the one before
+    \retval     number of frames received
+*/
+uint32_t can_burst(uint32_t *ordered)
+{
+    can_queue_frame_struct frame;
+    uint32_t i, timeout, received = 0U, last = 0U;
+
+    frame.ff = (uint8_t)CAN_FF_STANDARD;
+    frame.ft = (uint8_t)CAN_FT_DATA;
+    frame.dlen = 2U;
+    for(i = 0U; i < BURST_FRAMES; i++){
+        frame.id = 0x400U - (i * 0x10U);
+        frame.data[0] = (uint8_t)i;
+        frame.data[1] = (uint8_t)(frame.id >> 4);
+        can_queue_transmit(&can_queue, &frame);
+    }
+
+    timeout = 0x00FFFFFFU;
+    while((0U != can_queue_tx_pending_get(&can_queue)) && (0U != timeout)){
+        timeout--;
+    }
+    timeout = 0xFFFFU;
+    while((BURST_FRAMES != can_queue_rx_count_get(&can_queue, CAN_FIFO0)) && (0U != timeout)){
+        timeout--;
+    }
+
+    /* the first frames went out before the later, higher priority ones were queued */
+    while(SUCCESS == can_queue_receive(&can_queue, CAN_FIFO0, &frame)){
+        if(frame.id >= last){
+            (*ordered)++;
+        }
+        last = frame.id;
+        received++;
+    }
+
+    return received;
+}
+
+/*!
+    \brief      initialize CAN0 in loopback mode at 125kbps
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_loopback_init(void)
+{
+    can_parameter_struct can_parameter;
+
+    can_struct_para_init(CAN_INIT_STRUCT, &can_parameter);
+    can_deinit(CAN0);
+
+    can_parameter.time_triggered = DISABLE;
+    can_parameter.auto_bus_off_recovery = DISABLE;
+    can_parameter.auto_wake_up = DISABLE;
+    can_parameter.no_auto_retrans = DISABLE;
+    can_parameter.rec_fifo_overwrite = DISABLE;
+    can_parameter.trans_fifo_order = DISABLE;
+    can_parameter.working_mode = CAN_LOOPBACK_MODE;
+    can_parameter.resync_jump_width = CAN_BT_SJW_1TQ;
+    can_parameter.time_segment_1 = CAN_BT_BS1_5TQ;
+    can_parameter.time_segment_2 = CAN_BT_BS2_3TQ;
+    can_parameter.prescaler = 48;
+    can_init(CAN0, &can_parameter);
+
+    if(SUCCESS == can_filter_compile(&filter_plan, filter_ids, sizeof(filter_ids) / sizeof(filter_ids[0]))){
+        can_filter_apply(&filter_plan);
+    }
+}
+
+/*!
+    \brief      hand the heap and the rings to the CAN queue driver
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_queue_config(void)
+{
+    can_queue_parameter_struct queue_parameter;
+
+    queue_parameter.can_periph = CAN0;
+    queue_parameter.tx_buffer = tx_slots;
+    queue_parameter.tx_size = sizeof(tx_slots) / sizeof(tx_slots[0]);
+    queue_parameter.rx_buffer[0] = rx0_ring;
+    queue_parameter.rx_size[0] = sizeof(rx0_ring) / sizeof(rx0_ring[0]);
+    queue_parameter.rx_buffer[1] = rx1_ring;
+    queue_parameter.rx_size[1] = sizeof(rx1_ring) / sizeof(rx1_ring[0]);
+    if(SUCCESS != can_queue_init(&can_queue, &queue_parameter)){
+        printf("\r\n CAN queue init failed \r\n");
+        while(1);
+    }
+}
+
+/*!
+    \brief      configure the nested vectored interrupt controller
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void clic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_priority_group_set(ECLIC_PRIGROUP_LEVEL3_PRIO1);
+    eclic_irq_enable(CAN0_TX_IRQn, 2, 0);
+    eclic_irq_enable(CAN0_RX0_IRQn, 2, 0);
+    eclic_irq_enable(CAN0_RX1_IRQn, 2, 0);
+}
+
+/*!
+    \brief      configure the leds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void led_config(void)
+{
+    gd_eval_led_init(LED1);
+    gd_eval_led_init(LED2);
+}
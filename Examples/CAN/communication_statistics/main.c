@@ -0,0 +1,243 @@
+/*!
+    \file  main.c
+    \brief CAN bus load, latency and error statistics
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_can_filter.h"
+#include "gd32vf103_can_queue.h"
+#include "gd32vf103_can_stats.h"
+
+#define BURST_FRAMES        32U                             /* frames submitted in one burst */
+
+/* standard identifiers into FIFO0, extended ones into FIFO1 */
+static const can_filter_id_struct filter_ids[] = {
+    {CAN0, CAN_FF_STANDARD, 0x000U, 0x7FFU, CAN_FIFO0},
+    {CAN0, CAN_FF_EXTENDED, 0x00000000U, 0x1FFFFFFFU, CAN_FIFO1},
+};
+static can_filter_plan_struct filter_plan;
+static can_queue_slot_struct tx_slots[32];
+static can_queue_frame_struct rx0_ring[64];
+static can_queue_frame_struct rx1_ring[16];
+static can_stats_id_struct stats_ids[32];
+static can_stats_struct can_stats;
+static uint8_t snapshot[CAN_STATS_SNAPSHOT_HEADER + (48U * CAN_STATS_SNAPSHOT_RECORD)];
+can_queue_struct can_queue;
+
+void led_config(void);
+void can_loopback_init(void);
+void can_queue_config(void);
+void clic_config(void);
+void can_burst(void);
+void snapshot_dump(const uint8_t *buffer, uint32_t len);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    can_stats_parameter_struct stats_parameter;
+    uint32_t len;
+
+    /* enable CAN clock */
+    rcu_periph_clock_enable(RCU_CAN0);
+    /* configure USART */
+    gd_eval_com_init(EVAL_COM0);
+    /* configure leds */
+    led_config();
+    gd_eval_led_off(LED1);
+    gd_eval_led_off(LED2);
+
+    can_loopback_init();
+    can_queue_config();
+    stats_parameter.queue = &can_queue;
+    stats_parameter.ids = stats_ids;
+    stats_parameter.id_size = sizeof(stats_ids) / sizeof(stats_ids[0]);
+    if(SUCCESS != can_stats_init(&can_stats, &stats_parameter)){
+        printf("\r\n CAN statistics init failed \r\n");
+        while(1);
+    }
+    clic_config();
+
+    /* one period with a burst of frames, closed once the bus is idle again */
+    can_stats_period(&can_stats);
+    can_burst();
+    can_stats_period(&can_stats);
+
+    printf("\r\n %d frames in %d us, bus load %d permille \r\n", (int)can_stats.period_frames,
+           (int)can_stats.period_us, (int)can_stats.load);
+    printf("\r\n queue to ACK in bits: min %d, max %d, waiting for the bus: min %d, max %d \r\n",
+           (int)can_stats.total.min, (int)can_stats.total.max, (int)can_stats.wait.min, (int)can_stats.wait.max);
+    len = can_stats_snapshot(&can_stats, snapshot, sizeof(snapshot));
+    snapshot_dump(snapshot, len);
+    if((BURST_FRAMES == can_stats.total.count) && (0U != len)){
+        gd_eval_led_on(LED1);
+    }else{
+        gd_eval_led_on(LED2);
+    }
+    while(1);
+}
+
+/*!
+    \brief      send a burst of standard frames on eight identifiers and drain
+                the frames that looped back
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_burst(void)
+{
+    can_queue_frame_struct frame;
+    uint32_t i, timeout;
+
+    frame.ff = (uint8_t)CAN_FF_STANDARD;
+    frame.ft = (uint8_t)CAN_FT_DATA;
+    frame.dlen = 8U;
+    for(i = 0U; i < BURST_FRAMES; i++){
+        frame.id = 0x100U + (i % 8U);
+        frame.data[0] = (uint8_t)i;
+        can_queue_transmit(&can_queue, &frame);
+    }
+
+    timeout = 0x00FFFFFFU;
+    while((0U != can_queue_tx_pending_get(&can_queue)) && (0U != timeout)){
+        timeout--;
+    }
+    while(SUCCESS == can_queue_receive(&can_queue, CAN_FIFO0, &frame)){
+    }
+}
+
+/*!
+    \brief      print a snapshot as hexadecimal bytes, 16 per line
+    \param[in]  buffer: snapshot
+    \param[in]  len: bytes in the snapshot
+    \param[out] none
+    \retval     none
+*/
+void snapshot_dump(const uint8_t *buffer, uint32_t len)
+{
+    uint32_t i;
+
+    printf("\r\n snapshot, %d bytes:", (int)len);
+    for(i = 0U; i < len; i++){
+        if(0U == (i % 16U)){
+            printf("\r\n");
+        }
+        printf(" %02x", buffer[i]);
+    }
+    printf("\r\n");
+}
+/*!
+    \brief      initialize CAN0 in loopback mode at 125kbps
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_loopback_init(void)
+{
+    can_parameter_struct can_parameter;
+
+    can_struct_para_init(CAN_INIT_STRUCT, &can_parameter);
+    can_deinit(CAN0);
+
+    can_parameter.time_triggered = DISABLE;
+    can_parameter.auto_bus_off_recovery = DISABLE;
+    can_parameter.auto_wake_up = DISABLE;
+    can_parameter.no_auto_retrans = DISABLE;
+    can_parameter.rec_fifo_overwrite = DISABLE;
+    can_parameter.trans_fifo_order = DISABLE;
+    can_parameter.working_mode = CAN_LOOPBACK_MODE;
+    can_parameter.resync_jump_width = CAN_BT_SJW_1TQ;
+    can_parameter.time_segment_1 = CAN_BT_BS1_5TQ;
+    can_parameter.time_segment_2 = CAN_BT_BS2_3TQ;
+    can_parameter.prescaler = 48;
+    can_init(CAN0, &can_parameter);
+
+    if(SUCCESS == can_filter_compile(&filter_plan, filter_ids, sizeof(filter_ids) / sizeof(filter_ids[0]))){
+        can_filter_apply(&filter_plan);
+    }
+}
+
+/*!
+    \brief      hand the heap and the rings to the CAN queue driver
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void can_queue_config(void)
+{
+    can_queue_parameter_struct queue_parameter;
+
+    queue_parameter.can_periph = CAN0;
+    queue_parameter.tx_buffer = tx_slots;
+    queue_parameter.tx_size = sizeof(tx_slots) / sizeof(tx_slots[0]);
+    queue_parameter.rx_buffer[0] = rx0_ring;
+    queue_parameter.rx_size[0] = sizeof(rx0_ring) / sizeof(rx0_ring[0]);
+    queue_parameter.rx_buffer[1] = rx1_ring;
+    queue_parameter.rx_size[1] = sizeof(rx1_ring) / sizeof(rx1_ring[0]);
+    if(SUCCESS != can_queue_init(&can_queue, &queue_parameter)){
+        printf("\r\n CAN queue init failed \r\n");
+        while(1);
+    }
+}
+
+/*!
+    \brief      configure the nested vectored interrupt controller
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void clic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_priority_group_set(ECLIC_PRIGROUP_LEVEL3_PRIO1);
+    eclic_irq_enable(CAN0_TX_IRQn, 2, 0);
+    eclic_irq_enable(CAN0_RX0_IRQn, 2, 0);
+    eclic_irq_enable(CAN0_RX1_IRQn, 2, 0);
+}
+
+/*!
+    \brief      configure the leds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void led_config(void)
+{
+    gd_eval_led_init(LED1);
+    gd_eval_led_init(LED2);
+}
@@ -0,0 +1,191 @@
+/*!
+    \file  main.c
+    \brief main routine of the DAC concurrent waveform stream
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include "systick.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_dac_stream.h"
+
+#define SAMPLE_RATE         64000U
+#define WAVE_FREQUENCY      1000U
+#define TABLE_SIZE          64U
+#define HALF_POINTS         64U
+
+/* one period of a sine, 12-bit right aligned */
+static const uint16_t sine_table[TABLE_SIZE] = {
+    0x800U, 0x8C9U, 0x98FU, 0xA52U, 0xB0FU, 0xBC5U, 0xC71U, 0xD13U,
+    0xDA7U, 0xE2EU, 0xEA6U, 0xF0DU, 0xF63U, 0xFA7U, 0xFD8U, 0xFF5U,
+    0xFFFU, 0xFF5U, 0xFD8U, 0xFA7U, 0xF63U, 0xF0DU, 0xEA6U, 0xE2EU,
+    0xDA7U, 0xD13U, 0xC71U, 0xBC5U, 0xB0FU, 0xA52U, 0x98FU, 0x8C9U,
+    0x800U, 0x737U, 0x671U, 0x5AEU, 0x4F1U, 0x43BU, 0x38FU, 0x2EDU,
+    0x259U, 0x1D2U, 0x15AU, 0x0F3U, 0x09DU, 0x059U, 0x028U, 0x00BU,
+    0x001U, 0x00BU, 0x028U, 0x059U, 0x09DU, 0x0F3U, 0x15AU, 0x1D2U,
+    0x259U, 0x2EDU, 0x38FU, 0x43BU, 0x4F1U, 0x5AEU, 0x671U, 0x737U
+};
+/* pairs of DAC0 and DAC1 samples, two halves */
+static uint16_t dac_buffer[2U * 2U * HALF_POINTS];
+dac_stream_struct dac_stream;
+/* table position in 16.16 fixed point */
+static uint32_t wave_phase;
+static uint32_t wave_step;
+
+void rcu_config(void);
+void gpio_config(void);
+void eclic_config(void);
+void dac_config(void);
+uint32_t dac_wave_fill(dac_stream_struct *stream, uint16_t *data, uint32_t len);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    /* system clocks configuration */
+    rcu_config();
+    /* GPIO configuration */
+    gpio_config();
+    /* eclic configuration */
+    eclic_config();
+    /* DAC stream configuration */
+    dac_config();
+    /* configure COM port */
+    gd_eval_com_init(EVAL_COM0);
+
+    /* fill both halves and start TIMER5 */
+    dac_stream_start(&dac_stream);
+
+    while(1){
+        delay_1ms(1000);
+        printf("\r\n sample rate = %d Hz \r\n", (int)dac_stream.sample_rate);
+        printf("\r\n halves = %d, underruns = %d \r\n", (int)dac_stream.halves, (int)dac_stream.underrun);
+        printf("\r\n ***********************************\r\n");
+    }
+}
+
+/*!
+    \brief      fill a half with the next points, a sine on DAC0 and a cosine on DAC1
+    \param[in]  stream: DAC stream the half belongs to
+    \param[in]  len: number of samples to fill, two per point
+    \param[out] data: half to fill
+    \retval     number of samples filled
+*/
+uint32_t dac_wave_fill(dac_stream_struct *stream, uint16_t *data, uint32_t len)
+{
+    uint32_t index, i;
+
+    (void)stream;
+    for(i = 0U; i < len; i += 2U){
+        index = wave_phase >> 16U;
+        data[i] = sine_table[index];
+        data[i + 1U] = sine_table[(index + (TABLE_SIZE / 4U)) % TABLE_SIZE];
+        wave_phase = (wave_phase + wave_step) % (TABLE_SIZE << 16U);
+    }
+    return len;
+}
+
+/*!
+    \brief      configure the different system clocks
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void rcu_config(void)
+{
+    /* enable GPIOA clock */
+    rcu_periph_clock_enable(RCU_GPIOA);
+    /* enable DAC clock */
+    rcu_periph_clock_enable(RCU_DAC);
+    /* enable DMA1 clock */
+    rcu_periph_clock_enable(RCU_DMA1);
+    /* enable timer5 clock */
+    rcu_periph_clock_enable(RCU_TIMER5);
+}
+
+/*!
+    \brief      configure the GPIO peripheral
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gpio_config(void)
+{
+    /* once enabled the DAC, the corresponding GPIO pin is connected to the DAC converter automatically */
+    gpio_init(GPIOA, GPIO_MODE_AIN, GPIO_OSPEED_50MHZ, GPIO_PIN_4 | GPIO_PIN_5);
+}
+
+/*!
+    \brief      configure the DAC stream
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void dac_config(void)
+{
+    dac_stream_parameter_struct dac_stream_para;
+
+    /* reset DAC */
+    dac_deinit();
+    /* both DACs on each TIMER5 update event, 64 points per half */
+    dac_stream_para.output       = DAC_STREAM_OUTPUT_CONCURRENT;
+    dac_stream_para.timer_periph = TIMER5;
+    dac_stream_para.sample_rate  = SAMPLE_RATE;
+    dac_stream_para.buffer       = dac_buffer;
+    dac_stream_para.size         = sizeof(dac_buffer) / sizeof(dac_buffer[0]);
+    dac_stream_para.callback     = dac_wave_fill;
+    dac_stream_para.user_data    = NULL;
+    if(ERROR == dac_stream_init(&dac_stream, &dac_stream_para)){
+        while(1){
+        }
+    }
+    /* table entries per sample in 16.16 fixed point, from the rate the timer really runs at */
+    wave_phase = 0U;
+    wave_step = (uint32_t)(((uint64_t)(TABLE_SIZE << 16U) * WAVE_FREQUENCY) / dac_stream.sample_rate);
+}
+
+/**
+    \brief      configure the nested vectored interrupt controller
+    \param[in]  none
+    \param[out] none
+    \retval     none
+  */
+void eclic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_irq_enable(DMA1_Channel2_IRQn, 2, 0);
+}
@@ -0,0 +1,153 @@
+/*!
+    \file  main.c
+    \brief settings records written through the buffered flash writer
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_fmc_writer.h"
+
+#define WRITER_START            0x08008000U                 /* first page of the area */
+#define WRITER_PAGES            4U                          /* pages of the area */
+#define SHADOW_NUM              2U                          /* pages buffered in RAM */
+#define RECORD_NUM              200U                        /* records written per pass */
+
+/* settings record, 10 bytes so most records straddle two words */
+typedef struct
+{
+    uint16_t id;
+    uint32_t value;
+    uint32_t check;
+}__attribute__((packed)) record_struct;
+
+static fmc_writer_shadow_struct shadows[SHADOW_NUM];
+static fmc_writer_struct writer;
+
+void led_config(void);
+void write_records(uint32_t seed);
+void page_done(fmc_writer_struct *w, const fmc_writer_page_struct *page);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    fmc_writer_parameter_struct init;
+    uint32_t pass;
+
+    led_config();
+    gd_eval_com_init(EVAL_COM0);
+    gd_eval_led_off(LED1);
+    gd_eval_led_off(LED2);
+    rcu_periph_clock_enable(RCU_CRC);
+
+    init.start = WRITER_START;
+    init.size = WRITER_PAGES * FMC_WRITER_PAGE_SIZE;
+    init.shadows = shadows;
+    init.shadow_num = SHADOW_NUM;
+    init.callback = page_done;
+    if(SUCCESS != fmc_writer_init(&writer, &init)){
+        printf("\r\n FMC writer init failed \r\n");
+        gd_eval_led_on(LED2);
+        while(1){
+        }
+    }
+
+    /* the second pass writes the same records and programs nothing, the third changes them */
+    for(pass = 0U; pass < 3U; pass++){
+        printf("\r\n pass %d:", (int)pass);
+        write_records((2U == pass) ? 1U : 0U);
+    }
+    printf("\r\n %d pages, %d erased, %d programs, %d words skipped, %d errors \r\n",
+           (int)writer.pages, (int)writer.erases, (int)writer.programmed, (int)writer.skipped, (int)writer.errors);
+
+    if(0U == writer.errors){
+        gd_eval_led_on(LED1);
+    }
+    while(1){
+    }
+}
+
+/*!
+    \brief      write RECORD_NUM records one by one and flush the writer
+    \param[in]  seed: changes the values of the records
+    \param[out] none
+    \retval     none
+*/
+void write_records(uint32_t seed)
+{
+    record_struct record;
+    uint32_t i;
+
+    for(i = 0U; i < RECORD_NUM; i++){
+        record.id = (uint16_t)i;
+        record.value = (i * 0x9E3779B1U) ^ seed;
+        record.check = ~(record.id ^ record.value);
+        if(FMC_WRITER_OK != fmc_writer_write(&writer, WRITER_START + (i * sizeof(record)), (const uint8_t *)&record, sizeof(record))){
+            gd_eval_led_on(LED2);
+        }
+    }
+    if(FMC_WRITER_OK != fmc_writer_flush(&writer)){
+        gd_eval_led_on(LED2);
+    }
+}
+
+/*!
+    \brief      FMC writer callback, print the statistics of a page flushed
+    \param[in]  w: writer state
+    \param[in]  page: statistics of the page
+    \param[out] none
+    \retval     none
+*/
+void page_done(fmc_writer_struct *w, const fmc_writer_page_struct *page)
+{
+    (void)w;
+    printf("\r\n  page 0x%08x: %s, %d programs, %d skipped, crc 0x%08x, %d cycles, result %d",
+           (unsigned)page->page, (0U != page->erased) ? "erased" : "not erased", (int)page->programmed,
+           (int)page->skipped, (unsigned)page->crc, (int)page->cycles, (int)page->result);
+}
+
+/*!
+    \brief      configure the leds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void led_config(void)
+{
+    gd_eval_led_init(LED1);
+    gd_eval_led_init(LED2);
+}
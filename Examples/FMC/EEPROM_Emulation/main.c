@@ -0,0 +1,162 @@
+/*!
+    \file  main.c
+    \brief settings kept in the key-value store of the main flash
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_fmc_kv.h"
+
+#define KV_START                0x0801E000U                 /* first page of the store */
+#define KV_PAGES                8U                          /* pages of the store */
+#define KV_BUDGET               4U                          /* records copied per maintenance step */
+
+/* keys of the settings */
+#define KEY_BOOT_COUNT          0U                          /* number of resets */
+#define KEY_SETPOINT            1U                          /* value changed with KEY_A */
+#define KEY_NAME                2U                          /* text written on the first boot */
+#define KEY_NUM                 3U
+
+static uint32_t kv_index[KEY_NUM];
+static fmc_kv_struct kv;
+
+void led_config(void);
+uint32_t setting_get(uint32_t key);
+void setting_set(uint32_t key, uint32_t value);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    static const char name[] = "GD32VF103V-EVAL";
+    fmc_kv_parameter_struct init;
+    uint8_t text[32];
+    uint32_t len, setpoint;
+
+    led_config();
+    gd_eval_key_init(KEY_A, KEY_MODE_GPIO);
+    gd_eval_com_init(EVAL_COM0);
+    gd_eval_led_off(LED1);
+    gd_eval_led_off(LED2);
+
+    init.start = KV_START;
+    init.page_num = KV_PAGES;
+    init.index = kv_index;
+    init.key_num = KEY_NUM;
+    if(SUCCESS != fmc_kv_init(&kv, &init)){
+        printf("\r\n key-value store init failed \r\n");
+        gd_eval_led_on(LED2);
+        while(1){
+        }
+    }
+    if(0U != kv.torn){
+        printf("\r\n %d records cut by a reset were skipped", (int)kv.torn);
+    }
+
+    if(FMC_KV_OK != fmc_kv_read(&kv, KEY_NAME, text, sizeof(text) - 1U, &len)){
+        /* first boot */
+        len = 0U;
+        if(FMC_KV_OK == fmc_kv_write(&kv, KEY_NAME, (const uint8_t *)name, sizeof(name) - 1U)){
+            fmc_kv_read(&kv, KEY_NAME, text, sizeof(text) - 1U, &len);
+        }
+    }
+    text[(len < sizeof(text)) ? len : (sizeof(text) - 1U)] = '\0';
+    setting_set(KEY_BOOT_COUNT, setting_get(KEY_BOOT_COUNT) + 1U);
+    setpoint = setting_get(KEY_SETPOINT);
+    printf("\r\n %s: boot %d, setpoint %d \r\n", (char *)text, (int)setting_get(KEY_BOOT_COUNT), (int)setpoint);
+
+    while(1){
+        if(0 == gd_eval_key_state_get(KEY_A)){
+            setpoint++;
+            setting_set(KEY_SETPOINT, setpoint);
+            printf("\r\n setpoint %d, %d writes, %d copies, %d erases, %d erased pages",
+                   (int)setpoint, (int)kv.writes, (int)kv.copies, (int)kv.erases, (int)kv.erased);
+            while(0 == gd_eval_key_state_get(KEY_A)){
+            }
+        }else{
+            /* the loop is idle, a stall of one page erase does no harm here */
+            if(FMC_KV_FULL == fmc_kv_maintain(&kv, KV_BUDGET)){
+                gd_eval_led_on(LED2);
+            }
+        }
+    }
+}
+
+/*!
+    \brief      get a 32-bit setting, 0 when it was never written
+    \param[in]  key: key of the setting
+    \param[out] none
+    \retval     value of the setting
+*/
+uint32_t setting_get(uint32_t key)
+{
+    uint32_t value = 0U;
+    uint32_t len;
+
+    if((FMC_KV_OK != fmc_kv_read(&kv, key, (uint8_t *)&value, sizeof(value), &len)) || (sizeof(value) != len)){
+        value = 0U;
+    }
+    return value;
+}
+
+/*!
+    \brief      set a 32-bit setting, LED1 toggles on each record programmed
+    \param[in]  key: key of the setting
+    \param[in]  value: value of the setting
+    \param[out] none
+    \retval     none
+*/
+void setting_set(uint32_t key, uint32_t value)
+{
+    if(FMC_KV_OK != fmc_kv_write(&kv, key, (const uint8_t *)&value, sizeof(value))){
+        gd_eval_led_on(LED2);
+    }else{
+        gd_eval_led_toggle(LED1);
+    }
+}
+
+/*!
+    \brief      configure the leds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void led_config(void)
+{
+    gd_eval_led_init(LED1);
+    gd_eval_led_init(LED2);
+}
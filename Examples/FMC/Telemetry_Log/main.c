@@ -0,0 +1,184 @@
+/*!
+    \file  main.c
+    \brief telemetry records streamed into the flash log ring
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103.h"
+#include <stdio.h>
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_fmc_log.h"
+#include "n200_func.h"
+
+#define LOG_START               0x0801C000U                 /* first page of the log */
+#define LOG_PAGES               16U                         /* pages of the log */
+#define RING_WORDS              512U                        /* RAM ring, several page erases of records */
+#define SAMPLE_RATE             1000U                       /* records per second */
+
+/* telemetry record */
+typedef struct
+{
+    uint32_t loop;
+    uint16_t channel[4];
+}sample_struct;
+
+static uint32_t ring[RING_WORDS];
+fmc_log_struct flash_log;
+
+void led_config(void);
+void clic_config(void);
+void log_dump(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    fmc_log_parameter_struct init;
+    sample_struct sample;
+    uint32_t clock = rcu_clock_freq_get(CK_AHB);
+    uint32_t period = clock / SAMPLE_RATE;
+    uint32_t next, report, i;
+
+    led_config();
+    gd_eval_key_init(KEY_A, KEY_MODE_GPIO);
+    gd_eval_com_init(EVAL_COM0);
+    gd_eval_led_off(LED1);
+    gd_eval_led_off(LED2);
+    rcu_periph_clock_enable(RCU_CRC);
+    clic_config();
+
+    init.start = LOG_START;
+    init.page_num = LOG_PAGES;
+    init.buffer = ring;
+    init.size = RING_WORDS;
+    if(SUCCESS != fmc_log_init(&flash_log, &init)){
+        printf("\r\n flash log init failed \r\n");
+        gd_eval_led_on(LED2);
+        while(1){
+        }
+    }
+    printf("\r\n flash log: head page %d offset %d, next record %d, %d records cut by a reset \r\n",
+           (int)flash_log.page, (int)flash_log.offset, (int)flash_log.seq, (int)flash_log.torn);
+
+    sample.loop = 0U;
+    next = (uint32_t)get_cycle_value();
+    report = next;
+    while(1){
+        if(period <= ((uint32_t)get_cycle_value() - next)){
+            next += period;
+            for(i = 0U; i < 4U; i++){
+                sample.channel[i] = (uint16_t)((sample.loop * (i + 1U)) & 0x0FFFU);
+            }
+            /* returns at once, the FMC interrupt programs the record later */
+            if(FMC_LOG_OK != fmc_log_append(&flash_log, &sample, sizeof(sample))){
+                gd_eval_led_on(LED2);
+            }
+            sample.loop++;
+        }
+        if(clock <= ((uint32_t)get_cycle_value() - report)){
+            report += clock;
+            gd_eval_led_toggle(LED1);
+            printf("\r\n %d appended, %d written, %d dropped, %d erases, %d errors, ring peak %d words",
+                   (int)flash_log.appended, (int)flash_log.written, (int)flash_log.dropped,
+                   (int)flash_log.erases, (int)flash_log.errors, (int)flash_log.fill_max);
+        }
+        if(0 == gd_eval_key_state_get(KEY_A)){
+            log_dump();
+            while(0 == gd_eval_key_state_get(KEY_A)){
+            }
+        }
+    }
+}
+
+/*!
+    \brief      print the first and last records kept in the flash and the
+                records that failed their CRC
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void log_dump(void)
+{
+    fmc_log_cursor_struct cursor;
+    fmc_log_record_struct record, first;
+    fmc_log_result_enum result;
+    sample_struct sample;
+    uint32_t count = 0U;
+    uint32_t bad = 0U;
+
+    first.seq = 0U;
+    record.seq = 0U;
+    fmc_log_read_start(&flash_log, &cursor);
+    while(1){
+        result = fmc_log_read(&flash_log, &cursor, &record, (uint8_t *)&sample, sizeof(sample));
+        if(FMC_LOG_END == result){
+            break;
+        }
+        if(FMC_LOG_CRC == result){
+            bad++;
+            continue;
+        }
+        if(0U == count){
+            first = record;
+        }
+        count++;
+    }
+    printf("\r\n %d records from %d to %d, %d with a bad CRC \r\n", (int)count, (int)first.seq, (int)record.seq, (int)bad);
+}
+
+/*!
+    \brief      configure the leds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void led_config(void)
+{
+    gd_eval_led_init(LED1);
+    gd_eval_led_init(LED2);
+}
+
+/*!
+    \brief      configure the FMC interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void clic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_priority_group_set(ECLIC_PRIGROUP_LEVEL3_PRIO1);
+    eclic_irq_enable(FMC_IRQn, 1, 0);
+}
@@ -0,0 +1,91 @@
+/*!
+    \file  gd32vf103_it.c
+    \brief interrupt service routines
+    
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this 
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, 
+       this list of conditions and the following disclaimer in the documentation 
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors 
+       may be used to endorse or promote products derived from this software without 
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" 
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR 
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY 
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103_it.h"
+
+/*!
+    \brief      this function handles I2C0 event interrupt request exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void I2C0_EV_IRQHandler(void)
+{
+    i2c_bus_event_irq_handler(&i2c0_bus);
+}
+
+/*!
+    \brief      this function handles I2C0 error interrupt request exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void I2C0_ER_IRQHandler(void)
+{
+    i2c_bus_error_irq_handler(&i2c0_bus);
+}
+
+/*!
+    \brief      this function handles DMA0 channel 5 interrupt request exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DMA0_Channel5_IRQHandler(void)
+{
+    i2c_bus_dma_irq_handler(&i2c0_bus);
+}
+
+/*!
+    \brief      this function handles DMA0 channel 6 interrupt request exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DMA0_Channel6_IRQHandler(void)
+{
+    i2c_bus_dma_irq_handler(&i2c0_bus);
+}
+
+/*!
+    \brief      this function handles TIMER6 interrupt request exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void TIMER6_IRQHandler(void)
+{
+    i2c_bus_timer_irq_handler(&i2c0_bus);
+}
@@ -0,0 +1,205 @@
+/*!
+    \file  main.c
+    \brief I2C master transaction queue demo
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_i2c_bus.h"
+#include "gd32vf103_it.h"
+
+#define EEPROM_ADDRESS          0xA0U               /* 24C02 EEPROM on I2C0 */
+#define EEPROM_PAGE_SIZE        8U                  /* bytes written by one page write */
+#define I2C0_OWN_ADDRESS7       0x72U
+
+i2c_bus_struct i2c0_bus;
+i2c_xfer_struct *i2c0_slots[4];
+
+uint8_t page_write[1 + EEPROM_PAGE_SIZE];
+uint8_t page_read[EEPROM_PAGE_SIZE + EEPROM_PAGE_SIZE];
+uint8_t word_address = 0x00U;
+
+void rcu_config(void);
+void gpio_config(void);
+void i2c_config(void);
+void i2c_eclic_config(void);
+/* run a transaction and wait for its end */
+uint32_t i2c_xfer_run(i2c_xfer_struct *xfer);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    i2c_xfer_struct xfer;
+    uint32_t i;
+    uint32_t failed = 0U;
+
+    gd_eval_led_init(LED2);
+    gd_eval_led_init(LED3);
+    rcu_config();
+    gpio_config();
+    i2c_config();
+    i2c_eclic_config();
+
+    i2c_bus_init(&i2c0_bus, I2C0, i2c0_slots, 4U);
+    /* payloads from 8 bytes on are moved by DMA0 channel 5 and 6 */
+    i2c_bus_dma_config(&i2c0_bus, DMA0, 8U);
+    /* TIMER6 counts at 108 MHz, 270 ticks are one SCL period at 400 kHz */
+    i2c_bus_timer_config(&i2c0_bus, TIMER6, 270U);
+
+    /* page write: the word address followed by the data */
+    page_write[0] = word_address;
+    for(i = 0U; i < EEPROM_PAGE_SIZE; i++){
+        page_write[1U + i] = (uint8_t)(i + 0x30U);
+    }
+    i2c_xfer_prepare(&xfer, EEPROM_ADDRESS, page_write, sizeof(page_write), NULL, 0U, NULL);
+    failed |= (I2C_XFER_DONE != i2c_xfer_run(&xfer));
+
+    /* the EEPROM does not answer its address until the page is programmed */
+    i2c_xfer_prepare(&xfer, EEPROM_ADDRESS, NULL, 0U, NULL, 0U, NULL);
+    while(I2C_XFER_NACK == i2c_xfer_run(&xfer)){
+    }
+
+    /* read the page back with a one byte, a two byte and a five byte transaction */
+    i2c_xfer_prepare(&xfer, EEPROM_ADDRESS, &word_address, 1U, &page_read[0], 1U, NULL);
+    failed |= (I2C_XFER_DONE != i2c_xfer_run(&xfer));
+    i2c_xfer_prepare(&xfer, EEPROM_ADDRESS, NULL, 0U, &page_read[1], 2U, NULL);
+    failed |= (I2C_XFER_DONE != i2c_xfer_run(&xfer));
+    i2c_xfer_prepare(&xfer, EEPROM_ADDRESS, NULL, 0U, &page_read[3], 5U, NULL);
+    failed |= (I2C_XFER_DONE != i2c_xfer_run(&xfer));
+    /* and once more as a whole through the DMA */
+    i2c_xfer_prepare(&xfer, EEPROM_ADDRESS, &word_address, 1U, &page_read[EEPROM_PAGE_SIZE], EEPROM_PAGE_SIZE, NULL);
+    failed |= (I2C_XFER_DONE != i2c_xfer_run(&xfer));
+
+    for(i = 0U; i < EEPROM_PAGE_SIZE; i++){
+        if((page_write[1U + i] != page_read[i]) || (page_write[1U + i] != page_read[EEPROM_PAGE_SIZE + i])){
+            failed = 1U;
+        }
+    }
+    if(0U == failed){
+        /* if success, LED2 and LED3 are on */
+        gd_eval_led_on(LED2);
+        gd_eval_led_on(LED3);
+    }else{
+        gd_eval_led_off(LED2);
+        gd_eval_led_off(LED3);
+    }
+
+    while(1){
+    }
+}
+
+/*!
+    \brief      run a transaction and wait for its end, the CPU is free for
+                other work while the transaction is on the bus
+    \param[in]  xfer: transaction prepared by i2c_xfer_prepare
+    \param[out] none
+    \retval     I2C_XFER_DONE, I2C_XFER_NACK or I2C_XFER_ERROR
+*/
+uint32_t i2c_xfer_run(i2c_xfer_struct *xfer)
+{
+    if(SUCCESS != i2c_bus_submit(&i2c0_bus, xfer)){
+        return I2C_XFER_ERROR;
+    }
+    /* a transaction held back by the STOP of the previous one is started by TIMER6 */
+    while((I2C_XFER_QUEUED == xfer->status) || (I2C_XFER_ACTIVE == xfer->status)){
+    }
+    return xfer->status;
+}
+
+/*!
+    \brief      enable the peripheral clock
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void rcu_config(void)
+{
+    /* enable GPIOB clock */
+    rcu_periph_clock_enable(RCU_GPIOB);
+    /* enable I2C0 clock */
+    rcu_periph_clock_enable(RCU_I2C0);
+    /* enable DMA0 clock */
+    rcu_periph_clock_enable(RCU_DMA0);
+    /* enable TIMER6 clock */
+    rcu_periph_clock_enable(RCU_TIMER6);
+}
+
+/*!
+    \brief      cofigure the GPIO ports
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gpio_config(void)
+{
+    /* connect PB6 to I2C0_SCL */
+    /* connect PB7 to I2C0_SDA */
+    gpio_init(GPIOB, GPIO_MODE_AF_OD, GPIO_OSPEED_50MHZ, GPIO_PIN_6 | GPIO_PIN_7);
+}
+
+/*!
+    \brief      cofigure the I2C0 interface
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2c_config(void)
+{
+    /* I2C clock configure */
+    i2c_clock_config(I2C0, 400000, I2C_DTCY_2);
+    /* I2C address configure */
+    i2c_mode_addr_config(I2C0, I2C_I2CMODE_ENABLE, I2C_ADDFORMAT_7BITS, I2C0_OWN_ADDRESS7);
+    /* enable I2C0 */
+    i2c_enable(I2C0);
+}
+
+/*!
+    \brief      cofigure the ECLIC
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2c_eclic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_irq_enable(I2C0_EV_IRQn, 1, 0);
+    eclic_irq_enable(I2C0_ER_IRQn, 1, 0);
+    eclic_irq_enable(DMA0_Channel5_IRQn, 1, 0);
+    eclic_irq_enable(DMA0_Channel6_IRQn, 1, 0);
+    eclic_irq_enable(TIMER6_IRQn, 1, 0);
+}
@@ -0,0 +1,214 @@
+/*!
+    \file  main.c
+    \brief I2S double-buffered stream demo
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_i2s_stream.h"
+#include "gd32vf103_it.h"
+
+#define STREAM_SIZE         256U                /* words of both halves */
+#define STREAM_HALVES       400U                /* halves to receive before checking */
+
+i2s_stream_struct tx_stream;
+i2s_stream_struct rx_stream;
+uint16_t tx_buffer[STREAM_SIZE];
+uint16_t rx_buffer[STREAM_SIZE];
+uint16_t tx_next = 0U;
+uint16_t rx_next = 0U;
+uint32_t rx_started = 0U;
+volatile uint32_t rx_errors = 0U;
+
+void rcu_config(void);
+void gpio_config(void);
+void i2s_eclic_config(void);
+/* stream callbacks, called from the DMA interrupts */
+uint32_t tx_fill(i2s_stream_struct *stream, uint16_t *data, uint32_t len);
+uint32_t rx_take(i2s_stream_struct *stream, uint16_t *data, uint32_t len);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    i2s_stream_parameter_struct init_struct;
+
+    /* initialize the LED */
+    gd_eval_led_init(LED2);
+
+    rcu_config();
+    gpio_config();
+    i2s_eclic_config();
+
+    /* I2S2 slave receives what I2S1 master sends, 16 bit frames at 44.1 kHz */
+    init_struct.spi_periph = SPI2;
+    init_struct.mode = I2S_MODE_SLAVERX;
+    init_struct.standard = I2S_STD_PHILLIPS;
+    init_struct.ckpl = I2S_CKPL_LOW;
+    init_struct.audiosample = I2S_AUDIOSAMPLE_44K;
+    init_struct.frameformat = I2S_FRAMEFORMAT_DT16B_CH16B;
+    init_struct.mckout = I2S_MCKOUT_DISABLE;
+    init_struct.buffer = rx_buffer;
+    init_struct.size = STREAM_SIZE;
+    init_struct.callback = rx_take;
+    init_struct.user_data = NULL;
+    i2s_stream_init(&rx_stream, &init_struct);
+
+    init_struct.spi_periph = SPI1;
+    init_struct.mode = I2S_MODE_MASTERTX;
+    init_struct.buffer = tx_buffer;
+    init_struct.callback = tx_fill;
+    i2s_stream_init(&tx_stream, &init_struct);
+
+    /* the slave listens before the master drives the clock */
+    i2s_stream_start(&rx_stream);
+    i2s_stream_start(&tx_stream);
+
+    /* the CPU is free, the halves are refilled and taken in the DMA interrupts */
+    while(rx_stream.halves < STREAM_HALVES){
+    }
+    i2s_stream_stop(&tx_stream);
+    i2s_stream_stop(&rx_stream);
+
+    /* every word arrived in order and no half was late */
+    if((0U == rx_errors) && (0U == tx_stream.underrun) && (0U == rx_stream.overrun)){
+        gd_eval_led_on(LED2);
+    }else{
+        gd_eval_led_off(LED2);
+    }
+
+    while(1){
+    }
+}
+
+/*!
+    \brief      transmit callback, sends a counter
+    \param[in]  stream: I2S stream
+    \param[in]  len: number of words to fill
+    \param[out] data: half to fill
+    \retval     number of words filled
+*/
+uint32_t tx_fill(i2s_stream_struct *stream, uint16_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    for(i = 0U; i < len; i++){
+        data[i] = tx_next++;
+    }
+    return len;
+}
+
+/*!
+    \brief      receive callback, checks that the counter goes on without a jump
+    \param[in]  stream: I2S stream
+    \param[in]  data: received half
+    \param[in]  len: number of words
+    \param[out] none
+    \retval     number of words taken
+*/
+uint32_t rx_take(i2s_stream_struct *stream, uint16_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    for(i = 0U; i < len; i++){
+        if(0U == rx_started){
+            /* the first word sets where the counter is */
+            rx_next = data[i];
+            rx_started = 1U;
+        }
+        if(rx_next != data[i]){
+            rx_errors++;
+        }
+        rx_next = (uint16_t)(data[i] + 1U);
+    }
+    return len;
+}
+
+/*!
+    \brief      configure different peripheral clocks
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void rcu_config(void)
+{
+    rcu_pll2_config(RCU_PLL2_MUL8);
+    rcu_osci_on(RCU_PLL2_CK);
+    while((RCU_CTL & RCU_CTL_PLL2STB) == 0){
+    }
+    rcu_i2s1_clock_config(RCU_I2S1SRC_CKPLL2_MUL2);
+    rcu_i2s2_clock_config(RCU_I2S2SRC_CKPLL2_MUL2);
+
+    rcu_periph_clock_enable(RCU_SPI1);
+    rcu_periph_clock_enable(RCU_SPI2);
+    rcu_periph_clock_enable(RCU_GPIOA);
+    rcu_periph_clock_enable(RCU_GPIOB);
+    rcu_periph_clock_enable(RCU_GPIOC);
+    rcu_periph_clock_enable(RCU_AF);
+    rcu_periph_clock_enable(RCU_DMA0);
+    rcu_periph_clock_enable(RCU_DMA1);
+}
+
+/*!
+    \brief      configure the GPIO peripheral
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gpio_config(void)
+{
+    /* I2S1 GPIO config: I2S1_WS/PB12, I2S1_CK/PB13, I2S_SD/PB15 */
+    gpio_init(GPIOB, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_12 | GPIO_PIN_13 | GPIO_PIN_15);
+
+    /* I2S2 GPIO config: I2S2_WS/PA4, I2S2_CK/PC10, I2S2_SD/PC12 */
+    gpio_pin_remap_config(GPIO_SPI2_REMAP, ENABLE);
+    gpio_init(GPIOC, GPIO_MODE_IN_FLOATING, GPIO_OSPEED_50MHZ, GPIO_PIN_10 | GPIO_PIN_12);
+    gpio_init(GPIOA, GPIO_MODE_IN_FLOATING, GPIO_OSPEED_50MHZ, GPIO_PIN_4);
+}
+
+/*!
+    \brief      configure the ECLIC
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_eclic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_irq_enable(DMA0_Channel4_IRQn, 1, 0);
+    eclic_irq_enable(DMA1_Channel0_IRQn, 1, 0);
+}
@@ -0,0 +1,7 @@
+#ifndef FATTIME_H_
+
+#include "integer.h"
+
+DWORD get_fattime (void);
+
+#endif
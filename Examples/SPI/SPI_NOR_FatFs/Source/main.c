@@ -0,0 +1,215 @@
+/*!
+    \file  main.c
+    \brief FatFs on a SPI NOR flash demo
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103.h"
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_spi_nor.h"
+#include "gd32vf103_it.h"
+#include "ff.h"
+#include <string.h>
+
+#define FILE_SIZE               8192U
+#define CLUSTER_SIZE            4096U               /* one erase sector per cluster */
+
+spi_bus_struct spi0_bus;
+spi_xfer_struct *spi0_slots[8];
+spi_device_struct flash_device;
+spi_nor_struct spi_flash;
+uint8_t flash_cache[SPI_NOR_CACHE_LINES * 512U];
+
+FATFS fatfs;
+FIL file;
+uint8_t file_buffer[512];
+
+void rcu_config(void);
+void gpio_config(void);
+void spi_eclic_config(void);
+/* write a file on the flash and read it back */
+ErrStatus file_check(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    spi_parameter_struct spi_init_struct;
+    ErrStatus status = ERROR;
+
+    gd_eval_led_init(LED2);
+    gd_eval_led_init(LED3);
+    rcu_config();
+    gpio_config();
+    spi_eclic_config();
+
+    /* the flash runs in mode 0 at PCLK2/4 with 8 bit frames */
+    spi_struct_para_init(&spi_init_struct);
+    spi_init_struct.frame_size = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.endian = SPI_ENDIAN_MSB;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE;
+    spi_init_struct.prescale = SPI_PSC_4;
+    spi_device_init(&flash_device, &spi_init_struct, GPIOE, GPIO_PIN_3);
+
+    spi_bus_init(&spi0_bus, SPI0, spi0_slots, 8U);
+    spi_bus_dma_config(&spi0_bus, SPI_BUS_DMA_THRESHOLD);
+
+    /* FatFs reads 512 byte sectors, one cache line each */
+    if(SUCCESS == spi_nor_init(&spi_flash, &spi0_bus, &flash_device, flash_cache, 512U)){
+        /* TIMER6 counts at 108 MHz, a busy flash is asked again every 50 us */
+        spi_nor_timer_config(&spi_flash, TIMER6, 5400U);
+        f_mount(0, &fatfs);
+        status = file_check();
+        f_mount(0, NULL);
+    }
+
+    if(SUCCESS == status){
+        /* if success, LED2 and LED3 are on */
+        gd_eval_led_on(LED2);
+        gd_eval_led_on(LED3);
+    }else{
+        gd_eval_led_off(LED2);
+        gd_eval_led_off(LED3);
+    }
+
+    while(1){
+    }
+}
+
+/*!
+    \brief      write a file on the flash and read it back, formats the flash if it holds no volume
+    \param[in]  none
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus file_check(void)
+{
+    FRESULT res;
+    UINT count;
+    uint32_t offset, i;
+
+    res = f_open(&file, "0:GD32.TXT", FA_CREATE_ALWAYS | FA_WRITE);
+    if(FR_NO_FILESYSTEM == res){
+        if(FR_OK != f_mkfs(0, 1, CLUSTER_SIZE)){
+            return ERROR;
+        }
+        res = f_open(&file, "0:GD32.TXT", FA_CREATE_ALWAYS | FA_WRITE);
+    }
+    if(FR_OK != res){
+        return ERROR;
+    }
+
+    /* the sectors of one erase sector are gathered by the disk interface,
+       so the flash is erased at most once per 4 KB */
+    for(offset = 0U; offset < FILE_SIZE; offset += sizeof(file_buffer)){
+        for(i = 0U; i < sizeof(file_buffer); i++){
+            file_buffer[i] = (uint8_t)(offset + i + (offset >> 9));
+        }
+        if((FR_OK != f_write(&file, file_buffer, sizeof(file_buffer), &count)) || (sizeof(file_buffer) != count)){
+            f_close(&file);
+            return ERROR;
+        }
+    }
+    if(FR_OK != f_close(&file)){
+        return ERROR;
+    }
+
+    if(FR_OK != f_open(&file, "0:GD32.TXT", FA_OPEN_EXISTING | FA_READ)){
+        return ERROR;
+    }
+    for(offset = 0U; offset < FILE_SIZE; offset += sizeof(file_buffer)){
+        if((FR_OK != f_read(&file, file_buffer, sizeof(file_buffer), &count)) || (sizeof(file_buffer) != count)){
+            f_close(&file);
+            return ERROR;
+        }
+        for(i = 0U; i < sizeof(file_buffer); i++){
+            if((uint8_t)(offset + i + (offset >> 9)) != file_buffer[i]){
+                f_close(&file);
+                return ERROR;
+            }
+        }
+    }
+    f_close(&file);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      enable the peripheral clock
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void rcu_config(void)
+{
+    /* enable GPIOA and GPIOE clock */
+    rcu_periph_clock_enable(RCU_GPIOA);
+    rcu_periph_clock_enable(RCU_GPIOE);
+    /* enable SPI0 clock */
+    rcu_periph_clock_enable(RCU_SPI0);
+    /* enable DMA0 clock */
+    rcu_periph_clock_enable(RCU_DMA0);
+    /* enable TIMER6 clock */
+    rcu_periph_clock_enable(RCU_TIMER6);
+}
+
+/*!
+    \brief      cofigure the GPIO ports, the chip select is set up by spi_device_init
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gpio_config(void)
+{
+    /* SPI0 GPIO config: SCK/PA5, MISO/PA6, MOSI/PA7 */
+    gpio_init(GPIOA, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_5 | GPIO_PIN_7);
+    gpio_init(GPIOA, GPIO_MODE_IN_FLOATING, GPIO_OSPEED_50MHZ, GPIO_PIN_6);
+}
+
+/*!
+    \brief      cofigure the ECLIC
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_eclic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_irq_enable(DMA0_Channel1_IRQn, 1, 0);
+    eclic_irq_enable(DMA0_Channel2_IRQn, 1, 0);
+    /* the timer submits to the SPI queue as the DMA interrupts do, so it runs at their level */
+    eclic_irq_enable(TIMER6_IRQn, 1, 0);
+}
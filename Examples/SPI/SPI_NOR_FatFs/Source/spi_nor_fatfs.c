@@ -0,0 +1,313 @@
+/*!
+    \file  spi_nor_fatfs.c
+    \brief FatFs disk interface on the SPI NOR flash driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "diskio.h"
+#include "gd32vf103_spi_nor.h"
+#include <string.h>
+
+/*
+    FatFs sees 512 byte sectors, so even the 2 MB of a GD25Q16 are enough for
+    f_mkfs. The flash erases 4 KB at a time, so the written sectors are gathered
+    in a copy of their erase sector and put back by flush_erase_sector() when a
+    sector of another erase sector is written or on CTRL_SYNC. A write that only
+    clears bits, as into a freshly erased area, needs no erase: only its pages
+    are programmed again.
+*/
+
+#define DISK_SECTOR_SIZE        512U
+#define DISK_SECTORS_PER_ERASE  (SPI_NOR_SECTOR_SIZE / DISK_SECTOR_SIZE)
+
+static volatile DSTATUS state = STA_NOINIT; /* disk status */
+
+static uint8_t erase_buffer[SPI_NOR_SECTOR_SIZE];   /* copy of the erase sector being written */
+static uint32_t erase_addr = SPI_NOR_CACHE_INVALID; /* flash address of erase_buffer */
+static uint32_t dirty_pages = 0U;                   /* pages of erase_buffer not in the flash yet */
+static uint32_t erase_needed = 0U;                  /* a write set bits the flash has cleared */
+
+extern spi_nor_struct spi_flash;
+
+static DRESULT flush_erase_sector(void);
+
+/*!
+    \brief      initialize the disk drive
+    \param[in]  drv: physical drive number (0)
+    \param[out] none
+    \retval     operation status
+*/
+DSTATUS disk_initialize (BYTE drv)
+{
+    /* the flash is identified by spi_nor_init() before the volume is mounted */
+    if (drv) {
+        return STA_NOINIT;
+    }
+
+    if (0U != spi_flash.capacity) {
+        state &= ~STA_NOINIT;
+    }
+
+    return state;
+}
+
+/*!
+    \brief      get disk status
+    \param[in]  drv: physical drive number (0)
+    \param[out] none
+    \retval     operation status
+*/
+DSTATUS disk_status (BYTE drv)
+{
+    if (drv) {
+        return STA_NOINIT; /* supports only single drive */
+    }
+
+    return state;
+}
+
+/*!
+    \brief      read sectors
+    \param[in]  drv: physical drive number (0)
+    \param[in]  buff: pointer to the data buffer to store read data
+    \param[in]  sector: start sector number (LBA)
+    \param[in]  count: sector count (1..255)
+    \param[out] none
+    \retval     operation status
+*/
+DRESULT disk_read (BYTE drv, 
+                   BYTE *buff, 
+                   DWORD sector, 
+                   BYTE count)
+{
+    uint32_t addr = sector * DISK_SECTOR_SIZE;
+
+    if (drv || !count) {
+        return RES_PARERR;
+    }
+
+    if (state & STA_NOINIT) {
+        return RES_NOTRDY;
+    }
+
+    while (count--) {
+        if ((addr & ~(SPI_NOR_SECTOR_SIZE - 1U)) == erase_addr) {
+            /* the copy is newer than the flash */
+            memcpy(buff, &erase_buffer[addr & (SPI_NOR_SECTOR_SIZE - 1U)], DISK_SECTOR_SIZE);
+        } else if (SUCCESS != spi_nor_read(&spi_flash, addr, buff, DISK_SECTOR_SIZE)) {
+            return RES_ERROR;
+        }
+
+        buff += DISK_SECTOR_SIZE;
+        addr += DISK_SECTOR_SIZE;
+    }
+
+    return RES_OK;
+}
+
+#if _READONLY == 0
+
+/*!
+    \brief      write sectors
+    \param[in]  drv: physical drive number (0)
+    \param[in]  buff: pointer to the data to be written
+    \param[in]  sector: start sector number (LBA)
+    \param[in]  count: sector count (1..255)
+    \param[out] none
+    \retval     operation status
+*/
+DRESULT disk_write (BYTE drv, 
+                    const BYTE *buff, 
+                    DWORD sector, 
+                    BYTE count)
+{
+    uint32_t addr = sector * DISK_SECTOR_SIZE;
+    uint32_t base, offset, i;
+    DRESULT res;
+
+    if (drv || !count) {
+        return RES_PARERR;
+    }
+
+    if (state & STA_NOINIT) {
+        return RES_NOTRDY;
+    }
+
+    if (state & STA_PROTECT) {
+        return RES_WRPRT;
+    }
+
+    while (count--) {
+        base = addr & ~(SPI_NOR_SECTOR_SIZE - 1U);
+        offset = addr - base;
+
+        if (base != erase_addr) {
+            /* put the previous erase sector back and load the one of this sector */
+            res = flush_erase_sector();
+            if (RES_OK != res) {
+                return res;
+            }
+            erase_addr = SPI_NOR_CACHE_INVALID;
+            if (SUCCESS != spi_nor_read(&spi_flash, base, erase_buffer, SPI_NOR_SECTOR_SIZE)) {
+                return RES_ERROR;
+            }
+            erase_addr = base;
+        }
+
+        for (i = 0U; i < DISK_SECTOR_SIZE; i++) {
+            if ((erase_buffer[offset + i] & buff[i]) != buff[i]) {
+                erase_needed = 1U;
+            }
+        }
+        memcpy(&erase_buffer[offset], buff, DISK_SECTOR_SIZE);
+        dirty_pages |= ((1U << (DISK_SECTOR_SIZE / SPI_NOR_PAGE_SIZE)) - 1U) << (offset / SPI_NOR_PAGE_SIZE);
+
+        buff += DISK_SECTOR_SIZE;
+        addr += DISK_SECTOR_SIZE;
+    }
+
+    return RES_OK;
+}
+
+#endif /* _READONLY == 0 */
+
+/*!
+    \brief      write the gathered erase sector back to the flash
+    \param[in]  none
+    \param[out] none
+    \retval     operation status
+*/
+static DRESULT flush_erase_sector(void)
+{
+    uint32_t page, run;
+
+    if (0U == dirty_pages) {
+        return RES_OK;
+    }
+
+    if (erase_needed) {
+        if ((SUCCESS != spi_nor_erase_start(&spi_flash, erase_addr, SPI_NOR_SECTOR_SIZE)) ||
+            (SPI_NOR_READY != spi_nor_wait(&spi_flash))) {
+            return RES_ERROR;
+        }
+        /* every page holding a cleared bit has to be programmed again */
+        dirty_pages = 0U;
+        for (page = 0U; page < (SPI_NOR_SECTOR_SIZE / SPI_NOR_PAGE_SIZE); page++) {
+            for (run = 0U; run < SPI_NOR_PAGE_SIZE; run++) {
+                if (0xFFU != erase_buffer[(page * SPI_NOR_PAGE_SIZE) + run]) {
+                    dirty_pages |= 1U << page;
+                    break;
+                }
+            }
+        }
+        erase_needed = 0U;
+    }
+
+    /* program each run of dirty pages in one operation */
+    page = 0U;
+    while (0U != dirty_pages) {
+        while (0U == (dirty_pages & (1U << page))) {
+            page++;
+        }
+        run = 0U;
+        while (dirty_pages & (1U << (page + run))) {
+            dirty_pages &= ~(1U << (page + run));
+            run++;
+        }
+        if ((SUCCESS != spi_nor_program_start(&spi_flash, erase_addr + (page * SPI_NOR_PAGE_SIZE),
+                                              &erase_buffer[page * SPI_NOR_PAGE_SIZE], run * SPI_NOR_PAGE_SIZE)) ||
+            (SPI_NOR_READY != spi_nor_wait(&spi_flash))) {
+            erase_addr = SPI_NOR_CACHE_INVALID;
+            return RES_ERROR;
+        }
+        page += run;
+    }
+
+    return RES_OK;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Miscellaneous Functions                                               */
+/*-----------------------------------------------------------------------*/
+
+#if _USE_IOCTL != 0
+
+/*!
+    \brief      I/O control function
+    \param[in]  drv: physical drive number (0)
+    \param[in]  ctrl: control code
+    \param[in]  buff: pointer to the data buffer to store read data
+    \param[out] none
+    \retval     operation status
+*/
+DRESULT disk_ioctl (BYTE drv, 
+                    BYTE ctrl, 
+                    void *buff)
+{
+    DRESULT res;
+
+    if (drv) {
+        return RES_PARERR;
+    }
+
+    if (state & STA_NOINIT) {
+        return RES_NOTRDY;
+    }
+
+    switch (ctrl) {
+    case CTRL_SYNC:         /* make sure that no pending write process */
+        res = flush_erase_sector();
+        break;
+
+    case GET_SECTOR_COUNT:  /* get number of sectors on the disk (dword) */
+        *(DWORD*)buff = (DWORD)(spi_flash.capacity / DISK_SECTOR_SIZE);
+        res = RES_OK;
+        break;
+
+    case GET_SECTOR_SIZE:  /* get r/w sector size (word) */
+        *(WORD*)buff = DISK_SECTOR_SIZE;
+        res = RES_OK;
+        break;
+
+    case GET_BLOCK_SIZE:   /* get erase block size in unit of sector (dword) */
+        *(DWORD*)buff = DISK_SECTORS_PER_ERASE;
+        res = RES_OK;
+        break;
+
+    default:
+        res = RES_PARERR;
+        break;
+    }
+
+    return res;
+}
+#endif /* _USE_IOCTL != 0 */
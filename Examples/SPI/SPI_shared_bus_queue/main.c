@@ -0,0 +1,181 @@
+/*!
+    \file  main.c
+    \brief SPI shared bus queue demo
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103.h"
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_spi_bus.h"
+#include "gd32vf103_it.h"
+
+#define FLASH_CMD_READ_ID       0x9FU               /* JEDEC ID of the SPI NOR flash */
+#define FLASH_CMD_READ          0x03U               /* read data */
+#define FLASH_ID_GD25Q16        0xC84015U           /* manufacturer and device ID of the GD25Q16 */
+#define FLASH_READ_SIZE         256U
+
+spi_bus_struct spi0_bus;
+spi_xfer_struct *spi0_slots[8];
+spi_device_struct flash_device;
+spi_device_struct adc_device;
+
+uint8_t flash_id_cmd[4] = {FLASH_CMD_READ_ID, 0xFFU, 0xFFU, 0xFFU};
+uint8_t flash_id[4];
+uint8_t flash_read_cmd[4] = {FLASH_CMD_READ, 0x00U, 0x00U, 0x00U};
+uint8_t flash_data[FLASH_READ_SIZE];
+uint16_t adc_cmd[4] = {0x8300U, 0x8700U, 0x8B00U, 0x8F00U};
+uint16_t adc_sample[4];
+volatile uint32_t flash_read_done = 0U;
+
+void rcu_config(void);
+void gpio_config(void);
+void spi_eclic_config(void);
+/* callback of the last flash transaction */
+void flash_read_end(spi_xfer_struct *xfer);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    spi_parameter_struct spi_init_struct;
+    spi_xfer_struct xfer[4];
+    uint32_t id;
+
+    gd_eval_led_init(LED2);
+    gd_eval_led_init(LED3);
+    rcu_config();
+    gpio_config();
+    spi_eclic_config();
+
+    /* the flash runs in mode 0 at PCLK2/4 with 8 bit frames */
+    spi_struct_para_init(&spi_init_struct);
+    spi_init_struct.frame_size = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.endian = SPI_ENDIAN_MSB;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE;
+    spi_init_struct.prescale = SPI_PSC_4;
+    spi_device_init(&flash_device, &spi_init_struct, GPIOE, GPIO_PIN_3);
+    /* the ADC runs in mode 3 at PCLK2/32 with 16 bit frames */
+    spi_init_struct.frame_size = SPI_FRAMESIZE_16BIT;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_HIGH_PH_2EDGE;
+    spi_init_struct.prescale = SPI_PSC_32;
+    spi_device_init(&adc_device, &spi_init_struct, GPIOE, GPIO_PIN_4);
+
+    spi_bus_init(&spi0_bus, SPI0, spi0_slots, 8U);
+    /* transactions from 16 frames on are moved by DMA0 channel 1 and 2 */
+    spi_bus_dma_config(&spi0_bus, 16U);
+
+    /* the ID read and the read command are polled, the data phase goes through the DMA
+       with the chip select still low; the ADC conversions are queued in between and
+       run when the bus gets free, with the SPI switched to the ADC mode and back */
+    spi_xfer_prepare(&xfer[0], &flash_device, flash_id_cmd, flash_id, 4U, 0U, NULL);
+    spi_xfer_prepare(&xfer[1], &flash_device, flash_read_cmd, NULL, 4U, SPI_XFER_CS_KEEP, NULL);
+    spi_xfer_prepare(&xfer[2], &flash_device, NULL, flash_data, FLASH_READ_SIZE, 0U, flash_read_end);
+    spi_xfer_prepare(&xfer[3], &adc_device, adc_cmd, adc_sample, 4U, 0U, NULL);
+    spi_bus_submit(&spi0_bus, &xfer[0]);
+    spi_bus_submit(&spi0_bus, &xfer[1]);
+    spi_bus_submit(&spi0_bus, &xfer[2]);
+    spi_bus_submit(&spi0_bus, &xfer[3]);
+
+    /* the CPU is free while the data phase runs */
+    while(0U != spi_bus_pending_get(&spi0_bus)){
+    }
+
+    id = ((uint32_t)flash_id[1] << 16) | ((uint32_t)flash_id[2] << 8) | flash_id[3];
+    if((FLASH_ID_GD25Q16 == id) && (0U != flash_read_done)){
+        /* if success, LED2 and LED3 are on */
+        gd_eval_led_on(LED2);
+        gd_eval_led_on(LED3);
+    }else{
+        gd_eval_led_off(LED2);
+        gd_eval_led_off(LED3);
+    }
+
+    while(1){
+    }
+}
+
+/*!
+    \brief      callback of the last flash transaction, called from the DMA interrupt
+    \param[in]  xfer: finished transaction
+    \param[out] none
+    \retval     none
+*/
+void flash_read_end(spi_xfer_struct *xfer)
+{
+    flash_read_done = (SPI_XFER_DONE == xfer->status) ? 1U : 0U;
+}
+
+/*!
+    \brief      enable the peripheral clock
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void rcu_config(void)
+{
+    /* enable GPIOA and GPIOE clock */
+    rcu_periph_clock_enable(RCU_GPIOA);
+    rcu_periph_clock_enable(RCU_GPIOE);
+    /* enable SPI0 clock */
+    rcu_periph_clock_enable(RCU_SPI0);
+    /* enable DMA0 clock */
+    rcu_periph_clock_enable(RCU_DMA0);
+}
+
+/*!
+    \brief      cofigure the GPIO ports, the chip selects are set up by spi_device_init
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gpio_config(void)
+{
+    /* SPI0 GPIO config: SCK/PA5, MISO/PA6, MOSI/PA7 */
+    gpio_init(GPIOA, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_5 | GPIO_PIN_7);
+    gpio_init(GPIOA, GPIO_MODE_IN_FLOATING, GPIO_OSPEED_50MHZ, GPIO_PIN_6);
+}
+
+/*!
+    \brief      cofigure the ECLIC
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_eclic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_irq_enable(DMA0_Channel1_IRQn, 1, 0);
+    eclic_irq_enable(DMA0_Channel2_IRQn, 1, 0);
+}
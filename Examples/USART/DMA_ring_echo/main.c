@@ -0,0 +1,111 @@
+/*!
+    \file  main.c
+    \brief USART0 echo through the DMA rings
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103.h"
+#include "gd32vf103v_eval.h"
+#include "gd32vf103_usart_ring.h"
+
+#define TX_RING_SIZE            256U
+#define RX_RING_SIZE            256U
+
+static uint8_t tx_ring[TX_RING_SIZE];
+static uint8_t rx_ring[RX_RING_SIZE];
+static const uint8_t banner[] = "\n\rUSART DMA ring echo example, type some text:\n\r";
+usart_ring_struct com_ring;
+
+void clic_config(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+int main(void)
+{
+    usart_ring_parameter_struct ring_init_struct;
+    uint32_t overrun = 0U;
+    uint32_t len, done, sent;
+    uint8_t *span;
+
+    gd_eval_led_init(LED2);
+    gd_eval_led_off(LED2);
+    rcu_periph_clock_enable(RCU_DMA0);
+    gd_eval_com_init(EVAL_COM0);
+    clic_config();
+
+    ring_init_struct.usart_periph = EVAL_COM0;
+    ring_init_struct.dma_periph = DMA0;
+    ring_init_struct.tx_channel = DMA_CH3;
+    ring_init_struct.rx_channel = DMA_CH4;
+    ring_init_struct.tx_buffer = tx_ring;
+    ring_init_struct.tx_size = TX_RING_SIZE;
+    ring_init_struct.rx_buffer = rx_ring;
+    ring_init_struct.rx_size = RX_RING_SIZE;
+    usart_ring_init(&com_ring, &ring_init_struct);
+
+    usart_ring_write(&com_ring, banner, sizeof(banner) - 1U);
+    while(1){
+        /* echo straight from the RX ring, the span ends at the wrap of the ring */
+        len = usart_ring_rx_span_get(&com_ring, &span);
+        if(0U != len){
+            done = 0U;
+            while(done < len){
+                sent = usart_ring_write(&com_ring, &span[done], len - done);
+                done += sent;
+            }
+            usart_ring_rx_span_release(&com_ring, len);
+        }
+        /* the DMA overtook the echo, some input was lost */
+        if(overrun != com_ring.rx_overrun){
+            overrun = com_ring.rx_overrun;
+            gd_eval_led_toggle(LED2);
+        }
+    }
+}
+
+/*!
+    \brief      configure the USART0 and DMA0 interrupts
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void clic_config(void)
+{
+    eclic_global_interrupt_enable();
+    eclic_priority_group_set(ECLIC_PRIGROUP_LEVEL3_PRIO1);
+    eclic_irq_enable(USART0_IRQn, 1, 0);
+    eclic_irq_enable(DMA0_Channel3_IRQn, 1, 0);
+    eclic_irq_enable(DMA0_Channel4_IRQn, 1, 0);
+}
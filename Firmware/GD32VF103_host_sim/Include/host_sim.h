@@ -0,0 +1,211 @@
+/*!
+    \file  host_sim.h
+    \brief definitions for the host-side register model simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include "gd32vf103.h"
+
+/*
+    The simulator maps the peripheral address windows of the GD32VF103 at their
+    real addresses inside a non-PIE Linux process and keeps them inaccessible.
+    Every REG32/REG16/REG8 access made by the drivers faults, is serviced by the
+    register model of the addressed peripheral and is then single-stepped, so the
+    unmodified library sources run on the host. One register access is one bus
+    tick, which is the time base of all the models.
+
+    The main flash is mapped the same way behind the FMC model, erased at the
+    reset. Only the word an instruction faults on is presented, so the flash is
+    read with REG32 or REG16, never with memcpy() or wider loads.
+*/
+
+/* constants definitions */
+#define HOST_SIM_IRQ_STORM_LIMIT        1024U                       /*!< handler calls after which host_sim_irq_dispatch gives up */
+#define HOST_SIM_DMA_M2M_BURST          4U                          /*!< memory to memory items moved by a DMA channel per bus tick */
+#define HOST_SIM_USART_FIFO_SIZE        4096U                       /*!< depth of the injected RX and captured TX byte streams */
+#define HOST_SIM_USART_FRAME_TICKS      8U                          /*!< default bus ticks needed to shift one USART frame */
+#define HOST_SIM_I2C_BYTE_TICKS         9U                          /*!< default bus ticks needed to shift one I2C byte and its ACK */
+#define HOST_SIM_SPI_FRAME_TICKS        8U                          /*!< default bus ticks needed to exchange one SPI frame */
+#define HOST_SIM_SPI_SLAVE_NUM          4U                          /*!< slaves that can be attached to one SPI */
+#define HOST_SIM_SPI_NOR_PROGRAM_TICKS  400U                        /*!< bus ticks a page program keeps a simulated SPI NOR flash busy */
+#define HOST_SIM_SPI_NOR_ERASE_TICKS    4000U                       /*!< bus ticks an erase keeps a simulated SPI NOR flash busy */
+#define HOST_SIM_ADC_CONVERSION_TICKS   14U                         /*!< bus ticks needed for one ADC conversion */
+#define HOST_SIM_CAN_FRAME_TICKS        64U                         /*!< default bus ticks one CAN frame occupies the bus */
+#define HOST_SIM_CAN_QUEUE_SIZE         256U                        /*!< depth of the injected and captured CAN frame streams */
+#define HOST_SIM_FLASH_SIZE             0x00020000U                 /*!< bytes of main flash mapped at 0x08000000 */
+#define HOST_SIM_FMC_PROGRAM_TICKS      4U                          /*!< default bus ticks a word or half word program keeps the FMC busy */
+#define HOST_SIM_FMC_ERASE_TICKS        400U                        /*!< default bus ticks a page erase keeps the FMC busy */
+
+/* register access counters */
+typedef struct
+{
+    uint64_t read;                                                  /*!< number of register reads */
+    uint64_t write;                                                 /*!< number of register writes */
+}host_sim_access_struct;
+
+/* CAN frame in the layout of the mailbox registers */
+typedef struct
+{
+    uint32_t mi;                                                    /*!< identifier, FF and FT as in CAN_TMI, TEN clear */
+    uint32_t mp;                                                    /*!< data length code as in CAN_TMP, filter index on reception */
+    uint32_t data0;                                                 /*!< data bytes 0 to 3 */
+    uint32_t data1;                                                 /*!< data bytes 4 to 7 */
+}host_sim_can_frame_struct;
+
+/* operations done by the FMC */
+typedef struct
+{
+    uint32_t programs;                                              /*!< word and half word programs */
+    uint32_t page_erases;                                           /*!< page erases */
+    uint32_t mass_erases;                                           /*!< mass erases */
+    uint32_t errors;                                                /*!< programs and erases refused with PGERR */
+}host_sim_fmc_ops_struct;
+
+/* behavioral model of one peripheral window */
+typedef struct
+{
+    uint32_t base;                                                  /*!< first address decoded by the model */
+    uint32_t size;                                                  /*!< size of the decoded window in bytes */
+    void (*reset)(void);                                            /*!< load the register reset values */
+    void (*read)(uint32_t addr);                                    /*!< side effects of reading a register */
+    uint32_t (*write)(uint32_t addr, uint32_t oldval, uint32_t newval); /*!< returns the value latched by the register */
+    void (*tick)(void);                                             /*!< advance the model by one bus tick */
+}host_sim_model_struct;
+
+/* peripheral models */
+extern const host_sim_model_struct host_sim_rcu_model;
+extern const host_sim_model_struct host_sim_gpio_model;
+extern const host_sim_model_struct host_sim_usart0_model;
+extern const host_sim_model_struct host_sim_usart_model;
+extern const host_sim_model_struct host_sim_dma_model;
+extern const host_sim_model_struct host_sim_crc_model;
+extern const host_sim_model_struct host_sim_i2c_model;
+extern const host_sim_model_struct host_sim_spi0_model;
+extern const host_sim_model_struct host_sim_spi_model;
+extern const host_sim_model_struct host_sim_adc_model;
+extern const host_sim_model_struct host_sim_timer_model;
+extern const host_sim_model_struct host_sim_dac_model;
+extern const host_sim_model_struct host_sim_can_model;
+extern const host_sim_model_struct host_sim_fmc_model;
+extern const host_sim_model_struct host_sim_flash_model;
+
+/* function declarations */
+/* simulator control functions */
+/* map the simulated peripherals and install the access trap */
+void host_sim_init(void);
+/* put every simulated peripheral back into its reset state */
+void host_sim_reset(void);
+/* let the peripherals run for a number of bus ticks without CPU accesses */
+void host_sim_run(uint32_t ticks);
+/* get the current simulated bus time */
+uint64_t host_sim_time_get(void);
+/* get the register access counters */
+void host_sim_access_get(host_sim_access_struct *access);
+/* clear the register access counters */
+void host_sim_access_clear(void);
+
+/* register and bus functions used by the models */
+/* read a register without side effects */
+uint32_t host_sim_reg_peek(uint32_t addr);
+/* write a register without side effects */
+void host_sim_reg_poke(uint32_t addr, uint32_t value);
+/* read as a bus master, going through the register models */
+uint32_t host_sim_bus_read(uint32_t addr, uint32_t width);
+/* write as a bus master, going through the register models */
+void host_sim_bus_write(uint32_t addr, uint32_t value, uint32_t width);
+/* deliver a hardware trigger event to the DAC */
+void host_sim_dac_trigger(uint32_t trigger);
+
+/* interrupt functions */
+/* register the handler called for an interrupt line */
+void host_sim_irq_handler_register(IRQn_Type irq, void (*handler)(void));
+/* drive the level of an interrupt line */
+void host_sim_irq_set(IRQn_Type irq, ControlStatus level);
+/* call the handlers of the asserted interrupt lines until none is left */
+uint32_t host_sim_irq_dispatch(void);
+
+/* peripheral stimulus functions */
+/* feed bytes into the receive line of a USART */
+uint32_t host_sim_usart_rx_inject(uint32_t usart_periph, const uint8_t *data, uint32_t len);
+/* fetch the bytes a USART has shifted out */
+uint32_t host_sim_usart_tx_fetch(uint32_t usart_periph, uint8_t *data, uint32_t len);
+/* configure the number of bus ticks needed to shift one USART frame */
+void host_sim_usart_frame_ticks_config(uint32_t usart_periph, uint32_t ticks);
+/* attach a slave with a register file to an I2C bus */
+void host_sim_i2c_slave_attach(uint32_t i2c_periph, uint32_t addr, uint8_t *mem, uint32_t size);
+/* configure the number of bus ticks needed to shift one I2C byte */
+void host_sim_i2c_byte_ticks_config(uint32_t i2c_periph, uint32_t ticks);
+/* attach a slave selected by a low GPIO pin to a SPI */
+ErrStatus host_sim_spi_slave_attach(uint32_t spi_periph, uint32_t gpio_periph, uint32_t pin, uint32_t mode,
+                                    uint8_t *mem, uint32_t size);
+/* attach a SPI NOR flash selected by a low GPIO pin to a SPI */
+ErrStatus host_sim_spi_nor_attach(uint32_t spi_periph, uint32_t gpio_periph, uint32_t pin, uint8_t *mem, uint32_t size);
+/* get the number of frames a slave saw in the wrong mode or together with another slave */
+uint32_t host_sim_spi_slave_errors_get(uint32_t spi_periph, uint32_t gpio_periph, uint32_t pin);
+/* configure the number of bus ticks needed to exchange one SPI frame */
+void host_sim_spi_frame_ticks_config(uint32_t spi_periph, uint32_t ticks);
+/* attach a stream of frames sent or received by the I2S of a SPI */
+void host_sim_i2s_attach(uint32_t spi_periph, uint16_t *mem, uint32_t size);
+/* get the number of frames an I2S has exchanged */
+uint32_t host_sim_i2s_frames_get(uint32_t spi_periph, uint32_t *gaps);
+/* set the level of an analog input and its change per conversion */
+void host_sim_adc_input_set(uint32_t channel, uint32_t value, uint32_t step);
+/* configure the period of the external regular trigger of an ADC */
+void host_sim_adc_trigger_period_config(uint32_t adc_periph, uint32_t ticks);
+/* get the number of regular conversions an ADC has done */
+uint32_t host_sim_adc_conversions_get(uint32_t adc_periph, uint32_t *lost);
+/* get the number of update events of a basic timer */
+uint32_t host_sim_timer_updates_get(uint32_t timer_periph);
+/* attach a capture of the levels a DAC outputs */
+void host_sim_dac_attach(uint32_t dac_periph, uint16_t *mem, uint32_t size);
+/* get the number of levels a DAC has output */
+uint32_t host_sim_dac_outputs_get(uint32_t dac_periph, uint32_t *stale);
+/* queue a frame the host node sends on the CAN bus */
+ErrStatus host_sim_can_inject(const host_sim_can_frame_struct *frame);
+/* fetch the frames the CANs have sent on the bus */
+uint32_t host_sim_can_fetch(host_sim_can_frame_struct *frame, uint32_t len);
+/* get the number of frames a CAN has stored in its receive FIFOs */
+uint32_t host_sim_can_frames_get(uint32_t can_periph, uint32_t *lost);
+/* configure the number of bus ticks one CAN frame occupies the bus */
+void host_sim_can_frame_ticks_config(uint32_t ticks);
+/* get the number of operations the FMC has done */
+void host_sim_fmc_ops_get(host_sim_fmc_ops_struct *ops);
+/* configure the number of bus ticks a program and a page erase keep the FMC busy */
+void host_sim_fmc_ticks_config(uint32_t program_ticks, uint32_t erase_ticks);
+/* drive the input level of GPIO pins */
+void host_sim_gpio_input_set(uint32_t gpio_periph, uint32_t pin, FlagStatus level);
+/* service a DMA request raised by a peripheral */
+ErrStatus host_sim_dma_request(uint32_t dma_periph, uint32_t channelx);
+
+#endif /* HOST_SIM_H */
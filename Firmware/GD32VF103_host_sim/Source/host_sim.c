@@ -0,0 +1,571 @@
+/*!
+    \file  host_sim.c
+    \brief host-side register model simulator core
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "host_sim.h"
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "the host simulator relies on x86-64 Linux page fault reporting"
+#endif
+
+#define SIM_PAGE_SIZE               0x00001000U                     /* granularity of the access trap */
+#define SIM_EFLAGS_TF               0x00000100U                     /* x86 trap flag, single-steps one instruction */
+#define SIM_PF_ERR_WRITE            0x00000002U                     /* page fault error code: access was a write */
+
+/* simulated address window */
+typedef struct
+{
+    uint32_t base;                                                  /* first simulated address */
+    uint32_t size;                                                  /* size of the window in bytes */
+    uint32_t *shadow;                                               /* register contents */
+}sim_region_struct;
+
+/* access being single-stepped */
+typedef struct
+{
+    sim_region_struct *region;                                      /* window of the access */
+    uint32_t addr;                                                  /* word address of the access */
+    uint32_t write;                                                 /* non-zero for a write or read-modify-write */
+    uint32_t active;                                                /* an access is in flight */
+}sim_pending_struct;
+
+static sim_region_struct sim_region[] = {
+    {APB1_BUS_BASE, 0x00024000U, NULL},                             /* APB1, APB2 and AHB1 peripherals */
+    {TIMER_CTRL_ADDR, SIM_PAGE_SIZE, NULL},                         /* core timer */
+    {ECLIC_ADDR_BASE, 0x00002000U, NULL},                           /* ECLIC */
+    {DBG_BASE, SIM_PAGE_SIZE, NULL},                                /* DBG */
+    {0x08000000U, HOST_SIM_FLASH_SIZE, NULL},                       /* main flash */
+};
+
+static const host_sim_model_struct *const sim_model[] = {
+    &host_sim_rcu_model,
+    &host_sim_gpio_model,
+    &host_sim_usart0_model,
+    &host_sim_usart_model,
+    &host_sim_dma_model,
+    &host_sim_crc_model,
+    &host_sim_i2c_model,
+    &host_sim_spi0_model,
+    &host_sim_spi_model,
+    &host_sim_adc_model,
+    &host_sim_timer_model,
+    &host_sim_dac_model,
+    &host_sim_can_model,
+    &host_sim_fmc_model,
+    &host_sim_flash_model,
+};
+
+#define SIM_REGION_NUM              (sizeof(sim_region) / sizeof(sim_region[0]))
+#define SIM_MODEL_NUM               (sizeof(sim_model) / sizeof(sim_model[0]))
+
+static uint32_t sim_initialized = 0U;
+static uint64_t sim_time = 0U;
+static host_sim_access_struct sim_access;
+static sim_pending_struct sim_pending;
+static uint8_t sim_irq_line[ECLIC_NUM_INTERRUPTS];
+static void (*sim_irq_handler[ECLIC_NUM_INTERRUPTS])(void);
+
+/* find the simulated window containing an address */
+static sim_region_struct *sim_region_find(uintptr_t addr);
+/* find the register model decoding an address */
+static const host_sim_model_struct *sim_model_find(uint32_t addr);
+/* advance every model by one bus tick */
+static void sim_tick(void);
+/* commit a register write through its model */
+static void sim_reg_write(uint32_t addr, uint32_t value);
+/* apply the side effects of a register read */
+static void sim_reg_read(uint32_t addr);
+/* SIGSEGV handler, opens the register for one instruction */
+static void sim_fault_handler(int sig, siginfo_t *info, void *context);
+/* SIGTRAP handler, commits the access and closes the register again */
+static void sim_step_handler(int sig, siginfo_t *info, void *context);
+
+/*!
+    \brief      map the simulated peripherals and install the access trap
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void host_sim_init(void)
+{
+    struct sigaction action;
+    uint32_t i;
+    void *map;
+
+    if(0U != sim_initialized){
+        host_sim_reset();
+        return;
+    }
+
+    for(i = 0U; i < SIM_REGION_NUM; i++){
+        map = mmap((void *)(uintptr_t)sim_region[i].base, sim_region[i].size, PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        if((MAP_FAILED == map) || ((uintptr_t)sim_region[i].base != (uintptr_t)map)){
+            abort();
+        }
+        sim_region[i].shadow = (uint32_t *)calloc(sim_region[i].size / 4U, sizeof(uint32_t));
+        if(NULL == sim_region[i].shadow){
+            abort();
+        }
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = sim_fault_handler;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGSEGV, &action, NULL);
+    action.sa_sigaction = sim_step_handler;
+    sigaction(SIGTRAP, &action, NULL);
+
+    sim_initialized = 1U;
+    host_sim_reset();
+}
+
+/*!
+    \brief      put every simulated peripheral back into its reset state
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void host_sim_reset(void)
+{
+    uint32_t i;
+
+    for(i = 0U; i < SIM_REGION_NUM; i++){
+        memset(sim_region[i].shadow, 0, sim_region[i].size);
+    }
+    for(i = 0U; i < SIM_MODEL_NUM; i++){
+        if(NULL != sim_model[i]->reset){
+            sim_model[i]->reset();
+        }
+    }
+    memset(sim_irq_line, 0, sizeof(sim_irq_line));
+    sim_time = 0U;
+    host_sim_access_clear();
+}
+
+/*!
+    \brief      let the peripherals run for a number of bus ticks without CPU accesses
+    \param[in]  ticks: number of bus ticks, asserted interrupts are dispatched after each one
+    \param[out] none
+    \retval     none
+*/
+void host_sim_run(uint32_t ticks)
+{
+    while(ticks--){
+        sim_tick();
+        host_sim_irq_dispatch();
+    }
+}
+
+/*!
+    \brief      get the current simulated bus time
+    \param[in]  none
+    \param[out] none
+    \retval     bus ticks since the last reset
+*/
+uint64_t host_sim_time_get(void)
+{
+    return sim_time;
+}
+
+/*!
+    \brief      get the register access counters
+    \param[in]  none
+    \param[out] access: register reads and writes since the last clear
+    \retval     none
+*/
+void host_sim_access_get(host_sim_access_struct *access)
+{
+    *access = sim_access;
+}
+
+/*!
+    \brief      clear the register access counters
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void host_sim_access_clear(void)
+{
+    sim_access.read = 0U;
+    sim_access.write = 0U;
+}
+
+/*!
+    \brief      read a register without side effects
+    \param[in]  addr: address of the register
+    \param[out] none
+    \retval     register contents, 0 outside the simulated windows
+*/
+uint32_t host_sim_reg_peek(uint32_t addr)
+{
+    sim_region_struct *region = sim_region_find(addr);
+
+    if(NULL == region){
+        return 0U;
+    }
+    return region->shadow[(addr - region->base) >> 2];
+}
+
+/*!
+    \brief      write a register without side effects
+    \param[in]  addr: address of the register
+    \param[in]  value: new register contents
+    \param[out] none
+    \retval     none
+*/
+void host_sim_reg_poke(uint32_t addr, uint32_t value)
+{
+    sim_region_struct *region = sim_region_find(addr);
+
+    if(NULL != region){
+        region->shadow[(addr - region->base) >> 2] = value;
+    }
+}
+
+/*!
+    \brief      read as a bus master, going through the register models
+    \param[in]  addr: address to read, host memory outside the simulated windows
+    \param[in]  width: access width in bytes, 1, 2 or 4
+    \param[out] none
+    \retval     data read
+*/
+uint32_t host_sim_bus_read(uint32_t addr, uint32_t width)
+{
+    uint32_t value;
+
+    if(NULL == sim_region_find(addr)){
+        switch(width){
+        case 1U:
+            return *(volatile uint8_t *)(uintptr_t)addr;
+        case 2U:
+            return *(volatile uint16_t *)(uintptr_t)addr;
+        default:
+            return *(volatile uint32_t *)(uintptr_t)addr;
+        }
+    }
+
+    value = host_sim_reg_peek(addr & ~3U) >> ((addr & 3U) * 8U);
+    sim_reg_read(addr & ~3U);
+    if(4U > width){
+        value &= (1U << (width * 8U)) - 1U;
+    }
+    return value;
+}
+
+/*!
+    \brief      write as a bus master, going through the register models
+    \param[in]  addr: address to write, host memory outside the simulated windows
+    \param[in]  value: data to write
+    \param[in]  width: access width in bytes, 1, 2 or 4
+    \param[out] none
+    \retval     none
+*/
+void host_sim_bus_write(uint32_t addr, uint32_t value, uint32_t width)
+{
+    uint32_t shift, mask;
+
+    if(NULL == sim_region_find(addr)){
+        switch(width){
+        case 1U:
+            *(volatile uint8_t *)(uintptr_t)addr = (uint8_t)value;
+            break;
+        case 2U:
+            *(volatile uint16_t *)(uintptr_t)addr = (uint16_t)value;
+            break;
+        default:
+            *(volatile uint32_t *)(uintptr_t)addr = value;
+            break;
+        }
+        return;
+    }
+
+    /* merge narrow writes into the register word */
+    shift = (addr & 3U) * 8U;
+    mask = (4U > width) ? (((1U << (width * 8U)) - 1U) << shift) : 0xFFFFFFFFU;
+    value = (host_sim_reg_peek(addr & ~3U) & ~mask) | ((value << shift) & mask);
+    sim_reg_write(addr & ~3U, value);
+}
+
+/*!
+    \brief      register the handler called for an interrupt line
+    \param[in]  irq: interrupt number
+    \param[in]  handler: interrupt service routine, NULL to unregister
+    \param[out] none
+    \retval     none
+*/
+void host_sim_irq_handler_register(IRQn_Type irq, void (*handler)(void))
+{
+    sim_irq_handler[irq] = handler;
+}
+
+/*!
+    \brief      drive the level of an interrupt line
+    \param[in]  irq: interrupt number
+    \param[in]  level: ENABLE to assert the line, DISABLE to release it
+    \param[out] none
+    \retval     none
+*/
+void host_sim_irq_set(IRQn_Type irq, ControlStatus level)
+{
+    sim_irq_line[irq] = (ENABLE == level) ? 1U : 0U;
+}
+
+/*!
+    \brief      call the handlers of the asserted interrupt lines until none is left
+    \param[in]  none
+    \param[out] none
+    \retval     number of handler calls
+*/
+uint32_t host_sim_irq_dispatch(void)
+{
+    uint32_t calls = 0U;
+    uint32_t irq = 0U;
+
+    /* the lowest interrupt number wins, as with equal ECLIC priorities */
+    while((irq < ECLIC_NUM_INTERRUPTS) && (calls < HOST_SIM_IRQ_STORM_LIMIT)){
+        if((0U != sim_irq_line[irq]) && (NULL != sim_irq_handler[irq])){
+            sim_irq_handler[irq]();
+            calls++;
+            irq = 0U;
+        }else{
+            irq++;
+        }
+    }
+    return calls;
+}
+
+/*!
+    \brief      the host build has no mcycle counter, report the simulated bus time
+    \param[in]  none
+    \param[out] none
+    \retval     bus ticks since the last reset
+*/
+uint64_t get_cycle_value(void)
+{
+    return sim_time;
+}
+
+/*!
+    \brief      the host build has no minstret counter, report the simulated bus time
+    \param[in]  none
+    \param[out] none
+    \retval     bus ticks since the last reset
+*/
+uint64_t get_instret_value(void)
+{
+    return sim_time;
+}
+
+/*!
+    \brief      the simulated bus time always runs, nothing to turn on
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void enable_mcycle_minstret(void)
+{
+}
+
+/*!
+    \brief      the simulated bus time always runs, nothing to turn off
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void disable_mcycle_minstret(void)
+{
+}
+
+/*!
+    \brief      find the simulated window containing an address
+    \param[in]  addr: address to look up
+    \param[out] none
+    \retval     window descriptor, NULL for host memory
+*/
+static sim_region_struct *sim_region_find(uintptr_t addr)
+{
+    uint32_t i;
+
+    for(i = 0U; i < SIM_REGION_NUM; i++){
+        if((addr >= sim_region[i].base) && (addr < ((uintptr_t)sim_region[i].base + sim_region[i].size))){
+            return &sim_region[i];
+        }
+    }
+    return NULL;
+}
+
+/*!
+    \brief      find the register model decoding an address
+    \param[in]  addr: address to look up
+    \param[out] none
+    \retval     model descriptor, NULL for plain storage
+*/
+static const host_sim_model_struct *sim_model_find(uint32_t addr)
+{
+    uint32_t i;
+
+    for(i = 0U; i < SIM_MODEL_NUM; i++){
+        if((addr >= sim_model[i]->base) && (addr < (sim_model[i]->base + sim_model[i]->size))){
+            return sim_model[i];
+        }
+    }
+    return NULL;
+}
+
+/*!
+    \brief      advance every model by one bus tick
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_tick(void)
+{
+    uint32_t i;
+
+    sim_time++;
+    for(i = 0U; i < SIM_MODEL_NUM; i++){
+        if(NULL != sim_model[i]->tick){
+            sim_model[i]->tick();
+        }
+    }
+}
+
+/*!
+    \brief      commit a register write through its model
+    \param[in]  addr: word address of the register
+    \param[in]  value: value written by the bus master
+    \param[out] none
+    \retval     none
+*/
+static void sim_reg_write(uint32_t addr, uint32_t value)
+{
+    const host_sim_model_struct *model = sim_model_find(addr);
+
+    if((NULL != model) && (NULL != model->write)){
+        value = model->write(addr, host_sim_reg_peek(addr), value);
+    }
+    host_sim_reg_poke(addr, value);
+}
+
+/*!
+    \brief      apply the side effects of a register read
+    \param[in]  addr: word address of the register
+    \param[out] none
+    \retval     none
+*/
+static void sim_reg_read(uint32_t addr)
+{
+    const host_sim_model_struct *model = sim_model_find(addr);
+
+    if((NULL != model) && (NULL != model->read)){
+        model->read(addr);
+    }
+}
+
+/*!
+    \brief      SIGSEGV handler, opens the register for one instruction
+    \param[in]  sig: signal number
+    \param[in]  info: fault address
+    \param[in]  context: interrupted CPU context
+    \param[out] none
+    \retval     none
+*/
+static void sim_fault_handler(int sig, siginfo_t *info, void *context)
+{
+    ucontext_t *uc = (ucontext_t *)context;
+    sim_region_struct *region = sim_region_find((uintptr_t)info->si_addr);
+    uint32_t addr = (uint32_t)(uintptr_t)info->si_addr;
+
+    (void)sig;
+    if((NULL == region) || (0U != sim_pending.active)){
+        /* a real fault: let the default action terminate the process */
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+
+    sim_tick();
+
+    sim_pending.region = region;
+    sim_pending.addr = addr & ~3U;
+    sim_pending.write = (0U != ((uint32_t)uc->uc_mcontext.gregs[REG_ERR] & SIM_PF_ERR_WRITE)) ? 1U : 0U;
+    sim_pending.active = 1U;
+
+    /* present the register contents and step over the access */
+    mprotect((void *)(uintptr_t)(addr & ~(SIM_PAGE_SIZE - 1U)), SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    *(volatile uint32_t *)(uintptr_t)sim_pending.addr = host_sim_reg_peek(sim_pending.addr);
+    uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+/*!
+    \brief      SIGTRAP handler, commits the access and closes the register again
+    \param[in]  sig: signal number
+    \param[in]  info: trap information
+    \param[in]  context: interrupted CPU context
+    \param[out] none
+    \retval     none
+*/
+static void sim_step_handler(int sig, siginfo_t *info, void *context)
+{
+    ucontext_t *uc = (ucontext_t *)context;
+    uint32_t value;
+
+    (void)sig;
+    (void)info;
+    if(0U == sim_pending.active){
+        signal(SIGTRAP, SIG_DFL);
+        raise(SIGTRAP);
+        return;
+    }
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~(greg_t)SIM_EFLAGS_TF;
+    value = *(volatile uint32_t *)(uintptr_t)sim_pending.addr;
+    mprotect((void *)(uintptr_t)(sim_pending.addr & ~(SIM_PAGE_SIZE - 1U)), SIM_PAGE_SIZE, PROT_NONE);
+    sim_pending.active = 0U;
+
+    if(0U != sim_pending.write){
+        sim_access.write++;
+        sim_reg_write(sim_pending.addr, value);
+    }else{
+        sim_access.read++;
+        sim_reg_read(sim_pending.addr);
+    }
+}
@@ -0,0 +1,446 @@
+/*!
+    \file  host_sim_adc.c
+    \brief ADC register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "host_sim.h"
+
+#define SIM_ADC_NUM                 2U
+#define SIM_ADC_CHANNEL_NUM         18U
+#define SIM_ADC_CALIBRATION_TICKS   8U
+#define SIM_ADC_ETSRC_SOFTWARE      ADC_CTL1_ETSRC
+#define SIM_ADC_SYNC_FREE           0xFFFFFFFFU
+
+/* ADC instance state */
+typedef struct
+{
+    uint32_t periph;                                                /* ADC base address */
+    uint32_t trigger_ticks;                                         /* period of the external regular trigger, 0 for none */
+    uint32_t trigger_timer;                                         /* ticks since the last external trigger */
+    uint32_t conversion_ticks;                                      /* bus ticks per conversion */
+    uint32_t busy;                                                  /* a regular scan is running */
+    uint32_t rank;                                                  /* rank being converted */
+    uint32_t timer;                                                 /* ticks left of the conversion, the first one includes the start delay */
+    uint32_t calibration;                                           /* ticks left of a calibration */
+    uint32_t unread;                                                /* RDATA holds a result not read yet */
+    uint32_t conversions;                                           /* regular conversions done */
+    uint32_t lost;                                                  /* results overwritten before they were read */
+}sim_adc_struct;
+
+static sim_adc_struct sim_adc[SIM_ADC_NUM] = {
+    {.periph = ADC0},
+    {.periph = ADC1},
+};
+
+/* analog inputs, shared by both ADCs */
+static uint32_t sim_adc_input[SIM_ADC_CHANNEL_NUM];
+static uint32_t sim_adc_step[SIM_ADC_CHANNEL_NUM];
+
+/* load the register reset values */
+static void sim_adc_reset(void);
+/* apply the side effects of a register read */
+static void sim_adc_read(uint32_t addr);
+/* latch a register write */
+static uint32_t sim_adc_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* convert on every instance for one bus tick */
+static void sim_adc_tick(void);
+/* start the regular scan of an ADC, or of both in the regular sync modes */
+static void sim_adc_trigger(sim_adc_struct *adc);
+/* start a scan of the regular sequence */
+static void sim_adc_scan_start(sim_adc_struct *adc, uint32_t delay);
+/* get the delay of ADC0 behind ADC1 in the regular sync modes */
+static uint32_t sim_adc_sync_delay(void);
+/* end the conversion of the current rank */
+static void sim_adc_conversion_end(sim_adc_struct *adc, uint32_t ctl1);
+/* find the instance owning an address */
+static sim_adc_struct *sim_adc_find(uint32_t addr);
+/* recompute the shared interrupt line */
+static void sim_adc_irq_update(void);
+
+const host_sim_model_struct host_sim_adc_model = {
+    ADC0, 0x00000800U, sim_adc_reset, sim_adc_read, sim_adc_write, sim_adc_tick
+};
+
+/*!
+    \brief      set the level of an analog input, every conversion of the
+                channel returns the level and then adds step to it, both ADCs
+                see the same inputs
+    \param[in]  channel: ADC_CHANNEL_x(x=0..17)
+    \param[in]  value: level of the next conversion, 12 bits
+    \param[in]  step: added to the level after each conversion
+    \param[out] none
+    \retval     none
+*/
+void host_sim_adc_input_set(uint32_t channel, uint32_t value, uint32_t step)
+{
+    if(channel < SIM_ADC_CHANNEL_NUM){
+        sim_adc_input[channel] = value;
+        sim_adc_step[channel] = step;
+    }
+}
+
+/*!
+    \brief      configure the period of the external regular trigger, the
+                trigger selected by ETSRC fires every ticks bus ticks while
+                ETERC is set, whichever source is selected
+    \param[in]  adc_periph: ADCx(x=0,1)
+    \param[in]  ticks: bus ticks between two triggers, 0 for no trigger
+    \param[out] none
+    \retval     none
+*/
+void host_sim_adc_trigger_period_config(uint32_t adc_periph, uint32_t ticks)
+{
+    sim_adc_struct *adc = sim_adc_find(adc_periph);
+
+    adc->trigger_ticks = ticks;
+    adc->trigger_timer = 0U;
+}
+
+/*!
+    \brief      get the number of regular conversions an ADC has done
+    \param[in]  adc_periph: ADCx(x=0,1)
+    \param[out] lost: results overwritten before RDATA was read, may be NULL
+    \retval     number of conversions
+*/
+uint32_t host_sim_adc_conversions_get(uint32_t adc_periph, uint32_t *lost)
+{
+    sim_adc_struct *adc = sim_adc_find(adc_periph);
+
+    if(NULL != lost){
+        *lost = adc->lost;
+    }
+    return adc->conversions;
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_adc_reset(void)
+{
+    uint32_t i;
+
+    for(i = 0U; i < SIM_ADC_NUM; i++){
+        sim_adc[i].trigger_ticks = 0U;
+        sim_adc[i].trigger_timer = 0U;
+        sim_adc[i].conversion_ticks = HOST_SIM_ADC_CONVERSION_TICKS;
+        sim_adc[i].busy = 0U;
+        sim_adc[i].calibration = 0U;
+        sim_adc[i].unread = 0U;
+        sim_adc[i].conversions = 0U;
+        sim_adc[i].lost = 0U;
+    }
+    for(i = 0U; i < SIM_ADC_CHANNEL_NUM; i++){
+        sim_adc_input[i] = 0U;
+        sim_adc_step[i] = 0U;
+    }
+}
+
+/*!
+    \brief      apply the side effects of a register read
+    \param[in]  addr: word address of the register
+    \param[out] none
+    \retval     none
+*/
+static void sim_adc_read(uint32_t addr)
+{
+    sim_adc_struct *adc = sim_adc_find(addr);
+
+    if(0x4CU == (addr - adc->periph)){
+        /* reading RDATA clears EOC, in the regular sync modes the ADC0 word carries the ADC1 result too */
+        adc->unread = 0U;
+        if((ADC0 == adc->periph) && (SIM_ADC_SYNC_FREE != sim_adc_sync_delay())){
+            sim_adc[1].unread = 0U;
+        }
+        host_sim_reg_poke(adc->periph + 0x00U, host_sim_reg_peek(adc->periph + 0x00U) & ~ADC_STAT_EOC);
+        sim_adc_irq_update();
+    }
+}
+
+/*!
+    \brief      latch a register write
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_adc_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    sim_adc_struct *adc = sim_adc_find(addr);
+
+    switch(addr - adc->periph){
+    case 0x00U:
+        /* STAT: the flags are cleared by writing 0 */
+        newval &= oldval;
+        break;
+    case 0x08U:
+        /* CTL1 */
+        if(0U == (newval & ADC_CTL1_ADCON)){
+            /* powering down aborts the scan and the calibration */
+            adc->busy = 0U;
+            adc->calibration = 0U;
+            newval &= ~(ADC_CTL1_CLB | ADC_CTL1_RSTCLB | ADC_CTL1_SWRCST | ADC_CTL1_SWICST);
+            break;
+        }
+        if(0U != (newval & (ADC_CTL1_CLB | ADC_CTL1_RSTCLB))){
+            adc->calibration = SIM_ADC_CALIBRATION_TICKS;
+        }
+        if((0U != (newval & ADC_CTL1_SWRCST)) && (SIM_ADC_ETSRC_SOFTWARE == (newval & ADC_CTL1_ETSRC))){
+            /* the software trigger starts the scan and clears itself */
+            newval &= ~ADC_CTL1_SWRCST;
+            host_sim_reg_poke(addr, newval);
+            sim_adc_trigger(adc);
+        }
+        break;
+    case 0x4CU:
+        /* RDATA is read only */
+        newval = oldval;
+        break;
+    default:
+        break;
+    }
+    host_sim_reg_poke(addr, newval);
+    sim_adc_irq_update();
+    return newval;
+}
+
+/*!
+    \brief      convert on every instance for one bus tick; the triggers of
+                both ADCs are taken before any conversion moves on, and ADC1
+                converts first, so that ADC0 packs the ADC1 result of the same
+                tick in the regular sync modes
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_adc_tick(void)
+{
+    sim_adc_struct *adc;
+    uint32_t ctl1, i;
+
+    for(i = 0U; i < SIM_ADC_NUM; i++){
+        adc = &sim_adc[i];
+        ctl1 = host_sim_reg_peek(adc->periph + 0x08U);
+        if(0U == (ctl1 & ADC_CTL1_ADCON)){
+            continue;
+        }
+
+        if((0U != adc->calibration) && (0U == --adc->calibration)){
+            ctl1 &= ~(ADC_CTL1_CLB | ADC_CTL1_RSTCLB);
+            host_sim_reg_poke(adc->periph + 0x08U, ctl1);
+        }
+
+        /* external trigger, a trigger during a scan is ignored */
+        if((0U != (ctl1 & ADC_CTL1_ETERC)) && (SIM_ADC_ETSRC_SOFTWARE != (ctl1 & ADC_CTL1_ETSRC))
+           && (0U != adc->trigger_ticks) && (++adc->trigger_timer >= adc->trigger_ticks)){
+            adc->trigger_timer = 0U;
+            sim_adc_trigger(adc);
+        }
+    }
+
+    for(i = SIM_ADC_NUM; i > 0U; i--){
+        adc = &sim_adc[i - 1U];
+        ctl1 = host_sim_reg_peek(adc->periph + 0x08U);
+        if(0U == (ctl1 & ADC_CTL1_ADCON)){
+            continue;
+        }
+
+        if((0U != adc->busy) && (0U == --adc->timer)){
+            sim_adc_conversion_end(adc, ctl1);
+        }
+
+        /* only ADC0 has a DMA request, the transfer goes through the RDATA register model */
+        if((ADC0 == adc->periph) && (0U != (ctl1 & ADC_CTL1_DMA)) && (0U != adc->unread)){
+            host_sim_dma_request(DMA0, DMA_CH0);
+        }
+    }
+    sim_adc_irq_update();
+}
+
+/*!
+    \brief      start the regular scan of an ADC; in the regular sync modes the
+                trigger of ADC0 starts ADC1 as well, provided ADC1 is on and its
+                external trigger enabled, and ADC0 follows it after the delay
+                of the mode; a trigger during a scan is ignored
+    \param[in]  adc: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_adc_trigger(sim_adc_struct *adc)
+{
+    sim_adc_struct *slave = &sim_adc[1];
+    uint32_t delay = sim_adc_sync_delay();
+    uint32_t ctl1;
+
+    if((ADC0 != adc->periph) || (SIM_ADC_SYNC_FREE == delay)){
+        if(0U == adc->busy){
+            sim_adc_scan_start(adc, 0U);
+        }
+        return;
+    }
+
+    ctl1 = host_sim_reg_peek(slave->periph + 0x08U);
+    if((0U == slave->busy) && (0U != (ctl1 & ADC_CTL1_ADCON)) && (0U != (ctl1 & ADC_CTL1_ETERC))){
+        sim_adc_scan_start(slave, 0U);
+    }
+    if(0U == adc->busy){
+        sim_adc_scan_start(adc, delay);
+    }
+}
+
+/*!
+    \brief      start a scan of the regular sequence
+    \param[in]  adc: instance state
+    \param[in]  delay: bus ticks before the first conversion starts
+    \param[out] none
+    \retval     none
+*/
+static void sim_adc_scan_start(sim_adc_struct *adc, uint32_t delay)
+{
+    adc->busy = 1U;
+    adc->rank = 0U;
+    adc->timer = adc->conversion_ticks + delay;
+    host_sim_reg_poke(adc->periph + 0x00U, host_sim_reg_peek(adc->periph + 0x00U) | ADC_STAT_STRC);
+}
+
+/*!
+    \brief      end the conversion of the current rank, store the result and
+                go on with the next rank, the start of the sequence in
+                continuous mode, or stop
+    \param[in]  adc: instance state
+    \param[in]  ctl1: ADC_CTL1 value
+    \param[out] none
+    \retval     none
+*/
+static void sim_adc_conversion_end(sim_adc_struct *adc, uint32_t ctl1)
+{
+    uint32_t length = ((host_sim_reg_peek(adc->periph + 0x2CU) & ADC_RSQ0_RL) >> 20U) + 1U;
+    uint32_t rsq = host_sim_reg_peek(adc->periph + 0x34U - (4U * (adc->rank / 6U)));
+    uint32_t channel = (rsq >> (5U * (adc->rank % 6U))) & ADC_RSQX_RSQN;
+    uint32_t value = 0U;
+
+    if(channel < SIM_ADC_CHANNEL_NUM){
+        value = sim_adc_input[channel] & 0x0FFFU;
+        sim_adc_input[channel] += sim_adc_step[channel];
+    }
+    if(0U != (ctl1 & ADC_CTL1_DAL)){
+        value <<= 4U;
+    }
+    if((ADC0 == adc->periph) && (SIM_ADC_SYNC_FREE != sim_adc_sync_delay())){
+        /* the last ADC1 result goes into the upper half of the ADC0 word */
+        value |= (host_sim_reg_peek(ADC1 + 0x4CU) & 0x0000FFFFU) << 16U;
+    }
+    if(0U != adc->unread){
+        adc->lost++;
+    }
+    host_sim_reg_poke(adc->periph + 0x4CU, value);
+    host_sim_reg_poke(adc->periph + 0x00U, host_sim_reg_peek(adc->periph + 0x00U) | ADC_STAT_EOC);
+    adc->unread = 1U;
+    adc->conversions++;
+
+    adc->timer = adc->conversion_ticks;
+    if((0U != (host_sim_reg_peek(adc->periph + 0x04U) & ADC_CTL0_SM)) && ((adc->rank + 1U) < length)){
+        adc->rank++;
+    }else if(0U != (ctl1 & ADC_CTL1_CTN)){
+        adc->rank = 0U;
+    }else{
+        adc->busy = 0U;
+    }
+}
+
+/*!
+    \brief      get the delay of ADC0 behind ADC1 in the regular sync modes:
+                none in regular parallel, half a conversion in follow-up fast
+                and a whole one in follow-up slow
+    \param[in]  none
+    \param[out] none
+    \retval     delay in bus ticks, SIM_ADC_SYNC_FREE if the regular groups run on their own
+*/
+static uint32_t sim_adc_sync_delay(void)
+{
+    switch(host_sim_reg_peek(ADC0 + 0x04U) & ADC_CTL0_SYNCM){
+    case ADC_DAUL_REGULAL_PARALLEL_INSERTED_PARALLEL:
+    case ADC_DAUL_REGULAL_PARALLEL_INSERTED_ROTATION:
+    case ADC_DAUL_REGULAL_PARALLEL:
+        return 0U;
+    case ADC_DAUL_INSERTED_PARALLEL_REGULAL_FOLLOWUP_FAST:
+    case ADC_DAUL_REGULAL_FOLLOWUP_FAST:
+        return sim_adc[0].conversion_ticks / 2U;
+    case ADC_DAUL_INSERTED_PARALLEL_REGULAL_FOLLOWUP_SLOW:
+    case ADC_DAUL_REGULAL_FOLLOWUP_SLOW:
+        return sim_adc[0].conversion_ticks;
+    default:
+        return SIM_ADC_SYNC_FREE;
+    }
+}
+
+/*!
+    \brief      find the instance owning an address
+    \param[in]  addr: register or base address
+    \param[out] none
+    \retval     instance state
+*/
+static sim_adc_struct *sim_adc_find(uint32_t addr)
+{
+    return ((addr & ~0x000003FFU) == ADC1) ? &sim_adc[1] : &sim_adc[0];
+}
+
+/*!
+    \brief      recompute the interrupt line shared by both ADCs
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_adc_irq_update(void)
+{
+    uint32_t pending = 0U;
+    uint32_t stat, ctl0, i;
+
+    for(i = 0U; i < SIM_ADC_NUM; i++){
+        stat = host_sim_reg_peek(sim_adc[i].periph + 0x00U);
+        ctl0 = host_sim_reg_peek(sim_adc[i].periph + 0x04U);
+        if(0U != (ctl0 & ADC_CTL0_EOCIE)){
+            pending |= stat & ADC_STAT_EOC;
+        }
+        if(0U != (ctl0 & ADC_CTL0_EOICIE)){
+            pending |= stat & ADC_STAT_EOIC;
+        }
+        if(0U != (ctl0 & ADC_CTL0_WDEIE)){
+            pending |= stat & ADC_STAT_WDE;
+        }
+    }
+    host_sim_irq_set(ADC0_1_IRQn, (0U != pending) ? ENABLE : DISABLE);
+}
@@ -0,0 +1,778 @@
+/*!
+    \file  host_sim_can.c
+    \brief CAN register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "host_sim.h"
+#include <string.h>
+
+#define SIM_CAN_NUM                 2U
+#define SIM_CAN_MAILBOX_NUM         3U
+#define SIM_CAN_FIFO_DEPTH          3U
+#define SIM_CAN_HOST                SIM_CAN_NUM                     /* sender number of the host node */
+#define SIM_CAN_INTERMISSION        3U                              /* recessive bits between two frames */
+
+/* register offsets */
+#define SIM_CAN_CTL                 0x000U
+#define SIM_CAN_STAT                0x004U
+#define SIM_CAN_TSTAT               0x008U
+#define SIM_CAN_RFIFO0              0x00CU
+#define SIM_CAN_INTEN               0x014U
+#define SIM_CAN_BT                  0x01CU
+#define SIM_CAN_TMI0                0x180U
+#define SIM_CAN_RFIFOMI0            0x1B0U
+#define SIM_CAN_FCTL                0x200U
+#define SIM_CAN_FMCFG               0x204U
+#define SIM_CAN_FSCFG               0x20CU
+#define SIM_CAN_FAFIFO              0x214U
+#define SIM_CAN_FW                  0x21CU
+#define SIM_CAN_FDATA0              0x240U
+
+/* CAN instance state */
+typedef struct
+{
+    uint32_t periph;                                                /* CAN base address */
+    IRQn_Type tx_irq;                                               /* transmit interrupt line */
+    IRQn_Type rx_irq[2];                                            /* receive FIFO interrupt lines */
+    uint32_t stamp[SIM_CAN_MAILBOX_NUM];                            /* request order of the mailboxes */
+    host_sim_can_frame_struct fifo[2][SIM_CAN_FIFO_DEPTH];          /* receive FIFOs, oldest first */
+    uint32_t fifo_len[2];                                           /* frames in the receive FIFOs */
+    uint32_t received;                                              /* frames stored in a receive FIFO */
+    uint32_t lost;                                                  /* frames lost on a full receive FIFO */
+}sim_can_struct;
+
+/* shared bus state */
+typedef struct
+{
+    uint32_t frame_ticks;                                           /* bus ticks one frame occupies the bus, 0 to follow the bit timing */
+    uint32_t busy;                                                  /* bus ticks left of the frame on the bus */
+    uint32_t gap;                                                   /* bus ticks left of the intermission */
+    uint64_t sof;                                                   /* bus time of the start of the frame on the bus */
+    uint32_t sender;                                                /* CAN number or SIM_CAN_HOST */
+    uint32_t mailbox;                                               /* mailbox of the frame on the bus */
+    uint32_t stamp;                                                 /* request counter */
+    host_sim_can_frame_struct frame;                                /* frame on the bus */
+    host_sim_can_frame_struct inject[HOST_SIM_CAN_QUEUE_SIZE];      /* frames the host node sends */
+    uint32_t inject_head;                                           /* frames queued by the host */
+    uint32_t inject_tail;                                           /* frames put on the bus */
+    host_sim_can_frame_struct capture[HOST_SIM_CAN_QUEUE_SIZE];     /* frames the CANs sent */
+    uint32_t capture_head;                                          /* frames captured */
+    uint32_t capture_tail;                                          /* frames fetched */
+}sim_can_bus_struct;
+
+static sim_can_struct sim_can[SIM_CAN_NUM] = {
+    {.periph = CAN0, .tx_irq = CAN0_TX_IRQn, .rx_irq = {CAN0_RX0_IRQn, CAN0_RX1_IRQn}},
+    {.periph = CAN1, .tx_irq = CAN1_TX_IRQn, .rx_irq = {CAN1_RX0_IRQn, CAN1_RX1_IRQn}},
+};
+static sim_can_bus_struct sim_can_bus;
+
+/* load the register reset values */
+static void sim_can_reset(void);
+/* load the register reset values of one instance */
+static void sim_can_instance_reset(sim_can_struct *can);
+/* latch a register write */
+static uint32_t sim_can_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* move the frame on the bus for one bus tick */
+static void sim_can_tick(void);
+/* put the frame that wins the arbitration on the bus */
+static void sim_can_arbitrate(void);
+/* end the frame on the bus and deliver it */
+static void sim_can_complete(void);
+/* store a frame in a receive FIFO if the filters accept it */
+static void sim_can_receive(sim_can_struct *can, const host_sim_can_frame_struct *frame);
+/* find the filter of a CAN that accepts a frame */
+static uint32_t sim_can_filter_match(uint32_t can, uint32_t mi, uint32_t *fi);
+/* mirror the head of a receive FIFO into its registers */
+static void sim_can_fifo_update(sim_can_struct *can, uint32_t fifo);
+/* get the arbitration priority of a frame, lower wins */
+static uint32_t sim_can_key(uint32_t mi);
+/* get the number of bits a frame occupies the bus, stuff bits included */
+static uint32_t sim_can_frame_bits(const host_sim_can_frame_struct *frame);
+/* append bits to a bit string */
+static uint32_t sim_can_bits_put(uint8_t *bit, uint32_t n, uint32_t value, uint32_t len);
+/* get the number of bus ticks of one bit of an instance */
+static uint32_t sim_can_bit_ticks(const sim_can_struct *can);
+/* get the time stamp of the start of the frame on the bus */
+static uint32_t sim_can_time_stamp(const sim_can_struct *can);
+/* check whether an instance is out of the initial and sleep working modes */
+static uint32_t sim_can_active(const sim_can_struct *can);
+/* find the instance owning an address */
+static sim_can_struct *sim_can_find(uint32_t addr);
+/* recompute the interrupt lines of an instance */
+static void sim_can_irq_update(sim_can_struct *can);
+
+const host_sim_model_struct host_sim_can_model = {
+    CAN0, 0x00000800U, sim_can_reset, NULL, sim_can_write, sim_can_tick
+};
+
+/*!
+    \brief      queue a frame the host node sends on the CAN bus; it takes part
+                in the arbitration like the frames of the CAN mailboxes
+    \param[in]  frame: frame in mailbox register layout
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if the host queue is full
+*/
+ErrStatus host_sim_can_inject(const host_sim_can_frame_struct *frame)
+{
+    if(HOST_SIM_CAN_QUEUE_SIZE == (sim_can_bus.inject_head - sim_can_bus.inject_tail)){
+        return ERROR;
+    }
+    sim_can_bus.inject[sim_can_bus.inject_head % HOST_SIM_CAN_QUEUE_SIZE] = *frame;
+    sim_can_bus.inject[sim_can_bus.inject_head % HOST_SIM_CAN_QUEUE_SIZE].mi &= ~CAN_TMI_TEN;
+    sim_can_bus.inject_head++;
+    return SUCCESS;
+}
+
+/*!
+    \brief      fetch the frames the CANs have sent on the bus, in bus order
+    \param[in]  len: size of the frame buffer
+    \param[out] frame: frame buffer
+    \retval     number of frames fetched
+*/
+uint32_t host_sim_can_fetch(host_sim_can_frame_struct *frame, uint32_t len)
+{
+    uint32_t n = 0U;
+
+    while((n < len) && (sim_can_bus.capture_tail != sim_can_bus.capture_head)){
+        frame[n++] = sim_can_bus.capture[sim_can_bus.capture_tail % HOST_SIM_CAN_QUEUE_SIZE];
+        sim_can_bus.capture_tail++;
+    }
+    return n;
+}
+
+/*!
+    \brief      get the number of frames a CAN has stored in its receive FIFOs
+    \param[in]  can_periph: CANx(x=0,1)
+    \param[out] lost: frames lost on a full receive FIFO, may be NULL
+    \retval     number of frames stored
+*/
+uint32_t host_sim_can_frames_get(uint32_t can_periph, uint32_t *lost)
+{
+    sim_can_struct *can = sim_can_find(can_periph);
+
+    if(NULL != lost){
+        *lost = can->lost;
+    }
+    return can->received;
+}
+
+/*!
+    \brief      configure the number of bus ticks one frame occupies the bus
+    \param[in]  ticks: bus ticks per frame, or 0 for the stuffed length of
+                each frame at the bit timing of the sender followed by the
+                intermission; the host node uses the bit timing of CAN0
+    \param[out] none
+    \retval     none
+*/
+void host_sim_can_frame_ticks_config(uint32_t ticks)
+{
+    sim_can_bus.frame_ticks = ticks;
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_can_reset(void)
+{
+    uint32_t i;
+
+    memset(&sim_can_bus, 0, sizeof(sim_can_bus));
+    sim_can_bus.frame_ticks = HOST_SIM_CAN_FRAME_TICKS;
+    for(i = 0U; i < SIM_CAN_NUM; i++){
+        sim_can_instance_reset(&sim_can[i]);
+        sim_can[i].received = 0U;
+        sim_can[i].lost = 0U;
+    }
+    /* the filters come up locked for configuration, CAN1 from bank 14 */
+    host_sim_reg_poke(CAN0 + SIM_CAN_FCTL, 0x2A1C0E01U);
+}
+
+/*!
+    \brief      load the register reset values of one instance, the filters
+                are kept
+    \param[in]  can: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_can_instance_reset(sim_can_struct *can)
+{
+    uint32_t offset;
+
+    for(offset = 0U; offset < SIM_CAN_FCTL; offset += 4U){
+        host_sim_reg_poke(can->periph + offset, 0U);
+    }
+    host_sim_reg_poke(can->periph + SIM_CAN_CTL, CAN_CTL_DFZ | CAN_CTL_SLPWMOD);
+    host_sim_reg_poke(can->periph + SIM_CAN_STAT, CAN_STAT_RXL | CAN_STAT_LASTRX | CAN_STAT_SLPWS);
+    host_sim_reg_poke(can->periph + SIM_CAN_TSTAT, CAN_TSTAT_TME0 | CAN_TSTAT_TME1 | CAN_TSTAT_TME2);
+    host_sim_reg_poke(can->periph + SIM_CAN_BT, 0x01230000U);
+    can->fifo_len[0] = 0U;
+    can->fifo_len[1] = 0U;
+    if((0U != sim_can_bus.busy) && (SIM_CAN_HOST != sim_can_bus.sender) && (can == &sim_can[sim_can_bus.sender])){
+        sim_can_bus.busy = 0U;
+    }
+    sim_can_irq_update(can);
+}
+
+/*!
+    \brief      latch a register write
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_can_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    sim_can_struct *can = sim_can_find(addr);
+    uint32_t offset = addr - can->periph;
+    uint32_t stat, tstat, mailbox, fifo;
+
+    switch(offset){
+    case SIM_CAN_CTL:
+        if(0U != (newval & CAN_CTL_SWRST)){
+            sim_can_instance_reset(can);
+            return host_sim_reg_peek(addr);
+        }
+        /* the working state follows the request at once, initial working first */
+        stat = host_sim_reg_peek(can->periph + SIM_CAN_STAT) & ~(CAN_STAT_IWS | CAN_STAT_SLPWS);
+        if(0U != (newval & CAN_CTL_IWMOD)){
+            stat |= CAN_STAT_IWS;
+        }else if(0U != (newval & CAN_CTL_SLPWMOD)){
+            stat |= CAN_STAT_SLPWS;
+        }
+        host_sim_reg_poke(can->periph + SIM_CAN_STAT, stat);
+        break;
+    case SIM_CAN_STAT:
+        /* the status change flags are cleared by writing 1, the rest is read only */
+        newval = oldval & ~(newval & (CAN_STAT_ERRIF | CAN_STAT_WUIF | CAN_STAT_SLPIF));
+        break;
+    case SIM_CAN_TSTAT:
+        tstat = oldval;
+        for(mailbox = 0U; mailbox < SIM_CAN_MAILBOX_NUM; mailbox++){
+            /* MTF written 1 clears the finish flags of the mailbox */
+            if(0U != (newval & (CAN_TSTAT_MTF0 << (8U * mailbox)))){
+                tstat &= ~((CAN_TSTAT_MTF0 | CAN_TSTAT_MTFNERR0 | CAN_TSTAT_MAL0 | CAN_TSTAT_MTE0) << (8U * mailbox));
+            }
+            if((0U == (newval & (CAN_TSTAT_MST0 << (8U * mailbox)))) || (0U != (tstat & (CAN_TSTAT_TME0 << mailbox)))){
+                continue;
+            }
+            if((0U != sim_can_bus.busy) && (SIM_CAN_HOST != sim_can_bus.sender) && (can == &sim_can[sim_can_bus.sender])
+               && (mailbox == sim_can_bus.mailbox)){
+                /* a frame on the bus is finished first, the stop request waits for it */
+                tstat |= CAN_TSTAT_MST0 << (8U * mailbox);
+            }else{
+                tstat &= ~(CAN_TSTAT_MTFNERR0 << (8U * mailbox));
+                tstat |= (CAN_TSTAT_MTF0 << (8U * mailbox)) | (CAN_TSTAT_TME0 << mailbox);
+                host_sim_reg_poke(can->periph + SIM_CAN_TMI0 + (0x10U * mailbox),
+                                  host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * mailbox)) & ~CAN_TMI_TEN);
+            }
+        }
+        newval = tstat;
+        break;
+    case SIM_CAN_RFIFO0:
+    case SIM_CAN_RFIFO0 + 4U:
+        fifo = (offset - SIM_CAN_RFIFO0) / 4U;
+        /* RFF and RFO are cleared by writing 1, RFD releases the oldest frame */
+        host_sim_reg_poke(addr, oldval & ~(newval & (CAN_RFIFO0_RFF0 | CAN_RFIFO0_RFO0)));
+        if((0U != (newval & CAN_RFIFO0_RFD0)) && (0U != can->fifo_len[fifo])){
+            can->fifo_len[fifo]--;
+            memmove(&can->fifo[fifo][0], &can->fifo[fifo][1], can->fifo_len[fifo] * sizeof(host_sim_can_frame_struct));
+        }
+        sim_can_fifo_update(can, fifo);
+        sim_can_irq_update(can);
+        return host_sim_reg_peek(addr);
+    default:
+        if((offset >= SIM_CAN_TMI0) && (offset < SIM_CAN_RFIFOMI0) && (0U == (offset & 0x0FU))){
+            mailbox = (offset - SIM_CAN_TMI0) / 0x10U;
+            tstat = host_sim_reg_peek(can->periph + SIM_CAN_TSTAT);
+            if(0U == (tstat & (CAN_TSTAT_TME0 << mailbox))){
+                /* a pending mailbox is write protected */
+                return oldval;
+            }
+            if(0U != (newval & CAN_TMI_TEN)){
+                host_sim_reg_poke(can->periph + SIM_CAN_TSTAT, tstat & ~(CAN_TSTAT_TME0 << mailbox));
+                can->stamp[mailbox] = ++sim_can_bus.stamp;
+            }
+        }
+        break;
+    }
+    host_sim_reg_poke(addr, newval);
+    sim_can_irq_update(can);
+    return newval;
+}
+
+/*!
+    \brief      move the frame on the bus for one bus tick; when the bus is
+                idle the pending frames arbitrate for it
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_can_tick(void)
+{
+    if(0U != sim_can_bus.busy){
+        if(0U != --sim_can_bus.busy){
+            return;
+        }
+        sim_can_complete();
+    }
+    if(0U != sim_can_bus.gap){
+        sim_can_bus.gap--;
+        return;
+    }
+    sim_can_arbitrate();
+}
+
+/*!
+    \brief      put the frame that wins the arbitration on the bus; each CAN
+                offers the pending mailbox of highest priority, or the oldest
+                request with TFO set, the host node its oldest frame
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_can_arbitrate(void)
+{
+    sim_can_struct *can;
+    uint32_t best_key = 0U, best_sender = SIM_CAN_HOST, best_mailbox = 0U, found = 0U;
+    uint32_t tstat, fifo_order, key, chosen, mailbox, i;
+
+    for(i = 0U; i < SIM_CAN_NUM; i++){
+        can = &sim_can[i];
+        if(0U == sim_can_active(can)){
+            continue;
+        }
+        tstat = host_sim_reg_peek(can->periph + SIM_CAN_TSTAT);
+        if((CAN_TSTAT_TME0 | CAN_TSTAT_TME1 | CAN_TSTAT_TME2) == (tstat & (CAN_TSTAT_TME0 | CAN_TSTAT_TME1 | CAN_TSTAT_TME2))){
+            continue;
+        }
+        fifo_order = host_sim_reg_peek(can->periph + SIM_CAN_CTL) & CAN_CTL_TFO;
+        chosen = SIM_CAN_MAILBOX_NUM;
+        for(mailbox = 0U; mailbox < SIM_CAN_MAILBOX_NUM; mailbox++){
+            if(0U != (tstat & (CAN_TSTAT_TME0 << mailbox))){
+                continue;
+            }
+            if((SIM_CAN_MAILBOX_NUM == chosen)
+               || ((0U != fifo_order) ? ((int32_t)(can->stamp[mailbox] - can->stamp[chosen]) < 0) :
+                   (sim_can_key(host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * mailbox))) <
+                    sim_can_key(host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * chosen)))))){
+                chosen = mailbox;
+            }
+        }
+        key = sim_can_key(host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * chosen)));
+        if((0U == found) || (key < best_key)){
+            found = 1U;
+            best_key = key;
+            best_sender = i;
+            best_mailbox = chosen;
+        }
+    }
+    if(sim_can_bus.inject_head != sim_can_bus.inject_tail){
+        key = sim_can_key(sim_can_bus.inject[sim_can_bus.inject_tail % HOST_SIM_CAN_QUEUE_SIZE].mi);
+        if((0U == found) || (key < best_key)){
+            found = 1U;
+            best_sender = SIM_CAN_HOST;
+        }
+    }
+    if(0U == found){
+        return;
+    }
+
+    sim_can_bus.sender = best_sender;
+    sim_can_bus.mailbox = best_mailbox;
+    sim_can_bus.sof = host_sim_time_get();
+    if(SIM_CAN_HOST == best_sender){
+        can = &sim_can[0];
+        sim_can_bus.frame = sim_can_bus.inject[sim_can_bus.inject_tail % HOST_SIM_CAN_QUEUE_SIZE];
+        sim_can_bus.inject_tail++;
+    }else{
+        can = &sim_can[best_sender];
+        sim_can_bus.frame.mi = host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * best_mailbox)) & ~CAN_TMI_TEN;
+        sim_can_bus.frame.mp = host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * best_mailbox) + 0x04U)
+                               & CAN_TMP_DLENC;
+        sim_can_bus.frame.data0 = host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * best_mailbox) + 0x08U);
+        sim_can_bus.frame.data1 = host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * best_mailbox) + 0x0CU);
+    }
+    if(0U != sim_can_bus.frame_ticks){
+        sim_can_bus.busy = sim_can_bus.frame_ticks;
+        sim_can_bus.gap = 0U;
+    }else{
+        sim_can_bus.busy = sim_can_frame_bits(&sim_can_bus.frame) * sim_can_bit_ticks(can);
+        sim_can_bus.gap = SIM_CAN_INTERMISSION * sim_can_bit_ticks(can);
+    }
+}
+
+/*!
+    \brief      end the frame on the bus: the sending mailbox finishes without
+                error, every other active CAN that is not in loopback mode
+                receives the frame, the sender too in loopback mode; a frame of
+                a CAN in silent mode stays off the bus; with TTC set the
+                mailbox gets the time stamp of the start of frame
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_can_complete(void)
+{
+    host_sim_can_frame_struct frame = sim_can_bus.frame;
+    sim_can_struct *can;
+    uint32_t mailbox = sim_can_bus.mailbox;
+    uint32_t tstat, bt = 0U, i;
+
+    if(SIM_CAN_HOST != sim_can_bus.sender){
+        can = &sim_can[sim_can_bus.sender];
+        tstat = host_sim_reg_peek(can->periph + SIM_CAN_TSTAT) & ~(CAN_TSTAT_MST0 << (8U * mailbox));
+        tstat |= ((CAN_TSTAT_MTF0 | CAN_TSTAT_MTFNERR0) << (8U * mailbox)) | (CAN_TSTAT_TME0 << mailbox);
+        host_sim_reg_poke(can->periph + SIM_CAN_TSTAT, tstat);
+        if(0U != (host_sim_reg_peek(can->periph + SIM_CAN_CTL) & CAN_CTL_TTC)){
+            host_sim_reg_poke(can->periph + SIM_CAN_TMI0 + (0x10U * mailbox) + 0x04U,
+                              (host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * mailbox) + 0x04U) & ~CAN_TMP_TS)
+                              | (sim_can_time_stamp(can) << 16));
+        }
+        host_sim_reg_poke(can->periph + SIM_CAN_TMI0 + (0x10U * mailbox),
+                          host_sim_reg_peek(can->periph + SIM_CAN_TMI0 + (0x10U * mailbox)) & ~CAN_TMI_TEN);
+        sim_can_irq_update(can);
+
+        bt = host_sim_reg_peek(can->periph + SIM_CAN_BT);
+        if(0U != (bt & CAN_BT_LCMOD)){
+            sim_can_receive(can, &frame);
+        }
+        if(0U != (bt & CAN_BT_SCMOD)){
+            return;
+        }
+        if(HOST_SIM_CAN_QUEUE_SIZE == (sim_can_bus.capture_head - sim_can_bus.capture_tail)){
+            sim_can_bus.capture_tail++;
+        }
+        sim_can_bus.capture[sim_can_bus.capture_head % HOST_SIM_CAN_QUEUE_SIZE] = frame;
+        sim_can_bus.capture_head++;
+    }
+    for(i = 0U; i < SIM_CAN_NUM; i++){
+        if((i != sim_can_bus.sender) && (0U == (host_sim_reg_peek(sim_can[i].periph + SIM_CAN_BT) & CAN_BT_LCMOD))){
+            sim_can_receive(&sim_can[i], &frame);
+        }
+    }
+}
+
+/*!
+    \brief      store a frame in a receive FIFO if the filters accept it; on a
+                full FIFO the frame is dropped with RFOD set, else it replaces
+                the newest frame, and RFO is set; with TTC set the frame gets
+                the time stamp of its start of frame
+    \param[in]  can: instance state
+    \param[in]  frame: received frame
+    \param[out] none
+    \retval     none
+*/
+static void sim_can_receive(sim_can_struct *can, const host_sim_can_frame_struct *frame)
+{
+    host_sim_can_frame_struct *slot;
+    uint32_t addr, fifo, fi = 0U;
+
+    if(0U == sim_can_active(can)){
+        return;
+    }
+    fifo = sim_can_filter_match((uint32_t)(can - sim_can), frame->mi, &fi);
+    if(0U == fifo){
+        return;
+    }
+    fifo--;
+    addr = can->periph + SIM_CAN_RFIFO0 + (4U * fifo);
+
+    if(SIM_CAN_FIFO_DEPTH == can->fifo_len[fifo]){
+        can->lost++;
+        host_sim_reg_poke(addr, host_sim_reg_peek(addr) | CAN_RFIFO0_RFO0);
+        if(0U != (host_sim_reg_peek(can->periph + SIM_CAN_CTL) & CAN_CTL_RFOD)){
+            sim_can_irq_update(can);
+            return;
+        }
+        slot = &can->fifo[fifo][SIM_CAN_FIFO_DEPTH - 1U];
+    }else{
+        slot = &can->fifo[fifo][can->fifo_len[fifo]++];
+        if(SIM_CAN_FIFO_DEPTH == can->fifo_len[fifo]){
+            host_sim_reg_poke(addr, host_sim_reg_peek(addr) | CAN_RFIFO0_RFF0);
+        }
+    }
+    can->received++;
+    slot->mi = frame->mi & ~CAN_TMI_TEN;
+    slot->mp = (frame->mp & CAN_TMP_DLENC) | (fi << 8);
+    if(0U != (host_sim_reg_peek(can->periph + SIM_CAN_CTL) & CAN_CTL_TTC)){
+        slot->mp |= sim_can_time_stamp(can) << 16;
+    }
+    slot->data0 = frame->data0;
+    slot->data1 = frame->data1;
+    sim_can_fifo_update(can, fifo);
+    sim_can_irq_update(can);
+}
+
+/*!
+    \brief      find the filter of a CAN that accepts a frame; the banks below
+                the CAN1 start bank serve CAN0, the others CAN1, and the first
+                active bank in order that matches wins; the filter index counts
+                the filters of the banks routed to the same FIFO, active or not
+    \param[in]  can: 0 for CAN0, 1 for CAN1
+    \param[in]  mi: identifier word of the frame
+    \param[out] fi: filter index
+    \retval     0 if rejected, 1 for FIFO0, 2 for FIFO1
+*/
+static uint32_t sim_can_filter_match(uint32_t can, uint32_t mi, uint32_t *fi)
+{
+    uint32_t fctl = host_sim_reg_peek(CAN0 + SIM_CAN_FCTL);
+    uint32_t mode = host_sim_reg_peek(CAN0 + SIM_CAN_FMCFG);
+    uint32_t scale = host_sim_reg_peek(CAN0 + SIM_CAN_FSCFG);
+    uint32_t assign = host_sim_reg_peek(CAN0 + SIM_CAN_FAFIFO);
+    uint32_t working = host_sim_reg_peek(CAN0 + SIM_CAN_FW);
+    uint32_t start = (fctl & CAN_FCTL_HBC1F) >> 8;
+    uint32_t number[2] = {0U, 0U};
+    uint32_t word32 = mi & ~CAN_TMI_TEN;
+    uint32_t word16 = ((mi >> 21) << 5) | (((mi >> 1) & 1U) << 4) | (((mi >> 2) & 1U) << 3) | ((mi >> 18) & 0x7U);
+    uint32_t data0, data1, fifo, bank, hit;
+
+    /* no frame is received while the filters are being configured */
+    if(0U != (fctl & CAN_FCTL_FLD)){
+        return 0U;
+    }
+    for(bank = (0U == can) ? 0U : start; bank < ((0U == can) ? start : 28U); bank++){
+        fifo = (assign >> bank) & 1U;
+        data0 = host_sim_reg_peek(CAN0 + SIM_CAN_FDATA0 + (8U * bank));
+        data1 = host_sim_reg_peek(CAN0 + SIM_CAN_FDATA0 + (8U * bank) + 4U);
+        hit = 4U;
+        if(0U != (scale & BIT(bank))){
+            if(0U != (mode & BIT(bank))){
+                hit = (word32 == data0) ? 0U : ((word32 == data1) ? 1U : 4U);
+            }else{
+                hit = (0U == ((word32 ^ data0) & data1)) ? 0U : 4U;
+            }
+        }else{
+            if(0U != (mode & BIT(bank))){
+                hit = (word16 == (data0 & 0xFFFFU)) ? 0U : ((word16 == (data0 >> 16)) ? 1U :
+                      ((word16 == (data1 & 0xFFFFU)) ? 2U : ((word16 == (data1 >> 16)) ? 3U : 4U)));
+            }else{
+                hit = (0U == ((word16 ^ data0) & (data0 >> 16) & 0xFFFFU)) ? 0U :
+                      ((0U == ((word16 ^ data1) & (data1 >> 16) & 0xFFFFU)) ? 1U : 4U);
+            }
+        }
+        if((0U != (working & BIT(bank))) && (4U != hit)){
+            *fi = number[fifo] + hit;
+            return fifo + 1U;
+        }
+        /* 32-bit mask banks hold one filter, 16-bit list banks four, the others two */
+        number[fifo] += (0U != (scale & BIT(bank))) ? ((0U != (mode & BIT(bank))) ? 2U : 1U) :
+                        ((0U != (mode & BIT(bank))) ? 4U : 2U);
+    }
+
+    return 0U;
+}
+
+/*!
+    \brief      mirror the length and the oldest frame of a receive FIFO into
+                its registers
+    \param[in]  can: instance state
+    \param[in]  fifo: 0 or 1
+    \param[out] none
+    \retval     none
+*/
+static void sim_can_fifo_update(sim_can_struct *can, uint32_t fifo)
+{
+    uint32_t addr = can->periph + SIM_CAN_RFIFO0 + (4U * fifo);
+    uint32_t mailbox = can->periph + SIM_CAN_RFIFOMI0 + (0x10U * fifo);
+
+    host_sim_reg_poke(addr, (host_sim_reg_peek(addr) & (CAN_RFIFO0_RFF0 | CAN_RFIFO0_RFO0)) | can->fifo_len[fifo]);
+    if(0U != can->fifo_len[fifo]){
+        host_sim_reg_poke(mailbox + 0x00U, can->fifo[fifo][0].mi);
+        host_sim_reg_poke(mailbox + 0x04U, can->fifo[fifo][0].mp);
+        host_sim_reg_poke(mailbox + 0x08U, can->fifo[fifo][0].data0);
+        host_sim_reg_poke(mailbox + 0x0CU, can->fifo[fifo][0].data1);
+    }
+}
+
+/*!
+    \brief      get the arbitration priority of a frame, lower wins: the base
+                identifier, then RTR or SRR, IDE, the identifier extension and
+                the RTR of an extended frame, as they are sent on the bus
+    \param[in]  mi: identifier word of the frame
+    \param[out] none
+    \retval     arbitration key
+*/
+static uint32_t sim_can_key(uint32_t mi)
+{
+    uint32_t rtr = (mi & CAN_TMI_FT) >> 1;
+
+    if(0U == (mi & CAN_TMI_FF)){
+        return (mi & CAN_TMI_SFID) | (rtr << 20);
+    }
+    return (mi & CAN_TMI_SFID) | BIT(20) | BIT(19) | (((mi >> 3) & 0x3FFFFU) << 1) | rtr;
+}
+
+/*!
+    \brief      get the number of bits a frame occupies the bus: start of frame
+                to CRC with the stuff bits, the delimiters, ACK and end of frame
+    \param[in]  frame: frame in mailbox register layout
+    \param[out] none
+    \retval     number of bits
+*/
+static uint32_t sim_can_frame_bits(const host_sim_can_frame_struct *frame)
+{
+    uint8_t bit[128];
+    uint32_t rtr = (frame->mi & CAN_TMI_FT) >> 1;
+    uint32_t dlen = frame->mp & CAN_TMP_DLENC;
+    uint32_t n = 0U, crc = 0U, run = 0U, stuff = 0U, last = 2U, i;
+
+    /* start of frame, arbitration and control fields */
+    n = sim_can_bits_put(bit, n, 0U, 1U);
+    n = sim_can_bits_put(bit, n, frame->mi >> 21, 11U);
+    if(0U == (frame->mi & CAN_TMI_FF)){
+        n = sim_can_bits_put(bit, n, rtr << 2, 3U);
+    }else{
+        n = sim_can_bits_put(bit, n, 0x3U, 2U);
+        n = sim_can_bits_put(bit, n, (frame->mi >> 3) & 0x3FFFFU, 18U);
+        n = sim_can_bits_put(bit, n, rtr << 2, 3U);
+    }
+    n = sim_can_bits_put(bit, n, dlen, 4U);
+    if(0U == rtr){
+        for(i = 0U; (i < dlen) && (i < 8U); i++){
+            n = sim_can_bits_put(bit, n, ((i < 4U) ? frame->data0 : frame->data1) >> (8U * (i & 3U)), 8U);
+        }
+    }
+    for(i = 0U; i < n; i++){
+        crc = ((crc << 1) & 0x7FFFU) ^ ((bit[i] ^ (crc >> 14)) ? 0x4599U : 0U);
+    }
+    n = sim_can_bits_put(bit, n, crc, 15U);
+
+    /* a bit of the other level follows five equal ones and counts for the next run */
+    for(i = 0U; i < n; i++){
+        run = (bit[i] == last) ? (run + 1U) : 1U;
+        last = bit[i];
+        if(5U == run){
+            stuff++;
+            last ^= 1U;
+            run = 1U;
+        }
+    }
+
+    /* CRC delimiter, ACK slot and delimiter, end of frame */
+    return n + stuff + 10U;
+}
+
+/*!
+    \brief      append the low bits of a value to a bit string, most
+                significant first
+    \param[in]  bit: bit string
+    \param[in]  n: bits in the string
+    \param[in]  value: value
+    \param[in]  len: number of bits
+    \param[out] none
+    \retval     bits in the string after the append
+*/
+static uint32_t sim_can_bits_put(uint8_t *bit, uint32_t n, uint32_t value, uint32_t len)
+{
+    while(0U != len){
+        len--;
+        bit[n++] = (uint8_t)((value >> len) & 1U);
+    }
+    return n;
+}
+
+/*!
+    \brief      get the number of bus ticks of one bit of an instance, the
+                bus ticks running at the APB1 clock
+    \param[in]  can: instance state
+    \param[out] none
+    \retval     bus ticks per bit
+*/
+static uint32_t sim_can_bit_ticks(const sim_can_struct *can)
+{
+    uint32_t bt = host_sim_reg_peek(can->periph + SIM_CAN_BT);
+
+    return ((bt & CAN_BT_BAUDPSC) + 1U) * (3U + ((bt & CAN_BT_BS1) >> 16) + ((bt & CAN_BT_BS2) >> 20));
+}
+
+/*!
+    \brief      get the time stamp of the start of the frame on the bus, the
+                time triggered counter of an instance counting bits
+    \param[in]  can: instance state
+    \param[out] none
+    \retval     16-bit time stamp
+*/
+static uint32_t sim_can_time_stamp(const sim_can_struct *can)
+{
+    return (uint32_t)(sim_can_bus.sof / sim_can_bit_ticks(can)) & 0xFFFFU;
+}
+
+/*!
+    \brief      check whether an instance is out of the initial and sleep working modes
+    \param[in]  can: instance state
+    \param[out] none
+    \retval     1 if it takes part in the bus, 0 otherwise
+*/
+static uint32_t sim_can_active(const sim_can_struct *can)
+{
+    return (0U == (host_sim_reg_peek(can->periph + SIM_CAN_STAT) & (CAN_STAT_IWS | CAN_STAT_SLPWS))) ? 1U : 0U;
+}
+
+/*!
+    \brief      find the instance owning an address
+    \param[in]  addr: register or base address
+    \param[out] none
+    \retval     instance state
+*/
+static sim_can_struct *sim_can_find(uint32_t addr)
+{
+    return ((addr & ~0x000003FFU) == CAN1) ? &sim_can[1] : &sim_can[0];
+}
+
+/*!
+    \brief      recompute the interrupt lines of an instance
+    \param[in]  can: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_can_irq_update(sim_can_struct *can)
+{
+    uint32_t inten = host_sim_reg_peek(can->periph + SIM_CAN_INTEN);
+    uint32_t tstat = host_sim_reg_peek(can->periph + SIM_CAN_TSTAT);
+    uint32_t rfifo, pending, fifo;
+
+    pending = (0U != (inten & CAN_INTEN_TMEIE)) && (0U != (tstat & (CAN_TSTAT_MTF0 | CAN_TSTAT_MTF1 | CAN_TSTAT_MTF2)));
+    host_sim_irq_set(can->tx_irq, (0U != pending) ? ENABLE : DISABLE);
+    for(fifo = 0U; fifo < 2U; fifo++){
+        rfifo = host_sim_reg_peek(can->periph + SIM_CAN_RFIFO0 + (4U * fifo));
+        /* the FIFO1 enables sit 3 bits above the FIFO0 ones */
+        pending = ((0U != (inten & (CAN_INTEN_RFNEIE0 << (3U * fifo)))) && (0U != (rfifo & CAN_RFIFO0_RFL0)))
+                  || ((0U != (inten & (CAN_INTEN_RFFIE0 << (3U * fifo)))) && (0U != (rfifo & CAN_RFIFO0_RFF0)))
+                  || ((0U != (inten & (CAN_INTEN_RFOIE0 << (3U * fifo)))) && (0U != (rfifo & CAN_RFIFO0_RFO0)));
+        host_sim_irq_set(can->rx_irq[fifo], (0U != pending) ? ENABLE : DISABLE);
+    }
+}
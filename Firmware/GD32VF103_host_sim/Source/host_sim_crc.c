@@ -0,0 +1,91 @@
+/*!
+    \file  host_sim_crc.c
+    \brief CRC register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "host_sim.h"
+
+#define SIM_CRC_POLYNOMIAL          0x04C11DB7U
+
+/* load the register reset values */
+static void sim_crc_reset(void);
+/* latch a register write, a data write advances the checksum */
+static uint32_t sim_crc_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+
+const host_sim_model_struct host_sim_crc_model = {
+    CRC, 0x00000400U, sim_crc_reset, NULL, sim_crc_write, NULL
+};
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_crc_reset(void)
+{
+    host_sim_reg_poke(CRC + 0x00U, 0xFFFFFFFFU);
+}
+
+/*!
+    \brief      latch a register write, a data write advances the checksum
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_crc_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    uint32_t bit;
+
+    switch(addr - CRC){
+    case 0x00U:
+        /* CRC_DATA: CRC-32 with polynomial 0x04C11DB7, MSB first, one word per write */
+        oldval ^= newval;
+        for(bit = 0U; bit < 32U; bit++){
+            oldval = (0U != (oldval & 0x80000000U)) ? ((oldval << 1) ^ SIM_CRC_POLYNOMIAL) : (oldval << 1);
+        }
+        return oldval;
+    case 0x04U:
+        /* CRC_FDATA */
+        return newval & CRC_FDATA_FDATA;
+    case 0x08U:
+        /* CRC_CTL: the reset bit self-clears */
+        if(0U != (newval & CRC_CTL_RST)){
+            host_sim_reg_poke(CRC + 0x00U, 0xFFFFFFFFU);
+        }
+        return 0U;
+    default:
+        return oldval;
+    }
+}
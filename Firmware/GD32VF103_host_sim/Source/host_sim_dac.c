@@ -0,0 +1,289 @@
+/*!
+    \file  host_sim_dac.c
+    \brief DAC register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "host_sim.h"
+
+#define SIM_DAC_NUM                 2U
+#define SIM_DAC_CTL_SHIFT(ch)       (16U * (ch))
+
+/* DAC channel state hidden from software */
+typedef struct
+{
+    uint32_t hold;                                                  /* 12-bit level of the data holding register */
+    uint32_t fresh;                                                 /* the holding register was written since the last trigger */
+    uint16_t *mem;                                                  /* captured output levels */
+    uint32_t size;                                                  /* number of levels in mem */
+    uint32_t pos;                                                   /* next level in mem */
+    uint32_t outputs;                                               /* output register loads */
+    uint32_t stale;                                                 /* DMA paced loads of a level already output */
+}sim_dac_struct;
+
+static sim_dac_struct sim_dac[SIM_DAC_NUM];
+
+/* load the register reset values */
+static void sim_dac_reset(void);
+/* latch a register write */
+static uint32_t sim_dac_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* load the output registers of triggered channels and request their next data */
+static void sim_dac_trigger_channels(uint32_t mask);
+/* load the output register of a channel */
+static void sim_dac_output(uint32_t channel);
+
+const host_sim_model_struct host_sim_dac_model = {
+    DAC, 0x00000400U, sim_dac_reset, NULL, sim_dac_write, NULL
+};
+
+/*!
+    \brief      attach a capture of the levels a DAC outputs, each load of the
+                output register is stored into the next word of mem, wrapping
+                at the end
+    \param[in]  dac_periph: DACx(x=0,1)
+    \param[in]  mem: captured levels, NULL detaches the capture
+    \param[in]  size: number of levels in mem
+    \param[out] none
+    \retval     none
+*/
+void host_sim_dac_attach(uint32_t dac_periph, uint16_t *mem, uint32_t size)
+{
+    sim_dac_struct *dac = &sim_dac[(DAC1 == dac_periph) ? 1U : 0U];
+
+    dac->mem = mem;
+    dac->size = (0U == size) ? 1U : size;
+    dac->pos = 0U;
+    dac->outputs = 0U;
+    dac->stale = 0U;
+}
+
+/*!
+    \brief      get the number of levels a DAC has output
+    \param[in]  dac_periph: DACx(x=0,1)
+    \param[out] stale: triggers with DMA enabled that found the holding
+                register not rewritten since the previous one, may be NULL
+    \retval     number of output register loads
+*/
+uint32_t host_sim_dac_outputs_get(uint32_t dac_periph, uint32_t *stale)
+{
+    sim_dac_struct *dac = &sim_dac[(DAC1 == dac_periph) ? 1U : 0U];
+
+    if(NULL != stale){
+        *stale = dac->stale;
+    }
+    return dac->outputs;
+}
+
+/*!
+    \brief      deliver a hardware trigger event to the DAC, every channel that
+                is enabled with its trigger on and selecting the source loads
+                its output register
+    \param[in]  trigger: DAC_TRIGGER_xxx, the source as DTSEL0 codes it
+    \param[out] none
+    \retval     none
+*/
+void host_sim_dac_trigger(uint32_t trigger)
+{
+    uint32_t ctl = host_sim_reg_peek(DAC + 0x00U);
+    uint32_t mask = 0U;
+    uint32_t channel, shift;
+
+    for(channel = 0U; channel < SIM_DAC_NUM; channel++){
+        shift = SIM_DAC_CTL_SHIFT(channel);
+        if((0U != ((ctl >> shift) & DAC_CTL_DEN0)) && (0U != ((ctl >> shift) & DAC_CTL_DTEN0))
+           && (trigger == ((ctl >> shift) & DAC_CTL_DTSEL0))){
+            mask |= BIT(channel);
+        }
+    }
+    sim_dac_trigger_channels(mask);
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_dac_reset(void)
+{
+    uint32_t i;
+
+    for(i = 0U; i < SIM_DAC_NUM; i++){
+        sim_dac[i].hold = 0U;
+        sim_dac[i].fresh = 0U;
+        sim_dac[i].pos = 0U;
+        sim_dac[i].outputs = 0U;
+        sim_dac[i].stale = 0U;
+    }
+}
+
+/*!
+    \brief      latch a register write; a holding register write goes to the
+                output at once on a channel without trigger, the noise and
+                triangle wave generators are not modelled
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_dac_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    uint32_t offset = addr - DAC;
+    uint32_t ctl = host_sim_reg_peek(DAC + 0x00U);
+    uint32_t level[SIM_DAC_NUM] = {0U, 0U};
+    uint32_t mask = 0U;
+    uint32_t channel, shift;
+
+    switch(offset){
+    case 0x00U:
+        /* CTL */
+        return newval;
+    case 0x04U:
+        /* SWT: a software trigger hits the channels selecting it, the bits clear themselves */
+        for(channel = 0U; channel < SIM_DAC_NUM; channel++){
+            shift = SIM_DAC_CTL_SHIFT(channel);
+            if((0U != (newval & BIT(channel))) && (0U != ((ctl >> shift) & DAC_CTL_DEN0))
+               && (0U != ((ctl >> shift) & DAC_CTL_DTEN0)) && (DAC_TRIGGER_SOFTWARE == ((ctl >> shift) & DAC_CTL_DTSEL0))){
+                mask |= BIT(channel);
+            }
+        }
+        sim_dac_trigger_channels(mask);
+        return 0U;
+    case 0x08U:
+    case 0x14U:
+        /* DACx_R12DH */
+        level[0] = newval & 0x0FFFU;
+        mask = (0x08U == offset) ? BIT(0) : BIT(1);
+        break;
+    case 0x0CU:
+    case 0x18U:
+        /* DACx_L12DH */
+        level[0] = (newval >> 4U) & 0x0FFFU;
+        mask = (0x0CU == offset) ? BIT(0) : BIT(1);
+        break;
+    case 0x10U:
+    case 0x1CU:
+        /* DACx_R8DH */
+        level[0] = (newval & 0x00FFU) << 4U;
+        mask = (0x10U == offset) ? BIT(0) : BIT(1);
+        break;
+    case 0x20U:
+        /* DACC_R12DH */
+        level[0] = newval & 0x0FFFU;
+        level[1] = (newval >> 16U) & 0x0FFFU;
+        mask = BIT(0) | BIT(1);
+        break;
+    case 0x24U:
+        /* DACC_L12DH */
+        level[0] = (newval >> 4U) & 0x0FFFU;
+        level[1] = (newval >> 20U) & 0x0FFFU;
+        mask = BIT(0) | BIT(1);
+        break;
+    case 0x28U:
+        /* DACC_R8DH */
+        level[0] = (newval & 0x00FFU) << 4U;
+        level[1] = ((newval >> 8U) & 0x00FFU) << 4U;
+        mask = BIT(0) | BIT(1);
+        break;
+    default:
+        /* DACx_DO are read only */
+        return oldval;
+    }
+
+    /* a single channel register carries its level in level[0] */
+    if(BIT(1) == mask){
+        level[1] = level[0];
+    }
+    host_sim_reg_poke(addr, newval);
+    for(channel = 0U; channel < SIM_DAC_NUM; channel++){
+        if(0U == (mask & BIT(channel))){
+            continue;
+        }
+        sim_dac[channel].hold = level[channel];
+        sim_dac[channel].fresh = 1U;
+        if(0U == ((ctl >> SIM_DAC_CTL_SHIFT(channel)) & DAC_CTL_DTEN0)){
+            sim_dac_output(channel);
+        }
+    }
+    return newval;
+}
+
+/*!
+    \brief      load the output registers of triggered channels, then raise the
+                DMA request of those with DMA enabled; all loads come first, so
+                a concurrent word written by the request of DAC0 is not output
+                early by DAC1
+    \param[in]  mask: BIT(x) for channel x
+    \param[out] none
+    \retval     none
+*/
+static void sim_dac_trigger_channels(uint32_t mask)
+{
+    uint32_t ctl = host_sim_reg_peek(DAC + 0x00U);
+    uint32_t channel, dma;
+
+    for(channel = 0U; channel < SIM_DAC_NUM; channel++){
+        if(0U == (mask & BIT(channel))){
+            continue;
+        }
+        dma = (ctl >> SIM_DAC_CTL_SHIFT(channel)) & DAC_CTL_DDMAEN0;
+        if((0U != dma) && (0U == sim_dac[channel].fresh)){
+            sim_dac[channel].stale++;
+        }
+        sim_dac_output(channel);
+    }
+    for(channel = 0U; channel < SIM_DAC_NUM; channel++){
+        if((0U != (mask & BIT(channel))) && (0U != ((ctl >> SIM_DAC_CTL_SHIFT(channel)) & DAC_CTL_DDMAEN0))){
+            host_sim_dma_request(DMA1, (0U == channel) ? DMA_CH2 : DMA_CH3);
+        }
+    }
+}
+
+/*!
+    \brief      load the output register of a channel from its holding register
+    \param[in]  channel: 0 for DAC0, 1 for DAC1
+    \param[out] none
+    \retval     none
+*/
+static void sim_dac_output(uint32_t channel)
+{
+    sim_dac_struct *dac = &sim_dac[channel];
+
+    host_sim_reg_poke(DAC + 0x2CU + (4U * channel), dac->hold);
+    dac->fresh = 0U;
+    if(NULL != dac->mem){
+        dac->mem[dac->pos] = (uint16_t)dac->hold;
+        dac->pos = (dac->pos + 1U) % dac->size;
+    }
+    dac->outputs++;
+}
@@ -0,0 +1,245 @@
+/*!
+    \file  host_sim_dma.c
+    \brief DMA register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "host_sim.h"
+
+#define SIM_DMA_NUM                 2U
+#define SIM_DMA_CHANNEL_NUM         7U
+#define SIM_DMA_CH_OFFSET(ch)       (0x08U + 0x14U * (ch))
+
+/* DMA channel state hidden from software */
+typedef struct
+{
+    uint32_t active;                                                /* CHEN seen set */
+    uint32_t number;                                                /* programmed transfer number */
+    uint32_t paddr;                                                 /* current peripheral address */
+    uint32_t maddr;                                                 /* current memory address */
+}sim_dma_channel_struct;
+
+static sim_dma_channel_struct sim_dma[SIM_DMA_NUM][SIM_DMA_CHANNEL_NUM];
+
+/* latch a register write */
+static uint32_t sim_dma_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* move memory to memory items */
+static void sim_dma_tick(void);
+/* move one item on a channel */
+static ErrStatus sim_dma_transfer(uint32_t dma_periph, uint32_t channelx);
+/* recompute the interrupt line of a channel */
+static void sim_dma_irq_update(uint32_t dma_periph, uint32_t channelx);
+
+const host_sim_model_struct host_sim_dma_model = {
+    DMA0, 0x00000800U, NULL, NULL, sim_dma_write, sim_dma_tick
+};
+
+/*!
+    \brief      service a DMA request raised by a peripheral
+    \param[in]  dma_periph: DMAx(x=0,1)
+    \param[in]  channelx: DMA_CHx(x=0..6)
+    \param[out] none
+    \retval     SUCCESS if an item was moved, ERROR if the channel is idle
+*/
+ErrStatus host_sim_dma_request(uint32_t dma_periph, uint32_t channelx)
+{
+    if(0U != (host_sim_reg_peek(dma_periph + SIM_DMA_CH_OFFSET(channelx)) & DMA_CHXCTL_M2M)){
+        return ERROR;
+    }
+    return sim_dma_transfer(dma_periph, channelx);
+}
+
+/*!
+    \brief      latch a register write
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_dma_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    uint32_t dma_periph = addr & ~0x000003FFU;
+    uint32_t offset = addr - dma_periph;
+    uint32_t channelx, reg;
+    sim_dma_channel_struct *channel;
+
+    if(0x00U == offset){
+        /* INTF is read only */
+        return oldval;
+    }
+    if(0x04U == offset){
+        /* INTC: clear the flags, GIFC clears every flag of its channel, the register reads as zero */
+        for(channelx = 0U; channelx < SIM_DMA_CHANNEL_NUM; channelx++){
+            if(0U != (newval & DMA_FLAG_ADD(DMA_INTC_GIFC, channelx))){
+                newval |= DMA_FLAG_ADD(DMA_CHINTF_RESET_VALUE, channelx);
+            }
+        }
+        host_sim_reg_poke(dma_periph + 0x00U, host_sim_reg_peek(dma_periph + 0x00U) & ~newval);
+        for(channelx = 0U; channelx < SIM_DMA_CHANNEL_NUM; channelx++){
+            sim_dma_irq_update(dma_periph, channelx);
+        }
+        return 0U;
+    }
+
+    channelx = (offset - 0x08U) / 0x14U;
+    reg = (offset - 0x08U) % 0x14U;
+    if((SIM_DMA_CHANNEL_NUM <= channelx) || (0x0CU < reg)){
+        return oldval;
+    }
+    channel = &sim_dma[(dma_periph - DMA0) / 0x00000400U][channelx];
+    if(0x00U == reg){
+        /* CHxCTL: enabling the channel loads the address and counter shadows */
+        if((0U == (oldval & DMA_CHXCTL_CHEN)) && (0U != (newval & DMA_CHXCTL_CHEN))){
+            channel->active = 1U;
+            channel->number = host_sim_reg_peek(addr + 0x04U) & DMA_CHXCNT_CNT;
+            channel->paddr = host_sim_reg_peek(addr + 0x08U);
+            channel->maddr = host_sim_reg_peek(addr + 0x0CU);
+        }else if(0U == (newval & DMA_CHXCTL_CHEN)){
+            channel->active = 0U;
+        }
+        host_sim_reg_poke(addr, newval);
+        sim_dma_irq_update(dma_periph, channelx);
+        return newval;
+    }
+    /* CHxCNT, CHxPADDR and CHxMADDR are locked while the channel is enabled */
+    if(0U != (host_sim_reg_peek(dma_periph + SIM_DMA_CH_OFFSET(channelx)) & DMA_CHXCTL_CHEN)){
+        return oldval;
+    }
+    return (0x04U == reg) ? (newval & DMA_CHXCNT_CNT) : newval;
+}
+
+/*!
+    \brief      move memory to memory items
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_dma_tick(void)
+{
+    uint32_t dma, channelx, burst;
+    uint32_t dma_periph;
+
+    for(dma = 0U; dma < SIM_DMA_NUM; dma++){
+        dma_periph = DMA0 + dma * 0x00000400U;
+        for(channelx = 0U; channelx < SIM_DMA_CHANNEL_NUM; channelx++){
+            if(0U == (host_sim_reg_peek(dma_periph + SIM_DMA_CH_OFFSET(channelx)) & DMA_CHXCTL_M2M)){
+                continue;
+            }
+            for(burst = 0U; burst < HOST_SIM_DMA_M2M_BURST; burst++){
+                if(ERROR == sim_dma_transfer(dma_periph, channelx)){
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*!
+    \brief      move one item on a channel
+    \param[in]  dma_periph: DMAx(x=0,1)
+    \param[in]  channelx: DMA_CHx(x=0..6)
+    \param[out] none
+    \retval     SUCCESS if an item was moved, ERROR if the channel is idle
+*/
+static ErrStatus sim_dma_transfer(uint32_t dma_periph, uint32_t channelx)
+{
+    sim_dma_channel_struct *channel = &sim_dma[(dma_periph - DMA0) / 0x00000400U][channelx];
+    uint32_t ctladdr = dma_periph + SIM_DMA_CH_OFFSET(channelx);
+    uint32_t ctl = host_sim_reg_peek(ctladdr);
+    uint32_t cnt = host_sim_reg_peek(ctladdr + 0x04U);
+    uint32_t pwidth = 1U << GET_BITS(ctl, 8U, 9U);
+    uint32_t mwidth = 1U << GET_BITS(ctl, 10U, 11U);
+    uint32_t flags = 0U;
+    uint32_t data;
+
+    if((0U == channel->active) || (0U == (ctl & DMA_CHXCTL_CHEN)) || (0U == cnt)){
+        return ERROR;
+    }
+
+    if(0U != (ctl & DMA_CHXCTL_DIR)){
+        data = host_sim_bus_read(channel->maddr, mwidth);
+        host_sim_bus_write(channel->paddr, data, pwidth);
+    }else{
+        data = host_sim_bus_read(channel->paddr, pwidth);
+        host_sim_bus_write(channel->maddr, data, mwidth);
+    }
+    if(0U != (ctl & DMA_CHXCTL_PNAGA)){
+        channel->paddr += pwidth;
+    }
+    if(0U != (ctl & DMA_CHXCTL_MNAGA)){
+        channel->maddr += mwidth;
+    }
+
+    cnt--;
+    if((channel->number / 2U) == cnt){
+        flags |= DMA_INTF_GIF | DMA_INTF_HTFIF;
+    }
+    if(0U == cnt){
+        flags |= DMA_INTF_GIF | DMA_INTF_FTFIF;
+        if(0U != (ctl & DMA_CHXCTL_CMEN)){
+            /* circular mode reloads the counter and the addresses */
+            cnt = channel->number;
+            channel->paddr = host_sim_reg_peek(ctladdr + 0x08U);
+            channel->maddr = host_sim_reg_peek(ctladdr + 0x0CU);
+        }
+    }
+    host_sim_reg_poke(ctladdr + 0x04U, cnt);
+    if(0U != flags){
+        host_sim_reg_poke(dma_periph + 0x00U, host_sim_reg_peek(dma_periph + 0x00U) | (flags << (channelx * 4U)));
+        sim_dma_irq_update(dma_periph, channelx);
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      recompute the interrupt line of a channel
+    \param[in]  dma_periph: DMAx(x=0,1)
+    \param[in]  channelx: DMA_CHx(x=0..6)
+    \param[out] none
+    \retval     none
+*/
+static void sim_dma_irq_update(uint32_t dma_periph, uint32_t channelx)
+{
+    uint32_t flags = (host_sim_reg_peek(dma_periph + 0x00U) >> (channelx * 4U)) & 0xEU;
+    uint32_t ctl = host_sim_reg_peek(dma_periph + SIM_DMA_CH_OFFSET(channelx));
+    IRQn_Type irq;
+
+    /* the FTF/HTF/ERR flags line up with the FTFIE/HTFIE/ERRIE enables */
+    if(DMA0 == dma_periph){
+        irq = (IRQn_Type)(DMA0_Channel0_IRQn + channelx);
+    }else if(5U > channelx){
+        irq = (IRQn_Type)(DMA1_Channel0_IRQn + channelx);
+    }else{
+        return;
+    }
+    host_sim_irq_set(irq, (0U != (flags & ctl)) ? ENABLE : DISABLE);
+}
@@ -0,0 +1,316 @@
+/*!
+    \file  host_sim_fmc.c
+    \brief FMC and main flash model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "host_sim.h"
+
+#define SIM_FLASH_BASE              0x08000000U                     /* first address of the main flash */
+#define SIM_FLASH_PAGE_SIZE         0x00000400U                     /* bytes erased by a page erase */
+#define SIM_FMC_STAT0               0x0CU                           /* status register offset */
+#define SIM_FMC_CTL0                0x10U                           /* control register offset */
+#define SIM_FMC_ADDR0               0x14U                           /* address register offset */
+#define SIM_FMC_STAT0_W1C           (FMC_STAT0_PGERR | FMC_STAT0_WPERR | FMC_STAT0_ENDF)
+
+/* operation in progress */
+#define SIM_FMC_IDLE                0U                              /* no operation */
+#define SIM_FMC_PROGRAM             1U                              /* a word or half word is programmed */
+#define SIM_FMC_PAGE_ERASE          2U                              /* a page is erased */
+#define SIM_FMC_MASS_ERASE          3U                              /* the whole flash is erased */
+
+/* FMC state */
+typedef struct
+{
+    uint32_t key;                                                   /* unlock sequence: 1 after UNLOCK_KEY0 */
+    uint32_t operation;                                             /* operation in progress */
+    uint32_t addr;                                                  /* word address of the program, or page address */
+    uint32_t data;                                                  /* word content once programmed */
+    uint32_t busy;                                                  /* bus ticks left of the operation */
+    uint32_t program_ticks;                                         /* bus ticks of a program */
+    uint32_t erase_ticks;                                           /* bus ticks of a page erase */
+    host_sim_fmc_ops_struct ops;                                    /* operations done */
+}sim_fmc_struct;
+
+static sim_fmc_struct sim_fmc;
+
+/* load the register reset values */
+static void sim_fmc_reset(void);
+/* latch a register write, the keys unlock CTL0 and START begins an erase */
+static uint32_t sim_fmc_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* count down the operation in progress */
+static void sim_fmc_tick(void);
+/* fill the flash with the erased value */
+static void sim_flash_reset(void);
+/* accept a program while PG is set, ignore any other write */
+static uint32_t sim_flash_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* end the operation in progress or refuse it with an error flag */
+static void sim_fmc_end(uint32_t error);
+/* recompute the interrupt line */
+static void sim_fmc_irq_update(void);
+
+const host_sim_model_struct host_sim_fmc_model = {
+    FMC, 0x00000400U, sim_fmc_reset, NULL, sim_fmc_write, sim_fmc_tick
+};
+
+const host_sim_model_struct host_sim_flash_model = {
+    SIM_FLASH_BASE, HOST_SIM_FLASH_SIZE, sim_flash_reset, NULL, sim_flash_write, NULL
+};
+
+/*!
+    \brief      get the number of operations the FMC has done
+    \param[in]  none
+    \param[out] ops: programs and erases since the reset
+    \retval     none
+*/
+void host_sim_fmc_ops_get(host_sim_fmc_ops_struct *ops)
+{
+    *ops = sim_fmc.ops;
+}
+
+/*!
+    \brief      configure the number of bus ticks a program and a page erase keep the FMC busy
+    \param[in]  program_ticks: bus ticks of a word or half word program, at least 1
+    \param[in]  erase_ticks: bus ticks of a page erase, at least 1, a mass erase takes 4 times longer
+    \param[out] none
+    \retval     none
+*/
+void host_sim_fmc_ticks_config(uint32_t program_ticks, uint32_t erase_ticks)
+{
+    sim_fmc.program_ticks = (0U != program_ticks) ? program_ticks : 1U;
+    sim_fmc.erase_ticks = (0U != erase_ticks) ? erase_ticks : 1U;
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_fmc_reset(void)
+{
+    sim_fmc.key = 0U;
+    sim_fmc.operation = SIM_FMC_IDLE;
+    sim_fmc.busy = 0U;
+    sim_fmc.program_ticks = HOST_SIM_FMC_PROGRAM_TICKS;
+    sim_fmc.erase_ticks = HOST_SIM_FMC_ERASE_TICKS;
+    sim_fmc.ops.programs = 0U;
+    sim_fmc.ops.page_erases = 0U;
+    sim_fmc.ops.mass_erases = 0U;
+    sim_fmc.ops.errors = 0U;
+    host_sim_reg_poke(FMC + SIM_FMC_CTL0, FMC_CTL0_LK);
+    host_sim_irq_set(FMC_IRQn, DISABLE);
+}
+
+/*!
+    \brief      latch a register write, the keys unlock CTL0 and START begins an erase
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_fmc_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    uint32_t page;
+
+    switch(addr - FMC){
+    case 0x04U:
+        /* KEY0: UNLOCK_KEY0 then UNLOCK_KEY1 clears LK, anything else breaks the sequence */
+        if((0U == sim_fmc.key) && (UNLOCK_KEY0 == newval)){
+            sim_fmc.key = 1U;
+        }else{
+            if((1U == sim_fmc.key) && (UNLOCK_KEY1 == newval)){
+                host_sim_reg_poke(FMC + SIM_FMC_CTL0, host_sim_reg_peek(FMC + SIM_FMC_CTL0) & ~FMC_CTL0_LK);
+            }
+            sim_fmc.key = 0U;
+        }
+        return 0U;
+    case SIM_FMC_STAT0:
+        /* BUSY is read only, the error and end flags clear on a 1 */
+        newval = oldval & ~(newval & SIM_FMC_STAT0_W1C);
+        host_sim_reg_poke(addr, newval);
+        sim_fmc_irq_update();
+        return newval;
+    case SIM_FMC_CTL0:
+        /* locked, only LK itself reads back; LK is set by writing 1 */
+        if(0U != (oldval & FMC_CTL0_LK)){
+            return oldval;
+        }
+        newval |= oldval & FMC_CTL0_LK;
+        host_sim_reg_poke(addr, newval & ~FMC_CTL0_START);
+        if((0U != (newval & FMC_CTL0_START)) && (SIM_FMC_IDLE == sim_fmc.operation)){
+            if(0U != (newval & FMC_CTL0_PER)){
+                page = host_sim_reg_peek(FMC + SIM_FMC_ADDR0);
+                if((page < SIM_FLASH_BASE) || (page >= (SIM_FLASH_BASE + HOST_SIM_FLASH_SIZE))){
+                    sim_fmc_end(FMC_STAT0_PGERR);
+                }else{
+                    sim_fmc.operation = SIM_FMC_PAGE_ERASE;
+                    sim_fmc.addr = page & ~(SIM_FLASH_PAGE_SIZE - 1U);
+                    sim_fmc.busy = sim_fmc.erase_ticks;
+                }
+            }else if(0U != (newval & FMC_CTL0_MER)){
+                sim_fmc.operation = SIM_FMC_MASS_ERASE;
+                sim_fmc.busy = 4U * sim_fmc.erase_ticks;
+            }
+            if(SIM_FMC_IDLE != sim_fmc.operation){
+                host_sim_reg_poke(FMC + SIM_FMC_STAT0, host_sim_reg_peek(FMC + SIM_FMC_STAT0) | FMC_STAT0_BUSY);
+            }
+        }
+        sim_fmc_irq_update();
+        return newval & ~FMC_CTL0_START;
+    default:
+        return newval;
+    }
+}
+
+/*!
+    \brief      count down the operation in progress, its result lands in the
+                flash when it ends
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_fmc_tick(void)
+{
+    uint32_t addr;
+
+    if((SIM_FMC_IDLE == sim_fmc.operation) || (0U != --sim_fmc.busy)){
+        return;
+    }
+    switch(sim_fmc.operation){
+    case SIM_FMC_PROGRAM:
+        host_sim_reg_poke(sim_fmc.addr, sim_fmc.data);
+        sim_fmc.ops.programs++;
+        break;
+    case SIM_FMC_PAGE_ERASE:
+        for(addr = sim_fmc.addr; addr < (sim_fmc.addr + SIM_FLASH_PAGE_SIZE); addr += 4U){
+            host_sim_reg_poke(addr, 0xFFFFFFFFU);
+        }
+        sim_fmc.ops.page_erases++;
+        break;
+    default:
+        sim_flash_reset();
+        sim_fmc.ops.mass_erases++;
+        break;
+    }
+    sim_fmc_end(0U);
+}
+
+/*!
+    \brief      fill the flash with the erased value
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_flash_reset(void)
+{
+    uint32_t addr;
+
+    for(addr = SIM_FLASH_BASE; addr < (SIM_FLASH_BASE + HOST_SIM_FLASH_SIZE); addr += 4U){
+        host_sim_reg_poke(addr, 0xFFFFFFFFU);
+    }
+}
+
+/*!
+    \brief      accept a program while PG is set and the FMC is idle; the half
+                words that change must be erased, or PGERR is set and nothing
+                is written; any other write leaves the flash as it was
+    \param[in]  addr: word address in the flash
+    \param[in]  oldval: flash contents before the write
+    \param[in]  newval: value written, merged with the flash contents for a half word
+    \param[out] none
+    \retval     flash contents, the program lands when it ends
+*/
+static uint32_t sim_flash_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    uint32_t ctl = host_sim_reg_peek(FMC + SIM_FMC_CTL0);
+    uint32_t changed = oldval ^ newval;
+
+    if((0U != (ctl & FMC_CTL0_LK)) || (0U == (ctl & FMC_CTL0_PG)) || (SIM_FMC_IDLE != sim_fmc.operation)){
+        return oldval;
+    }
+    if(((0U != (changed & 0x0000FFFFU)) && (0x0000FFFFU != (oldval & 0x0000FFFFU)))
+       || ((0U != (changed & 0xFFFF0000U)) && (0xFFFF0000U != (oldval & 0xFFFF0000U)))){
+        sim_fmc_end(FMC_STAT0_PGERR);
+        return oldval;
+    }
+    sim_fmc.operation = SIM_FMC_PROGRAM;
+    sim_fmc.addr = addr;
+    sim_fmc.data = newval;
+    sim_fmc.busy = sim_fmc.program_ticks;
+    host_sim_reg_poke(FMC + SIM_FMC_STAT0, host_sim_reg_peek(FMC + SIM_FMC_STAT0) | FMC_STAT0_BUSY);
+    return oldval;
+}
+
+/*!
+    \brief      end the operation in progress, or refuse one with an error flag
+    \param[in]  error: FMC_STAT0_PGERR or FMC_STAT0_WPERR, 0 for a good end
+    \param[out] none
+    \retval     none
+*/
+static void sim_fmc_end(uint32_t error)
+{
+    uint32_t stat = host_sim_reg_peek(FMC + SIM_FMC_STAT0) & ~FMC_STAT0_BUSY;
+
+    if(0U != error){
+        stat |= error;
+        sim_fmc.ops.errors++;
+    }else{
+        stat |= FMC_STAT0_ENDF;
+    }
+    host_sim_reg_poke(FMC + SIM_FMC_STAT0, stat);
+    sim_fmc.operation = SIM_FMC_IDLE;
+    sim_fmc.busy = 0U;
+    sim_fmc_irq_update();
+}
+
+/*!
+    \brief      recompute the interrupt line from the end and error flags and their enables
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_fmc_irq_update(void)
+{
+    uint32_t stat = host_sim_reg_peek(FMC + SIM_FMC_STAT0);
+    uint32_t ctl = host_sim_reg_peek(FMC + SIM_FMC_CTL0);
+    uint32_t level = 0U;
+
+    if((0U != (ctl & FMC_CTL0_ENDIE)) && (0U != (stat & FMC_STAT0_ENDF))){
+        level = 1U;
+    }
+    if((0U != (ctl & FMC_CTL0_ERRIE)) && (0U != (stat & (FMC_STAT0_PGERR | FMC_STAT0_WPERR)))){
+        level = 1U;
+    }
+    host_sim_irq_set(FMC_IRQn, (0U != level) ? ENABLE : DISABLE);
+}
@@ -0,0 +1,153 @@
+/*!
+    \file  host_sim_gpio.c
+    \brief GPIO register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "host_sim.h"
+
+#define SIM_GPIO_PORT_NUM           5U
+#define SIM_GPIO_CTL_RESET_VALUE    0x44444444U
+
+static uint32_t sim_gpio_input[SIM_GPIO_PORT_NUM];
+
+/* load the register reset values */
+static void sim_gpio_reset(void);
+/* latch a register write, bit operation registers act on the output */
+static uint32_t sim_gpio_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* recompute the input status register of a port */
+static void sim_gpio_istat_update(uint32_t gpio_periph);
+
+const host_sim_model_struct host_sim_gpio_model = {
+    GPIOA, SIM_GPIO_PORT_NUM * 0x00000400U, sim_gpio_reset, NULL, sim_gpio_write, NULL
+};
+
+/*!
+    \brief      drive the input level of GPIO pins
+    \param[in]  gpio_periph: GPIOx(x = A,B,C,D,E)
+    \param[in]  pin: GPIO_PIN_x(x=0..15), GPIO_PIN_ALL
+    \param[in]  level: SET or RESET
+    \param[out] none
+    \retval     none
+*/
+void host_sim_gpio_input_set(uint32_t gpio_periph, uint32_t pin, FlagStatus level)
+{
+    uint32_t port = (gpio_periph - GPIOA) / 0x00000400U;
+
+    if(RESET == level){
+        sim_gpio_input[port] &= ~pin;
+    }else{
+        sim_gpio_input[port] |= pin;
+    }
+    sim_gpio_istat_update(gpio_periph);
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_gpio_reset(void)
+{
+    uint32_t port;
+
+    for(port = 0U; port < SIM_GPIO_PORT_NUM; port++){
+        sim_gpio_input[port] = 0U;
+        host_sim_reg_poke(GPIOA + port * 0x00000400U + 0x00U, SIM_GPIO_CTL_RESET_VALUE);
+        host_sim_reg_poke(GPIOA + port * 0x00000400U + 0x04U, SIM_GPIO_CTL_RESET_VALUE);
+    }
+}
+
+/*!
+    \brief      latch a register write, bit operation registers act on the output
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_gpio_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    uint32_t gpio_periph = addr & ~0x000003FFU;
+    uint32_t octl = host_sim_reg_peek(gpio_periph + 0x0CU);
+
+    switch(addr - gpio_periph){
+    case 0x00U:
+    case 0x04U:
+    case 0x0CU:
+        /* GPIO_CTL0, GPIO_CTL1, GPIO_OCTL */
+        host_sim_reg_poke(addr, newval);
+        sim_gpio_istat_update(gpio_periph);
+        return newval;
+    case 0x10U:
+        /* GPIO_BOP: the clear half is overridden by the set half */
+        octl &= ~(newval >> 16);
+        octl |= (newval & 0x0000FFFFU);
+        break;
+    case 0x14U:
+        /* GPIO_BC */
+        octl &= ~(newval & 0x0000FFFFU);
+        break;
+    case 0x18U:
+        /* GPIO_LOCK */
+        return newval;
+    default:
+        /* GPIO_ISTAT is read only */
+        return oldval;
+    }
+    host_sim_reg_poke(gpio_periph + 0x0CU, octl);
+    sim_gpio_istat_update(gpio_periph);
+    return 0U;
+}
+
+/*!
+    \brief      recompute the input status register of a port
+    \param[in]  gpio_periph: GPIOx(x = A,B,C,D,E)
+    \param[out] none
+    \retval     none
+*/
+static void sim_gpio_istat_update(uint32_t gpio_periph)
+{
+    uint32_t port = (gpio_periph - GPIOA) / 0x00000400U;
+    uint64_t ctl = ((uint64_t)host_sim_reg_peek(gpio_periph + 0x04U) << 32) | host_sim_reg_peek(gpio_periph + 0x00U);
+    uint32_t output = 0U;
+    uint32_t pin;
+
+    /* pins with a non-zero MD field are outputs and read back their output latch */
+    for(pin = 0U; pin < 16U; pin++){
+        if(0U != ((ctl >> (pin * 4U)) & 0x3U)){
+            output |= BIT(pin);
+        }
+    }
+    host_sim_reg_poke(gpio_periph + 0x08U, (host_sim_reg_peek(gpio_periph + 0x0CU) & output)
+                                            | (sim_gpio_input[port] & ~output));
+}
@@ -0,0 +1,470 @@
+/*!
+    \file  host_sim_i2c.c
+    \brief I2C register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "host_sim.h"
+
+#define SIM_I2C_NUM                 2U
+#define SIM_I2C_STAT0_ERRORS        (I2C_STAT0_BERR | I2C_STAT0_LOSTARB | I2C_STAT0_AERR | I2C_STAT0_OUERR | \
+                                     I2C_STAT0_PECERR | I2C_STAT0_SMBTO | I2C_STAT0_SMBALT)
+#define SIM_I2C_STAT0_EVENTS        (I2C_STAT0_SBSEND | I2C_STAT0_ADDSEND | I2C_STAT0_BTC | I2C_STAT0_ADD10SEND | I2C_STAT0_STPDET)
+
+/* bus phase of the master */
+#define SIM_I2C_IDLE                0U                              /* not master, bus free */
+#define SIM_I2C_START               1U                              /* start condition on the bus */
+#define SIM_I2C_ADDRESS             2U                              /* address byte expected or on the bus */
+#define SIM_I2C_TX                  3U                              /* addressed for a write */
+#define SIM_I2C_RX                  4U                              /* addressed for a read */
+#define SIM_I2C_HOLD                5U                              /* address refused, bus held until STOP or START */
+#define SIM_I2C_STOP                6U                              /* stop condition on the bus, CTL0_STOP still set */
+
+/* I2C instance state */
+typedef struct
+{
+    uint32_t periph;                                                /* I2C base address */
+    IRQn_Type ev_irq;                                               /* event interrupt line */
+    IRQn_Type er_irq;                                               /* error interrupt line */
+    uint32_t dma_tx;                                                /* DMA0 channel of the transmit request */
+    uint32_t dma_rx;                                                /* DMA0 channel of the receive request */
+    uint32_t byte_ticks;                                            /* bus ticks per byte on the bus */
+    uint32_t phase;                                                 /* bus phase, SIM_I2C_IDLE to SIM_I2C_STOP */
+    uint32_t timer;                                                 /* ticks left for the condition or byte on the bus */
+    uint32_t shift;                                                 /* byte on the bus or held by the shift register */
+    uint32_t shift_full;                                            /* receiver: a byte waits in the shift register */
+    uint32_t tx_data;                                               /* transmitter: byte written to DATA */
+    uint32_t tx_full;                                               /* transmitter: DATA holds a byte */
+    uint32_t rx_ack;                                                /* receiver with POAP: ACK of the byte on the bus */
+    uint32_t rx_end;                                                /* receiver: a byte was not acknowledged */
+    uint32_t stat0_read;                                            /* STAT0 was read, clears SBSEND, ADDSEND and BTC */
+    uint32_t slave_addr;                                            /* address of the attached slave in bits 7:1 */
+    uint8_t *mem;                                                   /* register file of the slave, NULL if none */
+    uint32_t size;                                                  /* size of the register file */
+    uint32_t pointer;                                               /* register pointer of the slave */
+    uint32_t pointer_set;                                           /* the first byte of this write set the pointer */
+}sim_i2c_struct;
+
+static sim_i2c_struct sim_i2c[SIM_I2C_NUM] = {
+    {.periph = I2C0, .ev_irq = I2C0_EV_IRQn, .er_irq = I2C0_ER_IRQn, .dma_tx = DMA_CH5, .dma_rx = DMA_CH6},
+    {.periph = I2C1, .ev_irq = I2C1_EV_IRQn, .er_irq = I2C1_ER_IRQn, .dma_tx = DMA_CH3, .dma_rx = DMA_CH4},
+};
+
+/* load the register reset values */
+static void sim_i2c_reset(void);
+/* apply the side effects of a register read */
+static void sim_i2c_read(uint32_t addr);
+/* latch a register write */
+static uint32_t sim_i2c_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* move the bus of every instance by one bus tick */
+static void sim_i2c_tick(void);
+/* end the condition or byte on the bus */
+static void sim_i2c_bus_done(sim_i2c_struct *i2c);
+/* start the next condition or byte when the bus waits */
+static void sim_i2c_bus_next(sim_i2c_struct *i2c);
+/* find the instance owning an address */
+static sim_i2c_struct *sim_i2c_find(uint32_t addr);
+/* recompute the interrupt lines of an instance */
+static void sim_i2c_irq_update(sim_i2c_struct *i2c);
+
+const host_sim_model_struct host_sim_i2c_model = {
+    I2C0, 0x00000800U, sim_i2c_reset, sim_i2c_read, sim_i2c_write, sim_i2c_tick
+};
+
+/*!
+    \brief      attach a slave with a register file to an I2C bus, the first byte
+                of a write sets the register pointer, the next bytes are written
+                and reads return bytes from the pointer on
+    \param[in]  i2c_periph: I2Cx(x=0,1)
+    \param[in]  addr: slave address in bits 7:1, as passed to i2c_master_addressing
+    \param[in]  mem: register file, NULL detaches the slave
+    \param[in]  size: size of the register file in bytes
+    \param[out] none
+    \retval     none
+*/
+void host_sim_i2c_slave_attach(uint32_t i2c_periph, uint32_t addr, uint8_t *mem, uint32_t size)
+{
+    sim_i2c_struct *i2c = sim_i2c_find(i2c_periph);
+
+    i2c->slave_addr = addr & 0xFEU;
+    i2c->mem = mem;
+    i2c->size = (0U == size) ? 1U : size;
+    i2c->pointer = 0U;
+}
+
+/*!
+    \brief      configure the number of bus ticks needed to shift one I2C byte
+    \param[in]  i2c_periph: I2Cx(x=0,1)
+    \param[in]  ticks: bus ticks per byte, at least 1
+    \param[out] none
+    \retval     none
+*/
+void host_sim_i2c_byte_ticks_config(uint32_t i2c_periph, uint32_t ticks)
+{
+    sim_i2c_find(i2c_periph)->byte_ticks = (0U == ticks) ? 1U : ticks;
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_i2c_reset(void)
+{
+    uint32_t i;
+
+    for(i = 0U; i < SIM_I2C_NUM; i++){
+        sim_i2c[i].byte_ticks = HOST_SIM_I2C_BYTE_TICKS;
+        sim_i2c[i].phase = SIM_I2C_IDLE;
+        sim_i2c[i].timer = 0U;
+        sim_i2c[i].shift_full = 0U;
+        sim_i2c[i].tx_full = 0U;
+        sim_i2c[i].rx_end = 0U;
+        sim_i2c[i].stat0_read = 0U;
+        sim_i2c[i].pointer = 0U;
+    }
+}
+
+/*!
+    \brief      apply the side effects of a register read
+    \param[in]  addr: word address of the register
+    \param[out] none
+    \retval     none
+*/
+static void sim_i2c_read(uint32_t addr)
+{
+    sim_i2c_struct *i2c = sim_i2c_find(addr);
+    uint32_t stat0 = host_sim_reg_peek(i2c->periph + 0x14U);
+
+    switch(addr - i2c->periph){
+    case 0x10U:
+        /* DATA: empties the receive buffer, a byte waiting in the shift register moves up */
+        if(0U != i2c->stat0_read){
+            stat0 &= ~I2C_STAT0_BTC;
+        }
+        stat0 &= ~I2C_STAT0_RBNE;
+        if(0U != i2c->shift_full){
+            host_sim_reg_poke(i2c->periph + 0x10U, i2c->shift);
+            stat0 |= I2C_STAT0_RBNE;
+            stat0 &= ~I2C_STAT0_BTC;
+            i2c->shift_full = 0U;
+        }
+        i2c->stat0_read = 0U;
+        break;
+    case 0x14U:
+        i2c->stat0_read = 1U;
+        break;
+    case 0x18U:
+        /* STAT1 after STAT0 clears ADDSEND and opens the data phase */
+        if((0U != i2c->stat0_read) && (0U != (stat0 & I2C_STAT0_ADDSEND))){
+            stat0 &= ~I2C_STAT0_ADDSEND;
+            if(0U != (host_sim_reg_peek(i2c->periph + 0x18U) & I2C_STAT1_TR)){
+                i2c->phase = SIM_I2C_TX;
+                stat0 |= I2C_STAT0_TBE;
+            }else{
+                i2c->phase = SIM_I2C_RX;
+            }
+        }
+        i2c->stat0_read = 0U;
+        break;
+    default:
+        break;
+    }
+    host_sim_reg_poke(i2c->periph + 0x14U, stat0);
+    sim_i2c_irq_update(i2c);
+}
+
+/*!
+    \brief      latch a register write
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_i2c_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    sim_i2c_struct *i2c = sim_i2c_find(addr);
+    uint32_t stat0 = host_sim_reg_peek(i2c->periph + 0x14U);
+
+    switch(addr - i2c->periph){
+    case 0x00U:
+        /* CTL0: a software reset puts the whole instance back into its reset state */
+        if(0U != (newval & I2C_CTL0_SRESET)){
+            i2c->phase = SIM_I2C_IDLE;
+            i2c->timer = 0U;
+            i2c->shift_full = 0U;
+            i2c->tx_full = 0U;
+            host_sim_reg_poke(i2c->periph + 0x14U, 0U);
+            host_sim_reg_poke(i2c->periph + 0x18U, 0U);
+            newval = I2C_CTL0_SRESET;
+        }
+        host_sim_reg_poke(addr, newval);
+        break;
+    case 0x10U:
+        /* DATA: the address after a start, data bytes in the transmitter phase */
+        if((0U != (stat0 & I2C_STAT0_SBSEND)) && (0U != i2c->stat0_read)){
+            stat0 &= ~I2C_STAT0_SBSEND;
+            i2c->shift = newval & 0xFFU;
+            i2c->timer = i2c->byte_ticks;
+        }else if(SIM_I2C_TX == i2c->phase){
+            i2c->tx_data = newval & 0xFFU;
+            i2c->tx_full = 1U;
+            stat0 &= ~(I2C_STAT0_TBE | I2C_STAT0_BTC);
+        }
+        i2c->stat0_read = 0U;
+        host_sim_reg_poke(i2c->periph + 0x14U, stat0);
+        newval = oldval;
+        break;
+    case 0x14U:
+        /* STAT0: only the error flags can be cleared by software */
+        newval = oldval & (newval | ~SIM_I2C_STAT0_ERRORS);
+        host_sim_reg_poke(addr, newval);
+        break;
+    case 0x18U:
+        /* STAT1 is read only */
+        newval = oldval;
+        break;
+    default:
+        host_sim_reg_poke(addr, newval);
+        break;
+    }
+    sim_i2c_irq_update(i2c);
+    return newval;
+}
+
+/*!
+    \brief      move the bus of every instance by one bus tick
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_i2c_tick(void)
+{
+    sim_i2c_struct *i2c;
+    uint32_t stat0, ctl1, i;
+
+    for(i = 0U; i < SIM_I2C_NUM; i++){
+        i2c = &sim_i2c[i];
+        if(0U == (host_sim_reg_peek(i2c->periph + 0x00U) & I2C_CTL0_I2CEN)){
+            continue;
+        }
+
+        if((0U != i2c->timer) && (0U == --i2c->timer)){
+            sim_i2c_bus_done(i2c);
+        }
+        if(0U == i2c->timer){
+            sim_i2c_bus_next(i2c);
+        }
+
+        /* DMA requests, the transfers go through the DATA register model */
+        stat0 = host_sim_reg_peek(i2c->periph + 0x14U);
+        ctl1 = host_sim_reg_peek(i2c->periph + 0x04U);
+        if(0U != (ctl1 & I2C_CTL1_DMAON)){
+            if((SIM_I2C_TX == i2c->phase) && (0U != (stat0 & I2C_STAT0_TBE))){
+                host_sim_dma_request(DMA0, i2c->dma_tx);
+            }
+            if(0U != (stat0 & I2C_STAT0_RBNE)){
+                host_sim_dma_request(DMA0, i2c->dma_rx);
+            }
+        }
+        sim_i2c_irq_update(i2c);
+    }
+}
+
+/*!
+    \brief      end the condition or byte on the bus
+    \param[in]  i2c: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_i2c_bus_done(sim_i2c_struct *i2c)
+{
+    uint32_t ctl0 = host_sim_reg_peek(i2c->periph + 0x00U);
+    uint32_t ctl1 = host_sim_reg_peek(i2c->periph + 0x04U);
+    uint32_t stat0 = host_sim_reg_peek(i2c->periph + 0x14U);
+    uint32_t stat1 = host_sim_reg_peek(i2c->periph + 0x18U);
+    uint32_t ack, remain;
+
+    switch(i2c->phase){
+    case SIM_I2C_START:
+        stat0 |= I2C_STAT0_SBSEND;
+        stat1 |= I2C_STAT1_MASTER | I2C_STAT1_I2CBSY;
+        host_sim_reg_poke(i2c->periph + 0x00U, ctl0 & ~I2C_CTL0_START);
+        i2c->phase = SIM_I2C_ADDRESS;
+        break;
+    case SIM_I2C_ADDRESS:
+        if((NULL != i2c->mem) && ((i2c->shift & 0xFEU) == i2c->slave_addr)){
+            stat0 |= I2C_STAT0_ADDSEND;
+            if(0U == (i2c->shift & 0x01U)){
+                stat1 |= I2C_STAT1_TR;
+                i2c->pointer_set = 0U;
+            }else{
+                /* with POAP the ACK of the first byte is decided by ACKEN at this point */
+                stat1 &= ~I2C_STAT1_TR;
+                i2c->rx_ack = ctl0 & I2C_CTL0_ACKEN;
+            }
+        }else{
+            stat0 |= I2C_STAT0_AERR;
+            i2c->phase = SIM_I2C_HOLD;
+        }
+        break;
+    case SIM_I2C_TX:
+        /* the slave takes the byte, the first one of a write is its register pointer */
+        if(0U == i2c->pointer_set){
+            i2c->pointer = i2c->shift % i2c->size;
+            i2c->pointer_set = 1U;
+        }else{
+            i2c->mem[i2c->pointer] = (uint8_t)i2c->shift;
+            i2c->pointer = (i2c->pointer + 1U) % i2c->size;
+        }
+        if(0U == i2c->tx_full){
+            stat0 |= I2C_STAT0_BTC;
+        }
+        break;
+    case SIM_I2C_RX:
+        /* ACK from ACKEN, sampled one byte earlier with POAP, and NACK on the last DMA byte with DMALST */
+        if(0U != (ctl0 & I2C_CTL0_POAP)){
+            ack = i2c->rx_ack;
+            i2c->rx_ack = ctl0 & I2C_CTL0_ACKEN;
+        }else{
+            ack = ctl0 & I2C_CTL0_ACKEN;
+        }
+        if((I2C_CTL1_DMAON | I2C_CTL1_DMALST) == (ctl1 & (I2C_CTL1_DMAON | I2C_CTL1_DMALST))){
+            remain = host_sim_reg_peek((uint32_t)(uintptr_t)&DMA_CHCNT(DMA0, i2c->dma_rx));
+            if(0U != (stat0 & I2C_STAT0_RBNE)){
+                remain--;
+            }
+            if(1U == remain){
+                ack = 0U;
+            }
+        }
+        if(0U == (stat0 & I2C_STAT0_RBNE)){
+            host_sim_reg_poke(i2c->periph + 0x10U, i2c->shift);
+            stat0 |= I2C_STAT0_RBNE;
+        }else{
+            i2c->shift_full = 1U;
+            stat0 |= I2C_STAT0_BTC;
+        }
+        if(0U == ack){
+            i2c->rx_end = 1U;
+        }
+        break;
+    case SIM_I2C_STOP:
+        /* the hardware clears STOP once the condition is on the bus */
+        host_sim_reg_poke(i2c->periph + 0x00U, ctl0 & ~I2C_CTL0_STOP);
+        stat1 &= ~(I2C_STAT1_MASTER | I2C_STAT1_I2CBSY | I2C_STAT1_TR);
+        i2c->phase = SIM_I2C_IDLE;
+        break;
+    default:
+        break;
+    }
+    host_sim_reg_poke(i2c->periph + 0x14U, stat0);
+    host_sim_reg_poke(i2c->periph + 0x18U, stat1);
+}
+
+/*!
+    \brief      start the next condition or byte when the bus waits
+    \param[in]  i2c: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_i2c_bus_next(sim_i2c_struct *i2c)
+{
+    uint32_t ctl0 = host_sim_reg_peek(i2c->periph + 0x00U);
+    uint32_t stat0 = host_sim_reg_peek(i2c->periph + 0x14U);
+    uint32_t stat1 = host_sim_reg_peek(i2c->periph + 0x18U);
+
+    if((SIM_I2C_TX == i2c->phase) && (0U != i2c->tx_full)){
+        /* DATA moves to the shift register, TBE rises again */
+        i2c->shift = i2c->tx_data;
+        i2c->tx_full = 0U;
+        i2c->timer = i2c->byte_ticks;
+        stat0 |= I2C_STAT0_TBE;
+    }else if((0U != (ctl0 & I2C_CTL0_STOP)) && (0U != (stat1 & I2C_STAT1_MASTER)) && (SIM_I2C_STOP != i2c->phase)){
+        /* a STOP condition and the bus free time take about two bit times */
+        stat0 &= ~(I2C_STAT0_TBE | I2C_STAT0_BTC | I2C_STAT0_SBSEND | I2C_STAT0_ADDSEND);
+        i2c->phase = SIM_I2C_STOP;
+        i2c->timer = (i2c->byte_ticks >= 8U) ? (i2c->byte_ticks / 4U) : 2U;
+    }else if((0U != (ctl0 & I2C_CTL0_START)) && (SIM_I2C_START != i2c->phase) && (SIM_I2C_ADDRESS != i2c->phase)){
+        stat0 &= ~(I2C_STAT0_TBE | I2C_STAT0_BTC);
+        i2c->phase = SIM_I2C_START;
+        i2c->timer = 1U;
+        i2c->shift_full = 0U;
+        i2c->rx_end = 0U;
+    }else if((SIM_I2C_RX == i2c->phase) && (0U == i2c->rx_end) && (0U == i2c->shift_full)){
+        /* the slave sends the next byte from its register pointer */
+        i2c->shift = i2c->mem[i2c->pointer];
+        i2c->pointer = (i2c->pointer + 1U) % i2c->size;
+        i2c->timer = i2c->byte_ticks;
+    }
+    host_sim_reg_poke(i2c->periph + 0x14U, stat0);
+    host_sim_reg_poke(i2c->periph + 0x18U, stat1);
+}
+
+/*!
+    \brief      find the instance owning an address
+    \param[in]  addr: register or base address
+    \param[out] none
+    \retval     instance state
+*/
+static sim_i2c_struct *sim_i2c_find(uint32_t addr)
+{
+    return ((addr & ~0x000003FFU) == I2C1) ? &sim_i2c[1] : &sim_i2c[0];
+}
+
+/*!
+    \brief      recompute the interrupt lines of an instance
+    \param[in]  i2c: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_i2c_irq_update(sim_i2c_struct *i2c)
+{
+    uint32_t ctl1 = host_sim_reg_peek(i2c->periph + 0x04U);
+    uint32_t stat0 = host_sim_reg_peek(i2c->periph + 0x14U);
+    uint32_t event = 0U;
+    uint32_t error = 0U;
+
+    if(0U != (ctl1 & I2C_CTL1_EVIE)){
+        event = stat0 & SIM_I2C_STAT0_EVENTS;
+        if(0U != (ctl1 & I2C_CTL1_BUFIE)){
+            event |= stat0 & (I2C_STAT0_TBE | I2C_STAT0_RBNE);
+        }
+    }
+    if(0U != (ctl1 & I2C_CTL1_ERRIE)){
+        error = stat0 & SIM_I2C_STAT0_ERRORS;
+    }
+    host_sim_irq_set(i2c->ev_irq, (0U != event) ? ENABLE : DISABLE);
+    host_sim_irq_set(i2c->er_irq, (0U != error) ? ENABLE : DISABLE);
+}
@@ -0,0 +1,93 @@
+/*!
+    \file  host_sim_rcu.c
+    \brief RCU register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "host_sim.h"
+
+#define SIM_RCU_CTL_RESET_VALUE     (RCU_CTL_IRC8MEN | RCU_CTL_IRC8MSTB | 0x00000080U)
+
+/* load the register reset values */
+static void sim_rcu_reset(void);
+/* latch a register write, oscillators and PLLs lock immediately */
+static uint32_t sim_rcu_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+
+const host_sim_model_struct host_sim_rcu_model = {
+    RCU, 0x00000400U, sim_rcu_reset, NULL, sim_rcu_write, NULL
+};
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_rcu_reset(void)
+{
+    host_sim_reg_poke(RCU + 0x00U, SIM_RCU_CTL_RESET_VALUE);
+}
+
+/*!
+    \brief      latch a register write, oscillators and PLLs lock immediately
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_rcu_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    (void)oldval;
+
+    switch(addr - RCU){
+    case 0x00U:
+        /* RCU_CTL: every enabled clock source reports stable */
+        newval &= ~(RCU_CTL_IRC8MSTB | RCU_CTL_HXTALSTB | RCU_CTL_PLLSTB | RCU_CTL_PLL1STB | RCU_CTL_PLL2STB);
+        newval |= (newval & (RCU_CTL_IRC8MEN | RCU_CTL_HXTALEN | RCU_CTL_PLLEN | RCU_CTL_PLL1EN | RCU_CTL_PLL2EN)) << 1;
+        break;
+    case 0x04U:
+        /* RCU_CFG0: the clock switch completes at once */
+        newval = (newval & ~RCU_CFG0_SCSS) | ((newval & RCU_CFG0_SCS) << 2);
+        break;
+    case 0x20U:
+        /* RCU_BDCTL */
+        newval = (newval & ~RCU_BDCTL_LXTALSTB) | ((newval & RCU_BDCTL_LXTALEN) << 1);
+        break;
+    case 0x24U:
+        /* RCU_RSTSCK */
+        newval = (newval & ~RCU_RSTSCK_IRC40KSTB) | ((newval & RCU_RSTSCK_IRC40KEN) << 1);
+        break;
+    default:
+        break;
+    }
+    return newval;
+}
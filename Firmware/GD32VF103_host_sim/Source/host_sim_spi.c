@@ -0,0 +1,713 @@
+/*!
+    \file  host_sim_spi.c
+    \brief SPI register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "host_sim.h"
+
+#define SIM_SPI_NUM                 3U
+#define SIM_SPI_CTL0_MODE           (SPI_CTL0_CKPH | SPI_CTL0_CKPL | SPI_CTL0_LF | SPI_CTL0_FF16)
+#define SIM_I2S_ENABLED             (SPI_I2SCTL_I2SSEL | SPI_I2SCTL_I2SEN)
+
+/* SPI NOR flash commands of the NOR slave */
+#define SIM_NOR_WRITE_ENABLE        0x06U
+#define SIM_NOR_WRITE_DISABLE       0x04U
+#define SIM_NOR_READ_STATUS         0x05U
+#define SIM_NOR_READ_ID             0x9FU
+#define SIM_NOR_READ                0x03U
+#define SIM_NOR_FAST_READ           0x0BU
+#define SIM_NOR_PAGE_PROGRAM        0x02U
+#define SIM_NOR_SECTOR_ERASE        0x20U
+#define SIM_NOR_BLOCK_ERASE         0xD8U
+#define SIM_NOR_CHIP_ERASE          0xC7U
+
+/* slave selected by a GPIO pin */
+typedef struct
+{
+    uint32_t gpio_periph;                                           /* GPIO port of the chip select, 0 if the slot is free */
+    uint32_t pin;                                                   /* GPIO pin of the chip select */
+    uint32_t mode;                                                  /* CKPH, CKPL, LF and FF16 bits the slave expects */
+    uint8_t *mem;                                                   /* bytes shifted out, replaced by the bytes shifted in */
+    uint32_t size;                                                  /* size of mem */
+    uint32_t pos;                                                   /* next byte of mem, back to 0 while deselected */
+    uint32_t errors;                                                /* frames seen in the wrong mode or together with another slave */
+    uint32_t selected;                                              /* chip select was low at the last tick */
+    uint32_t nor;                                                   /* the slave decodes SPI NOR flash commands */
+    uint32_t cmd;                                                   /* NOR: command of the current selection */
+    uint32_t addr;                                                  /* NOR: address of the command */
+    uint32_t wel;                                                   /* NOR: write enable latch */
+    uint32_t wip;                                                   /* NOR: ticks left of a program or erase */
+}sim_spi_slave_struct;
+
+/* SPI instance state */
+typedef struct
+{
+    uint32_t periph;                                                /* SPI base address */
+    IRQn_Type irq;                                                  /* interrupt line */
+    uint32_t dma_periph;                                            /* DMA serving the SPI */
+    uint32_t dma_rx;                                                /* DMA channel of the receive request */
+    uint32_t dma_tx;                                                /* DMA channel of the transmit request */
+    uint32_t frame_ticks;                                           /* bus ticks per frame */
+    uint32_t busy;                                                  /* shift register is exchanging a frame */
+    uint32_t timer;                                                 /* ticks left for the frame being exchanged */
+    uint32_t shift;                                                 /* frame being sent */
+    uint32_t tx_buffer;                                             /* frame waiting for the shift register */
+    uint16_t *i2s_mem;                                              /* I2S: frames sent or to be received, NULL for none */
+    uint32_t i2s_size;                                              /* I2S: number of frames in i2s_mem */
+    uint32_t i2s_pos;                                               /* I2S: next frame of i2s_mem */
+    uint32_t i2s_frames;                                            /* I2S: frames exchanged */
+    uint32_t i2s_gaps;                                              /* I2S: frames sent without data or received while RBNE was set */
+    sim_spi_slave_struct slave[HOST_SIM_SPI_SLAVE_NUM];
+}sim_spi_struct;
+
+static sim_spi_struct sim_spi[SIM_SPI_NUM] = {
+    {.periph = SPI0, .irq = SPI0_IRQn, .dma_periph = DMA0, .dma_rx = DMA_CH1, .dma_tx = DMA_CH2},
+    {.periph = SPI1, .irq = SPI1_IRQn, .dma_periph = DMA0, .dma_rx = DMA_CH3, .dma_tx = DMA_CH4},
+    {.periph = SPI2, .irq = SPI2_IRQn, .dma_periph = DMA1, .dma_rx = DMA_CH0, .dma_tx = DMA_CH1},
+};
+
+/* load the register reset values */
+static void sim_spi_reset(void);
+/* apply the side effects of a register read */
+static void sim_spi_read(uint32_t addr);
+/* latch a register write */
+static uint32_t sim_spi_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* shift every instance by one bus tick */
+static void sim_spi_tick(void);
+/* exchange one I2S frame when its time has come */
+static void sim_spi_i2s_tick(sim_spi_struct *spi, uint32_t i2sctl);
+/* exchange the frame in the shift register with the selected slave */
+static uint32_t sim_spi_exchange(sim_spi_struct *spi, uint32_t ctl0, uint32_t frame);
+/* shift one byte through a NOR slave */
+static uint32_t sim_spi_nor_byte(sim_spi_slave_struct *slave, uint32_t byte);
+/* execute the program or erase command of a NOR slave when its chip select goes high */
+static void sim_spi_nor_end(sim_spi_slave_struct *slave);
+/* get the chip select level of a slave */
+static uint32_t sim_spi_selected(const sim_spi_slave_struct *slave);
+/* find the instance owning an address */
+static sim_spi_struct *sim_spi_find(uint32_t addr);
+/* recompute the interrupt line of an instance */
+static void sim_spi_irq_update(sim_spi_struct *spi);
+
+const host_sim_model_struct host_sim_spi0_model = {
+    SPI0, 0x00000400U, sim_spi_reset, sim_spi_read, sim_spi_write, sim_spi_tick
+};
+
+const host_sim_model_struct host_sim_spi_model = {
+    SPI1, 0x00000800U, NULL, sim_spi_read, sim_spi_write, NULL
+};
+
+/*!
+    \brief      attach a slave selected by a low GPIO pin to a SPI, each frame
+                shifts the next bytes of mem out and stores the bytes shifted in
+                in their place, the position goes back to the start whenever
+                the chip select is high; a slave with the same chip select is
+                replaced
+    \param[in]  spi_periph: SPIx(x=0,1,2)
+    \param[in]  gpio_periph: GPIOx(x=A,B,C,D,E) of the chip select
+    \param[in]  pin: GPIO_PIN_x(x=0..15) of the chip select
+    \param[in]  mode: SPI_CTL0 CKPH, CKPL, LF and FF16 bits the slave expects
+    \param[in]  mem: bytes of the slave, NULL detaches it
+    \param[in]  size: size of mem in bytes
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if every slot is taken
+*/
+ErrStatus host_sim_spi_slave_attach(uint32_t spi_periph, uint32_t gpio_periph, uint32_t pin, uint32_t mode,
+                                    uint8_t *mem, uint32_t size)
+{
+    sim_spi_struct *spi = sim_spi_find(spi_periph);
+    sim_spi_slave_struct *slave = NULL;
+    uint32_t i;
+
+    for(i = 0U; i < HOST_SIM_SPI_SLAVE_NUM; i++){
+        if((gpio_periph == spi->slave[i].gpio_periph) && (pin == spi->slave[i].pin)){
+            slave = &spi->slave[i];
+            break;
+        }
+        if((NULL == slave) && (0U == spi->slave[i].gpio_periph)){
+            slave = &spi->slave[i];
+        }
+    }
+    if(NULL == slave){
+        return ERROR;
+    }
+
+    slave->gpio_periph = (NULL == mem) ? 0U : gpio_periph;
+    slave->pin = pin;
+    slave->mode = mode & SIM_SPI_CTL0_MODE;
+    slave->mem = mem;
+    slave->size = (0U == size) ? 1U : size;
+    slave->pos = 0U;
+    slave->errors = 0U;
+    slave->selected = 0U;
+    slave->nor = 0U;
+    slave->wel = 0U;
+    slave->wip = 0U;
+    return SUCCESS;
+}
+
+/*!
+    \brief      attach a SPI NOR flash selected by a low GPIO pin to a SPI, it
+                answers the JEDEC ID, status, read, fast read, write enable, page
+                program and sector, block and chip erase commands in mode 0, and
+                stays busy for HOST_SIM_SPI_NOR_PROGRAM_TICKS after a page program
+                and HOST_SIM_SPI_NOR_ERASE_TICKS after an erase
+    \param[in]  spi_periph: SPIx(x=0,1,2)
+    \param[in]  gpio_periph: GPIOx(x=A,B,C,D,E) of the chip select
+    \param[in]  pin: GPIO_PIN_x(x=0..15) of the chip select
+    \param[in]  mem: flash array, NULL detaches the flash
+    \param[in]  size: size of mem in bytes, a power of two from 64 KB on
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if every slot is taken
+*/
+ErrStatus host_sim_spi_nor_attach(uint32_t spi_periph, uint32_t gpio_periph, uint32_t pin, uint8_t *mem, uint32_t size)
+{
+    sim_spi_struct *spi = sim_spi_find(spi_periph);
+    uint32_t i;
+
+    if(SUCCESS != host_sim_spi_slave_attach(spi_periph, gpio_periph, pin, 0U, mem, size)){
+        return ERROR;
+    }
+    for(i = 0U; i < HOST_SIM_SPI_SLAVE_NUM; i++){
+        if((gpio_periph == spi->slave[i].gpio_periph) && (pin == spi->slave[i].pin)){
+            spi->slave[i].nor = 1U;
+        }
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      get the number of frames a slave saw in the wrong mode or while
+                another slave of the SPI was selected as well
+    \param[in]  spi_periph: SPIx(x=0,1,2)
+    \param[in]  gpio_periph: GPIOx(x=A,B,C,D,E) of the chip select
+    \param[in]  pin: GPIO_PIN_x(x=0..15) of the chip select
+    \param[out] none
+    \retval     number of frames
+*/
+uint32_t host_sim_spi_slave_errors_get(uint32_t spi_periph, uint32_t gpio_periph, uint32_t pin)
+{
+    sim_spi_struct *spi = sim_spi_find(spi_periph);
+    uint32_t i;
+
+    for(i = 0U; i < HOST_SIM_SPI_SLAVE_NUM; i++){
+        if((gpio_periph == spi->slave[i].gpio_periph) && (pin == spi->slave[i].pin)){
+            return spi->slave[i].errors;
+        }
+    }
+    return 0U;
+}
+
+/*!
+    \brief      configure the number of bus ticks needed to exchange one SPI frame
+    \param[in]  spi_periph: SPIx(x=0,1,2)
+    \param[in]  ticks: bus ticks per frame, at least 1
+    \param[out] none
+    \retval     none
+*/
+void host_sim_spi_frame_ticks_config(uint32_t spi_periph, uint32_t ticks)
+{
+    sim_spi_find(spi_periph)->frame_ticks = (0U == ticks) ? 1U : ticks;
+}
+
+/*!
+    \brief      attach a stream of frames to the I2S of a SPI, each frame the I2S
+                sends is stored into the next word of mem and each frame it
+                receives is taken from there, wrapping at the end
+    \param[in]  spi_periph: SPIx(x=1,2)
+    \param[in]  mem: frames of the stream, NULL detaches it
+    \param[in]  size: number of frames in mem
+    \param[out] none
+    \retval     none
+*/
+void host_sim_i2s_attach(uint32_t spi_periph, uint16_t *mem, uint32_t size)
+{
+    sim_spi_struct *spi = sim_spi_find(spi_periph);
+
+    spi->i2s_mem = mem;
+    spi->i2s_size = (0U == size) ? 1U : size;
+    spi->i2s_pos = 0U;
+    spi->i2s_frames = 0U;
+    spi->i2s_gaps = 0U;
+}
+
+/*!
+    \brief      get the number of frames an I2S has exchanged
+    \param[in]  spi_periph: SPIx(x=1,2)
+    \param[out] gaps: frames sent while the transmit buffer was empty or
+                received while the last one was unread, may be NULL
+    \retval     number of frames
+*/
+uint32_t host_sim_i2s_frames_get(uint32_t spi_periph, uint32_t *gaps)
+{
+    sim_spi_struct *spi = sim_spi_find(spi_periph);
+
+    if(NULL != gaps){
+        *gaps = spi->i2s_gaps;
+    }
+    return spi->i2s_frames;
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_spi_reset(void)
+{
+    uint32_t i, j;
+
+    for(i = 0U; i < SIM_SPI_NUM; i++){
+        sim_spi[i].frame_ticks = HOST_SIM_SPI_FRAME_TICKS;
+        sim_spi[i].busy = 0U;
+        sim_spi[i].timer = 0U;
+        sim_spi[i].i2s_pos = 0U;
+        sim_spi[i].i2s_frames = 0U;
+        sim_spi[i].i2s_gaps = 0U;
+        for(j = 0U; j < HOST_SIM_SPI_SLAVE_NUM; j++){
+            sim_spi[i].slave[j].pos = 0U;
+            sim_spi[i].slave[j].errors = 0U;
+            sim_spi[i].slave[j].selected = 0U;
+            sim_spi[i].slave[j].wel = 0U;
+            sim_spi[i].slave[j].wip = 0U;
+        }
+        host_sim_reg_poke(sim_spi[i].periph + 0x08U, SPI_STAT_TBE);
+        host_sim_reg_poke(sim_spi[i].periph + 0x10U, 0x00000007U);
+    }
+}
+
+/*!
+    \brief      apply the side effects of a register read
+    \param[in]  addr: word address of the register
+    \param[out] none
+    \retval     none
+*/
+static void sim_spi_read(uint32_t addr)
+{
+    sim_spi_struct *spi = sim_spi_find(addr);
+
+    if(0x0CU == (addr - spi->periph)){
+        /* reading DATA empties the receive buffer */
+        host_sim_reg_poke(spi->periph + 0x08U, host_sim_reg_peek(spi->periph + 0x08U) & ~SPI_STAT_RBNE);
+        sim_spi_irq_update(spi);
+    }
+}
+
+/*!
+    \brief      latch a register write
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_spi_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    sim_spi_struct *spi = sim_spi_find(addr);
+    uint32_t stat = host_sim_reg_peek(spi->periph + 0x08U);
+    uint32_t ctl0 = host_sim_reg_peek(spi->periph + 0x00U);
+    uint32_t i2sctl = host_sim_reg_peek(spi->periph + 0x1CU);
+
+    switch(addr - spi->periph){
+    case 0x08U:
+        /* STAT: only the CRC error flag can be cleared by software */
+        newval = oldval & (newval | ~SPI_STAT_CRCERR);
+        break;
+    case 0x0CU:
+        /* DATA: a write feeds the transmitter, the register keeps the received frame */
+        if(SIM_I2S_ENABLED == (i2sctl & SIM_I2S_ENABLED)){
+            /* the I2S takes the frame from the buffer when the next one is due */
+            spi->tx_buffer = newval & 0xFFFFU;
+            host_sim_reg_poke(spi->periph + 0x08U, stat & ~SPI_STAT_TBE);
+        }else if((0U != (ctl0 & SPI_CTL0_SPIEN)) && (0U != (ctl0 & SPI_CTL0_MSTMOD))){
+            newval &= (0U != (ctl0 & SPI_CTL0_FF16)) ? 0xFFFFU : 0xFFU;
+            if(0U == spi->busy){
+                spi->shift = newval;
+                spi->timer = spi->frame_ticks;
+                spi->busy = 1U;
+                stat |= SPI_STAT_TRANS;
+            }else{
+                spi->tx_buffer = newval;
+                stat &= ~SPI_STAT_TBE;
+            }
+            host_sim_reg_poke(spi->periph + 0x08U, stat);
+        }
+        newval = oldval;
+        break;
+    case 0x14U:
+    case 0x18U:
+        /* the CRC values are read only */
+        newval = oldval;
+        break;
+    case 0x1CU:
+        /* I2SCTL: the first frame goes out one frame time after the enable */
+        if((0U == (oldval & SPI_I2SCTL_I2SEN)) && (0U != (newval & SPI_I2SCTL_I2SEN))){
+            spi->timer = spi->frame_ticks;
+        }
+        break;
+    default:
+        break;
+    }
+    host_sim_reg_poke(addr, newval);
+    sim_spi_irq_update(spi);
+    return newval;
+}
+
+/*!
+    \brief      shift every instance by one bus tick
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_spi_tick(void)
+{
+    sim_spi_struct *spi;
+    sim_spi_slave_struct *slave;
+    uint32_t stat, ctl0, ctl1, i2sctl, i, j;
+
+    for(i = 0U; i < SIM_SPI_NUM; i++){
+        spi = &sim_spi[i];
+
+        /* a high chip select ends the command of a slave */
+        for(j = 0U; j < HOST_SIM_SPI_SLAVE_NUM; j++){
+            slave = &spi->slave[j];
+            if(0U == slave->gpio_periph){
+                continue;
+            }
+            if(0U != slave->wip){
+                slave->wip--;
+            }
+            if(0U != sim_spi_selected(slave)){
+                slave->selected = 1U;
+                continue;
+            }
+            if((0U != slave->selected) && (0U != slave->nor)){
+                sim_spi_nor_end(slave);
+            }
+            slave->selected = 0U;
+            slave->pos = 0U;
+        }
+
+        ctl0 = host_sim_reg_peek(spi->periph + 0x00U);
+        ctl1 = host_sim_reg_peek(spi->periph + 0x04U);
+        i2sctl = host_sim_reg_peek(spi->periph + 0x1CU);
+        if(SIM_I2S_ENABLED == (i2sctl & SIM_I2S_ENABLED)){
+            sim_spi_i2s_tick(spi, i2sctl);
+            stat = host_sim_reg_peek(spi->periph + 0x08U);
+        }else if(0U == (ctl0 & SPI_CTL0_SPIEN)){
+            continue;
+        }else{
+            stat = host_sim_reg_peek(spi->periph + 0x08U);
+        }
+
+        if((0U == (i2sctl & SPI_I2SCTL_I2SSEL)) && (0U != spi->busy) && (0U == --spi->timer)){
+            if(0U != (stat & SPI_STAT_RBNE)){
+                /* the new frame is lost, DATA keeps the unread one */
+                stat |= SPI_STAT_RXORERR;
+                (void)sim_spi_exchange(spi, ctl0, spi->shift);
+            }else{
+                host_sim_reg_poke(spi->periph + 0x0CU, sim_spi_exchange(spi, ctl0, spi->shift));
+                stat |= SPI_STAT_RBNE;
+            }
+            if(0U == (stat & SPI_STAT_TBE)){
+                spi->shift = spi->tx_buffer;
+                spi->timer = spi->frame_ticks;
+                stat |= SPI_STAT_TBE;
+            }else{
+                spi->busy = 0U;
+                stat &= ~SPI_STAT_TRANS;
+            }
+        }
+        host_sim_reg_poke(spi->periph + 0x08U, stat);
+
+        /* DMA requests, the transfers go through the DATA register model */
+        if((0U != (ctl1 & SPI_CTL1_DMAREN)) && (0U != (stat & SPI_STAT_RBNE))){
+            host_sim_dma_request(spi->dma_periph, spi->dma_rx);
+        }
+        stat = host_sim_reg_peek(spi->periph + 0x08U);
+        if((0U != (ctl1 & SPI_CTL1_DMATEN)) && (0U != (stat & SPI_STAT_TBE))){
+            host_sim_dma_request(spi->dma_periph, spi->dma_tx);
+        }
+        sim_spi_irq_update(spi);
+    }
+}
+
+/*!
+    \brief      exchange one I2S frame when its time has come, the transmit
+                modes send the buffered frame or a zero frame if the buffer is
+                empty, the receive modes load the next frame of the stream
+    \param[in]  spi: instance state
+    \param[in]  i2sctl: SPI_I2SCTL value
+    \param[out] none
+    \retval     none
+*/
+static void sim_spi_i2s_tick(sim_spi_struct *spi, uint32_t i2sctl)
+{
+    uint32_t stat = host_sim_reg_peek(spi->periph + 0x08U);
+    uint32_t frame = 0U;
+
+    if((0U != spi->timer) && (0U != --spi->timer)){
+        return;
+    }
+    spi->timer = spi->frame_ticks;
+
+    if(0U == (i2sctl & I2SCTL_I2SOPMOD(1))){
+        /* transmit, a slave flags the frame it had nothing for */
+        if(0U == (stat & SPI_STAT_TBE)){
+            frame = spi->tx_buffer;
+            stat |= SPI_STAT_TBE;
+        }else{
+            spi->i2s_gaps++;
+            if(0U == (i2sctl & I2SCTL_I2SOPMOD(2))){
+                stat |= SPI_STAT_TXURERR;
+            }
+        }
+        if(NULL != spi->i2s_mem){
+            spi->i2s_mem[spi->i2s_pos] = (uint16_t)frame;
+        }
+    }else{
+        if(NULL != spi->i2s_mem){
+            frame = spi->i2s_mem[spi->i2s_pos];
+        }
+        if(0U != (stat & SPI_STAT_RBNE)){
+            spi->i2s_gaps++;
+            stat |= SPI_STAT_RXORERR;
+        }else{
+            host_sim_reg_poke(spi->periph + 0x0CU, frame);
+            stat |= SPI_STAT_RBNE;
+        }
+    }
+    if(NULL != spi->i2s_mem){
+        spi->i2s_pos = (spi->i2s_pos + 1U) % spi->i2s_size;
+    }
+    spi->i2s_frames++;
+    host_sim_reg_poke(spi->periph + 0x08U, stat ^ SPI_STAT_I2SCH);
+}
+
+/*!
+    \brief      exchange the frame in the shift register with the selected slave
+    \param[in]  spi: instance state
+    \param[in]  ctl0: SPI_CTL0 value during the frame
+    \param[in]  frame: frame sent on MOSI
+    \param[out] none
+    \retval     frame received on MISO, all ones if no slave drives it
+*/
+static uint32_t sim_spi_exchange(sim_spi_struct *spi, uint32_t ctl0, uint32_t frame)
+{
+    sim_spi_slave_struct *slave;
+    uint32_t bytes = (0U != (ctl0 & SPI_CTL0_FF16)) ? 2U : 1U;
+    uint32_t selected = 0U;
+    uint32_t rx = (2U == bytes) ? 0xFFFFU : 0xFFU;
+    uint32_t i, j, tx;
+
+    for(i = 0U; i < HOST_SIM_SPI_SLAVE_NUM; i++){
+        if((0U != spi->slave[i].gpio_periph) && (0U != sim_spi_selected(&spi->slave[i]))){
+            selected++;
+        }
+    }
+
+    for(i = 0U; i < HOST_SIM_SPI_SLAVE_NUM; i++){
+        slave = &spi->slave[i];
+        if((0U == slave->gpio_periph) || (0U == sim_spi_selected(slave))){
+            continue;
+        }
+        if((1U != selected) || (slave->mode != (ctl0 & SIM_SPI_CTL0_MODE))){
+            slave->errors++;
+        }
+        /* the slave exchanges bytes, a 16 bit frame is its two next bytes, high byte first */
+        rx = 0U;
+        for(j = 0U; j < bytes; j++){
+            tx = (frame >> (8U * (bytes - 1U - j))) & 0xFFU;
+            if(0U != slave->nor){
+                rx = (rx << 8U) | sim_spi_nor_byte(slave, tx);
+                continue;
+            }
+            rx = (rx << 8U) | slave->mem[slave->pos];
+            slave->mem[slave->pos] = (uint8_t)tx;
+            slave->pos = (slave->pos + 1U) % slave->size;
+        }
+    }
+    return rx;
+}
+
+/*!
+    \brief      shift one byte through a NOR slave
+    \param[in]  slave: slave state
+    \param[in]  byte: byte on MOSI
+    \param[out] none
+    \retval     byte on MISO
+*/
+static uint32_t sim_spi_nor_byte(sim_spi_slave_struct *slave, uint32_t byte)
+{
+    uint32_t pos = slave->pos++;
+    uint32_t code = 0U;
+
+    if(0U == pos){
+        /* a busy flash only answers the status read */
+        slave->cmd = ((0U != slave->wip) && (SIM_NOR_READ_STATUS != byte)) ? 0U : byte;
+        slave->addr = 0U;
+        if(SIM_NOR_WRITE_ENABLE == slave->cmd){
+            slave->wel = 1U;
+        }else if(SIM_NOR_WRITE_DISABLE == slave->cmd){
+            slave->wel = 0U;
+        }
+        return 0xFFU;
+    }
+
+    switch(slave->cmd){
+    case SIM_NOR_READ_ID:
+        /* GigaDevice, SPI NOR, capacity as a power of two */
+        while((1U << code) < slave->size){
+            code++;
+        }
+        return (1U == pos) ? 0xC8U : ((2U == pos) ? 0x40U : ((3U == pos) ? code : 0xFFU));
+    case SIM_NOR_READ_STATUS:
+        return ((0U != slave->wip) ? 0x01U : 0x00U) | ((0U != slave->wel) ? 0x02U : 0x00U);
+    case SIM_NOR_READ:
+    case SIM_NOR_FAST_READ:
+    case SIM_NOR_PAGE_PROGRAM:
+    case SIM_NOR_SECTOR_ERASE:
+    case SIM_NOR_BLOCK_ERASE:
+        if(pos <= 3U){
+            slave->addr = ((slave->addr << 8U) | byte) % slave->size;
+        }else if((SIM_NOR_READ == slave->cmd) || ((SIM_NOR_FAST_READ == slave->cmd) && (pos > 4U))){
+            byte = slave->mem[slave->addr];
+            slave->addr = (slave->addr + 1U) % slave->size;
+            return byte;
+        }else if((SIM_NOR_PAGE_PROGRAM == slave->cmd) && (0U != slave->wel)){
+            /* programming only clears bits and wraps inside the page */
+            slave->mem[(slave->addr & ~0xFFU) | ((slave->addr + pos - 4U) & 0xFFU)] &= (uint8_t)byte;
+        }
+        break;
+    default:
+        break;
+    }
+    return 0xFFU;
+}
+
+/*!
+    \brief      execute the program or erase command of a NOR slave when its chip select goes high
+    \param[in]  slave: slave state
+    \param[out] none
+    \retval     none
+*/
+static void sim_spi_nor_end(sim_spi_slave_struct *slave)
+{
+    uint32_t size = 0U;
+    uint32_t i;
+
+    if(0U == slave->wel){
+        return;
+    }
+    switch(slave->cmd){
+    case SIM_NOR_PAGE_PROGRAM:
+        if(slave->pos > 4U){
+            slave->wip = HOST_SIM_SPI_NOR_PROGRAM_TICKS;
+            slave->wel = 0U;
+        }
+        return;
+    case SIM_NOR_SECTOR_ERASE:
+        size = (4U == slave->pos) ? 0x1000U : 0U;
+        break;
+    case SIM_NOR_BLOCK_ERASE:
+        size = (4U == slave->pos) ? 0x10000U : 0U;
+        break;
+    case SIM_NOR_CHIP_ERASE:
+        size = (1U == slave->pos) ? slave->size : 0U;
+        slave->addr = 0U;
+        break;
+    default:
+        return;
+    }
+    if(0U != size){
+        for(i = slave->addr & ~(size - 1U); i < ((slave->addr & ~(size - 1U)) + size); i++){
+            slave->mem[i % slave->size] = 0xFFU;
+        }
+        slave->wip = HOST_SIM_SPI_NOR_ERASE_TICKS;
+        slave->wel = 0U;
+    }
+}
+
+/*!
+    \brief      get the chip select level of a slave
+    \param[in]  slave: slave state
+    \param[out] none
+    \retval     1 if the chip select is driven low, 0 otherwise
+*/
+static uint32_t sim_spi_selected(const sim_spi_slave_struct *slave)
+{
+    return (0U == (host_sim_reg_peek(slave->gpio_periph + 0x0CU) & slave->pin)) ? 1U : 0U;
+}
+
+/*!
+    \brief      find the instance owning an address
+    \param[in]  addr: register or base address
+    \param[out] none
+    \retval     instance state
+*/
+static sim_spi_struct *sim_spi_find(uint32_t addr)
+{
+    uint32_t i;
+
+    for(i = 0U; i < (SIM_SPI_NUM - 1U); i++){
+        if(sim_spi[i].periph == (addr & ~0x000003FFU)){
+            break;
+        }
+    }
+    return &sim_spi[i];
+}
+
+/*!
+    \brief      recompute the interrupt line of an instance
+    \param[in]  spi: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_spi_irq_update(sim_spi_struct *spi)
+{
+    uint32_t stat = host_sim_reg_peek(spi->periph + 0x08U);
+    uint32_t ctl1 = host_sim_reg_peek(spi->periph + 0x04U);
+    uint32_t pending = 0U;
+
+    if(0U != (ctl1 & SPI_CTL1_TBEIE)){
+        pending |= stat & SPI_STAT_TBE;
+    }
+    if(0U != (ctl1 & SPI_CTL1_RBNEIE)){
+        pending |= stat & SPI_STAT_RBNE;
+    }
+    if(0U != (ctl1 & SPI_CTL1_ERRIE)){
+        pending |= stat & (SPI_STAT_RXORERR | SPI_STAT_CONFERR | SPI_STAT_CRCERR | SPI_STAT_TXURERR);
+    }
+    host_sim_irq_set(spi->irq, (0U != pending) ? ENABLE : DISABLE);
+}
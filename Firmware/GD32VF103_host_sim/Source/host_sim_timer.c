@@ -0,0 +1,246 @@
+/*!
+    \file  host_sim_timer.c
+    \brief basic timer register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "host_sim.h"
+
+#define SIM_TIMER_NUM               2U
+
+/* basic timer instance state */
+typedef struct
+{
+    uint32_t periph;                                                /* TIMER base address */
+    IRQn_Type irq;                                                  /* update interrupt line */
+    uint32_t trigger;                                               /* DAC trigger source driven by TRGO */
+    uint32_t prescaler;                                             /* prescaler shadow, loaded on the update event */
+    uint32_t autoreload;                                            /* auto-reload shadow, used when ARSE is set */
+    uint32_t divider;                                               /* prescaler counter */
+    uint32_t updates;                                               /* update events */
+}sim_timer_struct;
+
+static sim_timer_struct sim_timer[SIM_TIMER_NUM] = {
+    {.periph = TIMER5, .irq = TIMER5_IRQn, .trigger = DAC_TRIGGER_T5_TRGO},
+    {.periph = TIMER6, .irq = TIMER6_IRQn, .trigger = DAC_TRIGGER_T6_TRGO},
+};
+
+/* load the register reset values */
+static void sim_timer_reset(void);
+/* latch a register write */
+static uint32_t sim_timer_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* count on every instance for one bus tick */
+static void sim_timer_tick(void);
+/* generate an update event */
+static void sim_timer_update(sim_timer_struct *timer, uint32_t software);
+/* find the instance owning an address */
+static sim_timer_struct *sim_timer_find(uint32_t addr);
+/* recompute the interrupt line of an instance */
+static void sim_timer_irq_update(sim_timer_struct *timer);
+
+const host_sim_model_struct host_sim_timer_model = {
+    TIMER5, 0x00000800U, sim_timer_reset, NULL, sim_timer_write, sim_timer_tick
+};
+
+/*!
+    \brief      get the number of update events of a basic timer
+    \param[in]  timer_periph: TIMERx(x=5,6)
+    \param[out] none
+    \retval     number of update events since the reset
+*/
+uint32_t host_sim_timer_updates_get(uint32_t timer_periph)
+{
+    return sim_timer_find(timer_periph)->updates;
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_timer_reset(void)
+{
+    uint32_t i;
+
+    for(i = 0U; i < SIM_TIMER_NUM; i++){
+        sim_timer[i].prescaler = 0U;
+        sim_timer[i].autoreload = 0U;
+        sim_timer[i].divider = 0U;
+        sim_timer[i].updates = 0U;
+    }
+}
+
+/*!
+    \brief      latch a register write
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_timer_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    sim_timer_struct *timer = sim_timer_find(addr);
+
+    switch(addr - timer->periph){
+    case 0x00U:
+        /* CTL0: with MMC 1 the counter enable is the TRGO */
+        host_sim_reg_poke(addr, newval);
+        if((0U == (oldval & TIMER_CTL0_CEN)) && (0U != (newval & TIMER_CTL0_CEN))
+           && (TIMER_TRI_OUT_SRC_ENABLE == (host_sim_reg_peek(timer->periph + 0x04U) & TIMER_CTL1_MMC))){
+            host_sim_dac_trigger(timer->trigger);
+        }
+        break;
+    case 0x10U:
+        /* INTF: the flags are cleared by writing 0 */
+        newval &= oldval;
+        break;
+    case 0x14U:
+        /* SWEVG: UPG restarts the counter and the prescaler, the register reads as zero */
+        if(0U != (newval & TIMER_SWEVG_UPG)){
+            sim_timer_update(timer, 1U);
+        }
+        newval = 0U;
+        break;
+    case 0x24U:
+    case 0x28U:
+    case 0x2CU:
+        /* CNT, PSC and CAR are 16 bits wide */
+        newval &= 0x0000FFFFU;
+        break;
+    default:
+        break;
+    }
+    host_sim_reg_poke(addr, newval);
+    sim_timer_irq_update(timer);
+    return newval;
+}
+
+/*!
+    \brief      count on every instance for one bus tick, the timer clock is
+                the bus tick; the counter counts up to the auto-reload value
+                and the overflow is an update event
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_timer_tick(void)
+{
+    sim_timer_struct *timer;
+    uint32_t ctl0, autoreload, counter, i;
+
+    for(i = 0U; i < SIM_TIMER_NUM; i++){
+        timer = &sim_timer[i];
+        ctl0 = host_sim_reg_peek(timer->periph + 0x00U);
+        if(0U == (ctl0 & TIMER_CTL0_CEN)){
+            continue;
+        }
+        if(++timer->divider <= timer->prescaler){
+            continue;
+        }
+        timer->divider = 0U;
+
+        autoreload = (0U != (ctl0 & TIMER_CTL0_ARSE)) ? timer->autoreload : host_sim_reg_peek(timer->periph + 0x2CU);
+        counter = host_sim_reg_peek(timer->periph + 0x24U);
+        if(counter < autoreload){
+            host_sim_reg_poke(timer->periph + 0x24U, counter + 1U);
+            continue;
+        }
+        host_sim_reg_poke(timer->periph + 0x24U, 0U);
+        sim_timer_update(timer, 0U);
+        if(0U != (ctl0 & TIMER_CTL0_SPM)){
+            host_sim_reg_poke(timer->periph + 0x00U, host_sim_reg_peek(timer->periph + 0x00U) & ~TIMER_CTL0_CEN);
+        }
+    }
+}
+
+/*!
+    \brief      generate an update event: reload the shadow registers, set the
+                update flag and drive TRGO as selected by MMC; UPDIS suppresses
+                the event, UPS keeps a software event off the flag
+    \param[in]  timer: instance state
+    \param[in]  software: the event comes from UPG, which also restarts the counter
+    \param[out] none
+    \retval     none
+*/
+static void sim_timer_update(sim_timer_struct *timer, uint32_t software)
+{
+    uint32_t ctl0 = host_sim_reg_peek(timer->periph + 0x00U);
+    uint32_t mmc = host_sim_reg_peek(timer->periph + 0x04U) & TIMER_CTL1_MMC;
+
+    if(0U != software){
+        timer->divider = 0U;
+        host_sim_reg_poke(timer->periph + 0x24U, 0U);
+        if(TIMER_TRI_OUT_SRC_RESET == mmc){
+            host_sim_dac_trigger(timer->trigger);
+        }
+    }
+    if(0U != (ctl0 & TIMER_CTL0_UPDIS)){
+        return;
+    }
+    timer->prescaler = host_sim_reg_peek(timer->periph + 0x28U);
+    timer->autoreload = host_sim_reg_peek(timer->periph + 0x2CU);
+    timer->updates++;
+    if((0U == software) || (0U == (ctl0 & TIMER_CTL0_UPS))){
+        host_sim_reg_poke(timer->periph + 0x10U, host_sim_reg_peek(timer->periph + 0x10U) | TIMER_INTF_UPIF);
+        sim_timer_irq_update(timer);
+    }
+    if(TIMER_TRI_OUT_SRC_UPDATE == mmc){
+        host_sim_dac_trigger(timer->trigger);
+    }
+}
+
+/*!
+    \brief      find the instance owning an address
+    \param[in]  addr: register or base address
+    \param[out] none
+    \retval     instance state
+*/
+static sim_timer_struct *sim_timer_find(uint32_t addr)
+{
+    return ((addr & ~0x000003FFU) == TIMER6) ? &sim_timer[1] : &sim_timer[0];
+}
+
+/*!
+    \brief      recompute the interrupt line of an instance
+    \param[in]  timer: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_timer_irq_update(sim_timer_struct *timer)
+{
+    uint32_t pending = host_sim_reg_peek(timer->periph + 0x10U) & host_sim_reg_peek(timer->periph + 0x0CU)
+                       & TIMER_INTF_UPIF;
+
+    host_sim_irq_set(timer->irq, (0U != pending) ? ENABLE : DISABLE);
+}
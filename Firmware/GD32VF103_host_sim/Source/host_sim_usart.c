@@ -0,0 +1,347 @@
+/*!
+    \file  host_sim_usart.c
+    \brief USART register model of the host simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "host_sim.h"
+
+#define SIM_USART_NUM               5U
+#define SIM_USART_STAT_RESET_VALUE  (USART_STAT_TBE | USART_STAT_TC)
+#define SIM_USART_STAT_RC_W0        (USART_STAT_TC | USART_STAT_RBNE | USART_STAT_LBDF | USART_STAT_CTSF)
+#define SIM_USART_STAT_SEQ_CLEAR    (USART_STAT_IDLEF | USART_STAT_ORERR | USART_STAT_NERR | USART_STAT_FERR | USART_STAT_PERR)
+
+/* byte stream between the test and a USART */
+typedef struct
+{
+    uint16_t data[HOST_SIM_USART_FIFO_SIZE];
+    uint32_t head;
+    uint32_t tail;
+}sim_usart_fifo_struct;
+
+/* USART instance state */
+typedef struct
+{
+    uint32_t periph;                                                /* USART base address */
+    IRQn_Type irq;                                                  /* interrupt line */
+    uint32_t dma_periph;                                            /* DMA serving the USART, 0 if none */
+    uint32_t dma_tx;                                                /* DMA channel of the transmit request */
+    uint32_t dma_rx;                                                /* DMA channel of the receive request */
+    uint32_t frame_ticks;                                           /* bus ticks per frame */
+    uint32_t tx_busy;                                               /* shift register is sending */
+    uint32_t tx_timer;                                              /* ticks left for the frame being sent */
+    uint16_t tx_shift;                                              /* frame being sent */
+    uint16_t tx_buffer;                                             /* frame waiting for the shift register */
+    uint32_t rx_timer;                                              /* ticks left for the next received frame */
+    uint32_t idle_armed;                                            /* an idle frame follows the last received frame */
+    uint32_t stat_read;                                             /* STAT was read, a DATA read clears the errors */
+    sim_usart_fifo_struct rx;                                       /* frames still to arrive on the RX line */
+    sim_usart_fifo_struct tx;                                       /* frames sent on the TX line */
+}sim_usart_struct;
+
+static sim_usart_struct sim_usart[SIM_USART_NUM] = {
+    {.periph = USART0, .irq = USART0_IRQn, .dma_periph = DMA0, .dma_tx = DMA_CH3, .dma_rx = DMA_CH4},
+    {.periph = USART1, .irq = USART1_IRQn, .dma_periph = DMA0, .dma_tx = DMA_CH6, .dma_rx = DMA_CH5},
+    {.periph = USART2, .irq = USART2_IRQn, .dma_periph = DMA0, .dma_tx = DMA_CH1, .dma_rx = DMA_CH2},
+    {.periph = UART3, .irq = UART3_IRQn, .dma_periph = DMA1, .dma_tx = DMA_CH4, .dma_rx = DMA_CH2},
+    {.periph = UART4, .irq = UART4_IRQn, .dma_periph = 0U},
+};
+
+/* load the register reset values */
+static void sim_usart_reset(void);
+/* apply the side effects of a register read */
+static void sim_usart_read(uint32_t addr);
+/* latch a register write */
+static uint32_t sim_usart_write(uint32_t addr, uint32_t oldval, uint32_t newval);
+/* shift the TX and RX lines by one bus tick */
+static void sim_usart_tick(void);
+/* find the instance owning an address */
+static sim_usart_struct *sim_usart_find(uint32_t addr);
+/* recompute the interrupt line of an instance */
+static void sim_usart_irq_update(sim_usart_struct *usart);
+
+const host_sim_model_struct host_sim_usart0_model = {
+    USART0, 0x00000400U, sim_usart_reset, sim_usart_read, sim_usart_write, sim_usart_tick
+};
+
+const host_sim_model_struct host_sim_usart_model = {
+    USART1, 0x00001000U, NULL, sim_usart_read, sim_usart_write, NULL
+};
+
+/*!
+    \brief      feed bytes into the receive line of a USART
+    \param[in]  usart_periph: USARTx(x=0,1,2)/UARTx(x=3,4)
+    \param[in]  data: bytes to receive, one frame each
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     number of bytes queued
+*/
+uint32_t host_sim_usart_rx_inject(uint32_t usart_periph, const uint8_t *data, uint32_t len)
+{
+    sim_usart_struct *usart = sim_usart_find(usart_periph);
+    uint32_t count = 0U;
+
+    while((count < len) && (((usart->rx.head + 1U) % HOST_SIM_USART_FIFO_SIZE) != usart->rx.tail)){
+        usart->rx.data[usart->rx.head] = data[count++];
+        usart->rx.head = (usart->rx.head + 1U) % HOST_SIM_USART_FIFO_SIZE;
+    }
+    return count;
+}
+
+/*!
+    \brief      fetch the bytes a USART has shifted out
+    \param[in]  usart_periph: USARTx(x=0,1,2)/UARTx(x=3,4)
+    \param[in]  len: size of the buffer
+    \param[out] data: buffer receiving the bytes
+    \retval     number of bytes fetched
+*/
+uint32_t host_sim_usart_tx_fetch(uint32_t usart_periph, uint8_t *data, uint32_t len)
+{
+    sim_usart_struct *usart = sim_usart_find(usart_periph);
+    uint32_t count = 0U;
+
+    while((count < len) && (usart->tx.tail != usart->tx.head)){
+        data[count++] = (uint8_t)usart->tx.data[usart->tx.tail];
+        usart->tx.tail = (usart->tx.tail + 1U) % HOST_SIM_USART_FIFO_SIZE;
+    }
+    return count;
+}
+
+/*!
+    \brief      configure the number of bus ticks needed to shift one USART frame
+    \param[in]  usart_periph: USARTx(x=0,1,2)/UARTx(x=3,4)
+    \param[in]  ticks: bus ticks per frame, at least 1
+    \param[out] none
+    \retval     none
+*/
+void host_sim_usart_frame_ticks_config(uint32_t usart_periph, uint32_t ticks)
+{
+    sim_usart_find(usart_periph)->frame_ticks = (0U == ticks) ? 1U : ticks;
+}
+
+/*!
+    \brief      load the register reset values
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_usart_reset(void)
+{
+    uint32_t i;
+
+    for(i = 0U; i < SIM_USART_NUM; i++){
+        sim_usart[i].frame_ticks = HOST_SIM_USART_FRAME_TICKS;
+        sim_usart[i].tx_busy = 0U;
+        sim_usart[i].rx_timer = HOST_SIM_USART_FRAME_TICKS;
+        sim_usart[i].idle_armed = 0U;
+        sim_usart[i].stat_read = 0U;
+        sim_usart[i].rx.head = sim_usart[i].rx.tail = 0U;
+        sim_usart[i].tx.head = sim_usart[i].tx.tail = 0U;
+        host_sim_reg_poke(sim_usart[i].periph + 0x00U, SIM_USART_STAT_RESET_VALUE);
+    }
+}
+
+/*!
+    \brief      apply the side effects of a register read
+    \param[in]  addr: word address of the register
+    \param[out] none
+    \retval     none
+*/
+static void sim_usart_read(uint32_t addr)
+{
+    sim_usart_struct *usart = sim_usart_find(addr);
+    uint32_t stat = host_sim_reg_peek(usart->periph + 0x00U);
+
+    if(0x00U == (addr - usart->periph)){
+        usart->stat_read = 1U;
+    }else if(0x04U == (addr - usart->periph)){
+        /* reading DATA empties the receive buffer, after a STAT read it also clears the errors */
+        stat &= ~USART_STAT_RBNE;
+        if(0U != usart->stat_read){
+            stat &= ~SIM_USART_STAT_SEQ_CLEAR;
+        }
+        usart->stat_read = 0U;
+        host_sim_reg_poke(usart->periph + 0x00U, stat);
+        sim_usart_irq_update(usart);
+    }
+}
+
+/*!
+    \brief      latch a register write
+    \param[in]  addr: word address of the register
+    \param[in]  oldval: register contents before the write
+    \param[in]  newval: value written
+    \param[out] none
+    \retval     value latched by the register
+*/
+static uint32_t sim_usart_write(uint32_t addr, uint32_t oldval, uint32_t newval)
+{
+    sim_usart_struct *usart = sim_usart_find(addr);
+    uint32_t stat = host_sim_reg_peek(usart->periph + 0x00U);
+    uint32_t ctl0 = host_sim_reg_peek(usart->periph + 0x0CU);
+
+    switch(addr - usart->periph){
+    case 0x00U:
+        /* STAT: only the rc_w0 flags can be cleared by software */
+        newval = oldval & (newval | ~SIM_USART_STAT_RC_W0);
+        break;
+    case 0x04U:
+        /* DATA: a write feeds the transmitter, the register keeps the received frame */
+        if((USART_CTL0_UEN | USART_CTL0_TEN) == (ctl0 & (USART_CTL0_UEN | USART_CTL0_TEN))){
+            if(0U == usart->tx_busy){
+                usart->tx_shift = (uint16_t)(newval & USART_DATA_DATA);
+                usart->tx_timer = usart->frame_ticks;
+                usart->tx_busy = 1U;
+            }else{
+                usart->tx_buffer = (uint16_t)(newval & USART_DATA_DATA);
+                stat &= ~USART_STAT_TBE;
+            }
+            stat &= ~USART_STAT_TC;
+            host_sim_reg_poke(usart->periph + 0x00U, stat);
+        }
+        newval = oldval;
+        break;
+    default:
+        host_sim_reg_poke(addr, newval);
+        break;
+    }
+    if(0x00U == (addr - usart->periph)){
+        host_sim_reg_poke(addr, newval);
+    }
+    sim_usart_irq_update(usart);
+    return newval;
+}
+
+/*!
+    \brief      shift the TX and RX lines by one bus tick
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void sim_usart_tick(void)
+{
+    sim_usart_struct *usart;
+    uint32_t stat, ctl0, ctl2, i;
+
+    for(i = 0U; i < SIM_USART_NUM; i++){
+        usart = &sim_usart[i];
+        ctl0 = host_sim_reg_peek(usart->periph + 0x0CU);
+        ctl2 = host_sim_reg_peek(usart->periph + 0x14U);
+        stat = host_sim_reg_peek(usart->periph + 0x00U);
+
+        /* transmitter */
+        if((0U != usart->tx_busy) && (0U == --usart->tx_timer)){
+            if(((usart->tx.head + 1U) % HOST_SIM_USART_FIFO_SIZE) != usart->tx.tail){
+                usart->tx.data[usart->tx.head] = usart->tx_shift;
+                usart->tx.head = (usart->tx.head + 1U) % HOST_SIM_USART_FIFO_SIZE;
+            }
+            if(0U == (stat & USART_STAT_TBE)){
+                usart->tx_shift = usart->tx_buffer;
+                usart->tx_timer = usart->frame_ticks;
+                stat |= USART_STAT_TBE;
+            }else{
+                usart->tx_busy = 0U;
+                stat |= USART_STAT_TC;
+            }
+        }
+
+        /* receiver */
+        if((USART_CTL0_UEN | USART_CTL0_REN) == (ctl0 & (USART_CTL0_UEN | USART_CTL0_REN))){
+            if(usart->rx.tail != usart->rx.head){
+                if(0U == --usart->rx_timer){
+                    if(0U != (stat & USART_STAT_RBNE)){
+                        /* the new frame is lost, DATA keeps the unread one */
+                        stat |= USART_STAT_ORERR;
+                    }else{
+                        host_sim_reg_poke(usart->periph + 0x04U, usart->rx.data[usart->rx.tail]);
+                        stat |= USART_STAT_RBNE;
+                    }
+                    usart->rx.tail = (usart->rx.tail + 1U) % HOST_SIM_USART_FIFO_SIZE;
+                    usart->rx_timer = usart->frame_ticks;
+                    usart->idle_armed = 1U;
+                }
+            }else if((0U != usart->idle_armed) && (0U == --usart->rx_timer)){
+                stat |= USART_STAT_IDLEF;
+                usart->idle_armed = 0U;
+                usart->rx_timer = usart->frame_ticks;
+            }
+        }
+        host_sim_reg_poke(usart->periph + 0x00U, stat);
+
+        /* DMA requests, the transfers go through the DATA register model */
+        if(0U != usart->dma_periph){
+            if((0U != (ctl2 & USART_CTL2_DENT)) && (0U != (stat & USART_STAT_TBE))){
+                host_sim_dma_request(usart->dma_periph, usart->dma_tx);
+            }
+            if((0U != (ctl2 & USART_CTL2_DENR)) && (0U != (stat & USART_STAT_RBNE))){
+                host_sim_dma_request(usart->dma_periph, usart->dma_rx);
+            }
+        }
+        sim_usart_irq_update(usart);
+    }
+}
+
+/*!
+    \brief      find the instance owning an address
+    \param[in]  addr: register or base address
+    \param[out] none
+    \retval     instance state
+*/
+static sim_usart_struct *sim_usart_find(uint32_t addr)
+{
+    uint32_t i;
+
+    for(i = 0U; i < (SIM_USART_NUM - 1U); i++){
+        if(sim_usart[i].periph == (addr & ~0x000003FFU)){
+            break;
+        }
+    }
+    return &sim_usart[i];
+}
+
+/*!
+    \brief      recompute the interrupt line of an instance
+    \param[in]  usart: instance state
+    \param[out] none
+    \retval     none
+*/
+static void sim_usart_irq_update(sim_usart_struct *usart)
+{
+    uint32_t stat = host_sim_reg_peek(usart->periph + 0x00U);
+    uint32_t ctl0 = host_sim_reg_peek(usart->periph + 0x0CU);
+    uint32_t ctl2 = host_sim_reg_peek(usart->periph + 0x14U);
+    uint32_t pending;
+
+    pending = (stat & ctl0 & (USART_STAT_TBE | USART_STAT_TC | USART_STAT_RBNE | USART_STAT_IDLEF))
+            | ((0U != (ctl0 & USART_CTL0_RBNEIE)) ? (stat & USART_STAT_ORERR) : 0U)
+            | ((0U != (ctl2 & USART_CTL2_ERRIE)) ? (stat & (USART_STAT_ORERR | USART_STAT_NERR | USART_STAT_FERR)) : 0U);
+    host_sim_irq_set(usart->irq, (0U != pending) ? ENABLE : DISABLE);
+}
@@ -0,0 +1,136 @@
+/*!
+    \file  gd32vf103_adc_stream.h
+    \brief definitions for the continuous ADC scan acquisition
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_ADC_STREAM_H
+#define GD32VF103_ADC_STREAM_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_adc.h"
+#include "gd32vf103_dma.h"
+
+/*
+    Continuous acquisition of a regular scan group of ADC0. Each trigger, a
+    timer event in general, converts the whole group; the DMA channel 0 of DMA0
+    writes the results into a buffer split into two frames and wraps around by
+    itself, so no conversion involves the CPU and the latency from a sample to
+    its callback is fixed by the frame length.
+
+    A frame holds scans sets of scan_size interleaved samples, in the order
+    of the channels array. The half and full transfer interrupts hand the frame
+    the DMA has just left to the callback; adc_stream_channel_get() copies the
+    samples of one channel out of it. If the DMA comes back into a frame while
+    its callback still runs, or a whole frame goes by unhandled, the stream
+    counts an overrun.
+
+    The timer, or the EXTI line, behind the trigger is set up and started by
+    the application.
+
+    In the regular sync modes ADC0 and ADC1 run as a pair on the trigger of
+    ADC0 and the DMA moves 32-bit words, ADC0 result in the lower and ADC1
+    result in the upper half. Read as samples, a scan then holds the results
+    of both ADCs rank by rank: ADC0 at 2r and ADC1 at 2r + 1.
+      - regular parallel: both ADCs scan at once, each its own sequence;
+      - follow-up fast: ADC1 converts channels[0], ADC0 the same channel half
+        a conversion later, so back to back the pair samples at twice the
+        rate of one ADC; the sample time must stay below 7 ADC clocks;
+      - follow-up slow: as fast, ADC0 a whole conversion later and only one
+        pair per trigger; the sample time must stay below 14 ADC clocks.
+    adc_stream_interleaved_get() puts the samples of the follow-up modes back
+    in conversion order.
+*/
+
+/* constants definitions */
+#define ADC_STREAM_CHANNELS_MAX         16U                         /*!< channels of a regular scan group */
+#define ADC_STREAM_SIZE_MAX             0xFFFEU                     /*!< largest buffer in DMA transfers, bounded by the DMA counter */
+
+/* ADC stream state */
+#define ADC_STREAM_IDLE                 0U                          /*!< initialized or stopped */
+#define ADC_STREAM_RUNNING              1U                          /*!< the ADC converts on each trigger */
+#define ADC_STREAM_ERROR                2U                          /*!< stopped on a DMA transfer error */
+
+struct adc_stream_struct;
+
+/* ADC stream callback, frame holds scans sets of interleaved samples */
+typedef void (*adc_stream_callback)(struct adc_stream_struct *stream, const uint16_t *frame, uint32_t scans);
+
+/* ADC stream initialize struct */
+typedef struct
+{
+    uint32_t adc_periph;                                            /*!< ADC0, the only ADC with a DMA request */
+    uint32_t mode;                                                  /*!< ADC_MODE_FREE or ADC_DAUL_REGULAL_xxx */
+    const uint8_t *channels;                                        /*!< ADC_CHANNEL_x in scan order */
+    const uint8_t *channels1;                                       /*!< ADC_CHANNEL_x of ADC1 in regular parallel mode */
+    uint32_t channel_num;                                           /*!< channels per ADC, 1 to ADC_STREAM_CHANNELS_MAX, 1 in follow-up modes */
+    uint32_t sample_time;                                           /*!< ADC_SAMPLETIME_xxx of every channel */
+    uint32_t trigger;                                               /*!< ADC0_1_EXTTRIG_REGULAR_xxx, NONE converts back to back */
+    uint16_t *buffer;                                               /*!< storage of both frames, 2 * scans * channel_num samples per ADC, word aligned */
+    uint32_t scans;                                                 /*!< scans per frame */
+    adc_stream_callback callback;                                   /*!< consumer of the frames */
+    void *user_data;                                                /*!< free for the application */
+}adc_stream_parameter_struct;
+
+/* ADC stream */
+typedef struct adc_stream_struct
+{
+    uint32_t adc_periph;                                            /*!< ADC of the scan group */
+    uint32_t mode;                                                  /*!< ADC_MODE_FREE or ADC_DAUL_REGULAL_xxx */
+    uint32_t channel_num;                                           /*!< channels per ADC */
+    uint32_t scan_size;                                             /*!< samples per scan, twice channel_num in the sync modes */
+    uint32_t trigger;                                               /*!< external trigger of the regular group */
+    uint16_t *buffer;                                               /*!< storage of both frames */
+    uint32_t scans;                                                 /*!< scans per frame */
+    uint32_t size;                                                  /*!< samples in buffer */
+    adc_stream_callback callback;                                   /*!< consumer of the frames */
+    void *user_data;                                                /*!< free for the application */
+    volatile uint32_t state;                                        /*!< ADC_STREAM_IDLE, RUNNING or ERROR */
+    volatile uint32_t frames;                                       /*!< frames handed to the callback */
+    volatile uint32_t overrun;                                      /*!< frames overwritten before or while being handled */
+}adc_stream_struct;
+
+/* function declarations */
+/* configure the scan group, calibrate the ADC and set up its DMA channel */
+ErrStatus adc_stream_init(adc_stream_struct *stream, adc_stream_parameter_struct *init_struct);
+/* start converting on each trigger */
+void adc_stream_start(adc_stream_struct *stream);
+/* stop the conversions and the DMA channel */
+void adc_stream_stop(adc_stream_struct *stream);
+/* copy the samples of one channel out of a frame */
+void adc_stream_channel_get(const adc_stream_struct *stream, const uint16_t *frame, uint32_t index, uint16_t *samples);
+/* copy the samples of a follow-up mode frame in conversion order */
+void adc_stream_interleaved_get(const adc_stream_struct *stream, const uint16_t *frame, uint16_t *samples);
+/* DMA channel interrupt service, hands the finished frame to the callback */
+void adc_stream_dma_irq_handler(adc_stream_struct *stream);
+
+#endif /* GD32VF103_ADC_STREAM_H */
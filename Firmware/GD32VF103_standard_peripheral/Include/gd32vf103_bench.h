@@ -0,0 +1,108 @@
+/*!
+    \file  gd32vf103_bench.h
+    \brief definitions for the mcycle/minstret benchmark regions
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_BENCH_H
+#define GD32VF103_BENCH_H
+
+#include "gd32vf103.h"
+
+/*
+    Named timing regions on top of the mcycle and minstret counters of the
+    core. Each region accumulates the number of samples, the minimum, maximum
+    and total cycle count and the total retired instructions, and keeps the
+    last BENCH_SAMPLE_DEPTH cycle samples for the percentiles. The cost of an
+    empty start/stop pair is measured by bench_init() and taken off every
+    sample.
+
+    init.c stops both counters to save power, so the first region started
+    turns them on and the last region stopped turns them off again; a driver
+    timing events with mcycle holds them on with bench_counters_hold(). Reports
+    go to a sink, which is either a USART polled by the CPU or a RAM buffer.
+*/
+
+/* constants definitions */
+#define BENCH_SAMPLE_DEPTH              64U                         /*!< cycle samples kept per region for the percentiles */
+#define BENCH_NAME_WIDTH                16U                         /*!< width of the region name column of a report */
+
+/* timing region */
+typedef struct
+{
+    const char *name;                                               /*!< name printed in the reports */
+    uint32_t count;                                                 /*!< number of samples taken */
+    uint32_t min;                                                   /*!< smallest sample in cycles */
+    uint32_t max;                                                   /*!< largest sample in cycles */
+    uint64_t cycles;                                                /*!< sum of the samples in cycles */
+    uint64_t instret;                                               /*!< sum of the retired instructions */
+    uint64_t start_cycle;                                           /*!< mcycle when the running sample started */
+    uint64_t start_instret;                                         /*!< minstret when the running sample started */
+    uint32_t sample[BENCH_SAMPLE_DEPTH];                            /*!< last samples in cycles, oldest overwritten first */
+}bench_region_struct;
+
+/* report sink */
+typedef struct
+{
+    uint32_t usart_periph;                                          /*!< USART the report is sent on, 0 for the RAM buffer */
+    char *buffer;                                                   /*!< RAM buffer receiving the report */
+    uint32_t size;                                                  /*!< size of buffer in bytes */
+    uint32_t len;                                                   /*!< bytes stored in buffer, without the terminating zero */
+}bench_sink_struct;
+
+/* function declarations */
+/* measure the cost of an empty region */
+void bench_init(void);
+/* reset a region and give it a name */
+void bench_region_init(bench_region_struct *region, const char *name);
+/* start a sample of a region */
+void bench_region_start(bench_region_struct *region);
+/* end the running sample of a region */
+void bench_region_stop(bench_region_struct *region);
+/* get the mean sample of a region in cycles */
+uint32_t bench_region_mean(const bench_region_struct *region);
+/* get a percentile of the kept samples of a region in cycles */
+uint32_t bench_region_percentile(const bench_region_struct *region, uint32_t percent);
+/* keep the counters running outside of the regions */
+void bench_counters_hold(void);
+/* give back a hold taken with bench_counters_hold() */
+void bench_counters_release(void);
+
+/* report functions */
+/* send the reports to a USART */
+void bench_sink_usart_init(bench_sink_struct *sink, uint32_t usart_periph);
+/* store the reports in a RAM buffer */
+void bench_sink_buffer_init(bench_sink_struct *sink, char *buffer, uint32_t size);
+/* write a table of regions to a sink */
+void bench_report(bench_sink_struct *sink, const bench_region_struct *region, uint32_t count);
+
+#endif /* GD32VF103_BENCH_H */
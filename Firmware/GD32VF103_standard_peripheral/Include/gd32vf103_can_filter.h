@@ -0,0 +1,123 @@
+/*!
+    \file  gd32vf103_can_filter.h
+    \brief definitions for the CAN filter bank compiler
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_CAN_FILTER_H
+#define GD32VF103_CAN_FILTER_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_can.h"
+
+/*
+    Builds the filter banks of both CANs from the identifiers each one has to
+    receive, single identifiers or ranges, standard or extended, each routed
+    to a receive FIFO. The 28 banks are shared: CAN0 owns the banks below the
+    CAN1 start bank and CAN1 the others, and the compiler sets the split.
+
+    A range is first cut into aligned blocks, each an exact identifier/mask
+    pattern, so the banks accept the requested identifiers and nothing else.
+    While the patterns of both CANs need more banks than there are, the two
+    patterns of the same CAN, format and FIFO whose merge lets through the
+    fewest identifiers that were not asked for per bank it frees are merged,
+    standard and extended alike. A merge that frees no bank by itself, such as
+    two exact standard identifiers into one mask half, is rated together with
+    the cheapest merge after it that does. Each CAN is merged on its own down
+    to every bank count it may get, and the CAN1 start bank is the split with
+    the fewest such identifiers on both CANs together. The patterns are then
+    packed by bank cost:
+      - 16-bit list: four exact standard identifiers;
+      - 16-bit mask: two masked standard patterns;
+      - 32-bit list: two exact identifiers of either format;
+      - 32-bit mask: one masked extended pattern.
+    Filters compare the IDE and RTR bits too, so only data frames of the
+    requested format pass.
+
+    can_filter_report() counts the identifiers the banks let through against
+    the ones requested, so the false positives of a plan can be checked on the
+    host before it goes to a node. Compiling and reporting take under 1 KB of
+    stack and also run on the target.
+*/
+
+/* constants definitions */
+#define CAN_FILTER_BANK_NUM             28U                         /*!< filter banks shared by CAN0 and CAN1 */
+#define CAN_FILTER_PATTERN_MAX          128U                        /*!< patterns a plan holds, after cutting the ranges */
+
+/* identifiers a CAN receives */
+typedef struct
+{
+    uint32_t can_periph;                                            /*!< CANx(x=0,1) */
+    uint32_t ff;                                                    /*!< CAN_FF_STANDARD or CAN_FF_EXTENDED */
+    uint32_t first;                                                 /*!< first identifier */
+    uint32_t last;                                                  /*!< last identifier, first for a single one */
+    uint8_t fifo;                                                   /*!< CAN_FIFO0 or CAN_FIFO1 */
+}can_filter_id_struct;
+
+/* identifier pattern, the identifiers that agree with value on the bits set in mask */
+typedef struct
+{
+    uint32_t value;                                                 /*!< identifier bits */
+    uint32_t mask;                                                  /*!< bits compared */
+    uint8_t can;                                                    /*!< 0 for CAN0, 1 for CAN1 */
+    uint8_t extended;                                               /*!< 1 for an extended identifier */
+    uint8_t fifo;                                                   /*!< CAN_FIFO0 or CAN_FIFO1 */
+}can_filter_pattern_struct;
+
+/* filter plan */
+typedef struct
+{
+    can_filter_pattern_struct pattern[CAN_FILTER_PATTERN_MAX];      /*!< patterns after merging */
+    uint32_t pattern_num;                                           /*!< number of patterns */
+    can_filter_parameter_struct bank[CAN_FILTER_BANK_NUM];          /*!< bank settings, filter_enable set for the used ones */
+    uint32_t bank_num[2];                                           /*!< banks used by CAN0 and CAN1 */
+    uint32_t can1_start_bank;                                       /*!< first bank of CAN1 */
+    uint32_t requested[2][2];                                       /*!< identifiers requested, by CAN and format */
+}can_filter_plan_struct;
+
+/* acceptance report */
+typedef struct
+{
+    uint32_t requested[2][2];                                       /*!< identifiers requested, by CAN and standard/extended */
+    uint32_t accepted[2][2];                                        /*!< identifiers the banks let through */
+    uint32_t false_positive[2][2];                                  /*!< identifiers let through but not requested */
+}can_filter_report_struct;
+
+/* function declarations */
+/* compile the identifiers of both CANs into filter banks */
+ErrStatus can_filter_compile(can_filter_plan_struct *plan, const can_filter_id_struct *ids, uint32_t num);
+/* load the banks of a plan and the CAN1 start bank */
+void can_filter_apply(const can_filter_plan_struct *plan);
+/* count the identifiers the banks of a plan let through */
+void can_filter_report(const can_filter_plan_struct *plan, can_filter_report_struct *report);
+
+#endif /* GD32VF103_CAN_FILTER_H */
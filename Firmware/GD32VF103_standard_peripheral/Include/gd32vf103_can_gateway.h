@@ -0,0 +1,158 @@
+/*!
+    \file  gd32vf103_can_gateway.h
+    \brief definitions for the CAN0 to CAN1 gateway
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_CAN_GATEWAY_H
+#define GD32VF103_CAN_GATEWAY_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_can.h"
+#include "gd32vf103_can_queue.h"
+
+/*
+    The gateway forwards frames between CAN0 and CAN1 in their receive FIFO
+    interrupts. A frame taken from a FIFO is matched against the routes of its
+    CAN, first match wins, gets the identifier of its route and is written
+    in register layout into a free transmit mailbox of the other CAN, with the
+    register functions of the CAN queues. Only when the three mailboxes are busy does the frame wait
+    in the transmit ring of the other CAN, which the transmit interrupt loads
+    as mailboxes finish; a frame that finds the ring full is dropped. Frames
+    behind a waiting frame wait too, so the frames of a route keep their
+    order, and TFO is set on both CANs so the mailboxes go out in load order.
+
+    A route limits its rate with a token bucket: rate frames per second on
+    average and up to burst frames back to back. The latency of a route runs
+    from the receive interrupt that took the frame to the transmit interrupt
+    that saw its mailbox finish, so it covers the wait for the bus too. Time
+    is counted with mcycle, held on with bench_counters_hold().
+
+    The filters of both CANs are loaded by the caller and only let through
+    the frames to forward; frames of no route are counted and dropped. The
+    four CAN interrupts of the gateway must not preempt each other.
+*/
+
+/* constants definitions */
+#define CAN_GATEWAY_ROUTE_MAX           255U                        /*!< largest number of routes */
+#define CAN_GATEWAY_RING_MAX            32768U                      /*!< largest transmit ring, in frames */
+
+/* frame waiting for a transmit mailbox */
+typedef struct
+{
+    can_queue_raw_struct raw;                                       /*!< frame with the identifier of its route */
+    uint32_t stamp;                                                 /*!< low word of mcycle at the reception */
+    uint32_t route;                                                 /*!< route of the frame */
+}can_gateway_frame_struct;
+
+/* gateway route, the fields up to burst are set before can_gateway_init() */
+typedef struct
+{
+    uint32_t src_periph;                                            /*!< CAN the frames come from, CANx(x=0,1) */
+    uint8_t ff;                                                     /*!< CAN_FF_STANDARD or CAN_FF_EXTENDED */
+    uint32_t id;                                                    /*!< identifier bits to match */
+    uint32_t mask;                                                  /*!< identifier bits compared, a set bit must match */
+    uint32_t new_id;                                                /*!< identifier bits written on the other CAN */
+    uint32_t new_mask;                                              /*!< identifier bits replaced, 0 forwards the identifier as is */
+    uint32_t rate;                                                  /*!< frames per second, 0 for no limit */
+    uint32_t burst;                                                 /*!< frames accepted back to back, at least 1 with a rate */
+    uint32_t match;                                                 /*!< identifier register of a matching frame */
+    uint32_t match_mask;                                            /*!< identifier register bits compared */
+    uint32_t replace;                                               /*!< identifier register bits written */
+    uint32_t replace_mask;                                          /*!< identifier register bits replaced */
+    uint32_t period;                                                /*!< mcycles per frame at the rate */
+    uint32_t credit;                                                /*!< mcycles of credit in the bucket */
+    uint32_t credit_max;                                            /*!< credit of a full bucket */
+    uint64_t last;                                                  /*!< mcycle at the last frame */
+    volatile uint32_t forwarded;                                    /*!< frames sent on the other CAN */
+    volatile uint32_t dropped_rate;                                 /*!< frames over the rate */
+    volatile uint32_t dropped_busy;                                 /*!< frames that found the mailboxes and the ring full */
+    volatile uint32_t dropped_error;                                /*!< frames whose transmission ended in an error */
+    uint32_t latency_min;                                           /*!< shortest latency in mcycles */
+    uint32_t latency_max;                                           /*!< longest latency in mcycles */
+    uint64_t latency_sum;                                           /*!< sum of the latencies of the frames forwarded */
+}can_gateway_route_struct;
+
+/* gateway route statistics */
+typedef struct
+{
+    uint32_t forwarded;                                             /*!< frames sent on the other CAN */
+    uint32_t dropped_rate;                                          /*!< frames over the rate */
+    uint32_t dropped_busy;                                          /*!< frames that found the mailboxes and the ring full */
+    uint32_t dropped_error;                                         /*!< frames whose transmission ended in an error */
+    uint32_t latency_min_ns;                                        /*!< shortest latency */
+    uint32_t latency_max_ns;                                        /*!< longest latency */
+    uint32_t latency_avg_ns;                                        /*!< average latency */
+}can_gateway_stats_struct;
+
+/* gateway initialize struct */
+typedef struct
+{
+    can_gateway_route_struct *routes;                               /*!< routes, configured */
+    uint32_t route_num;                                             /*!< number of routes, 1 to 255 */
+    can_gateway_frame_struct *tx_buffer[2];                         /*!< transmit ring storage of CAN0 and CAN1 */
+    uint32_t tx_size[2];                                            /*!< transmit ring sizes, powers of two or 0 for no ring */
+}can_gateway_parameter_struct;
+
+/* gateway state */
+typedef struct
+{
+    can_gateway_route_struct *routes;                               /*!< routes */
+    uint32_t route_num;                                             /*!< number of routes */
+    uint32_t clock;                                                 /*!< mcycle frequency in Hz */
+    can_gateway_frame_struct *tx_buffer[2];                         /*!< transmit rings */
+    uint32_t tx_size[2];                                            /*!< transmit ring sizes */
+    uint32_t tx_head[2];                                            /*!< frames put into the rings */
+    uint32_t tx_tail[2];                                            /*!< frames loaded from the rings */
+    uint8_t mailbox_route[2][3];                                    /*!< 1 + route of a loaded mailbox, 0 when free */
+    uint32_t mailbox_stamp[2][3];                                   /*!< reception mcycle of the frame of a loaded mailbox */
+    volatile uint32_t tx_direct[2];                                 /*!< frames written straight into a mailbox */
+    volatile uint32_t tx_queued[2];                                 /*!< frames that waited in the ring */
+    volatile uint32_t unrouted[2];                                  /*!< frames of no route */
+    volatile uint32_t rx_overrun[2][2];                             /*!< hardware FIFO overruns */
+}can_gateway_struct;
+
+/* function declarations */
+/* initialize the routes and enable the interrupts of both CANs */
+ErrStatus can_gateway_init(can_gateway_struct *gateway, can_gateway_parameter_struct *init_struct);
+/* disable the CAN interrupts of the gateway */
+void can_gateway_deinit(can_gateway_struct *gateway);
+/* get the counters and the latencies of a route */
+ErrStatus can_gateway_stats_get(can_gateway_struct *gateway, uint32_t route, can_gateway_stats_struct *stats);
+
+/* interrupt functions */
+/* transmit interrupt service, retires the finished mailboxes and loads the waiting frames */
+void can_gateway_tx_irq_handler(can_gateway_struct *gateway, uint32_t can_periph);
+/* receive FIFO interrupt service, forwards the frames to the other CAN */
+void can_gateway_rx_irq_handler(can_gateway_struct *gateway, uint32_t can_periph, uint8_t fifo);
+
+#endif /* GD32VF103_CAN_GATEWAY_H */
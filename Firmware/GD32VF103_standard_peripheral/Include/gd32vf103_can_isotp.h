@@ -0,0 +1,178 @@
+/*!
+    \file  gd32vf103_can_isotp.h
+    \brief definitions for the ISO 15765-2 transport over CAN
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_CAN_ISOTP_H
+#define GD32VF103_CAN_ISOTP_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_can.h"
+
+/*
+    ISO 15765-2 transport over classic CAN with normal addressing. A session
+    is a pair of identifiers, one sent and one received, with a transmit and a
+    receive side of its own, so several messages move at the same time on one
+    CAN. Messages up to 4095 bytes use the 12-bit first frame length, longer
+    ones the 32-bit escape.
+
+    The driver owns the three mailboxes and both receive FIFO interrupts of its
+    CAN, and sets TFO so the mailboxes go out in the order they were loaded.
+    Without a separation time a session keeps up to three consecutive frames
+    in the mailboxes and the bus carries them back to back. The bytes sent are
+    packed into the mailbox data registers straight from the buffer of the
+    caller, and the bytes received go from the FIFO data registers straight
+    into the receive buffer of the session, so no frame is staged in between.
+    A flow control frame is loaded before the data of any session.
+
+    A session asks its peer for block_size and st_min in its flow control
+    frames and paces its own consecutive frames with the values of the peer.
+    Time is counted with mcycle, held on with bench_counters_hold(). Frames
+    held back by a separation time and the N_Bs and N_Cr timeouts are served
+    by can_isotp_poll(), which runs from a timer or the main loop at the
+    resolution of the separation times in use.
+
+    The callbacks run in the CAN interrupts, or in can_isotp_poll() for a
+    timeout. The CAN interrupts must not preempt each other;
+    can_isotp_transmit() and can_isotp_poll() mask them while they work and
+    run in one context of lower priority.
+*/
+
+/* constants definitions */
+#define CAN_ISOTP_PADDING_NONE          0xFFFFU                     /*!< frames end with their last byte, no fill */
+#define CAN_ISOTP_TIMEOUT_MS            1000U                       /*!< default N_Bs and N_Cr timeout */
+#define CAN_ISOTP_WAIT_MAX              8U                          /*!< flow control waits accepted in a row, N_WFTmax */
+#define CAN_ISOTP_SF_MAX                7U                          /*!< largest message of a single frame */
+#define CAN_ISOTP_FF_DL_MAX             4095U                       /*!< largest message without the first frame escape */
+
+/* outcome of a message */
+typedef enum
+{
+    CAN_ISOTP_OK = 0,                                               /*!< message sent or received */
+    CAN_ISOTP_TIMEOUT,                                              /*!< no flow control or consecutive frame in time */
+    CAN_ISOTP_WRONG_SN,                                             /*!< consecutive frame out of sequence */
+    CAN_ISOTP_OVERFLOW,                                             /*!< message longer than the receive buffer */
+    CAN_ISOTP_WAIT_LIMIT,                                           /*!< more than CAN_ISOTP_WAIT_MAX flow control waits */
+    CAN_ISOTP_INVALID_FS,                                           /*!< flow control frame with a reserved flow status */
+    CAN_ISOTP_ABORTED                                               /*!< transmit error, or reception cut by a new message */
+}can_isotp_result_enum;
+
+struct can_isotp_struct;
+struct can_isotp_session_struct;
+
+/* ISO-TP callbacks, called at the end of each message sent or received */
+typedef void (*can_isotp_tx_callback)(struct can_isotp_struct *isotp, struct can_isotp_session_struct *session,
+                                      can_isotp_result_enum result);
+typedef void (*can_isotp_rx_callback)(struct can_isotp_struct *isotp, struct can_isotp_session_struct *session,
+                                      uint32_t len, can_isotp_result_enum result);
+
+/* ISO-TP session, the fields up to user_data are set before can_isotp_init() */
+typedef struct can_isotp_session_struct
+{
+    uint32_t tx_id;                                                 /*!< identifier of the frames sent */
+    uint32_t rx_id;                                                 /*!< identifier of the frames received */
+    uint8_t ff;                                                     /*!< CAN_FF_STANDARD or CAN_FF_EXTENDED, for both identifiers */
+    uint8_t block_size;                                             /*!< consecutive frames asked per flow control, 0 for all */
+    uint8_t st_min;                                                 /*!< separation time asked, 0x00-0x7F ms or 0xF1-0xF9 100-900 us */
+    uint16_t padding;                                               /*!< fill byte of short frames, or CAN_ISOTP_PADDING_NONE */
+    uint8_t *rx_buffer;                                             /*!< receive buffer, may be swapped by the receive callback */
+    uint32_t rx_size;                                               /*!< receive buffer size */
+    can_isotp_tx_callback tx_callback;                              /*!< end of a message sent, or NULL */
+    can_isotp_rx_callback rx_callback;                              /*!< end of a message received, or NULL */
+    void *user_data;                                                /*!< free for the owner of the session */
+    const uint8_t *tx_data;                                         /*!< message being sent, owned by the caller until the end */
+    uint32_t tx_len;                                                /*!< length of the message being sent */
+    uint32_t tx_offset;                                             /*!< bytes loaded into the mailboxes */
+    uint32_t tx_st;                                                 /*!< separation time of the peer in mcycles */
+    uint32_t tx_time;                                               /*!< mcycle from which the next consecutive frame may go */
+    uint32_t tx_deadline;                                           /*!< mcycle by which a flow control is due */
+    uint8_t tx_state;                                               /*!< idle, sending or waiting for a flow control */
+    uint8_t tx_sn;                                                  /*!< sequence number of the next consecutive frame */
+    uint8_t tx_bs;                                                  /*!< block size of the peer */
+    uint8_t tx_block;                                               /*!< consecutive frames left in the block */
+    uint8_t tx_inflight;                                            /*!< frames of the session in the mailboxes */
+    uint8_t tx_waits;                                               /*!< flow control waits in a row */
+    uint8_t rx_state;                                               /*!< idle or receiving */
+    uint8_t rx_sn;                                                  /*!< sequence number of the next consecutive frame */
+    uint8_t rx_block;                                               /*!< consecutive frames left before the next flow control */
+    uint8_t rx_fc;                                                  /*!< flow status of the flow control to send, or none */
+    uint32_t rx_len;                                                /*!< length of the message being received */
+    uint32_t rx_offset;                                             /*!< bytes received */
+    uint32_t rx_deadline;                                           /*!< mcycle by which a consecutive frame is due */
+    uint32_t tx_messages;                                           /*!< messages sent */
+    uint32_t rx_messages;                                           /*!< messages received */
+    uint32_t tx_errors;                                             /*!< messages that failed to go out */
+    uint32_t rx_errors;                                             /*!< messages that failed to come in */
+}can_isotp_session_struct;
+
+/* ISO-TP initialize struct */
+typedef struct
+{
+    uint32_t can_periph;                                            /*!< CANx(x=0,1) */
+    can_isotp_session_struct *sessions;                             /*!< sessions, configured */
+    uint32_t session_num;                                           /*!< number of sessions, 1 to 255 */
+    uint32_t timeout_ms;                                            /*!< N_Bs and N_Cr timeout, 0 for CAN_ISOTP_TIMEOUT_MS */
+}can_isotp_parameter_struct;
+
+/* ISO-TP driver state */
+typedef struct can_isotp_struct
+{
+    uint32_t can_periph;                                            /*!< CAN carrying the sessions */
+    can_isotp_session_struct *sessions;                             /*!< sessions */
+    uint32_t session_num;                                           /*!< number of sessions */
+    uint32_t clock;                                                 /*!< mcycle frequency in Hz */
+    uint32_t timeout;                                               /*!< N_Bs and N_Cr timeout in mcycles */
+    uint32_t next;                                                  /*!< session served first by the next load */
+    uint8_t mailbox_session[3];                                     /*!< 1 + session of a loaded mailbox, 0 when free */
+    uint8_t mailbox_fc;                                             /*!< BIT(x) for a mailbox x loaded with a flow control */
+    volatile uint32_t ignored;                                      /*!< frames of no session, or without a valid PCI */
+    volatile uint32_t rx_overrun[2];                                /*!< hardware FIFO overruns */
+}can_isotp_struct;
+
+/* function declarations */
+/* initialize the sessions and enable the CAN interrupts */
+ErrStatus can_isotp_init(can_isotp_struct *isotp, can_isotp_parameter_struct *init_struct);
+/* disable the CAN interrupts of the transport */
+void can_isotp_deinit(can_isotp_struct *isotp);
+/* start sending a message on a session */
+ErrStatus can_isotp_transmit(can_isotp_struct *isotp, can_isotp_session_struct *session, const uint8_t *data, uint32_t len);
+/* serve the separation times and the timeouts */
+void can_isotp_poll(can_isotp_struct *isotp);
+
+/* interrupt functions */
+/* transmit interrupt service, retires the finished mailboxes and loads the next frames */
+void can_isotp_tx_irq_handler(can_isotp_struct *isotp);
+/* receive FIFO interrupt service, hands the frames to their sessions */
+void can_isotp_rx_irq_handler(can_isotp_struct *isotp, uint8_t fifo);
+
+#endif /* GD32VF103_CAN_ISOTP_H */
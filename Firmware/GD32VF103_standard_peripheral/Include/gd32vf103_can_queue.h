@@ -0,0 +1,179 @@
+/*!
+    \file  gd32vf103_can_queue.h
+    \brief interrupt driven CAN driver with software receive rings and a priority ordered transmit queue
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_CAN_QUEUE_H
+#define GD32VF103_CAN_QUEUE_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_can.h"
+
+/*
+    Each receive FIFO interrupt drains its 3-deep hardware FIFO into a
+    software ring of the same FIFO, reading every mailbox register once. A ring
+    has one producer, its FIFO interrupt, and one consumer, so neither side
+    takes a lock. A frame that finds its ring full is dropped and counted; a
+    hardware FIFO overrun is counted too.
+
+    Frames to send go into a binary heap ordered like the bus arbitration,
+    lowest identifier first and in submission order among equal identifiers.
+    The head of the heap is loaded into a free mailbox; with the three
+    mailboxes busy and the head of higher priority than the lowest priority
+    mailbox, that mailbox is asked to stop and its frame goes back into the
+    heap once the stop is done. No stop is asked for while the heap is full,
+    and while one is pending the heap keeps a slot free for the frame. A
+    frame is not loaded while a mailbox holds the same identifier, so frames
+    of one identifier stay in order. The driver clears TFO so the hardware
+    too sends the mailboxes by identifier.
+
+    A frame carries the 16-bit time stamp of its start of frame, counted in
+    bit times by the CAN in time triggered communication mode, and a queued
+    frame the low word of mcycle at its submission. The callbacks see every
+    frame sent and every frame received, the dropped ones too.
+
+    The heap is shared by can_queue_transmit() and the transmit interrupt:
+    can_queue_transmit() masks the transmit mailbox empty interrupt while it
+    works on it and must be called from a single context of lower priority
+    than the CAN interrupts.
+
+    can_queue_mailbox_load() and can_queue_fifo_take() are the register side
+    of the queues, shared with the ISO-TP transport and the gateway, which
+    drive the mailboxes themselves. Each of the three takes all transmit
+    mailboxes and both FIFO interrupts of its CAN, so a CAN is served by one
+    of them at a time.
+*/
+
+/* constants definitions */
+#define CAN_QUEUE_SIZE_MAX              32768U                      /*!< largest ring or heap, in frames */
+#define CAN_QUEUE_FIFO_DEPTH            3U                          /*!< frames a receive FIFO holds */
+
+/* CAN frame */
+typedef struct
+{
+    uint32_t id;                                                    /*!< standard or extended identifier */
+    uint8_t ff;                                                     /*!< CAN_FF_STANDARD or CAN_FF_EXTENDED */
+    uint8_t ft;                                                     /*!< CAN_FT_DATA or CAN_FT_REMOTE */
+    uint8_t dlen;                                                   /*!< data length, 0 to 8 */
+    uint8_t fi;                                                     /*!< filter index of a received frame */
+    uint8_t data[8];                                                /*!< data bytes */
+    uint16_t ts;                                                    /*!< time stamp of the start of frame, with TTC set */
+}can_queue_frame_struct;
+
+/* frame in the layout of the mailbox registers */
+typedef struct
+{
+    uint32_t mi;                                                    /*!< identifier register, TEN clear */
+    uint32_t mp;                                                    /*!< property register: data length code, and filter index and time stamp when received */
+    uint32_t data0;                                                 /*!< data bytes 0 to 3 */
+    uint32_t data1;                                                 /*!< data bytes 4 to 7 */
+}can_queue_raw_struct;
+
+/* transmit heap entry */
+typedef struct
+{
+    uint32_t key;                                                   /*!< arbitration priority, lower first */
+    uint32_t seq;                                                   /*!< submission order */
+    uint32_t queued;                                                /*!< low word of mcycle at the submission */
+    can_queue_frame_struct frame;                                   /*!< frame */
+}can_queue_slot_struct;
+
+struct can_queue_struct;
+
+/* CAN queue callbacks, called from the interrupts for each frame sent or received */
+typedef void (*can_queue_tx_callback)(struct can_queue_struct *queue, const can_queue_slot_struct *slot);
+typedef void (*can_queue_rx_callback)(struct can_queue_struct *queue, const can_queue_frame_struct *frame);
+
+/* CAN queue initialize struct */
+typedef struct
+{
+    uint32_t can_periph;                                            /*!< CANx(x=0,1) */
+    can_queue_slot_struct *tx_buffer;                               /*!< transmit heap storage */
+    uint32_t tx_size;                                               /*!< transmit heap size */
+    can_queue_frame_struct *rx_buffer[2];                           /*!< receive ring storage of FIFO0 and FIFO1 */
+    uint32_t rx_size[2];                                            /*!< receive ring sizes, powers of two */
+}can_queue_parameter_struct;
+
+/* CAN queue driver state */
+typedef struct can_queue_struct
+{
+    uint32_t can_periph;                                            /*!< CAN served by the queues */
+    can_queue_slot_struct *tx_heap;                                 /*!< transmit heap */
+    uint32_t tx_size;                                               /*!< transmit heap size */
+    uint32_t tx_num;                                                /*!< frames in the heap */
+    uint32_t tx_seq;                                                /*!< submission counter */
+    can_queue_slot_struct mailbox[3];                               /*!< frames loaded into the mailboxes */
+    uint32_t mailbox_busy;                                          /*!< BIT(x) for a loaded mailbox x */
+    uint32_t mailbox_stop;                                          /*!< BIT(x) for a mailbox x asked to stop */
+    can_queue_frame_struct *rx_buffer[2];                           /*!< receive rings */
+    uint32_t rx_size[2];                                            /*!< receive ring sizes */
+    volatile uint32_t rx_head[2];                                   /*!< frames received, written by the interrupts */
+    volatile uint32_t rx_tail[2];                                   /*!< frames consumed, written by the consumer */
+    volatile uint32_t tx_sent;                                      /*!< frames sent */
+    volatile uint32_t tx_stopped;                                   /*!< mailboxes stopped for a frame of higher priority */
+    volatile uint32_t tx_failed;                                    /*!< frames that ended in an error */
+    volatile uint32_t tx_dropped;                                   /*!< frames refused on a full heap */
+    volatile uint32_t rx_dropped[2];                                /*!< frames dropped on a full ring */
+    volatile uint32_t rx_overrun[2];                                /*!< hardware FIFO overruns */
+    can_queue_tx_callback tx_callback;                              /*!< sees each frame sent, or NULL */
+    can_queue_rx_callback rx_callback;                              /*!< sees each frame received, or NULL */
+    void *user_data;                                                /*!< free for the owner of the callbacks */
+}can_queue_struct;
+
+/* function declarations */
+/* initialize the CAN queues and enable the CAN interrupts */
+ErrStatus can_queue_init(can_queue_struct *queue, can_queue_parameter_struct *init_struct);
+/* disable the CAN interrupts of the queues */
+void can_queue_deinit(can_queue_struct *queue);
+/* queue a frame for transmission */
+ErrStatus can_queue_transmit(can_queue_struct *queue, const can_queue_frame_struct *frame);
+/* get the number of frames queued or in a mailbox */
+uint32_t can_queue_tx_pending_get(can_queue_struct *queue);
+/* take the oldest frame of a receive ring */
+ErrStatus can_queue_receive(can_queue_struct *queue, uint8_t fifo, can_queue_frame_struct *frame);
+/* get the number of frames in a receive ring */
+uint32_t can_queue_rx_count_get(can_queue_struct *queue, uint8_t fifo);
+
+/* interrupt functions */
+/* transmit interrupt service, retires the finished mailboxes and loads the next frames */
+void can_queue_tx_irq_handler(can_queue_struct *queue);
+/* receive FIFO interrupt service, drains the FIFO into its ring */
+void can_queue_rx_irq_handler(can_queue_struct *queue, uint8_t fifo);
+
+/* mailbox register functions */
+/* write a frame into an empty transmit mailbox and request its transmission */
+void can_queue_mailbox_load(uint32_t can_periph, uint32_t mailbox, const can_queue_raw_struct *raw);
+/* take the frames of a receive FIFO, reading each mailbox register once */
+uint32_t can_queue_fifo_take(uint32_t can_periph, uint8_t fifo, can_queue_raw_struct *raw, volatile uint32_t *overrun);
+
+#endif /* GD32VF103_CAN_QUEUE_H */
@@ -0,0 +1,186 @@
+/*!
+    \file  gd32vf103_can_stats.h
+    \brief definitions for the CAN bus load, latency and error statistics
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_CAN_STATS_H
+#define GD32VF103_CAN_STATS_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_can.h"
+#include "gd32vf103_can_queue.h"
+
+/*
+    Bus statistics gathered by the callbacks of a CAN queue. Every frame sent
+    or received counts for its identifier and for the bus load, the stuffed
+    length of the frame and the intermission at the bit timing of CAN_BT. The
+    CRC and the stuff bits are worked out a nibble at a time from two small
+    tables, so the cost in the interrupt stays at a few dozen steps a frame.
+
+    With the CAN in time triggered communication mode each frame sent carries
+    the time stamp of its start of frame, 16 bits counting bit times, and the
+    queue remembers mcycle at its submission. The offset between the two time
+    bases comes from the completions: the transmit interrupt never runs before
+    the end of frame, so the smallest offset seen is the closest to the true
+    one and the excess of a completion is the delay of its interrupt. The
+    latency from the queue to the end of frame is then split into the wait
+    for the bus and the frame itself.
+
+    can_stats_period() closes a measurement period, turning the counts into
+    frames per second and bus load and sampling the error counters into a
+    history. can_stats_snapshot() packs the results into a little endian
+    record for a host tool:
+
+    offset  size  header
+    0       2     CAN_STATS_SNAPSHOT_MAGIC
+    2       1     CAN_STATS_SNAPSHOT_VERSION
+    3       1     n, identifier records after the header
+    4       1     m, error records after the identifier records
+    5       1     WERR, PERR and BOERR of the last error sample
+    6       2     bit time in ns
+    8       4     number of the last period
+    12      4     length of the last period in us
+    16      4     frames of the last period
+    20      2     bus load of the last period in permille
+    22      2     highest bus load of a period in permille
+    24      4     frames whose identifier found the table full
+    28      16    wait for the bus: count, min, max, mean in bits
+    44      16    queue to end of frame: count, min, max, mean in bits
+    60      8     transmit interrupt delay: max, mean in mcycles
+    68      32    CAN_STATS_HISTOGRAM_BINS 16-bit counts of the queue to
+                  end of frame latency, see can_stats_struct
+    identifier record, 8 bytes: identifier with CAN_STATS_ID_EXT, frames per second
+    error record, 8 bytes: period (16 bits), TEC, REC, highest TEC and REC
+                  of the period, WERR PERR BOERR, ERRN
+
+    The callbacks run in the CAN interrupts, which must not preempt each
+    other; can_stats_period() and can_stats_snapshot() run in one context of
+    lower priority.
+*/
+
+/* constants definitions */
+#define CAN_STATS_ID_EXT                BIT(31)                     /*!< extended identifier flag in the identifier table */
+#define CAN_STATS_ID_NONE               0xFFFFFFFFU                 /*!< free entry of the identifier table */
+#define CAN_STATS_ERROR_DEPTH           16U                         /*!< error samples kept, a power of two */
+#define CAN_STATS_HISTOGRAM_BINS        16U                         /*!< bins of the queue to end of frame latency */
+#define CAN_STATS_SNAPSHOT_MAGIC        0x5343U                     /*!< "CS" */
+#define CAN_STATS_SNAPSHOT_VERSION      1U                          /*!< layout of the snapshot */
+#define CAN_STATS_SNAPSHOT_HEADER       100U                        /*!< bytes of the snapshot header */
+#define CAN_STATS_SNAPSHOT_RECORD       8U                          /*!< bytes of an identifier or error record */
+
+/* identifier table entry */
+typedef struct
+{
+    uint32_t id;                                                    /*!< identifier with CAN_STATS_ID_EXT, or CAN_STATS_ID_NONE */
+    uint32_t frames;                                                /*!< frames seen, free running */
+    uint32_t last;                                                  /*!< frames seen at the end of the last period */
+    uint32_t rate;                                                  /*!< frames per second over the last period */
+}can_stats_id_struct;
+
+/* latency summary */
+typedef struct
+{
+    uint32_t count;                                                 /*!< samples */
+    uint32_t min;                                                   /*!< smallest sample */
+    uint32_t max;                                                   /*!< largest sample */
+    uint64_t sum;                                                   /*!< sum of the samples */
+}can_stats_latency_struct;
+
+/* error counter sample */
+typedef struct
+{
+    uint16_t period;                                                /*!< period closed by the sample */
+    uint8_t tec;                                                    /*!< transmit error count */
+    uint8_t rec;                                                    /*!< receive error count */
+    uint8_t tec_max;                                                /*!< highest transmit error count seen in the period */
+    uint8_t rec_max;                                                /*!< highest receive error count seen in the period */
+    uint8_t state;                                                  /*!< CAN_ERR_WERR, CAN_ERR_PERR and CAN_ERR_BOERR */
+    uint8_t errn;                                                   /*!< last error number */
+}can_stats_error_struct;
+
+/* CAN statistics initialize struct */
+typedef struct
+{
+    can_queue_struct *queue;                                        /*!< initialized CAN queue whose frames are counted */
+    can_stats_id_struct *ids;                                       /*!< identifier table storage */
+    uint32_t id_size;                                               /*!< identifier table size, a power of two */
+}can_stats_parameter_struct;
+
+/* CAN statistics */
+typedef struct
+{
+    can_queue_struct *queue;                                        /*!< CAN queue whose frames are counted */
+    uint32_t can_periph;                                            /*!< CAN of the queue */
+    uint32_t clock;                                                 /*!< mcycle frequency in Hz */
+    uint32_t bit_cycles;                                            /*!< mcycles per bit */
+    can_stats_id_struct *ids;                                       /*!< identifier table, open addressing */
+    uint32_t id_size;                                               /*!< identifier table size */
+    uint32_t id_num;                                                /*!< identifiers in the table */
+    volatile uint32_t id_missed;                                    /*!< frames whose identifier found the table full */
+    volatile uint32_t frames;                                       /*!< frames seen, free running */
+    volatile uint32_t bits;                                         /*!< bus bits of the frames seen, free running */
+    uint32_t last_frames;                                           /*!< frames at the end of the last period */
+    uint32_t last_bits;                                             /*!< bus bits at the end of the last period */
+    uint64_t period_start;                                          /*!< mcycle at the start of the running period */
+    uint32_t period;                                                /*!< periods closed */
+    uint32_t period_us;                                             /*!< length of the last period in us */
+    uint32_t period_frames;                                         /*!< frames of the last period */
+    uint32_t load;                                                  /*!< bus load of the last period in permille */
+    uint32_t load_max;                                              /*!< highest bus load of a period in permille */
+    uint32_t phase;                                                 /*!< mcycle of time stamp 0, modulo 65536 bits */
+    uint32_t phase_valid;                                           /*!< a completion has set phase */
+    can_stats_latency_struct wait;                                  /*!< queue to start of frame in bits */
+    can_stats_latency_struct total;                                 /*!< queue to end of frame in bits */
+    can_stats_latency_struct irq;                                   /*!< end of frame to the transmit interrupt in mcycles */
+    uint32_t histogram[CAN_STATS_HISTOGRAM_BINS];                   /*!< queue to end of frame, bin 0 below 64 bits, bin n from 32 << n */
+    volatile uint32_t tec_max;                                      /*!< highest transmit error count of the running period */
+    volatile uint32_t rec_max;                                      /*!< highest receive error count of the running period */
+    can_stats_error_struct error[CAN_STATS_ERROR_DEPTH];            /*!< error samples, oldest overwritten first */
+    uint32_t error_num;                                             /*!< error samples taken */
+}can_stats_struct;
+
+/* function declarations */
+/* attach the statistics to a CAN queue and turn on time triggered communication */
+ErrStatus can_stats_init(can_stats_struct *stats, can_stats_parameter_struct *init_struct);
+/* detach the statistics from their CAN queue */
+void can_stats_deinit(can_stats_struct *stats);
+/* close a measurement period */
+void can_stats_period(can_stats_struct *stats);
+/* find the table entry of an identifier */
+const can_stats_id_struct *can_stats_id_find(const can_stats_struct *stats, uint32_t id, uint8_t ff);
+/* pack the statistics into a binary snapshot */
+uint32_t can_stats_snapshot(const can_stats_struct *stats, uint8_t *buffer, uint32_t size);
+/* get the number of bits a frame occupies the bus */
+uint32_t can_stats_frame_bits(const can_queue_frame_struct *frame);
+
+#endif /* GD32VF103_CAN_STATS_H */
@@ -0,0 +1,90 @@
+/*!
+    \file  gd32vf103_crc_stream.h
+    \brief definitions for the CRC streaming driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_CRC_STREAM_H
+#define GD32VF103_CRC_STREAM_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_crc.h"
+#include "gd32vf103_dma.h"
+
+/*
+    Streaming front end of the CRC unit for byte buffers of any length and
+    alignment. The bytes of the stream are grouped into little-endian words
+    counted from the start of the stream, and each word is fed to CRC_DATA, so
+    a stream of whole words gives the same value as crc_block_data_calculate().
+    The last 1 to 3 bytes of a stream form a partial word that is fed most
+    significant byte first by software. Word aligned runs of at least
+    dma_threshold words are written to CRC_DATA by a memory to memory DMA
+    channel, the other words by the CPU.
+
+    The CRC unit has no way to reload a saved value, so only one stream can
+    be in progress at a time. The CRC clock must be enabled by the caller, and
+    so must the DMA clock when a channel is configured.
+*/
+
+/* constants definitions */
+#define CRC_STREAM_DMA_THRESHOLD        16U                         /*!< default number of words from which a run goes through the DMA */
+
+/* CRC stream state */
+typedef struct
+{
+    uint32_t dma_periph;                                            /*!< DMA feeding CRC_DATA, 0 for the CPU only */
+    dma_channel_enum channelx;                                      /*!< DMA channel feeding CRC_DATA */
+    uint32_t dma_threshold;                                         /*!< shortest run in words handed to the DMA */
+    const uint32_t *dma_next;                                       /*!< words of the running DMA run not yet started */
+    uint32_t dma_remain;                                            /*!< number of words at dma_next */
+    uint32_t dma_busy;                                              /*!< a DMA transfer to CRC_DATA is running */
+    uint32_t partial;                                               /*!< bytes of an incomplete word, little-endian */
+    uint32_t partial_len;                                           /*!< number of bytes in partial */
+}crc_stream_struct;
+
+/* function declarations */
+/* reset the CRC unit and start a stream */
+void crc_stream_init(crc_stream_struct *stream);
+/* let the stream feed long word runs through a memory to memory DMA channel */
+void crc_stream_dma_config(crc_stream_struct *stream, uint32_t dma_periph, dma_channel_enum channelx, uint32_t threshold);
+/* add bytes to the stream and wait until they are processed */
+void crc_stream_update(crc_stream_struct *stream, const void *data, uint32_t len);
+/* add bytes to the stream, a DMA run keeps going in the background */
+void crc_stream_update_start(crc_stream_struct *stream, const void *data, uint32_t len);
+/* check whether a DMA run of the stream is still going */
+FlagStatus crc_stream_busy(crc_stream_struct *stream);
+/* wait for the DMA run of the stream to end */
+void crc_stream_wait(crc_stream_struct *stream);
+/* finish the stream and get its CRC value */
+uint32_t crc_stream_final(crc_stream_struct *stream);
+
+#endif /* GD32VF103_CRC_STREAM_H */
@@ -0,0 +1,126 @@
+/*!
+    \file  gd32vf103_dac_stream.h
+    \brief definitions for the timer paced DAC waveform stream
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_DAC_STREAM_H
+#define GD32VF103_DAC_STREAM_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_dac.h"
+#include "gd32vf103_dma.h"
+
+/*
+    Waveform output on the DAC at a sample rate set by a basic timer. TIMER5
+    or TIMER6 counts at the timer clock, its update event is the TRGO that
+    triggers the DAC and every trigger makes the DAC ask the DMA for the next
+    sample, so the output runs at the exact timer rate without the CPU.
+
+    With no callback the buffer is a table the circular DMA plays over and
+    over, for a periodic waveform of size samples at sample_rate. With a
+    callback the buffer is split into two halves as in the I2S stream: the
+    half and full transfer interrupts hand the half the DMA has just left to
+    the callback to fill with the next samples. A callback that is late does
+    not stop the output; the half it works on is played while being written
+    and the stream counts an underrun.
+
+    Samples are 12-bit right aligned. In concurrent mode both DACs take the
+    same trigger and the buffer holds pairs of samples, DAC0 first: the DMA
+    moves them as one 32-bit word into DACC_R12DH, DAC0 in the lower and DAC1
+    in the upper half as dac_concurrent_data_set() packs them, so both outputs
+    change on the same trigger.
+
+    The clocks of the DAC, the timer and DMA1 and the analog mode of PA4 and
+    PA5 are set up by the application. DMA request channels: DAC0 and the
+    concurrent mode DMA1_CH2, DAC1 DMA1_CH3.
+*/
+
+/* constants definitions */
+#define DAC_STREAM_SIZE_MAX             0xFFFEU                     /*!< largest buffer in DMA transfers, bounded by the DMA counter */
+
+/* DAC stream outputs */
+#define DAC_STREAM_OUTPUT_DAC0          0U                          /*!< DAC0 on PA4 */
+#define DAC_STREAM_OUTPUT_DAC1          1U                          /*!< DAC1 on PA5 */
+#define DAC_STREAM_OUTPUT_CONCURRENT    2U                          /*!< both DACs, the buffer holds DAC0 and DAC1 pairs */
+
+/* DAC stream state */
+#define DAC_STREAM_IDLE                 0U                          /*!< initialized or stopped */
+#define DAC_STREAM_RUNNING              1U                          /*!< the timer paces the output */
+#define DAC_STREAM_ERROR                2U                          /*!< stopped on a DMA transfer error */
+
+struct dac_stream_struct;
+
+/* DAC stream callback: fills data with up to len samples and returns the number written */
+typedef uint32_t (*dac_stream_callback)(struct dac_stream_struct *stream, uint16_t *data, uint32_t len);
+
+/* DAC stream initialize struct */
+typedef struct
+{
+    uint32_t output;                                                /*!< DAC_STREAM_OUTPUT_xxx */
+    uint32_t timer_periph;                                          /*!< pacing timer, TIMERx(x=5,6) */
+    uint32_t sample_rate;                                           /*!< samples per second of each output */
+    uint16_t *buffer;                                               /*!< table, or storage of both halves */
+    uint32_t size;                                                  /*!< number of samples in buffer */
+    dac_stream_callback callback;                                   /*!< producer of the halves, NULL to loop the table */
+    void *user_data;                                                /*!< free for the application */
+}dac_stream_parameter_struct;
+
+/* DAC stream */
+typedef struct dac_stream_struct
+{
+    uint32_t output;                                                /*!< DAC_STREAM_OUTPUT_xxx */
+    uint32_t timer_periph;                                          /*!< pacing timer */
+    uint32_t dma_periph;                                            /*!< DMA serving the DAC */
+    dma_channel_enum channelx;                                      /*!< DMA channel of the DAC */
+    uint32_t sample_rate;                                           /*!< rate the timer actually runs at */
+    uint16_t *buffer;                                               /*!< table, or storage of both halves */
+    uint32_t size;                                                  /*!< number of samples in buffer */
+    uint32_t transfers;                                             /*!< number of DMA transfers over buffer */
+    dac_stream_callback callback;                                   /*!< producer of the halves, NULL to loop the table */
+    void *user_data;                                                /*!< free for the application */
+    volatile uint32_t state;                                        /*!< DAC_STREAM_IDLE, RUNNING or ERROR */
+    volatile uint32_t halves;                                       /*!< halves handed to the callback */
+    volatile uint32_t underrun;                                     /*!< halves not filled completely or in time */
+}dac_stream_struct;
+
+/* function declarations */
+/* configure the DAC, the DMA channel and the pacing timer of a stream */
+ErrStatus dac_stream_init(dac_stream_struct *stream, dac_stream_parameter_struct *init_struct);
+/* start the output, a streaming output fills both halves first */
+void dac_stream_start(dac_stream_struct *stream);
+/* stop the pacing timer and the DMA channel, the outputs keep their level */
+void dac_stream_stop(dac_stream_struct *stream);
+/* DMA channel interrupt service, hands the free half to the callback */
+void dac_stream_dma_irq_handler(dac_stream_struct *stream);
+
+#endif /* GD32VF103_DAC_STREAM_H */
@@ -0,0 +1,106 @@
+/*!
+    \file  gd32vf103_dma_job.h
+    \brief definitions for the DMA job queue driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_DMA_JOB_H
+#define GD32VF103_DMA_JOB_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_dma.h"
+
+/*
+    A job is a DMA transfer whose register values are computed once by
+    dma_job_prepare(). Committing it to a channel is a fixed sequence of six
+    register writes and no reads, instead of the read-modify-write calls of
+    dma_init() and friends. A queue owns one channel: submitted jobs run in
+    order, the full transfer finish interrupt starts the next job before the
+    callback of the finished one is called. The queue has a single submitting
+    context and the channel interrupt as consumer, so it takes no lock. The
+    number of queue slots must be a power of two.
+*/
+
+/* constants definitions */
+/* DMA job status */
+#define DMA_JOB_IDLE                    0U                          /*!< job prepared or finished and not queued */
+#define DMA_JOB_QUEUED                  1U                          /*!< job waits in a queue */
+#define DMA_JOB_ACTIVE                  2U                          /*!< job is committed to the channel */
+#define DMA_JOB_DONE                    3U                          /*!< all data transferred */
+#define DMA_JOB_ERROR                   4U                          /*!< the channel reported a transfer error */
+
+/* DMA job descriptor */
+typedef struct dma_job_struct
+{
+    uint32_t ctl;                                                   /*!< CHxCTL value of the transfer, CHEN excluded */
+    uint32_t periph_addr;                                           /*!< CHxPADDR value */
+    uint32_t memory_addr;                                           /*!< CHxMADDR value */
+    uint32_t number;                                                /*!< CHxCNT value */
+    void (*callback)(struct dma_job_struct *job);                   /*!< called from the interrupt when the job ends, or NULL */
+    void *user_data;                                                /*!< free for the owner of the job */
+    volatile uint32_t status;                                       /*!< DMA_JOB_IDLE, QUEUED, ACTIVE, DONE or ERROR */
+}dma_job_struct;
+
+/* DMA job queue of one channel */
+typedef struct
+{
+    uint32_t dma_periph;                                            /*!< DMAx(x=0,1) */
+    dma_channel_enum channelx;                                      /*!< channel owned by the queue */
+    dma_job_struct **slots;                                         /*!< queue storage */
+    uint32_t size;                                                  /*!< number of slots, power of two */
+    volatile uint32_t head;                                         /*!< jobs submitted, written by the submitter */
+    volatile uint32_t tail;                                         /*!< jobs ended, written by the interrupt */
+    volatile uint32_t busy;                                         /*!< a job is committed to the channel */
+}dma_queue_struct;
+
+/* function declarations */
+/* job functions */
+/* compute the register values of a DMA job */
+void dma_job_prepare(dma_job_struct *job, dma_parameter_struct *init_struct, uint32_t m2m, void (*callback)(dma_job_struct *job));
+/* commit a prepared job to a DMA channel and start it */
+void dma_job_commit(uint32_t dma_periph, dma_channel_enum channelx, const dma_job_struct *job);
+
+/* queue functions */
+/* initialize a DMA job queue on a channel */
+ErrStatus dma_queue_init(dma_queue_struct *queue, uint32_t dma_periph, dma_channel_enum channelx, dma_job_struct **slots, uint32_t size);
+/* append a job to a queue, it starts at once if the channel is idle */
+ErrStatus dma_queue_submit(dma_queue_struct *queue, dma_job_struct *job);
+/* get the number of jobs queued or running */
+uint32_t dma_queue_pending_get(dma_queue_struct *queue);
+/* stop the channel and drop every job of the queue */
+void dma_queue_stop(dma_queue_struct *queue);
+
+/* interrupt functions */
+/* DMA channel interrupt service, ends the running job and starts the next one */
+void dma_queue_irq_handler(dma_queue_struct *queue);
+
+#endif /* GD32VF103_DMA_JOB_H */
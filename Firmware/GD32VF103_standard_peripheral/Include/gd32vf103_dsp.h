@@ -0,0 +1,169 @@
+/*!
+    \file  gd32vf103_dsp.h
+    \brief definitions for the fixed-point DSP kernels
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_DSP_H
+#define GD32VF103_DSP_H
+
+#include "gd32vf103.h"
+
+/*
+    Fixed-point signal processing for the RV32IMAC core, which has a fast
+    multiplier, a slow divider and no saturating or packed instructions.
+    Q15 values are int16_t in Q1.15 and Q31 values int32_t in Q1.31.
+
+    The kernels keep to what the core does well: products go into 32-bit
+    accumulators where the range allows, the Q31 FIR and biquad add the full
+    64-bit products (a mul and a mulh each) into a 64-bit accumulator, the
+    FIR delay line is stored twice so the inner loop runs over contiguous
+    memory without wrapping, the inner loops are unrolled by four, and
+    divisions are replaced by shifts or by a multiply with a reciprocal.
+    Results are rounded and saturated once, when they leave the accumulator.
+
+    Every filter keeps its state in a struct and in memory given by the
+    caller, so blocks of any length can be fed one after the other, such as
+    the frames of an ADC stream after dsp_q15_from_adc().
+*/
+
+/* constants definitions */
+#define DSP_BIQUAD_COEFF_NUM            5U                          /*!< coefficients per biquad stage: b0, b1, b2, a1, a2 */
+#define DSP_BIQUAD_STATE_NUM            4U                          /*!< state per biquad stage: x[n-1], x[n-2], y[n-1], y[n-2] */
+#define DSP_CIC_STAGES_MAX              4U                          /*!< integrator and comb pairs of a CIC decimator */
+#define DSP_CIC_GROWTH_MAX              16U                         /*!< stages * log2(decimation) fitting the 32-bit registers */
+#define DSP_FFT_SIZE_MIN                4U                          /*!< smallest FFT, complex points */
+#define DSP_FFT_SIZE_MAX                1024U                       /*!< largest FFT, bounded by the sine table */
+
+typedef int16_t q15_t;                                              /*!< Q1.15 value */
+typedef int32_t q31_t;                                              /*!< Q1.31 value */
+
+/* Q15 FIR filter */
+typedef struct
+{
+    const q15_t *coeffs;                                            /*!< taps coefficients, h[0] first */
+    q15_t *state;                                                   /*!< delay line, 2 * taps values */
+    uint32_t taps;                                                  /*!< number of coefficients */
+    uint32_t index;                                                 /*!< position of the newest sample in the delay line */
+}dsp_fir_q15_struct;
+
+/* Q31 FIR filter */
+typedef struct
+{
+    const q31_t *coeffs;                                            /*!< taps coefficients, h[0] first */
+    q31_t *state;                                                   /*!< delay line, 2 * taps values */
+    uint32_t taps;                                                  /*!< number of coefficients */
+    uint32_t index;                                                 /*!< position of the newest sample in the delay line */
+}dsp_fir_q31_struct;
+
+/* Q15 biquad cascade, direct form I */
+typedef struct
+{
+    const q15_t *coeffs;                                            /*!< DSP_BIQUAD_COEFF_NUM per stage, in Q(15 - shift) */
+    q15_t *state;                                                   /*!< DSP_BIQUAD_STATE_NUM per stage */
+    uint32_t stages;                                                /*!< number of second order sections */
+    uint32_t shift;                                                 /*!< headroom bits of the coefficients, 0 to 2 */
+}dsp_biquad_q15_struct;
+
+/* Q31 biquad cascade, direct form I */
+typedef struct
+{
+    const q31_t *coeffs;                                            /*!< DSP_BIQUAD_COEFF_NUM per stage, in Q(31 - shift) */
+    q31_t *state;                                                   /*!< DSP_BIQUAD_STATE_NUM per stage */
+    uint32_t stages;                                                /*!< number of second order sections */
+    uint32_t shift;                                                 /*!< headroom bits of the coefficients, 0 to 2 */
+}dsp_biquad_q31_struct;
+
+/* Q15 moving average */
+typedef struct
+{
+    q15_t *window;                                                  /*!< last length samples */
+    uint32_t length;                                                /*!< number of samples averaged */
+    uint32_t index;                                                 /*!< position of the oldest sample in window */
+    int32_t sum;                                                    /*!< sum of the samples in window */
+    uint32_t reciprocal;                                            /*!< 2^32 / length, rounded up */
+}dsp_moving_average_q15_struct;
+
+/* Q15 CIC decimator */
+typedef struct
+{
+    uint32_t integrator[DSP_CIC_STAGES_MAX];                        /*!< integrator registers, wrapping around */
+    uint32_t comb[DSP_CIC_STAGES_MAX];                              /*!< previous input of each comb */
+    uint32_t stages;                                                /*!< number of integrator and comb pairs */
+    uint32_t decimation;                                            /*!< input samples per output sample, a power of two */
+    uint32_t shift;                                                 /*!< stages * log2(decimation), the gain of the filter */
+    uint32_t phase;                                                 /*!< input samples since the last output */
+}dsp_cic_q15_struct;
+
+/* function declarations */
+/* convert right aligned 12-bit ADC samples to Q15 around mid scale */
+void dsp_q15_from_adc(const uint16_t *samples, uint32_t stride, q15_t *out, uint32_t len);
+
+/* FIR functions */
+/* initialize a Q15 FIR filter and clear its delay line */
+void dsp_fir_q15_init(dsp_fir_q15_struct *fir, const q15_t *coeffs, q15_t *state, uint32_t taps);
+/* filter a block of Q15 samples */
+void dsp_fir_q15(dsp_fir_q15_struct *fir, const q15_t *in, q15_t *out, uint32_t len);
+/* initialize a Q31 FIR filter and clear its delay line */
+void dsp_fir_q31_init(dsp_fir_q31_struct *fir, const q31_t *coeffs, q31_t *state, uint32_t taps);
+/* filter a block of Q31 samples */
+void dsp_fir_q31(dsp_fir_q31_struct *fir, const q31_t *in, q31_t *out, uint32_t len);
+
+/* IIR functions */
+/* initialize a Q15 biquad cascade and clear its state */
+ErrStatus dsp_biquad_q15_init(dsp_biquad_q15_struct *biquad, const q15_t *coeffs, q15_t *state,
+                              uint32_t stages, uint32_t shift);
+/* filter a block of Q15 samples through the cascade */
+void dsp_biquad_q15(dsp_biquad_q15_struct *biquad, const q15_t *in, q15_t *out, uint32_t len);
+/* initialize a Q31 biquad cascade and clear its state */
+ErrStatus dsp_biquad_q31_init(dsp_biquad_q31_struct *biquad, const q31_t *coeffs, q31_t *state,
+                              uint32_t stages, uint32_t shift);
+/* filter a block of Q31 samples through the cascade */
+void dsp_biquad_q31(dsp_biquad_q31_struct *biquad, const q31_t *in, q31_t *out, uint32_t len);
+
+/* averaging and decimation functions */
+/* initialize a Q15 moving average and clear its window */
+ErrStatus dsp_moving_average_q15_init(dsp_moving_average_q15_struct *average, q15_t *window, uint32_t length);
+/* average a block of Q15 samples */
+void dsp_moving_average_q15(dsp_moving_average_q15_struct *average, const q15_t *in, q15_t *out, uint32_t len);
+/* initialize a Q15 CIC decimator and clear its registers */
+ErrStatus dsp_cic_q15_init(dsp_cic_q15_struct *cic, uint32_t stages, uint32_t decimation);
+/* decimate a block of Q15 samples */
+uint32_t dsp_cic_q15(dsp_cic_q15_struct *cic, const q15_t *in, q15_t *out, uint32_t len);
+
+/* analysis functions */
+/* get the root mean square of a block of Q15 samples */
+q15_t dsp_rms_q15(const q15_t *in, uint32_t len);
+/* in place radix-2 FFT of interleaved complex Q15 samples, scaled by 1/n */
+ErrStatus dsp_fft_q15(q15_t *data, uint32_t n);
+
+#endif /* GD32VF103_DSP_H */
@@ -46,6 +46,33 @@ OF SUCH DAMAGE.
 
 #define __SEV           eclic_send_event
 
+/* interrupt handler dispatch modes */
+#define ECLIC_NON_VECTORED                 0U   /*!< plain C handler, called through irq_entry which saves the full caller context */
+#define ECLIC_VECTORED                     1U   /*!< the core jumps to the handler, which saves its own context and returns with mret */
+
+/* define a vectored handler, the compiler saves only the registers it uses and returns with mret */
+#define ECLIC_VECTORED_HANDLER(name)       __attribute__((interrupt)) void name(void)
+
+#define ECLIC_VECTOR_TABLE_ALIGN           512U /*!< alignment of the vector table, covers ECLIC_NUM_INTERRUPTS entries */
+#define ECLIC_LATENCY_BINS                 16U  /*!< number of bins of a latency histogram */
+
+/* record the entry latency of an interrupt, the first statement of an instrumented handler */
+#ifdef ECLIC_LATENCY_ENABLE
+#define ECLIC_LATENCY_RECORD(source)       eclic_latency_record(source)
+#else
+#define ECLIC_LATENCY_RECORD(source)       ((void)0)
+#endif /* ECLIC_LATENCY_ENABLE */
+
+/* entry latency histogram of one interrupt */
+typedef struct
+{
+    uint32_t bin_width;                         /*!< cycles per bin */
+    uint32_t bins[ECLIC_LATENCY_BINS];          /*!< samples per bin, the last bin also counts everything above */
+    uint32_t samples;                           /*!< number of samples */
+    uint32_t min;                               /*!< shortest latency in cycles */
+    uint32_t max;                               /*!< longest latency in cycles */
+}eclic_latency_struct;
+
 /* function declarations */
 /* enable the global interrupt */
 void eclic_global_interrupt_enable(void);
@@ -57,6 +84,22 @@ void eclic_priority_group_set(uint32_t prigroup);
 void eclic_irq_enable(uint32_t source, uint8_t level, uint8_t priority);
 /* disable the interrupt request */
 void eclic_irq_disable(uint32_t source);
+/* copy the vector table to RAM so handlers can be registered at run time */
+void eclic_vector_table_relocate(void);
+/* register the handler of an interrupt request, select its dispatch mode and enable it */
+void eclic_irq_handler_register(uint32_t source, uint8_t level, uint8_t priority, void (*handler)(void), uint32_t mode);
+
+/* latency instrumentation functions */
+/* set the functions keeping mcycle on while histograms are attached */
+void eclic_latency_counter_config(void (*hold)(void), void (*release)(void));
+/* attach a histogram to an interrupt, mcycle is turned on while it is attached */
+void eclic_latency_attach(uint32_t source, eclic_latency_struct *histogram, uint32_t bin_width);
+/* mark the moment the event of an interrupt happened */
+void eclic_latency_mark(uint32_t source);
+/* mark now and make an interrupt pending by software */
+void eclic_latency_trigger(uint32_t source);
+/* add the cycles since the mark or since irq_entry to the histogram of an interrupt */
+void eclic_latency_record(uint32_t source);
 
 /* reset system */
 void eclic_system_reset(void);
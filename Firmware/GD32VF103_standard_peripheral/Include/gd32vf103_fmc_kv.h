@@ -0,0 +1,140 @@
+/*!
+    \file  gd32vf103_fmc_kv.h
+    \brief definitions for the key-value store in the main flash
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef GD32VF103_FMC_KV_H
+#define GD32VF103_FMC_KV_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_fmc.h"
+
+/*
+    Log-structured key-value store on 1 KB pages of the main flash, for
+    settings that used to live in an EEPROM. Keys are 0 to key_num - 1 and a
+    RAM index holds the flash address of the current record of each key, so
+    a lookup is one array access. An update appends a new record to the
+    active page and leaves the old one behind; writing the value a key
+    already has programs nothing.
+
+    A page starts with a header: magic, 32-bit sequence number, a valid
+    marker and an obsolete marker. A record is the key, the length, the data
+    and a commit marker, all half words programmed in that order with
+    fmc_halfword_program(). Each marker is a half word of its own that goes
+    from 0xFFFF to 0x0000, so a write cut by a reset leaves a record without
+    its commit marker, which fmc_kv_init() skips: the key keeps its previous
+    value. A page only counts once its valid marker is set and no longer
+    once its obsolete marker is set.
+
+    Writes never erase. When the active page is full the next erased page
+    after it is opened, so the pages are used in turn. The last erased page
+    is kept for the garbage collection, which runs in fmc_kv_maintain(): the
+    application calls it when a stall suits it, each call either copies a
+    bounded number of live records out of the oldest page holding dead ones
+    or erases one page. Once the collection has taken the last erased page,
+    writes only get the room its remaining copies leave. A page whose records
+    were all copied is marked obsolete before it is erased, so an erase cut
+    by a reset is never read back as records. The live records must fit in
+    page_num - 2 pages.
+*/
+
+/* constants definitions */
+#define FMC_KV_PAGE_SIZE                1024U                       /*!< bytes of a flash page */
+#define FMC_KV_PAGE_MAX                 32U                         /*!< most pages of a store */
+#define FMC_KV_VALUE_MAX                256U                        /*!< longest value in bytes */
+#define FMC_KV_KEY_MAX                  0xFFFFU                     /*!< most keys, 0xFFFF marks an erased half word */
+#define FMC_KV_RECORD_SIZE(len)         (6U + (((len) + 1U) & ~1U)) /*!< bytes of a record holding len bytes */
+
+/* page states */
+#define FMC_KV_PAGE_ERASED              0U                          /*!< erased, free to open */
+#define FMC_KV_PAGE_VALID               1U                          /*!< holds records */
+#define FMC_KV_PAGE_DIRTY               2U                          /*!< obsolete or torn, to be erased */
+
+/* outcome of an operation */
+typedef enum
+{
+    FMC_KV_OK = 0,                                                  /*!< done */
+    FMC_KV_PENDING,                                                 /*!< fmc_kv_maintain() has more work */
+    FMC_KV_NOT_FOUND,                                               /*!< the key has no value */
+    FMC_KV_PARAM,                                                   /*!< key or length out of range */
+    FMC_KV_FULL,                                                    /*!< no erased page left, fmc_kv_maintain() must run */
+    FMC_KV_PGERR,                                                   /*!< program error */
+    FMC_KV_WPERR,                                                   /*!< erase/program protection error */
+    FMC_KV_TOERR                                                    /*!< the FMC did not get ready */
+}fmc_kv_result_enum;
+
+/* key-value store initialize struct */
+typedef struct
+{
+    uint32_t start;                                                 /*!< first page of the store, page aligned */
+    uint32_t page_num;                                              /*!< pages of the store, 3 to FMC_KV_PAGE_MAX */
+    uint32_t *index;                                                /*!< key_num entries, filled by fmc_kv_init() */
+    uint32_t key_num;                                               /*!< number of keys, 1 to FMC_KV_KEY_MAX */
+}fmc_kv_parameter_struct;
+
+/* key-value store state */
+typedef struct
+{
+    uint32_t start;                                                 /*!< first page of the store */
+    uint32_t page_num;                                              /*!< pages of the store */
+    uint32_t *index;                                                /*!< address of the current record of each key, 0 for none */
+    uint32_t key_num;                                               /*!< number of keys */
+    uint8_t page_state[FMC_KV_PAGE_MAX];                            /*!< FMC_KV_PAGE_ERASED, _VALID or _DIRTY */
+    uint32_t page_seq[FMC_KV_PAGE_MAX];                             /*!< sequence number of a valid page */
+    uint16_t page_dead[FMC_KV_PAGE_MAX];                            /*!< bytes of records no longer current */
+    uint32_t active;                                                /*!< page receiving the records, page_num for none */
+    uint32_t offset;                                                /*!< next free byte of the active page */
+    uint32_t seq;                                                   /*!< sequence number of the last page opened */
+    uint32_t erased;                                                /*!< erased pages */
+    uint32_t gc_page;                                               /*!< page being collected, page_num for none */
+    uint32_t gc_offset;                                             /*!< next record of the page being collected */
+    uint32_t gc_need;                                               /*!< bytes of live records left to copy */
+    uint32_t writes;                                                /*!< records appended by the caller */
+    uint32_t unchanged;                                             /*!< writes of the current value, nothing programmed */
+    uint32_t copies;                                                /*!< records copied by the garbage collection */
+    uint32_t erases;                                                /*!< pages erased */
+    uint32_t torn;                                                  /*!< records without commit marker found by fmc_kv_init() */
+}fmc_kv_struct;
+
+/* function declarations */
+/* scan the pages and build the index */
+ErrStatus fmc_kv_init(fmc_kv_struct *kv, fmc_kv_parameter_struct *init_struct);
+/* read the value of a key */
+fmc_kv_result_enum fmc_kv_read(fmc_kv_struct *kv, uint32_t key, uint8_t *data, uint32_t size, uint32_t *len);
+/* write the value of a key */
+fmc_kv_result_enum fmc_kv_write(fmc_kv_struct *kv, uint32_t key, const uint8_t *data, uint32_t len);
+/* delete the value of a key */
+fmc_kv_result_enum fmc_kv_delete(fmc_kv_struct *kv, uint32_t key);
+/* do one step of the garbage collection */
+fmc_kv_result_enum fmc_kv_maintain(fmc_kv_struct *kv, uint32_t budget);
+
+#endif /* GD32VF103_FMC_KV_H */
@@ -0,0 +1,149 @@
+/*!
+    \file  gd32vf103_fmc_log.h
+    \brief definitions for the record log ring in the main flash
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef GD32VF103_FMC_LOG_H
+#define GD32VF103_FMC_LOG_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_fmc.h"
+
+/*
+    Append-only log of records in a ring of 1 KB pages of the main flash.
+    Each record carries a sequence number, the mcycle count when it was
+    appended, its length and a CRC of all that computed by the CRC unit; it
+    is programmed as 32-bit words and never crosses a page.
+
+    fmc_log_append() builds the record in a RAM ring of words and returns; it
+    never waits for the FMC. The words are programmed one by one from the FMC
+    end of operation interrupt. As soon as a page is opened for writing the
+    page after it, holding the oldest records, is erased from the same
+    interrupt, so the next page is ready long before it is needed; while the
+    erase runs the records collect in the RAM ring, which must hold the
+    records of one page erase. A record that does not fit in the RAM ring is
+    dropped and counted.
+
+    fmc_log_init() locates the head from the sequence number opening each
+    page and walks only the newest page; a record cut by a reset fails its
+    CRC and is skipped. It also notes which pages are wholly erased, so a
+    page already erased is not erased again. The FMC stays unlocked while the log runs, the CRC
+    unit is reset by each append and each record read, and the CRC clock and
+    FMC_IRQn are enabled by the caller. Code running from the flash stalls
+    while a page is erased or a word programmed.
+*/
+
+/* constants definitions */
+#define FMC_LOG_PAGE_SIZE               1024U                       /*!< bytes of a flash page */
+#define FMC_LOG_PAGE_MAX                32U                         /*!< most pages of a log */
+#define FMC_LOG_DATA_MAX                256U                        /*!< longest record data in bytes */
+#define FMC_LOG_RECORD_WORDS(len)       (4U + (((len) + 3U) >> 2))  /*!< words of a record holding len bytes */
+
+/* outcome of an operation */
+typedef enum
+{
+    FMC_LOG_OK = 0,                                                 /*!< done */
+    FMC_LOG_END,                                                    /*!< no record left to read */
+    FMC_LOG_CRC,                                                    /*!< record skipped on a CRC error */
+    FMC_LOG_PARAM,                                                  /*!< length out of range */
+    FMC_LOG_FULL                                                    /*!< the RAM ring is full, the record is dropped */
+}fmc_log_result_enum;
+
+/* record read back */
+typedef struct
+{
+    uint32_t seq;                                                   /*!< sequence number */
+    uint32_t stamp;                                                 /*!< mcycle when the record was appended */
+    uint32_t len;                                                   /*!< bytes of data */
+}fmc_log_record_struct;
+
+/* position of the next record to read */
+typedef struct
+{
+    uint32_t page;                                                  /*!< page of the log */
+    uint32_t offset;                                                /*!< byte offset in the page */
+}fmc_log_cursor_struct;
+
+/* flash log initialize struct */
+typedef struct
+{
+    uint32_t start;                                                 /*!< first page of the log, page aligned */
+    uint32_t page_num;                                              /*!< pages of the log, 3 to FMC_LOG_PAGE_MAX */
+    uint32_t *buffer;                                               /*!< RAM ring of words */
+    uint32_t size;                                                  /*!< words of the RAM ring, a power of two holding a longest record */
+}fmc_log_parameter_struct;
+
+/* flash log state */
+typedef struct
+{
+    uint32_t start;                                                 /*!< first page of the log */
+    uint32_t page_num;                                              /*!< pages of the log */
+    uint32_t *buffer;                                               /*!< RAM ring of words */
+    uint32_t size;                                                  /*!< words of the RAM ring */
+    volatile uint32_t head;                                         /*!< words put in the RAM ring */
+    volatile uint32_t tail;                                         /*!< words taken from the RAM ring */
+    uint32_t seq;                                                   /*!< sequence number of the next record */
+    uint32_t locked;                                                /*!< FMC_CTL0_LK if the FMC was locked by init */
+    volatile uint32_t page;                                         /*!< page written */
+    volatile uint32_t offset;                                       /*!< byte offset of the next word programmed */
+    volatile uint32_t committed;                                    /*!< byte offset after the last record programmed */
+    volatile uint32_t words;                                        /*!< words left of the record programmed */
+    volatile uint32_t erase;                                        /*!< 1 while the page after the one written needs an erase */
+    volatile uint32_t erased_map;                                   /*!< BIT(x) for a page x known to be erased */
+    volatile uint32_t busy;                                         /*!< FMC operation in progress */
+    volatile uint32_t appended;                                     /*!< records put in the RAM ring */
+    volatile uint32_t dropped;                                      /*!< records dropped on a full RAM ring */
+    volatile uint32_t written;                                      /*!< records programmed */
+    volatile uint32_t erases;                                       /*!< pages erased */
+    volatile uint32_t errors;                                       /*!< programs or erases that failed */
+    volatile uint32_t fill_max;                                     /*!< most words in the RAM ring */
+    uint32_t torn;                                                  /*!< records of the newest page failing their CRC at init */
+}fmc_log_struct;
+
+/* function declarations */
+/* locate the head, unlock the FMC and enable its interrupts */
+ErrStatus fmc_log_init(fmc_log_struct *log, fmc_log_parameter_struct *init_struct);
+/* disable the FMC interrupts and lock the FMC again */
+void fmc_log_deinit(fmc_log_struct *log);
+/* append a record */
+fmc_log_result_enum fmc_log_append(fmc_log_struct *log, const void *data, uint32_t len);
+/* get the number of words waiting in the RAM ring */
+uint32_t fmc_log_pending(fmc_log_struct *log);
+/* place a cursor on the oldest record */
+void fmc_log_read_start(fmc_log_struct *log, fmc_log_cursor_struct *cursor);
+/* read the record at a cursor and move it to the next one */
+fmc_log_result_enum fmc_log_read(fmc_log_struct *log, fmc_log_cursor_struct *cursor, fmc_log_record_struct *record,
+                                 uint8_t *data, uint32_t size);
+/* FMC interrupt handler of the log */
+void fmc_log_irq_handler(fmc_log_struct *log);
+
+#endif /* GD32VF103_FMC_LOG_H */
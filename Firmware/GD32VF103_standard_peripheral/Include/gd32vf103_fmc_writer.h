@@ -0,0 +1,145 @@
+/*!
+    \file  gd32vf103_fmc_writer.h
+    \brief definitions for the buffered FMC writer
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_FMC_WRITER_H
+#define GD32VF103_FMC_WRITER_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_fmc.h"
+
+/*
+    Buffered writer of the main flash for byte ranges of any length and
+    alignment. A write lands in the RAM shadow of its 1 KB page; the words it
+    touches are merged with the flash contents the first time, so any number
+    of small writes to one page cost one flush. With all shadows in use the
+    least recently written page is flushed to make room.
+
+    A flush reads the page once and compares it with the shadow. The FMC
+    programs a half word only once after an erase, so the page is erased only
+    when a half word that changes is no longer 0xFFFF; a page that is already
+    erased, or is only appended to, is never erased. Without an erase only the
+    half words that differ are programmed, as one 32-bit program when both
+    halves of a word change; after an erase only the words that are not
+    0xFFFFFFFF. PG is held across the page with one ready wait per program.
+    The page is then read back through the CRC unit and compared with the CRC
+    of the shadow.
+
+    The CRC unit is reset by each flush, so no CRC stream may be in progress;
+    the CRC clock is enabled by the caller. The flash is unlocked for a flush
+    and locked again if it was locked before. Code running from the flash
+    stalls while the FMC erases or programs.
+*/
+
+/* constants definitions */
+#define FMC_WRITER_PAGE_SIZE            1024U                       /*!< bytes of a flash page */
+#define FMC_WRITER_PAGE_WORDS           (FMC_WRITER_PAGE_SIZE / 4U) /*!< words of a flash page */
+#define FMC_WRITER_NO_PAGE              0xFFFFFFFFU                 /*!< page address of an unused shadow */
+
+/* outcome of a write or a flush */
+typedef enum
+{
+    FMC_WRITER_OK = 0,                                              /*!< data written */
+    FMC_WRITER_RANGE,                                               /*!< bytes outside the area of the writer */
+    FMC_WRITER_PGERR,                                               /*!< program error */
+    FMC_WRITER_WPERR,                                               /*!< erase/program protection error */
+    FMC_WRITER_TOERR,                                               /*!< the FMC did not get ready */
+    FMC_WRITER_VERIFY                                               /*!< the CRC of the page differs from the shadow */
+}fmc_writer_result_enum;
+
+/* statistics of one page flushed */
+typedef struct
+{
+    uint32_t page;                                                  /*!< page address */
+    uint32_t erased;                                                /*!< 1 if the page was erased */
+    uint32_t programmed;                                            /*!< words and half words programmed */
+    uint32_t skipped;                                               /*!< words written by the caller that needed no program */
+    uint32_t crc;                                                   /*!< CRC of the page read back */
+    uint32_t cycles;                                                /*!< mcycles spent on the page */
+    fmc_writer_result_enum result;                                  /*!< outcome */
+}fmc_writer_page_struct;
+
+/* RAM shadow of a flash page */
+typedef struct
+{
+    uint32_t page;                                                  /*!< page address, or FMC_WRITER_NO_PAGE */
+    uint32_t used;                                                  /*!< write count at the last write, for the replacement */
+    uint32_t written[FMC_WRITER_PAGE_WORDS / 32U];                  /*!< BIT(x) for a word x merged into the shadow */
+    uint32_t data[FMC_WRITER_PAGE_WORDS];                           /*!< page contents */
+}fmc_writer_shadow_struct;
+
+struct fmc_writer_struct;
+
+/* FMC writer callback, called at the end of each page flushed */
+typedef void (*fmc_writer_page_callback)(struct fmc_writer_struct *writer, const fmc_writer_page_struct *page);
+
+/* FMC writer initialize struct */
+typedef struct
+{
+    uint32_t start;                                                 /*!< first address of the area, page aligned */
+    uint32_t size;                                                  /*!< bytes of the area, a multiple of the page size */
+    fmc_writer_shadow_struct *shadows;                              /*!< shadow storage */
+    uint32_t shadow_num;                                            /*!< number of shadows, at least 1 */
+    fmc_writer_page_callback callback;                              /*!< end of a page flushed, or NULL */
+}fmc_writer_parameter_struct;
+
+/* FMC writer state */
+typedef struct fmc_writer_struct
+{
+    uint32_t start;                                                 /*!< first address of the area */
+    uint32_t size;                                                  /*!< bytes of the area */
+    fmc_writer_shadow_struct *shadows;                              /*!< shadows */
+    uint32_t shadow_num;                                            /*!< number of shadows */
+    uint32_t writes;                                                /*!< write count */
+    fmc_writer_page_callback callback;                              /*!< end of a page flushed, or NULL */
+    void *user_data;                                                /*!< free for the owner of the callback */
+    uint32_t pages;                                                 /*!< pages flushed */
+    uint32_t erases;                                                /*!< pages erased */
+    uint32_t erases_skipped;                                        /*!< pages flushed without an erase */
+    uint32_t programmed;                                            /*!< words and half words programmed */
+    uint32_t skipped;                                               /*!< words that needed no program */
+    uint32_t errors;                                                /*!< pages that failed */
+}fmc_writer_struct;
+
+/* function declarations */
+/* initialize the writer with all shadows unused */
+ErrStatus fmc_writer_init(fmc_writer_struct *writer, fmc_writer_parameter_struct *init_struct);
+/* write a byte range into the shadows */
+fmc_writer_result_enum fmc_writer_write(fmc_writer_struct *writer, uint32_t address, const uint8_t *data, uint32_t len);
+/* read a byte range as it will be once flushed */
+fmc_writer_result_enum fmc_writer_read(fmc_writer_struct *writer, uint32_t address, uint8_t *data, uint32_t len);
+/* flush every shadow in use to the flash */
+fmc_writer_result_enum fmc_writer_flush(fmc_writer_struct *writer);
+
+#endif /* GD32VF103_FMC_WRITER_H */
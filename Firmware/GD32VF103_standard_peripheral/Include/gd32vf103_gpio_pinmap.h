@@ -0,0 +1,108 @@
+/*!
+    \file  gd32vf103_gpio_pinmap.h
+    \brief definitions for the GPIO pin map driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_GPIO_PINMAP_H
+#define GD32VF103_GPIO_PINMAP_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_gpio.h"
+
+/*
+    A board pin map is a const table with one entry per pin group. It is
+    compiled into one CTL0/CTL1/OCTL image per used port and one AFIO_PCF0/
+    AFIO_PCF1 image, which are then written with one store per register and
+    no reads. The image of a port covers all of its 16 pins: pins that are not
+    listed are put into their reset state, floating input. Ports that do not
+    appear in the table are not touched.
+
+    Images can also be written as constant expressions with the
+    GPIO_PINMAP_CTL0/CTL1/OCTL macros, so they live in flash and need no
+    compilation at run time. The GPIO and AFIO clocks must be enabled by the
+    caller.
+*/
+
+/* constants definitions */
+#define GPIO_PINMAP_PORT_NUM            5U                          /*!< GPIOA to GPIOE */
+
+/* control bits of one pin, the speed only applies to output modes */
+#define GPIO_PINMAP_CFG(mode, speed)    ((((uint32_t)(mode)) & 0x0FU) | ((0U != ((uint32_t)(mode) & 0x10U)) ? (uint32_t)(speed) : 0U))
+/* GPIO_CTL0 bits of pin n, zero for the pins of GPIO_CTL1 */
+#define GPIO_PINMAP_CTL0(n, mode, speed) (((n) < 8U) ? GPIO_MODE_SET((n) & 7U, GPIO_PINMAP_CFG((mode), (speed))) : 0U)
+/* GPIO_CTL1 bits of pin n, zero for the pins of GPIO_CTL0 */
+#define GPIO_PINMAP_CTL1(n, mode, speed) (((n) >= 8U) ? GPIO_MODE_SET((n) & 7U, GPIO_PINMAP_CFG((mode), (speed))) : 0U)
+/* GPIO_OCTL bit of pin n: the pull direction of IPU/IPD or the initial output level */
+#define GPIO_PINMAP_OCTL(n, mode, level) (((GPIO_MODE_IPU == (mode)) || ((0U != ((uint32_t)(mode) & 0x10U)) && (RESET != (level)))) ? BIT(n) : 0U)
+/* GPIO_CTLx image with every pin in its reset state */
+#define GPIO_PINMAP_CTL_RESET           ((uint32_t)0x44444444U)
+
+/* one entry of a board pin map */
+typedef struct
+{
+    uint32_t gpio_periph;                                           /*!< GPIOx(x = A,B,C,D,E) */
+    uint32_t pin;                                                   /*!< GPIO_PIN_x(x=0..15), one or more */
+    uint8_t mode;                                                   /*!< GPIO_MODE_x */
+    uint8_t speed;                                                  /*!< GPIO_OSPEED_x, for output modes */
+    uint8_t level;                                                  /*!< initial output level, SET or RESET */
+}gpio_pinmap_entry_struct;
+
+/* register image of one port */
+typedef struct
+{
+    uint32_t gpio_periph;                                           /*!< GPIOx(x = A,B,C,D,E) */
+    uint32_t ctl0;                                                  /*!< GPIO_CTL0 value */
+    uint32_t ctl1;                                                  /*!< GPIO_CTL1 value */
+    uint32_t octl;                                                  /*!< GPIO_OCTL value */
+}gpio_port_image_struct;
+
+/* register image of a whole pin map */
+typedef struct
+{
+    gpio_port_image_struct port[GPIO_PINMAP_PORT_NUM];              /*!< images of GPIOA to GPIOE */
+    uint32_t port_used;                                             /*!< bit x set when port x is in the map */
+    uint32_t remap_used;                                            /*!< the AFIO registers are written */
+    uint32_t pcf0;                                                  /*!< AFIO_PCF0 value */
+    uint32_t pcf1;                                                  /*!< AFIO_PCF1 value */
+}gpio_pinmap_image_struct;
+
+/* function declarations */
+/* compile a pin table and a remap list into register images */
+ErrStatus gpio_pinmap_compile(const gpio_pinmap_entry_struct *table, uint32_t count,
+                              const uint32_t *remap, uint32_t remap_count, gpio_pinmap_image_struct *image);
+/* write the register images of a compiled pin map */
+void gpio_pinmap_apply(const gpio_pinmap_image_struct *image);
+/* write the register image of one port */
+void gpio_port_image_apply(const gpio_port_image_struct *port);
+
+#endif /* GD32VF103_GPIO_PINMAP_H */
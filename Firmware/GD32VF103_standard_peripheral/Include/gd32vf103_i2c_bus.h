@@ -0,0 +1,141 @@
+/*!
+    \file  gd32vf103_i2c_bus.h
+    \brief definitions for the interrupt driven I2C master transaction queue
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_I2C_BUS_H
+#define GD32VF103_I2C_BUS_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_i2c.h"
+#include "gd32vf103_timer.h"
+#include "gd32vf103_dma_job.h"
+
+/*
+    Queue of I2C master transactions run by the event and error interrupts of
+    one I2C peripheral. A transaction writes tx_len bytes to a slave and then,
+    after a repeated start, reads rx_len bytes from it, so a register read is a
+    single transaction with the register address as its write part. Either part
+    may be empty, a transaction with both parts empty only probes the address.
+    Payloads of at least dma_threshold bytes go through the DMA channels of the
+    I2C, shorter ones are moved byte by byte by the event interrupt, which is
+    disabled while the DMA owns a payload. The end of a transaction starts the
+    next one at once when the bus is free. The I2C raises no event once a STOP
+    is done and the interrupt must not spin on it, so while the STOP is still
+    being sent a one-shot timer set by i2c_bus_timer_config() looks again after
+    about one SCL period; without a timer the next transaction waits for
+    i2c_bus_poll() or i2c_bus_submit(). The one and two byte receptions use
+    the ACKEN/POAP sequences of the reference manual, so the last byte is
+    always answered with a NACK before STOP.
+
+    The caller configures the clocks, the pins, the I2C speed and own address
+    and enables the I2C, the ECLIC lines of its event and error interrupts, of
+    the DMA channels and of the timer. The interrupt service routines call the
+    handlers of this module. Transactions are submitted from a single context,
+    the number of queue slots must be a power of two.
+*/
+
+/* constants definitions */
+/* I2C transaction status */
+#define I2C_XFER_IDLE                   0U                          /*!< transaction prepared or finished and not queued */
+#define I2C_XFER_QUEUED                 1U                          /*!< transaction waits in a queue */
+#define I2C_XFER_ACTIVE                 2U                          /*!< transaction is on the bus */
+#define I2C_XFER_DONE                   3U                          /*!< all bytes transferred */
+#define I2C_XFER_NACK                   4U                          /*!< the slave did not acknowledge its address or a byte */
+#define I2C_XFER_ERROR                  5U                          /*!< bus error, arbitration lost or DMA error */
+
+#define I2C_BUS_DMA_THRESHOLD           8U                          /*!< default number of bytes from which a payload goes through the DMA */
+
+/* I2C transaction descriptor */
+typedef struct i2c_xfer_struct
+{
+    uint32_t addr;                                                  /*!< slave address in bits 7:1, as for i2c_master_addressing */
+    const uint8_t *tx_buf;                                          /*!< bytes written to the slave */
+    uint32_t tx_len;                                                /*!< number of bytes written, may be 0 */
+    uint8_t *rx_buf;                                                /*!< bytes read from the slave */
+    uint32_t rx_len;                                                /*!< number of bytes read, may be 0 */
+    void (*callback)(struct i2c_xfer_struct *xfer);                 /*!< called from the interrupt when the transaction ends, or NULL */
+    void *user_data;                                                /*!< free for the owner of the transaction */
+    volatile uint32_t status;                                       /*!< I2C_XFER_IDLE, QUEUED, ACTIVE, DONE, NACK or ERROR */
+}i2c_xfer_struct;
+
+/* I2C transaction queue of one I2C peripheral */
+typedef struct
+{
+    uint32_t i2c_periph;                                            /*!< I2Cx(x=0,1) */
+    uint32_t dma_periph;                                            /*!< DMA0 to move long payloads, 0 for the CPU only */
+    dma_channel_enum dma_tx;                                        /*!< DMA channel of the I2C transmit request */
+    dma_channel_enum dma_rx;                                        /*!< DMA channel of the I2C receive request */
+    uint32_t dma_threshold;                                         /*!< shortest payload in bytes handed to the DMA */
+    uint32_t timer_periph;                                          /*!< one-shot timer looking at a pending STOP, or 0 */
+    i2c_xfer_struct **slots;                                        /*!< queue storage */
+    uint32_t size;                                                  /*!< number of slots, power of two */
+    volatile uint32_t head;                                         /*!< transactions submitted, written by the submitter */
+    volatile uint32_t tail;                                         /*!< transactions ended, written by the interrupts */
+    volatile uint32_t busy;                                         /*!< a transaction is on the bus */
+    uint32_t state;                                                 /*!< step of the running transaction */
+    uint32_t index;                                                 /*!< bytes moved in the running part */
+    dma_job_struct dma_job;                                         /*!< DMA transfer of the running payload */
+}i2c_bus_struct;
+
+/* function declarations */
+/* transaction functions */
+/* fill a write-then-read transaction */
+void i2c_xfer_prepare(i2c_xfer_struct *xfer, uint32_t addr, const uint8_t *tx_buf, uint32_t tx_len,
+                      uint8_t *rx_buf, uint32_t rx_len, void (*callback)(i2c_xfer_struct *xfer));
+
+/* queue functions */
+/* initialize the transaction queue of an I2C peripheral */
+ErrStatus i2c_bus_init(i2c_bus_struct *bus, uint32_t i2c_periph, i2c_xfer_struct **slots, uint32_t size);
+/* let the queue move long payloads through the DMA channels of the I2C */
+void i2c_bus_dma_config(i2c_bus_struct *bus, uint32_t dma_periph, uint32_t threshold);
+/* let a one-shot timer start the next transaction once the STOP of the previous one is on the bus */
+void i2c_bus_timer_config(i2c_bus_struct *bus, uint32_t timer_periph, uint32_t ticks);
+/* append a transaction to a queue, it starts at once if the bus is idle */
+ErrStatus i2c_bus_submit(i2c_bus_struct *bus, i2c_xfer_struct *xfer);
+/* start the oldest queued transaction if the STOP of the previous one is on the bus */
+void i2c_bus_poll(i2c_bus_struct *bus);
+/* get the number of transactions queued or running */
+uint32_t i2c_bus_pending_get(i2c_bus_struct *bus);
+
+/* interrupt functions */
+/* I2C event interrupt service, moves the running transaction on */
+void i2c_bus_event_irq_handler(i2c_bus_struct *bus);
+/* I2C error interrupt service, ends the running transaction with NACK or ERROR */
+void i2c_bus_error_irq_handler(i2c_bus_struct *bus);
+/* timer update interrupt service, starts the next transaction after a STOP */
+void i2c_bus_timer_irq_handler(i2c_bus_struct *bus);
+/* DMA channel interrupt service of both I2C channels, ends a DMA payload */
+void i2c_bus_dma_irq_handler(i2c_bus_struct *bus);
+
+#endif /* GD32VF103_I2C_BUS_H */
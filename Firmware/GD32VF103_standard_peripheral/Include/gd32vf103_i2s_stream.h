@@ -0,0 +1,117 @@
+/*!
+    \file  gd32vf103_i2s_stream.h
+    \brief definitions for the double-buffered I2S stream
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_I2S_STREAM_H
+#define GD32VF103_I2S_STREAM_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_dma.h"
+#include "gd32vf103_spi.h"
+
+/*
+    One I2S direction streams through a buffer split into two halves by a
+    circular DMA channel that is started once and never stopped. The half and
+    full transfer interrupts hand the half the DMA has just left to the
+    application callback: a transmit stream asks it to fill the half with the
+    next words, a receive stream passes it the words just received. As the DMA
+    never waits for software, a callback that is late does not open a gap in
+    the I2S clock; instead the half it works on is played or overwritten while
+    being handled, and the stream counts an underrun or an overrun.
+
+    The buffer holds 16 bit words as the SPI_DATA register sees them, so a
+    24 or 32 bit frame format takes two words per channel sample.
+
+    DMA request channels: SPI1/I2S1 TX DMA0_CH4 RX DMA0_CH3, SPI2/I2S2 TX
+    DMA1_CH1 RX DMA1_CH0.
+*/
+
+/* constants definitions */
+#define I2S_STREAM_SIZE_MAX             0xFFFEU                     /*!< largest buffer in words, bounded by the DMA counter */
+
+/* I2S stream state */
+#define I2S_STREAM_IDLE                 0U                          /*!< initialized or stopped */
+#define I2S_STREAM_RUNNING              1U                          /*!< the DMA is moving data */
+#define I2S_STREAM_ERROR                2U                          /*!< stopped on a DMA transfer error */
+
+struct i2s_stream_struct;
+
+/* I2S stream callback: a transmit stream fills data with up to len words and
+   returns the number written, a receive stream takes the len words of data */
+typedef uint32_t (*i2s_stream_callback)(struct i2s_stream_struct *stream, uint16_t *data, uint32_t len);
+
+/* I2S stream initialize struct */
+typedef struct
+{
+    uint32_t spi_periph;                                            /*!< SPIx(x=1,2) */
+    uint32_t mode;                                                  /*!< I2S_MODE_xxx, sets the direction */
+    uint32_t standard;                                              /*!< I2S_STD_xxx */
+    uint32_t ckpl;                                                  /*!< I2S_CKPL_xxx */
+    uint32_t audiosample;                                           /*!< I2S_AUDIOSAMPLE_xxx */
+    uint32_t frameformat;                                           /*!< I2S_FRAMEFORMAT_xxx */
+    uint32_t mckout;                                                /*!< I2S_MCKOUT_xxx */
+    uint16_t *buffer;                                               /*!< storage of both halves */
+    uint32_t size;                                                  /*!< number of words in buffer, even */
+    i2s_stream_callback callback;                                   /*!< producer or consumer of the halves */
+    void *user_data;                                                /*!< free for the application */
+}i2s_stream_parameter_struct;
+
+/* I2S stream */
+typedef struct i2s_stream_struct
+{
+    uint32_t spi_periph;                                            /*!< SPI in I2S mode */
+    uint32_t dma_periph;                                            /*!< DMA serving the I2S */
+    dma_channel_enum channelx;                                      /*!< DMA channel of the stream direction */
+    uint32_t transmit;                                              /*!< the stream sends */
+    uint16_t *buffer;                                               /*!< storage of both halves */
+    uint32_t size;                                                  /*!< number of words in buffer */
+    i2s_stream_callback callback;                                   /*!< producer or consumer of the halves */
+    void *user_data;                                                /*!< free for the application */
+    volatile uint32_t state;                                        /*!< I2S_STREAM_IDLE, RUNNING or ERROR */
+    volatile uint32_t halves;                                       /*!< halves handed to the callback */
+    volatile uint32_t underrun;                                     /*!< transmit halves not filled completely or in time */
+    volatile uint32_t overrun;                                      /*!< receive halves not taken in time */
+}i2s_stream_struct;
+
+/* function declarations */
+/* configure the I2S and the DMA channel of a stream */
+ErrStatus i2s_stream_init(i2s_stream_struct *stream, i2s_stream_parameter_struct *init_struct);
+/* start streaming, a transmit stream fills both halves first */
+void i2s_stream_start(i2s_stream_struct *stream);
+/* stop the I2S and its DMA channel */
+void i2s_stream_stop(i2s_stream_struct *stream);
+/* DMA channel interrupt service, hands the free half to the callback */
+void i2s_stream_dma_irq_handler(i2s_stream_struct *stream);
+
+#endif /* GD32VF103_I2S_STREAM_H */
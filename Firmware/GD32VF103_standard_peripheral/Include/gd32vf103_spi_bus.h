@@ -0,0 +1,142 @@
+/*!
+    \file  gd32vf103_spi_bus.h
+    \brief definitions for the SPI bus manager with queued DMA transactions
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_SPI_BUS_H
+#define GD32VF103_SPI_BUS_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_spi.h"
+#include "gd32vf103_gpio.h"
+#include "gd32vf103_dma_job.h"
+
+/*
+    Queue of full-duplex master transactions on one SPI shared by several
+    devices. A device keeps the CTL0 value of its clock mode, prescaler, frame
+    size and bit order and its chip-select pin, so switching the SPI to another
+    device is two register writes and only happens when the device changes.
+    The chip select is driven low before the first frame of a transaction and
+    high after its last frame, unless the transaction asks to keep it low for
+    a following one of the same device.
+
+    Transactions of at least dma_threshold frames run on the DMA channels of
+    the SPI and end in the receive channel interrupt, which starts the next
+    transaction. Shorter ones are moved by polling when the submitter starts
+    them, since setting up the channels costs more than a few frames; the DMA
+    interrupt never polls and hands every transaction it chains, however
+    short, to the DMA as well. The caller configures the clocks and the SCK,
+    MISO and MOSI pins and enables the ECLIC lines of both DMA channels, the
+    transmit channel only interrupts on a transfer error.
+    Transactions are submitted from a single context, the number of queue
+    slots must be a power of two.
+*/
+
+/* constants definitions */
+/* SPI transaction status */
+#define SPI_XFER_IDLE                   0U                          /*!< transaction prepared or finished and not queued */
+#define SPI_XFER_QUEUED                 1U                          /*!< transaction waits in a queue */
+#define SPI_XFER_ACTIVE                 2U                          /*!< transaction is on the bus */
+#define SPI_XFER_DONE                   3U                          /*!< all frames transferred */
+#define SPI_XFER_ERROR                  4U                          /*!< a DMA channel reported a transfer error */
+
+/* SPI transaction flags */
+#define SPI_XFER_CS_KEEP                BIT(0)                      /*!< leave the chip select low for the next transaction of the device */
+
+#define SPI_BUS_DMA_THRESHOLD           16U                         /*!< default number of frames from which a transaction goes through the DMA */
+
+/* device on a shared SPI */
+typedef struct
+{
+    uint32_t ctl0;                                                  /*!< CTL0 value of the device, SPIEN included */
+    uint32_t cs_gpio_periph;                                        /*!< GPIO port of the chip select, 0 if the device has none */
+    uint32_t cs_pin;                                                /*!< GPIO pin of the chip select */
+}spi_device_struct;
+
+/* SPI transaction descriptor */
+typedef struct spi_xfer_struct
+{
+    spi_device_struct *device;                                      /*!< addressed device */
+    const void *tx_buf;                                             /*!< frames sent, NULL sends 0xFF or 0xFFFF */
+    void *rx_buf;                                                   /*!< frames received, NULL drops them */
+    uint32_t len;                                                   /*!< number of frames, uint8_t or uint16_t each after the frame size */
+    uint32_t flags;                                                 /*!< SPI_XFER_CS_KEEP or 0 */
+    void (*callback)(struct spi_xfer_struct *xfer);                 /*!< called when the transaction ends, or NULL */
+    void *user_data;                                                /*!< free for the owner of the transaction */
+    volatile uint32_t status;                                       /*!< SPI_XFER_IDLE, QUEUED, ACTIVE, DONE or ERROR */
+}spi_xfer_struct;
+
+/* SPI transaction queue of one SPI */
+typedef struct
+{
+    uint32_t spi_periph;                                            /*!< SPIx(x=0,1,2) */
+    uint32_t dma_periph;                                            /*!< DMA of the SPI, 0 to poll every transaction */
+    dma_channel_enum dma_rx;                                        /*!< DMA channel of the SPI receive request */
+    dma_channel_enum dma_tx;                                        /*!< DMA channel of the SPI transmit request */
+    uint32_t dma_threshold;                                         /*!< shortest transaction in frames handed to the DMA */
+    spi_xfer_struct **slots;                                        /*!< queue storage */
+    uint32_t size;                                                  /*!< number of slots, power of two */
+    volatile uint32_t head;                                         /*!< transactions submitted, written by the submitter */
+    volatile uint32_t tail;                                         /*!< transactions ended, written by the interrupt */
+    volatile uint32_t busy;                                         /*!< a transaction is on the bus */
+    uint32_t chaining;                                              /*!< the DMA interrupt is starting transactions */
+    uint32_t ctl0;                                                  /*!< CTL0 value currently loaded */
+    spi_device_struct *selected;                                    /*!< device whose chip select is low, or NULL */
+    uint32_t sink;                                                  /*!< DMA target of the frames dropped by a NULL rx_buf */
+    dma_job_struct rx_job;                                          /*!< DMA transfer of the received frames */
+    dma_job_struct tx_job;                                          /*!< DMA transfer of the sent frames */
+}spi_bus_struct;
+
+/* function declarations */
+/* device and transaction functions */
+/* describe a device on a shared SPI and release its chip select */
+void spi_device_init(spi_device_struct *device, spi_parameter_struct *spi_struct, uint32_t cs_gpio_periph, uint32_t cs_pin);
+/* fill a full-duplex transaction */
+void spi_xfer_prepare(spi_xfer_struct *xfer, spi_device_struct *device, const void *tx_buf, void *rx_buf,
+                      uint32_t len, uint32_t flags, void (*callback)(spi_xfer_struct *xfer));
+
+/* queue functions */
+/* initialize the transaction queue of a SPI */
+ErrStatus spi_bus_init(spi_bus_struct *bus, uint32_t spi_periph, spi_xfer_struct **slots, uint32_t size);
+/* let the queue run long transactions on the DMA channels of the SPI */
+void spi_bus_dma_config(spi_bus_struct *bus, uint32_t threshold);
+/* append a transaction to a queue, it starts at once if the bus is idle */
+ErrStatus spi_bus_submit(spi_bus_struct *bus, spi_xfer_struct *xfer);
+/* get the number of transactions queued or running */
+uint32_t spi_bus_pending_get(spi_bus_struct *bus);
+
+/* interrupt functions */
+/* DMA receive channel interrupt service, ends the running transaction and starts the next one */
+void spi_bus_dma_irq_handler(spi_bus_struct *bus);
+
+#endif /* GD32VF103_SPI_BUS_H */
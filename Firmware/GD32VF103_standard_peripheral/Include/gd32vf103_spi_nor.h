@@ -0,0 +1,143 @@
+/*!
+    \file  gd32vf103_spi_nor.h
+    \brief definitions for the SPI NOR flash block driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32VF103_SPI_NOR_H
+#define GD32VF103_SPI_NOR_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_spi_bus.h"
+#include "gd32vf103_timer.h"
+
+/*
+    Block driver of a JEDEC SPI NOR flash (GD25Qxx, W25Qxx and alike) on a SPI
+    transaction queue of gd32vf103_spi_bus. Reads use the fast read command,
+    the commands are polled and the data phase runs on the DMA. Small reads go
+    through a cache of two lines of cache_size bytes: a miss loads the whole
+    aligned line, and a read reaching the end of a line hands the next line to
+    the DMA in the other one and returns, so a sequential reader finds its next
+    line fetched while it was busy with the previous one. Reads of at least one
+    line that miss go straight into the caller's buffer and fetch the line after
+    them the same way.
+
+    Page programs and erases are asynchronous. spi_nor_program_start() and
+    spi_nor_erase_start() queue the first step and the status read behind it
+    and return. With a one-shot timer set by spi_nor_timer_config(), the end of
+    a status read queues the next step, or starts the timer while the flash is
+    busy, and the timer interrupt queues the next status read; the reads are
+    paced by the timer and the operation moves on in the DMA and timer
+    interrupts, which then submit to the SPI queue: both run at the same ECLIC
+    level and nothing else is submitted to the queue until the operation has
+    ended. Without a timer, spi_nor_service() checks the status read, queues
+    the next step or another status read and returns at once; it has to be
+    called from the context submitting to the queue, typically the main loop,
+    and spi_nor_wait() does it until the end. The page data goes through the
+    DMA from the caller's buffer, which must stay untouched until the operation
+    has ended. A step is only queued when the SPI queue has room for all of its
+    transactions, otherwise the operation ends in SPI_NOR_ERROR with nothing
+    left on the queue.
+*/
+
+/* constants definitions */
+#define SPI_NOR_PAGE_SIZE               256U                        /*!< bytes of a page program */
+#define SPI_NOR_SECTOR_SIZE             0x00001000U                 /*!< bytes of a sector erase */
+#define SPI_NOR_BLOCK_SIZE              0x00010000U                 /*!< bytes of a block erase */
+#define SPI_NOR_READ_CHUNK              0x00008000U                 /*!< largest data phase of one read, within the DMA counter */
+#define SPI_NOR_CACHE_LINES             2U                          /*!< lines of the cache, the one read last and the one fetched ahead */
+#define SPI_NOR_CACHE_INVALID           0xFFFFFFFFU                 /*!< cache_addr of an empty line */
+#define SPI_NOR_LINE_NONE               0xFFFFFFFFU                 /*!< no cache line */
+
+/* SPI NOR flash commands */
+#define SPI_NOR_CMD_WRITE_ENABLE        0x06U                       /*!< set the write enable latch */
+#define SPI_NOR_CMD_READ_STATUS         0x05U                       /*!< read status register 1 */
+#define SPI_NOR_CMD_READ_ID             0x9FU                       /*!< read the JEDEC ID */
+#define SPI_NOR_CMD_FAST_READ           0x0BU                       /*!< read with one dummy byte */
+#define SPI_NOR_CMD_PAGE_PROGRAM        0x02U                       /*!< program up to one page */
+#define SPI_NOR_CMD_SECTOR_ERASE        0x20U                       /*!< erase a 4 KB sector */
+#define SPI_NOR_CMD_BLOCK_ERASE         0xD8U                       /*!< erase a 64 KB block */
+#define SPI_NOR_STATUS_WIP              BIT(0)                      /*!< write in progress */
+
+/* state of the asynchronous operation */
+#define SPI_NOR_READY                   0U                          /*!< no operation running, the last one succeeded */
+#define SPI_NOR_BUSY                    1U                          /*!< a program or erase is running */
+#define SPI_NOR_ERROR                   2U                          /*!< the last operation was abandoned on a transfer error or a full queue */
+
+/* SPI NOR flash */
+typedef struct
+{
+    spi_bus_struct *bus;                                            /*!< SPI transaction queue of the flash */
+    spi_device_struct *device;                                      /*!< SPI device of the flash */
+    uint32_t jedec_id;                                              /*!< manufacturer, memory type and capacity code */
+    uint32_t capacity;                                              /*!< size of the flash in bytes */
+    uint8_t *cache;                                                 /*!< SPI_NOR_CACHE_LINES lines of cache_size bytes, NULL for no cache */
+    uint32_t cache_size;                                            /*!< size of a line, power of two */
+    uint32_t cache_addr[SPI_NOR_CACHE_LINES];                       /*!< flash address of each line, SPI_NOR_CACHE_INVALID if empty */
+    uint32_t cache_last;                                            /*!< line read last */
+    uint32_t prefetch;                                              /*!< line being filled by the DMA, SPI_NOR_LINE_NONE if none */
+    uint32_t timer_periph;                                          /*!< one-shot timer pacing the status reads, or 0 */
+    uint32_t state;                                                 /*!< SPI_NOR_READY, BUSY or ERROR */
+    volatile uint32_t polled;                                       /*!< a status read ended in its submitter, which follows it up */
+    uint32_t erase;                                                 /*!< the running operation erases */
+    const uint8_t *src;                                             /*!< program: data of the next page */
+    uint32_t addr;                                                  /*!< flash address of the next step */
+    uint32_t remain;                                                /*!< bytes left after the running step */
+    uint8_t wren_cmd;                                               /*!< write enable command */
+    uint8_t cmd[5];                                                 /*!< command and address of the running transaction */
+    uint8_t status_cmd[2];                                          /*!< status read command */
+    uint8_t status[2];                                              /*!< status read answer */
+    spi_xfer_struct wren_xfer;                                      /*!< write enable transaction */
+    spi_xfer_struct cmd_xfer;                                       /*!< command and address transaction */
+    spi_xfer_struct data_xfer;                                      /*!< data phase transaction */
+    spi_xfer_struct status_xfer;                                    /*!< status read transaction */
+}spi_nor_struct;
+
+/* function declarations */
+/* identify the flash and attach a cache of two lines */
+ErrStatus spi_nor_init(spi_nor_struct *nor, spi_bus_struct *bus, spi_device_struct *device, uint8_t *cache, uint32_t cache_size);
+/* let a one-shot timer pace the status reads of program and erase */
+void spi_nor_timer_config(spi_nor_struct *nor, uint32_t timer_periph, uint32_t ticks);
+/* read bytes, waits for a running program or erase first */
+ErrStatus spi_nor_read(spi_nor_struct *nor, uint32_t addr, uint8_t *buf, uint32_t len);
+/* start programming erased bytes, page by page */
+ErrStatus spi_nor_program_start(spi_nor_struct *nor, uint32_t addr, const uint8_t *buf, uint32_t len);
+/* start erasing whole sectors, 64 KB blocks where aligned */
+ErrStatus spi_nor_erase_start(spi_nor_struct *nor, uint32_t addr, uint32_t len);
+/* move a running program or erase on without waiting */
+uint32_t spi_nor_service(spi_nor_struct *nor);
+/* call spi_nor_service until the running operation has ended */
+uint32_t spi_nor_wait(spi_nor_struct *nor);
+/* timer update interrupt service, queues the next status read */
+void spi_nor_timer_irq_handler(spi_nor_struct *nor);
+
+#endif /* GD32VF103_SPI_NOR_H */
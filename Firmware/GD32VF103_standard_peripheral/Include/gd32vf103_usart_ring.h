@@ -0,0 +1,126 @@
+/*!
+    \file  gd32vf103_usart_ring.h
+    \brief definitions for the USART ring buffer driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef GD32VF103_USART_RING_H
+#define GD32VF103_USART_RING_H
+
+#include "gd32vf103.h"
+#include "gd32vf103_dma.h"
+#include "gd32vf103_usart.h"
+
+/*
+    Both directions run on DMA. Reception uses a circular DMA channel writing
+    straight into the RX ring, the USART IDLE interrupt and the half/full
+    transfer interrupts publish the DMA position. Transmission sends every
+    committed, contiguous part of the TX ring as one DMA transfer and chains the
+    next one from the full transfer finish interrupt. Each ring has exactly one
+    producer and one consumer, so neither side takes a lock. Ring sizes must be
+    powers of two, at most 32768 bytes.
+
+    DMA request channels: USART0 TX DMA0_CH3 RX DMA0_CH4, USART1 TX DMA0_CH6
+    RX DMA0_CH5, USART2 TX DMA0_CH1 RX DMA0_CH2, UART3 TX DMA1_CH4 RX DMA1_CH2.
+*/
+
+/* constants definitions */
+#define USART_RING_SIZE_MAX             32768U                      /*!< largest ring, bounded by the DMA counter */
+
+/* USART ring initialize struct */
+typedef struct
+{
+    uint32_t usart_periph;                                          /*!< USARTx(x=0,1,2)/UARTx(x=3) */
+    uint32_t dma_periph;                                            /*!< DMA serving the USART */
+    dma_channel_enum tx_channel;                                    /*!< DMA channel of the USART TX request */
+    dma_channel_enum rx_channel;                                    /*!< DMA channel of the USART RX request */
+    uint8_t *tx_buffer;                                             /*!< TX ring storage */
+    uint32_t tx_size;                                               /*!< TX ring size, power of two */
+    uint8_t *rx_buffer;                                             /*!< RX ring storage */
+    uint32_t rx_size;                                               /*!< RX ring size, power of two */
+}usart_ring_parameter_struct;
+
+/* USART ring driver state */
+typedef struct
+{
+    uint32_t usart_periph;                                          /*!< USART served by the rings */
+    uint32_t dma_periph;                                            /*!< DMA serving the USART */
+    dma_channel_enum tx_channel;                                    /*!< DMA channel of the USART TX request */
+    dma_channel_enum rx_channel;                                    /*!< DMA channel of the USART RX request */
+    uint8_t *tx_buffer;                                             /*!< TX ring storage */
+    uint32_t tx_size;                                               /*!< TX ring size */
+    volatile uint32_t tx_head;                                      /*!< bytes committed, written by the producer */
+    volatile uint32_t tx_tail;                                      /*!< bytes sent, written by the DMA interrupt */
+    volatile uint32_t tx_inflight;                                  /*!< bytes of the running DMA transfer */
+    volatile uint32_t tx_busy;                                      /*!< a TX DMA transfer is running */
+    uint8_t *rx_buffer;                                             /*!< RX ring storage */
+    uint32_t rx_size;                                               /*!< RX ring size */
+    volatile uint32_t rx_head;                                      /*!< bytes received, written by the interrupts */
+    volatile uint32_t rx_tail;                                      /*!< bytes consumed, written by the consumer */
+    volatile uint32_t rx_overrun;                                   /*!< times the DMA overtook the consumer */
+}usart_ring_struct;
+
+/* function declarations */
+/* initialization functions */
+/* initialize the USART rings and start reception */
+ErrStatus usart_ring_init(usart_ring_struct *ring, usart_ring_parameter_struct *init_struct);
+/* stop both DMA channels of the USART rings */
+void usart_ring_deinit(usart_ring_struct *ring);
+
+/* transmit functions */
+/* get the contiguous free space of the TX ring */
+uint32_t usart_ring_tx_span_get(usart_ring_struct *ring, uint8_t **span);
+/* commit bytes written into the TX span and start sending them */
+void usart_ring_tx_span_commit(usart_ring_struct *ring, uint32_t len);
+/* copy bytes into the TX ring */
+uint32_t usart_ring_write(usart_ring_struct *ring, const uint8_t *data, uint32_t len);
+/* get the number of bytes not yet handed to the DMA */
+uint32_t usart_ring_tx_pending_get(usart_ring_struct *ring);
+
+/* receive functions */
+/* get the contiguous received bytes of the RX ring */
+uint32_t usart_ring_rx_span_get(usart_ring_struct *ring, uint8_t **span);
+/* release bytes consumed from the RX span */
+void usart_ring_rx_span_release(usart_ring_struct *ring, uint32_t len);
+/* copy bytes out of the RX ring */
+uint32_t usart_ring_read(usart_ring_struct *ring, uint8_t *data, uint32_t len);
+/* publish the RX DMA position to the consumer */
+void usart_ring_rx_update(usart_ring_struct *ring);
+
+/* interrupt functions */
+/* USART interrupt service, handles the IDLE line event */
+void usart_ring_usart_irq_handler(usart_ring_struct *ring);
+/* TX DMA channel interrupt service, chains the next transfer */
+void usart_ring_dma_tx_irq_handler(usart_ring_struct *ring);
+/* RX DMA channel interrupt service, handles the half and full transfer events */
+void usart_ring_dma_rx_irq_handler(usart_ring_struct *ring);
+
+#endif /* GD32VF103_USART_RING_H */
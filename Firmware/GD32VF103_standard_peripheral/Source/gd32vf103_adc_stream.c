@@ -0,0 +1,334 @@
+/*!
+    \file  gd32vf103_adc_stream.c
+    \brief continuous ADC scan acquisition driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_adc_stream.h"
+
+/* configure the regular scan group of one ADC */
+static void adc_stream_group_config(uint32_t adc_periph, const uint8_t *channels, uint32_t channel_num,
+                                    uint32_t sample_time, uint32_t trigger);
+/* get the number of samples the DMA has written into the buffer */
+static uint32_t adc_stream_position(const adc_stream_struct *stream);
+/* hand one frame of the buffer to the callback */
+static void adc_stream_frame(adc_stream_struct *stream, uint32_t offset);
+
+/*!
+    \brief      configure the regular scan group of an ADC, or of both ADCs in the
+                sync modes, calibrate them and set up the DMA channel; the
+                stream starts with adc_stream_start
+    \param[in]  stream: ADC stream
+    \param[in]  init_struct: the data needed to initialize the stream
+                  adc_periph: ADC0
+                  mode: ADC_MODE_FREE, ADC_DAUL_REGULAL_PARALLEL, ADC_DAUL_REGULAL_FOLLOWUP_FAST,
+                        ADC_DAUL_REGULAL_FOLLOWUP_SLOW
+                  channels, channel_num: ADC_CHANNEL_x in scan order, 1 to ADC_STREAM_CHANNELS_MAX of them,
+                                         only 1 in the follow-up modes
+                  channels1: ADC_CHANNEL_x of ADC1 in scan order in regular parallel mode, unused otherwise
+                  sample_time: ADC_SAMPLETIME_xxx of every channel
+                  trigger: ADC0_1_EXTTRIG_REGULAR_xxx, ADC0_1_EXTTRIG_REGULAR_NONE for back to back scans,
+                           except in follow-up slow mode
+                  buffer, scans: storage of two frames of scans scans, at most ADC_STREAM_SIZE_MAX DMA transfers
+                  callback: consumer of the frames, called from the DMA interrupt
+                  user_data: free for the application
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus adc_stream_init(adc_stream_struct *stream, adc_stream_parameter_struct *init_struct)
+{
+    dma_parameter_struct dma_init_struct;
+    uint32_t mode = init_struct->mode;
+    uint32_t number = 2U * init_struct->scans * init_struct->channel_num;
+    uint32_t followup = ((ADC_DAUL_REGULAL_FOLLOWUP_FAST == mode) || (ADC_DAUL_REGULAL_FOLLOWUP_SLOW == mode)) ? 1U : 0U;
+
+    if((ADC0 != init_struct->adc_periph) || (NULL == init_struct->callback)
+       || (0U == init_struct->channel_num) || (ADC_STREAM_CHANNELS_MAX < init_struct->channel_num)
+       || (0U == init_struct->scans) || (ADC_STREAM_SIZE_MAX < number)){
+        return ERROR;
+    }
+    if((ADC_MODE_FREE != mode) && (ADC_DAUL_REGULAL_PARALLEL != mode) && (0U == followup)){
+        return ERROR;
+    }
+    if((ADC_DAUL_REGULAL_PARALLEL == mode) && (NULL == init_struct->channels1)){
+        return ERROR;
+    }
+    /* the follow-up modes share one channel, and slow mode cannot run continuously */
+    if((0U != followup) && (1U != init_struct->channel_num)){
+        return ERROR;
+    }
+    if((ADC_DAUL_REGULAL_FOLLOWUP_SLOW == mode) && (ADC0_1_EXTTRIG_REGULAR_NONE == init_struct->trigger)){
+        return ERROR;
+    }
+
+    stream->adc_periph = init_struct->adc_periph;
+    stream->mode = mode;
+    stream->channel_num = init_struct->channel_num;
+    stream->scan_size = (ADC_MODE_FREE == mode) ? stream->channel_num : (2U * stream->channel_num);
+    stream->trigger = init_struct->trigger;
+    stream->buffer = init_struct->buffer;
+    stream->scans = init_struct->scans;
+    stream->size = 2U * stream->scans * stream->scan_size;
+    stream->callback = init_struct->callback;
+    stream->user_data = init_struct->user_data;
+    stream->state = ADC_STREAM_IDLE;
+    stream->frames = 0U;
+    stream->overrun = 0U;
+
+    /* one scan of the group per trigger, the results go to the DMA */
+    adc_disable(stream->adc_periph);
+    adc_mode_config(mode);
+    adc_stream_group_config(stream->adc_periph, init_struct->channels, stream->channel_num,
+                            init_struct->sample_time, stream->trigger);
+    adc_dma_mode_enable(stream->adc_periph);
+    adc_enable(stream->adc_periph);
+    adc_calibration_enable(stream->adc_periph);
+
+    /* ADC1 follows the trigger of ADC0, its own trigger is the software one */
+    if(ADC_MODE_FREE != mode){
+        adc_disable(ADC1);
+        adc_stream_group_config(ADC1, (0U != followup) ? init_struct->channels : init_struct->channels1,
+                                stream->channel_num, init_struct->sample_time, ADC0_1_EXTTRIG_REGULAR_NONE);
+        adc_enable(ADC1);
+        adc_calibration_enable(ADC1);
+    }
+
+    /* one circular transfer over both frames, reloaded by the DMA itself */
+    dma_deinit(DMA0, DMA_CH0);
+    dma_init_struct.direction = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr = (uint32_t)stream->buffer;
+    dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = (ADC_MODE_FREE == mode) ? DMA_MEMORY_WIDTH_16BIT : DMA_MEMORY_WIDTH_32BIT;
+    dma_init_struct.number = number;
+    dma_init_struct.periph_addr = (uint32_t)&ADC_RDATA(stream->adc_periph);
+    dma_init_struct.periph_inc = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = (ADC_MODE_FREE == mode) ? DMA_PERIPHERAL_WIDTH_16BIT : DMA_PERIPHERAL_WIDTH_32BIT;
+    dma_init_struct.priority = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(DMA0, DMA_CH0, &dma_init_struct);
+    dma_circulation_enable(DMA0, DMA_CH0);
+    dma_memory_to_memory_disable(DMA0, DMA_CH0);
+    dma_interrupt_enable(DMA0, DMA_CH0, DMA_INT_HTF | DMA_INT_FTF | DMA_INT_ERR);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      start converting on each trigger, the first scan lands at the
+                start of the first frame
+    \param[in]  stream: ADC stream
+    \param[out] none
+    \retval     none
+*/
+void adc_stream_start(adc_stream_struct *stream)
+{
+    dma_channel_disable(DMA0, DMA_CH0);
+    dma_interrupt_flag_clear(DMA0, DMA_CH0, DMA_INT_FLAG_G);
+    dma_transfer_number_config(DMA0, DMA_CH0, (ADC_MODE_FREE == stream->mode) ? stream->size : (stream->size >> 1U));
+    stream->state = ADC_STREAM_RUNNING;
+    dma_channel_enable(DMA0, DMA_CH0);
+
+    /* adc_stream_stop powered the ADCs down to abort a scan half way, ADC1 is armed first */
+    if(ADC_MODE_FREE != stream->mode){
+        adc_enable(ADC1);
+        adc_external_trigger_config(ADC1, ADC_REGULAR_CHANNEL, ENABLE);
+        if(ADC0_1_EXTTRIG_REGULAR_NONE == stream->trigger){
+            adc_special_function_config(ADC1, ADC_CONTINUOUS_MODE, ENABLE);
+        }
+    }
+    adc_enable(stream->adc_periph);
+    adc_external_trigger_config(stream->adc_periph, ADC_REGULAR_CHANNEL, ENABLE);
+    if(ADC0_1_EXTTRIG_REGULAR_NONE == stream->trigger){
+        adc_special_function_config(stream->adc_periph, ADC_CONTINUOUS_MODE, ENABLE);
+        adc_software_trigger_enable(stream->adc_periph, ADC_REGULAR_CHANNEL);
+    }
+}
+
+/*!
+    \brief      stop the conversions and the DMA channel, a scan under way is
+                aborted so that the next start lines up with the first channel
+    \param[in]  stream: ADC stream
+    \param[out] none
+    \retval     none
+*/
+void adc_stream_stop(adc_stream_struct *stream)
+{
+    adc_external_trigger_config(stream->adc_periph, ADC_REGULAR_CHANNEL, DISABLE);
+    adc_special_function_config(stream->adc_periph, ADC_CONTINUOUS_MODE, DISABLE);
+    adc_disable(stream->adc_periph);
+    if(ADC_MODE_FREE != stream->mode){
+        adc_external_trigger_config(ADC1, ADC_REGULAR_CHANNEL, DISABLE);
+        adc_special_function_config(ADC1, ADC_CONTINUOUS_MODE, DISABLE);
+        adc_disable(ADC1);
+    }
+    dma_channel_disable(DMA0, DMA_CH0);
+    dma_interrupt_flag_clear(DMA0, DMA_CH0, DMA_INT_FLAG_G);
+    if(ADC_STREAM_RUNNING == stream->state){
+        stream->state = ADC_STREAM_IDLE;
+    }
+}
+
+/*!
+    \brief      copy the samples of one channel out of a frame
+    \param[in]  stream: ADC stream
+    \param[in]  frame: frame handed to the callback
+    \param[in]  index: position of the channel in the channels array, in the sync
+                modes 2r for rank r of ADC0 and 2r + 1 for rank r of ADC1
+    \param[out] samples: scans samples of the channel, oldest first
+    \retval     none
+*/
+void adc_stream_channel_get(const adc_stream_struct *stream, const uint16_t *frame, uint32_t index, uint16_t *samples)
+{
+    const uint16_t *src = &frame[index];
+    uint32_t i;
+
+    for(i = 0U; i < stream->scans; i++){
+        samples[i] = *src;
+        src += stream->scan_size;
+    }
+}
+
+/*!
+    \brief      copy the samples of a follow-up mode frame in conversion order;
+                ADC1 converts first, so each ADC1 sample goes before the ADC0
+                sample sharing its DMA word
+    \param[in]  stream: ADC stream in a follow-up mode
+    \param[in]  frame: frame handed to the callback
+    \param[out] samples: 2 * scans samples, oldest first
+    \retval     none
+*/
+void adc_stream_interleaved_get(const adc_stream_struct *stream, const uint16_t *frame, uint16_t *samples)
+{
+    uint32_t i;
+
+    for(i = 0U; i < stream->scans; i++){
+        samples[2U * i] = frame[(2U * i) + 1U];
+        samples[(2U * i) + 1U] = frame[2U * i];
+    }
+}
+
+/*!
+    \brief      DMA channel interrupt service, hands the frame the DMA is not in
+                to the callback; the frame is picked by the DMA position rather
+                than by the flags, so a late interrupt still passes the right one
+    \param[in]  stream: ADC stream
+    \param[out] none
+    \retval     none
+*/
+void adc_stream_dma_irq_handler(adc_stream_struct *stream)
+{
+    uint32_t half = stream->size >> 1U;
+    uint32_t position, offset;
+    FlagStatus htf, ftf;
+
+    if(RESET != dma_interrupt_flag_get(DMA0, DMA_CH0, DMA_INT_FLAG_ERR)){
+        adc_stream_stop(stream);
+        stream->state = ADC_STREAM_ERROR;
+        return;
+    }
+    htf = dma_interrupt_flag_get(DMA0, DMA_CH0, DMA_INT_FLAG_HTF);
+    ftf = dma_interrupt_flag_get(DMA0, DMA_CH0, DMA_INT_FLAG_FTF);
+    if((RESET == htf) && (RESET == ftf)){
+        return;
+    }
+    dma_interrupt_flag_clear(DMA0, DMA_CH0, DMA_INT_FLAG_G);
+
+    /* both events pending: a whole frame went by without being handled */
+    if((RESET != htf) && (RESET != ftf)){
+        stream->overrun++;
+    }
+
+    position = adc_stream_position(stream);
+    offset = (position < half) ? half : 0U;
+    adc_stream_frame(stream, offset);
+
+    /* the DMA must not have come back into the frame while the callback read it */
+    position = adc_stream_position(stream);
+    if((position >= offset) && (position < (offset + half))){
+        stream->overrun++;
+    }
+}
+
+/*!
+    \brief      configure the regular scan group of one ADC, triggers disabled
+    \param[in]  adc_periph: ADCx(x=0,1)
+    \param[in]  channels: ADC_CHANNEL_x in scan order
+    \param[in]  channel_num: number of channels
+    \param[in]  sample_time: ADC_SAMPLETIME_xxx of every channel
+    \param[in]  trigger: ADC0_1_EXTTRIG_REGULAR_xxx
+    \param[out] none
+    \retval     none
+*/
+static void adc_stream_group_config(uint32_t adc_periph, const uint8_t *channels, uint32_t channel_num,
+                                    uint32_t sample_time, uint32_t trigger)
+{
+    uint32_t rank;
+
+    adc_special_function_config(adc_periph, ADC_SCAN_MODE, ENABLE);
+    adc_special_function_config(adc_periph, ADC_CONTINUOUS_MODE, DISABLE);
+    adc_data_alignment_config(adc_periph, ADC_DATAALIGN_RIGHT);
+    adc_channel_length_config(adc_periph, ADC_REGULAR_CHANNEL, channel_num);
+    for(rank = 0U; rank < channel_num; rank++){
+        adc_regular_channel_config(adc_periph, (uint8_t)rank, channels[rank], sample_time);
+    }
+    adc_external_trigger_source_config(adc_periph, ADC_REGULAR_CHANNEL, trigger);
+    adc_external_trigger_config(adc_periph, ADC_REGULAR_CHANNEL, DISABLE);
+}
+
+/*!
+    \brief      get the number of samples the DMA has written into the buffer,
+                a DMA word holds two of them in the sync modes
+    \param[in]  stream: ADC stream
+    \param[out] none
+    \retval     position in samples
+*/
+static uint32_t adc_stream_position(const adc_stream_struct *stream)
+{
+    uint32_t remaining = dma_transfer_number_get(DMA0, DMA_CH0);
+
+    if(ADC_MODE_FREE != stream->mode){
+        remaining <<= 1U;
+    }
+    return stream->size - remaining;
+}
+
+/*!
+    \brief      hand one frame of the buffer to the callback
+    \param[in]  stream: ADC stream
+    \param[in]  offset: first sample of the frame
+    \param[out] none
+    \retval     none
+*/
+static void adc_stream_frame(adc_stream_struct *stream, uint32_t offset)
+{
+    stream->callback(stream, &stream->buffer[offset], stream->scans);
+    stream->frames++;
+}
@@ -0,0 +1,374 @@
+/*!
+    \file  gd32vf103_bench.c
+    \brief mcycle/minstret benchmark regions
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_bench.h"
+#include "gd32vf103_usart.h"
+#include "n200_func.h"
+
+#define BENCH_CALIBRATION_RUNS          8U                          /*!< empty samples taken by bench_init() */
+#define BENCH_VALUE_WIDTH               10U                         /*!< width of the number columns of a report */
+
+/* cycles and instructions of an empty start/stop pair */
+static uint32_t bench_overhead_cycle = 0U;
+static uint32_t bench_overhead_instret = 0U;
+/* number of regions with a running sample and of holds on the counters,
+   changed with atomic operations as holds are taken from interrupts too */
+static uint32_t bench_running = 0U;
+
+/* write bytes to a sink */
+static void bench_sink_write(bench_sink_struct *sink, const char *text, uint32_t len);
+/* write a string padded with spaces to a width */
+static void bench_text_write(bench_sink_struct *sink, const char *text, uint32_t width);
+/* write a decimal number right aligned to a width */
+static void bench_value_write(bench_sink_struct *sink, uint32_t value, uint32_t width);
+
+/*!
+    \brief      measure the cost of an empty region
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_init(void)
+{
+    bench_region_struct empty;
+    uint32_t i;
+
+    bench_overhead_cycle = 0U;
+    bench_overhead_instret = 0U;
+    bench_region_init(&empty, "");
+    for(i = 0U; i < BENCH_CALIBRATION_RUNS; i++){
+        bench_region_start(&empty);
+        bench_region_stop(&empty);
+    }
+    bench_overhead_cycle = empty.min;
+    bench_overhead_instret = (uint32_t)(empty.instret / BENCH_CALIBRATION_RUNS);
+}
+
+/*!
+    \brief      reset a region and give it a name
+    \param[in]  region: timing region
+    \param[in]  name: name printed in the reports, kept by reference
+    \param[out] none
+    \retval     none
+*/
+void bench_region_init(bench_region_struct *region, const char *name)
+{
+    uint32_t i;
+
+    region->name = name;
+    region->count = 0U;
+    region->min = 0xFFFFFFFFU;
+    region->max = 0U;
+    region->cycles = 0U;
+    region->instret = 0U;
+    region->start_cycle = 0U;
+    region->start_instret = 0U;
+    for(i = 0U; i < BENCH_SAMPLE_DEPTH; i++){
+        region->sample[i] = 0U;
+    }
+}
+
+/*!
+    \brief      start a sample of a region, the counters are turned on by the first running region
+    \param[in]  region: timing region
+    \param[out] none
+    \retval     none
+*/
+void bench_region_start(bench_region_struct *region)
+{
+    bench_counters_hold();
+    region->start_instret = get_instret_value();
+    region->start_cycle = get_cycle_value();
+}
+
+/*!
+    \brief      keep the counters running outside of the regions, like a region
+                that never stops
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_counters_hold(void)
+{
+    if(0U == __atomic_fetch_add(&bench_running, 1U, __ATOMIC_ACQ_REL)){
+        enable_mcycle_minstret();
+    }
+}
+
+/*!
+    \brief      give back a hold taken with bench_counters_hold(), a release
+                without a hold is ignored
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void bench_counters_release(void)
+{
+    uint32_t running = __atomic_load_n(&bench_running, __ATOMIC_ACQUIRE);
+
+    do{
+        if(0U == running){
+            return;
+        }
+    }while(!__atomic_compare_exchange_n(&bench_running, &running, running - 1U,
+                                        0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    if(1U == running){
+        disable_mcycle_minstret();
+    }
+}
+
+/*!
+    \brief      end the running sample of a region, the counters are turned off with the last running region
+    \param[in]  region: timing region
+    \param[out] none
+    \retval     none
+*/
+void bench_region_stop(bench_region_struct *region)
+{
+    uint64_t cycle = get_cycle_value();
+    uint64_t instret = get_instret_value();
+    uint32_t sample;
+
+    bench_counters_release();
+
+    cycle -= region->start_cycle;
+    instret -= region->start_instret;
+    /* take off the cost of reading the counters */
+    sample = (cycle > bench_overhead_cycle) ? (uint32_t)(cycle - bench_overhead_cycle) : 0U;
+    instret = (instret > bench_overhead_instret) ? (instret - bench_overhead_instret) : 0U;
+
+    region->sample[region->count & (BENCH_SAMPLE_DEPTH - 1U)] = sample;
+    region->count++;
+    region->cycles += sample;
+    region->instret += instret;
+    if(sample < region->min){
+        region->min = sample;
+    }
+    if(sample > region->max){
+        region->max = sample;
+    }
+}
+
+/*!
+    \brief      get the mean sample of a region in cycles
+    \param[in]  region: timing region
+    \param[out] none
+    \retval     mean of all samples, 0 when the region has none
+*/
+uint32_t bench_region_mean(const bench_region_struct *region)
+{
+    if(0U == region->count){
+        return 0U;
+    }
+    return (uint32_t)(region->cycles / region->count);
+}
+
+/*!
+    \brief      get a percentile of the kept samples of a region in cycles
+    \param[in]  region: timing region
+    \param[in]  percent: percentile, 0 to 100, computed by nearest rank over
+                the last BENCH_SAMPLE_DEPTH samples
+    \param[out] none
+    \retval     percentile of the kept samples, 0 when the region has none
+*/
+uint32_t bench_region_percentile(const bench_region_struct *region, uint32_t percent)
+{
+    uint32_t sorted[BENCH_SAMPLE_DEPTH];
+    uint32_t n = (region->count < BENCH_SAMPLE_DEPTH) ? region->count : BENCH_SAMPLE_DEPTH;
+    uint32_t rank;
+    uint32_t i, j;
+
+    if(0U == n){
+        return 0U;
+    }
+    if(percent > 100U){
+        percent = 100U;
+    }
+
+    /* insertion sort, the sample buffer is short */
+    for(i = 0U; i < n; i++){
+        uint32_t value = region->sample[i];
+
+        for(j = i; (j > 0U) && (sorted[j - 1U] > value); j--){
+            sorted[j] = sorted[j - 1U];
+        }
+        sorted[j] = value;
+    }
+
+    rank = ((percent * n) + 99U) / 100U;
+    if(0U == rank){
+        rank = 1U;
+    }
+    return sorted[rank - 1U];
+}
+
+/*!
+    \brief      send the reports to a USART, the USART must be configured and enabled
+    \param[in]  sink: report sink
+    \param[in]  usart_periph: USARTx(x=0,1,2)/UARTx(x=3,4)
+    \param[out] none
+    \retval     none
+*/
+void bench_sink_usart_init(bench_sink_struct *sink, uint32_t usart_periph)
+{
+    sink->usart_periph = usart_periph;
+    sink->buffer = NULL;
+    sink->size = 0U;
+    sink->len = 0U;
+}
+
+/*!
+    \brief      store the reports in a RAM buffer, text not fitting in the buffer is dropped
+    \param[in]  sink: report sink
+    \param[in]  buffer: RAM buffer, always kept zero terminated
+    \param[in]  size: size of buffer in bytes
+    \param[out] none
+    \retval     none
+*/
+void bench_sink_buffer_init(bench_sink_struct *sink, char *buffer, uint32_t size)
+{
+    sink->usart_periph = 0U;
+    sink->buffer = buffer;
+    sink->size = size;
+    sink->len = 0U;
+    if(size > 0U){
+        buffer[0] = '\0';
+    }
+}
+
+/*!
+    \brief      write a table of regions to a sink, one line per region with
+                the sample count, min, mean, p50, p90, p99 and max in cycles and
+                the mean number of retired instructions
+    \param[in]  sink: report sink
+    \param[in]  region: array of timing regions
+    \param[in]  count: number of regions
+    \param[out] none
+    \retval     none
+*/
+void bench_report(bench_sink_struct *sink, const bench_region_struct *region, uint32_t count)
+{
+    uint32_t i;
+
+    bench_text_write(sink, "region", BENCH_NAME_WIDTH);
+    bench_text_write(sink, "     count       min      mean       p50       p90       p99       max   instret\r\n", 0U);
+
+    for(i = 0U; i < count; i++){
+        const bench_region_struct *r = &region[i];
+
+        bench_text_write(sink, r->name, BENCH_NAME_WIDTH);
+        bench_value_write(sink, r->count, BENCH_VALUE_WIDTH);
+        bench_value_write(sink, (0U == r->count) ? 0U : r->min, BENCH_VALUE_WIDTH);
+        bench_value_write(sink, bench_region_mean(r), BENCH_VALUE_WIDTH);
+        bench_value_write(sink, bench_region_percentile(r, 50U), BENCH_VALUE_WIDTH);
+        bench_value_write(sink, bench_region_percentile(r, 90U), BENCH_VALUE_WIDTH);
+        bench_value_write(sink, bench_region_percentile(r, 99U), BENCH_VALUE_WIDTH);
+        bench_value_write(sink, r->max, BENCH_VALUE_WIDTH);
+        bench_value_write(sink, (0U == r->count) ? 0U : (uint32_t)(r->instret / r->count), BENCH_VALUE_WIDTH);
+        bench_sink_write(sink, "\r\n", 2U);
+    }
+}
+
+/*!
+    \brief      write bytes to a sink
+    \param[in]  sink: report sink
+    \param[in]  text: bytes to write
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     none
+*/
+static void bench_sink_write(bench_sink_struct *sink, const char *text, uint32_t len)
+{
+    uint32_t i;
+
+    if(0U != sink->usart_periph){
+        for(i = 0U; i < len; i++){
+            while(RESET == usart_flag_get(sink->usart_periph, USART_FLAG_TBE)){
+            }
+            usart_data_transmit(sink->usart_periph, (uint8_t)text[i]);
+        }
+    }else if(sink->size > 0U){
+        for(i = 0U; (i < len) && (sink->len < (sink->size - 1U)); i++){
+            sink->buffer[sink->len++] = text[i];
+        }
+        sink->buffer[sink->len] = '\0';
+    }
+}
+
+/*!
+    \brief      write a string padded with spaces to a width
+    \param[in]  sink: report sink
+    \param[in]  text: zero terminated string
+    \param[in]  width: minimum number of characters written
+    \param[out] none
+    \retval     none
+*/
+static void bench_text_write(bench_sink_struct *sink, const char *text, uint32_t width)
+{
+    uint32_t len = 0U;
+
+    while('\0' != text[len]){
+        len++;
+    }
+    bench_sink_write(sink, text, len);
+    while(len++ < width){
+        bench_sink_write(sink, " ", 1U);
+    }
+}
+
+/*!
+    \brief      write a decimal number right aligned to a width
+    \param[in]  sink: report sink
+    \param[in]  value: number to write
+    \param[in]  width: minimum number of characters written
+    \param[out] none
+    \retval     none
+*/
+static void bench_value_write(bench_sink_struct *sink, uint32_t value, uint32_t width)
+{
+    char digit[BENCH_VALUE_WIDTH];
+    uint32_t n = BENCH_VALUE_WIDTH;
+
+    do{
+        digit[--n] = (char)('0' + (value % 10U));
+        value /= 10U;
+    }while(0U != value);
+
+    while((BENCH_VALUE_WIDTH - n) < width){
+        bench_sink_write(sink, " ", 1U);
+        width--;
+    }
+    bench_sink_write(sink, &digit[n], BENCH_VALUE_WIDTH - n);
+}
@@ -0,0 +1,850 @@
+/*!
+    \file  gd32vf103_can_filter.c
+    \brief CAN filter bank compiler
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_can_filter.h"
+#include <string.h>
+
+/* IDE and RTR bits of the filter words */
+#define CAN_FILTER_IDE32                BIT(2)
+#define CAN_FILTER_RTR32                BIT(1)
+#define CAN_FILTER_IDE16                BIT(3)
+#define CAN_FILTER_RTR16                BIT(4)
+
+/* pattern classes, by bank cost */
+#define CAN_FILTER_STD_EXACT            0U
+#define CAN_FILTER_STD_MASK             1U
+#define CAN_FILTER_EXT_EXACT            2U
+#define CAN_FILTER_EXT_MASK             3U
+
+#define CAN_FILTER_FP_NONE              0xFFFFFFFFU                 /*!< bank count a CAN was not merged down to */
+
+/* cut the identifiers into patterns and count the requested ones */
+static ErrStatus can_filter_prepare(can_filter_plan_struct *plan, const can_filter_id_struct *ids, uint32_t num);
+/* merge the patterns of a CAN down to a bank count, noting the extra identifiers on the way */
+static ErrStatus can_filter_shrink(can_filter_plan_struct *plan, uint32_t can, uint32_t banks, uint32_t *fp);
+/* cut an identifier range into aligned exact patterns */
+static ErrStatus can_filter_cut(can_filter_plan_struct *plan, const can_filter_id_struct *id);
+/* drop the patterns another pattern of their group already covers */
+static void can_filter_prune(can_filter_plan_struct *plan);
+/* merge the two patterns of a group that let through the fewest extra identifiers */
+static ErrStatus can_filter_merge(can_filter_plan_struct *plan, uint32_t can_mask);
+/* merge two patterns of a group and get the identifiers neither let through */
+static uint32_t can_filter_merge_cost(const can_filter_pattern_struct *a, const can_filter_pattern_struct *b,
+                                      can_filter_pattern_struct *merged);
+/* get the banks a group saves when two of its patterns are replaced by their merge */
+static uint32_t can_filter_merge_saved(const uint32_t *count, const can_filter_pattern_struct *a,
+                                       const can_filter_pattern_struct *b, const can_filter_pattern_struct *merged);
+/* get the banks the patterns of a CAN need */
+static uint32_t can_filter_banks(const can_filter_plan_struct *plan, uint32_t can);
+/* get the banks the patterns of one FIFO need, by class count */
+static uint32_t can_filter_group_banks(const uint32_t *count);
+/* pack the patterns into banks */
+static void can_filter_layout(can_filter_plan_struct *plan);
+/* fill the settings of one bank from its register words */
+static void can_filter_bank_set(can_filter_plan_struct *plan, uint32_t bank, uint8_t fifo, uint16_t bits,
+                                uint16_t mode, uint32_t data0, uint32_t data1);
+/* count the identifiers of a CAN and format the patterns let through */
+static uint32_t can_filter_union(const can_filter_plan_struct *plan, uint32_t can, uint32_t extended);
+/* sort the patterns by CAN, FIFO and class */
+static void can_filter_sort(can_filter_plan_struct *plan);
+/* get the sort key of a pattern */
+static uint32_t can_filter_key(const can_filter_pattern_struct *pattern);
+/* get the identifier bits of a format */
+static uint32_t can_filter_id_mask(uint32_t extended);
+/* get the number of identifiers a mask lets through */
+static uint32_t can_filter_ids(uint32_t extended, uint32_t mask);
+/* get the number of identifiers a pattern lets through */
+static uint32_t can_filter_size(const can_filter_pattern_struct *pattern);
+/* get the class of a pattern */
+static uint32_t can_filter_class(const can_filter_pattern_struct *pattern);
+/* check whether two patterns share CAN, format and FIFO */
+static uint32_t can_filter_same_group(const can_filter_pattern_struct *a, const can_filter_pattern_struct *b);
+
+/*!
+    \brief      compile the identifiers of both CANs into filter banks; the
+                ranges are cut into exact patterns and patterns are merged,
+                fewest extra identifiers first, until both CANs fit into the
+                28 banks; the CAN1 start bank is the split that lets through
+                the fewest identifiers that were not asked for; nothing is
+                written to the CAN
+    \param[in]  ids: identifiers or ranges to receive
+    \param[in]  num: number of entries in ids
+    \param[out] plan: patterns, bank settings and CAN1 start bank
+    \retval     ErrStatus: SUCCESS, or ERROR on a bad entry or more than CAN_FILTER_PATTERN_MAX patterns
+*/
+ErrStatus can_filter_compile(can_filter_plan_struct *plan, const can_filter_id_struct *ids, uint32_t num)
+{
+    uint32_t fp[2][CAN_FILTER_BANK_NUM + 1U];
+    uint32_t banks[2], least[2];
+    uint32_t best_sum = CAN_FILTER_FP_NONE, best_max = CAN_FILTER_FP_NONE, best_start = 0U;
+    uint32_t start, sum, max;
+
+    if(ERROR == can_filter_prepare(plan, ids, num)){
+        return ERROR;
+    }
+    /* CAN0 keeps at least bank 0 and CAN1 starts at bank 27 at the latest */
+    banks[0] = can_filter_banks(plan, 0U);
+    banks[1] = can_filter_banks(plan, 1U);
+    if(0U == banks[0]){
+        banks[0] = 1U;
+    }
+    if((CAN_FILTER_BANK_NUM > banks[0]) && (CAN_FILTER_BANK_NUM >= (banks[0] + banks[1]))){
+        can_filter_layout(plan);
+        return SUCCESS;
+    }
+
+    /* the merges of a CAN never touch the patterns of the other, so each one is
+       merged on its own down to the banks the other leaves when it merges nothing */
+    least[0] = (banks[1] < CAN_FILTER_BANK_NUM) ? (CAN_FILTER_BANK_NUM - banks[1]) : 1U;
+    least[1] = (banks[0] < CAN_FILTER_BANK_NUM) ? (CAN_FILTER_BANK_NUM - banks[0]) : 1U;
+    (void)can_filter_shrink(plan, 0U, least[0], fp[0]);
+    (void)can_filter_shrink(plan, 1U, least[1], fp[1]);
+    for(start = 1U; start < CAN_FILTER_BANK_NUM; start++){
+        if((CAN_FILTER_FP_NONE == fp[0][start]) || (CAN_FILTER_FP_NONE == fp[1][CAN_FILTER_BANK_NUM - start])){
+            continue;
+        }
+        /* a tie goes to the split that shares the extra identifiers more evenly */
+        sum = fp[0][start] + fp[1][CAN_FILTER_BANK_NUM - start];
+        max = (fp[0][start] > fp[1][CAN_FILTER_BANK_NUM - start]) ? fp[0][start] : fp[1][CAN_FILTER_BANK_NUM - start];
+        if((sum < best_sum) || ((sum == best_sum) && (max < best_max))){
+            best_sum = sum;
+            best_max = max;
+            best_start = start;
+        }
+    }
+    if(0U == best_start){
+        return ERROR;
+    }
+
+    /* merge again from the start, each CAN down to its side of the split */
+    (void)can_filter_prepare(plan, ids, num);
+    if((ERROR == can_filter_shrink(plan, 0U, best_start, NULL))
+       || (ERROR == can_filter_shrink(plan, 1U, CAN_FILTER_BANK_NUM - best_start, NULL))){
+        return ERROR;
+    }
+    can_filter_layout(plan);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      load the banks of a plan, the unused ones disabled, and the
+                CAN1 start bank; the filters live in CAN0 and serve both CANs
+    \param[in]  plan: compiled plan
+    \param[out] none
+    \retval     none
+*/
+void can_filter_apply(const can_filter_plan_struct *plan)
+{
+    can_filter_parameter_struct bank;
+    uint32_t i;
+
+    for(i = 0U; i < CAN_FILTER_BANK_NUM; i++){
+        bank = plan->bank[i];
+        can_filter_init(&bank);
+    }
+    can1_filter_start_bank((uint8_t)plan->can1_start_bank);
+}
+
+/*!
+    \brief      count the identifiers the banks of a plan let through, against
+                the identifiers requested
+    \param[in]  plan: compiled plan
+    \param[out] report: requested, accepted and false positive identifiers by CAN and format
+    \retval     none
+*/
+void can_filter_report(const can_filter_plan_struct *plan, can_filter_report_struct *report)
+{
+    uint32_t can, extended;
+
+    for(can = 0U; can < 2U; can++){
+        for(extended = 0U; extended < 2U; extended++){
+            report->requested[can][extended] = plan->requested[can][extended];
+            report->accepted[can][extended] = can_filter_union(plan, can, extended);
+            report->false_positive[can][extended] = report->accepted[can][extended] - plan->requested[can][extended];
+        }
+    }
+}
+
+/*!
+    \brief      cut the identifiers into exact patterns, drop the covered ones
+                and count the identifiers requested
+    \param[in]  ids: identifiers or ranges to receive
+    \param[in]  num: number of entries in ids
+    \param[out] plan: patterns and requested identifiers
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus can_filter_prepare(can_filter_plan_struct *plan, const can_filter_id_struct *ids, uint32_t num)
+{
+    uint32_t can, extended, i;
+
+    plan->pattern_num = 0U;
+    for(i = 0U; i < num; i++){
+        if(ERROR == can_filter_cut(plan, &ids[i])){
+            return ERROR;
+        }
+    }
+    can_filter_prune(plan);
+    for(can = 0U; can < 2U; can++){
+        for(extended = 0U; extended < 2U; extended++){
+            plan->requested[can][extended] = can_filter_union(plan, can, extended);
+        }
+    }
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      merge the patterns of a CAN until they fit into a number of
+                banks, CAN0 always taking bank 0
+    \param[in]  plan: plan
+    \param[in]  can: 0 for CAN0, 1 for CAN1
+    \param[in]  banks: banks the CAN may use
+    \param[out] fp: for each bank count from 0 to CAN_FILTER_BANK_NUM, the extra
+                identifiers of the CAN when it first fit into that many banks,
+                CAN_FILTER_FP_NONE where it never did; NULL when not needed
+    \retval     ErrStatus: SUCCESS, or ERROR if the patterns do not merge down to banks
+*/
+static ErrStatus can_filter_shrink(can_filter_plan_struct *plan, uint32_t can, uint32_t banks, uint32_t *fp)
+{
+    uint32_t used, extra, i;
+
+    if(NULL != fp){
+        for(i = 0U; i <= CAN_FILTER_BANK_NUM; i++){
+            fp[i] = CAN_FILTER_FP_NONE;
+        }
+    }
+    while(1){
+        used = can_filter_banks(plan, can);
+        if((0U == can) && (0U == used)){
+            used = 1U;
+        }
+        if(NULL != fp){
+            extra = can_filter_union(plan, can, 0U) + can_filter_union(plan, can, 1U)
+                    - plan->requested[can][0] - plan->requested[can][1];
+            /* the counts above were reached by a merge before, with fewer extra identifiers */
+            for(i = used; (i <= CAN_FILTER_BANK_NUM) && (CAN_FILTER_FP_NONE == fp[i]); i++){
+                fp[i] = extra;
+            }
+        }
+        if(used <= banks){
+            return SUCCESS;
+        }
+        if(ERROR == can_filter_merge(plan, BIT(can))){
+            return ERROR;
+        }
+    }
+}
+
+/*!
+    \brief      cut an identifier range into aligned blocks, each an exact pattern
+    \param[in]  plan: plan the patterns are added to
+    \param[in]  id: identifier or range
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus can_filter_cut(can_filter_plan_struct *plan, const can_filter_id_struct *id)
+{
+    can_filter_pattern_struct *pattern;
+    uint32_t extended, full, first, size;
+    uint8_t can;
+
+    if(CAN0 == id->can_periph){
+        can = 0U;
+    }else if(CAN1 == id->can_periph){
+        can = 1U;
+    }else{
+        return ERROR;
+    }
+    if(CAN_FF_EXTENDED == id->ff){
+        extended = 1U;
+    }else if(CAN_FF_STANDARD == id->ff){
+        extended = 0U;
+    }else{
+        return ERROR;
+    }
+    full = can_filter_id_mask(extended);
+    if((id->first > id->last) || (id->last > full) || (CAN_FIFO1 < id->fifo)){
+        return ERROR;
+    }
+
+    first = id->first;
+    while(first <= id->last){
+        /* the largest block aligned on first that ends within the range */
+        size = (0U == first) ? (full + 1U) : (first & (~first + 1U));
+        while((first + size - 1U) > id->last){
+            size >>= 1U;
+        }
+        if(CAN_FILTER_PATTERN_MAX <= plan->pattern_num){
+            return ERROR;
+        }
+        pattern = &plan->pattern[plan->pattern_num++];
+        pattern->value = first;
+        pattern->mask = full & ~(size - 1U);
+        pattern->can = can;
+        pattern->extended = (uint8_t)extended;
+        pattern->fifo = id->fifo;
+        first += size;
+    }
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      drop the patterns another pattern of their group already covers
+    \param[in]  plan: plan
+    \param[out] none
+    \retval     none
+*/
+static void can_filter_prune(can_filter_plan_struct *plan)
+{
+    const can_filter_pattern_struct *a, *b;
+    uint32_t i, j;
+
+    for(i = 0U; i < plan->pattern_num; i++){
+        a = &plan->pattern[i];
+        for(j = 0U; j < plan->pattern_num; j++){
+            b = &plan->pattern[j];
+            if((i == j) || (0U == can_filter_same_group(a, b))){
+                continue;
+            }
+            /* a inside b: b compares no bit a leaves free and agrees on the bits it compares */
+            if((0U == (b->mask & ~a->mask)) && (0U == ((a->value ^ b->value) & b->mask))){
+                plan->pattern[i] = plan->pattern[--plan->pattern_num];
+                i--;
+                break;
+            }
+        }
+    }
+}
+
+/*!
+    \brief      merge the two patterns of a group that cost the fewest extra
+                identifiers per bank saved, or the fewest extra identifiers
+                when no merge leads to a saved bank; the merged pattern
+                compares the bits both compare and agree on
+    \param[in]  plan: plan
+    \param[in]  can_mask: BIT(x) for the CANx the merge may pick from
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if no group has two patterns left
+*/
+static ErrStatus can_filter_merge(can_filter_plan_struct *plan, uint32_t can_mask)
+{
+    can_filter_pattern_struct merged, best, next;
+    const can_filter_pattern_struct *a, *b, *c;
+    uint32_t count[2][2][4];
+    uint32_t after[4];
+    uint32_t best_cost = 0xFFFFFFFFU, best_saved = 0U;
+    uint32_t best_i = 0U, best_j = 0U;
+    uint32_t cost, saved, next_cost, next_saved, follow_cost, follow_saved, i, j, k;
+
+    memset(count, 0, sizeof(count));
+    for(i = 0U; i < plan->pattern_num; i++){
+        a = &plan->pattern[i];
+        count[a->can][a->fifo][can_filter_class(a)]++;
+    }
+    memset(&best, 0, sizeof(best));
+
+    for(i = 0U; i < plan->pattern_num; i++){
+        a = &plan->pattern[i];
+        if(0U == (can_mask & BIT(a->can))){
+            continue;
+        }
+        for(j = i + 1U; j < plan->pattern_num; j++){
+            b = &plan->pattern[j];
+            if(0U == can_filter_same_group(a, b)){
+                continue;
+            }
+            cost = can_filter_merge_cost(a, b, &merged);
+            saved = can_filter_merge_saved(count[a->can][a->fifo], a, b, &merged);
+            if(0U == saved){
+                /* two exact standard identifiers merged share a 16-bit mask half and save
+                   nothing yet, so the merge is rated with the cheapest one after it that
+                   saves a bank; otherwise the standard identifiers, which cost at most
+                   2048 identifiers all together, would lose against extended merges */
+                memcpy(after, count[a->can][a->fifo], sizeof(after));
+                after[can_filter_class(a)]--;
+                after[can_filter_class(b)]--;
+                after[can_filter_class(&merged)]++;
+                follow_cost = 0xFFFFFFFFU;
+                follow_saved = 0U;
+                for(k = 0U; k < plan->pattern_num; k++){
+                    c = &plan->pattern[k];
+                    if((k == i) || (k == j) || (0U == can_filter_same_group(a, c))){
+                        continue;
+                    }
+                    next_cost = can_filter_merge_cost(&merged, c, &next);
+                    next_saved = can_filter_merge_saved(after, &merged, c, &next);
+                    if((0U != next_saved) && ((0U == follow_saved) ||
+                       (((uint64_t)next_cost * follow_saved) < ((uint64_t)follow_cost * next_saved)))){
+                        follow_cost = next_cost;
+                        follow_saved = next_saved;
+                    }
+                }
+                if(0U != follow_saved){
+                    /* both costs stay below 2^29, the sum fits */
+                    cost += follow_cost;
+                    saved = follow_saved;
+                }
+            }
+            if((0U == best_saved) ? ((0U != saved) || (cost < best_cost)) :
+               ((0U != saved) && (((uint64_t)cost * best_saved) < ((uint64_t)best_cost * saved)))){
+                best_cost = cost;
+                best_saved = saved;
+                best = merged;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+    if((0xFFFFFFFFU == best_cost) && (0U == best_saved)){
+        return ERROR;
+    }
+    plan->pattern[best_i] = best;
+    plan->pattern[best_j] = plan->pattern[--plan->pattern_num];
+    can_filter_prune(plan);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      merge two patterns of a group into the one comparing the bits
+                both compare and agree on, and get the identifiers the merge
+                lets through that neither of them did
+    \param[in]  a: pattern
+    \param[in]  b: pattern of the same group
+    \param[out] merged: merged pattern
+    \retval     number of identifiers
+*/
+static uint32_t can_filter_merge_cost(const can_filter_pattern_struct *a, const can_filter_pattern_struct *b,
+                                      can_filter_pattern_struct *merged)
+{
+    uint32_t both;
+
+    *merged = *a;
+    merged->mask = a->mask & b->mask & ~(a->value ^ b->value);
+    merged->value = a->value & merged->mask;
+    both = (0U != ((a->value ^ b->value) & a->mask & b->mask)) ? 0U : can_filter_ids(a->extended, a->mask | b->mask);
+
+    return can_filter_size(merged) - (can_filter_size(a) + can_filter_size(b) - both);
+}
+
+/*!
+    \brief      get the banks a group saves when two of its patterns are replaced
+                by their merge
+    \param[in]  count: patterns of the group by class
+    \param[in]  a: pattern
+    \param[in]  b: pattern
+    \param[in]  merged: merge of a and b
+    \param[out] none
+    \retval     number of banks
+*/
+static uint32_t can_filter_merge_saved(const uint32_t *count, const can_filter_pattern_struct *a,
+                                       const can_filter_pattern_struct *b, const can_filter_pattern_struct *merged)
+{
+    uint32_t after[4];
+
+    memcpy(after, count, sizeof(after));
+    after[can_filter_class(a)]--;
+    after[can_filter_class(b)]--;
+    after[can_filter_class(merged)]++;
+
+    return can_filter_group_banks(count) - can_filter_group_banks(after);
+}
+
+/*!
+    \brief      get the banks the patterns of a CAN need
+    \param[in]  plan: plan
+    \param[in]  can: 0 for CAN0, 1 for CAN1
+    \param[out] none
+    \retval     number of banks
+*/
+static uint32_t can_filter_banks(const can_filter_plan_struct *plan, uint32_t can)
+{
+    uint32_t count[2][4];
+    uint32_t i;
+
+    memset(count, 0, sizeof(count));
+    for(i = 0U; i < plan->pattern_num; i++){
+        if(can == plan->pattern[i].can){
+            count[plan->pattern[i].fifo][can_filter_class(&plan->pattern[i])]++;
+        }
+    }
+
+    return can_filter_group_banks(count[0]) + can_filter_group_banks(count[1]);
+}
+
+/*!
+    \brief      get the banks the patterns of one FIFO need; an odd masked
+                standard pattern or exact extended identifier leaves half a
+                bank that takes an exact standard identifier
+    \param[in]  count: number of patterns by class
+    \param[out] none
+    \retval     number of banks
+*/
+static uint32_t can_filter_group_banks(const uint32_t *count)
+{
+    uint32_t banks, left;
+
+    banks = count[CAN_FILTER_EXT_MASK] + (count[CAN_FILTER_STD_MASK] / 2U) + (count[CAN_FILTER_EXT_EXACT] / 2U) +
+            (count[CAN_FILTER_STD_EXACT] / 4U);
+    left = count[CAN_FILTER_STD_EXACT] % 4U;
+    if(0U != (count[CAN_FILTER_STD_MASK] & 1U)){
+        banks++;
+        if(0U != left){
+            left--;
+        }
+    }
+    if(0U != (count[CAN_FILTER_EXT_EXACT] & 1U)){
+        banks++;
+        if(0U != left){
+            left--;
+        }
+    }
+    if(0U != left){
+        banks++;
+    }
+
+    return banks;
+}
+
+/*!
+    \brief      pack the patterns into banks, CAN0 from bank 0 and CAN1 from
+                its start bank, FIFO0 before FIFO1; a bank that is not filled
+                repeats one of its entries
+    \param[in]  plan: plan
+    \param[out] none
+    \retval     none
+*/
+static void can_filter_layout(can_filter_plan_struct *plan)
+{
+    const can_filter_pattern_struct *index[4];
+    uint32_t count[4];
+    uint32_t word[4];
+    const can_filter_pattern_struct *p, *q;
+    uint32_t bank = 0U, can, fifo, i, n;
+
+    /* sorted, the patterns of a class form a run that index points at */
+    can_filter_sort(plan);
+
+    for(can = 0U; can < 2U; can++){
+        if(1U == can){
+            plan->can1_start_bank = (0U == bank) ? 1U : bank;
+            bank = plan->can1_start_bank;
+        }
+        plan->bank_num[can] = bank;
+        for(fifo = 0U; fifo < 2U; fifo++){
+            memset(count, 0, sizeof(count));
+            for(i = 0U; i < plan->pattern_num; i++){
+                p = &plan->pattern[i];
+                if((can == p->can) && (fifo == p->fifo)){
+                    n = can_filter_class(p);
+                    if(0U == count[n]){
+                        index[n] = p;
+                    }
+                    count[n]++;
+                }
+            }
+
+            /* one masked extended pattern per 32-bit mask bank */
+            for(i = 0U; i < count[CAN_FILTER_EXT_MASK]; i++){
+                p = &index[CAN_FILTER_EXT_MASK][i];
+                can_filter_bank_set(plan, bank++, (uint8_t)fifo, CAN_FILTERBITS_32BIT, CAN_FILTERMODE_MASK,
+                                    (p->value << 3) | CAN_FILTER_IDE32,
+                                    (p->mask << 3) | CAN_FILTER_IDE32 | CAN_FILTER_RTR32);
+            }
+            /* two masked standard patterns per 16-bit mask bank, an exact one fills an odd bank */
+            for(i = 0U; i < count[CAN_FILTER_STD_MASK]; i += 2U){
+                p = &index[CAN_FILTER_STD_MASK][i];
+                if((i + 1U) < count[CAN_FILTER_STD_MASK]){
+                    q = &index[CAN_FILTER_STD_MASK][i + 1U];
+                }else if(0U != count[CAN_FILTER_STD_EXACT]){
+                    q = &index[CAN_FILTER_STD_EXACT][--count[CAN_FILTER_STD_EXACT]];
+                }else{
+                    q = p;
+                }
+                can_filter_bank_set(plan, bank++, (uint8_t)fifo, CAN_FILTERBITS_16BIT, CAN_FILTERMODE_MASK,
+                                    (((p->mask << 5) | CAN_FILTER_IDE16 | CAN_FILTER_RTR16) << 16) | (p->value << 5),
+                                    (((q->mask << 5) | CAN_FILTER_IDE16 | CAN_FILTER_RTR16) << 16) | (q->value << 5));
+            }
+            /* two exact extended identifiers per 32-bit list bank, an exact standard one fills an odd bank */
+            for(i = 0U; i < count[CAN_FILTER_EXT_EXACT]; i += 2U){
+                p = &index[CAN_FILTER_EXT_EXACT][i];
+                word[0] = (p->value << 3) | CAN_FILTER_IDE32;
+                if((i + 1U) < count[CAN_FILTER_EXT_EXACT]){
+                    q = &index[CAN_FILTER_EXT_EXACT][i + 1U];
+                    word[1] = (q->value << 3) | CAN_FILTER_IDE32;
+                }else if(0U != count[CAN_FILTER_STD_EXACT]){
+                    q = &index[CAN_FILTER_STD_EXACT][--count[CAN_FILTER_STD_EXACT]];
+                    word[1] = q->value << 21;
+                }else{
+                    word[1] = word[0];
+                }
+                can_filter_bank_set(plan, bank++, (uint8_t)fifo, CAN_FILTERBITS_32BIT, CAN_FILTERMODE_LIST,
+                                    word[0], word[1]);
+            }
+            /* four exact standard identifiers per 16-bit list bank */
+            for(i = 0U; i < count[CAN_FILTER_STD_EXACT]; i += 4U){
+                for(n = 0U; n < 4U; n++){
+                    p = &index[CAN_FILTER_STD_EXACT][((i + n) < count[CAN_FILTER_STD_EXACT]) ? (i + n) : i];
+                    word[n] = p->value << 5;
+                }
+                can_filter_bank_set(plan, bank++, (uint8_t)fifo, CAN_FILTERBITS_16BIT, CAN_FILTERMODE_LIST,
+                                    (word[1] << 16) | word[0], (word[3] << 16) | word[2]);
+            }
+        }
+        plan->bank_num[can] = bank - plan->bank_num[can];
+    }
+
+    /* the banks left over, including bank 0 when CAN0 needs none, stay disabled */
+    for(i = 0U; i < CAN_FILTER_BANK_NUM; i++){
+        if((i >= bank) || ((0U == plan->bank_num[0]) && (0U == i))){
+            can_filter_bank_set(plan, i, CAN_FIFO0, CAN_FILTERBITS_32BIT, CAN_FILTERMODE_MASK, 0U, 0U);
+            plan->bank[i].filter_enable = DISABLE;
+        }
+    }
+}
+
+/*!
+    \brief      fill the settings of one bank from the values of its two data
+                registers, as can_filter_init() builds them
+    \param[in]  plan: plan
+    \param[in]  bank: bank number
+    \param[in]  fifo: CAN_FIFO0 or CAN_FIFO1
+    \param[in]  bits: CAN_FILTERBITS_16BIT or CAN_FILTERBITS_32BIT
+    \param[in]  mode: CAN_FILTERMODE_MASK or CAN_FILTERMODE_LIST
+    \param[in]  data0: value of the filter data 0 register
+    \param[in]  data1: value of the filter data 1 register
+    \param[out] none
+    \retval     none
+*/
+static void can_filter_bank_set(can_filter_plan_struct *plan, uint32_t bank, uint8_t fifo, uint16_t bits,
+                                uint16_t mode, uint32_t data0, uint32_t data1)
+{
+    can_filter_parameter_struct *filter = &plan->bank[bank];
+
+    filter->filter_number = (uint16_t)bank;
+    filter->filter_fifo_number = fifo;
+    filter->filter_bits = bits;
+    filter->filter_mode = mode;
+    filter->filter_enable = ENABLE;
+    if(CAN_FILTERBITS_32BIT == bits){
+        filter->filter_list_high = (uint16_t)(data0 >> 16);
+        filter->filter_list_low = (uint16_t)data0;
+        filter->filter_mask_high = (uint16_t)(data1 >> 16);
+        filter->filter_mask_low = (uint16_t)data1;
+    }else{
+        filter->filter_mask_low = (uint16_t)(data0 >> 16);
+        filter->filter_list_low = (uint16_t)data0;
+        filter->filter_mask_high = (uint16_t)(data1 >> 16);
+        filter->filter_list_high = (uint16_t)data1;
+    }
+}
+
+/*!
+    \brief      count the identifiers of a CAN and format the patterns let
+                through; the identifier space is split on the highest bit a
+                pattern of the part compares, patterns that leave the bit free
+                going to both halves, and the halves are walked depth first
+                with the split bits as the only stack, so the count runs on
+                the target as well
+    \param[in]  plan: plan
+    \param[in]  can: 0 for CAN0, 1 for CAN1
+    \param[in]  extended: 1 for extended identifiers
+    \param[out] none
+    \retval     number of identifiers
+*/
+static uint32_t can_filter_union(const can_filter_plan_struct *plan, uint32_t can, uint32_t extended)
+{
+    const can_filter_pattern_struct *p;
+    uint8_t split[29];
+    uint32_t bits = (0U != extended) ? 29U : 11U;
+    uint32_t path_mask = 0U, path_value = 0U, depth = 0U, count = 0U;
+    uint32_t care, found, full, bit, i;
+
+    while(1){
+        /* the part is the identifiers that agree with path_value on path_mask, its
+           patterns those that compare no path bit differently */
+        care = 0U;
+        found = 0U;
+        full = 0U;
+        for(i = 0U; (i < plan->pattern_num) && (0U == full); i++){
+            p = &plan->pattern[i];
+            if((can != p->can) || (extended != p->extended) || (0U != ((p->value ^ path_value) & p->mask & path_mask))){
+                continue;
+            }
+            found = 1U;
+            if(0U == (p->mask & ~path_mask)){
+                full = 1U;
+            }
+            care |= p->mask & ~path_mask;
+        }
+
+        if(0U != full){
+            /* a pattern takes the whole part, the bits off the path are free */
+            count += 1U << (bits - depth);
+        }else if(0U != found){
+            /* no pattern of the part compares the bits above the highest one cared for */
+            bit = 31U;
+            while(0U == (care & BIT(bit))){
+                bit--;
+            }
+            split[depth++] = (uint8_t)bit;
+            path_mask |= BIT(bit);
+            path_value &= ~BIT(bit);
+            continue;
+        }
+
+        /* back up to the last split still on its 0 side and take its 1 side */
+        while(0U != depth){
+            bit = split[depth - 1U];
+            if(0U == (path_value & BIT(bit))){
+                path_value |= BIT(bit);
+                break;
+            }
+            path_mask &= ~BIT(bit);
+            path_value &= ~BIT(bit);
+            depth--;
+        }
+        if(0U == depth){
+            return count;
+        }
+    }
+}
+
+/*!
+    \brief      sort the patterns by CAN, FIFO and class, so that the patterns
+                of a class sharing a FIFO are next to each other; there are at
+                most CAN_FILTER_PATTERN_MAX, an insertion sort does
+    \param[in]  plan: plan
+    \param[out] none
+    \retval     none
+*/
+static void can_filter_sort(can_filter_plan_struct *plan)
+{
+    can_filter_pattern_struct pattern;
+    uint32_t key, i, j;
+
+    for(i = 1U; i < plan->pattern_num; i++){
+        pattern = plan->pattern[i];
+        key = can_filter_key(&pattern);
+        for(j = i; (0U != j) && (can_filter_key(&plan->pattern[j - 1U]) > key); j--){
+            plan->pattern[j] = plan->pattern[j - 1U];
+        }
+        plan->pattern[j] = pattern;
+    }
+}
+
+/*!
+    \brief      get the sort key of a pattern
+    \param[in]  pattern: pattern
+    \param[out] none
+    \retval     key ordering CAN, then FIFO, then class
+*/
+static uint32_t can_filter_key(const can_filter_pattern_struct *pattern)
+{
+    return ((uint32_t)pattern->can << 3) | ((uint32_t)pattern->fifo << 2) | can_filter_class(pattern);
+}
+
+/*!
+    \brief      get the identifier bits of a format
+    \param[in]  extended: 1 for extended identifiers
+    \param[out] none
+    \retval     CAN_EFID_MASK or CAN_SFID_MASK
+*/
+static uint32_t can_filter_id_mask(uint32_t extended)
+{
+    return (0U != extended) ? CAN_EFID_MASK : CAN_SFID_MASK;
+}
+
+/*!
+    \brief      get the number of identifiers a mask lets through
+    \param[in]  extended: 1 for extended identifiers
+    \param[in]  mask: bits compared
+    \param[out] none
+    \retval     number of identifiers
+*/
+static uint32_t can_filter_ids(uint32_t extended, uint32_t mask)
+{
+    uint32_t free = can_filter_id_mask(extended) & ~mask;
+    uint32_t count = 1U;
+
+    while(0U != free){
+        count <<= 1U;
+        free &= free - 1U;
+    }
+
+    return count;
+}
+
+/*!
+    \brief      get the number of identifiers a pattern lets through
+    \param[in]  pattern: pattern
+    \param[out] none
+    \retval     number of identifiers
+*/
+static uint32_t can_filter_size(const can_filter_pattern_struct *pattern)
+{
+    return can_filter_ids(pattern->extended, pattern->mask);
+}
+
+/*!
+    \brief      get the class of a pattern
+    \param[in]  pattern: pattern
+    \param[out] none
+    \retval     CAN_FILTER_STD_EXACT, CAN_FILTER_STD_MASK, CAN_FILTER_EXT_EXACT or CAN_FILTER_EXT_MASK
+*/
+static uint32_t can_filter_class(const can_filter_pattern_struct *pattern)
+{
+    uint32_t exact = (can_filter_id_mask(pattern->extended) == pattern->mask) ? 1U : 0U;
+
+    if(0U != pattern->extended){
+        return (0U != exact) ? CAN_FILTER_EXT_EXACT : CAN_FILTER_EXT_MASK;
+    }
+
+    return (0U != exact) ? CAN_FILTER_STD_EXACT : CAN_FILTER_STD_MASK;
+}
+
+/*!
+    \brief      check whether two patterns share CAN, format and FIFO
+    \param[in]  a: pattern
+    \param[in]  b: pattern
+    \param[out] none
+    \retval     1 if they do, 0 otherwise
+*/
+static uint32_t can_filter_same_group(const can_filter_pattern_struct *a, const can_filter_pattern_struct *b)
+{
+    return ((a->can == b->can) && (a->extended == b->extended) && (a->fifo == b->fifo)) ? 1U : 0U;
+}
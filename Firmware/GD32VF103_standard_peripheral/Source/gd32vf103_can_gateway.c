@@ -0,0 +1,423 @@
+/*!
+    \file  gd32vf103_can_gateway.c
+    \brief CAN0 to CAN1 gateway
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_can_gateway.h"
+#include "gd32vf103_bench.h"
+#include "n200_func.h"
+
+#define CAN_GATEWAY_MAILBOX_NUM         3U
+#define CAN_GATEWAY_INT                 (CAN_INT_TME | CAN_INT_RFNE0 | CAN_INT_RFO0 | CAN_INT_RFNE1 | CAN_INT_RFO1)
+#define CAN_GATEWAY_CREDIT_MAX          0x7FFFFFFFU                 /*!< largest bucket, keeps the credit within half the mcycle word */
+
+/* get the index of a CAN, 0 for CAN0 and 1 for CAN1 */
+#define CAN_GATEWAY_INDEX(can_periph)   ((CAN0 == (can_periph)) ? 0U : 1U)
+/* get the CAN of an index */
+#define CAN_GATEWAY_PERIPH(index)       ((0U == (index)) ? CAN0 : CAN1)
+
+/* get a transmit mailbox of a CAN that is empty and retired */
+static uint32_t can_gateway_mailbox_get(const can_gateway_struct *gateway, uint32_t index);
+/* load the frames waiting in the ring of a CAN into its free mailboxes */
+static void can_gateway_ring_load(can_gateway_struct *gateway, uint32_t index);
+/* take a frame from the token bucket of its route */
+static uint32_t can_gateway_rate_pass(can_gateway_route_struct *route, uint64_t now);
+/* convert mcycles to nanoseconds */
+static uint32_t can_gateway_ns(const can_gateway_struct *gateway, uint64_t cycles);
+
+/*!
+    \brief      initialize the routes and enable the interrupts of both CANs;
+                the CANs are initialized and their filters loaded by the
+                caller, and TFO is set on both so the mailboxes go out in the
+                order they are loaded
+    \param[in]  gateway: gateway state
+    \param[in]  init_struct: the data needed to initialize the gateway
+                  routes, route_num: 1 to 255 configured routes
+                  tx_buffer, tx_size: transmit rings of CAN0 and CAN1, sizes powers of two up to 32768 or 0
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus can_gateway_init(can_gateway_struct *gateway, can_gateway_parameter_struct *init_struct)
+{
+    can_gateway_route_struct *route;
+    uint32_t clock = rcu_clock_freq_get(CK_AHB);
+    uint32_t fmask, i;
+
+    if((0U == init_struct->route_num) || (CAN_GATEWAY_ROUTE_MAX < init_struct->route_num)){
+        return ERROR;
+    }
+    for(i = 0U; i < 2U; i++){
+        if((CAN_GATEWAY_RING_MAX < init_struct->tx_size[i])
+           || (0U != (init_struct->tx_size[i] & (init_struct->tx_size[i] - 1U)))
+           || ((0U != init_struct->tx_size[i]) && (NULL == init_struct->tx_buffer[i]))){
+            return ERROR;
+        }
+    }
+    for(i = 0U; i < init_struct->route_num; i++){
+        route = &init_struct->routes[i];
+        fmask = ((uint8_t)CAN_FF_STANDARD == route->ff) ? CAN_SFID_MASK : CAN_EFID_MASK;
+        if(((CAN0 != route->src_periph) && (CAN1 != route->src_periph))
+           || (((uint8_t)CAN_FF_STANDARD != route->ff) && ((uint8_t)CAN_FF_EXTENDED != route->ff))
+           || (fmask < route->id) || (fmask < route->mask) || (fmask < route->new_id) || (fmask < route->new_mask)){
+            return ERROR;
+        }
+        /* the bucket must hold burst frames of clock / rate mcycles */
+        if((0U != route->rate) && ((0U == route->burst) || (clock < route->rate)
+                                   || ((clock / route->rate) > (CAN_GATEWAY_CREDIT_MAX / route->burst)))){
+            return ERROR;
+        }
+    }
+
+    gateway->routes = init_struct->routes;
+    gateway->route_num = init_struct->route_num;
+    /* mcycle runs at the AHB clock */
+    gateway->clock = clock;
+    for(i = 0U; i < gateway->route_num; i++){
+        route = &gateway->routes[i];
+        /* match and translate in the layout of the identifier registers */
+        if((uint8_t)CAN_FF_STANDARD == route->ff){
+            route->match = TMI_SFID(route->id & route->mask);
+            route->match_mask = TMI_SFID(route->mask) | CAN_RFIFOMI_FF;
+            route->replace = TMI_SFID(route->new_id & route->new_mask);
+            route->replace_mask = TMI_SFID(route->new_mask);
+        }else{
+            route->match = TMI_EFID(route->id & route->mask) | CAN_FF_EXTENDED;
+            route->match_mask = TMI_EFID(route->mask) | CAN_RFIFOMI_FF;
+            route->replace = TMI_EFID(route->new_id & route->new_mask);
+            route->replace_mask = TMI_EFID(route->new_mask);
+        }
+        route->period = (0U != route->rate) ? (clock / route->rate) : 0U;
+        route->credit_max = route->period * route->burst;
+        route->credit = route->credit_max;
+        route->last = get_cycle_value();
+        route->forwarded = 0U;
+        route->dropped_rate = 0U;
+        route->dropped_busy = 0U;
+        route->dropped_error = 0U;
+        route->latency_min = 0xFFFFFFFFU;
+        route->latency_max = 0U;
+        route->latency_sum = 0U;
+    }
+    for(i = 0U; i < 2U; i++){
+        gateway->tx_buffer[i] = init_struct->tx_buffer[i];
+        gateway->tx_size[i] = init_struct->tx_size[i];
+        gateway->tx_head[i] = 0U;
+        gateway->tx_tail[i] = 0U;
+        gateway->mailbox_route[i][0] = 0U;
+        gateway->mailbox_route[i][1] = 0U;
+        gateway->mailbox_route[i][2] = 0U;
+        gateway->tx_direct[i] = 0U;
+        gateway->tx_queued[i] = 0U;
+        gateway->unrouted[i] = 0U;
+        gateway->rx_overrun[i][0] = 0U;
+        gateway->rx_overrun[i][1] = 0U;
+    }
+
+    bench_counters_hold();
+    for(i = 0U; i < 2U; i++){
+        /* mailboxes go out in load order, stale finish flags are dropped */
+        CAN_CTL(CAN_GATEWAY_PERIPH(i)) |= CAN_CTL_TFO;
+        CAN_TSTAT(CAN_GATEWAY_PERIPH(i)) = CAN_TSTAT_MTF0 | CAN_TSTAT_MTF1 | CAN_TSTAT_MTF2;
+        can_interrupt_enable(CAN_GATEWAY_PERIPH(i), CAN_GATEWAY_INT);
+    }
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      disable the CAN interrupts of the gateway and drop the frames
+                waiting in the rings, the mailboxes already loaded are still sent
+    \param[in]  gateway: gateway state
+    \param[out] none
+    \retval     none
+*/
+void can_gateway_deinit(can_gateway_struct *gateway)
+{
+    can_interrupt_disable(CAN0, CAN_GATEWAY_INT);
+    can_interrupt_disable(CAN1, CAN_GATEWAY_INT);
+    gateway->tx_tail[0] = gateway->tx_head[0];
+    gateway->tx_tail[1] = gateway->tx_head[1];
+    bench_counters_release();
+}
+
+/*!
+    \brief      get the counters and the latencies of a route, taken together
+                with the CAN interrupts masked
+    \param[in]  gateway: gateway state
+    \param[in]  route: index of the route
+    \param[out] stats: counters, latencies in nanoseconds, 0 before the first frame forwarded
+    \retval     ErrStatus: SUCCESS, or ERROR for an index of no route
+*/
+ErrStatus can_gateway_stats_get(can_gateway_struct *gateway, uint32_t route, can_gateway_stats_struct *stats)
+{
+    can_gateway_route_struct *entry;
+    uint32_t inten0, inten1, forwarded, latency_min, latency_max;
+    uint64_t latency_sum;
+
+    if(gateway->route_num <= route){
+        return ERROR;
+    }
+    entry = &gateway->routes[route];
+    inten0 = CAN_INTEN(CAN0) & CAN_GATEWAY_INT;
+    inten1 = CAN_INTEN(CAN1) & CAN_GATEWAY_INT;
+    can_interrupt_disable(CAN0, CAN_GATEWAY_INT);
+    can_interrupt_disable(CAN1, CAN_GATEWAY_INT);
+    forwarded = entry->forwarded;
+    stats->dropped_rate = entry->dropped_rate;
+    stats->dropped_busy = entry->dropped_busy;
+    stats->dropped_error = entry->dropped_error;
+    latency_min = entry->latency_min;
+    latency_max = entry->latency_max;
+    latency_sum = entry->latency_sum;
+    CAN_INTEN(CAN0) |= inten0;
+    CAN_INTEN(CAN1) |= inten1;
+
+    stats->forwarded = forwarded;
+    if(0U == forwarded){
+        stats->latency_min_ns = 0U;
+        stats->latency_max_ns = 0U;
+        stats->latency_avg_ns = 0U;
+    }else{
+        stats->latency_min_ns = can_gateway_ns(gateway, latency_min);
+        stats->latency_max_ns = can_gateway_ns(gateway, latency_max);
+        stats->latency_avg_ns = can_gateway_ns(gateway, latency_sum / forwarded);
+    }
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      transmit interrupt service, retires the finished mailboxes of a
+                CAN into the statistics of their routes and loads the frames
+                waiting in its ring
+    \param[in]  gateway: gateway state
+    \param[in]  can_periph: CANx(x=0,1)
+    \param[out] none
+    \retval     none
+*/
+void can_gateway_tx_irq_handler(can_gateway_struct *gateway, uint32_t can_periph)
+{
+    can_gateway_route_struct *route;
+    uint32_t index = CAN_GATEWAY_INDEX(can_periph);
+    uint32_t tstat = CAN_TSTAT(can_periph);
+    uint32_t now = (uint32_t)get_cycle_value();
+    uint32_t mailbox, finished, owner, latency;
+
+    for(mailbox = 0U; mailbox < CAN_GATEWAY_MAILBOX_NUM; mailbox++){
+        finished = CAN_TSTAT_MTF0 << (8U * mailbox);
+        if(0U == (tstat & finished)){
+            continue;
+        }
+        /* MTF written 1 clears the finish flags, the other bits ignore a 0 */
+        CAN_TSTAT(can_periph) = finished;
+        owner = gateway->mailbox_route[index][mailbox];
+        if(0U == owner){
+            continue;
+        }
+        gateway->mailbox_route[index][mailbox] = 0U;
+        route = &gateway->routes[owner - 1U];
+        if(0U == (tstat & (CAN_TSTAT_MTFNERR0 << (8U * mailbox)))){
+            route->dropped_error++;
+            continue;
+        }
+        latency = now - gateway->mailbox_stamp[index][mailbox];
+        route->forwarded++;
+        route->latency_sum += latency;
+        if(latency < route->latency_min){
+            route->latency_min = latency;
+        }
+        if(latency > route->latency_max){
+            route->latency_max = latency;
+        }
+    }
+    can_gateway_ring_load(gateway, index);
+}
+
+/*!
+    \brief      receive FIFO interrupt service, forwards the frames of a FIFO
+                to the other CAN: straight from the FIFO mailbox into a free
+                transmit mailbox, or into the ring while frames wait there or
+                the mailboxes are busy
+    \param[in]  gateway: gateway state
+    \param[in]  can_periph: CANx(x=0,1)
+    \param[in]  fifo: CAN_FIFO0 or CAN_FIFO1
+    \param[out] none
+    \retval     none
+*/
+void can_gateway_rx_irq_handler(can_gateway_struct *gateway, uint32_t can_periph, uint8_t fifo)
+{
+    can_queue_raw_struct raw[CAN_QUEUE_FIFO_DEPTH];
+    can_gateway_route_struct *route;
+    can_gateway_frame_struct *slot;
+    uint32_t src = CAN_GATEWAY_INDEX(can_periph);
+    uint32_t dst = 1U - src;
+    uint32_t dst_periph = CAN_GATEWAY_PERIPH(dst);
+    uint64_t now = get_cycle_value();
+    uint32_t num, mailbox, n, i;
+
+    num = can_queue_fifo_take(can_periph, fifo, raw, &gateway->rx_overrun[src][fifo]);
+    for(n = 0U; n < num; n++){
+        route = NULL;
+        for(i = 0U; i < gateway->route_num; i++){
+            if((gateway->routes[i].src_periph == can_periph)
+               && (gateway->routes[i].match == (raw[n].mi & gateway->routes[i].match_mask))){
+                route = &gateway->routes[i];
+                break;
+            }
+        }
+        if(NULL == route){
+            gateway->unrouted[src]++;
+            continue;
+        }
+        if(0U == can_gateway_rate_pass(route, now)){
+            route->dropped_rate++;
+            continue;
+        }
+        /* the time stamp and filter index bits are not copied */
+        raw[n].mi = (raw[n].mi & ~(route->replace_mask | CAN_TMI_TEN)) | route->replace;
+        raw[n].mp &= CAN_TMP_DLENC;
+        mailbox = CAN_GATEWAY_MAILBOX_NUM;
+        if(gateway->tx_head[dst] == gateway->tx_tail[dst]){
+            mailbox = can_gateway_mailbox_get(gateway, dst);
+        }
+        if(CAN_GATEWAY_MAILBOX_NUM != mailbox){
+            can_queue_mailbox_load(dst_periph, mailbox, &raw[n]);
+            gateway->mailbox_route[dst][mailbox] = (uint8_t)(i + 1U);
+            gateway->mailbox_stamp[dst][mailbox] = (uint32_t)now;
+            gateway->tx_direct[dst]++;
+        }else if(gateway->tx_size[dst] != (gateway->tx_head[dst] - gateway->tx_tail[dst])){
+            slot = &gateway->tx_buffer[dst][gateway->tx_head[dst] & (gateway->tx_size[dst] - 1U)];
+            slot->raw = raw[n];
+            slot->stamp = (uint32_t)now;
+            slot->route = i;
+            gateway->tx_head[dst]++;
+        }else{
+            route->dropped_busy++;
+        }
+    }
+}
+
+/*!
+    \brief      get a transmit mailbox of a CAN that is empty and whose last
+                frame has been retired by the transmit interrupt
+    \param[in]  gateway: gateway state
+    \param[in]  index: 0 for CAN0, 1 for CAN1
+    \param[out] none
+    \retval     mailbox 0 to 2, or 3 when none is free
+*/
+static uint32_t can_gateway_mailbox_get(const can_gateway_struct *gateway, uint32_t index)
+{
+    uint32_t tstat = CAN_TSTAT(CAN_GATEWAY_PERIPH(index));
+    uint32_t mailbox;
+
+    for(mailbox = 0U; mailbox < CAN_GATEWAY_MAILBOX_NUM; mailbox++){
+        if((0U != (tstat & (CAN_TSTAT_TME0 << mailbox))) && (0U == gateway->mailbox_route[index][mailbox])){
+            break;
+        }
+    }
+    return mailbox;
+}
+
+/*!
+    \brief      load the frames waiting in the ring of a CAN into its free
+                mailboxes, oldest first
+    \param[in]  gateway: gateway state
+    \param[in]  index: 0 for CAN0, 1 for CAN1
+    \param[out] none
+    \retval     none
+*/
+static void can_gateway_ring_load(can_gateway_struct *gateway, uint32_t index)
+{
+    can_gateway_frame_struct *slot;
+    uint32_t can_periph = CAN_GATEWAY_PERIPH(index);
+    uint32_t mailbox;
+
+    while(gateway->tx_head[index] != gateway->tx_tail[index]){
+        mailbox = can_gateway_mailbox_get(gateway, index);
+        if(CAN_GATEWAY_MAILBOX_NUM == mailbox){
+            break;
+        }
+        slot = &gateway->tx_buffer[index][gateway->tx_tail[index] & (gateway->tx_size[index] - 1U)];
+        can_queue_mailbox_load(can_periph, mailbox, &slot->raw);
+        gateway->mailbox_route[index][mailbox] = (uint8_t)(slot->route + 1U);
+        gateway->mailbox_stamp[index][mailbox] = slot->stamp;
+        gateway->tx_tail[index]++;
+        gateway->tx_queued[index]++;
+    }
+}
+
+/*!
+    \brief      take a frame from the token bucket of its route; the bucket
+                gains one mcycle of credit per mcycle up to burst frames and a
+                frame costs clock / rate mcycles
+    \param[in]  route: route of the frame
+    \param[in]  now: mcycle
+    \param[out] none
+    \retval     1 when the frame may pass, 0 when it is over the rate
+*/
+static uint32_t can_gateway_rate_pass(can_gateway_route_struct *route, uint64_t now)
+{
+    uint64_t elapsed;
+
+    if(0U == route->rate){
+        return 1U;
+    }
+    /* the whole 64-bit mcycle, the low word wraps after 40 s at 108 MHz */
+    elapsed = now - route->last;
+    route->last = now;
+    /* the bucket is full after credit_max mcycles, so the sum cannot wrap */
+    if(elapsed >= (route->credit_max - route->credit)){
+        route->credit = route->credit_max;
+    }else{
+        route->credit += (uint32_t)elapsed;
+    }
+    if(route->credit < route->period){
+        return 0U;
+    }
+    route->credit -= route->period;
+    return 1U;
+}
+
+/*!
+    \brief      convert mcycles to nanoseconds, saturated to 32 bits
+    \param[in]  gateway: gateway state
+    \param[in]  cycles: mcycles
+    \param[out] none
+    \retval     nanoseconds
+*/
+static uint32_t can_gateway_ns(const can_gateway_struct *gateway, uint64_t cycles)
+{
+    uint64_t ns = (cycles * 1000000000ULL) / gateway->clock;
+
+    return (0xFFFFFFFFULL < ns) ? 0xFFFFFFFFU : (uint32_t)ns;
+}
@@ -0,0 +1,815 @@
+/*!
+    \file  gd32vf103_can_isotp.c
+    \brief ISO 15765-2 transport over CAN
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_can_isotp.h"
+#include "gd32vf103_can_queue.h"
+#include "gd32vf103_bench.h"
+#include "n200_func.h"
+
+#define CAN_ISOTP_MAILBOX_NUM           3U
+#define CAN_ISOTP_INT                   (CAN_INT_TME | CAN_INT_RFNE0 | CAN_INT_RFO0 | CAN_INT_RFNE1 | CAN_INT_RFO1)
+#define CAN_ISOTP_TIMEOUT_MS_MAX        10000U                      /*!< longest timeout, keeps deadlines within half the mcycle word */
+#define CAN_ISOTP_CF_DATA               7U                          /*!< data bytes of a consecutive frame */
+
+/* frame type, high nibble of the first byte */
+#define CAN_ISOTP_PCI_SF                0x00U                       /*!< single frame */
+#define CAN_ISOTP_PCI_FF                0x10U                       /*!< first frame */
+#define CAN_ISOTP_PCI_CF                0x20U                       /*!< consecutive frame */
+#define CAN_ISOTP_PCI_FC                0x30U                       /*!< flow control frame */
+
+/* flow status of a flow control frame */
+#define CAN_ISOTP_FS_CTS                0x00U                       /*!< continue to send */
+#define CAN_ISOTP_FS_WAIT               0x01U                       /*!< wait for the next flow control */
+#define CAN_ISOTP_FS_OVFLW              0x02U                       /*!< message too long, abort */
+#define CAN_ISOTP_FS_NONE               0xFFU                       /*!< no flow control to send */
+
+/* session states */
+#define CAN_ISOTP_IDLE                  0U                          /*!< no message */
+#define CAN_ISOTP_SEND                  1U                          /*!< frames of the message may be loaded */
+#define CAN_ISOTP_WAIT_FC               2U                          /*!< the peer owes a flow control */
+#define CAN_ISOTP_RECEIVE               1U                          /*!< consecutive frames expected */
+
+/* load the free mailboxes, flow control frames first, then the sessions in turn */
+static void can_isotp_tx_load(can_isotp_struct *isotp, uint32_t now);
+/* check whether a session may load its next frame */
+static uint32_t can_isotp_tx_ready(const can_isotp_session_struct *session, uint32_t now);
+/* load the next single, first or consecutive frame of a session into a mailbox */
+static void can_isotp_data_load(can_isotp_struct *isotp, uint32_t mailbox, uint32_t index, uint32_t now);
+/* load the pending flow control frame of a session into a mailbox */
+static void can_isotp_fc_load(can_isotp_struct *isotp, uint32_t mailbox, uint32_t index, uint32_t now);
+/* write a frame into a mailbox and request its transmission */
+static void can_isotp_mailbox_write(uint32_t can_periph, uint32_t mailbox, const can_isotp_session_struct *session,
+                                    const uint8_t *pci, uint32_t pci_len, const uint8_t *data, uint32_t len);
+/* hand a received frame to its session */
+static void can_isotp_frame_receive(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t dlen,
+                                    uint32_t data0, uint32_t data1, uint32_t now);
+/* take a consecutive frame into the receive buffer */
+static void can_isotp_cf_receive(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t dlen,
+                                 uint32_t data0, uint32_t data1, uint32_t now);
+/* apply a flow control frame to the message being sent */
+static void can_isotp_fc_receive(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t dlen,
+                                 uint32_t data0, uint32_t data1, uint32_t now);
+/* end the message being sent */
+static void can_isotp_tx_end(can_isotp_struct *isotp, can_isotp_session_struct *session, can_isotp_result_enum result);
+/* end the message being received */
+static void can_isotp_rx_end(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t len,
+                             can_isotp_result_enum result);
+/* convert a separation time to mcycles */
+static uint32_t can_isotp_st_cycles(const can_isotp_struct *isotp, uint32_t st_min);
+/* get a byte of a received frame from its data registers */
+static uint32_t can_isotp_byte(uint32_t data0, uint32_t data1, uint32_t index);
+
+/*!
+    \brief      initialize the sessions and enable the CAN interrupts; the CAN
+                is initialized and its filters loaded by the caller, and TFO is
+                set so the mailboxes go out in the order they are loaded
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  init_struct: the data needed to initialize the transport
+                  can_periph: CANx(x=0,1)
+                  sessions, session_num: 1 to 255 configured sessions, each received identifier once
+                  timeout_ms: N_Bs and N_Cr timeout up to 10000 ms, 0 for CAN_ISOTP_TIMEOUT_MS
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus can_isotp_init(can_isotp_struct *isotp, can_isotp_parameter_struct *init_struct)
+{
+    can_isotp_session_struct *session;
+    uint32_t timeout_ms = (0U != init_struct->timeout_ms) ? init_struct->timeout_ms : CAN_ISOTP_TIMEOUT_MS;
+    uint32_t mask, i, j;
+
+    if((0U == init_struct->session_num) || (255U < init_struct->session_num) || (CAN_ISOTP_TIMEOUT_MS_MAX < timeout_ms)){
+        return ERROR;
+    }
+    for(i = 0U; i < init_struct->session_num; i++){
+        session = &init_struct->sessions[i];
+        mask = ((uint8_t)CAN_FF_STANDARD == session->ff) ? CAN_SFID_MASK : CAN_EFID_MASK;
+        if((((uint8_t)CAN_FF_STANDARD != session->ff) && ((uint8_t)CAN_FF_EXTENDED != session->ff))
+           || (mask < session->tx_id) || (mask < session->rx_id)
+           || ((0xFFU < session->padding) && (CAN_ISOTP_PADDING_NONE != session->padding))){
+            return ERROR;
+        }
+        for(j = 0U; j < i; j++){
+            if((init_struct->sessions[j].rx_id == session->rx_id) && (init_struct->sessions[j].ff == session->ff)){
+                return ERROR;
+            }
+        }
+    }
+
+    isotp->can_periph = init_struct->can_periph;
+    isotp->sessions = init_struct->sessions;
+    isotp->session_num = init_struct->session_num;
+    /* mcycle runs at the AHB clock */
+    isotp->clock = rcu_clock_freq_get(CK_AHB);
+    isotp->timeout = (isotp->clock / 1000U) * timeout_ms;
+    isotp->next = 0U;
+    for(i = 0U; i < CAN_ISOTP_MAILBOX_NUM; i++){
+        isotp->mailbox_session[i] = 0U;
+    }
+    isotp->mailbox_fc = 0U;
+    isotp->ignored = 0U;
+    isotp->rx_overrun[0] = 0U;
+    isotp->rx_overrun[1] = 0U;
+    for(i = 0U; i < isotp->session_num; i++){
+        session = &isotp->sessions[i];
+        session->tx_data = NULL;
+        session->tx_len = 0U;
+        session->tx_offset = 0U;
+        session->tx_st = 0U;
+        session->tx_state = CAN_ISOTP_IDLE;
+        session->tx_inflight = 0U;
+        session->rx_state = CAN_ISOTP_IDLE;
+        session->rx_fc = CAN_ISOTP_FS_NONE;
+        session->rx_len = 0U;
+        session->rx_offset = 0U;
+        session->tx_messages = 0U;
+        session->rx_messages = 0U;
+        session->tx_errors = 0U;
+        session->rx_errors = 0U;
+    }
+
+    bench_counters_hold();
+    /* mailboxes go out in load order, stale finish flags are dropped */
+    CAN_CTL(isotp->can_periph) |= CAN_CTL_TFO;
+    CAN_TSTAT(isotp->can_periph) = CAN_TSTAT_MTF0 | CAN_TSTAT_MTF1 | CAN_TSTAT_MTF2;
+    can_interrupt_enable(isotp->can_periph, CAN_ISOTP_INT);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      disable the CAN interrupts of the transport, the mailboxes
+                already loaded are still sent
+    \param[in]  isotp: ISO-TP driver state
+    \param[out] none
+    \retval     none
+*/
+void can_isotp_deinit(can_isotp_struct *isotp)
+{
+    can_interrupt_disable(isotp->can_periph, CAN_ISOTP_INT);
+    bench_counters_release();
+}
+
+/*!
+    \brief      start sending a message on a session; the data is read while
+                the frames are loaded and must stay unchanged until the
+                transmit callback. May be called from the callbacks.
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  session: session of the driver
+    \param[in]  data: message
+    \param[in]  len: message length, at least 1 byte
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR while the session sends or still has frames in the mailboxes
+*/
+ErrStatus can_isotp_transmit(can_isotp_struct *isotp, can_isotp_session_struct *session, const uint8_t *data, uint32_t len)
+{
+    uint32_t inten;
+    ErrStatus status = ERROR;
+
+    if((NULL == data) || (0U == len)){
+        return ERROR;
+    }
+
+    /* the interrupts are masked, not enabled again, so a callback may call in too */
+    inten = CAN_INTEN(isotp->can_periph) & CAN_ISOTP_INT;
+    can_interrupt_disable(isotp->can_periph, CAN_ISOTP_INT);
+    if((CAN_ISOTP_IDLE == session->tx_state) && (0U == session->tx_inflight)){
+        session->tx_data = data;
+        session->tx_len = len;
+        session->tx_offset = 0U;
+        session->tx_st = 0U;
+        session->tx_sn = 1U;
+        session->tx_bs = 0U;
+        session->tx_block = 0U;
+        session->tx_waits = 0U;
+        session->tx_state = CAN_ISOTP_SEND;
+        can_isotp_tx_load(isotp, (uint32_t)get_cycle_value());
+        status = SUCCESS;
+    }
+    CAN_INTEN(isotp->can_periph) |= inten;
+
+    return status;
+}
+
+/*!
+    \brief      serve the separation times and the timeouts: loads the
+                consecutive frames whose separation time is over and ends the
+                messages whose flow control or consecutive frame is late
+    \param[in]  isotp: ISO-TP driver state
+    \param[out] none
+    \retval     none
+*/
+void can_isotp_poll(can_isotp_struct *isotp)
+{
+    can_isotp_session_struct *session;
+    uint32_t inten, now, i;
+
+    inten = CAN_INTEN(isotp->can_periph) & CAN_ISOTP_INT;
+    can_interrupt_disable(isotp->can_periph, CAN_ISOTP_INT);
+    now = (uint32_t)get_cycle_value();
+    for(i = 0U; i < isotp->session_num; i++){
+        session = &isotp->sessions[i];
+        /* N_Bs runs from the end of the last frame sent */
+        if((CAN_ISOTP_WAIT_FC == session->tx_state) && (0U == session->tx_inflight)
+           && (0 <= (int32_t)(now - session->tx_deadline))){
+            can_isotp_tx_end(isotp, session, CAN_ISOTP_TIMEOUT);
+        }
+        if((CAN_ISOTP_RECEIVE == session->rx_state) && (0 <= (int32_t)(now - session->rx_deadline))){
+            can_isotp_rx_end(isotp, session, session->rx_offset, CAN_ISOTP_TIMEOUT);
+        }
+    }
+    can_isotp_tx_load(isotp, now);
+    CAN_INTEN(isotp->can_periph) |= inten;
+}
+
+/*!
+    \brief      transmit interrupt service, retires the finished mailboxes and
+                loads the next frames; a frame that ended in an error aborts
+                the message it belongs to
+    \param[in]  isotp: ISO-TP driver state
+    \param[out] none
+    \retval     none
+*/
+void can_isotp_tx_irq_handler(can_isotp_struct *isotp)
+{
+    can_isotp_session_struct *session;
+    uint32_t tstat = CAN_TSTAT(isotp->can_periph);
+    uint32_t now = (uint32_t)get_cycle_value();
+    uint32_t mailbox, finished, owner, fc, sent;
+
+    for(mailbox = 0U; mailbox < CAN_ISOTP_MAILBOX_NUM; mailbox++){
+        finished = CAN_TSTAT_MTF0 << (8U * mailbox);
+        if(0U == (tstat & finished)){
+            continue;
+        }
+        /* MTF written 1 clears the finish flags, the other bits ignore a 0 */
+        CAN_TSTAT(isotp->can_periph) = finished;
+        owner = isotp->mailbox_session[mailbox];
+        if(0U == owner){
+            continue;
+        }
+        /* the mailbox is free before a callback may load it again */
+        fc = isotp->mailbox_fc & BIT(mailbox);
+        isotp->mailbox_session[mailbox] = 0U;
+        isotp->mailbox_fc &= ~BIT(mailbox);
+        session = &isotp->sessions[owner - 1U];
+        sent = tstat & (CAN_TSTAT_MTFNERR0 << (8U * mailbox));
+
+        if(0U != fc){
+            if(CAN_ISOTP_RECEIVE != session->rx_state){
+                continue;
+            }
+            if(0U == sent){
+                can_isotp_rx_end(isotp, session, session->rx_offset, CAN_ISOTP_ABORTED);
+            }else{
+                /* N_Cr runs from the end of the flow control */
+                session->rx_deadline = now + isotp->timeout;
+            }
+            continue;
+        }
+        session->tx_inflight--;
+        if(CAN_ISOTP_IDLE == session->tx_state){
+            continue;
+        }
+        if(0U == sent){
+            can_isotp_tx_end(isotp, session, CAN_ISOTP_ABORTED);
+            continue;
+        }
+        /* the separation time runs from the end of a frame to the start of the next */
+        session->tx_time = now + session->tx_st;
+        if(0U == session->tx_inflight){
+            if(CAN_ISOTP_WAIT_FC == session->tx_state){
+                session->tx_deadline = now + isotp->timeout;
+            }else if(session->tx_offset == session->tx_len){
+                can_isotp_tx_end(isotp, session, CAN_ISOTP_OK);
+            }
+        }
+    }
+    can_isotp_tx_load(isotp, now);
+}
+
+/*!
+    \brief      receive FIFO interrupt service, hands the frames to their
+                sessions; frames of no session, remote frames and frames
+                without data are counted as ignored
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  fifo: CAN_FIFO0 or CAN_FIFO1
+    \param[out] none
+    \retval     none
+*/
+void can_isotp_rx_irq_handler(can_isotp_struct *isotp, uint8_t fifo)
+{
+    can_queue_raw_struct raw[CAN_QUEUE_FIFO_DEPTH];
+    can_isotp_session_struct *session;
+    uint32_t now = (uint32_t)get_cycle_value();
+    uint32_t num, dlen, id, ff, n, i;
+
+    num = can_queue_fifo_take(isotp->can_periph, fifo, raw, &isotp->rx_overrun[fifo]);
+    for(n = 0U; n < num; n++){
+        dlen = GET_RFIFOMP_DLENC(raw[n].mp);
+        ff = raw[n].mi & CAN_RFIFOMI_FF;
+        id = (CAN_FF_STANDARD == ff) ? GET_RFIFOMI_SFID(raw[n].mi) : GET_RFIFOMI_EFID(raw[n].mi);
+        session = NULL;
+        for(i = 0U; i < isotp->session_num; i++){
+            if((isotp->sessions[i].rx_id == id) && ((uint32_t)isotp->sessions[i].ff == ff)){
+                session = &isotp->sessions[i];
+                break;
+            }
+        }
+        if((NULL == session) || (0U != (raw[n].mi & CAN_RFIFOMI_FT)) || (0U == dlen)){
+            isotp->ignored++;
+            continue;
+        }
+        /* data length codes above 8 still mean 8 bytes */
+        can_isotp_frame_receive(isotp, session, (8U < dlen) ? 8U : dlen, raw[n].data0, raw[n].data1, now);
+    }
+    can_isotp_tx_load(isotp, now);
+}
+
+/*!
+    \brief      load the free mailboxes: the pending flow control frames first,
+                then the data frames of the sessions, starting after the
+                session served last so the sessions take turns
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  now: low word of mcycle
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_tx_load(can_isotp_struct *isotp, uint32_t now)
+{
+    uint32_t mailbox, index, n;
+
+    for(mailbox = 0U; mailbox < CAN_ISOTP_MAILBOX_NUM; mailbox++){
+        if(0U != isotp->mailbox_session[mailbox]){
+            continue;
+        }
+        for(index = 0U; index < isotp->session_num; index++){
+            if(CAN_ISOTP_FS_NONE != isotp->sessions[index].rx_fc){
+                break;
+            }
+        }
+        if(index < isotp->session_num){
+            can_isotp_fc_load(isotp, mailbox, index, now);
+            continue;
+        }
+
+        for(n = 0U; n < isotp->session_num; n++){
+            index = (isotp->next + n) % isotp->session_num;
+            if(0U != can_isotp_tx_ready(&isotp->sessions[index], now)){
+                break;
+            }
+        }
+        if(n == isotp->session_num){
+            return;
+        }
+        can_isotp_data_load(isotp, mailbox, index, now);
+        isotp->next = (index + 1U) % isotp->session_num;
+    }
+}
+
+/*!
+    \brief      check whether a session may load its next frame: it is sending,
+                has bytes left and, with a separation time, has no frame in
+                the mailboxes and the time is over
+    \param[in]  session: session
+    \param[in]  now: low word of mcycle
+    \param[out] none
+    \retval     1 if a frame may be loaded, 0 otherwise
+*/
+static uint32_t can_isotp_tx_ready(const can_isotp_session_struct *session, uint32_t now)
+{
+    if((CAN_ISOTP_SEND != session->tx_state) || (session->tx_offset >= session->tx_len)){
+        return 0U;
+    }
+    if((0U != session->tx_st) && ((0U != session->tx_inflight) || (0 > (int32_t)(now - session->tx_time)))){
+        return 0U;
+    }
+    return 1U;
+}
+
+/*!
+    \brief      load the next frame of a session into a mailbox: a single frame
+                for up to 7 bytes, else a first frame, escaped above 4095
+                bytes, and then the consecutive frames; the session waits for
+                a flow control after the first frame and after each block
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  mailbox: free mailbox, 0 to 2
+    \param[in]  index: session
+    \param[in]  now: low word of mcycle
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_data_load(can_isotp_struct *isotp, uint32_t mailbox, uint32_t index, uint32_t now)
+{
+    can_isotp_session_struct *session = &isotp->sessions[index];
+    uint8_t pci[6];
+    uint32_t pci_len, len;
+
+    if(0U == session->tx_offset){
+        if(CAN_ISOTP_SF_MAX >= session->tx_len){
+            pci[0] = (uint8_t)(CAN_ISOTP_PCI_SF | session->tx_len);
+            pci_len = 1U;
+        }else if(CAN_ISOTP_FF_DL_MAX >= session->tx_len){
+            pci[0] = (uint8_t)(CAN_ISOTP_PCI_FF | (session->tx_len >> 8));
+            pci[1] = (uint8_t)session->tx_len;
+            pci_len = 2U;
+        }else{
+            pci[0] = (uint8_t)CAN_ISOTP_PCI_FF;
+            pci[1] = 0U;
+            pci[2] = (uint8_t)(session->tx_len >> 24);
+            pci[3] = (uint8_t)(session->tx_len >> 16);
+            pci[4] = (uint8_t)(session->tx_len >> 8);
+            pci[5] = (uint8_t)session->tx_len;
+            pci_len = 6U;
+        }
+        len = (1U == pci_len) ? session->tx_len : (8U - pci_len);
+        if(1U != pci_len){
+            session->tx_state = CAN_ISOTP_WAIT_FC;
+            session->tx_deadline = now + isotp->timeout;
+        }
+    }else{
+        pci[0] = (uint8_t)(CAN_ISOTP_PCI_CF | session->tx_sn);
+        pci_len = 1U;
+        len = session->tx_len - session->tx_offset;
+        if(CAN_ISOTP_CF_DATA < len){
+            len = CAN_ISOTP_CF_DATA;
+        }
+        session->tx_sn = (session->tx_sn + 1U) & 0x0FU;
+        if((0U != session->tx_bs) && (0U == --session->tx_block) && ((session->tx_offset + len) < session->tx_len)){
+            session->tx_state = CAN_ISOTP_WAIT_FC;
+            session->tx_deadline = now + isotp->timeout;
+        }
+    }
+
+    can_isotp_mailbox_write(isotp->can_periph, mailbox, session, pci, pci_len, &session->tx_data[session->tx_offset], len);
+    session->tx_offset += len;
+    session->tx_inflight++;
+    isotp->mailbox_session[mailbox] = (uint8_t)(index + 1U);
+}
+
+/*!
+    \brief      load the pending flow control frame of a session into a
+                mailbox, with the block size and separation time of the session
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  mailbox: free mailbox, 0 to 2
+    \param[in]  index: session
+    \param[in]  now: low word of mcycle
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_fc_load(can_isotp_struct *isotp, uint32_t mailbox, uint32_t index, uint32_t now)
+{
+    can_isotp_session_struct *session = &isotp->sessions[index];
+    uint8_t pci[3];
+
+    pci[0] = (uint8_t)(CAN_ISOTP_PCI_FC | session->rx_fc);
+    pci[1] = session->block_size;
+    pci[2] = session->st_min;
+    session->rx_fc = CAN_ISOTP_FS_NONE;
+    session->rx_deadline = now + isotp->timeout;
+
+    can_isotp_mailbox_write(isotp->can_periph, mailbox, session, pci, 3U, NULL, 0U);
+    isotp->mailbox_session[mailbox] = (uint8_t)(index + 1U);
+    isotp->mailbox_fc |= BIT(mailbox);
+}
+
+/*!
+    \brief      write a frame into a mailbox and request its transmission; the
+                data bytes are packed into the mailbox registers straight from
+                the buffer of the message
+    \param[in]  can_periph: CANx(x=0,1)
+    \param[in]  mailbox: empty mailbox, 0 to 2
+    \param[in]  session: session sending the frame
+    \param[in]  pci: protocol control information
+    \param[in]  pci_len: bytes of protocol control information
+    \param[in]  data: data bytes
+    \param[in]  len: data bytes, at most 8 with the PCI
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_mailbox_write(uint32_t can_periph, uint32_t mailbox, const can_isotp_session_struct *session,
+                                    const uint8_t *pci, uint32_t pci_len, const uint8_t *data, uint32_t len)
+{
+    can_queue_raw_struct raw;
+    uint32_t word[2] = {0U, 0U};
+    uint32_t dlen = pci_len + len;
+    uint32_t byte, i;
+
+    if(CAN_ISOTP_PADDING_NONE != session->padding){
+        dlen = 8U;
+    }
+    for(i = 0U; i < dlen; i++){
+        if(i < pci_len){
+            byte = pci[i];
+        }else if(i < (pci_len + len)){
+            byte = data[i - pci_len];
+        }else{
+            byte = session->padding;
+        }
+        word[i >> 2] |= byte << (8U * (i & 3U));
+    }
+
+    if((uint8_t)CAN_FF_STANDARD == session->ff){
+        raw.mi = TMI_SFID(session->tx_id) | CAN_FT_DATA;
+    }else{
+        raw.mi = TMI_EFID(session->tx_id) | CAN_FF_EXTENDED | CAN_FT_DATA;
+    }
+    raw.mp = dlen;
+    raw.data0 = word[0];
+    raw.data1 = word[1];
+    can_queue_mailbox_load(can_periph, mailbox, &raw);
+}
+
+/*!
+    \brief      hand a received frame to its session: a single frame is
+                delivered at once, a first frame starts a reception and asks
+                for the consecutive frames; either ends the message being
+                received
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  session: session of the received identifier
+    \param[in]  dlen: data bytes of the frame, 1 to 8
+    \param[in]  data0: data bytes 0 to 3
+    \param[in]  data1: data bytes 4 to 7
+    \param[in]  now: low word of mcycle
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_frame_receive(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t dlen,
+                                    uint32_t data0, uint32_t data1, uint32_t now)
+{
+    uint32_t pci = can_isotp_byte(data0, data1, 0U);
+    uint32_t len, start, n, i;
+
+    switch(pci & 0xF0U){
+    case CAN_ISOTP_PCI_SF:
+        len = pci & 0x0FU;
+        start = 1U;
+        if((0U == len) || (CAN_ISOTP_SF_MAX < len) || (dlen < (start + len))){
+            isotp->ignored++;
+            return;
+        }
+        break;
+    case CAN_ISOTP_PCI_FF:
+        len = ((pci & 0x0FU) << 8) | can_isotp_byte(data0, data1, 1U);
+        start = 2U;
+        if(0U == len){
+            len = (can_isotp_byte(data0, data1, 2U) << 24) | (can_isotp_byte(data0, data1, 3U) << 16)
+                  | (can_isotp_byte(data0, data1, 4U) << 8) | can_isotp_byte(data0, data1, 5U);
+            start = 6U;
+            if(CAN_ISOTP_FF_DL_MAX >= len){
+                isotp->ignored++;
+                return;
+            }
+        }
+        if((8U != dlen) || (CAN_ISOTP_SF_MAX >= len)){
+            isotp->ignored++;
+            return;
+        }
+        break;
+    case CAN_ISOTP_PCI_CF:
+        can_isotp_cf_receive(isotp, session, dlen, data0, data1, now);
+        return;
+    case CAN_ISOTP_PCI_FC:
+        can_isotp_fc_receive(isotp, session, dlen, data0, data1, now);
+        return;
+    default:
+        isotp->ignored++;
+        return;
+    }
+
+    if(CAN_ISOTP_RECEIVE == session->rx_state){
+        can_isotp_rx_end(isotp, session, session->rx_offset, CAN_ISOTP_ABORTED);
+    }
+    if((NULL == session->rx_buffer) || (session->rx_size < len)){
+        if(1U != start){
+            session->rx_fc = CAN_ISOTP_FS_OVFLW;
+        }
+        can_isotp_rx_end(isotp, session, len, CAN_ISOTP_OVERFLOW);
+        return;
+    }
+
+    n = (len < (dlen - start)) ? len : (dlen - start);
+    for(i = 0U; i < n; i++){
+        session->rx_buffer[i] = (uint8_t)can_isotp_byte(data0, data1, start + i);
+    }
+    session->rx_len = len;
+    session->rx_offset = n;
+    if(1U == start){
+        can_isotp_rx_end(isotp, session, len, CAN_ISOTP_OK);
+        return;
+    }
+    session->rx_state = CAN_ISOTP_RECEIVE;
+    session->rx_sn = 1U;
+    session->rx_block = session->block_size;
+    session->rx_fc = CAN_ISOTP_FS_CTS;
+    session->rx_deadline = now + isotp->timeout;
+}
+
+/*!
+    \brief      take a consecutive frame into the receive buffer; a frame out of
+                sequence ends the message, the last frame of a block asks for
+                the next block
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  session: session of the received identifier
+    \param[in]  dlen: data bytes of the frame, 1 to 8
+    \param[in]  data0: data bytes 0 to 3
+    \param[in]  data1: data bytes 4 to 7
+    \param[in]  now: low word of mcycle
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_cf_receive(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t dlen,
+                                 uint32_t data0, uint32_t data1, uint32_t now)
+{
+    uint8_t *dst;
+    uint32_t n, i;
+
+    /* a consecutive frame without a reception is not for this node */
+    if(CAN_ISOTP_RECEIVE != session->rx_state){
+        return;
+    }
+    if((can_isotp_byte(data0, data1, 0U) & 0x0FU) != session->rx_sn){
+        can_isotp_rx_end(isotp, session, session->rx_offset, CAN_ISOTP_WRONG_SN);
+        return;
+    }
+    n = session->rx_len - session->rx_offset;
+    if(CAN_ISOTP_CF_DATA < n){
+        n = CAN_ISOTP_CF_DATA;
+    }
+    if(dlen < (n + 1U)){
+        isotp->ignored++;
+        return;
+    }
+
+    dst = &session->rx_buffer[session->rx_offset];
+    for(i = 0U; i < n; i++){
+        dst[i] = (uint8_t)can_isotp_byte(data0, data1, i + 1U);
+    }
+    session->rx_offset += n;
+    session->rx_sn = (session->rx_sn + 1U) & 0x0FU;
+    session->rx_deadline = now + isotp->timeout;
+    if(session->rx_offset == session->rx_len){
+        can_isotp_rx_end(isotp, session, session->rx_len, CAN_ISOTP_OK);
+    }else if((0U != session->block_size) && (0U == --session->rx_block)){
+        session->rx_block = session->block_size;
+        session->rx_fc = CAN_ISOTP_FS_CTS;
+    }
+}
+
+/*!
+    \brief      apply a flow control frame to the message being sent; it is
+                ignored unless the session waits for one
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  session: session of the received identifier
+    \param[in]  dlen: data bytes of the frame, 1 to 8
+    \param[in]  data0: data bytes 0 to 3
+    \param[in]  data1: data bytes 4 to 7
+    \param[in]  now: low word of mcycle
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_fc_receive(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t dlen,
+                                 uint32_t data0, uint32_t data1, uint32_t now)
+{
+    if(3U > dlen){
+        isotp->ignored++;
+        return;
+    }
+    if(CAN_ISOTP_WAIT_FC != session->tx_state){
+        return;
+    }
+
+    switch(can_isotp_byte(data0, data1, 0U) & 0x0FU){
+    case CAN_ISOTP_FS_CTS:
+        session->tx_bs = (uint8_t)can_isotp_byte(data0, data1, 1U);
+        session->tx_block = session->tx_bs;
+        session->tx_st = can_isotp_st_cycles(isotp, can_isotp_byte(data0, data1, 2U));
+        session->tx_time = now;
+        session->tx_waits = 0U;
+        session->tx_state = CAN_ISOTP_SEND;
+        break;
+    case CAN_ISOTP_FS_WAIT:
+        if(CAN_ISOTP_WAIT_MAX <= session->tx_waits){
+            can_isotp_tx_end(isotp, session, CAN_ISOTP_WAIT_LIMIT);
+        }else{
+            session->tx_waits++;
+            session->tx_deadline = now + isotp->timeout;
+        }
+        break;
+    case CAN_ISOTP_FS_OVFLW:
+        can_isotp_tx_end(isotp, session, CAN_ISOTP_OVERFLOW);
+        break;
+    default:
+        can_isotp_tx_end(isotp, session, CAN_ISOTP_INVALID_FS);
+        break;
+    }
+}
+
+/*!
+    \brief      end the message being sent and report it; frames still in the
+                mailboxes go out, the session takes a new message after them
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  session: session
+    \param[in]  result: outcome of the message
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_tx_end(can_isotp_struct *isotp, can_isotp_session_struct *session, can_isotp_result_enum result)
+{
+    session->tx_state = CAN_ISOTP_IDLE;
+    if(CAN_ISOTP_OK == result){
+        session->tx_messages++;
+    }else{
+        session->tx_errors++;
+    }
+    if(NULL != session->tx_callback){
+        session->tx_callback(isotp, session, result);
+    }
+}
+
+/*!
+    \brief      end the message being received and report it; the callback may
+                replace the receive buffer for the next message
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  session: session
+    \param[in]  len: bytes received, or the length of a message that did not fit
+    \param[in]  result: outcome of the message
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_rx_end(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t len,
+                             can_isotp_result_enum result)
+{
+    session->rx_state = CAN_ISOTP_IDLE;
+    if(CAN_ISOTP_OK == result){
+        session->rx_messages++;
+    }else{
+        session->rx_errors++;
+    }
+    if(NULL != session->rx_callback){
+        session->rx_callback(isotp, session, len, result);
+    }
+}
+
+/*!
+    \brief      convert a separation time to mcycles; the reserved values mean
+                the longest time, 127 ms
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  st_min: separation time, 0x00-0x7F ms or 0xF1-0xF9 100-900 us
+    \param[out] none
+    \retval     separation time in mcycles
+*/
+static uint32_t can_isotp_st_cycles(const can_isotp_struct *isotp, uint32_t st_min)
+{
+    if(0x7FU >= st_min){
+        return st_min * (isotp->clock / 1000U);
+    }
+    if((0xF1U <= st_min) && (0xF9U >= st_min)){
+        return (st_min - 0xF0U) * (isotp->clock / 10000U);
+    }
+    return 0x7FU * (isotp->clock / 1000U);
+}
+
+/*!
+    \brief      get a byte of a received frame from its data registers
+    \param[in]  data0: data bytes 0 to 3
+    \param[in]  data1: data bytes 4 to 7
+    \param[in]  index: byte, 0 to 7
+    \param[out] none
+    \retval     byte
+*/
+static uint32_t can_isotp_byte(uint32_t data0, uint32_t data1, uint32_t index)
+{
+    return (((index < 4U) ? data0 : data1) >> (8U * (index & 3U))) & 0xFFU;
+}
@@ -0,0 +1,511 @@
+/*!
+    \file  gd32vf103_can_queue.c
+    \brief interrupt driven CAN driver with software receive rings and a priority ordered transmit queue
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_can_queue.h"
+#include "n200_func.h"
+
+#define CAN_QUEUE_MAILBOX_NUM           3U
+#define CAN_QUEUE_INT                   (CAN_INT_TME | CAN_INT_RFNE0 | CAN_INT_RFO0 | CAN_INT_RFNE1 | CAN_INT_RFO1)
+
+/* get the arbitration priority of a frame */
+static uint32_t can_queue_key(const can_queue_frame_struct *frame);
+/* check whether a heap entry goes before another */
+static uint32_t can_queue_before(const can_queue_slot_struct *a, const can_queue_slot_struct *b);
+/* add an entry to the transmit heap */
+static void can_queue_heap_push(can_queue_struct *queue, const can_queue_slot_struct *slot);
+/* remove the head of the transmit heap */
+static void can_queue_heap_pop(can_queue_struct *queue);
+/* load the head of the heap into the mailboxes, or stop a mailbox for it */
+static void can_queue_tx_load(can_queue_struct *queue);
+/* write a frame into a mailbox and request its transmission */
+static void can_queue_mailbox_write(uint32_t can_periph, uint32_t mailbox, const can_queue_frame_struct *frame);
+
+/*!
+    \brief      initialize the CAN queues and enable the CAN interrupts; the CAN
+                is initialized and its filters loaded by the caller
+    \param[in]  queue: CAN queue driver state
+    \param[in]  init_struct: the data needed to initialize the queues
+                  can_periph: CANx(x=0,1)
+                  tx_buffer, tx_size: transmit heap storage, 1 to CAN_QUEUE_SIZE_MAX frames
+                  rx_buffer, rx_size: receive ring storage of each FIFO, a power of two up to CAN_QUEUE_SIZE_MAX
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus can_queue_init(can_queue_struct *queue, can_queue_parameter_struct *init_struct)
+{
+    uint32_t fifo;
+
+    if((0U == init_struct->tx_size) || (CAN_QUEUE_SIZE_MAX < init_struct->tx_size)){
+        return ERROR;
+    }
+    for(fifo = 0U; fifo < 2U; fifo++){
+        if((0U == init_struct->rx_size[fifo]) || (0U != (init_struct->rx_size[fifo] & (init_struct->rx_size[fifo] - 1U)))
+           || (CAN_QUEUE_SIZE_MAX < init_struct->rx_size[fifo])){
+            return ERROR;
+        }
+    }
+
+    queue->can_periph = init_struct->can_periph;
+    queue->tx_heap = init_struct->tx_buffer;
+    queue->tx_size = init_struct->tx_size;
+    queue->tx_num = 0U;
+    queue->tx_seq = 0U;
+    queue->mailbox_busy = 0U;
+    queue->mailbox_stop = 0U;
+    queue->tx_sent = 0U;
+    queue->tx_stopped = 0U;
+    queue->tx_failed = 0U;
+    queue->tx_dropped = 0U;
+    queue->tx_callback = NULL;
+    queue->rx_callback = NULL;
+    queue->user_data = NULL;
+    for(fifo = 0U; fifo < 2U; fifo++){
+        queue->rx_buffer[fifo] = init_struct->rx_buffer[fifo];
+        queue->rx_size[fifo] = init_struct->rx_size[fifo];
+        queue->rx_head[fifo] = 0U;
+        queue->rx_tail[fifo] = 0U;
+        queue->rx_dropped[fifo] = 0U;
+        queue->rx_overrun[fifo] = 0U;
+    }
+
+    /* mailboxes go out by identifier, stale finish flags are dropped */
+    CAN_CTL(queue->can_periph) &= ~CAN_CTL_TFO;
+    CAN_TSTAT(queue->can_periph) = CAN_TSTAT_MTF0 | CAN_TSTAT_MTF1 | CAN_TSTAT_MTF2;
+    can_interrupt_enable(queue->can_periph, CAN_QUEUE_INT);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      disable the CAN interrupts of the queues, the mailboxes already
+                loaded are still sent
+    \param[in]  queue: CAN queue driver state
+    \param[out] none
+    \retval     none
+*/
+void can_queue_deinit(can_queue_struct *queue)
+{
+    can_interrupt_disable(queue->can_periph, CAN_QUEUE_INT);
+}
+
+/*!
+    \brief      queue a frame for transmission; it goes into a mailbox at once if
+                its priority allows
+    \param[in]  queue: CAN queue driver state
+    \param[in]  frame: frame to send, the filter index is ignored
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR on a bad frame or a full heap
+*/
+ErrStatus can_queue_transmit(can_queue_struct *queue, const can_queue_frame_struct *frame)
+{
+    can_queue_slot_struct slot;
+    ErrStatus status = ERROR;
+
+    if((8U < frame->dlen) || (((uint8_t)CAN_FF_STANDARD == frame->ff) ? (CAN_SFID_MASK < frame->id) :
+                              (((uint8_t)CAN_FF_EXTENDED != frame->ff) || (CAN_EFID_MASK < frame->id)))){
+        return ERROR;
+    }
+    slot.key = can_queue_key(frame);
+    slot.queued = (uint32_t)get_cycle_value();
+    slot.frame = *frame;
+
+    can_interrupt_disable(queue->can_periph, CAN_INT_TME);
+    /* a stopped mailbox is owed a place to come back to */
+    if((queue->tx_num + ((0U != queue->mailbox_stop) ? 1U : 0U)) < queue->tx_size){
+        slot.seq = queue->tx_seq++;
+        can_queue_heap_push(queue, &slot);
+        can_queue_tx_load(queue);
+        status = SUCCESS;
+    }else{
+        queue->tx_dropped++;
+    }
+    can_interrupt_enable(queue->can_periph, CAN_INT_TME);
+
+    return status;
+}
+
+/*!
+    \brief      get the number of frames queued or in a mailbox
+    \param[in]  queue: CAN queue driver state
+    \param[out] none
+    \retval     number of frames
+*/
+uint32_t can_queue_tx_pending_get(can_queue_struct *queue)
+{
+    uint32_t busy = __atomic_load_n(&queue->mailbox_busy, __ATOMIC_ACQUIRE);
+
+    return __atomic_load_n(&queue->tx_num, __ATOMIC_ACQUIRE) + (busy & 1U) + ((busy >> 1) & 1U) + ((busy >> 2) & 1U);
+}
+
+/*!
+    \brief      take the oldest frame of a receive ring
+    \param[in]  queue: CAN queue driver state
+    \param[in]  fifo: CAN_FIFO0 or CAN_FIFO1
+    \param[out] frame: received frame
+    \retval     ErrStatus: SUCCESS, or ERROR if the ring is empty
+*/
+ErrStatus can_queue_receive(can_queue_struct *queue, uint8_t fifo, can_queue_frame_struct *frame)
+{
+    uint32_t tail;
+
+    if(CAN_FIFO1 < fifo){
+        return ERROR;
+    }
+    tail = queue->rx_tail[fifo];
+    if(tail == __atomic_load_n(&queue->rx_head[fifo], __ATOMIC_ACQUIRE)){
+        return ERROR;
+    }
+    *frame = queue->rx_buffer[fifo][tail & (queue->rx_size[fifo] - 1U)];
+    __atomic_store_n(&queue->rx_tail[fifo], tail + 1U, __ATOMIC_RELEASE);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      get the number of frames in a receive ring
+    \param[in]  queue: CAN queue driver state
+    \param[in]  fifo: CAN_FIFO0 or CAN_FIFO1
+    \param[out] none
+    \retval     number of frames
+*/
+uint32_t can_queue_rx_count_get(can_queue_struct *queue, uint8_t fifo)
+{
+    return __atomic_load_n(&queue->rx_head[fifo], __ATOMIC_ACQUIRE) - queue->rx_tail[fifo];
+}
+
+/*!
+    \brief      transmit interrupt service, retires the finished mailboxes and
+                loads the next frames; a stopped frame that did not go out
+                returns to the heap ahead of the later frames of its identifier
+    \param[in]  queue: CAN queue driver state
+    \param[out] none
+    \retval     none
+*/
+void can_queue_tx_irq_handler(can_queue_struct *queue)
+{
+    uint32_t tstat = CAN_TSTAT(queue->can_periph);
+    uint32_t mailbox, finished;
+
+    for(mailbox = 0U; mailbox < CAN_QUEUE_MAILBOX_NUM; mailbox++){
+        finished = CAN_TSTAT_MTF0 << (8U * mailbox);
+        if(0U == (tstat & finished)){
+            continue;
+        }
+        /* MTF written 1 clears the finish flags, the other bits ignore a 0 */
+        CAN_TSTAT(queue->can_periph) = finished;
+        if(0U == (queue->mailbox_busy & BIT(mailbox))){
+            continue;
+        }
+        if(0U != (tstat & (CAN_TSTAT_MTFNERR0 << (8U * mailbox)))){
+            queue->tx_sent++;
+            if(NULL != queue->tx_callback){
+                queue->mailbox[mailbox].frame.ts = (uint16_t)(CAN_TMP(queue->can_periph, mailbox) >> 16);
+                queue->tx_callback(queue, &queue->mailbox[mailbox]);
+            }
+        }else if(0U != (queue->mailbox_stop & BIT(mailbox))){
+            can_queue_heap_push(queue, &queue->mailbox[mailbox]);
+            queue->tx_stopped++;
+        }else{
+            queue->tx_failed++;
+        }
+        queue->mailbox_stop &= ~BIT(mailbox);
+        __atomic_store_n(&queue->mailbox_busy, queue->mailbox_busy & ~BIT(mailbox), __ATOMIC_RELEASE);
+    }
+    can_queue_tx_load(queue);
+}
+
+/*!
+    \brief      receive FIFO interrupt service, drains the FIFO into its ring;
+                every frame is released from the FIFO and shown to the
+                callback, the ones that find the ring full are counted as
+                dropped
+    \param[in]  queue: CAN queue driver state
+    \param[in]  fifo: CAN_FIFO0 or CAN_FIFO1
+    \param[out] none
+    \retval     none
+*/
+void can_queue_rx_irq_handler(can_queue_struct *queue, uint8_t fifo)
+{
+    can_queue_raw_struct raw[CAN_QUEUE_FIFO_DEPTH];
+    can_queue_frame_struct *slot, dropped;
+    uint32_t mask = queue->rx_size[fifo] - 1U;
+    uint32_t head = queue->rx_head[fifo];
+    uint32_t num, full, i;
+
+    num = can_queue_fifo_take(queue->can_periph, fifo, raw, &queue->rx_overrun[fifo]);
+    for(i = 0U; i < num; i++){
+        full = ((head - __atomic_load_n(&queue->rx_tail[fifo], __ATOMIC_ACQUIRE)) > mask) ? 1U : 0U;
+        if((0U != full) && (NULL == queue->rx_callback)){
+            queue->rx_dropped[fifo]++;
+            continue;
+        }
+        slot = (0U != full) ? &dropped : &queue->rx_buffer[fifo][head & mask];
+        slot->ff = (uint8_t)(raw[i].mi & CAN_RFIFOMI_FF);
+        slot->ft = (uint8_t)(raw[i].mi & CAN_RFIFOMI_FT);
+        slot->id = (CAN_FF_STANDARD == slot->ff) ? GET_RFIFOMI_SFID(raw[i].mi) : GET_RFIFOMI_EFID(raw[i].mi);
+        slot->dlen = (uint8_t)GET_RFIFOMP_DLENC(raw[i].mp);
+        slot->fi = (uint8_t)GET_RFIFOMP_FI(raw[i].mp);
+        slot->data[0] = (uint8_t)raw[i].data0;
+        slot->data[1] = (uint8_t)(raw[i].data0 >> 8);
+        slot->data[2] = (uint8_t)(raw[i].data0 >> 16);
+        slot->data[3] = (uint8_t)(raw[i].data0 >> 24);
+        slot->data[4] = (uint8_t)raw[i].data1;
+        slot->data[5] = (uint8_t)(raw[i].data1 >> 8);
+        slot->data[6] = (uint8_t)(raw[i].data1 >> 16);
+        slot->data[7] = (uint8_t)(raw[i].data1 >> 24);
+        slot->ts = (uint16_t)(raw[i].mp >> 16);
+        if(NULL != queue->rx_callback){
+            queue->rx_callback(queue, slot);
+        }
+        if(0U != full){
+            queue->rx_dropped[fifo]++;
+        }else{
+            head++;
+        }
+    }
+    __atomic_store_n(&queue->rx_head[fifo], head, __ATOMIC_RELEASE);
+}
+
+/*!
+    \brief      write a frame into an empty transmit mailbox and request its
+                transmission, the identifier register last
+    \param[in]  can_periph: CANx(x=0,1)
+    \param[in]  mailbox: empty mailbox, 0 to 2
+    \param[in]  raw: frame in register layout, TEN clear
+    \param[out] none
+    \retval     none
+*/
+void can_queue_mailbox_load(uint32_t can_periph, uint32_t mailbox, const can_queue_raw_struct *raw)
+{
+    CAN_TMP(can_periph, mailbox) = raw->mp & CAN_TMP_DLENC;
+    CAN_TMDATA0(can_periph, mailbox) = raw->data0;
+    CAN_TMDATA1(can_periph, mailbox) = raw->data1;
+    CAN_TMI(can_periph, mailbox) = raw->mi | CAN_TMI_TEN;
+}
+
+/*!
+    \brief      take the frames of a receive FIFO, reading each mailbox register
+                once and releasing the FIFO mailbox after it; an overrun is
+                cleared and counted
+    \param[in]  can_periph: CANx(x=0,1)
+    \param[in]  fifo: CAN_FIFO0 or CAN_FIFO1
+    \param[out] raw: room for CAN_QUEUE_FIFO_DEPTH frames in register layout
+    \param[out] overrun: counter incremented on an overrun
+    \retval     number of frames taken
+*/
+uint32_t can_queue_fifo_take(uint32_t can_periph, uint8_t fifo, can_queue_raw_struct *raw, volatile uint32_t *overrun)
+{
+    volatile uint32_t *rfifo = (CAN_FIFO0 == fifo) ? &CAN_RFIFO0(can_periph) : &CAN_RFIFO1(can_periph);
+    uint32_t stat, num, i;
+
+    /* both FIFO registers have the same layout */
+    stat = *rfifo;
+    if(0U != (stat & CAN_RFIFO0_RFO0)){
+        *rfifo = CAN_RFIFO0_RFO0;
+        (*overrun)++;
+    }
+    num = stat & CAN_RFIFO0_RFL0;
+    for(i = 0U; i < num; i++){
+        raw[i].mi = CAN_RFIFOMI(can_periph, fifo);
+        raw[i].mp = CAN_RFIFOMP(can_periph, fifo);
+        raw[i].data0 = CAN_RFIFOMDATA0(can_periph, fifo);
+        raw[i].data1 = CAN_RFIFOMDATA1(can_periph, fifo);
+        *rfifo = CAN_RFIFO0_RFD0;
+    }
+
+    return num;
+}
+
+/*!
+    \brief      get the arbitration priority of a frame, lower wins: the base
+                identifier, then RTR or SRR, IDE, the identifier extension and
+                the RTR of an extended frame, in the order they are sent
+    \param[in]  frame: frame
+    \param[out] none
+    \retval     arbitration key
+*/
+static uint32_t can_queue_key(const can_queue_frame_struct *frame)
+{
+    uint32_t rtr = ((uint8_t)CAN_FT_REMOTE == frame->ft) ? 1U : 0U;
+
+    if((uint8_t)CAN_FF_STANDARD == frame->ff){
+        return (frame->id << 21) | (rtr << 20);
+    }
+    return ((frame->id >> 18) << 21) | BIT(20) | BIT(19) | ((frame->id & 0x3FFFFU) << 1) | rtr;
+}
+
+/*!
+    \brief      check whether a heap entry goes before another
+    \param[in]  a: heap entry
+    \param[in]  b: heap entry
+    \param[out] none
+    \retval     1 if a goes first, 0 otherwise
+*/
+static uint32_t can_queue_before(const can_queue_slot_struct *a, const can_queue_slot_struct *b)
+{
+    return ((a->key < b->key) || ((a->key == b->key) && ((int32_t)(a->seq - b->seq) < 0))) ? 1U : 0U;
+}
+
+/*!
+    \brief      add an entry to the transmit heap
+    \param[in]  queue: CAN queue driver state
+    \param[in]  slot: entry, copied
+    \param[out] none
+    \retval     none
+*/
+static void can_queue_heap_push(can_queue_struct *queue, const can_queue_slot_struct *slot)
+{
+    can_queue_slot_struct *heap = queue->tx_heap;
+    uint32_t child = queue->tx_num;
+    uint32_t parent;
+
+    /* move the parents down until the entry fits */
+    while(0U != child){
+        parent = (child - 1U) / 2U;
+        if(0U == can_queue_before(slot, &heap[parent])){
+            break;
+        }
+        heap[child] = heap[parent];
+        child = parent;
+    }
+    heap[child] = *slot;
+    __atomic_store_n(&queue->tx_num, queue->tx_num + 1U, __ATOMIC_RELEASE);
+}
+
+/*!
+    \brief      remove the head of the transmit heap
+    \param[in]  queue: CAN queue driver state
+    \param[out] none
+    \retval     none
+*/
+static void can_queue_heap_pop(can_queue_struct *queue)
+{
+    can_queue_slot_struct *heap = queue->tx_heap;
+    uint32_t num = queue->tx_num - 1U;
+    uint32_t parent = 0U;
+    uint32_t child;
+
+    /* the last entry sinks from the top, the earlier child moves up */
+    while(1){
+        child = (2U * parent) + 1U;
+        if(child >= num){
+            break;
+        }
+        if(((child + 1U) < num) && (0U != can_queue_before(&heap[child + 1U], &heap[child]))){
+            child++;
+        }
+        if(0U == can_queue_before(&heap[child], &heap[num])){
+            break;
+        }
+        heap[parent] = heap[child];
+        parent = child;
+    }
+    heap[parent] = heap[num];
+    __atomic_store_n(&queue->tx_num, num, __ATOMIC_RELEASE);
+}
+
+/*!
+    \brief      load the head of the heap into the free mailboxes; with none
+                free, stop the mailbox of lowest priority if the head goes
+                before it, one stop at a time and only while the heap has room
+                for the stopped frame
+    \param[in]  queue: CAN queue driver state
+    \param[out] none
+    \retval     none
+*/
+static void can_queue_tx_load(can_queue_struct *queue)
+{
+    const can_queue_slot_struct *head;
+    uint32_t mailbox, free, worst;
+
+    while(0U != queue->tx_num){
+        head = &queue->tx_heap[0];
+        free = CAN_QUEUE_MAILBOX_NUM;
+        worst = CAN_QUEUE_MAILBOX_NUM;
+        for(mailbox = 0U; mailbox < CAN_QUEUE_MAILBOX_NUM; mailbox++){
+            if(0U == (queue->mailbox_busy & BIT(mailbox))){
+                free = mailbox;
+                continue;
+            }
+            /* the hardware would send equal identifiers by mailbox number, not in order */
+            if(queue->mailbox[mailbox].key == head->key){
+                return;
+            }
+            if((CAN_QUEUE_MAILBOX_NUM == worst) || (queue->mailbox[mailbox].key > queue->mailbox[worst].key)){
+                worst = mailbox;
+            }
+        }
+
+        if(CAN_QUEUE_MAILBOX_NUM != free){
+            queue->mailbox[free] = *head;
+            can_queue_heap_pop(queue);
+            __atomic_store_n(&queue->mailbox_busy, queue->mailbox_busy | BIT(free), __ATOMIC_RELEASE);
+            can_queue_mailbox_write(queue->can_periph, free, &queue->mailbox[free].frame);
+            continue;
+        }
+        /* a full heap has no slot for the stopped frame, the head waits for a mailbox to finish */
+        if((0U == queue->mailbox_stop) && (queue->tx_num < queue->tx_size) && (queue->mailbox[worst].key > head->key)){
+            /* can_transmission_stop() would wait for the stop, it is finished in the interrupt */
+            queue->mailbox_stop = BIT(worst);
+            CAN_TSTAT(queue->can_periph) = CAN_TSTAT_MST0 << (8U * worst);
+        }
+        return;
+    }
+}
+
+/*!
+    \brief      write a frame into a mailbox and request its transmission
+    \param[in]  can_periph: CANx(x=0,1)
+    \param[in]  mailbox: empty mailbox, 0 to 2
+    \param[in]  frame: frame
+    \param[out] none
+    \retval     none
+*/
+static void can_queue_mailbox_write(uint32_t can_periph, uint32_t mailbox, const can_queue_frame_struct *frame)
+{
+    can_queue_raw_struct raw;
+
+    if((uint8_t)CAN_FF_STANDARD == frame->ff){
+        raw.mi = TMI_SFID(frame->id) | frame->ft;
+    }else{
+        raw.mi = TMI_EFID(frame->id) | CAN_FF_EXTENDED | frame->ft;
+    }
+    raw.mp = frame->dlen;
+    raw.data0 = (uint32_t)frame->data[0] | ((uint32_t)frame->data[1] << 8) |
+                ((uint32_t)frame->data[2] << 16) | ((uint32_t)frame->data[3] << 24);
+    raw.data1 = (uint32_t)frame->data[4] | ((uint32_t)frame->data[5] << 8) |
+                ((uint32_t)frame->data[6] << 16) | ((uint32_t)frame->data[7] << 24);
+    can_queue_mailbox_load(can_periph, mailbox, &raw);
+}
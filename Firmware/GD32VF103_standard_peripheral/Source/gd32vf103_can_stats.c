@@ -0,0 +1,540 @@
+/*!
+    \file  gd32vf103_can_stats.c
+    \brief CAN bus load, latency and error statistics
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_can_stats.h"
+#include "gd32vf103_bench.h"
+#include "n200_func.h"
+
+#define CAN_STATS_STAMP_SPAN            65536U                      /*!< bits counted by the 16-bit time stamp */
+#define CAN_STATS_INTERMISSION          3U                          /*!< recessive bits between two frames */
+#define CAN_STATS_STUFF_UNIT            8U                          /*!< one stuff bit in the count of a stuffing state */
+
+/* CRC-15 of a nibble shifted in at the top of a zero register, polynomial 0x4599 */
+static const uint16_t can_stats_crc_table[16] = {
+    0x0000U, 0x4599U, 0x4EABU, 0x0B32U, 0x58CFU, 0x1D56U, 0x1664U, 0x53FDU,
+    0x7407U, 0x319EU, 0x3AACU, 0x7F35U, 0x2CC8U, 0x6951U, 0x6263U, 0x27FAU
+};
+
+/* stuffing state after a nibble: bit 2 last level, bits 1:0 run length - 1,
+   bit 3 a stuff bit inserted; a nibble inserts one stuff bit at most */
+static const uint8_t can_stats_stuff_table[8][16] = {
+    {0x0CU, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x06U, 0x02U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x07U},
+    {0x08U, 0x0DU, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x06U, 0x02U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x07U},
+    {0x09U, 0x0CU, 0x08U, 0x0EU, 0x01U, 0x04U, 0x00U, 0x06U, 0x02U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x07U},
+    {0x0AU, 0x0CU, 0x08U, 0x0DU, 0x09U, 0x0CU, 0x08U, 0x0FU, 0x02U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x07U},
+    {0x03U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x06U, 0x02U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x08U},
+    {0x03U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x06U, 0x02U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x09U, 0x0CU},
+    {0x03U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x06U, 0x02U, 0x04U, 0x00U, 0x05U, 0x0AU, 0x0CU, 0x08U, 0x0DU},
+    {0x03U, 0x04U, 0x00U, 0x05U, 0x01U, 0x04U, 0x00U, 0x06U, 0x0BU, 0x0CU, 0x08U, 0x0DU, 0x09U, 0x0CU, 0x08U, 0x0EU}
+};
+
+/* count a frame for its identifier, the bus load and the error counters */
+static void can_stats_count(can_stats_struct *stats, const can_queue_frame_struct *frame, uint32_t bits);
+/* add a sample to a latency summary */
+static void can_stats_latency_add(can_stats_latency_struct *latency, uint32_t sample);
+/* callback of the transmit interrupt of the queue */
+static void can_stats_tx_callback(can_queue_struct *queue, const can_queue_slot_struct *slot);
+/* callback of the receive interrupts of the queue */
+static void can_stats_rx_callback(can_queue_struct *queue, const can_queue_frame_struct *frame);
+/* run a field through the CRC and the bit stuffing */
+static void can_stats_field_add(uint32_t *crc, uint32_t *stuff, uint32_t value, uint32_t len);
+/* store a little endian value in a snapshot */
+static void can_stats_put(uint8_t *buffer, uint32_t value, uint32_t len);
+
+/*!
+    \brief      attach the statistics to a CAN queue; the CAN is switched to
+                time triggered communication mode if it is not in it yet,
+                going through the initialize working mode, so call it before
+                frames are queued
+    \param[in]  stats: CAN statistics
+    \param[in]  init_struct: the data needed to initialize the statistics
+                  queue: initialized CAN queue, its callbacks and user_data are taken
+                  ids, id_size: identifier table storage, a power of two up to 65536 entries
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus can_stats_init(can_stats_struct *stats, can_stats_parameter_struct *init_struct)
+{
+    can_queue_struct *queue = init_struct->queue;
+    uint32_t bt, i;
+
+    if((0U == init_struct->id_size) || (0U != (init_struct->id_size & (init_struct->id_size - 1U)))
+       || (65536U < init_struct->id_size)){
+        return ERROR;
+    }
+
+    stats->queue = queue;
+    stats->can_periph = queue->can_periph;
+    /* mcycle runs at the AHB clock, the CAN at the APB1 clock */
+    bt = CAN_BT(queue->can_periph);
+    stats->clock = rcu_clock_freq_get(CK_AHB);
+    stats->bit_cycles = (stats->clock / rcu_clock_freq_get(CK_APB1)) * ((bt & CAN_BT_BAUDPSC) + 1U)
+                        * (3U + ((bt & CAN_BT_BS1) >> 16) + ((bt & CAN_BT_BS2) >> 20));
+    stats->ids = init_struct->ids;
+    stats->id_size = init_struct->id_size;
+    stats->id_num = 0U;
+    stats->id_missed = 0U;
+    for(i = 0U; i < stats->id_size; i++){
+        stats->ids[i].id = CAN_STATS_ID_NONE;
+    }
+    stats->frames = 0U;
+    stats->bits = 0U;
+    stats->last_frames = 0U;
+    stats->last_bits = 0U;
+    stats->period = 0U;
+    stats->period_us = 0U;
+    stats->period_frames = 0U;
+    stats->load = 0U;
+    stats->load_max = 0U;
+    stats->phase = 0U;
+    stats->phase_valid = 0U;
+    stats->wait.count = 0U;
+    stats->wait.min = 0xFFFFFFFFU;
+    stats->wait.max = 0U;
+    stats->wait.sum = 0U;
+    stats->total = stats->wait;
+    stats->irq = stats->wait;
+    for(i = 0U; i < CAN_STATS_HISTOGRAM_BINS; i++){
+        stats->histogram[i] = 0U;
+    }
+    stats->tec_max = 0U;
+    stats->rec_max = 0U;
+    stats->error_num = 0U;
+
+    if(0U == (CAN_CTL(stats->can_periph) & CAN_CTL_TTC)){
+        can_working_mode_set(stats->can_periph, CAN_MODE_INITIALIZE);
+        can_time_trigger_mode_enable(stats->can_periph);
+        can_working_mode_set(stats->can_periph, CAN_MODE_NORMAL);
+    }
+    bench_counters_hold();
+    stats->period_start = get_cycle_value();
+
+    queue->user_data = stats;
+    queue->rx_callback = can_stats_rx_callback;
+    queue->tx_callback = can_stats_tx_callback;
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      detach the statistics from their CAN queue, the results stay
+    \param[in]  stats: CAN statistics
+    \param[out] none
+    \retval     none
+*/
+void can_stats_deinit(can_stats_struct *stats)
+{
+    stats->queue->tx_callback = NULL;
+    stats->queue->rx_callback = NULL;
+    stats->queue->user_data = NULL;
+    bench_counters_release();
+}
+
+/*!
+    \brief      close a measurement period: frames per second of each
+                identifier, bus load, and a sample of the error counters
+    \param[in]  stats: CAN statistics
+    \param[out] none
+    \retval     none
+*/
+void can_stats_period(can_stats_struct *stats)
+{
+    uint64_t now = get_cycle_value();
+    uint64_t elapsed = now - stats->period_start;
+    uint32_t frames = stats->frames;
+    uint32_t bits = stats->bits;
+    can_stats_error_struct *sample;
+    uint32_t err, total, i;
+
+    if(0U == elapsed){
+        return;
+    }
+    for(i = 0U; i < stats->id_size; i++){
+        if(CAN_STATS_ID_NONE == __atomic_load_n(&stats->ids[i].id, __ATOMIC_ACQUIRE)){
+            continue;
+        }
+        total = stats->ids[i].frames;
+        stats->ids[i].rate = (uint32_t)((((uint64_t)(total - stats->ids[i].last) * stats->clock) + (elapsed / 2U)) / elapsed);
+        stats->ids[i].last = total;
+    }
+    stats->period_frames = frames - stats->last_frames;
+    stats->last_frames = frames;
+    stats->load = (uint32_t)(((uint64_t)(bits - stats->last_bits) * stats->bit_cycles * 1000U) / elapsed);
+    stats->last_bits = bits;
+    if(stats->load > stats->load_max){
+        stats->load_max = stats->load;
+    }
+    stats->period_us = (uint32_t)((elapsed * 1000000U) / stats->clock);
+    stats->period_start = now;
+    stats->period++;
+
+    err = CAN_ERR(stats->can_periph);
+    sample = &stats->error[stats->error_num & (CAN_STATS_ERROR_DEPTH - 1U)];
+    sample->period = (uint16_t)stats->period;
+    sample->tec = (uint8_t)GET_ERR_TECNT(err);
+    sample->rec = (uint8_t)GET_ERR_RECNT(err);
+    sample->tec_max = (uint8_t)((stats->tec_max > sample->tec) ? stats->tec_max : sample->tec);
+    sample->rec_max = (uint8_t)((stats->rec_max > sample->rec) ? stats->rec_max : sample->rec);
+    sample->state = (uint8_t)(err & (CAN_ERR_WERR | CAN_ERR_PERR | CAN_ERR_BOERR));
+    sample->errn = (uint8_t)GET_ERR_ERRN(err);
+    stats->tec_max = 0U;
+    stats->rec_max = 0U;
+    stats->error_num++;
+}
+
+/*!
+    \brief      find the table entry of an identifier
+    \param[in]  stats: CAN statistics
+    \param[in]  id: standard or extended identifier
+    \param[in]  ff: CAN_FF_STANDARD or CAN_FF_EXTENDED
+    \param[out] none
+    \retval     table entry, NULL if the identifier was not seen
+*/
+const can_stats_id_struct *can_stats_id_find(const can_stats_struct *stats, uint32_t id, uint8_t ff)
+{
+    uint32_t key = id | (((uint8_t)CAN_FF_EXTENDED == ff) ? CAN_STATS_ID_EXT : 0U);
+    uint32_t mask = stats->id_size - 1U;
+    uint32_t index = (key * 0x9E3779B1U) >> 16;
+    uint32_t probe;
+
+    for(probe = 0U; probe < stats->id_size; probe++){
+        if(key == stats->ids[(index + probe) & mask].id){
+            return &stats->ids[(index + probe) & mask];
+        }
+        if(CAN_STATS_ID_NONE == stats->ids[(index + probe) & mask].id){
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*!
+    \brief      pack the statistics into a binary snapshot, laid out as
+                described in gd32vf103_can_stats.h; the error records are
+                kept whole and the identifier records fill the rest
+    \param[in]  stats: CAN statistics
+    \param[in]  size: size of buffer in bytes
+    \param[out] buffer: snapshot
+    \retval     bytes written, 0 if the header does not fit
+*/
+uint32_t can_stats_snapshot(const can_stats_struct *stats, uint8_t *buffer, uint32_t size)
+{
+    const can_stats_error_struct *sample;
+    uint32_t error_num, id_num = 0U, len, i;
+    uint64_t bit_ns;
+
+    if(size < CAN_STATS_SNAPSHOT_HEADER){
+        return 0U;
+    }
+    error_num = (stats->error_num < CAN_STATS_ERROR_DEPTH) ? stats->error_num : CAN_STATS_ERROR_DEPTH;
+    if(error_num > ((size - CAN_STATS_SNAPSHOT_HEADER) / CAN_STATS_SNAPSHOT_RECORD)){
+        error_num = (size - CAN_STATS_SNAPSHOT_HEADER) / CAN_STATS_SNAPSHOT_RECORD;
+    }
+    len = CAN_STATS_SNAPSHOT_HEADER;
+    for(i = 0U; (i < stats->id_size) && (id_num < 255U); i++){
+        if((len + ((error_num + 1U) * CAN_STATS_SNAPSHOT_RECORD)) > size){
+            break;
+        }
+        if(CAN_STATS_ID_NONE == stats->ids[i].id){
+            continue;
+        }
+        can_stats_put(&buffer[len], stats->ids[i].id, 4U);
+        can_stats_put(&buffer[len + 4U], stats->ids[i].rate, 4U);
+        len += CAN_STATS_SNAPSHOT_RECORD;
+        id_num++;
+    }
+    for(i = stats->error_num - error_num; i != stats->error_num; i++){
+        sample = &stats->error[i & (CAN_STATS_ERROR_DEPTH - 1U)];
+        can_stats_put(&buffer[len], sample->period, 2U);
+        buffer[len + 2U] = sample->tec;
+        buffer[len + 3U] = sample->rec;
+        buffer[len + 4U] = sample->tec_max;
+        buffer[len + 5U] = sample->rec_max;
+        buffer[len + 6U] = sample->state;
+        buffer[len + 7U] = sample->errn;
+        len += CAN_STATS_SNAPSHOT_RECORD;
+    }
+
+    bit_ns = ((uint64_t)stats->bit_cycles * 1000000000U) / stats->clock;
+    can_stats_put(&buffer[0], CAN_STATS_SNAPSHOT_MAGIC, 2U);
+    buffer[2] = (uint8_t)CAN_STATS_SNAPSHOT_VERSION;
+    buffer[3] = (uint8_t)id_num;
+    buffer[4] = (uint8_t)error_num;
+    buffer[5] = (0U != stats->error_num) ? stats->error[(stats->error_num - 1U) & (CAN_STATS_ERROR_DEPTH - 1U)].state : 0U;
+    can_stats_put(&buffer[6], (bit_ns > 0xFFFFU) ? 0xFFFFU : (uint32_t)bit_ns, 2U);
+    can_stats_put(&buffer[8], stats->period, 4U);
+    can_stats_put(&buffer[12], stats->period_us, 4U);
+    can_stats_put(&buffer[16], stats->period_frames, 4U);
+    can_stats_put(&buffer[20], stats->load, 2U);
+    can_stats_put(&buffer[22], stats->load_max, 2U);
+    can_stats_put(&buffer[24], stats->id_missed, 4U);
+    can_stats_put(&buffer[28], stats->wait.count, 4U);
+    can_stats_put(&buffer[32], (0U != stats->wait.count) ? stats->wait.min : 0U, 4U);
+    can_stats_put(&buffer[36], stats->wait.max, 4U);
+    can_stats_put(&buffer[40], (0U != stats->wait.count) ? (uint32_t)(stats->wait.sum / stats->wait.count) : 0U, 4U);
+    can_stats_put(&buffer[44], stats->total.count, 4U);
+    can_stats_put(&buffer[48], (0U != stats->total.count) ? stats->total.min : 0U, 4U);
+    can_stats_put(&buffer[52], stats->total.max, 4U);
+    can_stats_put(&buffer[56], (0U != stats->total.count) ? (uint32_t)(stats->total.sum / stats->total.count) : 0U, 4U);
+    can_stats_put(&buffer[60], stats->irq.max, 4U);
+    can_stats_put(&buffer[64], (0U != stats->irq.count) ? (uint32_t)(stats->irq.sum / stats->irq.count) : 0U, 4U);
+    for(i = 0U; i < CAN_STATS_HISTOGRAM_BINS; i++){
+        can_stats_put(&buffer[68U + (2U * i)], (stats->histogram[i] > 0xFFFFU) ? 0xFFFFU : stats->histogram[i], 2U);
+    }
+
+    return len;
+}
+
+/*!
+    \brief      get the number of bits a frame occupies the bus: start of frame
+                to CRC with the stuff bits, the CRC delimiter, ACK slot and
+                delimiter and the end of frame, without the intermission
+    \param[in]  frame: frame
+    \param[out] none
+    \retval     number of bits
+*/
+uint32_t can_stats_frame_bits(const can_queue_frame_struct *frame)
+{
+    uint32_t rtr = ((uint8_t)CAN_FT_REMOTE == frame->ft) ? 1U : 0U;
+    uint32_t dlen = (0U == rtr) ? ((frame->dlen < 8U) ? frame->dlen : 8U) : 0U;
+    /* the start of frame is dominant: a run of one 0, it leaves the CRC at 0 */
+    uint32_t crc = 0U, stuff = 0U, n, i;
+
+    /* arbitration and control fields */
+    if((uint8_t)CAN_FF_STANDARD == frame->ff){
+        can_stats_field_add(&crc, &stuff, frame->id, 11U);
+        can_stats_field_add(&crc, &stuff, rtr << 2, 3U);
+        n = 19U;
+    }else{
+        /* SRR and IDE are recessive, r1 and r0 dominant */
+        can_stats_field_add(&crc, &stuff, frame->id >> 18, 11U);
+        can_stats_field_add(&crc, &stuff, 0x3U, 2U);
+        can_stats_field_add(&crc, &stuff, frame->id, 18U);
+        can_stats_field_add(&crc, &stuff, rtr << 2, 3U);
+        n = 39U;
+    }
+    can_stats_field_add(&crc, &stuff, frame->dlen, 4U);
+    for(i = 0U; i < dlen; i++){
+        can_stats_field_add(&crc, &stuff, frame->data[i], 8U);
+    }
+    /* the CRC is stuffed but not part of its own sum */
+    can_stats_field_add(NULL, &stuff, crc, 15U);
+
+    return n + (8U * dlen) + 15U + (stuff / CAN_STATS_STUFF_UNIT) + 10U;
+}
+
+/*!
+    \brief      count a frame for its identifier, the bus load and the error
+                counters
+    \param[in]  stats: CAN statistics
+    \param[in]  frame: frame sent or received
+    \param[in]  bits: length of the frame on the bus
+    \param[out] none
+    \retval     none
+*/
+static void can_stats_count(can_stats_struct *stats, const can_queue_frame_struct *frame, uint32_t bits)
+{
+    uint32_t key = frame->id | (((uint8_t)CAN_FF_EXTENDED == frame->ff) ? CAN_STATS_ID_EXT : 0U);
+    uint32_t mask = stats->id_size - 1U;
+    uint32_t index = (key * 0x9E3779B1U) >> 16;
+    uint32_t err = CAN_ERR(stats->can_periph);
+    can_stats_id_struct *entry;
+    uint32_t probe;
+
+    for(probe = 0U; probe < stats->id_size; probe++){
+        entry = &stats->ids[(index + probe) & mask];
+        if(key == entry->id){
+            entry->frames++;
+            break;
+        }
+        if(CAN_STATS_ID_NONE == entry->id){
+            /* the identifier goes in last, can_stats_period() skips the entry until then */
+            entry->frames = 1U;
+            entry->last = 0U;
+            entry->rate = 0U;
+            __atomic_store_n(&entry->id, key, __ATOMIC_RELEASE);
+            stats->id_num++;
+            break;
+        }
+    }
+    if(probe == stats->id_size){
+        stats->id_missed++;
+    }
+    stats->frames++;
+    stats->bits += bits + CAN_STATS_INTERMISSION;
+    if(GET_ERR_TECNT(err) > stats->tec_max){
+        stats->tec_max = GET_ERR_TECNT(err);
+    }
+    if(GET_ERR_RECNT(err) > stats->rec_max){
+        stats->rec_max = GET_ERR_RECNT(err);
+    }
+}
+
+/*!
+    \brief      add a sample to a latency summary
+    \param[in]  latency: latency summary
+    \param[in]  sample: sample
+    \param[out] none
+    \retval     none
+*/
+static void can_stats_latency_add(can_stats_latency_struct *latency, uint32_t sample)
+{
+    latency->count++;
+    latency->sum += sample;
+    if(sample < latency->min){
+        latency->min = sample;
+    }
+    if(sample > latency->max){
+        latency->max = sample;
+    }
+}
+
+/*!
+    \brief      callback of the transmit interrupt of the queue: counts the
+                frame, moves the time stamp offset and splits the latency
+    \param[in]  queue: CAN queue
+    \param[in]  slot: frame sent with its submission time
+    \param[out] none
+    \retval     none
+*/
+static void can_stats_tx_callback(can_queue_struct *queue, const can_queue_slot_struct *slot)
+{
+    can_stats_struct *stats = (can_stats_struct *)queue->user_data;
+    uint64_t now = get_cycle_value();
+    uint32_t bits = can_stats_frame_bits(&slot->frame);
+    uint64_t span = (uint64_t)CAN_STATS_STAMP_SPAN * stats->bit_cycles;
+    uint32_t eof, offset, delay, total, bin;
+
+    can_stats_count(stats, &slot->frame, bits);
+
+    /* mcycle of time stamp 0 as seen from this completion, late by the interrupt delay */
+    eof = ((uint32_t)slot->frame.ts + bits) % CAN_STATS_STAMP_SPAN;
+    offset = (uint32_t)(((now % span) + span - ((uint64_t)eof * stats->bit_cycles)) % span);
+    if(0U == stats->phase_valid){
+        stats->phase = offset;
+        stats->phase_valid = 1U;
+    }
+    delay = (uint32_t)(((uint64_t)offset + span - stats->phase) % span);
+    if(delay > (span / 2U)){
+        /* earlier than all completions before, this one was served sooner */
+        stats->phase = offset;
+        delay = 0U;
+    }
+    can_stats_latency_add(&stats->irq, delay);
+
+    total = ((uint32_t)now - slot->queued - delay + (stats->bit_cycles / 2U)) / stats->bit_cycles;
+    can_stats_latency_add(&stats->total, total);
+    can_stats_latency_add(&stats->wait, (total > bits) ? (total - bits) : 0U);
+    bin = 0U;
+    while((bin < (CAN_STATS_HISTOGRAM_BINS - 1U)) && (total >= (64U << bin))){
+        bin++;
+    }
+    stats->histogram[bin]++;
+}
+
+/*!
+    \brief      callback of the receive interrupts of the queue: counts the frame
+    \param[in]  queue: CAN queue
+    \param[in]  frame: frame received
+    \param[out] none
+    \retval     none
+*/
+static void can_stats_rx_callback(can_queue_struct *queue, const can_queue_frame_struct *frame)
+{
+    can_stats_struct *stats = (can_stats_struct *)queue->user_data;
+
+    can_stats_count(stats, frame, can_stats_frame_bits(frame));
+}
+
+/*!
+    \brief      run the low bits of a value, most significant first, through
+                the CRC-15 and count the stuff bits; a nibble at a time with
+                the tables, the remaining bits one by one
+    \param[in]  crc: CRC register, NULL to leave the bits out of the CRC
+    \param[in]  stuff: stuffing state in the low 3 bits, stuff bits counted
+                in units of CAN_STATS_STUFF_UNIT above
+    \param[in]  value: value
+    \param[in]  len: number of bits, up to 32
+    \param[out] crc: CRC register after the bits
+    \param[out] stuff: stuffing state and count after the bits
+    \retval     none
+*/
+static void can_stats_field_add(uint32_t *crc, uint32_t *stuff, uint32_t value, uint32_t len)
+{
+    uint32_t state, bit;
+
+    while(len >= 4U){
+        len -= 4U;
+        bit = (value >> len) & 0xFU;
+        if(NULL != crc){
+            *crc = ((*crc << 4) & 0x7FFFU) ^ can_stats_crc_table[((*crc >> 11) ^ bit) & 0xFU];
+        }
+        *stuff = (*stuff & ~0x7U) + can_stats_stuff_table[*stuff & 0x7U][bit];
+    }
+    while(0U != len){
+        len--;
+        bit = (value >> len) & 1U;
+        if(NULL != crc){
+            *crc = ((*crc << 1) & 0x7FFFU) ^ ((0U != (bit ^ (*crc >> 14))) ? 0x4599U : 0U);
+        }
+        state = *stuff & 0x7U;
+        if(bit != (state >> 2)){
+            state = bit << 2;
+        }else if(3U == (state & 0x3U)){
+            /* fifth equal bit, the stuff bit of the other level starts the next run */
+            state = (CAN_STATS_STUFF_UNIT | 0x4U) ^ (state & 0x4U);
+        }else{
+            state++;
+        }
+        *stuff = (*stuff & ~0x7U) + state;
+    }
+}
+
+/*!
+    \brief      store a little endian value in a snapshot
+    \param[in]  buffer: first byte of the field
+    \param[in]  value: value
+    \param[in]  len: size of the field in bytes
+    \param[out] none
+    \retval     none
+*/
+static void can_stats_put(uint8_t *buffer, uint32_t value, uint32_t len)
+{
+    uint32_t i;
+
+    for(i = 0U; i < len; i++){
+        buffer[i] = (uint8_t)(value >> (8U * i));
+    }
+}
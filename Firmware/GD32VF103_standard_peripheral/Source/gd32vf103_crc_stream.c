@@ -0,0 +1,247 @@
+/*!
+    \file  gd32vf103_crc_stream.c
+    \brief CRC streaming driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_crc_stream.h"
+#include "gd32vf103_dma_job.h"
+
+#define CRC_STREAM_POLY                 ((uint32_t)0x04C11DB7U)     /*!< polynomial of the CRC unit */
+
+/* start the next part of a DMA run */
+static void crc_stream_dma_next(crc_stream_struct *stream);
+
+/*!
+    \brief      reset the CRC unit and start a stream
+    \param[in]  stream: CRC stream state
+    \param[out] none
+    \retval     none
+*/
+void crc_stream_init(crc_stream_struct *stream)
+{
+    stream->dma_periph = 0U;
+    stream->channelx = DMA_CH0;
+    stream->dma_threshold = CRC_STREAM_DMA_THRESHOLD;
+    stream->dma_next = NULL;
+    stream->dma_remain = 0U;
+    stream->dma_busy = 0U;
+    stream->partial = 0U;
+    stream->partial_len = 0U;
+
+    crc_data_register_reset();
+}
+
+/*!
+    \brief      let the stream feed long word runs through a memory to memory DMA channel
+    \param[in]  stream: CRC stream state
+    \param[in]  dma_periph: DMAx(x=0,1), or 0 to feed every word by the CPU
+    \param[in]  channelx: specify which DMA channel feeds CRC_DATA
+                only one parameter can be selected which is shown as below:
+      \arg        DMA0: DMA_CHx(x=0..6), DMA1: DMA_CHx(x=0..4)
+    \param[in]  threshold: shortest run in words handed to the DMA
+    \param[out] none
+    \retval     none
+*/
+void crc_stream_dma_config(crc_stream_struct *stream, uint32_t dma_periph, dma_channel_enum channelx, uint32_t threshold)
+{
+    crc_stream_wait(stream);
+
+    stream->dma_periph = dma_periph;
+    stream->channelx = channelx;
+    stream->dma_threshold = (0U == threshold) ? 1U : threshold;
+}
+
+/*!
+    \brief      add bytes to the stream and wait until they are processed
+    \param[in]  stream: CRC stream state
+    \param[in]  data: bytes to add, any alignment
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     none
+*/
+void crc_stream_update(crc_stream_struct *stream, const void *data, uint32_t len)
+{
+    crc_stream_update_start(stream, data, len);
+    crc_stream_wait(stream);
+}
+
+/*!
+    \brief      add bytes to the stream, a DMA run keeps going in the background
+                and the data must stay unchanged until crc_stream_busy returns RESET
+    \param[in]  stream: CRC stream state
+    \param[in]  data: bytes to add, any alignment
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     none
+*/
+void crc_stream_update_start(crc_stream_struct *stream, const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint32_t words, index;
+
+    /* the words of an earlier DMA run come first */
+    crc_stream_wait(stream);
+
+    /* complete the partial word left by the previous update */
+    while((0U != stream->partial_len) && (0U != len)){
+        stream->partial |= (uint32_t)*p++ << (8U * stream->partial_len);
+        stream->partial_len++;
+        len--;
+        if(4U == stream->partial_len){
+            CRC_DATA = stream->partial;
+            stream->partial = 0U;
+            stream->partial_len = 0U;
+        }
+    }
+
+    words = len / 4U;
+    if(0U != words){
+        if(0U != ((uint32_t)p & 0x3U)){
+            /* the stream words are not aligned in memory, assemble them from bytes */
+            for(index = 0U; index < words; index++){
+                CRC_DATA = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+                p += 4;
+            }
+        }else if((0U != stream->dma_periph) && (words >= stream->dma_threshold)){
+            stream->dma_next = (const uint32_t *)p;
+            stream->dma_remain = words;
+            crc_stream_dma_next(stream);
+            p += 4U * words;
+        }else{
+            for(index = 0U; index < words; index++){
+                CRC_DATA = ((const uint32_t *)p)[index];
+            }
+            p += 4U * words;
+        }
+        len -= 4U * words;
+    }
+
+    /* keep the tail, it is fed once the stream goes on or ends */
+    while(0U != len){
+        stream->partial |= (uint32_t)*p++ << (8U * stream->partial_len);
+        stream->partial_len++;
+        len--;
+    }
+}
+
+/*!
+    \brief      check whether a DMA run of the stream is still going
+    \param[in]  stream: CRC stream state
+    \param[out] none
+    \retval     FlagStatus: SET or RESET
+*/
+FlagStatus crc_stream_busy(crc_stream_struct *stream)
+{
+    if(0U == stream->dma_busy){
+        return RESET;
+    }
+    if(RESET == dma_flag_get(stream->dma_periph, stream->channelx, DMA_FLAG_FTF)){
+        return SET;
+    }
+    if(0U != stream->dma_remain){
+        crc_stream_dma_next(stream);
+        return SET;
+    }
+
+    DMA_CHCTL(stream->dma_periph, stream->channelx) = DMA_CHCTL_RESET_VALUE;
+    dma_flag_clear(stream->dma_periph, stream->channelx, DMA_FLAG_G);
+    stream->dma_busy = 0U;
+
+    return RESET;
+}
+
+/*!
+    \brief      wait for the DMA run of the stream to end
+    \param[in]  stream: CRC stream state
+    \param[out] none
+    \retval     none
+*/
+void crc_stream_wait(crc_stream_struct *stream)
+{
+    while(SET == crc_stream_busy(stream)){
+    }
+}
+
+/*!
+    \brief      finish the stream and get its CRC value
+    \param[in]  stream: CRC stream state
+    \param[out] none
+    \retval     32-bit CRC value of the stream
+*/
+uint32_t crc_stream_final(crc_stream_struct *stream)
+{
+    uint32_t crc, bit;
+    uint32_t index = stream->partial_len;
+
+    crc_stream_wait(stream);
+    crc = CRC_DATA;
+
+    /* partial word, most significant byte first like the hardware */
+    while(0U != index){
+        index--;
+        crc ^= ((stream->partial >> (8U * index)) & 0xFFU) << 24;
+        for(bit = 0U; bit < 8U; bit++){
+            crc = (0U != (crc & 0x80000000U)) ? ((crc << 1) ^ CRC_STREAM_POLY) : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/*!
+    \brief      start the next part of a DMA run
+    \param[in]  stream: CRC stream state
+    \param[out] none
+    \retval     none
+*/
+static void crc_stream_dma_next(crc_stream_struct *stream)
+{
+    dma_job_struct job;
+    uint32_t number = stream->dma_remain;
+
+    if(number > DMA_CHANNEL_CNT_MASK){
+        number = DMA_CHANNEL_CNT_MASK;
+    }
+
+    /* memory to CRC_DATA, polled, so no channel interrupt is enabled */
+    job.ctl = DMA_CHXCTL_M2M | DMA_CHXCTL_DIR | DMA_CHXCTL_MNAGA | DMA_PERIPHERAL_WIDTH_32BIT
+              | DMA_MEMORY_WIDTH_32BIT | DMA_PRIORITY_LOW;
+    job.periph_addr = (uint32_t)&CRC_DATA;
+    job.memory_addr = (uint32_t)stream->dma_next;
+    job.number = number;
+    dma_job_commit(stream->dma_periph, stream->channelx, &job);
+
+    stream->dma_next += number;
+    stream->dma_remain -= number;
+    stream->dma_busy = 1U;
+}
@@ -0,0 +1,368 @@
+/*!
+    \file  gd32vf103_dac_stream.c
+    \brief timer paced DAC waveform stream
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_dac_stream.h"
+#include "gd32vf103_rcu.h"
+#include "gd32vf103_timer.h"
+
+/* configure the pacing timer for a sample rate */
+static ErrStatus dac_stream_timer_config(dac_stream_struct *stream, uint32_t sample_rate);
+/* get the number of samples of one output point */
+static uint32_t dac_stream_point(dac_stream_struct *stream);
+/* get the number of samples the DMA has moved since the start of the buffer */
+static uint32_t dac_stream_position(dac_stream_struct *stream);
+/* hand one half of the buffer to the callback */
+static void dac_stream_half(dac_stream_struct *stream, uint32_t offset);
+
+/*!
+    \brief      configure the DAC, the DMA channel and the pacing timer of a
+                stream, the stream starts with dac_stream_start
+    \param[in]  stream: DAC stream
+    \param[in]  init_struct: the data needed to initialize the stream
+                  output: DAC_STREAM_OUTPUT_DAC0, DAC_STREAM_OUTPUT_DAC1, DAC_STREAM_OUTPUT_CONCURRENT
+                  timer_periph: TIMERx(x=5,6), its update event triggers the DAC
+                  sample_rate: samples per second of each output, the timer runs at the nearest rate it can make
+                  buffer, size: table or storage of both halves, size in samples; a whole number of output points,
+                    and of two points when streaming, up to DAC_STREAM_SIZE_MAX DMA transfers
+                  callback: producer of the halves, called from the DMA interrupt; NULL to loop the table
+                  user_data: free for the application
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus dac_stream_init(dac_stream_struct *stream, dac_stream_parameter_struct *init_struct)
+{
+    dma_parameter_struct dma_init_struct;
+    uint32_t trigger, point;
+
+    if(TIMER5 == init_struct->timer_periph){
+        trigger = DAC_TRIGGER_T5_TRGO;
+    }else if(TIMER6 == init_struct->timer_periph){
+        trigger = DAC_TRIGGER_T6_TRGO;
+    }else{
+        return ERROR;
+    }
+    if(DAC_STREAM_OUTPUT_CONCURRENT < init_struct->output){
+        return ERROR;
+    }
+
+    stream->output = init_struct->output;
+    point = dac_stream_point(stream);
+    /* streaming splits the buffer into two halves of whole points */
+    if(NULL != init_struct->callback){
+        point <<= 1U;
+    }
+    if((0U == init_struct->size) || (0U != (init_struct->size % point))
+       || (DAC_STREAM_SIZE_MAX < (init_struct->size / dac_stream_point(stream)))){
+        return ERROR;
+    }
+
+    stream->timer_periph = init_struct->timer_periph;
+    stream->dma_periph = DMA1;
+    stream->channelx = (DAC_STREAM_OUTPUT_DAC1 == stream->output) ? DMA_CH3 : DMA_CH2;
+    stream->buffer = init_struct->buffer;
+    stream->size = init_struct->size;
+    stream->transfers = stream->size / dac_stream_point(stream);
+    stream->callback = init_struct->callback;
+    stream->user_data = init_struct->user_data;
+    stream->state = DAC_STREAM_IDLE;
+    stream->halves = 0U;
+    stream->underrun = 0U;
+
+    /* the update event of timer_init must not reach an armed DAC */
+    if(DAC_STREAM_OUTPUT_DAC1 != stream->output){
+        dac_disable(DAC0);
+    }
+    if(DAC_STREAM_OUTPUT_DAC0 != stream->output){
+        dac_disable(DAC1);
+    }
+    if(ERROR == dac_stream_timer_config(stream, init_struct->sample_rate)){
+        return ERROR;
+    }
+
+    if(DAC_STREAM_OUTPUT_DAC1 != stream->output){
+        dac_wave_mode_config(DAC0, DAC_WAVE_DISABLE);
+        dac_trigger_source_config(DAC0, trigger);
+        dac_trigger_enable(DAC0);
+        dac_output_buffer_enable(DAC0);
+        /* in concurrent mode the DAC0 request moves the pair of both DACs */
+        dac_dma_enable(DAC0);
+    }
+    if(DAC_STREAM_OUTPUT_DAC0 != stream->output){
+        dac_wave_mode_config(DAC1, DAC_WAVE_DISABLE);
+        dac_trigger_source_config(DAC1, trigger);
+        dac_trigger_enable(DAC1);
+        dac_output_buffer_enable(DAC1);
+        if(DAC_STREAM_OUTPUT_DAC1 == stream->output){
+            dac_dma_enable(DAC1);
+        }else{
+            dac_dma_disable(DAC1);
+        }
+    }
+
+    /* one circular transfer over the buffer, reloaded by the DMA itself */
+    dma_deinit(stream->dma_periph, stream->channelx);
+    dma_init_struct.direction = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr = (uint32_t)stream->buffer;
+    dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.number = stream->transfers;
+    dma_init_struct.periph_inc = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.priority = DMA_PRIORITY_HIGH;
+    if(DAC_STREAM_OUTPUT_CONCURRENT == stream->output){
+        dma_init_struct.memory_width = DMA_MEMORY_WIDTH_32BIT;
+        dma_init_struct.periph_addr = (uint32_t)&DACC_R12DH;
+        dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_32BIT;
+    }else{
+        dma_init_struct.memory_width = DMA_MEMORY_WIDTH_16BIT;
+        dma_init_struct.periph_addr = (DAC_STREAM_OUTPUT_DAC0 == stream->output) ? (uint32_t)&DAC0_R12DH
+                                                                                  : (uint32_t)&DAC1_R12DH;
+        dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_16BIT;
+    }
+    dma_init(stream->dma_periph, stream->channelx, &dma_init_struct);
+    dma_circulation_enable(stream->dma_periph, stream->channelx);
+    dma_memory_to_memory_disable(stream->dma_periph, stream->channelx);
+    if(NULL != stream->callback){
+        dma_interrupt_enable(stream->dma_periph, stream->channelx, DMA_INT_HTF | DMA_INT_FTF | DMA_INT_ERR);
+    }else{
+        dma_interrupt_enable(stream->dma_periph, stream->channelx, DMA_INT_ERR);
+    }
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      start the output, a streaming output asks the callback for both
+                halves before the timer starts; the first trigger outputs the
+                level preloaded into the holding register, the last point of a
+                table so that it loops without a seam, the first point of a stream
+    \param[in]  stream: DAC stream
+    \param[out] none
+    \retval     none
+*/
+void dac_stream_start(dac_stream_struct *stream)
+{
+    uint32_t point = dac_stream_point(stream);
+    uint16_t *preload = stream->buffer;
+
+    if(NULL != stream->callback){
+        dac_stream_half(stream, 0U);
+        dac_stream_half(stream, stream->size >> 1U);
+    }else{
+        preload = &stream->buffer[stream->size - point];
+    }
+
+    timer_disable(stream->timer_periph);
+    timer_counter_value_config(stream->timer_periph, 0U);
+
+    if(DAC_STREAM_OUTPUT_CONCURRENT == stream->output){
+        dac_concurrent_data_set(DAC_ALIGN_12B_R, preload[0], preload[1]);
+        dac_concurrent_enable();
+    }else{
+        dac_data_set(stream->output, DAC_ALIGN_12B_R, preload[0]);
+        dac_enable(stream->output);
+    }
+
+    /* restart at the start of the buffer, also after dac_stream_stop */
+    dma_channel_disable(stream->dma_periph, stream->channelx);
+    dma_interrupt_flag_clear(stream->dma_periph, stream->channelx, DMA_INT_FLAG_G);
+    dma_transfer_number_config(stream->dma_periph, stream->channelx, stream->transfers);
+    stream->state = DAC_STREAM_RUNNING;
+    dma_channel_enable(stream->dma_periph, stream->channelx);
+
+    timer_enable(stream->timer_periph);
+}
+
+/*!
+    \brief      stop the pacing timer and the DMA channel, the outputs keep the
+                level of the last trigger
+    \param[in]  stream: DAC stream
+    \param[out] none
+    \retval     none
+*/
+void dac_stream_stop(dac_stream_struct *stream)
+{
+    timer_disable(stream->timer_periph);
+    dma_channel_disable(stream->dma_periph, stream->channelx);
+    dma_interrupt_flag_clear(stream->dma_periph, stream->channelx, DMA_INT_FLAG_G);
+    if(DAC_STREAM_RUNNING == stream->state){
+        stream->state = DAC_STREAM_IDLE;
+    }
+}
+
+/*!
+    \brief      DMA channel interrupt service, hands the half the DMA is not in
+                to the callback; the half is picked by the DMA position rather
+                than by the flags, so a late interrupt still refills the right one
+    \param[in]  stream: DAC stream
+    \param[out] none
+    \retval     none
+*/
+void dac_stream_dma_irq_handler(dac_stream_struct *stream)
+{
+    uint32_t half = stream->size >> 1U;
+    uint32_t position, offset;
+    FlagStatus htf, ftf;
+
+    if(RESET != dma_interrupt_flag_get(stream->dma_periph, stream->channelx, DMA_INT_FLAG_ERR)){
+        dac_stream_stop(stream);
+        stream->state = DAC_STREAM_ERROR;
+        return;
+    }
+    htf = dma_interrupt_flag_get(stream->dma_periph, stream->channelx, DMA_INT_FLAG_HTF);
+    ftf = dma_interrupt_flag_get(stream->dma_periph, stream->channelx, DMA_INT_FLAG_FTF);
+    if((RESET == htf) && (RESET == ftf)){
+        return;
+    }
+    dma_interrupt_flag_clear(stream->dma_periph, stream->channelx, DMA_INT_FLAG_G);
+    if(NULL == stream->callback){
+        return;
+    }
+
+    /* both events pending: a whole half went by without being refilled */
+    if((RESET != htf) && (RESET != ftf)){
+        stream->underrun++;
+    }
+
+    position = dac_stream_position(stream);
+    offset = (position < half) ? half : 0U;
+    dac_stream_half(stream, offset);
+
+    /* the DMA must not have reached the half while the callback worked on it */
+    position = dac_stream_position(stream);
+    if((position >= offset) && (position < (offset + half))){
+        stream->underrun++;
+    }
+}
+
+/*!
+    \brief      configure the pacing timer for a sample rate, the timer clock
+                is CK_APB1, doubled when the APB1 prescaler divides
+    \param[in]  stream: DAC stream, timer_periph set
+    \param[in]  sample_rate: samples per second
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if the timer cannot make the rate
+*/
+static ErrStatus dac_stream_timer_config(dac_stream_struct *stream, uint32_t sample_rate)
+{
+    timer_parameter_struct timer_init_struct;
+    uint32_t timer_clock = rcu_clock_freq_get(CK_APB1);
+    uint32_t ticks, prescaler, period;
+
+    if(RCU_APB1_CKAHB_DIV1 != (RCU_CFG0 & RCU_CFG0_APB1PSC)){
+        timer_clock <<= 1U;
+    }
+    if(0U == sample_rate){
+        return ERROR;
+    }
+    ticks = (timer_clock + (sample_rate >> 1U)) / sample_rate;
+    if(2U > ticks){
+        return ERROR;
+    }
+    /* smallest prescaler that fits the period into the 16-bit counter */
+    prescaler = (ticks - 1U) >> 16U;
+    period = (ticks + ((prescaler + 1U) >> 1U)) / (prescaler + 1U);
+    if(65536U < period){
+        period = 65536U;
+    }
+    stream->sample_rate = timer_clock / ((prescaler + 1U) * period);
+
+    timer_disable(stream->timer_periph);
+    timer_struct_para_init(&timer_init_struct);
+    timer_init_struct.prescaler = (uint16_t)prescaler;
+    timer_init_struct.period = period - 1U;
+    timer_init(stream->timer_periph, &timer_init_struct);
+    timer_auto_reload_shadow_enable(stream->timer_periph);
+    timer_master_output_trigger_source_select(stream->timer_periph, TIMER_TRI_OUT_SRC_UPDATE);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      get the number of samples of one output point
+    \param[in]  stream: DAC stream, output set
+    \param[out] none
+    \retval     2 in concurrent mode, 1 otherwise
+*/
+static uint32_t dac_stream_point(dac_stream_struct *stream)
+{
+    return (DAC_STREAM_OUTPUT_CONCURRENT == stream->output) ? 2U : 1U;
+}
+
+/*!
+    \brief      get the number of samples the DMA has moved since the start of the buffer
+    \param[in]  stream: DAC stream
+    \param[out] none
+    \retval     position of the DMA in samples
+*/
+static uint32_t dac_stream_position(dac_stream_struct *stream)
+{
+    uint32_t transfers = stream->transfers - dma_transfer_number_get(stream->dma_periph, stream->channelx);
+
+    return transfers * dac_stream_point(stream);
+}
+
+/*!
+    \brief      hand one half of the buffer to the callback, the part of the
+                half the callback left empty holds the last level it produced
+    \param[in]  stream: DAC stream
+    \param[in]  offset: first sample of the half
+    \param[out] none
+    \retval     none
+*/
+static void dac_stream_half(dac_stream_struct *stream, uint32_t offset)
+{
+    uint32_t half = stream->size >> 1U;
+    uint32_t point = dac_stream_point(stream);
+    uint16_t *data = &stream->buffer[offset];
+    const uint16_t *last;
+    uint32_t len;
+
+    len = stream->callback(stream, data, half);
+    if(len > half){
+        len = half;
+    }
+    len -= len % point;
+    if(len < half){
+        /* hold the level instead of stepping to zero */
+        last = (0U != len) ? &data[len - point] : &stream->buffer[((offset + stream->size) - point) % stream->size];
+        for(; len < half; len += point){
+            data[len] = last[0];
+            if(2U == point){
+                data[len + 1U] = last[1];
+            }
+        }
+        stream->underrun++;
+    }
+    stream->halves++;
+}
@@ -0,0 +1,271 @@
+/*!
+    \file  gd32vf103_dma_job.c
+    \brief DMA job queue driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_dma_job.h"
+
+/* start the oldest queued job if the channel is idle */
+static void dma_queue_kick(dma_queue_struct *queue);
+
+/*!
+    \brief      compute the register values of a DMA job
+    \param[in]  job: DMA job descriptor
+    \param[in]  init_struct: the data needed to initialize the transfer
+                  periph_addr: peripheral base address
+                  periph_width: DMA_PERIPHERAL_WIDTH_8BIT, DMA_PERIPHERAL_WIDTH_16BIT, DMA_PERIPHERAL_WIDTH_32BIT
+                  periph_inc: DMA_PERIPH_INCREASE_ENABLE, DMA_PERIPH_INCREASE_DISABLE
+                  memory_addr: memory base address
+                  memory_width: DMA_MEMORY_WIDTH_8BIT, DMA_MEMORY_WIDTH_16BIT, DMA_MEMORY_WIDTH_32BIT
+                  memory_inc: DMA_MEMORY_INCREASE_ENABLE, DMA_MEMORY_INCREASE_DISABLE
+                  direction: DMA_PERIPHERAL_TO_MEMORY, DMA_MEMORY_TO_PERIPHERAL
+                  number: the number of remaining data to be transferred by the DMA, 1 to 65535;
+                          a job of 0 never finishes and is refused by dma_queue_submit
+                  priority: DMA_PRIORITY_LOW, DMA_PRIORITY_MEDIUM, DMA_PRIORITY_HIGH, DMA_PRIORITY_ULTRA_HIGH
+    \param[in]  m2m: memory to memory mode
+                only one parameter can be selected which is shown as below:
+      \arg        DMA_MEMORY_TO_MEMORY_ENABLE, DMA_MEMORY_TO_MEMORY_DISABLE
+    \param[in]  callback: called from the DMA interrupt when the job ends, or NULL
+    \param[out] none
+    \retval     none
+*/
+void dma_job_prepare(dma_job_struct *job, dma_parameter_struct *init_struct, uint32_t m2m, void (*callback)(dma_job_struct *job))
+{
+    uint32_t ctl;
+
+    /* the queue needs the full transfer finish and error interrupts to chain */
+    ctl = DMA_CHXCTL_FTFIE | DMA_CHXCTL_ERRIE;
+    ctl |= (init_struct->periph_width | init_struct->memory_width | init_struct->priority);
+    if(DMA_PERIPH_INCREASE_ENABLE == init_struct->periph_inc){
+        ctl |= DMA_CHXCTL_PNAGA;
+    }
+    if(DMA_MEMORY_INCREASE_ENABLE == init_struct->memory_inc){
+        ctl |= DMA_CHXCTL_MNAGA;
+    }
+    if(DMA_MEMORY_TO_PERIPHERAL == init_struct->direction){
+        ctl |= DMA_CHXCTL_DIR;
+    }
+    if(DMA_MEMORY_TO_MEMORY_ENABLE == m2m){
+        ctl |= DMA_CHXCTL_M2M;
+    }
+
+    job->ctl = ctl;
+    job->periph_addr = init_struct->periph_addr;
+    job->memory_addr = init_struct->memory_addr;
+    job->number = init_struct->number & DMA_CHANNEL_CNT_MASK;
+    job->callback = callback;
+    job->status = DMA_JOB_IDLE;
+}
+
+/*!
+    \brief      commit a prepared job to a DMA channel and start it
+    \param[in]  dma_periph: DMAx(x=0,1)
+      \arg        DMAx(x=0,1)
+    \param[in]  channelx: specify which DMA channel runs the job
+                only one parameter can be selected which is shown as below:
+      \arg        DMA0: DMA_CHx(x=0..6), DMA1: DMA_CHx(x=0..4)
+    \param[in]  job: DMA job descriptor prepared by dma_job_prepare
+    \param[out] none
+    \retval     none
+*/
+void dma_job_commit(uint32_t dma_periph, dma_channel_enum channelx, const dma_job_struct *job)
+{
+    /* the address and counter registers are only writable with CHEN cleared */
+    DMA_CHCTL(dma_periph, channelx) = DMA_CHCTL_RESET_VALUE;
+    DMA_INTC(dma_periph) = DMA_FLAG_ADD(DMA_CHINTF_RESET_VALUE, channelx);
+    DMA_CHPADDR(dma_periph, channelx) = job->periph_addr;
+    DMA_CHMADDR(dma_periph, channelx) = job->memory_addr;
+    DMA_CHCNT(dma_periph, channelx) = job->number;
+    DMA_CHCTL(dma_periph, channelx) = job->ctl | DMA_CHXCTL_CHEN;
+}
+
+/*!
+    \brief      initialize a DMA job queue on a channel
+    \param[in]  queue: DMA job queue
+    \param[in]  dma_periph: DMAx(x=0,1)
+      \arg        DMAx(x=0,1)
+    \param[in]  channelx: specify which DMA channel is owned by the queue
+                only one parameter can be selected which is shown as below:
+      \arg        DMA0: DMA_CHx(x=0..6), DMA1: DMA_CHx(x=0..4)
+    \param[in]  slots: queue storage of size job pointers
+    \param[in]  size: number of slots, a power of two
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus dma_queue_init(dma_queue_struct *queue, uint32_t dma_periph, dma_channel_enum channelx, dma_job_struct **slots, uint32_t size)
+{
+    if((0U == size) || (0U != (size & (size - 1U)))){
+        return ERROR;
+    }
+    if((DMA1 == dma_periph) && (channelx > DMA_CH4)){
+        return ERROR;
+    }
+
+    queue->dma_periph = dma_periph;
+    queue->channelx = channelx;
+    queue->slots = slots;
+    queue->size = size;
+    queue->head = 0U;
+    queue->tail = 0U;
+    queue->busy = 0U;
+
+    DMA_CHCTL(dma_periph, channelx) = DMA_CHCTL_RESET_VALUE;
+    DMA_INTC(dma_periph) = DMA_FLAG_ADD(DMA_CHINTF_RESET_VALUE, channelx);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      append a job to a queue, it starts at once if the channel is idle
+    \param[in]  queue: DMA job queue
+    \param[in]  job: DMA job descriptor prepared by dma_job_prepare, not queued elsewhere
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if the queue is full, the job is still
+                queued or it has no data to transfer
+*/
+ErrStatus dma_queue_submit(dma_queue_struct *queue, dma_job_struct *job)
+{
+    uint32_t head = queue->head;
+
+    if((DMA_JOB_QUEUED == job->status) || (DMA_JOB_ACTIVE == job->status)){
+        return ERROR;
+    }
+    /* a zero count, also 65536 cut down by the counter mask, never raises FTF and would stall the queue */
+    if(0U == job->number){
+        return ERROR;
+    }
+    if((head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) == queue->size){
+        return ERROR;
+    }
+
+    job->status = DMA_JOB_QUEUED;
+    queue->slots[head & (queue->size - 1U)] = job;
+    __atomic_store_n(&queue->head, head + 1U, __ATOMIC_RELEASE);
+
+    dma_queue_kick(queue);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      get the number of jobs queued or running
+    \param[in]  queue: DMA job queue
+    \param[out] none
+    \retval     number of jobs
+*/
+uint32_t dma_queue_pending_get(dma_queue_struct *queue)
+{
+    return queue->head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+}
+
+/*!
+    \brief      stop the channel and drop every job of the queue, call it with
+                the channel interrupt disabled or from the channel interrupt
+    \param[in]  queue: DMA job queue
+    \param[out] none
+    \retval     none
+*/
+void dma_queue_stop(dma_queue_struct *queue)
+{
+    uint32_t tail;
+
+    DMA_CHCTL(queue->dma_periph, queue->channelx) = DMA_CHCTL_RESET_VALUE;
+    DMA_INTC(queue->dma_periph) = DMA_FLAG_ADD(DMA_CHINTF_RESET_VALUE, queue->channelx);
+
+    for(tail = queue->tail; tail != queue->head; tail++){
+        queue->slots[tail & (queue->size - 1U)]->status = DMA_JOB_IDLE;
+    }
+    queue->tail = tail;
+    queue->busy = 0U;
+}
+
+/*!
+    \brief      DMA channel interrupt service, ends the running job and starts the next one
+    \param[in]  queue: DMA job queue
+    \param[out] none
+    \retval     none
+*/
+void dma_queue_irq_handler(dma_queue_struct *queue)
+{
+    uint32_t flags;
+    dma_job_struct *job;
+
+    flags = DMA_INTF(queue->dma_periph) >> (queue->channelx * 4U);
+    if(0U == (flags & (DMA_INTF_FTFIF | DMA_INTF_ERRIF))){
+        return;
+    }
+    DMA_INTC(queue->dma_periph) = DMA_FLAG_ADD(DMA_INTC_GIFC, queue->channelx);
+
+    if(0U == queue->busy){
+        return;
+    }
+    job = queue->slots[queue->tail & (queue->size - 1U)];
+    job->status = (0U != (flags & DMA_INTF_ERRIF)) ? DMA_JOB_ERROR : DMA_JOB_DONE;
+    __atomic_store_n(&queue->tail, queue->tail + 1U, __ATOMIC_RELEASE);
+
+    /* chain the next job first, the callback may take a while */
+    __atomic_store_n(&queue->busy, 0U, __ATOMIC_RELEASE);
+    dma_queue_kick(queue);
+
+    if(NULL != job->callback){
+        job->callback(job);
+    }
+}
+
+/*!
+    \brief      start the oldest queued job if the channel is idle
+    \param[in]  queue: DMA job queue
+    \param[out] none
+    \retval     none
+*/
+static void dma_queue_kick(dma_queue_struct *queue)
+{
+    dma_job_struct *job;
+
+    if(__atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) == queue->tail){
+        return;
+    }
+    /* both the submitter and the DMA interrupt kick, the exchange elects one of them */
+    if(0U != __atomic_exchange_n(&queue->busy, 1U, __ATOMIC_ACQ_REL)){
+        return;
+    }
+    if(queue->head == queue->tail){
+        /* the interrupt emptied the queue between the check and the election */
+        __atomic_store_n(&queue->busy, 0U, __ATOMIC_RELEASE);
+        return;
+    }
+
+    job = queue->slots[queue->tail & (queue->size - 1U)];
+    job->status = DMA_JOB_ACTIVE;
+    dma_job_commit(queue->dma_periph, queue->channelx, job);
+}
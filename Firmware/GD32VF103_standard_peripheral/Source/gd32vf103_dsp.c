@@ -0,0 +1,683 @@
+/*!
+    \file  gd32vf103_dsp.c
+    \brief fixed-point DSP kernels
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_dsp.h"
+
+/* first quarter of a sine period in Q15, sin(pi * i / 512) for i = 0..256 */
+static const q15_t dsp_sine_table[(DSP_FFT_SIZE_MAX / 4U) + 1U] = {
+         0,    201,    402,    603,    804,   1005,   1206,   1407,
+      1608,   1809,   2009,   2210,   2410,   2611,   2811,   3012,
+      3212,   3412,   3612,   3811,   4011,   4210,   4410,   4609,
+      4808,   5007,   5205,   5404,   5602,   5800,   5998,   6195,
+      6393,   6590,   6786,   6983,   7179,   7375,   7571,   7767,
+      7962,   8157,   8351,   8545,   8739,   8933,   9126,   9319,
+      9512,   9704,   9896,  10087,  10278,  10469,  10659,  10849,
+     11039,  11228,  11417,  11605,  11793,  11980,  12167,  12353,
+     12539,  12725,  12910,  13094,  13279,  13462,  13645,  13828,
+     14010,  14191,  14372,  14553,  14732,  14912,  15090,  15269,
+     15446,  15623,  15800,  15976,  16151,  16325,  16499,  16673,
+     16846,  17018,  17189,  17360,  17530,  17700,  17869,  18037,
+     18204,  18371,  18537,  18703,  18868,  19032,  19195,  19357,
+     19519,  19680,  19841,  20000,  20159,  20317,  20475,  20631,
+     20787,  20942,  21096,  21250,  21403,  21554,  21705,  21856,
+     22005,  22154,  22301,  22448,  22594,  22739,  22884,  23027,
+     23170,  23311,  23452,  23592,  23731,  23870,  24007,  24143,
+     24279,  24413,  24547,  24680,  24811,  24942,  25072,  25201,
+     25329,  25456,  25582,  25708,  25832,  25955,  26077,  26198,
+     26319,  26438,  26556,  26674,  26790,  26905,  27019,  27133,
+     27245,  27356,  27466,  27575,  27683,  27790,  27896,  28001,
+     28105,  28208,  28310,  28411,  28510,  28609,  28706,  28803,
+     28898,  28992,  29085,  29177,  29268,  29358,  29447,  29534,
+     29621,  29706,  29791,  29874,  29956,  30037,  30117,  30195,
+     30273,  30349,  30424,  30498,  30571,  30643,  30714,  30783,
+     30852,  30919,  30985,  31050,  31113,  31176,  31237,  31297,
+     31356,  31414,  31470,  31526,  31580,  31633,  31685,  31736,
+     31785,  31833,  31880,  31926,  31971,  32014,  32057,  32098,
+     32137,  32176,  32213,  32250,  32285,  32318,  32351,  32382,
+     32412,  32441,  32469,  32495,  32521,  32545,  32567,  32589,
+     32609,  32628,  32646,  32663,  32678,  32692,  32705,  32717,
+     32728,  32737,  32745,  32752,  32757,  32761,  32765,  32766,
+     32767
+};
+
+/* saturate an accumulator to Q15 */
+static q15_t dsp_sat_q15(int32_t value);
+/* saturate an accumulator to Q31 */
+static q31_t dsp_sat_q31(int64_t value);
+/* get the integer square root of a 32-bit value */
+static uint32_t dsp_sqrt(uint32_t value);
+
+/*!
+    \brief      convert right aligned 12-bit ADC samples to Q15 around mid scale,
+                reading every stride-th sample so one channel can be taken
+                straight out of an interleaved ADC stream frame
+    \param[in]  samples: first ADC sample
+    \param[in]  stride: distance between two samples of the channel, 1 for a plain block
+    \param[out] out: len Q15 samples
+    \param[in]  len: number of samples
+    \retval     none
+*/
+void dsp_q15_from_adc(const uint16_t *samples, uint32_t stride, q15_t *out, uint32_t len)
+{
+    while(0U != len--){
+        *out++ = (q15_t)(((int32_t)(*samples & 0x0FFFU) - 2048) * 16);
+        samples += stride;
+    }
+}
+
+/*!
+    \brief      initialize a Q15 FIR filter and clear its delay line; the 32-bit
+                accumulator cannot overflow while the sum of the absolute values
+                of the coefficients stays below 2
+    \param[in]  fir: FIR filter
+    \param[in]  coeffs: taps coefficients, h[0] applies to the newest sample
+    \param[in]  state: delay line of 2 * taps values
+    \param[in]  taps: number of coefficients, at least 1
+    \param[out] none
+    \retval     none
+*/
+void dsp_fir_q15_init(dsp_fir_q15_struct *fir, const q15_t *coeffs, q15_t *state, uint32_t taps)
+{
+    uint32_t i;
+
+    fir->coeffs = coeffs;
+    fir->state = state;
+    fir->taps = taps;
+    fir->index = 0U;
+    for(i = 0U; i < (2U * taps); i++){
+        state[i] = 0;
+    }
+}
+
+/*!
+    \brief      filter a block of Q15 samples; each sample is written at both
+                ends of the delay line, so the newest taps samples are always
+                contiguous and the dot product never wraps
+    \param[in]  fir: FIR filter
+    \param[in]  in: len input samples
+    \param[out] out: len output samples, may be the same buffer as in
+    \param[in]  len: number of samples
+    \retval     none
+*/
+void dsp_fir_q15(dsp_fir_q15_struct *fir, const q15_t *in, q15_t *out, uint32_t len)
+{
+    uint32_t taps = fir->taps;
+    uint32_t index = fir->index;
+    const q15_t *h, *x;
+    int32_t acc;
+    uint32_t k;
+
+    while(0U != len--){
+        index = (0U == index) ? (taps - 1U) : (index - 1U);
+        fir->state[index] = *in;
+        fir->state[index + taps] = *in++;
+
+        h = fir->coeffs;
+        x = &fir->state[index];
+        acc = 1 << 14;
+        for(k = taps >> 2U; 0U != k; k--){
+            acc += (int32_t)h[0] * x[0];
+            acc += (int32_t)h[1] * x[1];
+            acc += (int32_t)h[2] * x[2];
+            acc += (int32_t)h[3] * x[3];
+            h += 4;
+            x += 4;
+        }
+        for(k = taps & 3U; 0U != k; k--){
+            acc += (int32_t)*h++ * *x++;
+        }
+        *out++ = dsp_sat_q15(acc >> 15);
+    }
+    fir->index = index;
+}
+
+/*!
+    \brief      initialize a Q31 FIR filter and clear its delay line; the 64-bit
+                accumulator cannot overflow while the sum of the absolute values
+                of the coefficients stays below 2
+    \param[in]  fir: FIR filter
+    \param[in]  coeffs: taps coefficients, h[0] applies to the newest sample
+    \param[in]  state: delay line of 2 * taps values
+    \param[in]  taps: number of coefficients, at least 1
+    \param[out] none
+    \retval     none
+*/
+void dsp_fir_q31_init(dsp_fir_q31_struct *fir, const q31_t *coeffs, q31_t *state, uint32_t taps)
+{
+    uint32_t i;
+
+    fir->coeffs = coeffs;
+    fir->state = state;
+    fir->taps = taps;
+    fir->index = 0U;
+    for(i = 0U; i < (2U * taps); i++){
+        state[i] = 0;
+    }
+}
+
+/*!
+    \brief      filter a block of Q31 samples, with the same delay line as the
+                Q15 filter and full 64-bit products
+    \param[in]  fir: FIR filter
+    \param[in]  in: len input samples
+    \param[out] out: len output samples, may be the same buffer as in
+    \param[in]  len: number of samples
+    \retval     none
+*/
+void dsp_fir_q31(dsp_fir_q31_struct *fir, const q31_t *in, q31_t *out, uint32_t len)
+{
+    uint32_t taps = fir->taps;
+    uint32_t index = fir->index;
+    const q31_t *h, *x;
+    int64_t acc;
+    uint32_t k;
+
+    while(0U != len--){
+        index = (0U == index) ? (taps - 1U) : (index - 1U);
+        fir->state[index] = *in;
+        fir->state[index + taps] = *in++;
+
+        h = fir->coeffs;
+        x = &fir->state[index];
+        acc = (int64_t)1 << 30;
+        for(k = taps >> 2U; 0U != k; k--){
+            acc += (int64_t)h[0] * x[0];
+            acc += (int64_t)h[1] * x[1];
+            acc += (int64_t)h[2] * x[2];
+            acc += (int64_t)h[3] * x[3];
+            h += 4;
+            x += 4;
+        }
+        for(k = taps & 3U; 0U != k; k--){
+            acc += (int64_t)*h++ * *x++;
+        }
+        *out++ = dsp_sat_q31(acc >> 31);
+    }
+    fir->index = index;
+}
+
+/*!
+    \brief      initialize a Q15 biquad cascade and clear its state; each stage
+                computes y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+    \param[in]  biquad: biquad cascade
+    \param[in]  coeffs: b0, b1, b2, a1, a2 of each stage in Q(15 - shift)
+    \param[in]  state: DSP_BIQUAD_STATE_NUM values per stage
+    \param[in]  stages: number of second order sections, at least 1
+    \param[in]  shift: headroom bits of the coefficients, 1 for coefficients in [-2, 2)
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus dsp_biquad_q15_init(dsp_biquad_q15_struct *biquad, const q15_t *coeffs, q15_t *state,
+                              uint32_t stages, uint32_t shift)
+{
+    uint32_t i;
+
+    if((0U == stages) || (2U < shift)){
+        return ERROR;
+    }
+    biquad->coeffs = coeffs;
+    biquad->state = state;
+    biquad->stages = stages;
+    biquad->shift = shift;
+    for(i = 0U; i < (DSP_BIQUAD_STATE_NUM * stages); i++){
+        state[i] = 0;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      filter a block of Q15 samples through the cascade, one stage over
+                the whole block at a time so its coefficients stay in registers;
+                the five products of a sample add up in 64 bits
+    \param[in]  biquad: biquad cascade
+    \param[in]  in: len input samples
+    \param[out] out: len output samples, may be the same buffer as in
+    \param[in]  len: number of samples
+    \retval     none
+*/
+void dsp_biquad_q15(dsp_biquad_q15_struct *biquad, const q15_t *in, q15_t *out, uint32_t len)
+{
+    const q15_t *c = biquad->coeffs;
+    q15_t *state = biquad->state;
+    uint32_t shift = 15U - biquad->shift;
+    int32_t b0, b1, b2, a1, a2, x0, x1, x2, y1, y2;
+    const q15_t *src = in;
+    int64_t acc;
+    uint32_t stage, n;
+
+    for(stage = 0U; stage < biquad->stages; stage++){
+        b0 = c[0];
+        b1 = c[1];
+        b2 = c[2];
+        a1 = c[3];
+        a2 = c[4];
+        x1 = state[0];
+        x2 = state[1];
+        y1 = state[2];
+        y2 = state[3];
+
+        for(n = 0U; n < len; n++){
+            x0 = src[n];
+            acc = (int64_t)(1 << (shift - 1U));
+            acc += b0 * x0;
+            acc += b1 * x1;
+            acc += b2 * x2;
+            acc -= a1 * y1;
+            acc -= a2 * y2;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = dsp_sat_q15((int32_t)(acc >> shift));
+            out[n] = (q15_t)y1;
+        }
+
+        state[0] = (q15_t)x1;
+        state[1] = (q15_t)x2;
+        state[2] = (q15_t)y1;
+        state[3] = (q15_t)y2;
+        c += DSP_BIQUAD_COEFF_NUM;
+        state += DSP_BIQUAD_STATE_NUM;
+        src = out;
+    }
+}
+
+/*!
+    \brief      initialize a Q31 biquad cascade and clear its state; each stage
+                computes y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+    \param[in]  biquad: biquad cascade
+    \param[in]  coeffs: b0, b1, b2, a1, a2 of each stage in Q(31 - shift)
+    \param[in]  state: DSP_BIQUAD_STATE_NUM values per stage
+    \param[in]  stages: number of second order sections, at least 1
+    \param[in]  shift: headroom bits of the coefficients, 1 for coefficients in [-2, 2)
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus dsp_biquad_q31_init(dsp_biquad_q31_struct *biquad, const q31_t *coeffs, q31_t *state,
+                              uint32_t stages, uint32_t shift)
+{
+    uint32_t i;
+
+    if((0U == stages) || (2U < shift)){
+        return ERROR;
+    }
+    biquad->coeffs = coeffs;
+    biquad->state = state;
+    biquad->stages = stages;
+    biquad->shift = shift;
+    for(i = 0U; i < (DSP_BIQUAD_STATE_NUM * stages); i++){
+        state[i] = 0;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      filter a block of Q31 samples through the cascade; the five full
+                64-bit products of a sample, a mul and a mulh each on the core,
+                add up in 64 bits and are rounded once, which leaves two guard
+                bits above the Q31 range before the output saturates
+    \param[in]  biquad: biquad cascade
+    \param[in]  in: len input samples
+    \param[out] out: len output samples, may be the same buffer as in
+    \param[in]  len: number of samples
+    \retval     none
+*/
+void dsp_biquad_q31(dsp_biquad_q31_struct *biquad, const q31_t *in, q31_t *out, uint32_t len)
+{
+    const q31_t *c = biquad->coeffs;
+    q31_t *state = biquad->state;
+    uint32_t shift = 31U - biquad->shift;
+    q31_t b0, b1, b2, a1, a2, x0, x1, x2, y1, y2;
+    const q31_t *src = in;
+    int64_t acc;
+    uint32_t stage, n;
+
+    for(stage = 0U; stage < biquad->stages; stage++){
+        b0 = c[0];
+        b1 = c[1];
+        b2 = c[2];
+        a1 = c[3];
+        a2 = c[4];
+        x1 = state[0];
+        x2 = state[1];
+        y1 = state[2];
+        y2 = state[3];
+
+        for(n = 0U; n < len; n++){
+            x0 = src[n];
+            acc = (int64_t)1 << (shift - 1U);
+            acc += (int64_t)b0 * x0;
+            acc += (int64_t)b1 * x1;
+            acc += (int64_t)b2 * x2;
+            acc -= (int64_t)a1 * y1;
+            acc -= (int64_t)a2 * y2;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = dsp_sat_q31(acc >> shift);
+            out[n] = y1;
+        }
+
+        state[0] = x1;
+        state[1] = x2;
+        state[2] = y1;
+        state[3] = y2;
+        c += DSP_BIQUAD_COEFF_NUM;
+        state += DSP_BIQUAD_STATE_NUM;
+        src = out;
+    }
+}
+
+/*!
+    \brief      initialize a Q15 moving average and clear its window
+    \param[in]  average: moving average
+    \param[in]  window: storage of length samples
+    \param[in]  length: number of samples averaged, 2 to 65536
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus dsp_moving_average_q15_init(dsp_moving_average_q15_struct *average, q15_t *window, uint32_t length)
+{
+    uint32_t i;
+
+    if((2U > length) || (65536U < length)){
+        return ERROR;
+    }
+    average->window = window;
+    average->length = length;
+    average->index = 0U;
+    average->sum = 0;
+    /* the running sum of up to 65536 samples fits in 32 bits */
+    average->reciprocal = (uint32_t)((0x100000000ULL + length - 1U) / length);
+    for(i = 0U; i < length; i++){
+        window[i] = 0;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      average a block of Q15 samples with a running sum, the division
+                by the length is a rounded multiply with its reciprocal
+    \param[in]  average: moving average
+    \param[in]  in: len input samples
+    \param[out] out: len output samples, may be the same buffer as in
+    \param[in]  len: number of samples
+    \retval     none
+*/
+void dsp_moving_average_q15(dsp_moving_average_q15_struct *average, const q15_t *in, q15_t *out, uint32_t len)
+{
+    uint32_t index = average->index;
+    int32_t sum = average->sum;
+    q15_t x;
+
+    while(0U != len--){
+        x = *in++;
+        sum += (int32_t)x - average->window[index];
+        average->window[index] = x;
+        if(++index == average->length){
+            index = 0U;
+        }
+        *out++ = (q15_t)((((int64_t)sum * average->reciprocal) + 0x80000000LL) >> 32);
+    }
+    average->index = index;
+    average->sum = sum;
+}
+
+/*!
+    \brief      initialize a Q15 CIC decimator and clear its registers; the gain
+                decimation^stages is taken off by a shift, so the output has the
+                scale of the input
+    \param[in]  cic: CIC decimator
+    \param[in]  stages: integrator and comb pairs, 1 to DSP_CIC_STAGES_MAX
+    \param[in]  decimation: input samples per output sample, a power of two from 2, with
+                stages * log2(decimation) at most DSP_CIC_GROWTH_MAX
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus dsp_cic_q15_init(dsp_cic_q15_struct *cic, uint32_t stages, uint32_t decimation)
+{
+    uint32_t log2 = 0U;
+    uint32_t i;
+
+    if((0U == stages) || (DSP_CIC_STAGES_MAX < stages) || (2U > decimation)
+       || (0U != (decimation & (decimation - 1U)))){
+        return ERROR;
+    }
+    while((1U << log2) < decimation){
+        log2++;
+    }
+    if(DSP_CIC_GROWTH_MAX < (stages * log2)){
+        return ERROR;
+    }
+
+    cic->stages = stages;
+    cic->decimation = decimation;
+    cic->shift = stages * log2;
+    cic->phase = 0U;
+    for(i = 0U; i < DSP_CIC_STAGES_MAX; i++){
+        cic->integrator[i] = 0U;
+        cic->comb[i] = 0U;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      decimate a block of Q15 samples; the integrators wrap around in
+                unsigned arithmetic, which the combs undo exactly
+    \param[in]  cic: CIC decimator
+    \param[in]  in: len input samples
+    \param[out] out: up to len / decimation + 1 output samples, may be the same buffer as in
+    \param[in]  len: number of input samples
+    \retval     number of output samples
+*/
+uint32_t dsp_cic_q15(dsp_cic_q15_struct *cic, const q15_t *in, q15_t *out, uint32_t len)
+{
+    uint32_t stages = cic->stages;
+    uint32_t count = 0U;
+    uint32_t value, delayed, k;
+
+    while(0U != len--){
+        value = (uint32_t)(int32_t)*in++;
+        for(k = 0U; k < stages; k++){
+            cic->integrator[k] += value;
+            value = cic->integrator[k];
+        }
+        if(++cic->phase < cic->decimation){
+            continue;
+        }
+        cic->phase = 0U;
+        for(k = 0U; k < stages; k++){
+            delayed = cic->comb[k];
+            cic->comb[k] = value;
+            value -= delayed;
+        }
+        out[count++] = dsp_sat_q15((int32_t)value >> cic->shift);
+    }
+    return count;
+}
+
+/*!
+    \brief      get the root mean square of a block of Q15 samples
+    \param[in]  in: len samples
+    \param[in]  len: number of samples, at least 1
+    \param[out] none
+    \retval     root mean square in Q15
+*/
+q15_t dsp_rms_q15(const q15_t *in, uint32_t len)
+{
+    uint64_t sum = 0U;
+    uint32_t k;
+
+    for(k = len >> 2U; 0U != k; k--){
+        sum += (uint32_t)((int32_t)in[0] * in[0]);
+        sum += (uint32_t)((int32_t)in[1] * in[1]);
+        sum += (uint32_t)((int32_t)in[2] * in[2]);
+        sum += (uint32_t)((int32_t)in[3] * in[3]);
+        in += 4;
+    }
+    for(k = len & 3U; 0U != k; k--){
+        sum += (uint32_t)((int32_t)*in * *in);
+        in++;
+    }
+    /* the mean square is Q30 and at most 2^30, its root Q15 */
+    return dsp_sat_q15((int32_t)dsp_sqrt((uint32_t)(sum / len)));
+}
+
+/*!
+    \brief      in place radix-2 decimation in time FFT of interleaved complex Q15
+                samples; every stage halves its results, so the output is the
+                DFT scaled by 1/n and cannot overflow while no input sample has a
+                magnitude above 1; the twiddles come from a quarter wave table
+    \param[in]  data: n complex samples, real part first
+    \param[in]  n: number of complex samples, a power of two from DSP_FFT_SIZE_MIN to DSP_FFT_SIZE_MAX
+    \param[out] data: n complex frequency bins, bin 0 first
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus dsp_fft_q15(q15_t *data, uint32_t n)
+{
+    uint32_t i, j, bit, size, half, step, k, t;
+    int32_t c, s, ar, ai, br, bi, tr, ti;
+    q15_t swap;
+
+    if((DSP_FFT_SIZE_MIN > n) || (DSP_FFT_SIZE_MAX < n) || (0U != (n & (n - 1U)))){
+        return ERROR;
+    }
+
+    /* bit reversed order */
+    for(i = 1U, j = 0U; i < n; i++){
+        for(bit = n >> 1U; 0U != (j & bit); bit >>= 1U){
+            j ^= bit;
+        }
+        j |= bit;
+        if(i < j){
+            swap = data[2U * i];
+            data[2U * i] = data[2U * j];
+            data[2U * j] = swap;
+            swap = data[(2U * i) + 1U];
+            data[(2U * i) + 1U] = data[(2U * j) + 1U];
+            data[(2U * j) + 1U] = swap;
+        }
+    }
+
+    for(size = 2U; size <= n; size <<= 1U){
+        half = size >> 1U;
+        step = DSP_FFT_SIZE_MAX / size;
+        for(k = 0U; k < half; k++){
+            /* w = cos(2 pi k / size) - i sin(2 pi k / size) */
+            t = k * step;
+            if(t <= (DSP_FFT_SIZE_MAX / 4U)){
+                c = dsp_sine_table[(DSP_FFT_SIZE_MAX / 4U) - t];
+                s = dsp_sine_table[t];
+            }else{
+                c = -dsp_sine_table[t - (DSP_FFT_SIZE_MAX / 4U)];
+                s = dsp_sine_table[(DSP_FFT_SIZE_MAX / 2U) - t];
+            }
+            for(i = k; i < n; i += size){
+                j = i + half;
+                br = data[2U * j];
+                bi = data[(2U * j) + 1U];
+                tr = ((c * br) + (s * bi)) >> 15;
+                ti = ((c * bi) - (s * br)) >> 15;
+                ar = data[2U * i];
+                ai = data[(2U * i) + 1U];
+                data[2U * i] = (q15_t)((ar + tr) >> 1);
+                data[(2U * i) + 1U] = (q15_t)((ai + ti) >> 1);
+                data[2U * j] = (q15_t)((ar - tr) >> 1);
+                data[(2U * j) + 1U] = (q15_t)((ai - ti) >> 1);
+            }
+        }
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      saturate an accumulator to Q15
+    \param[in]  value: accumulator scaled to Q15
+    \param[out] none
+    \retval     saturated value
+*/
+static q15_t dsp_sat_q15(int32_t value)
+{
+    if(value > 32767){
+        return 32767;
+    }
+    if(value < -32768){
+        return -32768;
+    }
+    return (q15_t)value;
+}
+
+/*!
+    \brief      saturate an accumulator to Q31
+    \param[in]  value: accumulator scaled to Q31
+    \param[out] none
+    \retval     saturated value
+*/
+static q31_t dsp_sat_q31(int64_t value)
+{
+    if(value > 0x7FFFFFFFLL){
+        return 0x7FFFFFFF;
+    }
+    if(value < -0x80000000LL){
+        return (q31_t)0x80000000U;
+    }
+    return (q31_t)value;
+}
+
+/*!
+    \brief      get the integer square root of a 32-bit value, one result bit
+                per step without a division
+    \param[in]  value: radicand
+    \param[out] none
+    \retval     floor of the square root
+*/
+static uint32_t dsp_sqrt(uint32_t value)
+{
+    uint32_t root = 0U;
+    uint32_t bit = 1U << 30U;
+
+    while(bit > value){
+        bit >>= 2U;
+    }
+    while(0U != bit){
+        if(value >= (root + bit)){
+            value -= root + bit;
+            root = (root >> 1U) + bit;
+        }else{
+            root >>= 1U;
+        }
+        bit >>= 2U;
+    }
+    return root;
+}
@@ -38,6 +38,22 @@ OF SUCH DAMAGE.
 #define REG_DBGMCU2       ((uint32_t)0xE0042008)
 #define REG_DBGMCU2EN     ((uint32_t)0xE004200C)
 
+/* read_csr() and write_csr() paste their argument into the asm text, expand a CSR_ name first */
+#define ECLIC_CSR_READ(csr)         read_csr(csr)
+#define ECLIC_CSR_WRITE(csr, val)   write_csr(csr, val)
+#define ECLIC_CSR_CLEAR(csr, bit)   clear_csr(csr, bit)
+
+#define ECLIC_MCOUNTINHIBIT_CY      BIT(0)      /* mcycle stopped */
+
+/* vector table in RAM, in use once eclic_vector_table_relocate has run */
+static uint32_t eclic_vector_table[ECLIC_NUM_INTERRUPTS] __attribute__((aligned(ECLIC_VECTOR_TABLE_ALIGN)));
+/* latency histograms and the mcycle value of the last mark of each interrupt */
+static eclic_latency_struct *eclic_latency_histogram[ECLIC_NUM_INTERRUPTS];
+static volatile uint32_t eclic_latency_stamp[ECLIC_NUM_INTERRUPTS];
+/* functions keeping mcycle on while histograms are attached */
+static void (*eclic_latency_hold)(void) = NULL;
+static void (*eclic_latency_release)(void) = NULL;
+
 /*!
     \brief      enable the global interrupt
     \param[in]  none
@@ -99,6 +115,164 @@ void eclic_irq_disable(uint32_t source) {
     eclic_disable_interrupt(source);
 }
 
+/*!
+    \brief      copy the vector table to RAM so handlers can be registered at run time
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void eclic_vector_table_relocate(void) {
+    const uint32_t *table = (const uint32_t *)ECLIC_CSR_READ(CSR_MTVT);
+    uint32_t i;
+
+    if(eclic_vector_table == table){
+        return;
+    }
+    for(i = 0U; i < ECLIC_NUM_INTERRUPTS; i++){
+        eclic_vector_table[i] = table[i];
+    }
+    /* the core fetches the vector entries through the instruction side */
+    __asm volatile("fence.i");
+    ECLIC_CSR_WRITE(CSR_MTVT, (uint32_t)eclic_vector_table);
+}
+
+/*!
+    \brief      register the handler of an interrupt request, select its dispatch mode and enable it
+    \param[in]  source: interrupt request, detailed in IRQn_Type
+    \param[in]  level: the level needed to set (maximum is 15, refer to the priority group)
+    \param[in]  priority: the priority needed to set (maximum is 15, refer to the priority group)
+    \param[in]  handler: interrupt handler
+    \param[in]  mode: dispatch mode of the handler
+      \arg        ECLIC_NON_VECTORED: a plain C function, called through irq_entry
+      \arg        ECLIC_VECTORED: defined with ECLIC_VECTORED_HANDLER, or naked and returning with mret
+    \param[out] none
+    \retval     none
+*/
+void eclic_irq_handler_register(uint32_t source, uint8_t level, uint8_t priority, void (*handler)(void), uint32_t mode) {
+    eclic_vector_table_relocate();
+
+    eclic_disable_interrupt(source);
+    eclic_vector_table[source] = (uint32_t)handler;
+    __asm volatile("fence.i");
+
+    if(ECLIC_VECTORED == mode){
+        eclic_set_vmode(source);
+    }else{
+        eclic_set_nonvmode(source);
+    }
+    eclic_irq_enable(source, level, priority);
+}
+
+/*!
+    \brief      set the functions keeping mcycle on while histograms are attached,
+                for an application sharing mcycle with other users; without
+                them the first attach turns mcycle on and it stays on
+    \param[in]  hold: called when a histogram is attached to an interrupt without one, or NULL
+    \param[in]  release: called when a histogram is detached, or NULL
+    \param[out] none
+    \retval     none
+*/
+void eclic_latency_counter_config(void (*hold)(void), void (*release)(void)) {
+    eclic_latency_hold = hold;
+    eclic_latency_release = release;
+}
+
+/*!
+    \brief      attach a histogram to an interrupt, mcycle is turned on while it is attached
+    \param[in]  source: interrupt request, detailed in IRQn_Type
+    \param[in]  histogram: latency histogram, cleared here, or NULL to detach
+    \param[in]  bin_width: cycles per histogram bin
+    \param[out] none
+    \retval     none
+*/
+void eclic_latency_attach(uint32_t source, eclic_latency_struct *histogram, uint32_t bin_width) {
+    eclic_latency_struct *previous = eclic_latency_histogram[source];
+    uint32_t i;
+
+    eclic_latency_histogram[source] = NULL;
+    if(NULL != histogram){
+        histogram->bin_width = (0U == bin_width) ? 1U : bin_width;
+        for(i = 0U; i < ECLIC_LATENCY_BINS; i++){
+            histogram->bins[i] = 0U;
+        }
+        histogram->samples = 0U;
+        histogram->min = 0xFFFFFFFFU;
+        histogram->max = 0U;
+        /* _init stops mcycle to save power */
+        if(NULL == previous){
+            if(NULL != eclic_latency_hold){
+                eclic_latency_hold();
+            }else{
+                ECLIC_CSR_CLEAR(CSR_MCOUNTINHIBIT, ECLIC_MCOUNTINHIBIT_CY);
+            }
+        }
+    }else if((NULL != previous) && (NULL != eclic_latency_release)){
+        eclic_latency_release();
+    }
+    eclic_latency_stamp[source] = 0U;
+    eclic_latency_histogram[source] = histogram;
+}
+
+/*!
+    \brief      mark the moment the event of an interrupt happened
+    \param[in]  source: interrupt request, detailed in IRQn_Type
+    \param[out] none
+    \retval     none
+*/
+void eclic_latency_mark(uint32_t source) {
+    /* zero means no mark */
+    eclic_latency_stamp[source] = read_csr(mcycle) | 1U;
+}
+
+/*!
+    \brief      mark now and make an interrupt pending by software, the
+                interrupt must be edge triggered for the pending bit to stick
+    \param[in]  source: interrupt request, detailed in IRQn_Type
+    \param[out] none
+    \retval     none
+*/
+void eclic_latency_trigger(uint32_t source) {
+    eclic_latency_mark(source);
+    eclic_set_pending(source);
+}
+
+/*!
+    \brief      add the cycles since the mark, or since irq_entry when built with
+                ECLIC_LATENCY_ENABLE and no mark is set, to the histogram of an interrupt
+    \param[in]  source: interrupt request, detailed in IRQn_Type
+    \param[out] none
+    \retval     none
+*/
+void eclic_latency_record(uint32_t source) {
+    uint32_t now = read_csr(mcycle);
+    eclic_latency_struct *histogram = eclic_latency_histogram[source];
+    uint32_t stamp, cycles, bin;
+
+    stamp = eclic_latency_stamp[source];
+    eclic_latency_stamp[source] = 0U;
+    if(0U == stamp){
+        /* irq_entry leaves its entry time in mscratch */
+        stamp = swap_csr(mscratch, 0U);
+    }
+    if((NULL == histogram) || (0U == stamp)){
+        return;
+    }
+
+    cycles = now - stamp;
+    bin = cycles / histogram->bin_width;
+    if(bin >= ECLIC_LATENCY_BINS){
+        bin = ECLIC_LATENCY_BINS - 1U;
+    }
+    histogram->bins[bin]++;
+    histogram->samples++;
+    if(cycles < histogram->min){
+        histogram->min = cycles;
+    }
+    if(cycles > histogram->max){
+        histogram->max = cycles;
+    }
+}
+
 /*!
     \brief      reset system
     \param[in]  none
@@ -0,0 +1,679 @@
+/*!
+    \file  gd32vf103_fmc_kv.c
+    \brief key-value store in the main flash
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103_fmc_kv.h"
+
+#define FMC_KV_MAGIC                    0x4B56U                     /* first half word of a page in use */
+#define FMC_KV_MARK                     0x0000U                     /* value of a marker once set */
+#define FMC_KV_ERASED                   0xFFFFU                     /* value of an erased half word */
+#define FMC_KV_TOMBSTONE                0x8000U                     /* length of a record deleting its key */
+#define FMC_KV_HEADER_SIZE              10U                         /* bytes of the page header */
+#define FMC_KV_GC_PAGES                 2U                          /* erased pages below which the garbage collection runs */
+
+/* offsets of the header half words */
+#define FMC_KV_HDR_MAGIC                0U
+#define FMC_KV_HDR_SEQ_LOW              2U
+#define FMC_KV_HDR_SEQ_HIGH             4U
+#define FMC_KV_HDR_VALID                6U
+#define FMC_KV_HDR_OBSOLETE             8U
+
+/* get the address of a page of the store */
+#define FMC_KV_PAGE_ADDR(kv, page)      ((kv)->start + ((page) * FMC_KV_PAGE_SIZE))
+/* get the page of the store holding an address */
+#define FMC_KV_PAGE_OF(kv, address)     (((address) - (kv)->start) / FMC_KV_PAGE_SIZE)
+
+/* unlock the FMC and clear its flags */
+static uint32_t fmc_kv_unlock(void);
+/* lock the FMC again if it was locked */
+static void fmc_kv_lock(uint32_t locked);
+/* find the state and sequence number of a page */
+static void fmc_kv_page_check(fmc_kv_struct *kv, uint32_t page);
+/* add the committed records of a page to the index */
+static uint32_t fmc_kv_page_scan(fmc_kv_struct *kv, uint32_t page);
+/* get the bytes of a record from its length half word */
+static uint32_t fmc_kv_record_size(uint32_t length);
+/* make a record the current one of its key */
+static void fmc_kv_index_set(fmc_kv_struct *kv, uint32_t key, uint32_t address, uint32_t size, uint32_t page);
+/* append a record to the active page */
+static fmc_kv_result_enum fmc_kv_append(fmc_kv_struct *kv, uint32_t key, uint32_t length, const uint8_t *data, uint32_t src, uint32_t gc);
+/* open the next erased page as the active one */
+static fmc_kv_result_enum fmc_kv_page_open(fmc_kv_struct *kv, uint32_t gc);
+/* get the bytes of the live records of a page */
+static uint32_t fmc_kv_live_bytes(fmc_kv_struct *kv, uint32_t page);
+/* copy live records out of the page being collected */
+static fmc_kv_result_enum fmc_kv_collect(fmc_kv_struct *kv, uint32_t budget);
+/* convert an FMC state to a store result */
+static fmc_kv_result_enum fmc_kv_result(fmc_state_enum state);
+
+/*!
+    \brief      scan the pages and build the index; a page that is neither
+                erased nor valid is left for fmc_kv_maintain() to erase, a
+                record without commit marker is skipped
+    \param[in]  kv: store state
+    \param[in]  init_struct: the data needed to initialize the store
+                  start, page_num: 3 to FMC_KV_PAGE_MAX pages in the main flash, page aligned
+                  index, key_num: index of 1 to FMC_KV_KEY_MAX keys
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus fmc_kv_init(fmc_kv_struct *kv, fmc_kv_parameter_struct *init_struct)
+{
+    uint32_t done = 0U;
+    uint32_t page, next, i;
+
+    if((0U != (init_struct->start & (FMC_KV_PAGE_SIZE - 1U))) || (0x08000000U > init_struct->start)
+       || (3U > init_struct->page_num) || (FMC_KV_PAGE_MAX < init_struct->page_num)
+       || (NULL == init_struct->index) || (0U == init_struct->key_num) || (FMC_KV_KEY_MAX < init_struct->key_num)){
+        return ERROR;
+    }
+
+    kv->start = init_struct->start;
+    kv->page_num = init_struct->page_num;
+    kv->index = init_struct->index;
+    kv->key_num = init_struct->key_num;
+    kv->active = kv->page_num;
+    kv->offset = FMC_KV_PAGE_SIZE;
+    kv->seq = 0U;
+    kv->erased = 0U;
+    kv->gc_page = kv->page_num;
+    kv->gc_offset = 0U;
+    kv->gc_need = 0U;
+    kv->writes = 0U;
+    kv->unchanged = 0U;
+    kv->copies = 0U;
+    kv->erases = 0U;
+    kv->torn = 0U;
+    for(i = 0U; i < kv->key_num; i++){
+        kv->index[i] = 0U;
+    }
+    for(page = 0U; page < kv->page_num; page++){
+        fmc_kv_page_check(kv, page);
+    }
+
+    /* replay the valid pages from the oldest, the last one stays active */
+    do{
+        next = kv->page_num;
+        for(page = 0U; page < kv->page_num; page++){
+            if((FMC_KV_PAGE_VALID == kv->page_state[page]) && (0U == (done & BIT(page)))
+               && ((kv->page_num == next) || (kv->page_seq[page] < kv->page_seq[next]))){
+                next = page;
+            }
+        }
+        if(kv->page_num != next){
+            done |= BIT(next);
+            kv->active = next;
+            kv->offset = fmc_kv_page_scan(kv, next);
+            kv->seq = kv->page_seq[next];
+        }
+    }while(kv->page_num != next);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      read the value of a key
+    \param[in]  kv: store state
+    \param[in]  key: 0 to key_num - 1
+    \param[in]  size: bytes of data, the value is cut to this length
+    \param[out] data: value
+    \param[out] len: length of the whole value
+    \retval     fmc_kv_result_enum: FMC_KV_OK, FMC_KV_NOT_FOUND or FMC_KV_PARAM
+*/
+fmc_kv_result_enum fmc_kv_read(fmc_kv_struct *kv, uint32_t key, uint8_t *data, uint32_t size, uint32_t *len)
+{
+    uint32_t address, length, half, i;
+
+    if(key >= kv->key_num){
+        return FMC_KV_PARAM;
+    }
+    address = kv->index[key];
+    if(0U == address){
+        return FMC_KV_NOT_FOUND;
+    }
+    length = REG16(address + 2U);
+    *len = length;
+    if(length > size){
+        length = size;
+    }
+    for(i = 0U; i < length; i += 2U){
+        half = REG16(address + 4U + i);
+        data[i] = (uint8_t)half;
+        if((i + 1U) < length){
+            data[i + 1U] = (uint8_t)(half >> 8);
+        }
+    }
+    return FMC_KV_OK;
+}
+
+/*!
+    \brief      write the value of a key; the current value written again
+                programs nothing, and the flash is never erased
+    \param[in]  kv: store state
+    \param[in]  key: 0 to key_num - 1
+    \param[in]  data: value
+    \param[in]  len: 0 to FMC_KV_VALUE_MAX bytes
+    \param[out] none
+    \retval     fmc_kv_result_enum: FMC_KV_OK, FMC_KV_PARAM, FMC_KV_FULL or an
+                FMC error
+*/
+fmc_kv_result_enum fmc_kv_write(fmc_kv_struct *kv, uint32_t key, const uint8_t *data, uint32_t len)
+{
+    fmc_kv_result_enum result;
+    uint32_t address, half, locked, i;
+
+    if((key >= kv->key_num) || (FMC_KV_VALUE_MAX < len)){
+        return FMC_KV_PARAM;
+    }
+    address = kv->index[key];
+    if((0U != address) && (len == REG16(address + 2U))){
+        for(i = 0U; i < len; i += 2U){
+            half = data[i];
+            if((i + 1U) < len){
+                half |= (uint32_t)data[i + 1U] << 8;
+            }else{
+                half |= 0xFF00U;
+            }
+            if(half != REG16(address + 4U + i)){
+                break;
+            }
+        }
+        if(i >= len){
+            kv->unchanged++;
+            return FMC_KV_OK;
+        }
+    }
+
+    locked = fmc_kv_unlock();
+    result = fmc_kv_append(kv, key, len, data, 0U, 0U);
+    fmc_kv_lock(locked);
+    if(FMC_KV_OK == result){
+        kv->writes++;
+    }
+    return result;
+}
+
+/*!
+    \brief      delete the value of a key with a record that has no data
+    \param[in]  kv: store state
+    \param[in]  key: 0 to key_num - 1
+    \param[out] none
+    \retval     fmc_kv_result_enum: FMC_KV_OK, FMC_KV_NOT_FOUND, FMC_KV_PARAM,
+                FMC_KV_FULL or an FMC error
+*/
+fmc_kv_result_enum fmc_kv_delete(fmc_kv_struct *kv, uint32_t key)
+{
+    fmc_kv_result_enum result;
+    uint32_t locked;
+
+    if(key >= kv->key_num){
+        return FMC_KV_PARAM;
+    }
+    if(0U == kv->index[key]){
+        return FMC_KV_NOT_FOUND;
+    }
+
+    locked = fmc_kv_unlock();
+    result = fmc_kv_append(kv, key, FMC_KV_TOMBSTONE, NULL, 0U, 0U);
+    fmc_kv_lock(locked);
+    if(FMC_KV_OK == result){
+        kv->writes++;
+    }
+    return result;
+}
+
+/*!
+    \brief      do one step of the garbage collection: erase one page left
+                obsolete or torn, or copy up to budget live records out of
+                the oldest page holding dead ones; nothing is done while
+                FMC_KV_GC_PAGES pages are erased
+    \param[in]  kv: store state
+    \param[in]  budget: most records copied by this call, 0 counts as 1
+    \param[out] none
+    \retval     fmc_kv_result_enum: FMC_KV_OK when there is nothing left to do,
+                FMC_KV_PENDING when another call has work, FMC_KV_FULL when no
+                page holds dead records, or an FMC error
+*/
+fmc_kv_result_enum fmc_kv_maintain(fmc_kv_struct *kv, uint32_t budget)
+{
+    fmc_kv_result_enum result = FMC_KV_PENDING;
+    fmc_state_enum state;
+    uint32_t locked, victim, page;
+
+    if(kv->page_num == kv->gc_page){
+        for(page = 0U; page < kv->page_num; page++){
+            if(FMC_KV_PAGE_DIRTY == kv->page_state[page]){
+                break;
+            }
+        }
+        if(kv->page_num != page){
+            locked = fmc_kv_unlock();
+            state = fmc_page_erase(FMC_KV_PAGE_ADDR(kv, page));
+            fmc_kv_lock(locked);
+            if(FMC_READY != state){
+                return fmc_kv_result(state);
+            }
+            kv->page_state[page] = FMC_KV_PAGE_ERASED;
+            kv->erased++;
+            kv->erases++;
+            return FMC_KV_PENDING;
+        }
+        if(FMC_KV_GC_PAGES <= kv->erased){
+            return FMC_KV_OK;
+        }
+
+        /* the oldest page with dead records; the active page closes when it is the only one */
+        victim = kv->page_num;
+        for(page = 0U; page < kv->page_num; page++){
+            if((FMC_KV_PAGE_VALID == kv->page_state[page]) && (0U != kv->page_dead[page])
+               && ((kv->page_num == victim) || (kv->page_seq[page] < kv->page_seq[victim]))){
+                victim = page;
+            }
+        }
+        if(kv->page_num == victim){
+            return FMC_KV_FULL;
+        }
+        if(kv->active == victim){
+            kv->offset = FMC_KV_PAGE_SIZE;
+        }
+        kv->gc_page = victim;
+        kv->gc_offset = FMC_KV_HEADER_SIZE;
+        kv->gc_need = fmc_kv_live_bytes(kv, victim);
+    }
+
+    locked = fmc_kv_unlock();
+    result = fmc_kv_collect(kv, (0U != budget) ? budget : 1U);
+    fmc_kv_lock(locked);
+    return result;
+}
+
+/*!
+    \brief      unlock the FMC and clear its flags
+    \param[in]  none
+    \param[out] none
+    \retval     FMC_CTL0_LK if the FMC was locked, 0 otherwise
+*/
+static uint32_t fmc_kv_unlock(void)
+{
+    uint32_t locked = FMC_CTL0 & FMC_CTL0_LK;
+
+    fmc_unlock();
+    fmc_flag_clear(FMC_FLAG_END);
+    fmc_flag_clear(FMC_FLAG_PGERR);
+    fmc_flag_clear(FMC_FLAG_WPERR);
+    return locked;
+}
+
+/*!
+    \brief      lock the FMC again if it was locked
+    \param[in]  locked: value returned by fmc_kv_unlock()
+    \param[out] none
+    \retval     none
+*/
+static void fmc_kv_lock(uint32_t locked)
+{
+    if(0U != locked){
+        fmc_lock();
+    }
+}
+
+/*!
+    \brief      find the state and sequence number of a page: erased when the
+                whole page is, valid with the magic and the valid marker but
+                not the obsolete one, dirty otherwise
+    \param[in]  kv: store state
+    \param[in]  page: page of the store
+    \param[out] none
+    \retval     none
+*/
+static void fmc_kv_page_check(fmc_kv_struct *kv, uint32_t page)
+{
+    uint32_t address = FMC_KV_PAGE_ADDR(kv, page);
+    uint32_t i;
+
+    kv->page_dead[page] = 0U;
+    kv->page_seq[page] = 0U;
+    if((FMC_KV_MAGIC == REG16(address + FMC_KV_HDR_MAGIC)) && (FMC_KV_MARK == REG16(address + FMC_KV_HDR_VALID))
+       && (FMC_KV_ERASED == REG16(address + FMC_KV_HDR_OBSOLETE))){
+        kv->page_state[page] = FMC_KV_PAGE_VALID;
+        kv->page_seq[page] = REG16(address + FMC_KV_HDR_SEQ_LOW) | ((uint32_t)REG16(address + FMC_KV_HDR_SEQ_HIGH) << 16);
+        return;
+    }
+    /* an erase cut by a reset may leave any word programmed */
+    for(i = 0U; i < FMC_KV_PAGE_SIZE; i += 4U){
+        if(0xFFFFFFFFU != REG32(address + i)){
+            kv->page_state[page] = FMC_KV_PAGE_DIRTY;
+            return;
+        }
+    }
+    kv->page_state[page] = FMC_KV_PAGE_ERASED;
+    kv->erased++;
+}
+
+/*!
+    \brief      add the committed records of a valid page to the index
+    \param[in]  kv: store state
+    \param[in]  page: valid page of the store
+    \param[out] none
+    \retval     offset of the first erased record of the page, or the page size
+*/
+static uint32_t fmc_kv_page_scan(fmc_kv_struct *kv, uint32_t page)
+{
+    uint32_t address = FMC_KV_PAGE_ADDR(kv, page);
+    uint32_t offset = FMC_KV_HEADER_SIZE;
+    uint32_t key, length, size;
+
+    while((offset + FMC_KV_RECORD_SIZE(0U)) <= FMC_KV_PAGE_SIZE){
+        key = REG16(address + offset);
+        if(FMC_KV_ERASED == key){
+            break;
+        }
+        length = REG16(address + offset + 2U);
+        /* the key went out but not the length: the record ends there */
+        if(FMC_KV_ERASED == length){
+            kv->page_dead[page] += 4U;
+            kv->torn++;
+            offset += 4U;
+            continue;
+        }
+        size = fmc_kv_record_size(length);
+        if((0U == size) || ((offset + size) > FMC_KV_PAGE_SIZE)){
+            /* a torn length, nothing after it can be trusted */
+            kv->page_dead[page] += FMC_KV_PAGE_SIZE - offset;
+            kv->torn++;
+            return FMC_KV_PAGE_SIZE;
+        }
+        if(FMC_KV_MARK != REG16(address + offset + size - 2U)){
+            kv->page_dead[page] += size;
+            kv->torn++;
+        }else{
+            fmc_kv_index_set(kv, key, (FMC_KV_TOMBSTONE == length) ? 0U : (address + offset), size, page);
+        }
+        offset += size;
+    }
+    return offset;
+}
+
+/*!
+    \brief      get the bytes of a record from its length half word
+    \param[in]  length: length half word of the record
+    \param[out] none
+    \retval     bytes of the record, 0 for a length out of range
+*/
+static uint32_t fmc_kv_record_size(uint32_t length)
+{
+    if(FMC_KV_TOMBSTONE == length){
+        return FMC_KV_RECORD_SIZE(0U);
+    }
+    if(FMC_KV_VALUE_MAX < length){
+        return 0U;
+    }
+    return FMC_KV_RECORD_SIZE(length);
+}
+
+/*!
+    \brief      make a record the current one of its key; the record it
+                replaces, a deleting record and a key out of range count as
+                dead bytes of their pages
+    \param[in]  kv: store state
+    \param[in]  key: key of the record
+    \param[in]  address: address of the record, 0 when it deletes the key
+    \param[in]  size: bytes of the record
+    \param[in]  page: page holding the record
+    \param[out] none
+    \retval     none
+*/
+static void fmc_kv_index_set(fmc_kv_struct *kv, uint32_t key, uint32_t address, uint32_t size, uint32_t page)
+{
+    uint32_t old;
+
+    if(key >= kv->key_num){
+        kv->page_dead[page] += size;
+        return;
+    }
+    old = kv->index[key];
+    if(0U != old){
+        kv->page_dead[FMC_KV_PAGE_OF(kv, old)] += fmc_kv_record_size(REG16(old + 2U));
+    }
+    kv->index[key] = address;
+    if(0U == address){
+        kv->page_dead[page] += size;
+    }
+}
+
+/*!
+    \brief      append a record to the active page, opening the next erased
+                page when it does not fit; the index follows once the commit
+                marker is programmed
+    \param[in]  kv: store state
+    \param[in]  key: key of the record
+    \param[in]  length: bytes of the value, or FMC_KV_TOMBSTONE
+    \param[in]  data: value, NULL to copy it from src
+    \param[in]  src: flash address of the value when data is NULL
+    \param[in]  gc: 1 for the garbage collection, which may take the last erased page
+    \param[out] none
+    \retval     fmc_kv_result_enum: FMC_KV_OK, FMC_KV_FULL or an FMC error
+*/
+static fmc_kv_result_enum fmc_kv_append(fmc_kv_struct *kv, uint32_t key, uint32_t length, const uint8_t *data, uint32_t src, uint32_t gc)
+{
+    fmc_kv_result_enum result;
+    fmc_state_enum state;
+    uint32_t size = fmc_kv_record_size(length);
+    uint32_t address, half, i;
+
+    /* the collection runs in the last page, leave it the room of its copies */
+    if((0U == gc) && (kv->page_num != kv->gc_page) && (0U == kv->erased)
+       && ((kv->offset + size + kv->gc_need) > FMC_KV_PAGE_SIZE)){
+        return FMC_KV_FULL;
+    }
+    if((kv->page_num == kv->active) || ((kv->offset + size) > FMC_KV_PAGE_SIZE)){
+        result = fmc_kv_page_open(kv, gc);
+        if(FMC_KV_OK != result){
+            return result;
+        }
+    }
+    address = FMC_KV_PAGE_ADDR(kv, kv->active) + kv->offset;
+    kv->offset += size;
+
+    state = fmc_halfword_program(address, (uint16_t)key);
+    if(FMC_READY == state){
+        state = fmc_halfword_program(address + 2U, (uint16_t)length);
+    }
+    for(i = 0U; (FMC_READY == state) && ((i + 6U) < size); i += 2U){
+        if(NULL == data){
+            half = REG16(src + i);
+        }else{
+            half = data[i];
+            half |= ((i + 1U) < length) ? ((uint32_t)data[i + 1U] << 8) : 0xFF00U;
+        }
+        /* an erased half word needs no program */
+        if(FMC_KV_ERASED != half){
+            state = fmc_halfword_program(address + 4U + i, (uint16_t)half);
+        }
+    }
+    if(FMC_READY == state){
+        state = fmc_halfword_program(address + size - 2U, FMC_KV_MARK);
+    }
+    if(FMC_READY != state){
+        kv->page_dead[kv->active] += size;
+        return fmc_kv_result(state);
+    }
+    fmc_kv_index_set(kv, key, (FMC_KV_TOMBSTONE == length) ? 0U : address, size, kv->active);
+    return FMC_KV_OK;
+}
+
+/*!
+    \brief      open the next erased page after the active one, so the pages
+                are used in turn; the last erased page is left to the garbage
+                collection
+    \param[in]  kv: store state
+    \param[in]  gc: 1 for the garbage collection
+    \param[out] none
+    \retval     fmc_kv_result_enum: FMC_KV_OK, FMC_KV_FULL or an FMC error
+*/
+static fmc_kv_result_enum fmc_kv_page_open(fmc_kv_struct *kv, uint32_t gc)
+{
+    fmc_state_enum state;
+    uint32_t seq = kv->seq + 1U;
+    uint32_t page, address, i;
+
+    if((0U == kv->erased) || ((0U == gc) && (1U == kv->erased))){
+        return FMC_KV_FULL;
+    }
+    page = (kv->page_num == kv->active) ? 0U : kv->active;
+    for(i = 0U; i < kv->page_num; i++){
+        page = (page + 1U) % kv->page_num;
+        if(FMC_KV_PAGE_ERASED == kv->page_state[page]){
+            break;
+        }
+    }
+    address = FMC_KV_PAGE_ADDR(kv, page);
+    kv->erased--;
+
+    /* the valid marker goes last: a page cut before it is erased again */
+    state = fmc_halfword_program(address + FMC_KV_HDR_MAGIC, FMC_KV_MAGIC);
+    if(FMC_READY == state){
+        state = fmc_halfword_program(address + FMC_KV_HDR_SEQ_LOW, (uint16_t)seq);
+    }
+    if(FMC_READY == state){
+        state = fmc_halfword_program(address + FMC_KV_HDR_SEQ_HIGH, (uint16_t)(seq >> 16));
+    }
+    if(FMC_READY == state){
+        state = fmc_halfword_program(address + FMC_KV_HDR_VALID, FMC_KV_MARK);
+    }
+    if(FMC_READY != state){
+        kv->page_state[page] = FMC_KV_PAGE_DIRTY;
+        return fmc_kv_result(state);
+    }
+    kv->page_state[page] = FMC_KV_PAGE_VALID;
+    kv->page_seq[page] = seq;
+    kv->page_dead[page] = 0U;
+    kv->seq = seq;
+    kv->active = page;
+    kv->offset = FMC_KV_HEADER_SIZE;
+    return FMC_KV_OK;
+}
+
+/*!
+    \brief      get the bytes of the live records of a page
+    \param[in]  kv: store state
+    \param[in]  page: valid page of the store
+    \param[out] none
+    \retval     bytes of the records that are current for their keys
+*/
+static uint32_t fmc_kv_live_bytes(fmc_kv_struct *kv, uint32_t page)
+{
+    uint32_t address = FMC_KV_PAGE_ADDR(kv, page);
+    uint32_t live = 0U;
+    uint32_t key;
+
+    for(key = 0U; key < kv->key_num; key++){
+        if((kv->index[key] >= address) && (kv->index[key] < (address + FMC_KV_PAGE_SIZE))){
+            live += fmc_kv_record_size(REG16(kv->index[key] + 2U));
+        }
+    }
+    return live;
+}
+
+/*!
+    \brief      copy up to budget live records out of the page being
+                collected; once they are all copied the page is marked
+                obsolete and left for the next call to erase
+    \param[in]  kv: store state
+    \param[in]  budget: most records copied, at least 1
+    \param[out] none
+    \retval     fmc_kv_result_enum: FMC_KV_PENDING or an FMC error
+*/
+static fmc_kv_result_enum fmc_kv_collect(fmc_kv_struct *kv, uint32_t budget)
+{
+    fmc_kv_result_enum result;
+    fmc_state_enum state;
+    uint32_t address = FMC_KV_PAGE_ADDR(kv, kv->gc_page);
+    uint32_t key, length, size;
+
+    while((0U != budget) && ((kv->gc_offset + FMC_KV_RECORD_SIZE(0U)) <= FMC_KV_PAGE_SIZE)){
+        key = REG16(address + kv->gc_offset);
+        if(FMC_KV_ERASED == key){
+            break;
+        }
+        length = REG16(address + kv->gc_offset + 2U);
+        if(FMC_KV_ERASED == length){
+            kv->gc_offset += 4U;
+            continue;
+        }
+        size = fmc_kv_record_size(length);
+        if((0U == size) || ((kv->gc_offset + size) > FMC_KV_PAGE_SIZE)){
+            break;
+        }
+        /* only the current records of their keys are live */
+        if((key < kv->key_num) && ((address + kv->gc_offset) == kv->index[key])){
+            result = fmc_kv_append(kv, key, length, NULL, address + kv->gc_offset + 4U, 1U);
+            if(FMC_KV_OK != result){
+                return result;
+            }
+            kv->copies++;
+            kv->gc_need -= (size < kv->gc_need) ? size : kv->gc_need;
+            budget--;
+        }
+        kv->gc_offset += size;
+    }
+    if(0U != budget){
+        state = fmc_halfword_program(address + FMC_KV_HDR_OBSOLETE, FMC_KV_MARK);
+        if(FMC_READY != state){
+            return fmc_kv_result(state);
+        }
+        kv->page_state[kv->gc_page] = FMC_KV_PAGE_DIRTY;
+        kv->gc_page = kv->page_num;
+    }
+    return FMC_KV_PENDING;
+}
+
+/*!
+    \brief      convert an FMC state to a store result
+    \param[in]  state: state returned by the FMC functions
+    \param[out] none
+    \retval     fmc_kv_result_enum: result of the operation
+*/
+static fmc_kv_result_enum fmc_kv_result(fmc_state_enum state)
+{
+    switch(state){
+    case FMC_READY:
+        return FMC_KV_OK;
+    case FMC_PGERR:
+        return FMC_KV_PGERR;
+    case FMC_WPERR:
+        return FMC_KV_WPERR;
+    default:
+        return FMC_KV_TOERR;
+    }
+}
@@ -0,0 +1,497 @@
+/*!
+    \file  gd32vf103_fmc_log.c
+    \brief record log ring in the main flash with background erase
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103_fmc_log.h"
+#include "gd32vf103_crc.h"
+#include "gd32vf103_bench.h"
+#include "n200_func.h"
+
+#define FMC_LOG_ERASED                  0xFFFFFFFFU                 /* value of an erased word */
+#define FMC_LOG_HEADER_WORDS            3U                          /* sequence number, stamp and length */
+
+/* FMC operation in progress */
+#define FMC_LOG_IDLE                    0U
+#define FMC_LOG_PROGRAM                 1U
+#define FMC_LOG_ERASE                   2U
+
+/* get the address of a page of the log */
+#define FMC_LOG_PAGE_ADDR(log, page)    ((log)->start + ((page) * FMC_LOG_PAGE_SIZE))
+/* get the page after a page of the log */
+#define FMC_LOG_PAGE_NEXT(log, page)    ((((page) + 1U) < (log)->page_num) ? ((page) + 1U) : 0U)
+
+/* start the next FMC operation when the FMC is idle */
+static void fmc_log_kick(fmc_log_struct *log);
+/* start the erase of the page after the one written */
+static void fmc_log_erase_start(fmc_log_struct *log);
+/* check whether a whole page is erased */
+static uint32_t fmc_log_page_erased(fmc_log_struct *log, uint32_t page);
+/* get the data length of a record from its length word */
+static uint32_t fmc_log_length(uint32_t word);
+/* check the CRC of a record in the flash */
+static uint32_t fmc_log_crc_check(uint32_t address, uint32_t words);
+
+/*!
+    \brief      locate the head from the first record of each page, unlock the
+                FMC and enable its end of operation and error interrupts; the
+                erase of the page after the head starts at once when needed
+    \param[in]  log: log state
+    \param[in]  init_struct: the data needed to initialize the log
+                  start, page_num: 3 to FMC_LOG_PAGE_MAX pages in the main flash, page aligned
+                  buffer, size: RAM ring of words, a power of two of at least FMC_LOG_RECORD_WORDS(FMC_LOG_DATA_MAX)
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus fmc_log_init(fmc_log_struct *log, fmc_log_parameter_struct *init_struct)
+{
+    uint32_t address, first, bytes, len, page;
+    uint32_t head = FMC_LOG_PAGE_MAX;
+    uint32_t head_seq = 0U;
+
+    if((0U != (init_struct->start & (FMC_LOG_PAGE_SIZE - 1U))) || (0x08000000U > init_struct->start)
+       || (3U > init_struct->page_num) || (FMC_LOG_PAGE_MAX < init_struct->page_num) || (NULL == init_struct->buffer)
+       || (FMC_LOG_RECORD_WORDS(FMC_LOG_DATA_MAX) > init_struct->size)
+       || (0U != (init_struct->size & (init_struct->size - 1U)))){
+        return ERROR;
+    }
+
+    log->start = init_struct->start;
+    log->page_num = init_struct->page_num;
+    log->buffer = init_struct->buffer;
+    log->size = init_struct->size;
+    log->head = 0U;
+    log->tail = 0U;
+    log->seq = 0U;
+    log->page = 0U;
+    log->offset = 0U;
+    log->words = 0U;
+    log->busy = FMC_LOG_IDLE;
+    log->appended = 0U;
+    log->dropped = 0U;
+    log->written = 0U;
+    log->erases = 0U;
+    log->errors = 0U;
+    log->fill_max = 0U;
+    log->torn = 0U;
+    log->erased_map = 0U;
+
+    /* the head page opens with the highest sequence number; a first record without length is not trusted */
+    for(page = 0U; page < log->page_num; page++){
+        address = FMC_LOG_PAGE_ADDR(log, page);
+        first = REG32(address);
+        if((FMC_LOG_ERASED != first) && (0U != fmc_log_length(REG32(address + 8U)))
+           && ((FMC_LOG_PAGE_MAX == head) || (0 < (int32_t)(first - head_seq)))){
+            head = page;
+            head_seq = first;
+        }
+        if(0U != fmc_log_page_erased(log, page)){
+            log->erased_map |= BIT(page);
+        }
+    }
+
+    /* walk the head page to its end */
+    if(FMC_LOG_PAGE_MAX != head){
+        log->page = head;
+        address = FMC_LOG_PAGE_ADDR(log, head);
+        while((log->offset + ((FMC_LOG_HEADER_WORDS + 1U) << 2)) <= FMC_LOG_PAGE_SIZE){
+            first = REG32(address + log->offset);
+            if(FMC_LOG_ERASED == first){
+                break;
+            }
+            len = fmc_log_length(REG32(address + log->offset + 8U));
+            bytes = FMC_LOG_RECORD_WORDS(len - 1U) << 2;
+            if((0U == len) || ((log->offset + bytes) > FMC_LOG_PAGE_SIZE)){
+                log->offset = FMC_LOG_PAGE_SIZE;
+                break;
+            }
+            if(0U == fmc_log_crc_check(address + log->offset, bytes >> 2)){
+                log->torn++;
+            }
+            log->seq = first + 1U;
+            log->offset += bytes;
+        }
+    }
+    log->committed = log->offset;
+    log->erased_map &= ~BIT(log->page);
+    log->erase = (0U == (log->erased_map & BIT(FMC_LOG_PAGE_NEXT(log, log->page)))) ? 1U : 0U;
+
+    log->locked = FMC_CTL0 & FMC_CTL0_LK;
+    fmc_unlock();
+    fmc_flag_clear(FMC_FLAG_END);
+    fmc_flag_clear(FMC_FLAG_PGERR);
+    fmc_flag_clear(FMC_FLAG_WPERR);
+    /* the stamps come from mcycle */
+    bench_counters_hold();
+    fmc_log_kick(log);
+    fmc_interrupt_enable(FMC_INT_END);
+    fmc_interrupt_enable(FMC_INT_ERR);
+    return SUCCESS;
+}
+
+/*!
+    \brief      disable the FMC interrupts, wait for the operation in progress
+                and lock the FMC again if it was locked; the words still in
+                the RAM ring are not programmed
+    \param[in]  log: log state
+    \param[out] none
+    \retval     none
+*/
+void fmc_log_deinit(fmc_log_struct *log)
+{
+    fmc_interrupt_disable(FMC_INT_END);
+    fmc_interrupt_disable(FMC_INT_ERR);
+    fmc_ready_wait(FMC_TIMEOUT_COUNT);
+    FMC_CTL0 &= ~(FMC_CTL0_PG | FMC_CTL0_PER);
+    fmc_flag_clear(FMC_FLAG_END);
+    fmc_flag_clear(FMC_FLAG_PGERR);
+    fmc_flag_clear(FMC_FLAG_WPERR);
+    log->busy = FMC_LOG_IDLE;
+    if(0U != log->locked){
+        fmc_lock();
+    }
+    bench_counters_release();
+}
+
+/*!
+    \brief      append a record: it is stamped, numbered and checked by the CRC
+                unit into the RAM ring, and programmed from the FMC interrupt;
+                this never waits for the FMC
+    \param[in]  log: log state
+    \param[in]  data: bytes of the record
+    \param[in]  len: 0 to FMC_LOG_DATA_MAX bytes
+    \param[out] none
+    \retval     fmc_log_result_enum: FMC_LOG_OK, FMC_LOG_PARAM or FMC_LOG_FULL
+*/
+fmc_log_result_enum fmc_log_append(fmc_log_struct *log, const void *data, uint32_t len)
+{
+    const uint8_t *byte = (const uint8_t *)data;
+    uint32_t mask = log->size - 1U;
+    uint32_t words = FMC_LOG_RECORD_WORDS(len);
+    uint32_t head, word, fill, i;
+
+    if(FMC_LOG_DATA_MAX < len){
+        return FMC_LOG_PARAM;
+    }
+
+    fmc_interrupt_disable(FMC_INT_END);
+    fmc_interrupt_disable(FMC_INT_ERR);
+    fill = log->head - log->tail;
+    if(words > (log->size - fill)){
+        log->dropped++;
+        fmc_interrupt_enable(FMC_INT_END);
+        fmc_interrupt_enable(FMC_INT_ERR);
+        return FMC_LOG_FULL;
+    }
+
+    head = log->head;
+    crc_data_register_reset();
+    log->buffer[head & mask] = log->seq;
+    log->buffer[(head + 1U) & mask] = (uint32_t)get_cycle_value();
+    log->buffer[(head + 2U) & mask] = len | ((~len & 0xFFFFU) << 16);
+    for(i = 0U; i < FMC_LOG_HEADER_WORDS; i++){
+        CRC_DATA = log->buffer[head & mask];
+        head++;
+    }
+    /* data words in little endian order, the last one padded with erased bytes */
+    for(i = 0U; i < len; i += 4U){
+        word = FMC_LOG_ERASED;
+        word = (word & ~0x000000FFU) | byte[i];
+        if((i + 1U) < len){
+            word = (word & ~0x0000FF00U) | ((uint32_t)byte[i + 1U] << 8);
+        }
+        if((i + 2U) < len){
+            word = (word & ~0x00FF0000U) | ((uint32_t)byte[i + 2U] << 16);
+        }
+        if((i + 3U) < len){
+            word = (word & ~0xFF000000U) | ((uint32_t)byte[i + 3U] << 24);
+        }
+        CRC_DATA = word;
+        log->buffer[head & mask] = word;
+        head++;
+    }
+    log->buffer[head & mask] = CRC_DATA;
+    log->head = head + 1U;
+    log->seq++;
+    log->appended++;
+    if((fill + words) > log->fill_max){
+        log->fill_max = fill + words;
+    }
+    fmc_log_kick(log);
+
+    fmc_interrupt_enable(FMC_INT_END);
+    fmc_interrupt_enable(FMC_INT_ERR);
+    return FMC_LOG_OK;
+}
+
+/*!
+    \brief      get the number of words waiting in the RAM ring
+    \param[in]  log: log state
+    \param[out] none
+    \retval     words not yet programmed
+*/
+uint32_t fmc_log_pending(fmc_log_struct *log)
+{
+    return log->head - log->tail;
+}
+
+/*!
+    \brief      place a cursor on the oldest record, in the first page after
+                the one written that holds any
+    \param[in]  log: log state
+    \param[out] cursor: position of the oldest record
+    \retval     none
+*/
+void fmc_log_read_start(fmc_log_struct *log, fmc_log_cursor_struct *cursor)
+{
+    uint32_t page = log->page;
+    uint32_t i;
+
+    cursor->page = log->page;
+    cursor->offset = 0U;
+    for(i = 1U; i < log->page_num; i++){
+        page = FMC_LOG_PAGE_NEXT(log, page);
+        /* the page after the one written is being erased */
+        if((1U == i) && (0U != log->erase)){
+            continue;
+        }
+        if(FMC_LOG_ERASED != REG32(FMC_LOG_PAGE_ADDR(log, page))){
+            cursor->page = page;
+            break;
+        }
+    }
+}
+
+/*!
+    \brief      read the record at a cursor and move the cursor to the next
+                one; the records still in the RAM ring are not read
+    \param[in]  log: log state
+    \param[in]  cursor: position of the record
+    \param[in]  size: bytes of data, the record is cut to this length
+    \param[out] cursor: position of the next record
+    \param[out] record: sequence number, stamp and length of the record
+    \param[out] data: bytes of the record
+    \retval     fmc_log_result_enum: FMC_LOG_OK, FMC_LOG_CRC for a record
+                skipped, or FMC_LOG_END
+*/
+fmc_log_result_enum fmc_log_read(fmc_log_struct *log, fmc_log_cursor_struct *cursor, fmc_log_record_struct *record,
+                                 uint8_t *data, uint32_t size)
+{
+    uint32_t address, limit, len, words, i;
+    uint32_t word = 0U;
+
+    while(1){
+        address = FMC_LOG_PAGE_ADDR(log, cursor->page) + cursor->offset;
+        limit = (cursor->page == log->page) ? log->committed : FMC_LOG_PAGE_SIZE;
+        len = 0U;
+        if(((cursor->offset + ((FMC_LOG_HEADER_WORDS + 1U) << 2)) <= limit) && (FMC_LOG_ERASED != REG32(address))){
+            len = fmc_log_length(REG32(address + 8U));
+        }
+        words = FMC_LOG_RECORD_WORDS(len - 1U);
+        if((0U != len) && ((cursor->offset + (words << 2)) <= limit)){
+            break;
+        }
+        /* the rest of the page holds no record */
+        if(cursor->page == log->page){
+            return FMC_LOG_END;
+        }
+        cursor->page = FMC_LOG_PAGE_NEXT(log, cursor->page);
+        cursor->offset = 0U;
+    }
+
+    cursor->offset += words << 2;
+    if(0U == fmc_log_crc_check(address, words)){
+        return FMC_LOG_CRC;
+    }
+    record->seq = REG32(address);
+    record->stamp = REG32(address + 4U);
+    record->len = len - 1U;
+    for(i = 0U; (i < record->len) && (i < size); i++){
+        if(0U == (i & 0x3U)){
+            word = REG32(address + (FMC_LOG_HEADER_WORDS << 2) + i);
+        }
+        data[i] = (uint8_t)(word >> ((i & 0x3U) << 3));
+    }
+    return FMC_LOG_OK;
+}
+
+/*!
+    \brief      FMC interrupt handler of the log: end the operation in progress
+                and start the next one
+    \param[in]  log: log state
+    \param[out] none
+    \retval     none
+*/
+void fmc_log_irq_handler(fmc_log_struct *log)
+{
+    if(0U != (FMC_STAT0 & (FMC_STAT0_PGERR | FMC_STAT0_WPERR))){
+        log->errors++;
+        fmc_flag_clear(FMC_FLAG_PGERR);
+        fmc_flag_clear(FMC_FLAG_WPERR);
+    }
+    fmc_flag_clear(FMC_FLAG_END);
+    if(0U != (FMC_STAT0 & FMC_STAT0_BUSY)){
+        return;
+    }
+
+    if(FMC_LOG_ERASE == log->busy){
+        /* a failed erase is not retried, the programs into the page fail and count as errors */
+        FMC_CTL0 &= ~FMC_CTL0_PER;
+        log->erased_map |= BIT(FMC_LOG_PAGE_NEXT(log, log->page));
+        log->erase = 0U;
+        log->erases++;
+    }else if(FMC_LOG_PROGRAM == log->busy){
+        FMC_CTL0 &= ~FMC_CTL0_PG;
+        if(0U == log->words){
+            log->committed = log->offset;
+            log->written++;
+        }
+    }
+    log->busy = FMC_LOG_IDLE;
+    fmc_log_kick(log);
+}
+
+/*!
+    \brief      start the next FMC operation when the FMC is idle: the erase of
+                the page after the one written first, then the next word of
+                the RAM ring; a record that does not fit opens the next page
+    \param[in]  log: log state
+    \param[out] none
+    \retval     none
+*/
+static void fmc_log_kick(fmc_log_struct *log)
+{
+    uint32_t words;
+
+    if(FMC_LOG_IDLE != log->busy){
+        return;
+    }
+    if(0U != log->erase){
+        fmc_log_erase_start(log);
+        return;
+    }
+    if(log->head == log->tail){
+        return;
+    }
+    if(0U == log->words){
+        words = FMC_LOG_RECORD_WORDS(log->buffer[(log->tail + 2U) & (log->size - 1U)] & 0xFFFFU);
+        if((log->offset + (words << 2)) > FMC_LOG_PAGE_SIZE){
+            /* the next page was erased in advance, the one after it is erased now */
+            log->page = FMC_LOG_PAGE_NEXT(log, log->page);
+            log->offset = 0U;
+            log->committed = 0U;
+            log->erased_map &= ~BIT(log->page);
+            if(0U == (log->erased_map & BIT(FMC_LOG_PAGE_NEXT(log, log->page)))){
+                log->erase = 1U;
+                fmc_log_erase_start(log);
+                return;
+            }
+        }
+        log->words = words;
+    }
+    FMC_CTL0 |= FMC_CTL0_PG;
+    REG32(FMC_LOG_PAGE_ADDR(log, log->page) + log->offset) = log->buffer[log->tail & (log->size - 1U)];
+    log->busy = FMC_LOG_PROGRAM;
+    log->tail++;
+    log->offset += 4U;
+    log->words--;
+}
+
+/*!
+    \brief      start the erase of the page after the one written
+    \param[in]  log: log state
+    \param[out] none
+    \retval     none
+*/
+static void fmc_log_erase_start(fmc_log_struct *log)
+{
+    FMC_CTL0 |= FMC_CTL0_PER;
+    FMC_ADDR0 = FMC_LOG_PAGE_ADDR(log, FMC_LOG_PAGE_NEXT(log, log->page));
+    FMC_CTL0 |= FMC_CTL0_START;
+    log->busy = FMC_LOG_ERASE;
+}
+
+/*!
+    \brief      check whether a whole page is erased, an erase cut by a reset
+                may leave any word programmed
+    \param[in]  log: log state
+    \param[in]  page: page of the log
+    \param[out] none
+    \retval     1 if every word is erased, 0 otherwise
+*/
+static uint32_t fmc_log_page_erased(fmc_log_struct *log, uint32_t page)
+{
+    uint32_t address = FMC_LOG_PAGE_ADDR(log, page);
+    uint32_t i;
+
+    for(i = 0U; i < FMC_LOG_PAGE_SIZE; i += 4U){
+        if(FMC_LOG_ERASED != REG32(address + i)){
+            return 0U;
+        }
+    }
+    return 1U;
+}
+
+/*!
+    \brief      get the data length of a record from its length word, which
+                holds the length and its complement
+    \param[in]  word: length word of the record
+    \param[out] none
+    \retval     data length plus 1, 0 for a length word not valid
+*/
+static uint32_t fmc_log_length(uint32_t word)
+{
+    uint32_t len = word & 0xFFFFU;
+
+    if(((word >> 16) != (~len & 0xFFFFU)) || (FMC_LOG_DATA_MAX < len)){
+        return 0U;
+    }
+    return len + 1U;
+}
+
+/*!
+    \brief      check the CRC of a record in the flash with the CRC unit
+    \param[in]  address: first word of the record
+    \param[in]  words: words of the record, the CRC included
+    \param[out] none
+    \retval     1 if the CRC matches, 0 otherwise
+*/
+static uint32_t fmc_log_crc_check(uint32_t address, uint32_t words)
+{
+    uint32_t i;
+
+    crc_data_register_reset();
+    for(i = 0U; i < (words - 1U); i++){
+        CRC_DATA = REG32(address + (i << 2));
+    }
+    return (CRC_DATA == REG32(address + ((words - 1U) << 2))) ? 1U : 0U;
+}
@@ -0,0 +1,418 @@
+/*!
+    \file  gd32vf103_fmc_writer.c
+    \brief buffered flash writer with erase skip and CRC verify
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103_fmc_writer.h"
+#include "gd32vf103_crc.h"
+#include "gd32vf103_bench.h"
+#include "n200_func.h"
+
+/* get the page address of a flash address */
+#define FMC_WRITER_PAGE(address)        ((address) & ~(FMC_WRITER_PAGE_SIZE - 1U))
+/* check whether word x of a shadow has been merged */
+#define FMC_WRITER_WRITTEN(shadow, x)   (0U != ((shadow)->written[(x) >> 5] & BIT((x) & 0x1FU)))
+
+/* find the shadow of a page, or NULL */
+static fmc_writer_shadow_struct *fmc_writer_shadow_find(fmc_writer_struct *writer, uint32_t page);
+/* get the shadow of a page, flushing the least recently written one when none is free */
+static fmc_writer_result_enum fmc_writer_shadow_get(fmc_writer_struct *writer, uint32_t page, fmc_writer_shadow_struct **shadow);
+/* program a shadow into its page */
+static fmc_writer_result_enum fmc_writer_page_flush(fmc_writer_struct *writer, fmc_writer_shadow_struct *shadow);
+/* convert an FMC state to a writer result */
+static fmc_writer_result_enum fmc_writer_result(fmc_state_enum state);
+
+/*!
+    \brief      initialize the writer with all shadows unused
+    \param[in]  writer: writer state
+    \param[in]  init_struct: the data needed to initialize the writer
+                  start, size: area in the main flash, page aligned
+                  shadows, shadow_num: at least one shadow
+                  callback: end of a page flushed, or NULL
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus fmc_writer_init(fmc_writer_struct *writer, fmc_writer_parameter_struct *init_struct)
+{
+    uint32_t i;
+
+    if((0U == init_struct->size) || (0U != (init_struct->start & (FMC_WRITER_PAGE_SIZE - 1U)))
+       || (0U != (init_struct->size & (FMC_WRITER_PAGE_SIZE - 1U))) || (0x08000000U > init_struct->start)
+       || ((0xFFFFFFFFU - init_struct->start) < (init_struct->size - 1U))
+       || (NULL == init_struct->shadows) || (0U == init_struct->shadow_num)){
+        return ERROR;
+    }
+
+    writer->start = init_struct->start;
+    writer->size = init_struct->size;
+    writer->shadows = init_struct->shadows;
+    writer->shadow_num = init_struct->shadow_num;
+    writer->writes = 0U;
+    writer->callback = init_struct->callback;
+    writer->pages = 0U;
+    writer->erases = 0U;
+    writer->erases_skipped = 0U;
+    writer->programmed = 0U;
+    writer->skipped = 0U;
+    writer->errors = 0U;
+    for(i = 0U; i < writer->shadow_num; i++){
+        writer->shadows[i].page = FMC_WRITER_NO_PAGE;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      write a byte range into the shadows; nothing reaches the flash
+                until the page is flushed, by fmc_writer_flush() or to make
+                room for another page
+    \param[in]  writer: writer state
+    \param[in]  address: first byte, any alignment
+    \param[in]  data: bytes to write
+    \param[in]  len: number of bytes, may cross pages
+    \param[out] none
+    \retval     fmc_writer_result_enum: FMC_WRITER_OK, FMC_WRITER_RANGE or the
+                result of a page flushed to make room
+*/
+fmc_writer_result_enum fmc_writer_write(fmc_writer_struct *writer, uint32_t address, const uint8_t *data, uint32_t len)
+{
+    fmc_writer_shadow_struct *shadow = NULL;
+    fmc_writer_result_enum result;
+    uint32_t page = FMC_WRITER_NO_PAGE;
+    uint32_t index, shift;
+
+    if((address < writer->start) || (len > writer->size) || ((address - writer->start) > (writer->size - len))){
+        return FMC_WRITER_RANGE;
+    }
+    if(0U != len){
+        writer->writes++;
+    }
+    while(0U != len){
+        if(FMC_WRITER_PAGE(address) != page){
+            page = FMC_WRITER_PAGE(address);
+            result = fmc_writer_shadow_get(writer, page, &shadow);
+            if(FMC_WRITER_OK != result){
+                return result;
+            }
+            shadow->used = writer->writes;
+        }
+        index = (address - page) >> 2;
+        /* merge the word with the flash the first time it is touched */
+        if(!FMC_WRITER_WRITTEN(shadow, index)){
+            shadow->data[index] = REG32(page + (index << 2));
+            shadow->written[index >> 5] |= BIT(index & 0x1FU);
+        }
+        shift = (address & 0x3U) << 3;
+        shadow->data[index] = (shadow->data[index] & ~((uint32_t)0xFFU << shift)) | ((uint32_t)*data << shift);
+        data++;
+        address++;
+        len--;
+    }
+    return FMC_WRITER_OK;
+}
+
+/*!
+    \brief      read a byte range as it will be once flushed
+    \param[in]  writer: writer state
+    \param[in]  address: first byte, any alignment
+    \param[in]  len: number of bytes, may cross pages
+    \param[out] data: bytes read
+    \retval     fmc_writer_result_enum: FMC_WRITER_OK or FMC_WRITER_RANGE
+*/
+fmc_writer_result_enum fmc_writer_read(fmc_writer_struct *writer, uint32_t address, uint8_t *data, uint32_t len)
+{
+    fmc_writer_shadow_struct *shadow = NULL;
+    uint32_t page = FMC_WRITER_NO_PAGE;
+    uint32_t index, word;
+
+    if((address < writer->start) || (len > writer->size) || ((address - writer->start) > (writer->size - len))){
+        return FMC_WRITER_RANGE;
+    }
+    while(0U != len){
+        if(FMC_WRITER_PAGE(address) != page){
+            page = FMC_WRITER_PAGE(address);
+            shadow = fmc_writer_shadow_find(writer, page);
+        }
+        index = (address - page) >> 2;
+        if((NULL != shadow) && FMC_WRITER_WRITTEN(shadow, index)){
+            word = shadow->data[index];
+        }else{
+            word = REG32(page + (index << 2));
+        }
+        *data = (uint8_t)(word >> ((address & 0x3U) << 3));
+        data++;
+        address++;
+        len--;
+    }
+    return FMC_WRITER_OK;
+}
+
+/*!
+    \brief      flush every shadow in use to the flash; a shadow that fails
+                stays in use so the flush can be retried
+    \param[in]  writer: writer state
+    \param[out] none
+    \retval     fmc_writer_result_enum: FMC_WRITER_OK or the result of the
+                first page that failed
+*/
+fmc_writer_result_enum fmc_writer_flush(fmc_writer_struct *writer)
+{
+    fmc_writer_result_enum result = FMC_WRITER_OK;
+    fmc_writer_result_enum page_result;
+    uint32_t i;
+
+    for(i = 0U; i < writer->shadow_num; i++){
+        if(FMC_WRITER_NO_PAGE != writer->shadows[i].page){
+            page_result = fmc_writer_page_flush(writer, &writer->shadows[i]);
+            if((FMC_WRITER_OK != page_result) && (FMC_WRITER_OK == result)){
+                result = page_result;
+            }
+        }
+    }
+    return result;
+}
+
+/*!
+    \brief      find the shadow of a page
+    \param[in]  writer: writer state
+    \param[in]  page: page address
+    \param[out] none
+    \retval     shadow of the page, NULL if the page has none
+*/
+static fmc_writer_shadow_struct *fmc_writer_shadow_find(fmc_writer_struct *writer, uint32_t page)
+{
+    uint32_t i;
+
+    for(i = 0U; i < writer->shadow_num; i++){
+        if(page == writer->shadows[i].page){
+            return &writer->shadows[i];
+        }
+    }
+    return NULL;
+}
+
+/*!
+    \brief      get the shadow of a page; a page without one takes a free
+                shadow, or the least recently written one once it is flushed
+    \param[in]  writer: writer state
+    \param[in]  page: page address
+    \param[out] shadow: shadow of the page
+    \retval     fmc_writer_result_enum: FMC_WRITER_OK or the result of the
+                page flushed to make room
+*/
+static fmc_writer_result_enum fmc_writer_shadow_get(fmc_writer_struct *writer, uint32_t page, fmc_writer_shadow_struct **shadow)
+{
+    fmc_writer_shadow_struct *victim = NULL;
+    fmc_writer_result_enum result;
+    uint32_t i;
+
+    *shadow = fmc_writer_shadow_find(writer, page);
+    if(NULL != *shadow){
+        return FMC_WRITER_OK;
+    }
+    for(i = 0U; i < writer->shadow_num; i++){
+        if(FMC_WRITER_NO_PAGE == writer->shadows[i].page){
+            victim = &writer->shadows[i];
+            break;
+        }
+        /* the write count wraps, compare the distances to the current write */
+        if((NULL == victim) || ((writer->writes - writer->shadows[i].used) > (writer->writes - victim->used))){
+            victim = &writer->shadows[i];
+        }
+    }
+    if(FMC_WRITER_NO_PAGE != victim->page){
+        result = fmc_writer_page_flush(writer, victim);
+        if(FMC_WRITER_OK != result){
+            return result;
+        }
+    }
+    victim->page = page;
+    for(i = 0U; i < (FMC_WRITER_PAGE_WORDS / 32U); i++){
+        victim->written[i] = 0U;
+    }
+    *shadow = victim;
+    return FMC_WRITER_OK;
+}
+
+/*!
+    \brief      program a shadow into its page: erase only when a half word
+                that changes is not erased, program only the half words that
+                differ, then compare the CRC of the page with the CRC of the
+                shadow; the shadow is freed when the page is good
+    \param[in]  writer: writer state
+    \param[in]  shadow: shadow in use
+    \param[out] none
+    \retval     fmc_writer_result_enum: result of the page
+*/
+static fmc_writer_result_enum fmc_writer_page_flush(fmc_writer_struct *writer, fmc_writer_shadow_struct *shadow)
+{
+    fmc_writer_page_struct stats;
+    fmc_state_enum state = FMC_READY;
+    uint32_t diff[FMC_WRITER_PAGE_WORDS / 32U];
+    uint32_t page = shadow->page;
+    uint32_t locked, address, flash, changed, same = 0U;
+    uint64_t start;
+    uint32_t i;
+
+    bench_counters_hold();
+    start = get_cycle_value();
+    stats.page = page;
+    stats.erased = 0U;
+    stats.programmed = 0U;
+    stats.skipped = 0U;
+
+    /* complete the shadow with the words never written and find the words that differ */
+    for(i = 0U; i < FMC_WRITER_PAGE_WORDS; i++){
+        if(0U == (i & 0x1FU)){
+            diff[i >> 5] = 0U;
+        }
+        flash = REG32(page + (i << 2));
+        if(!FMC_WRITER_WRITTEN(shadow, i)){
+            shadow->data[i] = flash;
+            continue;
+        }
+        changed = flash ^ shadow->data[i];
+        if(0U == changed){
+            same++;
+        }else{
+            diff[i >> 5] |= BIT(i & 0x1FU);
+            /* a half word is programmed once after the erase */
+            if(((0U != (changed & 0x0000FFFFU)) && (0x0000FFFFU != (flash & 0x0000FFFFU)))
+               || ((0U != (changed & 0xFFFF0000U)) && (0xFFFF0000U != (flash & 0xFFFF0000U)))){
+                stats.erased = 1U;
+            }
+        }
+    }
+
+    locked = FMC_CTL0 & FMC_CTL0_LK;
+    fmc_unlock();
+    fmc_flag_clear(FMC_FLAG_END);
+    fmc_flag_clear(FMC_FLAG_PGERR);
+    fmc_flag_clear(FMC_FLAG_WPERR);
+    if(0U != stats.erased){
+        state = fmc_page_erase(page);
+    }else{
+        state = fmc_ready_wait(FMC_TIMEOUT_COUNT);
+    }
+    if(FMC_READY == state){
+        FMC_CTL0 |= FMC_CTL0_PG;
+        for(i = 0U; i < FMC_WRITER_PAGE_WORDS; i++){
+            address = page + (i << 2);
+            if(0U != stats.erased){
+                /* every word of the page comes back from the shadow */
+                if(0xFFFFFFFFU == shadow->data[i]){
+                    if(FMC_WRITER_WRITTEN(shadow, i)){
+                        stats.skipped++;
+                    }
+                    continue;
+                }
+                changed = 0xFFFFFFFFU;
+            }else{
+                if(0U == (diff[i >> 5] & BIT(i & 0x1FU))){
+                    continue;
+                }
+                changed = REG32(address) ^ shadow->data[i];
+            }
+            /* a half word that changes alone is programmed alone */
+            if(0U == (changed & 0xFFFF0000U)){
+                REG16(address) = (uint16_t)shadow->data[i];
+            }else if(0U == (changed & 0x0000FFFFU)){
+                REG16(address + 2U) = (uint16_t)(shadow->data[i] >> 16);
+            }else{
+                REG32(address) = shadow->data[i];
+            }
+            stats.programmed++;
+            state = fmc_ready_wait(FMC_TIMEOUT_COUNT);
+            if(FMC_READY != state){
+                break;
+            }
+        }
+        FMC_CTL0 &= ~FMC_CTL0_PG;
+    }
+    if(0U != locked){
+        fmc_lock();
+    }
+    if(0U == stats.erased){
+        stats.skipped = same;
+    }
+    stats.result = fmc_writer_result(state);
+
+    /* read the page back through the CRC unit */
+    crc_data_register_reset();
+    for(i = 0U; i < FMC_WRITER_PAGE_WORDS; i++){
+        CRC_DATA = REG32(page + (i << 2));
+    }
+    stats.crc = CRC_DATA;
+    crc_data_register_reset();
+    if((FMC_WRITER_OK == stats.result) && (stats.crc != crc_block_data_calculate(shadow->data, FMC_WRITER_PAGE_WORDS))){
+        stats.result = FMC_WRITER_VERIFY;
+    }
+    stats.cycles = (uint32_t)(get_cycle_value() - start);
+    bench_counters_release();
+
+    writer->pages++;
+    if(0U != stats.erased){
+        writer->erases++;
+    }else{
+        writer->erases_skipped++;
+    }
+    writer->programmed += stats.programmed;
+    writer->skipped += stats.skipped;
+    if(FMC_WRITER_OK == stats.result){
+        shadow->page = FMC_WRITER_NO_PAGE;
+    }else{
+        writer->errors++;
+    }
+    if(NULL != writer->callback){
+        writer->callback(writer, &stats);
+    }
+    return stats.result;
+}
+
+/*!
+    \brief      convert an FMC state to a writer result
+    \param[in]  state: state returned by the FMC functions
+    \param[out] none
+    \retval     fmc_writer_result_enum: result of the operation
+*/
+static fmc_writer_result_enum fmc_writer_result(fmc_state_enum state)
+{
+    switch(state){
+    case FMC_READY:
+        return FMC_WRITER_OK;
+    case FMC_PGERR:
+        return FMC_WRITER_PGERR;
+    case FMC_WPERR:
+        return FMC_WRITER_WPERR;
+    default:
+        return FMC_WRITER_TOERR;
+    }
+}
@@ -0,0 +1,148 @@
+/*!
+    \file  gd32vf103_gpio_pinmap.c
+    \brief GPIO pin map driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_gpio_pinmap.h"
+
+#define PINMAP_PORT_SIZE                ((uint32_t)0x00000400U)     /*!< address distance of two GPIO ports */
+#define PINMAP_REMAP_PCF1               ((uint32_t)0x80000000U)     /*!< remap value selects AFIO_PCF1 */
+#define PINMAP_REMAP_LOCATION1          ((uint32_t)0x00200000U)     /*!< remap bits are in the upper half of AFIO_PCF0 */
+#define PINMAP_REMAP_SWJ                ((uint32_t)0x00300000U)     /*!< remap value is a SWJ_CFG setting */
+#define PINMAP_PCF0_SWJ_MASK            ((uint32_t)0x07000000U)     /*!< SWJ_CFG bits of AFIO_PCF0 */
+
+/*!
+    \brief      compile a pin table and a remap list into register images
+    \param[in]  table: pin map entries, each pin may appear only once
+    \param[in]  count: number of entries
+    \param[in]  remap: GPIO_x_REMAP values as taken by gpio_pin_remap_config, or NULL
+    \param[in]  remap_count: number of remap values
+    \param[out] image: register images
+    \retval     ErrStatus: SUCCESS, or ERROR for a bad port or a pin listed twice
+*/
+ErrStatus gpio_pinmap_compile(const gpio_pinmap_entry_struct *table, uint32_t count,
+                              const uint32_t *remap, uint32_t remap_count, gpio_pinmap_image_struct *image)
+{
+    uint32_t defined[GPIO_PINMAP_PORT_NUM] = {0U};
+    uint32_t i, n, index, cfg, octl;
+
+    for(index = 0U; index < GPIO_PINMAP_PORT_NUM; index++){
+        image->port[index].gpio_periph = GPIOA + (index * PINMAP_PORT_SIZE);
+        image->port[index].ctl0 = GPIO_PINMAP_CTL_RESET;
+        image->port[index].ctl1 = GPIO_PINMAP_CTL_RESET;
+        image->port[index].octl = 0U;
+    }
+    image->port_used = 0U;
+    image->remap_used = 0U;
+    image->pcf0 = 0U;
+    image->pcf1 = 0U;
+
+    for(i = 0U; i < count; i++){
+        index = (table[i].gpio_periph - GPIOA) / PINMAP_PORT_SIZE;
+        if((table[i].gpio_periph < GPIOA) || (index >= GPIO_PINMAP_PORT_NUM)
+           || (0U != ((table[i].gpio_periph - GPIOA) % PINMAP_PORT_SIZE))){
+            return ERROR;
+        }
+        if((0U == (table[i].pin & GPIO_PIN_ALL)) || (0U != (table[i].pin & defined[index]))){
+            return ERROR;
+        }
+        defined[index] |= table[i].pin & GPIO_PIN_ALL;
+        image->port_used |= BIT(index);
+
+        cfg = GPIO_PINMAP_CFG(table[i].mode, table[i].speed);
+        for(n = 0U; n < 16U; n++){
+            if(0U == (table[i].pin & BIT(n))){
+                continue;
+            }
+            octl = GPIO_PINMAP_OCTL(n, table[i].mode, table[i].level);
+            if(n < 8U){
+                image->port[index].ctl0 = (image->port[index].ctl0 & ~GPIO_MODE_MASK(n)) | GPIO_MODE_SET(n, cfg);
+            }else{
+                image->port[index].ctl1 = (image->port[index].ctl1 & ~GPIO_MODE_MASK(n - 8U)) | GPIO_MODE_SET(n - 8U, cfg);
+            }
+            image->port[index].octl |= octl;
+        }
+    }
+
+    for(i = 0U; i < remap_count; i++){
+        image->remap_used = 1U;
+        if(PINMAP_REMAP_PCF1 == (remap[i] & PINMAP_REMAP_PCF1)){
+            image->pcf1 |= remap[i] & 0xFFFFU;
+        }else if(PINMAP_REMAP_SWJ == (remap[i] & PINMAP_REMAP_SWJ)){
+            image->pcf0 = (image->pcf0 & ~PINMAP_PCF0_SWJ_MASK) | (((remap[i] & 0xFFFFU) << 16) & PINMAP_PCF0_SWJ_MASK);
+        }else if(PINMAP_REMAP_LOCATION1 == (remap[i] & PINMAP_REMAP_LOCATION1)){
+            /* the SWJ_CFG bits of these values are not part of the remapping */
+            image->pcf0 |= ((remap[i] & 0xFFFFU) << 16) & ~PINMAP_PCF0_SWJ_MASK;
+        }else{
+            image->pcf0 |= remap[i] & 0xFFFFU;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      write the register images of a compiled pin map
+    \param[in]  image: register images made by gpio_pinmap_compile
+    \param[out] none
+    \retval     none
+*/
+void gpio_pinmap_apply(const gpio_pinmap_image_struct *image)
+{
+    uint32_t index;
+
+    /* route the alternate functions before the pins are switched to them */
+    if(0U != image->remap_used){
+        AFIO_PCF0 = image->pcf0;
+        AFIO_PCF1 = image->pcf1;
+    }
+    for(index = 0U; index < GPIO_PINMAP_PORT_NUM; index++){
+        if(0U != (image->port_used & BIT(index))){
+            gpio_port_image_apply(&image->port[index]);
+        }
+    }
+}
+
+/*!
+    \brief      write the register image of one port
+    \param[in]  port: register image of the port
+    \param[out] none
+    \retval     none
+*/
+void gpio_port_image_apply(const gpio_port_image_struct *port)
+{
+    /* output levels and pull directions first, so no pin glitches when it turns into an output */
+    GPIO_OCTL(port->gpio_periph) = port->octl;
+    GPIO_CTL0(port->gpio_periph) = port->ctl0;
+    GPIO_CTL1(port->gpio_periph) = port->ctl1;
+}
@@ -612,6 +612,7 @@ void i2c_flag_clear(uint32_t i2c_periph, i2c_flag_enum flag)
         /* read I2C_STAT0 and then read I2C_STAT1 to clear ADDSEND */
         temp = I2C_STAT0(i2c_periph);
         temp = I2C_STAT1(i2c_periph);
+        (void)temp;
     } else {
         I2C_REG_VAL(i2c_periph, flag) &= ~BIT(I2C_BIT_POS(flag));
     }
@@ -720,6 +721,7 @@ void i2c_interrupt_flag_clear(uint32_t i2c_periph,i2c_interrupt_flag_enum int_fl
         /* read I2C_STAT0 and then read I2C_STAT1 to clear ADDSEND */
         temp = I2C_STAT0(i2c_periph);
         temp = I2C_STAT1(i2c_periph);
+        (void)temp;
     } else {
         I2C_REG_VAL2(i2c_periph, int_flag) &= ~BIT(I2C_BIT_POS2(int_flag));
     }
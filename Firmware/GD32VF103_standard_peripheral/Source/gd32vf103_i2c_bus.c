@@ -0,0 +1,590 @@
+/*!
+    \file  gd32vf103_i2c_bus.c
+    \brief interrupt driven I2C master transaction queue
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_i2c_bus.h"
+
+/* steps of the running transaction */
+#define I2C_BUS_IDLE                    0U                          /*!< no transaction on the bus */
+#define I2C_BUS_START_TX                1U                          /*!< START for the write part requested */
+#define I2C_BUS_ADDR_TX                 2U                          /*!< address sent for a write */
+#define I2C_BUS_TX                      3U                          /*!< write bytes moved on TBE */
+#define I2C_BUS_TX_DMA                  4U                          /*!< write bytes moved by the DMA */
+#define I2C_BUS_TX_LAST                 5U                          /*!< last byte written, waiting for BTC */
+#define I2C_BUS_START_RX                6U                          /*!< START for the read part requested */
+#define I2C_BUS_ADDR_RX                 7U                          /*!< address sent for a read */
+#define I2C_BUS_RX                      8U                          /*!< read bytes moved on RBNE */
+#define I2C_BUS_RX_BTC                  9U                          /*!< two bytes left to read plus one on the bus, waiting for BTC */
+#define I2C_BUS_RX_LAST                 10U                         /*!< STOP requested, waiting for the last byte */
+#define I2C_BUS_RX_DMA                  11U                         /*!< read bytes moved by the DMA */
+
+#define I2C_BUS_ERRORS                  (I2C_STAT0_BERR | I2C_STAT0_LOSTARB | I2C_STAT0_AERR | I2C_STAT0_OUERR)
+
+/* start the oldest queued transaction if the bus is idle */
+static void i2c_bus_kick(i2c_bus_struct *bus);
+/* start the write payload after the address was acknowledged */
+static void i2c_bus_tx_start(i2c_bus_struct *bus, i2c_xfer_struct *xfer);
+/* go on with the read part or stop after the write part */
+static void i2c_bus_tx_end(i2c_bus_struct *bus, i2c_xfer_struct *xfer);
+/* start the read payload, ADDSEND is cleared here */
+static void i2c_bus_rx_start(i2c_bus_struct *bus, i2c_xfer_struct *xfer);
+/* commit a payload transfer to a DMA channel */
+static void i2c_bus_dma_start(i2c_bus_struct *bus, dma_channel_enum channelx, uint8_t direction, const uint8_t *buf, uint32_t len);
+/* end the running transaction and start the next one */
+static void i2c_bus_complete(i2c_bus_struct *bus, uint32_t status);
+
+/*!
+    \brief      fill a write-then-read transaction
+    \param[in]  xfer: I2C transaction descriptor
+    \param[in]  addr: slave address in bits 7:1
+    \param[in]  tx_buf: bytes written to the slave, usually the register address
+    \param[in]  tx_len: number of bytes written, 0 for a plain read
+    \param[in]  rx_buf: buffer receiving the bytes read after a repeated start
+    \param[in]  rx_len: number of bytes read, 0 for a plain write
+    \param[in]  callback: called from the interrupt when the transaction ends, or NULL
+    \param[out] none
+    \retval     none
+*/
+void i2c_xfer_prepare(i2c_xfer_struct *xfer, uint32_t addr, const uint8_t *tx_buf, uint32_t tx_len,
+                      uint8_t *rx_buf, uint32_t rx_len, void (*callback)(i2c_xfer_struct *xfer))
+{
+    xfer->addr = addr & 0xFEU;
+    xfer->tx_buf = tx_buf;
+    xfer->tx_len = tx_len;
+    xfer->rx_buf = rx_buf;
+    xfer->rx_len = rx_len;
+    xfer->callback = callback;
+    xfer->status = I2C_XFER_IDLE;
+}
+
+/*!
+    \brief      initialize the transaction queue of an I2C peripheral, the I2C
+                must be configured and enabled
+    \param[in]  bus: I2C transaction queue
+    \param[in]  i2c_periph: I2Cx(x=0,1)
+    \param[in]  slots: queue storage of size transaction pointers
+    \param[in]  size: number of slots, a power of two
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus i2c_bus_init(i2c_bus_struct *bus, uint32_t i2c_periph, i2c_xfer_struct **slots, uint32_t size)
+{
+    if((0U == size) || (0U != (size & (size - 1U)))){
+        return ERROR;
+    }
+
+    bus->i2c_periph = i2c_periph;
+    bus->dma_periph = 0U;
+    bus->dma_tx = DMA_CH0;
+    bus->dma_rx = DMA_CH0;
+    bus->dma_threshold = I2C_BUS_DMA_THRESHOLD;
+    bus->timer_periph = 0U;
+    bus->slots = slots;
+    bus->size = size;
+    bus->head = 0U;
+    bus->tail = 0U;
+    bus->busy = 0U;
+    bus->state = I2C_BUS_IDLE;
+    bus->index = 0U;
+
+    I2C_CTL1(i2c_periph) &= ~(I2C_CTL1_EVIE | I2C_CTL1_ERRIE | I2C_CTL1_BUFIE | I2C_CTL1_DMAON | I2C_CTL1_DMALST);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      let the queue move long payloads through the DMA channels of the
+                I2C, DMA0 channel 5 and 6 for I2C0, channel 3 and 4 for I2C1;
+                call it while the queue is empty
+    \param[in]  bus: I2C transaction queue
+    \param[in]  dma_periph: DMA0, or 0 to move every byte by the CPU
+    \param[in]  threshold: shortest payload in bytes handed to the DMA, at least 2
+    \param[out] none
+    \retval     none
+*/
+void i2c_bus_dma_config(i2c_bus_struct *bus, uint32_t dma_periph, uint32_t threshold)
+{
+    bus->dma_periph = dma_periph;
+    if(I2C0 == bus->i2c_periph){
+        bus->dma_tx = DMA_CH5;
+        bus->dma_rx = DMA_CH6;
+    }else{
+        bus->dma_tx = DMA_CH3;
+        bus->dma_rx = DMA_CH4;
+    }
+    /* the DMA read ends with DMALST, which needs two bytes at least */
+    bus->dma_threshold = (threshold < 2U) ? 2U : threshold;
+}
+
+/*!
+    \brief      let a one-shot timer start the next transaction once the STOP of
+                the previous one is on the bus, the timer is configured here and
+                its update interrupt calls i2c_bus_timer_irq_handler; call it
+                while the queue is empty
+    \param[in]  bus: I2C transaction queue
+    \param[in]  timer_periph: TIMERx(x=0..6), or 0 to leave it to i2c_bus_poll()
+    \param[in]  ticks: timer clock cycles between two checks of the STOP bit,
+                about one SCL period, 2 to 65536
+    \param[out] none
+    \retval     none
+*/
+void i2c_bus_timer_config(i2c_bus_struct *bus, uint32_t timer_periph, uint32_t ticks)
+{
+    bus->timer_periph = timer_periph;
+    if(0U == timer_periph){
+        return;
+    }
+
+    ticks = (ticks < 2U) ? 2U : ((ticks > 0x10000U) ? 0x10000U : ticks);
+    /* the counter stops after one overflow, UPS keeps UPG off the update flag */
+    TIMER_CTL0(timer_periph) = TIMER_CTL0_SPM | TIMER_CTL0_UPS;
+    TIMER_PSC(timer_periph) = 0U;
+    TIMER_CAR(timer_periph) = ticks - 1U;
+    TIMER_SWEVG(timer_periph) = TIMER_SWEVG_UPG;
+    TIMER_INTF(timer_periph) = ~TIMER_INTF_UPIF;
+    TIMER_DMAINTEN(timer_periph) = TIMER_DMAINTEN_UPIE;
+}
+
+/*!
+    \brief      append a transaction to a queue, it starts at once if the bus is idle
+    \param[in]  bus: I2C transaction queue
+    \param[in]  xfer: I2C transaction prepared by i2c_xfer_prepare, not queued elsewhere
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if the queue is full or the transaction is still queued
+*/
+ErrStatus i2c_bus_submit(i2c_bus_struct *bus, i2c_xfer_struct *xfer)
+{
+    uint32_t head = bus->head;
+
+    if((I2C_XFER_QUEUED == xfer->status) || (I2C_XFER_ACTIVE == xfer->status)){
+        return ERROR;
+    }
+    if((head - __atomic_load_n(&bus->tail, __ATOMIC_ACQUIRE)) == bus->size){
+        return ERROR;
+    }
+
+    xfer->status = I2C_XFER_QUEUED;
+    bus->slots[head & (bus->size - 1U)] = xfer;
+    __atomic_store_n(&bus->head, head + 1U, __ATOMIC_RELEASE);
+
+    i2c_bus_kick(bus);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      start the oldest queued transaction if the STOP of the previous
+                one is on the bus; without a timer, call it from the submitting
+                context while transactions are pending
+    \param[in]  bus: I2C transaction queue
+    \param[out] none
+    \retval     none
+*/
+void i2c_bus_poll(i2c_bus_struct *bus)
+{
+    i2c_bus_kick(bus);
+}
+
+/*!
+    \brief      get the number of transactions queued or running
+    \param[in]  bus: I2C transaction queue
+    \param[out] none
+    \retval     number of transactions
+*/
+uint32_t i2c_bus_pending_get(i2c_bus_struct *bus)
+{
+    return bus->head - __atomic_load_n(&bus->tail, __ATOMIC_ACQUIRE);
+}
+
+/*!
+    \brief      I2C event interrupt service, moves the running transaction on
+    \param[in]  bus: I2C transaction queue
+    \param[out] none
+    \retval     none
+*/
+void i2c_bus_event_irq_handler(i2c_bus_struct *bus)
+{
+    uint32_t i2c_periph = bus->i2c_periph;
+    uint32_t stat0 = I2C_STAT0(i2c_periph);
+    i2c_xfer_struct *xfer;
+
+    if(0U == bus->busy){
+        return;
+    }
+    xfer = bus->slots[bus->tail & (bus->size - 1U)];
+
+    switch(bus->state){
+    case I2C_BUS_START_TX:
+        if(0U != (stat0 & I2C_STAT0_SBSEND)){
+            I2C_DATA(i2c_periph) = xfer->addr;
+            bus->state = I2C_BUS_ADDR_TX;
+        }
+        break;
+    case I2C_BUS_ADDR_TX:
+        if(0U != (stat0 & I2C_STAT0_ADDSEND)){
+            (void)I2C_STAT1(i2c_periph);
+            i2c_bus_tx_start(bus, xfer);
+        }
+        break;
+    case I2C_BUS_TX:
+        if(0U != (stat0 & I2C_STAT0_TBE)){
+            I2C_DATA(i2c_periph) = xfer->tx_buf[bus->index++];
+            if(bus->index == xfer->tx_len){
+                I2C_CTL1(i2c_periph) &= ~I2C_CTL1_BUFIE;
+                bus->state = I2C_BUS_TX_LAST;
+            }
+        }
+        break;
+    case I2C_BUS_TX_LAST:
+        if(0U != (stat0 & I2C_STAT0_BTC)){
+            i2c_bus_tx_end(bus, xfer);
+        }
+        break;
+    case I2C_BUS_START_RX:
+        if(0U != (stat0 & I2C_STAT0_SBSEND)){
+            if(2U == xfer->rx_len){
+                /* ACKEN now answers the byte after the one on the bus */
+                I2C_CTL0(i2c_periph) |= I2C_CTL0_POAP;
+            }
+            I2C_DATA(i2c_periph) = xfer->addr | 0x01U;
+            bus->state = I2C_BUS_ADDR_RX;
+        }
+        break;
+    case I2C_BUS_ADDR_RX:
+        if(0U != (stat0 & I2C_STAT0_ADDSEND)){
+            i2c_bus_rx_start(bus, xfer);
+        }
+        break;
+    case I2C_BUS_RX:
+        if(0U != (stat0 & I2C_STAT0_RBNE)){
+            xfer->rx_buf[bus->index++] = (uint8_t)I2C_DATA(i2c_periph);
+            if(3U == (xfer->rx_len - bus->index)){
+                I2C_CTL1(i2c_periph) &= ~I2C_CTL1_BUFIE;
+                bus->state = I2C_BUS_RX_BTC;
+            }
+        }
+        break;
+    case I2C_BUS_RX_BTC:
+        if(0U != (stat0 & I2C_STAT0_BTC)){
+            if(2U == (xfer->rx_len - bus->index)){
+                /* both bytes are in, the second one was not acknowledged */
+                I2C_CTL0(i2c_periph) |= I2C_CTL0_STOP;
+                xfer->rx_buf[bus->index++] = (uint8_t)I2C_DATA(i2c_periph);
+                xfer->rx_buf[bus->index++] = (uint8_t)I2C_DATA(i2c_periph);
+                i2c_bus_complete(bus, I2C_XFER_DONE);
+            }else{
+                /* N-2 in DATA and N-1 in the shift register: NACK byte N and stop after it */
+                I2C_CTL0(i2c_periph) &= ~I2C_CTL0_ACKEN;
+                xfer->rx_buf[bus->index++] = (uint8_t)I2C_DATA(i2c_periph);
+                I2C_CTL0(i2c_periph) |= I2C_CTL0_STOP;
+                xfer->rx_buf[bus->index++] = (uint8_t)I2C_DATA(i2c_periph);
+                I2C_CTL1(i2c_periph) |= I2C_CTL1_BUFIE;
+                bus->state = I2C_BUS_RX_LAST;
+            }
+        }
+        break;
+    case I2C_BUS_RX_LAST:
+        if(0U != (stat0 & I2C_STAT0_RBNE)){
+            xfer->rx_buf[bus->index++] = (uint8_t)I2C_DATA(i2c_periph);
+            i2c_bus_complete(bus, I2C_XFER_DONE);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+    \brief      I2C error interrupt service, ends the running transaction with NACK or ERROR
+    \param[in]  bus: I2C transaction queue
+    \param[out] none
+    \retval     none
+*/
+void i2c_bus_error_irq_handler(i2c_bus_struct *bus)
+{
+    uint32_t i2c_periph = bus->i2c_periph;
+    uint32_t errors = I2C_STAT0(i2c_periph) & I2C_BUS_ERRORS;
+
+    if(0U == errors){
+        return;
+    }
+    /* the error flags are cleared by writing 0, the other bits ignore the write */
+    I2C_STAT0(i2c_periph) = ~errors;
+
+    if(0U == bus->busy){
+        return;
+    }
+    if(0U != bus->dma_periph){
+        DMA_CHCTL(bus->dma_periph, bus->dma_tx) = DMA_CHCTL_RESET_VALUE;
+        DMA_CHCTL(bus->dma_periph, bus->dma_rx) = DMA_CHCTL_RESET_VALUE;
+    }
+    /* after a lost arbitration the I2C is no longer master and must not stop */
+    if(0U == (errors & I2C_STAT0_LOSTARB)){
+        I2C_CTL0(i2c_periph) |= I2C_CTL0_STOP;
+    }
+    i2c_bus_complete(bus, (I2C_STAT0_AERR == errors) ? I2C_XFER_NACK : I2C_XFER_ERROR);
+}
+
+/*!
+    \brief      timer update interrupt service, starts the next transaction after a STOP
+    \param[in]  bus: I2C transaction queue
+    \param[out] none
+    \retval     none
+*/
+void i2c_bus_timer_irq_handler(i2c_bus_struct *bus)
+{
+    uint32_t timer_periph = bus->timer_periph;
+
+    if((0U == timer_periph) || (0U == (TIMER_INTF(timer_periph) & TIMER_INTF_UPIF))){
+        return;
+    }
+    TIMER_INTF(timer_periph) = ~TIMER_INTF_UPIF;
+    /* arms the timer again if the STOP is still going out */
+    i2c_bus_kick(bus);
+}
+
+/*!
+    \brief      DMA channel interrupt service of both I2C channels, ends a DMA payload
+    \param[in]  bus: I2C transaction queue
+    \param[out] none
+    \retval     none
+*/
+void i2c_bus_dma_irq_handler(i2c_bus_struct *bus)
+{
+    dma_channel_enum channelx;
+    uint32_t flags;
+
+    if((0U == bus->busy) || ((I2C_BUS_TX_DMA != bus->state) && (I2C_BUS_RX_DMA != bus->state))){
+        return;
+    }
+    channelx = (I2C_BUS_RX_DMA == bus->state) ? bus->dma_rx : bus->dma_tx;
+    flags = DMA_INTF(bus->dma_periph) >> (channelx * 4U);
+    if(0U == (flags & (DMA_INTF_FTFIF | DMA_INTF_ERRIF))){
+        return;
+    }
+    DMA_INTC(bus->dma_periph) = DMA_FLAG_ADD(DMA_INTC_GIFC, channelx);
+    DMA_CHCTL(bus->dma_periph, channelx) = DMA_CHCTL_RESET_VALUE;
+
+    if(0U != (flags & DMA_INTF_ERRIF)){
+        I2C_CTL0(bus->i2c_periph) |= I2C_CTL0_STOP;
+        i2c_bus_complete(bus, I2C_XFER_ERROR);
+    }else if(I2C_BUS_RX_DMA == bus->state){
+        /* DMALST made the I2C answer the last byte with a NACK */
+        I2C_CTL0(bus->i2c_periph) |= I2C_CTL0_STOP;
+        i2c_bus_complete(bus, I2C_XFER_DONE);
+    }else{
+        /* the last byte may still be on the bus, BTC tells when it is out */
+        bus->state = I2C_BUS_TX_LAST;
+        I2C_CTL1(bus->i2c_periph) = (I2C_CTL1(bus->i2c_periph) & ~I2C_CTL1_DMAON) | I2C_CTL1_EVIE;
+    }
+}
+
+/*!
+    \brief      start the oldest queued transaction if the bus is idle
+    \param[in]  bus: I2C transaction queue
+    \param[out] none
+    \retval     none
+*/
+static void i2c_bus_kick(i2c_bus_struct *bus)
+{
+    uint32_t i2c_periph = bus->i2c_periph;
+    i2c_xfer_struct *xfer;
+
+    if(__atomic_load_n(&bus->head, __ATOMIC_ACQUIRE) == bus->tail){
+        return;
+    }
+    /* both the submitter and the interrupts kick, the exchange elects one of them */
+    if(0U != __atomic_exchange_n(&bus->busy, 1U, __ATOMIC_ACQ_REL)){
+        return;
+    }
+    if(bus->head == bus->tail){
+        /* an interrupt emptied the queue between the check and the election */
+        __atomic_store_n(&bus->busy, 0U, __ATOMIC_RELEASE);
+        return;
+    }
+    /* the STOP of the previous transaction has to be on the bus before the next
+       START; rather than wait for it here, maybe in an interrupt, look again
+       when the timer expires or at the next i2c_bus_poll() */
+    if(0U != (I2C_CTL0(i2c_periph) & I2C_CTL0_STOP)){
+        __atomic_store_n(&bus->busy, 0U, __ATOMIC_RELEASE);
+        if(0U != bus->timer_periph){
+            TIMER_CTL0(bus->timer_periph) |= TIMER_CTL0_CEN;
+        }
+        return;
+    }
+
+    xfer = bus->slots[bus->tail & (bus->size - 1U)];
+    xfer->status = I2C_XFER_ACTIVE;
+    bus->index = 0U;
+    bus->state = ((0U != xfer->tx_len) || (0U == xfer->rx_len)) ? I2C_BUS_START_TX : I2C_BUS_START_RX;
+
+    I2C_CTL1(i2c_periph) |= I2C_CTL1_EVIE | I2C_CTL1_ERRIE;
+    I2C_CTL0(i2c_periph) = (I2C_CTL0(i2c_periph) & ~I2C_CTL0_POAP) | I2C_CTL0_ACKEN | I2C_CTL0_START;
+}
+
+/*!
+    \brief      start the write payload after the address was acknowledged
+    \param[in]  bus: I2C transaction queue
+    \param[in]  xfer: running transaction
+    \param[out] none
+    \retval     none
+*/
+static void i2c_bus_tx_start(i2c_bus_struct *bus, i2c_xfer_struct *xfer)
+{
+    if(0U == xfer->tx_len){
+        i2c_bus_tx_end(bus, xfer);
+    }else if((0U != bus->dma_periph) && (xfer->tx_len >= bus->dma_threshold)){
+        i2c_bus_dma_start(bus, bus->dma_tx, DMA_MEMORY_TO_PERIPHERAL, xfer->tx_buf, xfer->tx_len);
+        bus->state = I2C_BUS_TX_DMA;
+        /* no event is served while the DMA owns the payload: a BTC set before
+           the DMA interrupt runs would raise the event interrupt again and again */
+        I2C_CTL1(bus->i2c_periph) = (I2C_CTL1(bus->i2c_periph) & ~I2C_CTL1_EVIE) | I2C_CTL1_DMAON;
+    }else{
+        bus->state = I2C_BUS_TX;
+        I2C_CTL1(bus->i2c_periph) |= I2C_CTL1_BUFIE;
+    }
+}
+
+/*!
+    \brief      go on with the read part or stop after the write part
+    \param[in]  bus: I2C transaction queue
+    \param[in]  xfer: running transaction
+    \param[out] none
+    \retval     none
+*/
+static void i2c_bus_tx_end(i2c_bus_struct *bus, i2c_xfer_struct *xfer)
+{
+    if(0U != xfer->rx_len){
+        bus->state = I2C_BUS_START_RX;
+        bus->index = 0U;
+        I2C_CTL0(bus->i2c_periph) |= I2C_CTL0_START;
+    }else{
+        I2C_CTL0(bus->i2c_periph) |= I2C_CTL0_STOP;
+        i2c_bus_complete(bus, I2C_XFER_DONE);
+    }
+}
+
+/*!
+    \brief      start the read payload, ADDSEND is cleared here
+    \param[in]  bus: I2C transaction queue
+    \param[in]  xfer: running transaction
+    \param[out] none
+    \retval     none
+*/
+static void i2c_bus_rx_start(i2c_bus_struct *bus, i2c_xfer_struct *xfer)
+{
+    uint32_t i2c_periph = bus->i2c_periph;
+
+    if(1U == xfer->rx_len){
+        /* NACK the only byte and request STOP right after clearing ADDSEND */
+        I2C_CTL0(i2c_periph) &= ~I2C_CTL0_ACKEN;
+        (void)I2C_STAT1(i2c_periph);
+        I2C_CTL0(i2c_periph) |= I2C_CTL0_STOP;
+        bus->state = I2C_BUS_RX_LAST;
+        I2C_CTL1(i2c_periph) |= I2C_CTL1_BUFIE;
+    }else if(2U == xfer->rx_len){
+        /* with POAP set the first byte is still acknowledged and the second one is not */
+        I2C_CTL0(i2c_periph) &= ~I2C_CTL0_ACKEN;
+        (void)I2C_STAT1(i2c_periph);
+        bus->state = I2C_BUS_RX_BTC;
+    }else if((0U != bus->dma_periph) && (xfer->rx_len >= bus->dma_threshold)){
+        i2c_bus_dma_start(bus, bus->dma_rx, DMA_PERIPHERAL_TO_MEMORY, xfer->rx_buf, xfer->rx_len);
+        bus->state = I2C_BUS_RX_DMA;
+        I2C_CTL1(i2c_periph) = (I2C_CTL1(i2c_periph) & ~I2C_CTL1_EVIE) | I2C_CTL1_DMAON | I2C_CTL1_DMALST;
+        (void)I2C_STAT1(i2c_periph);
+    }else{
+        (void)I2C_STAT1(i2c_periph);
+        if(3U == xfer->rx_len){
+            bus->state = I2C_BUS_RX_BTC;
+        }else{
+            bus->state = I2C_BUS_RX;
+            I2C_CTL1(i2c_periph) |= I2C_CTL1_BUFIE;
+        }
+    }
+}
+
+/*!
+    \brief      commit a payload transfer to a DMA channel
+    \param[in]  bus: I2C transaction queue
+    \param[in]  channelx: DMA channel of the request
+    \param[in]  direction: DMA_MEMORY_TO_PERIPHERAL or DMA_PERIPHERAL_TO_MEMORY
+    \param[in]  buf: payload
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     none
+*/
+static void i2c_bus_dma_start(i2c_bus_struct *bus, dma_channel_enum channelx, uint8_t direction, const uint8_t *buf, uint32_t len)
+{
+    dma_parameter_struct dma_init_struct;
+
+    dma_init_struct.periph_addr = (uint32_t)&I2C_DATA(bus->i2c_periph);
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.periph_inc = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.memory_addr = (uint32_t)buf;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.direction = direction;
+    dma_init_struct.number = len;
+    dma_init_struct.priority = DMA_PRIORITY_HIGH;
+    dma_job_prepare(&bus->dma_job, &dma_init_struct, DMA_MEMORY_TO_MEMORY_DISABLE, NULL);
+    dma_job_commit(bus->dma_periph, channelx, &bus->dma_job);
+}
+
+/*!
+    \brief      end the running transaction and start the next one
+    \param[in]  bus: I2C transaction queue
+    \param[in]  status: I2C_XFER_DONE, I2C_XFER_NACK or I2C_XFER_ERROR
+    \param[out] none
+    \retval     none
+*/
+static void i2c_bus_complete(i2c_bus_struct *bus, uint32_t status)
+{
+    uint32_t i2c_periph = bus->i2c_periph;
+    i2c_xfer_struct *xfer = bus->slots[bus->tail & (bus->size - 1U)];
+
+    I2C_CTL1(i2c_periph) &= ~(I2C_CTL1_EVIE | I2C_CTL1_ERRIE | I2C_CTL1_BUFIE | I2C_CTL1_DMAON | I2C_CTL1_DMALST);
+    I2C_CTL0(i2c_periph) = (I2C_CTL0(i2c_periph) & ~I2C_CTL0_POAP) | I2C_CTL0_ACKEN;
+
+    bus->state = I2C_BUS_IDLE;
+    xfer->status = status;
+    __atomic_store_n(&bus->tail, bus->tail + 1U, __ATOMIC_RELEASE);
+
+    /* chain the next transaction first, the callback may take a while */
+    __atomic_store_n(&bus->busy, 0U, __ATOMIC_RELEASE);
+    i2c_bus_kick(bus);
+
+    if(NULL != xfer->callback){
+        xfer->callback(xfer);
+    }
+}
@@ -0,0 +1,230 @@
+/*!
+    \file  gd32vf103_i2s_stream.c
+    \brief double-buffered I2S stream driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_i2s_stream.h"
+#include <string.h>
+
+/* hand one half of the buffer to the callback */
+static void i2s_stream_half(i2s_stream_struct *stream, uint32_t offset);
+/* count a half the callback got too late */
+static void i2s_stream_xrun(i2s_stream_struct *stream);
+
+/*!
+    \brief      configure the I2S and the DMA channel of a stream, the SPI is
+                reset first; the stream starts with i2s_stream_start
+    \param[in]  stream: I2S stream
+    \param[in]  init_struct: the data needed to initialize the stream
+                  spi_periph: SPIx(x=1,2)
+                  mode, standard, ckpl: the parameters of i2s_init
+                  audiosample, frameformat, mckout: the parameters of i2s_psc_config
+                  buffer, size: storage of both halves, size an even number of words up to I2S_STREAM_SIZE_MAX
+                  callback: producer or consumer of the halves, called from the DMA interrupt
+                  user_data: free for the application
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus i2s_stream_init(i2s_stream_struct *stream, i2s_stream_parameter_struct *init_struct)
+{
+    dma_parameter_struct dma_init_struct;
+    uint32_t transmit = (0U == (init_struct->mode & I2SCTL_I2SOPMOD(1))) ? 1U : 0U;
+
+    if((NULL == init_struct->callback) || (0U == init_struct->size) || (0U != (init_struct->size & 1U))
+       || (I2S_STREAM_SIZE_MAX < init_struct->size)){
+        return ERROR;
+    }
+
+    if(SPI1 == init_struct->spi_periph){
+        stream->dma_periph = DMA0;
+        stream->channelx = (0U != transmit) ? DMA_CH4 : DMA_CH3;
+    }else if(SPI2 == init_struct->spi_periph){
+        stream->dma_periph = DMA1;
+        stream->channelx = (0U != transmit) ? DMA_CH1 : DMA_CH0;
+    }else{
+        return ERROR;
+    }
+    stream->spi_periph = init_struct->spi_periph;
+    stream->transmit = transmit;
+    stream->buffer = init_struct->buffer;
+    stream->size = init_struct->size;
+    stream->callback = init_struct->callback;
+    stream->user_data = init_struct->user_data;
+    stream->state = I2S_STREAM_IDLE;
+    stream->halves = 0U;
+    stream->underrun = 0U;
+    stream->overrun = 0U;
+
+    spi_i2s_deinit(stream->spi_periph);
+    i2s_psc_config(stream->spi_periph, init_struct->audiosample, init_struct->frameformat, init_struct->mckout);
+    i2s_init(stream->spi_periph, init_struct->mode, init_struct->standard, init_struct->ckpl);
+
+    /* one circular transfer over both halves, reloaded by the DMA itself */
+    dma_deinit(stream->dma_periph, stream->channelx);
+    dma_init_struct.direction = (0U != transmit) ? DMA_MEMORY_TO_PERIPHERAL : DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr = (uint32_t)stream->buffer;
+    dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number = stream->size;
+    dma_init_struct.periph_addr = (uint32_t)&SPI_DATA(stream->spi_periph);
+    dma_init_struct.periph_inc = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_16BIT;
+    dma_init_struct.priority = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(stream->dma_periph, stream->channelx, &dma_init_struct);
+    dma_circulation_enable(stream->dma_periph, stream->channelx);
+    dma_memory_to_memory_disable(stream->dma_periph, stream->channelx);
+    dma_interrupt_enable(stream->dma_periph, stream->channelx, DMA_INT_HTF | DMA_INT_FTF | DMA_INT_ERR);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      start streaming, a transmit stream asks the callback for both
+                halves before the I2S starts
+    \param[in]  stream: I2S stream
+    \param[out] none
+    \retval     none
+*/
+void i2s_stream_start(i2s_stream_struct *stream)
+{
+    if(0U != stream->transmit){
+        i2s_stream_half(stream, 0U);
+        i2s_stream_half(stream, stream->size >> 1U);
+    }
+
+    /* restart at the first half, also after i2s_stream_stop */
+    dma_channel_disable(stream->dma_periph, stream->channelx);
+    dma_interrupt_flag_clear(stream->dma_periph, stream->channelx, DMA_INT_FLAG_G);
+    dma_transfer_number_config(stream->dma_periph, stream->channelx, stream->size);
+    stream->state = I2S_STREAM_RUNNING;
+    dma_channel_enable(stream->dma_periph, stream->channelx);
+
+    spi_dma_enable(stream->spi_periph, (0U != stream->transmit) ? SPI_DMA_TRANSMIT : SPI_DMA_RECEIVE);
+    i2s_enable(stream->spi_periph);
+}
+
+/*!
+    \brief      stop the I2S and its DMA channel
+    \param[in]  stream: I2S stream
+    \param[out] none
+    \retval     none
+*/
+void i2s_stream_stop(i2s_stream_struct *stream)
+{
+    i2s_disable(stream->spi_periph);
+    spi_dma_disable(stream->spi_periph, (0U != stream->transmit) ? SPI_DMA_TRANSMIT : SPI_DMA_RECEIVE);
+    dma_channel_disable(stream->dma_periph, stream->channelx);
+    dma_interrupt_flag_clear(stream->dma_periph, stream->channelx, DMA_INT_FLAG_G);
+    if(I2S_STREAM_RUNNING == stream->state){
+        stream->state = I2S_STREAM_IDLE;
+    }
+}
+
+/*!
+    \brief      DMA channel interrupt service, hands the half the DMA is not in
+                to the callback; the half is picked by the DMA position rather
+                than by the flags, so a late interrupt still refills the right one
+    \param[in]  stream: I2S stream
+    \param[out] none
+    \retval     none
+*/
+void i2s_stream_dma_irq_handler(i2s_stream_struct *stream)
+{
+    uint32_t half = stream->size >> 1U;
+    uint32_t position, offset;
+    FlagStatus htf, ftf;
+
+    if(RESET != dma_interrupt_flag_get(stream->dma_periph, stream->channelx, DMA_INT_FLAG_ERR)){
+        i2s_stream_stop(stream);
+        stream->state = I2S_STREAM_ERROR;
+        return;
+    }
+    htf = dma_interrupt_flag_get(stream->dma_periph, stream->channelx, DMA_INT_FLAG_HTF);
+    ftf = dma_interrupt_flag_get(stream->dma_periph, stream->channelx, DMA_INT_FLAG_FTF);
+    if((RESET == htf) && (RESET == ftf)){
+        return;
+    }
+    dma_interrupt_flag_clear(stream->dma_periph, stream->channelx, DMA_INT_FLAG_G);
+
+    /* both events pending: a whole half went by without being handled */
+    if((RESET != htf) && (RESET != ftf)){
+        i2s_stream_xrun(stream);
+    }
+
+    position = stream->size - dma_transfer_number_get(stream->dma_periph, stream->channelx);
+    offset = (position < half) ? half : 0U;
+    i2s_stream_half(stream, offset);
+
+    /* the DMA must not have reached the half while the callback worked on it */
+    position = stream->size - dma_transfer_number_get(stream->dma_periph, stream->channelx);
+    if((position >= offset) && (position < (offset + half))){
+        i2s_stream_xrun(stream);
+    }
+}
+
+/*!
+    \brief      hand one half of the buffer to the callback, the part of a
+                transmit half the callback left empty is filled with silence
+    \param[in]  stream: I2S stream
+    \param[in]  offset: first word of the half
+    \param[out] none
+    \retval     none
+*/
+static void i2s_stream_half(i2s_stream_struct *stream, uint32_t offset)
+{
+    uint32_t half = stream->size >> 1U;
+    uint16_t *data = &stream->buffer[offset];
+    uint32_t len;
+
+    len = stream->callback(stream, data, half);
+    if((0U != stream->transmit) && (len < half)){
+        memset(&data[len], 0, (half - len) * sizeof(uint16_t));
+        stream->underrun++;
+    }
+    stream->halves++;
+}
+
+/*!
+    \brief      count a half the callback got too late
+    \param[in]  stream: I2S stream
+    \param[out] none
+    \retval     none
+*/
+static void i2s_stream_xrun(i2s_stream_struct *stream)
+{
+    if(0U != stream->transmit){
+        stream->underrun++;
+    }else{
+        stream->overrun++;
+    }
+}
@@ -0,0 +1,444 @@
+/*!
+    \file  gd32vf103_spi_bus.c
+    \brief SPI bus manager with queued DMA transactions
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_spi_bus.h"
+
+/* frame sent for a transaction without tx_buf, read as 0xFF by 8 bit transfers */
+static const uint16_t spi_bus_idle_frame = 0xFFFFU;
+
+/* start queued transactions until one runs on the DMA or the queue is empty */
+static void spi_bus_kick(spi_bus_struct *bus);
+/* load the configuration of a device and drive its chip select low */
+static void spi_bus_select(spi_bus_struct *bus, spi_device_struct *device);
+/* move the frames of a short transaction by polling */
+static void spi_bus_poll(spi_bus_struct *bus, spi_xfer_struct *xfer);
+/* commit the frames of a long transaction to the DMA channels */
+static void spi_bus_dma_start(spi_bus_struct *bus, spi_xfer_struct *xfer);
+/* end the running transaction and release the bus */
+static spi_xfer_struct *spi_bus_complete(spi_bus_struct *bus, uint32_t status);
+
+/*!
+    \brief      describe a device on a shared SPI and release its chip select
+    \param[in]  device: device descriptor
+    \param[in]  spi_struct: SPI parameter of the device, device_mode, trans_mode
+                and nss are ignored, the bus is always a full-duplex master with
+                software NSS
+                  frame_size: SPI_FRAMESIZE_16BIT, SPI_FRAMESIZE_8BIT
+                  endian: SPI_ENDIAN_MSB, SPI_ENDIAN_LSB
+                  clock_polarity_phase: SPI_CK_PL_LOW_PH_1EDGE, SPI_CK_PL_HIGH_PH_1EDGE,
+                                        SPI_CK_PL_LOW_PH_2EDGE, SPI_CK_PL_HIGH_PH_2EDGE
+                  prescale: SPI_PSC_n (n=2,4,8,16,32,64,128,256)
+    \param[in]  cs_gpio_periph: GPIOx(x=A,B,C,D,E) of the chip select, 0 if the device has none
+    \param[in]  cs_pin: GPIO_PIN_x(x=0..15), configured as push-pull output here
+    \param[out] none
+    \retval     none
+*/
+void spi_device_init(spi_device_struct *device, spi_parameter_struct *spi_struct, uint32_t cs_gpio_periph, uint32_t cs_pin)
+{
+    device->ctl0 = SPI_MASTER | SPI_NSS_SOFT | SPI_TRANSMODE_FULLDUPLEX | SPI_CTL0_SPIEN;
+    device->ctl0 |= spi_struct->frame_size | spi_struct->endian;
+    device->ctl0 |= spi_struct->clock_polarity_phase | spi_struct->prescale;
+    device->cs_gpio_periph = cs_gpio_periph;
+    device->cs_pin = cs_pin;
+
+    if(0U != cs_gpio_periph){
+        /* high before the pin turns into an output, so the device never sees a glitch */
+        GPIO_BOP(cs_gpio_periph) = cs_pin;
+        gpio_init(cs_gpio_periph, GPIO_MODE_OUT_PP, GPIO_OSPEED_50MHZ, cs_pin);
+    }
+}
+
+/*!
+    \brief      fill a full-duplex transaction
+    \param[in]  xfer: SPI transaction descriptor
+    \param[in]  device: addressed device
+    \param[in]  tx_buf: frames sent, NULL sends 0xFF or 0xFFFF
+    \param[in]  rx_buf: frames received, NULL drops them
+    \param[in]  len: number of frames, bytes for 8 bit devices and half-words for 16 bit ones
+    \param[in]  flags: SPI_XFER_CS_KEEP to leave the chip select low for the next
+                transaction of the same device, or 0
+    \param[in]  callback: called when the transaction ends, or NULL
+    \param[out] none
+    \retval     none
+*/
+void spi_xfer_prepare(spi_xfer_struct *xfer, spi_device_struct *device, const void *tx_buf, void *rx_buf,
+                      uint32_t len, uint32_t flags, void (*callback)(spi_xfer_struct *xfer))
+{
+    xfer->device = device;
+    xfer->tx_buf = tx_buf;
+    xfer->rx_buf = rx_buf;
+    xfer->len = len;
+    xfer->flags = flags;
+    xfer->callback = callback;
+    xfer->status = SPI_XFER_IDLE;
+}
+
+/*!
+    \brief      initialize the transaction queue of a SPI, the SPI is configured
+                by the devices of its transactions
+    \param[in]  bus: SPI transaction queue
+    \param[in]  spi_periph: SPIx(x=0,1,2)
+    \param[in]  slots: queue storage of size transaction pointers
+    \param[in]  size: number of slots, a power of two
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus spi_bus_init(spi_bus_struct *bus, uint32_t spi_periph, spi_xfer_struct **slots, uint32_t size)
+{
+    if((0U == size) || (0U != (size & (size - 1U)))){
+        return ERROR;
+    }
+
+    bus->spi_periph = spi_periph;
+    bus->dma_periph = 0U;
+    bus->dma_rx = DMA_CH0;
+    bus->dma_tx = DMA_CH0;
+    bus->dma_threshold = SPI_BUS_DMA_THRESHOLD;
+    bus->slots = slots;
+    bus->size = size;
+    bus->head = 0U;
+    bus->tail = 0U;
+    bus->busy = 0U;
+    bus->chaining = 0U;
+    bus->selected = NULL;
+
+    SPI_CTL1(spi_periph) &= ~(SPI_CTL1_DMAREN | SPI_CTL1_DMATEN | SPI_CTL1_ERRIE | SPI_CTL1_RBNEIE | SPI_CTL1_TBEIE);
+    SPI_I2SCTL(spi_periph) &= ~SPI_I2SCTL_I2SSEL;
+    bus->ctl0 = SPI_CTL0(spi_periph);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      let the queue run long transactions on the DMA channels of the SPI,
+                DMA0 channel 1 and 2 for SPI0, DMA0 channel 3 and 4 for SPI1,
+                DMA1 channel 0 and 1 for SPI2; call it while the queue is empty
+    \param[in]  bus: SPI transaction queue
+    \param[in]  threshold: shortest transaction in frames handed to the DMA, 0 polls every transaction
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_dma_config(spi_bus_struct *bus, uint32_t threshold)
+{
+    if(0U == threshold){
+        bus->dma_periph = 0U;
+        return;
+    }
+
+    if(SPI0 == bus->spi_periph){
+        bus->dma_periph = DMA0;
+        bus->dma_rx = DMA_CH1;
+        bus->dma_tx = DMA_CH2;
+    }else if(SPI1 == bus->spi_periph){
+        bus->dma_periph = DMA0;
+        bus->dma_rx = DMA_CH3;
+        bus->dma_tx = DMA_CH4;
+    }else{
+        bus->dma_periph = DMA1;
+        bus->dma_rx = DMA_CH0;
+        bus->dma_tx = DMA_CH1;
+    }
+    bus->dma_threshold = threshold;
+}
+
+/*!
+    \brief      append a transaction to a queue, it starts at once if the bus is
+                idle; a short transaction started here is polled to its end and
+                its callback is called before the function returns
+    \param[in]  bus: SPI transaction queue
+    \param[in]  xfer: SPI transaction prepared by spi_xfer_prepare, not queued elsewhere
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if the queue is full or the transaction is still queued
+*/
+ErrStatus spi_bus_submit(spi_bus_struct *bus, spi_xfer_struct *xfer)
+{
+    uint32_t head = bus->head;
+
+    if((SPI_XFER_QUEUED == xfer->status) || (SPI_XFER_ACTIVE == xfer->status)){
+        return ERROR;
+    }
+    if((head - __atomic_load_n(&bus->tail, __ATOMIC_ACQUIRE)) == bus->size){
+        return ERROR;
+    }
+
+    xfer->status = SPI_XFER_QUEUED;
+    bus->slots[head & (bus->size - 1U)] = xfer;
+    __atomic_store_n(&bus->head, head + 1U, __ATOMIC_RELEASE);
+
+    spi_bus_kick(bus);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      get the number of transactions queued or running
+    \param[in]  bus: SPI transaction queue
+    \param[out] none
+    \retval     number of transactions
+*/
+uint32_t spi_bus_pending_get(spi_bus_struct *bus)
+{
+    return bus->head - __atomic_load_n(&bus->tail, __ATOMIC_ACQUIRE);
+}
+
+/*!
+    \brief      DMA channel interrupt service of both SPI channels, ends the
+                running transaction and starts the next one
+    \param[in]  bus: SPI transaction queue
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_dma_irq_handler(spi_bus_struct *bus)
+{
+    uint32_t dma_periph = bus->dma_periph;
+    uint32_t intf, status;
+    spi_xfer_struct *xfer;
+
+    if((0U == bus->busy) || (0U == dma_periph)){
+        return;
+    }
+    intf = DMA_INTF(dma_periph);
+    if(0U != ((intf >> (bus->dma_tx * 4U)) & DMA_INTF_ERRIF)){
+        status = SPI_XFER_ERROR;
+    }else if(0U != ((intf >> (bus->dma_rx * 4U)) & DMA_INTF_ERRIF)){
+        status = SPI_XFER_ERROR;
+    }else if(0U != ((intf >> (bus->dma_rx * 4U)) & DMA_INTF_FTFIF)){
+        /* the last frame is received, so the SPI is idle again */
+        status = SPI_XFER_DONE;
+    }else{
+        return;
+    }
+
+    DMA_INTC(dma_periph) = DMA_FLAG_ADD(DMA_INTC_GIFC, bus->dma_rx) | DMA_FLAG_ADD(DMA_INTC_GIFC, bus->dma_tx);
+    DMA_CHCTL(dma_periph, bus->dma_rx) = DMA_CHCTL_RESET_VALUE;
+    DMA_CHCTL(dma_periph, bus->dma_tx) = DMA_CHCTL_RESET_VALUE;
+    SPI_CTL1(bus->spi_periph) &= ~(SPI_CTL1_DMAREN | SPI_CTL1_DMATEN);
+
+    /* whatever starts from here on, the next transaction or one submitted by
+       the callback, goes to the DMA so that no frame is polled in the interrupt */
+    bus->chaining = 1U;
+    xfer = spi_bus_complete(bus, status);
+    /* chain the next transaction first, the callback may take a while */
+    spi_bus_kick(bus);
+    if(NULL != xfer->callback){
+        xfer->callback(xfer);
+    }
+    bus->chaining = 0U;
+}
+
+/*!
+    \brief      start queued transactions until one runs on the DMA or the queue is
+                empty; called by the DMA interrupt, it hands every transaction
+                with frames to the DMA, however short
+    \param[in]  bus: SPI transaction queue
+    \param[out] none
+    \retval     none
+*/
+static void spi_bus_kick(spi_bus_struct *bus)
+{
+    spi_xfer_struct *xfer;
+
+    for(;;){
+        if(__atomic_load_n(&bus->head, __ATOMIC_ACQUIRE) == bus->tail){
+            return;
+        }
+        /* both the submitter and the interrupt kick, the exchange elects one of them */
+        if(0U != __atomic_exchange_n(&bus->busy, 1U, __ATOMIC_ACQ_REL)){
+            return;
+        }
+        if(bus->head == bus->tail){
+            /* the interrupt emptied the queue between the check and the election */
+            __atomic_store_n(&bus->busy, 0U, __ATOMIC_RELEASE);
+            return;
+        }
+
+        xfer = bus->slots[bus->tail & (bus->size - 1U)];
+        xfer->status = SPI_XFER_ACTIVE;
+        spi_bus_select(bus, xfer->device);
+
+        if((0U != bus->dma_periph) &&
+           ((xfer->len >= bus->dma_threshold) || ((0U != bus->chaining) && (0U != xfer->len)))){
+            spi_bus_dma_start(bus, xfer);
+            return;
+        }
+
+        spi_bus_poll(bus, xfer);
+        xfer = spi_bus_complete(bus, SPI_XFER_DONE);
+        if(NULL != xfer->callback){
+            xfer->callback(xfer);
+        }
+    }
+}
+
+/*!
+    \brief      load the configuration of a device and drive its chip select low
+    \param[in]  bus: SPI transaction queue
+    \param[in]  device: device of the transaction about to start
+    \param[out] none
+    \retval     none
+*/
+static void spi_bus_select(spi_bus_struct *bus, spi_device_struct *device)
+{
+    uint32_t spi_periph = bus->spi_periph;
+
+    if(device == bus->selected){
+        /* the previous transaction kept the chip select low for this one */
+        return;
+    }
+    if(NULL != bus->selected){
+        GPIO_BOP(bus->selected->cs_gpio_periph) = bus->selected->cs_pin;
+    }
+    if(device->ctl0 != bus->ctl0){
+        /* clock mode and frame size change with the SPI disabled, before any chip select goes low */
+        SPI_CTL0(spi_periph) = device->ctl0 & ~SPI_CTL0_SPIEN;
+        SPI_CTL0(spi_periph) = device->ctl0;
+        bus->ctl0 = device->ctl0;
+    }
+    if(0U != device->cs_gpio_periph){
+        GPIO_BC(device->cs_gpio_periph) = device->cs_pin;
+        bus->selected = device;
+    }else{
+        bus->selected = NULL;
+    }
+}
+
+/*!
+    \brief      move the frames of a short transaction by polling
+    \param[in]  bus: SPI transaction queue
+    \param[in]  xfer: running transaction
+    \param[out] none
+    \retval     none
+*/
+static void spi_bus_poll(spi_bus_struct *bus, spi_xfer_struct *xfer)
+{
+    uint32_t spi_periph = bus->spi_periph;
+    uint32_t wide = bus->ctl0 & SPI_CTL0_FF16;
+    uint32_t frame, i;
+
+    /* one frame in flight at a time, so a late RBNE read can never overrun */
+    for(i = 0U; i < xfer->len; i++){
+        if(NULL == xfer->tx_buf){
+            frame = spi_bus_idle_frame;
+        }else if(0U != wide){
+            frame = ((const uint16_t *)xfer->tx_buf)[i];
+        }else{
+            frame = ((const uint8_t *)xfer->tx_buf)[i];
+        }
+        while(0U == (SPI_STAT(spi_periph) & SPI_STAT_TBE)){
+        }
+        SPI_DATA(spi_periph) = frame;
+        while(0U == (SPI_STAT(spi_periph) & SPI_STAT_RBNE)){
+        }
+        frame = SPI_DATA(spi_periph);
+        if(NULL != xfer->rx_buf){
+            if(0U != wide){
+                ((uint16_t *)xfer->rx_buf)[i] = (uint16_t)frame;
+            }else{
+                ((uint8_t *)xfer->rx_buf)[i] = (uint8_t)frame;
+            }
+        }
+    }
+}
+
+/*!
+    \brief      commit the frames of a long transaction to the DMA channels
+    \param[in]  bus: SPI transaction queue
+    \param[in]  xfer: running transaction
+    \param[out] none
+    \retval     none
+*/
+static void spi_bus_dma_start(spi_bus_struct *bus, spi_xfer_struct *xfer)
+{
+    dma_parameter_struct dma_init_struct;
+    uint32_t wide = bus->ctl0 & SPI_CTL0_FF16;
+
+    dma_init_struct.periph_addr = (uint32_t)&SPI_DATA(bus->spi_periph);
+    dma_init_struct.periph_width = (0U != wide) ? DMA_PERIPHERAL_WIDTH_16BIT : DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.periph_inc = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.memory_width = (0U != wide) ? DMA_MEMORY_WIDTH_16BIT : DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number = xfer->len;
+
+    /* the receive channel goes first and wins against the transmit one, so no frame is overrun */
+    if(NULL == xfer->rx_buf){
+        dma_init_struct.memory_addr = (uint32_t)&bus->sink;
+        dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_DISABLE;
+    }else{
+        dma_init_struct.memory_addr = (uint32_t)xfer->rx_buf;
+        dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    }
+    dma_init_struct.direction = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.priority = DMA_PRIORITY_ULTRA_HIGH;
+    dma_job_prepare(&bus->rx_job, &dma_init_struct, DMA_MEMORY_TO_MEMORY_DISABLE, NULL);
+    dma_job_commit(bus->dma_periph, bus->dma_rx, &bus->rx_job);
+
+    if(NULL == xfer->tx_buf){
+        dma_init_struct.memory_addr = (uint32_t)&spi_bus_idle_frame;
+        dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_DISABLE;
+    }else{
+        dma_init_struct.memory_addr = (uint32_t)xfer->tx_buf;
+        dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    }
+    dma_init_struct.direction = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.priority = DMA_PRIORITY_HIGH;
+    dma_job_prepare(&bus->tx_job, &dma_init_struct, DMA_MEMORY_TO_MEMORY_DISABLE, NULL);
+    /* the end of the transaction is the receive channel interrupt, the transmit one only reports errors */
+    bus->tx_job.ctl &= ~DMA_CHXCTL_FTFIE;
+    dma_job_commit(bus->dma_periph, bus->dma_tx, &bus->tx_job);
+
+    SPI_CTL1(bus->spi_periph) |= SPI_CTL1_DMAREN | SPI_CTL1_DMATEN;
+}
+
+/*!
+    \brief      end the running transaction and release the bus
+    \param[in]  bus: SPI transaction queue
+    \param[in]  status: SPI_XFER_DONE or SPI_XFER_ERROR
+    \param[out] none
+    \retval     the ended transaction
+*/
+static spi_xfer_struct *spi_bus_complete(spi_bus_struct *bus, uint32_t status)
+{
+    spi_xfer_struct *xfer = bus->slots[bus->tail & (bus->size - 1U)];
+
+    if((NULL != bus->selected) && ((SPI_XFER_DONE != status) || (0U == (xfer->flags & SPI_XFER_CS_KEEP)))){
+        GPIO_BOP(bus->selected->cs_gpio_periph) = bus->selected->cs_pin;
+        bus->selected = NULL;
+    }
+
+    xfer->status = status;
+    __atomic_store_n(&bus->tail, bus->tail + 1U, __ATOMIC_RELEASE);
+    __atomic_store_n(&bus->busy, 0U, __ATOMIC_RELEASE);
+
+    return xfer;
+}
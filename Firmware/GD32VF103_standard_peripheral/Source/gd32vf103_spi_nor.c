@@ -0,0 +1,657 @@
+/*!
+    \file  gd32vf103_spi_nor.c
+    \brief SPI NOR flash block driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include "gd32vf103_spi_nor.h"
+#include <string.h>
+
+/* submit a transaction and wait for its end */
+static ErrStatus spi_nor_transfer(spi_nor_struct *nor, spi_xfer_struct *xfer);
+/* read into a buffer with the fast read command */
+static ErrStatus spi_nor_fast_read(spi_nor_struct *nor, uint32_t addr, uint8_t *buf, uint32_t len);
+/* queue a fast read without waiting for it */
+static ErrStatus spi_nor_fast_read_start(spi_nor_struct *nor, uint32_t addr, uint8_t *buf, uint32_t len);
+/* find the cache line holding a flash line, waits for it if it is being fetched */
+static uint32_t spi_nor_line_find(spi_nor_struct *nor, uint32_t line);
+/* start fetching a flash line into a cache line */
+static void spi_nor_prefetch_start(spi_nor_struct *nor, uint32_t index, uint32_t line);
+/* wait for the line being fetched, the transactions are then free again */
+static void spi_nor_prefetch_end(spi_nor_struct *nor);
+/* queue the first step of a program or erase */
+static ErrStatus spi_nor_start(spi_nor_struct *nor);
+/* check the ended status read and queue what follows it */
+static void spi_nor_advance(spi_nor_struct *nor);
+/* status read callback, follows the operation up in the DMA interrupt */
+static void spi_nor_status_done(spi_xfer_struct *xfer);
+/* queue one page program or erase and the status read behind it */
+static ErrStatus spi_nor_step(spi_nor_struct *nor);
+/* check that a number of transactions fit into the SPI queue */
+static ErrStatus spi_nor_slots_check(spi_nor_struct *nor, uint32_t count);
+/* drop the cache lines overlapping a range about to change */
+static void spi_nor_cache_invalidate(spi_nor_struct *nor, uint32_t addr, uint32_t len);
+/* put a command and a 24 bit address into the command buffer */
+static void spi_nor_cmd_fill(spi_nor_struct *nor, uint8_t cmd, uint32_t addr);
+
+/*!
+    \brief      identify the flash and attach a cache of two lines, the bus and
+                the device must be initialized
+    \param[in]  nor: SPI NOR flash
+    \param[in]  bus: SPI transaction queue of the flash
+    \param[in]  device: SPI device of the flash, mode 0 or 3 with 8 bit frames MSB first
+    \param[in]  cache: SPI_NOR_CACHE_LINES * cache_size bytes, NULL to read every time from the flash
+    \param[in]  cache_size: size of a line, a power of two from 16 bytes to SPI_NOR_READ_CHUNK
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if no JEDEC flash answers
+*/
+ErrStatus spi_nor_init(spi_nor_struct *nor, spi_bus_struct *bus, spi_device_struct *device, uint8_t *cache, uint32_t cache_size)
+{
+    uint8_t id[4];
+    uint32_t code;
+
+    if((NULL != cache) && ((cache_size < 16U) || (cache_size > SPI_NOR_READ_CHUNK) || (0U != (cache_size & (cache_size - 1U))))){
+        return ERROR;
+    }
+
+    nor->bus = bus;
+    nor->device = device;
+    nor->cache = cache;
+    nor->cache_size = cache_size;
+    nor->cache_addr[0] = SPI_NOR_CACHE_INVALID;
+    nor->cache_addr[1] = SPI_NOR_CACHE_INVALID;
+    nor->cache_last = 0U;
+    nor->prefetch = SPI_NOR_LINE_NONE;
+    nor->timer_periph = 0U;
+    nor->state = SPI_NOR_READY;
+    nor->polled = 0U;
+    nor->wren_cmd = SPI_NOR_CMD_WRITE_ENABLE;
+    nor->status_cmd[0] = SPI_NOR_CMD_READ_STATUS;
+    nor->status_cmd[1] = 0xFFU;
+    spi_xfer_prepare(&nor->wren_xfer, device, &nor->wren_cmd, NULL, 1U, 0U, NULL);
+    spi_xfer_prepare(&nor->status_xfer, device, nor->status_cmd, nor->status, 2U, 0U, spi_nor_status_done);
+    nor->status_xfer.user_data = nor;
+
+    spi_nor_cmd_fill(nor, SPI_NOR_CMD_READ_ID, 0xFFFFFFU);
+    spi_xfer_prepare(&nor->cmd_xfer, device, nor->cmd, id, 4U, 0U, NULL);
+    if(SUCCESS != spi_nor_transfer(nor, &nor->cmd_xfer)){
+        return ERROR;
+    }
+    nor->jedec_id = ((uint32_t)id[1] << 16U) | ((uint32_t)id[2] << 8U) | id[3];
+
+    /* the third ID byte is the capacity as a power of two for the JEDEC flashes */
+    code = id[3];
+    if((0x00FFFFFFU == nor->jedec_id) || (0U == nor->jedec_id) || (code < 16U) || (code > 24U)){
+        return ERROR;
+    }
+    nor->capacity = 1U << code;
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      let a one-shot timer pace the status reads of program and erase,
+                the timer is configured here and its update interrupt calls
+                spi_nor_timer_irq_handler; call it while no operation runs
+    \param[in]  nor: SPI NOR flash
+    \param[in]  timer_periph: TIMERx(x=0..6), or 0 to leave them to spi_nor_service()
+    \param[in]  ticks: timer clock cycles from a busy status to the next status read, at least 2
+    \param[out] none
+    \retval     none
+*/
+void spi_nor_timer_config(spi_nor_struct *nor, uint32_t timer_periph, uint32_t ticks)
+{
+    uint32_t psc;
+
+    nor->timer_periph = timer_periph;
+    if(0U == timer_periph){
+        return;
+    }
+
+    /* the smallest prescaler that brings the period within the 16 bit counter */
+    ticks = (ticks < 2U) ? 2U : ticks;
+    psc = (ticks - 1U) >> 16U;
+    /* the counter stops after one overflow, UPS keeps UPG off the update flag */
+    TIMER_CTL0(timer_periph) = TIMER_CTL0_SPM | TIMER_CTL0_UPS;
+    TIMER_PSC(timer_periph) = psc;
+    TIMER_CAR(timer_periph) = (ticks / (psc + 1U)) - 1U;
+    TIMER_SWEVG(timer_periph) = TIMER_SWEVG_UPG;
+    TIMER_INTF(timer_periph) = ~TIMER_INTF_UPIF;
+    TIMER_DMAINTEN(timer_periph) = TIMER_DMAINTEN_UPIE;
+}
+
+/*!
+    \brief      read bytes, waits for a running program or erase first
+    \param[in]  nor: SPI NOR flash
+    \param[in]  addr: flash address
+    \param[in]  buf: buffer receiving the bytes
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR on a range outside the flash or a transfer error
+*/
+ErrStatus spi_nor_read(spi_nor_struct *nor, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+    uint32_t offset, line, chunk, index;
+    uint8_t *cache;
+
+    if((addr > nor->capacity) || (len > (nor->capacity - addr))){
+        return ERROR;
+    }
+    (void)spi_nor_wait(nor);
+
+    while(0U != len){
+        offset = (NULL != nor->cache) ? (addr & (nor->cache_size - 1U)) : 0U;
+        line = addr - offset;
+        index = (NULL != nor->cache) ? spi_nor_line_find(nor, line) : SPI_NOR_LINE_NONE;
+
+        if((NULL == nor->cache) || ((SPI_NOR_LINE_NONE == index) && (0U == offset) && (len >= nor->cache_size))){
+            /* whole lines bypass the cache */
+            chunk = (len > SPI_NOR_READ_CHUNK) ? SPI_NOR_READ_CHUNK : len;
+            if(NULL != nor->cache){
+                chunk &= ~(nor->cache_size - 1U);
+            }
+            spi_nor_prefetch_end(nor);
+            if(SUCCESS != spi_nor_fast_read(nor, addr, buf, chunk)){
+                return ERROR;
+            }
+            if((NULL != nor->cache) && (chunk == len)){
+                /* a reader of whole lines finds its next one in the cache */
+                spi_nor_prefetch_start(nor, nor->cache_last ^ 1U, addr + chunk);
+            }
+        }else{
+            if(SPI_NOR_LINE_NONE == index){
+                /* the line read last stays, the other one is replaced */
+                spi_nor_prefetch_end(nor);
+                index = nor->cache_last ^ 1U;
+                nor->cache_addr[index] = SPI_NOR_CACHE_INVALID;
+                if(SUCCESS != spi_nor_fast_read(nor, line, &nor->cache[index * nor->cache_size], nor->cache_size)){
+                    return ERROR;
+                }
+                nor->cache_addr[index] = line;
+            }
+            nor->cache_last = index;
+            cache = &nor->cache[index * nor->cache_size];
+            chunk = nor->cache_size - offset;
+            chunk = (len < chunk) ? len : chunk;
+            memcpy(buf, &cache[offset], chunk);
+            if((offset + chunk) == nor->cache_size){
+                /* a sequential reader goes on with the next line */
+                spi_nor_prefetch_start(nor, index ^ 1U, line + nor->cache_size);
+            }
+        }
+        addr += chunk;
+        buf += chunk;
+        len -= chunk;
+    }
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      start programming erased bytes, page by page; the data is read by
+                the DMA until the operation has ended
+    \param[in]  nor: SPI NOR flash
+    \param[in]  addr: flash address, any alignment
+    \param[in]  buf: data, kept unchanged until spi_nor_service returns SPI_NOR_READY
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if an operation is running, the range is
+                outside the flash or the SPI queue has no room for the first page
+*/
+ErrStatus spi_nor_program_start(spi_nor_struct *nor, uint32_t addr, const uint8_t *buf, uint32_t len)
+{
+    if((SPI_NOR_BUSY == nor->state) || (0U == len) || (addr > nor->capacity) || (len > (nor->capacity - addr))){
+        return ERROR;
+    }
+    spi_nor_prefetch_end(nor);
+    spi_nor_cache_invalidate(nor, addr, len);
+
+    nor->erase = 0U;
+    nor->src = buf;
+    nor->addr = addr;
+    nor->remain = len;
+
+    return spi_nor_start(nor);
+}
+
+/*!
+    \brief      start erasing whole sectors, 64 KB blocks where the range allows it
+    \param[in]  nor: SPI NOR flash
+    \param[in]  addr: flash address, aligned to SPI_NOR_SECTOR_SIZE
+    \param[in]  len: number of bytes, a multiple of SPI_NOR_SECTOR_SIZE
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if an operation is running, the range is
+                invalid or the SPI queue has no room for the first erase
+*/
+ErrStatus spi_nor_erase_start(spi_nor_struct *nor, uint32_t addr, uint32_t len)
+{
+    if((SPI_NOR_BUSY == nor->state) || (0U == len) || (0U != ((addr | len) & (SPI_NOR_SECTOR_SIZE - 1U)))){
+        return ERROR;
+    }
+    if((addr > nor->capacity) || (len > (nor->capacity - addr))){
+        return ERROR;
+    }
+    spi_nor_prefetch_end(nor);
+    spi_nor_cache_invalidate(nor, addr, len);
+
+    nor->erase = 1U;
+    nor->addr = addr;
+    nor->remain = len;
+
+    return spi_nor_start(nor);
+}
+
+/*!
+    \brief      move a running program or erase on without waiting, call it from
+                the context submitting to the SPI queue; with a timer the
+                interrupts move it on and this only reports the state
+    \param[in]  nor: SPI NOR flash
+    \param[out] none
+    \retval     SPI_NOR_READY, SPI_NOR_BUSY or SPI_NOR_ERROR
+*/
+uint32_t spi_nor_service(spi_nor_struct *nor)
+{
+    uint32_t status = nor->status_xfer.status;
+
+    if((SPI_NOR_BUSY != nor->state) || (0U != nor->timer_periph)){
+        return nor->state;
+    }
+    /* the status read is the last transaction of a step, it ends after the others */
+    if((SPI_XFER_QUEUED == status) || (SPI_XFER_ACTIVE == status)){
+        return SPI_NOR_BUSY;
+    }
+    spi_nor_advance(nor);
+
+    return nor->state;
+}
+
+/*!
+    \brief      call spi_nor_service until the running operation has ended
+    \param[in]  nor: SPI NOR flash
+    \param[out] none
+    \retval     SPI_NOR_READY or SPI_NOR_ERROR
+*/
+uint32_t spi_nor_wait(spi_nor_struct *nor)
+{
+    uint32_t state;
+
+    do{
+        state = spi_nor_service(nor);
+    }while(SPI_NOR_BUSY == state);
+
+    return state;
+}
+
+/*!
+    \brief      timer update interrupt service, queues the next status read
+    \param[in]  nor: SPI NOR flash
+    \param[out] none
+    \retval     none
+*/
+void spi_nor_timer_irq_handler(spi_nor_struct *nor)
+{
+    uint32_t timer_periph = nor->timer_periph;
+
+    if((0U == timer_periph) || (0U == (TIMER_INTF(timer_periph) & TIMER_INTF_UPIF))){
+        return;
+    }
+    TIMER_INTF(timer_periph) = ~TIMER_INTF_UPIF;
+    if(SPI_NOR_BUSY != nor->state){
+        return;
+    }
+
+    nor->polled = 0U;
+    if(SUCCESS != spi_bus_submit(nor->bus, &nor->status_xfer)){
+        nor->state = SPI_NOR_ERROR;
+    }else if(0U != nor->polled){
+        /* the bus was idle and the read is already over */
+        spi_nor_advance(nor);
+    }
+}
+
+/*!
+    \brief      submit a transaction and wait for its end
+    \param[in]  nor: SPI NOR flash
+    \param[in]  xfer: transaction
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus spi_nor_transfer(spi_nor_struct *nor, spi_xfer_struct *xfer)
+{
+    if(SUCCESS != spi_bus_submit(nor->bus, xfer)){
+        return ERROR;
+    }
+    while((SPI_XFER_QUEUED == xfer->status) || (SPI_XFER_ACTIVE == xfer->status)){
+    }
+    return (SPI_XFER_DONE == xfer->status) ? SUCCESS : ERROR;
+}
+
+/*!
+    \brief      read into a buffer with the fast read command
+    \param[in]  nor: SPI NOR flash
+    \param[in]  addr: flash address
+    \param[in]  buf: buffer receiving the bytes
+    \param[in]  len: number of bytes, at most SPI_NOR_READ_CHUNK
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus spi_nor_fast_read(spi_nor_struct *nor, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+    if(SUCCESS != spi_nor_fast_read_start(nor, addr, buf, len)){
+        return ERROR;
+    }
+    while((SPI_XFER_QUEUED == nor->data_xfer.status) || (SPI_XFER_ACTIVE == nor->data_xfer.status)){
+    }
+    return ((SPI_XFER_DONE == nor->cmd_xfer.status) && (SPI_XFER_DONE == nor->data_xfer.status)) ? SUCCESS : ERROR;
+}
+
+/*!
+    \brief      queue a fast read without waiting for it
+    \param[in]  nor: SPI NOR flash
+    \param[in]  addr: flash address
+    \param[in]  buf: buffer receiving the bytes
+    \param[in]  len: number of bytes, at most SPI_NOR_READ_CHUNK
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if the SPI queue has no room for the read
+*/
+static ErrStatus spi_nor_fast_read_start(spi_nor_struct *nor, uint32_t addr, uint8_t *buf, uint32_t len)
+{
+    spi_nor_cmd_fill(nor, SPI_NOR_CMD_FAST_READ, addr);
+    spi_xfer_prepare(&nor->cmd_xfer, nor->device, nor->cmd, NULL, 5U, SPI_XFER_CS_KEEP, NULL);
+    spi_xfer_prepare(&nor->data_xfer, nor->device, NULL, buf, len, 0U, NULL);
+
+    /* both are queued together, the data phase follows the command at once; a
+       command queued alone would keep the chip select low for whatever comes next */
+    if(SUCCESS != spi_nor_slots_check(nor, 2U)){
+        return ERROR;
+    }
+    if((SUCCESS != spi_bus_submit(nor->bus, &nor->cmd_xfer)) || (SUCCESS != spi_bus_submit(nor->bus, &nor->data_xfer))){
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      find the cache line holding a flash line, waits for it if it is
+                still being fetched
+    \param[in]  nor: SPI NOR flash
+    \param[in]  line: flash address of the line
+    \param[out] none
+    \retval     index of the cache line, or SPI_NOR_LINE_NONE if no line holds it
+*/
+static uint32_t spi_nor_line_find(spi_nor_struct *nor, uint32_t line)
+{
+    uint32_t index;
+
+    for(index = 0U; index < SPI_NOR_CACHE_LINES; index++){
+        if(line == nor->cache_addr[index]){
+            if(index == nor->prefetch){
+                /* a failed fetch leaves the line empty */
+                spi_nor_prefetch_end(nor);
+            }
+            return (line == nor->cache_addr[index]) ? index : SPI_NOR_LINE_NONE;
+        }
+    }
+    return SPI_NOR_LINE_NONE;
+}
+
+/*!
+    \brief      start fetching a flash line into a cache line and return at once;
+                nothing is fetched past the flash end, if the line is cached
+                already, while an earlier fetch is still running or if the SPI
+                queue has no room
+    \param[in]  nor: SPI NOR flash
+    \param[in]  index: cache line to fill
+    \param[in]  line: flash address of the line
+    \param[out] none
+    \retval     none
+*/
+static void spi_nor_prefetch_start(spi_nor_struct *nor, uint32_t index, uint32_t line)
+{
+    if((SPI_XFER_QUEUED == nor->data_xfer.status) || (SPI_XFER_ACTIVE == nor->data_xfer.status)){
+        return;
+    }
+    spi_nor_prefetch_end(nor);
+    if((line >= nor->capacity) || (line == nor->cache_addr[0]) || (line == nor->cache_addr[1])){
+        return;
+    }
+
+    nor->cache_addr[index] = SPI_NOR_CACHE_INVALID;
+    if(SUCCESS == spi_nor_fast_read_start(nor, line, &nor->cache[index * nor->cache_size], nor->cache_size)){
+        nor->cache_addr[index] = line;
+        nor->prefetch = index;
+    }
+}
+
+/*!
+    \brief      wait for the line being fetched, the command and data transactions
+                are free again afterwards
+    \param[in]  nor: SPI NOR flash
+    \param[out] none
+    \retval     none
+*/
+static void spi_nor_prefetch_end(spi_nor_struct *nor)
+{
+    uint32_t index = nor->prefetch;
+
+    if(SPI_NOR_LINE_NONE == index){
+        return;
+    }
+    while((SPI_XFER_QUEUED == nor->data_xfer.status) || (SPI_XFER_ACTIVE == nor->data_xfer.status)){
+    }
+    nor->prefetch = SPI_NOR_LINE_NONE;
+    if((SPI_XFER_DONE != nor->cmd_xfer.status) || (SPI_XFER_DONE != nor->data_xfer.status)){
+        nor->cache_addr[index] = SPI_NOR_CACHE_INVALID;
+    }
+}
+
+/*!
+    \brief      queue the first step of a program or erase; a status read the bus
+                could start at once has ended before the submit returned and is
+                followed up here
+    \param[in]  nor: SPI NOR flash
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if the SPI queue has no room for the step
+*/
+static ErrStatus spi_nor_start(spi_nor_struct *nor)
+{
+    nor->state = SPI_NOR_BUSY;
+    nor->polled = 0U;
+    if(SUCCESS != spi_nor_step(nor)){
+        return ERROR;
+    }
+    if(0U != nor->polled){
+        spi_nor_advance(nor);
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      check the ended status read and queue what follows it: the next
+                step, or while the flash is busy another status read, right away
+                without a timer and when the timer expires with one
+    \param[in]  nor: SPI NOR flash
+    \param[out] none
+    \retval     none
+*/
+static void spi_nor_advance(spi_nor_struct *nor)
+{
+    do{
+        nor->polled = 0U;
+        if((SPI_XFER_DONE != nor->status_xfer.status) || (SPI_XFER_DONE != nor->wren_xfer.status)
+           || (SPI_XFER_DONE != nor->cmd_xfer.status) || ((0U == nor->erase) && (SPI_XFER_DONE != nor->data_xfer.status))){
+            nor->state = SPI_NOR_ERROR;
+            return;
+        }
+
+        if(0U != (nor->status[1] & SPI_NOR_STATUS_WIP)){
+            if(0U != nor->timer_periph){
+                TIMER_CTL0(nor->timer_periph) |= TIMER_CTL0_CEN;
+            }else if(SUCCESS != spi_bus_submit(nor->bus, &nor->status_xfer)){
+                nor->state = SPI_NOR_ERROR;
+            }
+            return;
+        }
+        if(0U == nor->remain){
+            nor->state = SPI_NOR_READY;
+            return;
+        }
+        (void)spi_nor_step(nor);
+        /* the status read of an erase may have run at once on an idle bus */
+    }while((SPI_NOR_BUSY == nor->state) && (0U != nor->polled));
+}
+
+/*!
+    \brief      status read callback; with a timer the DMA interrupt that ended
+                the read follows the operation up, a read polled by its submitter
+                is left to the submitter
+    \param[in]  xfer: status read
+    \param[out] none
+    \retval     none
+*/
+static void spi_nor_status_done(spi_xfer_struct *xfer)
+{
+    spi_nor_struct *nor = (spi_nor_struct *)xfer->user_data;
+
+    if(0U == nor->timer_periph){
+        return;
+    }
+    if(0U != nor->bus->chaining){
+        spi_nor_advance(nor);
+    }else{
+        nor->polled = 1U;
+    }
+}
+
+/*!
+    \brief      queue one page program or erase and the status read behind it; if
+                the SPI queue has no room for the whole step nothing is queued
+                and the operation ends in SPI_NOR_ERROR
+    \param[in]  nor: SPI NOR flash
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus spi_nor_step(spi_nor_struct *nor)
+{
+    uint32_t len;
+    uint32_t failed = 0U;
+
+    /* a partly queued step would leave transactions behind that the driver no longer follows */
+    if(SUCCESS != spi_nor_slots_check(nor, (0U != nor->erase) ? 3U : 4U)){
+        nor->state = SPI_NOR_ERROR;
+        return ERROR;
+    }
+
+    failed |= (SUCCESS != spi_bus_submit(nor->bus, &nor->wren_xfer));
+    if(0U != nor->erase){
+        if((0U == (nor->addr & (SPI_NOR_BLOCK_SIZE - 1U))) && (nor->remain >= SPI_NOR_BLOCK_SIZE)){
+            len = SPI_NOR_BLOCK_SIZE;
+            spi_nor_cmd_fill(nor, SPI_NOR_CMD_BLOCK_ERASE, nor->addr);
+        }else{
+            len = SPI_NOR_SECTOR_SIZE;
+            spi_nor_cmd_fill(nor, SPI_NOR_CMD_SECTOR_ERASE, nor->addr);
+        }
+        spi_xfer_prepare(&nor->cmd_xfer, nor->device, nor->cmd, NULL, 4U, 0U, NULL);
+        failed |= (SUCCESS != spi_bus_submit(nor->bus, &nor->cmd_xfer));
+    }else{
+        /* a page program must not cross the page end, it would wrap around */
+        len = SPI_NOR_PAGE_SIZE - (nor->addr & (SPI_NOR_PAGE_SIZE - 1U));
+        len = (nor->remain < len) ? nor->remain : len;
+        spi_nor_cmd_fill(nor, SPI_NOR_CMD_PAGE_PROGRAM, nor->addr);
+        spi_xfer_prepare(&nor->cmd_xfer, nor->device, nor->cmd, NULL, 4U, SPI_XFER_CS_KEEP, NULL);
+        spi_xfer_prepare(&nor->data_xfer, nor->device, nor->src, NULL, len, 0U, NULL);
+        failed |= (SUCCESS != spi_bus_submit(nor->bus, &nor->cmd_xfer));
+        failed |= (SUCCESS != spi_bus_submit(nor->bus, &nor->data_xfer));
+        nor->src += len;
+    }
+    failed |= (SUCCESS != spi_bus_submit(nor->bus, &nor->status_xfer));
+
+    nor->addr += len;
+    nor->remain -= len;
+    if(0U != failed){
+        nor->state = SPI_NOR_ERROR;
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      check that a number of transactions fit into the SPI queue; the
+                driver is the only submitter of its context, so they still fit
+                when it submits them
+    \param[in]  nor: SPI NOR flash
+    \param[in]  count: number of transactions
+    \param[out] none
+    \retval     ErrStatus: SUCCESS, or ERROR if the queue has fewer free slots
+*/
+static ErrStatus spi_nor_slots_check(spi_nor_struct *nor, uint32_t count)
+{
+    return ((nor->bus->size - spi_bus_pending_get(nor->bus)) < count) ? ERROR : SUCCESS;
+}
+
+/*!
+    \brief      drop the cache lines overlapping a range about to change
+    \param[in]  nor: SPI NOR flash
+    \param[in]  addr: flash address of the range
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     none
+*/
+static void spi_nor_cache_invalidate(spi_nor_struct *nor, uint32_t addr, uint32_t len)
+{
+    uint32_t index;
+
+    for(index = 0U; index < SPI_NOR_CACHE_LINES; index++){
+        if((SPI_NOR_CACHE_INVALID != nor->cache_addr[index]) && (addr < (nor->cache_addr[index] + nor->cache_size))
+           && (nor->cache_addr[index] < (addr + len))){
+            nor->cache_addr[index] = SPI_NOR_CACHE_INVALID;
+        }
+    }
+}
+
+/*!
+    \brief      put a command and a 24 bit address into the command buffer, the
+                fifth byte is the dummy byte of the fast read
+    \param[in]  nor: SPI NOR flash
+    \param[in]  cmd: command
+    \param[in]  addr: flash address
+    \param[out] none
+    \retval     none
+*/
+static void spi_nor_cmd_fill(spi_nor_struct *nor, uint8_t cmd, uint32_t addr)
+{
+    nor->cmd[0] = cmd;
+    nor->cmd[1] = (uint8_t)(addr >> 16U);
+    nor->cmd[2] = (uint8_t)(addr >> 8U);
+    nor->cmd[3] = (uint8_t)addr;
+    nor->cmd[4] = 0xFFU;
+}
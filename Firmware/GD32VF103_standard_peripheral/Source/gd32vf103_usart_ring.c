@@ -0,0 +1,371 @@
+/*!
+    \file  gd32vf103_usart_ring.c
+    \brief USART ring buffer driver
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103_usart_ring.h"
+#include <string.h>
+
+/* check that a ring size is a usable power of two */
+static ErrStatus usart_ring_size_check(uint32_t size);
+/* start a TX DMA transfer if data is pending and the channel is idle */
+static void usart_ring_tx_kick(usart_ring_struct *ring);
+
+/*!
+    \brief      initialize the USART rings and start reception
+    \param[in]  ring: USART ring driver state
+    \param[in]  init_struct: the data needed to initialize the rings
+                  usart_periph: USARTx(x=0,1,2)/UARTx(x=3)
+                  dma_periph: DMAx(x=0,1)
+                  tx_channel, rx_channel: DMA channels of the USART requests
+                  tx_buffer, tx_size: TX ring storage, size a power of two up to USART_RING_SIZE_MAX
+                  rx_buffer, rx_size: RX ring storage, size a power of two up to USART_RING_SIZE_MAX
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+ErrStatus usart_ring_init(usart_ring_struct *ring, usart_ring_parameter_struct *init_struct)
+{
+    dma_parameter_struct dma_init_struct;
+
+    if((ERROR == usart_ring_size_check(init_struct->tx_size)) || (ERROR == usart_ring_size_check(init_struct->rx_size))){
+        return ERROR;
+    }
+
+    ring->usart_periph = init_struct->usart_periph;
+    ring->dma_periph = init_struct->dma_periph;
+    ring->tx_channel = init_struct->tx_channel;
+    ring->rx_channel = init_struct->rx_channel;
+    ring->tx_buffer = init_struct->tx_buffer;
+    ring->tx_size = init_struct->tx_size;
+    ring->tx_head = 0U;
+    ring->tx_tail = 0U;
+    ring->tx_inflight = 0U;
+    ring->tx_busy = 0U;
+    ring->rx_buffer = init_struct->rx_buffer;
+    ring->rx_size = init_struct->rx_size;
+    ring->rx_head = 0U;
+    ring->rx_tail = 0U;
+    ring->rx_overrun = 0U;
+
+    /* TX channel: memory to USART_DATA, one transfer per contiguous span */
+    dma_deinit(ring->dma_periph, ring->tx_channel);
+    dma_init_struct.direction = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr = (uint32_t)ring->tx_buffer;
+    dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number = 0U;
+    dma_init_struct.periph_addr = (uint32_t)&USART_DATA(ring->usart_periph);
+    dma_init_struct.periph_inc = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.priority = DMA_PRIORITY_MEDIUM;
+    dma_init(ring->dma_periph, ring->tx_channel, &dma_init_struct);
+    dma_circulation_disable(ring->dma_periph, ring->tx_channel);
+    dma_memory_to_memory_disable(ring->dma_periph, ring->tx_channel);
+    dma_interrupt_enable(ring->dma_periph, ring->tx_channel, DMA_INT_FTF);
+
+    /* RX channel: USART_DATA to the RX ring, circular */
+    dma_deinit(ring->dma_periph, ring->rx_channel);
+    dma_init_struct.direction = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr = (uint32_t)ring->rx_buffer;
+    dma_init_struct.number = ring->rx_size;
+    dma_init_struct.priority = DMA_PRIORITY_HIGH;
+    dma_init(ring->dma_periph, ring->rx_channel, &dma_init_struct);
+    dma_circulation_enable(ring->dma_periph, ring->rx_channel);
+    dma_memory_to_memory_disable(ring->dma_periph, ring->rx_channel);
+    dma_interrupt_enable(ring->dma_periph, ring->rx_channel, DMA_INT_HTF | DMA_INT_FTF);
+    dma_channel_enable(ring->dma_periph, ring->rx_channel);
+
+    usart_dma_receive_config(ring->usart_periph, USART_DENR_ENABLE);
+    usart_dma_transmit_config(ring->usart_periph, USART_DENT_ENABLE);
+    usart_interrupt_enable(ring->usart_periph, USART_INT_IDLE);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      stop both DMA channels of the USART rings
+    \param[in]  ring: USART ring driver state
+    \param[out] none
+    \retval     none
+*/
+void usart_ring_deinit(usart_ring_struct *ring)
+{
+    usart_interrupt_disable(ring->usart_periph, USART_INT_IDLE);
+    usart_dma_receive_config(ring->usart_periph, USART_DENR_DISABLE);
+    usart_dma_transmit_config(ring->usart_periph, USART_DENT_DISABLE);
+    dma_deinit(ring->dma_periph, ring->tx_channel);
+    dma_deinit(ring->dma_periph, ring->rx_channel);
+    ring->tx_busy = 0U;
+    ring->tx_inflight = 0U;
+}
+
+/*!
+    \brief      get the contiguous free space of the TX ring
+    \param[in]  ring: USART ring driver state
+    \param[out] span: start of the free space, to be filled in place
+    \retval     number of bytes that can be written at span
+*/
+uint32_t usart_ring_tx_span_get(usart_ring_struct *ring, uint8_t **span)
+{
+    uint32_t head = ring->tx_head;
+    uint32_t index = head & (ring->tx_size - 1U);
+    uint32_t space = ring->tx_size - (head - __atomic_load_n(&ring->tx_tail, __ATOMIC_ACQUIRE));
+
+    *span = &ring->tx_buffer[index];
+    return (space < (ring->tx_size - index)) ? space : (ring->tx_size - index);
+}
+
+/*!
+    \brief      commit bytes written into the TX span and start sending them
+    \param[in]  ring: USART ring driver state
+    \param[in]  len: number of bytes written, at most the span length
+    \param[out] none
+    \retval     none
+*/
+void usart_ring_tx_span_commit(usart_ring_struct *ring, uint32_t len)
+{
+    __atomic_store_n(&ring->tx_head, ring->tx_head + len, __ATOMIC_RELEASE);
+    usart_ring_tx_kick(ring);
+}
+
+/*!
+    \brief      copy bytes into the TX ring
+    \param[in]  ring: USART ring driver state
+    \param[in]  data: bytes to send
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     number of bytes accepted, less than len if the ring is full
+*/
+uint32_t usart_ring_write(usart_ring_struct *ring, const uint8_t *data, uint32_t len)
+{
+    uint32_t done = 0U;
+    uint32_t span_len, i;
+    uint8_t *span;
+
+    /* at most two spans, before and after the wrap */
+    for(i = 0U; (i < 2U) && (done < len); i++){
+        span_len = usart_ring_tx_span_get(ring, &span);
+        if(span_len > (len - done)){
+            span_len = len - done;
+        }
+        memcpy(span, &data[done], span_len);
+        done += span_len;
+        usart_ring_tx_span_commit(ring, span_len);
+    }
+    return done;
+}
+
+/*!
+    \brief      get the number of bytes not yet handed to the DMA
+    \param[in]  ring: USART ring driver state
+    \param[out] none
+    \retval     number of bytes
+*/
+uint32_t usart_ring_tx_pending_get(usart_ring_struct *ring)
+{
+    return ring->tx_head - ring->tx_tail - ring->tx_inflight;
+}
+
+/*!
+    \brief      get the contiguous received bytes of the RX ring
+    \param[in]  ring: USART ring driver state
+    \param[out] span: start of the received bytes, valid until released
+    \retval     number of bytes readable at span
+*/
+uint32_t usart_ring_rx_span_get(usart_ring_struct *ring, uint8_t **span)
+{
+    uint32_t head = __atomic_load_n(&ring->rx_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = ring->rx_tail;
+    uint32_t index;
+
+    /* the DMA has lapped the consumer: skip to the oldest bytes still in the ring */
+    if((head - tail) > ring->rx_size){
+        tail = head - ring->rx_size;
+        ring->rx_tail = tail;
+    }
+    index = tail & (ring->rx_size - 1U);
+    *span = &ring->rx_buffer[index];
+    return ((head - tail) < (ring->rx_size - index)) ? (head - tail) : (ring->rx_size - index);
+}
+
+/*!
+    \brief      release bytes consumed from the RX span
+    \param[in]  ring: USART ring driver state
+    \param[in]  len: number of bytes consumed, at most the span length
+    \param[out] none
+    \retval     none
+*/
+void usart_ring_rx_span_release(usart_ring_struct *ring, uint32_t len)
+{
+    __atomic_store_n(&ring->rx_tail, ring->rx_tail + len, __ATOMIC_RELEASE);
+}
+
+/*!
+    \brief      copy bytes out of the RX ring
+    \param[in]  ring: USART ring driver state
+    \param[in]  len: size of the buffer
+    \param[out] data: buffer receiving the bytes
+    \retval     number of bytes copied
+*/
+uint32_t usart_ring_read(usart_ring_struct *ring, uint8_t *data, uint32_t len)
+{
+    uint32_t done = 0U;
+    uint32_t span_len, i;
+    uint8_t *span;
+
+    for(i = 0U; (i < 2U) && (done < len); i++){
+        span_len = usart_ring_rx_span_get(ring, &span);
+        if(span_len > (len - done)){
+            span_len = len - done;
+        }
+        memcpy(&data[done], span, span_len);
+        done += span_len;
+        usart_ring_rx_span_release(ring, span_len);
+    }
+    return done;
+}
+
+/*!
+    \brief      publish the RX DMA position to the consumer
+    \param[in]  ring: USART ring driver state
+    \param[out] none
+    \retval     none
+*/
+void usart_ring_rx_update(usart_ring_struct *ring)
+{
+    uint32_t mask = ring->rx_size - 1U;
+    uint32_t position = (ring->rx_size - dma_transfer_number_get(ring->dma_periph, ring->rx_channel)) & mask;
+    uint32_t head = ring->rx_head + ((position - ring->rx_head) & mask);
+
+    if((head - ring->rx_tail) > ring->rx_size){
+        ring->rx_overrun++;
+    }
+    __atomic_store_n(&ring->rx_head, head, __ATOMIC_RELEASE);
+}
+
+/*!
+    \brief      USART interrupt service, handles the IDLE line event
+    \param[in]  ring: USART ring driver state
+    \param[out] none
+    \retval     none
+*/
+void usart_ring_usart_irq_handler(usart_ring_struct *ring)
+{
+    if(RESET != usart_interrupt_flag_get(ring->usart_periph, USART_INT_FLAG_IDLE)){
+        /* IDLEF is cleared by the STAT read above followed by a DATA read */
+        usart_data_receive(ring->usart_periph);
+        usart_ring_rx_update(ring);
+    }
+}
+
+/*!
+    \brief      TX DMA channel interrupt service, chains the next transfer
+    \param[in]  ring: USART ring driver state
+    \param[out] none
+    \retval     none
+*/
+void usart_ring_dma_tx_irq_handler(usart_ring_struct *ring)
+{
+    if(RESET != dma_interrupt_flag_get(ring->dma_periph, ring->tx_channel, DMA_INT_FLAG_FTF)){
+        dma_interrupt_flag_clear(ring->dma_periph, ring->tx_channel, DMA_INT_FLAG_G);
+        __atomic_store_n(&ring->tx_tail, ring->tx_tail + ring->tx_inflight, __ATOMIC_RELEASE);
+        ring->tx_inflight = 0U;
+        __atomic_store_n(&ring->tx_busy, 0U, __ATOMIC_RELEASE);
+        usart_ring_tx_kick(ring);
+    }
+}
+
+/*!
+    \brief      RX DMA channel interrupt service, handles the half and full transfer events
+    \param[in]  ring: USART ring driver state
+    \param[out] none
+    \retval     none
+*/
+void usart_ring_dma_rx_irq_handler(usart_ring_struct *ring)
+{
+    if((RESET != dma_interrupt_flag_get(ring->dma_periph, ring->rx_channel, DMA_INT_FLAG_HTF))
+       || (RESET != dma_interrupt_flag_get(ring->dma_periph, ring->rx_channel, DMA_INT_FLAG_FTF))){
+        dma_interrupt_flag_clear(ring->dma_periph, ring->rx_channel, DMA_INT_FLAG_G);
+        usart_ring_rx_update(ring);
+    }
+}
+
+/*!
+    \brief      check that a ring size is a usable power of two
+    \param[in]  size: ring size in bytes
+    \param[out] none
+    \retval     ErrStatus: SUCCESS or ERROR
+*/
+static ErrStatus usart_ring_size_check(uint32_t size)
+{
+    if((0U == size) || (0U != (size & (size - 1U))) || (USART_RING_SIZE_MAX < size)){
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      start a TX DMA transfer if data is pending and the channel is idle
+    \param[in]  ring: USART ring driver state
+    \param[out] none
+    \retval     none
+*/
+static void usart_ring_tx_kick(usart_ring_struct *ring)
+{
+    uint32_t tail, index, len;
+
+    if(__atomic_load_n(&ring->tx_head, __ATOMIC_ACQUIRE) == ring->tx_tail){
+        return;
+    }
+    /* both the producer and the DMA interrupt kick, the exchange elects one of them */
+    if(0U != __atomic_exchange_n(&ring->tx_busy, 1U, __ATOMIC_ACQ_REL)){
+        return;
+    }
+
+    tail = ring->tx_tail;
+    index = tail & (ring->tx_size - 1U);
+    len = ring->tx_head - tail;
+    if(0U == len){
+        /* the interrupt drained the ring between the check and the election */
+        __atomic_store_n(&ring->tx_busy, 0U, __ATOMIC_RELEASE);
+        return;
+    }
+    if(len > (ring->tx_size - index)){
+        len = ring->tx_size - index;
+    }
+    ring->tx_inflight = len;
+
+    dma_channel_disable(ring->dma_periph, ring->tx_channel);
+    dma_memory_address_config(ring->dma_periph, ring->tx_channel, (uint32_t)&ring->tx_buffer[index]);
+    dma_transfer_number_config(ring->dma_periph, ring->tx_channel, len);
+    dma_channel_enable(ring->dma_periph, ring->tx_channel);
+}
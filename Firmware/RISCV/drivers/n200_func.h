@@ -30,6 +30,10 @@ uint64_t get_instret_value();
 
 uint64_t get_cycle_value();
 
+void enable_mcycle_minstret();
+
+void disable_mcycle_minstret();
+
 uint32_t get_cpu_freq();
 
 uint32_t __attribute__((noinline)) measure_cpu_freq(size_t n);
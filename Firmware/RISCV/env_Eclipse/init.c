@@ -6,7 +6,6 @@
 #include "riscv_encoding.h"
 #include "n200_func.h"
 
-extern uint32_t disable_mcycle_minstret();
 void _init()
 {
 	SystemInit();
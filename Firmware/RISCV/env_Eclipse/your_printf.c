@@ -1,5 +1,341 @@
-int __wrap_printf(const char* fmt, ...)
+//See LICENSE for license details.
+#include <stdint.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include "your_printf.h"
+
+/* size of the stack buffer __wrap_printf hands to write() in one piece */
+#define PRINTF_CHUNK        64
+
+#define FLAG_LEFT           0x01
+#define FLAG_ZERO           0x02
+#define FLAG_PLUS           0x04
+#define FLAG_SPACE          0x08
+#define FLAG_UPPER          0x10
+
+/* output state, lives on the stack of the caller so the formatter is reentrant */
+typedef struct {
+    char* buf;
+    size_t pos;
+    size_t size;
+    int fd;                 /* -1: string output, truncated at size */
+    int total;
+} out_t;
+
+static void out_char(out_t* out, char ch)
+{
+    if (out->pos == out->size && out->fd >= 0) {
+        write(out->fd, out->buf, out->pos);
+        out->pos = 0;
+    }
+    if (out->pos < out->size) {
+        out->buf[out->pos++] = ch;
+    }
+    out->total++;
+}
+
+static void out_pad(out_t* out, char ch, int count)
+{
+    while (count-- > 0) {
+        out_char(out, ch);
+    }
+}
+
+/* emit sign/prefix, zero or space padding and the digits held in reverse order */
+static void out_field(out_t* out, const char* prefix, const char* digits, int ndigits,
+                      int precision, int width, int flags)
+{
+    int nprefix = 0;
+    int nzero = (precision > ndigits) ? (precision - ndigits) : 0;
+    int pad;
+
+    while (prefix[nprefix]) {
+        nprefix++;
+    }
+    pad = width - nprefix - nzero - ndigits;
+    if ((flags & FLAG_ZERO) && precision < 0) {
+        nzero += (pad > 0) ? pad : 0;
+        pad = 0;
+    }
+
+    if (!(flags & FLAG_LEFT)) {
+        out_pad(out, ' ', pad);
+    }
+    while (*prefix) {
+        out_char(out, *prefix++);
+    }
+    out_pad(out, '0', nzero);
+    while (ndigits > 0) {
+        out_char(out, digits[--ndigits]);
+    }
+    if (flags & FLAG_LEFT) {
+        out_pad(out, ' ', pad);
+    }
+}
+
+/* digits of value in base 10 or 16, least significant first */
+static int utoa_rev(char* digits, unsigned long value, unsigned base, int flags)
+{
+    const char* set = (flags & FLAG_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+    int n = 0;
+
+    do {
+        digits[n++] = set[value % base];
+        value /= base;
+    } while (value);
+
+    return n;
+}
+
+static const char* sign_prefix(int negative, int flags)
+{
+    if (negative) {
+        return "-";
+    }
+    if (flags & FLAG_PLUS) {
+        return "+";
+    }
+    return (flags & FLAG_SPACE) ? " " : "";
+}
+
+/* signed fixed-point value with frac_bits fractional bits */
+static void out_fixed(out_t* out, int32_t value, int frac_bits, int precision, int width, int flags)
+{
+    static const uint32_t dec_pow[10] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+    char digits[24];
+    uint32_t mag = (value < 0) ? (0U - (uint32_t)value) : (uint32_t)value;
+    uint32_t ipart = (frac_bits < 32) ? (mag >> frac_bits) : 0;
+    uint32_t fpart = mag & ((1ULL << frac_bits) - 1U);
+    uint32_t scaled;
+    int n = 0;
+    int i;
+
+    if (precision < 0) {
+        precision = 4;
+    } else if (precision > 9) {
+        precision = 9;
+    }
+
+    /* round the fraction to precision decimals, carrying into the integer part */
+    scaled = (uint32_t)((((uint64_t)fpart * dec_pow[precision]) + (1ULL << (frac_bits - 1))) >> frac_bits);
+    if (scaled >= dec_pow[precision]) {
+        scaled -= dec_pow[precision];
+        ipart++;
+    }
+
+    for (i = 0; i < precision; i++) {
+        digits[n++] = (char)('0' + (scaled % 10U));
+        scaled /= 10U;
+    }
+    if (precision > 0) {
+        digits[n++] = '.';
+    }
+    n += utoa_rev(&digits[n], ipart, 10, 0);
+
+    out_field(out, sign_prefix(value < 0, flags), digits, n, -1, width, flags);
+}
+
+static int your_vformat(out_t* out, const char* fmt, va_list ap)
 {
-    // You can implement your own printf to reduce the code size, because the printf is really a big function
+    char digits[24];
+
+    while (*fmt) {
+        int flags = 0;
+        int width = 0;
+        int precision = -1;
+        int length = 0;
+        char ch = *fmt++;
+
+        if (ch != '%') {
+            out_char(out, ch);
+            continue;
+        }
+
+        for (;; fmt++) {
+            if (*fmt == '-') {
+                flags |= FLAG_LEFT;
+            } else if (*fmt == '0') {
+                flags |= FLAG_ZERO;
+            } else if (*fmt == '+') {
+                flags |= FLAG_PLUS;
+            } else if (*fmt == ' ') {
+                flags |= FLAG_SPACE;
+            } else {
+                break;
+            }
+        }
+
+        if (*fmt == '*') {
+            width = va_arg(ap, int);
+            if (width < 0) {
+                flags |= FLAG_LEFT;
+                width = -width;
+            }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9') {
+                width = (width * 10) + (*fmt++ - '0');
+            }
+        }
+
+        if (*fmt == '.') {
+            fmt++;
+            precision = 0;
+            if (*fmt == '*') {
+                precision = va_arg(ap, int);
+                fmt++;
+            } else {
+                while (*fmt >= '0' && *fmt <= '9') {
+                    precision = (precision * 10) + (*fmt++ - '0');
+                }
+            }
+        }
+
+        /* length: -2 hh, -1 h, 0 int, 1 l */
+        while (*fmt == 'h') {
+            length--;
+            fmt++;
+        }
+        if (*fmt == 'l') {
+            length = 1;
+            fmt++;
+        }
+
+        ch = *fmt;
+        if (ch == '\0') {
+            break;
+        }
+        fmt++;
+
+        switch (ch) {
+        case 'd':
+        case 'i': {
+            long value = (length > 0) ? va_arg(ap, long) : va_arg(ap, int);
+            unsigned long mag;
+            int n;
+
+            if (length == -1) {
+                value = (short)value;
+            } else if (length == -2) {
+                value = (signed char)value;
+            }
+            mag = (value < 0) ? (0UL - (unsigned long)value) : (unsigned long)value;
+            n = (precision == 0 && mag == 0) ? 0 : utoa_rev(digits, mag, 10, 0);
+            out_field(out, sign_prefix(value < 0, flags), digits, n, precision, width, flags);
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X': {
+            unsigned long value = (length > 0) ? va_arg(ap, unsigned long) : va_arg(ap, unsigned int);
+            int n;
+
+            if (length == -1) {
+                value = (unsigned short)value;
+            } else if (length == -2) {
+                value = (unsigned char)value;
+            }
+            if (ch == 'X') {
+                flags |= FLAG_UPPER;
+            }
+            n = (precision == 0 && value == 0) ? 0 : utoa_rev(digits, value, (ch == 'u') ? 10 : 16, flags);
+            out_field(out, "", digits, n, precision, width, flags);
+            break;
+        }
+        case 'p': {
+            uintptr_t value = (uintptr_t)va_arg(ap, void*);
+            int n = utoa_rev(digits, value, 16, 0);
+
+            out_field(out, "0x", digits, n, precision, width, flags);
+            break;
+        }
+        case 'q': {
+            int32_t value = (length > 0) ? (int32_t)va_arg(ap, long) : (int32_t)va_arg(ap, int);
+
+            if (length < 0) {
+                out_fixed(out, (int16_t)value, 15, precision, width, flags);
+            } else {
+                out_fixed(out, value, (length > 0) ? 31 : 16, precision, width, flags);
+            }
+            break;
+        }
+        case 'c':
+            digits[0] = (char)va_arg(ap, int);
+            out_field(out, "", digits, 1, -1, width, flags & ~FLAG_ZERO);
+            break;
+        case 's': {
+            const char* str = va_arg(ap, const char*);
+            int n = 0;
+            int pad;
+
+            if (str == NULL) {
+                str = "(null)";
+            }
+            while (str[n] && (precision < 0 || n < precision)) {
+                n++;
+            }
+            pad = width - n;
+            if (!(flags & FLAG_LEFT)) {
+                out_pad(out, ' ', pad);
+            }
+            while (n-- > 0) {
+                out_char(out, *str++);
+            }
+            if (flags & FLAG_LEFT) {
+                out_pad(out, ' ', pad);
+            }
+            break;
+        }
+        default:
+            out_char(out, ch);
+            break;
+        }
+    }
+
+    return out->total;
+}
+
+int your_vsnprintf(char* buf, size_t size, const char* fmt, va_list ap)
+{
+    out_t out = { buf, 0, (size > 0) ? (size - 1) : 0, -1, 0 };
+    int total = your_vformat(&out, fmt, ap);
+
+    if (size > 0) {
+        buf[out.pos] = '\0';
+    }
+    return total;
+}
+
+int your_snprintf(char* buf, size_t size, const char* fmt, ...)
+{
+    va_list ap;
+    int total;
+
+    va_start(ap, fmt);
+    total = your_vsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return total;
 }
 
+/*
+ * Formats into a stack buffer and passes it to write(), so with the buffered
+ * _write backend of the stubs the text goes straight into the stdout ring.
+ * No heap, no FILE state.
+ */
+int __wrap_printf(const char* fmt, ...)
+{
+    char chunk[PRINTF_CHUNK];
+    out_t out = { chunk, 0, sizeof(chunk), 1, 0 };
+    va_list ap;
+
+    va_start(ap, fmt);
+    your_vformat(&out, fmt, ap);
+    va_end(ap);
+
+    if (out.pos > 0) {
+        write(out.fd, out.buf, out.pos);
+    }
+    return out.total;
+}
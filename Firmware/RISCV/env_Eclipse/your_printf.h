@@ -0,0 +1,20 @@
+//See LICENSE for license details.
+#ifndef _YOUR_PRINTF_H
+#define _YOUR_PRINTF_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/*
+ * Compact printf replacement, linked in place of the newlib printf with
+ * -Wl,--wrap=printf. Supported conversions: %d %i %u %x %X %c %s %p %%
+ * with the flags '-' '0' '+' ' ', width and precision (also as '*') and
+ * the length modifiers h, hh and l. %q prints a signed fixed-point value:
+ * %q is Q16.16, %hq is Q1.15 and %lq is Q1.31, the precision sets the
+ * number of decimals (default 4, at most 9).
+ */
+int __wrap_printf(const char* fmt, ...);
+int your_vsnprintf(char* buf, size_t size, const char* fmt, va_list ap);
+int your_snprintf(char* buf, size_t size, const char* fmt, ...);
+
+#endif /* _YOUR_PRINTF_H */
@@ -5,8 +5,30 @@
 #include <stdint.h>
 #include <unistd.h>
 
+/* buffered stdout backend, see write.c */
+#ifndef WRITE_USART
+#define WRITE_USART         USART0
+#endif
+
+/* size of the RAM log buffer in bytes, must be a power of two */
+#ifndef WRITE_BUFFER_SIZE
+#define WRITE_BUFFER_SIZE   1024
+#endif
+
+/* what _write does with bytes that do not fit into the log buffer */
+typedef enum {
+  WRITE_OVERFLOW_DROP = 0,          /* discard the new bytes and count them */
+  WRITE_OVERFLOW_BLOCK,             /* wait until the USART has made room */
+  WRITE_OVERFLOW_OVERWRITE          /* discard the oldest unsent bytes */
+} write_overflow_enum;
+
 void write_hex(int fd, unsigned long int hex);
 
+void write_async_init(write_overflow_enum policy);
+void write_async_irq_handler(void);
+void write_async_flush(void);
+uint32_t write_async_dropped_get(void);
+
 static inline int _stub(int err)
 {
   return -1;
@@ -9,23 +9,137 @@
 
 #include "stub.h"
 #include "gd32vf103.h"
+#include "riscv_encoding.h"
 
 typedef unsigned int size_t;
 
 extern int _put_char(int ch) __attribute__((weak));
 
+#if (WRITE_BUFFER_SIZE & (WRITE_BUFFER_SIZE - 1)) != 0
+#error "WRITE_BUFFER_SIZE must be a power of two"
+#endif
+
+/*
+ * Until write_async_init() is called, _write sends every character through
+ * _put_char and waits for it, as before. Afterwards _write only copies into
+ * write_buffer and the TBE interrupt of WRITE_USART drains it: the application
+ * calls write_async_irq_handler() from the USART interrupt handler.
+ *
+ * head and tail are free running, the buffer holds head - tail bytes. They are
+ * only changed with MIE cleared, so _write may be called from any context.
+ */
+static uint8_t write_buffer[WRITE_BUFFER_SIZE];
+static volatile uint32_t write_head;
+static volatile uint32_t write_tail;
+static volatile uint32_t write_dropped;
+static write_overflow_enum write_policy;
+static volatile int write_async;
+
+static inline unsigned long write_lock(void)
+{
+	return clear_csr(mstatus, MSTATUS_MIE) & MSTATUS_MIE;
+}
+
+static inline void write_unlock(unsigned long mie)
+{
+	if (mie) {
+		set_csr(mstatus, MSTATUS_MIE);
+	}
+}
+
+/*
+ * Move bytes into the USART for as long as TBE stays set: the first one goes
+ * straight on to the shift register, so an idle USART takes two bytes per
+ * call. Stops the TBE interrupt once the buffer is empty. Called with MIE
+ * cleared.
+ */
+static void write_pump(void)
+{
+	while (write_head != write_tail) {
+		if (RESET == usart_flag_get(WRITE_USART, USART_FLAG_TBE)) {
+			return;
+		}
+		usart_data_transmit(WRITE_USART, write_buffer[write_tail & (WRITE_BUFFER_SIZE - 1)]);
+		write_tail = write_tail + 1;
+	}
+	usart_interrupt_disable(WRITE_USART, USART_INT_TBE);
+}
+
+/*
+ * Queue num bytes as a unit, returns 0 when the overflow policy dropped them.
+ * A "\n" goes in together with its "\r", so the pair is never split by a
+ * full buffer.
+ */
+static int write_bytes(const uint8_t *bytes, uint32_t num)
+{
+	unsigned long mie = write_lock();
+	uint32_t i;
+
+	while ((WRITE_BUFFER_SIZE - (write_head - write_tail)) < num) {
+		if (WRITE_OVERFLOW_OVERWRITE == write_policy) {
+			write_tail = write_tail + 1;
+			write_dropped = write_dropped + 1;
+		} else if (WRITE_OVERFLOW_BLOCK == write_policy) {
+			/* poll the USART as well, the caller may be running with interrupts off */
+			write_pump();
+			write_unlock(mie);
+			mie = write_lock();
+		} else {
+			write_dropped = write_dropped + 1;
+			write_unlock(mie);
+			return 0;
+		}
+	}
+
+	for (i = 0; i < num; i++) {
+		write_buffer[write_head & (WRITE_BUFFER_SIZE - 1)] = bytes[i];
+		write_head = write_head + 1;
+	}
+
+	write_unlock(mie);
+	return 1;
+}
+
 ssize_t _write(int fd, const void* ptr, size_t len) {
+	static const uint8_t newline[2] = {'\n', '\r'};
 	const uint8_t * current = (const uint8_t *) ptr;
+	unsigned long mie;
+	int queued;
 
 //	if (isatty(fd)) 
 	{
-		for (size_t jj = 0; jj < len; jj++) {
-			_put_char(current[jj]);
+		if (!write_async) {
+			for (size_t jj = 0; jj < len; jj++) {
+				_put_char(current[jj]);
+
+				if (current[jj] == '\n') {
+					_put_char('\r');
+				}
+			}
+			return len;
+		}
 
+		for (size_t jj = 0; jj < len; jj++) {
 			if (current[jj] == '\n') {
-				_put_char('\r');
+				queued = write_bytes(newline, 2);
+			} else {
+				queued = write_bytes(&current[jj], 1);
+			}
+			if (!queued) {
+				/* the rest of the call is dropped as well */
+				mie = write_lock();
+				write_dropped = write_dropped + (len - jj - 1);
+				write_unlock(mie);
+				break;
 			}
 		}
+		/* CTL0 is shared with the interrupt, start the USART and arm TBE under the lock */
+		mie = write_lock();
+		write_pump();
+		if (write_head != write_tail) {
+			usart_interrupt_enable(WRITE_USART, USART_INT_TBE);
+		}
+		write_unlock(mie);
 		return len;
 	}
 
@@ -45,3 +159,42 @@ int _put_char(int ch)
     return ch;
 }
 
+/* switch _write to the buffered backend, WRITE_USART must already be configured */
+void write_async_init(write_overflow_enum policy)
+{
+	unsigned long mie = write_lock();
+
+	write_head = 0;
+	write_tail = 0;
+	write_dropped = 0;
+	write_policy = policy;
+	write_async = 1;
+
+	write_unlock(mie);
+}
+
+/* call from the WRITE_USART interrupt handler */
+void write_async_irq_handler(void)
+{
+	if (RESET != usart_interrupt_flag_get(WRITE_USART, USART_INT_FLAG_TBE)) {
+		unsigned long mie = write_lock();
+		write_pump();
+		write_unlock(mie);
+	}
+}
+
+/* wait until every queued byte has been handed to the USART */
+void write_async_flush(void)
+{
+	while (write_head != write_tail) {
+		unsigned long mie = write_lock();
+		write_pump();
+		write_unlock(mie);
+	}
+}
+
+/* number of bytes discarded by the overflow policy since write_async_init() */
+uint32_t write_async_dropped_get(void)
+{
+	return write_dropped;
+}
@@ -0,0 +1,3891 @@
+/*!
+    \file  host_main.c
+    \brief host build of the firmware library on the register model simulator
+
+    \version 2019-6-5, V1.0.0, firmware for GD32VF103
+*/
+
+/*
+    Copyright (c) 2019, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd32vf103.h"
+#include "gd32vf103_adc_stream.h"
+#include "gd32vf103_bench.h"
+#include "gd32vf103_can_filter.h"
+#include "gd32vf103_can_isotp.h"
+#include "gd32vf103_can_gateway.h"
+#include "gd32vf103_can_queue.h"
+#include "gd32vf103_can_stats.h"
+#include "gd32vf103_crc_stream.h"
+#include "gd32vf103_dac_stream.h"
+#include "gd32vf103_dma_job.h"
+#include "gd32vf103_dsp.h"
+#include "gd32vf103_fmc_kv.h"
+#include "gd32vf103_fmc_log.h"
+#include "gd32vf103_fmc_writer.h"
+#include "gd32vf103_gpio_pinmap.h"
+#include "gd32vf103_i2c_bus.h"
+#include "gd32vf103_i2s_stream.h"
+#include "gd32vf103_spi_bus.h"
+#include "gd32vf103_spi_nor.h"
+#include "gd32vf103_usart_ring.h"
+#include "host_sim.h"
+#include "your_printf.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DSP_CHECK_LEN       600U                                    /* samples fed to each DSP kernel */
+#define DSP_CHECK_TAPS      37U                                     /* taps of the FIR filters */
+#define DSP_CHECK_KERNELS   8U                                      /* kernels compared with a reference */
+#define FMC_KV_CHECK_KEYS   8U                                      /* keys of the key-value store */
+#define FMC_KV_CHECK_LEN    32U                                     /* longest value written */
+#define FMC_KV_CHECK_ABSENT 0xFFFFFFFFU                             /* expected length of a key without value */
+/* get the address of a page of the key-value store */
+#define FMC_KV_CHECK_PAGE(page)     (0x08014000U + ((page) * FMC_KV_PAGE_SIZE))
+#define FMC_LOG_CHECK_LEN   48U                                     /* longest record appended */
+/* get the address of a page of the flash log */
+#define FMC_LOG_CHECK_PAGE(page)    (0x08018000U + ((page) * FMC_LOG_PAGE_SIZE))
+
+static uint32_t source_buffer[64];
+static usart_ring_struct usart_ring;
+static uint32_t usart_ring_idle;
+static uint32_t destination_buffer[64];
+static dma_queue_struct dma_queue;
+static dma_job_struct dma_jobs[3];
+static uint32_t dma_job_order[3];
+static uint32_t dma_job_ends;
+static i2c_bus_struct i2c_bus;
+static uint32_t i2c_callbacks;
+static uint64_t i2c_irq_ticks;
+static uint32_t i2c_ev_calls;
+static spi_bus_struct spi_bus;
+static uint32_t spi_callbacks;
+static uint64_t spi_irq_ticks;
+static spi_nor_struct spi_nor;
+static i2s_stream_struct i2s_stream;
+static uint16_t i2s_next;
+static uint32_t i2s_errors;
+static uint32_t i2s_burn;
+static adc_stream_struct adc_stream;
+static uint32_t adc_expect[8];
+static uint32_t adc_step[8];
+static uint32_t adc_errors;
+static uint32_t adc_burn;
+static dac_stream_struct dac_stream;
+static uint16_t dac_next;
+static uint32_t dac_burn;
+static can_queue_struct can_queue;
+static can_isotp_struct can_isotp[2];
+static can_isotp_session_struct isotp_sessions[2][3];
+static uint32_t isotp_tx_done[2][3];
+static can_isotp_result_enum isotp_tx_result[2][3];
+static uint32_t isotp_rx_done[2][3];
+static can_isotp_result_enum isotp_rx_result[2][3];
+static uint32_t isotp_rx_len[2][3];
+static uint64_t isotp_rx_time[2][3];
+static can_gateway_struct can_gateway;
+static fmc_writer_struct fmc_writer;
+static fmc_writer_page_struct fmc_page_last;
+static uint32_t fmc_page_done;
+static fmc_kv_struct fmc_kv;
+static uint32_t kv_index[FMC_KV_CHECK_KEYS];
+static uint8_t kv_value[FMC_KV_CHECK_KEYS][FMC_KV_CHECK_LEN];
+static uint32_t kv_len[FMC_KV_CHECK_KEYS];
+static uint32_t kv_writes;
+static uint32_t kv_copies;
+static uint32_t kv_erases;
+static fmc_log_struct fmc_log;
+static uint32_t log_ring[256];
+
+/* run the USART transmit path */
+static int usart_check(void);
+/* receive and send through the DMA rings of USART1 */
+static int usart_ring_check(void);
+/* USART1 interrupt */
+static void usart1_irq(void);
+/* DMA0 channel 5 interrupt */
+static void usart1_dma_rx_irq(void);
+/* DMA0 channel 6 interrupt */
+static void usart1_dma_tx_irq(void);
+/* run the CRC block calculation */
+static int crc_check(void);
+/* run a memory to memory DMA transfer */
+static int dma_check(void);
+/* send three queued DMA jobs through the USART0 transmitter */
+static int dma_job_check(void);
+/* DMA job callback */
+static void dma_job_done(dma_job_struct *job);
+/* DMA0 channel 3 interrupt */
+static void dma_job_irq(void);
+/* compare a compiled pin map with the same pins set up by gpio_init */
+static int gpio_pinmap_check(void);
+/* check the CRC stream against a software reference */
+static int crc_stream_check(void);
+/* software reference of the CRC stream */
+static uint32_t crc_stream_reference(const uint8_t *data, uint32_t len);
+/* compare the compact printf with the C library and time both */
+static int printf_check(void);
+/* time driver calls with benchmark regions and report them */
+static int bench_check(void);
+/* run queued I2C transactions against a simulated slave */
+static int i2c_bus_check(void);
+/* I2C transaction callback */
+static void i2c_xfer_done(i2c_xfer_struct *xfer);
+/* interrupt handlers of the I2C transaction queue */
+static void i2c0_ev_irq(void);
+static void i2c0_er_irq(void);
+static void i2c0_dma_irq(void);
+static void i2c0_timer_irq(void);
+/* keep the longest run of an I2C interrupt handler */
+static void i2c_irq_ticks_track(uint64_t start);
+/* run queued SPI transactions of three devices sharing SPI0 */
+static int spi_bus_check(void);
+/* SPI transaction callback */
+static void spi_xfer_done(spi_xfer_struct *xfer);
+/* DMA interrupt handler of the SPI transaction queue */
+static void spi0_dma_irq(void);
+/* program, erase and read a simulated SPI NOR flash */
+static int spi_nor_check(void);
+/* TIMER6 interrupt pacing the status reads of the SPI NOR flash */
+static void spi_nor_timer_irq(void);
+/* stream I2S audio through the ping-pong buffers */
+static int i2s_stream_check(void);
+/* I2S stream callbacks */
+static uint32_t i2s_tx_fill(i2s_stream_struct *stream, uint16_t *data, uint32_t len);
+static uint32_t i2s_rx_take(i2s_stream_struct *stream, uint16_t *data, uint32_t len);
+/* DMA interrupt handler of the I2S stream */
+static void i2s_dma_irq(void);
+/* acquire an 8 channel scan group through the ping-pong frames */
+static int adc_stream_check(void);
+/* ADC stream callback */
+static void adc_frame_take(adc_stream_struct *stream, const uint16_t *frame, uint32_t scans);
+/* run both ADCs in the regular sync modes and compare their sample rates */
+static int adc_dual_check(void);
+/* ADC stream callback of the follow-up modes */
+static void adc_interleaved_take(adc_stream_struct *stream, const uint16_t *frame, uint32_t scans);
+/* DMA interrupt handler of the ADC stream */
+static void adc_dma_irq(void);
+/* compare the fixed-point DSP kernels with double precision references */
+static int dsp_check(void);
+/* track the largest distance between a reference and a result */
+static void dsp_error_update(double *err, double ref, double result);
+/* play a waveform table and a concurrent stream on the DAC */
+static int dac_stream_check(void);
+/* DAC stream callback */
+static uint32_t dac_fill(dac_stream_struct *stream, uint16_t *data, uint32_t len);
+/* DMA interrupt handler of the DAC stream */
+static void dac_dma_irq(void);
+/* compile, load and read back CAN filter plans */
+static int can_filter_check(void);
+/* check a plan against the acceptance of the loaded filter registers */
+static int can_filter_plan_check(const can_filter_plan_struct *plan, const can_filter_id_struct *ids, uint32_t num);
+/* decide, like the CAN, whether the loaded filters accept a data frame */
+static uint32_t can_filter_accept(const uint32_t *regs, uint32_t can, uint32_t ff, uint32_t id);
+/* check the CAN queues against bursts on the simulated bus */
+static int can_queue_check(void);
+/* build a frame the host node sends */
+static void can_queue_frame_make(host_sim_can_frame_struct *frame, uint32_t id, uint32_t ff, uint32_t seq);
+/* check the CAN statistics against frames of known length and timing */
+static int can_stats_check(void);
+/* convert a frame of the host node to the layout of the CAN queues */
+static void can_stats_frame_convert(const host_sim_can_frame_struct *injected, can_queue_frame_struct *frame);
+/* count the bits of a frame on the bus one by one */
+static uint32_t can_stats_bits_reference(const can_queue_frame_struct *frame);
+/* move ISO-TP messages between sessions on CAN0 and CAN1 */
+static int can_isotp_check(void);
+/* let the bus run while both ISO-TP instances are polled */
+static void can_isotp_run(uint32_t ticks);
+/* send a frame of up to 8 bytes from the host node */
+static void can_isotp_inject(uint32_t id, const uint8_t *data, uint32_t dlen);
+/* ISO-TP callback of a message sent */
+static void can_isotp_tx_done(can_isotp_struct *isotp, can_isotp_session_struct *session, can_isotp_result_enum result);
+/* ISO-TP callback of a message received */
+static void can_isotp_rx_done(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t len,
+                              can_isotp_result_enum result);
+/* ISO-TP interrupt handlers */
+static void isotp0_tx_irq(void);
+static void isotp0_rx0_irq(void);
+static void isotp1_tx_irq(void);
+static void isotp1_rx0_irq(void);
+/* forward frames between CAN0 and CAN1 through translating and rate limited routes */
+static int can_gateway_check(void);
+/* gateway interrupt handlers */
+static void gateway0_tx_irq(void);
+static void gateway0_rx0_irq(void);
+static void gateway0_rx1_irq(void);
+static void gateway1_tx_irq(void);
+static void gateway1_rx0_irq(void);
+/* write the flash through the buffered writer */
+static int fmc_writer_check(void);
+/* FMC writer callback of a page flushed */
+static void fmc_writer_page_done(fmc_writer_struct *writer, const fmc_writer_page_struct *page);
+/* keep keys in the flash through updates, garbage collection and resets */
+static int fmc_kv_check(void);
+/* write a value and keep it as the expected one */
+static int fmc_kv_check_write(uint32_t key, uint32_t len, uint32_t version);
+/* compare the store with the expected values */
+static int fmc_kv_check_verify(void);
+/* run the garbage collection to its end */
+static int fmc_kv_check_maintain(void);
+/* do one step of the garbage collection */
+static fmc_kv_result_enum fmc_kv_check_step(uint32_t budget);
+/* set a half word of the flash behind the FMC */
+static void fmc_kv_check_poke(uint32_t address, uint16_t value);
+/* stream records through the flash log */
+static int fmc_log_check(void);
+/* fill the data of a record from its sequence number */
+static uint32_t fmc_log_check_fill(uint8_t *data, uint32_t seq);
+/* run until the flash log is idle */
+static int fmc_log_check_drain(void);
+/* FMC interrupt handler of the flash log */
+static void fmc_log_irq(void);
+/* transmit interrupt handler of the CAN queues */
+static void can_tx_irq(void);
+/* FIFO0 interrupt handler of the CAN queues */
+static void can_rx0_irq(void);
+/* FIFO1 interrupt handler of the CAN queues */
+static void can_rx1_irq(void);
+/* print the register accesses of a check */
+static void access_report(const char *name);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     0 if every check passed
+*/
+int main(void)
+{
+    int failed = 0;
+
+    host_sim_init();
+    SystemInit();
+
+    failed |= usart_check();
+    failed |= usart_ring_check();
+    failed |= gpio_pinmap_check();
+    failed |= crc_check();
+    failed |= crc_stream_check();
+    failed |= dma_check();
+    failed |= dma_job_check();
+    failed |= printf_check();
+    failed |= bench_check();
+    failed |= i2c_bus_check();
+    failed |= spi_bus_check();
+    failed |= spi_nor_check();
+    failed |= i2s_stream_check();
+    failed |= adc_stream_check();
+    failed |= adc_dual_check();
+    failed |= dsp_check();
+    failed |= dac_stream_check();
+    failed |= can_filter_check();
+    failed |= can_queue_check();
+    failed |= can_stats_check();
+    failed |= can_isotp_check();
+    failed |= can_gateway_check();
+    failed |= fmc_writer_check();
+    failed |= fmc_kv_check();
+    failed |= fmc_log_check();
+
+    printf("%s\n", (0 == failed) ? "PASS" : "FAIL");
+    return failed;
+}
+
+/*!
+    \brief      run the USART transmit path
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int usart_check(void)
+{
+    const char message[] = "hello";
+    uint8_t line[sizeof(message)];
+    uint32_t i;
+
+    rcu_periph_clock_enable(RCU_USART0);
+    usart_deinit(USART0);
+    usart_baudrate_set(USART0, 115200U);
+    usart_transmit_config(USART0, USART_TRANSMIT_ENABLE);
+    usart_enable(USART0);
+
+    host_sim_access_clear();
+    for(i = 0U; i < strlen(message); i++){
+        usart_data_transmit(USART0, (uint8_t)message[i]);
+        while(RESET == usart_flag_get(USART0, USART_FLAG_TBE)){
+        }
+    }
+    while(RESET == usart_flag_get(USART0, USART_FLAG_TC)){
+    }
+    access_report("usart_data_transmit");
+
+    i = host_sim_usart_tx_fetch(USART0, line, sizeof(line));
+    return ((strlen(message) != i) || (0 != memcmp(line, message, i))) ? 1 : 0;
+}
+
+/*!
+    \brief      receive and send through the DMA rings of USART1
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int usart_ring_check(void)
+{
+    static uint8_t tx_buffer[64];
+    static uint8_t rx_buffer[64];
+    usart_ring_parameter_struct init_struct;
+    uint8_t data[128];
+    uint8_t line[128];
+    uint8_t *span;
+    uint32_t i, len;
+    int failed = 0;
+
+    for(i = 0U; i < sizeof(data); i++){
+        data[i] = (uint8_t)((i * 7U) + 1U);
+    }
+    host_sim_irq_handler_register(USART1_IRQn, usart1_irq);
+    host_sim_irq_handler_register(DMA0_Channel5_IRQn, usart1_dma_rx_irq);
+    host_sim_irq_handler_register(DMA0_Channel6_IRQn, usart1_dma_tx_irq);
+
+    rcu_periph_clock_enable(RCU_USART1);
+    rcu_periph_clock_enable(RCU_DMA0);
+    usart_deinit(USART1);
+    usart_baudrate_set(USART1, 115200U);
+    usart_receive_config(USART1, USART_RECEIVE_ENABLE);
+    usart_transmit_config(USART1, USART_TRANSMIT_ENABLE);
+    usart_enable(USART1);
+    init_struct.usart_periph = USART1;
+    init_struct.dma_periph = DMA0;
+    init_struct.tx_channel = DMA_CH6;
+    init_struct.rx_channel = DMA_CH5;
+    init_struct.tx_buffer = tx_buffer;
+    init_struct.tx_size = sizeof(tx_buffer);
+    init_struct.rx_buffer = rx_buffer;
+    init_struct.rx_size = sizeof(rx_buffer);
+    failed |= (SUCCESS != usart_ring_init(&usart_ring, &init_struct));
+    usart_ring_idle = 0U;
+
+    /* a message shorter than half the ring is published by the IDLE line event only */
+    host_sim_usart_rx_inject(USART1, data, 10U);
+    host_sim_run(10U * HOST_SIM_USART_FRAME_TICKS);
+    failed |= (0U != usart_ring.rx_head) || (0U != usart_ring_idle);
+    host_sim_run(4U * HOST_SIM_USART_FRAME_TICKS);
+    failed |= (1U != usart_ring_idle) || (10U != usart_ring.rx_head);
+    failed |= (10U != usart_ring_read(&usart_ring, line, sizeof(line))) || (0 != memcmp(line, data, 10U));
+
+    /* a burst across the end of the ring comes back as two spans */
+    host_sim_usart_rx_inject(USART1, &data[10], 40U);
+    host_sim_run(44U * HOST_SIM_USART_FRAME_TICKS);
+    failed |= (40U != usart_ring_read(&usart_ring, line, sizeof(line))) || (0 != memcmp(line, &data[10], 40U));
+    host_sim_usart_rx_inject(USART1, &data[50], 40U);
+    host_sim_run(44U * HOST_SIM_USART_FRAME_TICKS);
+    len = usart_ring_rx_span_get(&usart_ring, &span);
+    failed |= (14U != len) || (span != &rx_buffer[50]) || (0 != memcmp(span, &data[50], 14U));
+    usart_ring_rx_span_release(&usart_ring, len);
+    len = usart_ring_rx_span_get(&usart_ring, &span);
+    failed |= (26U != len) || (span != &rx_buffer[0]) || (0 != memcmp(span, &data[64], 26U));
+    usart_ring_rx_span_release(&usart_ring, len);
+    failed |= (0U != usart_ring.rx_overrun) || (0U != usart_ring_rx_span_get(&usart_ring, &span));
+
+    /* the DMA laps a consumer that stopped reading: the overrun is counted and
+       the reader resumes with the newest ring full of bytes */
+    host_sim_usart_rx_inject(USART1, data, 100U);
+    host_sim_run(104U * HOST_SIM_USART_FRAME_TICKS);
+    failed |= (190U != usart_ring.rx_head) || (0U == usart_ring.rx_overrun);
+    failed |= (64U != usart_ring_read(&usart_ring, line, sizeof(line))) || (0 != memcmp(line, &data[36], 64U));
+    failed |= (190U != usart_ring.rx_tail);
+
+    /* a write passing the end of the TX ring goes out as two chained DMA transfers */
+    failed |= (40U != usart_ring_write(&usart_ring, data, 40U));
+    host_sim_run(44U * HOST_SIM_USART_FRAME_TICKS);
+    failed |= (40U != host_sim_usart_tx_fetch(USART1, line, sizeof(line))) || (0 != memcmp(line, data, 40U));
+    len = usart_ring_tx_span_get(&usart_ring, &span);
+    failed |= (24U != len) || (span != &tx_buffer[40]);
+    failed |= (50U != usart_ring_write(&usart_ring, &data[40], 50U));
+    failed |= (24U != usart_ring.tx_inflight) || (26U != usart_ring_tx_pending_get(&usart_ring));
+    host_sim_run(54U * HOST_SIM_USART_FRAME_TICKS);
+    failed |= (50U != host_sim_usart_tx_fetch(USART1, line, sizeof(line))) || (0 != memcmp(line, &data[40], 50U));
+    failed |= (90U != usart_ring.tx_tail) || (0U != usart_ring.tx_busy);
+
+    usart_ring_deinit(&usart_ring);
+    usart_disable(USART1);
+    host_sim_irq_handler_register(USART1_IRQn, NULL);
+    host_sim_irq_handler_register(DMA0_Channel5_IRQn, NULL);
+    host_sim_irq_handler_register(DMA0_Channel6_IRQn, NULL);
+    printf("%-28s %6u bytes %u overruns %s\n", "usart_ring", (unsigned)(usart_ring.rx_head + usart_ring.tx_tail),
+           (unsigned)usart_ring.rx_overrun, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      USART1 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void usart1_irq(void)
+{
+    usart_ring_idle++;
+    usart_ring_usart_irq_handler(&usart_ring);
+}
+
+/*!
+    \brief      DMA0 channel 5 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void usart1_dma_rx_irq(void)
+{
+    usart_ring_dma_rx_irq_handler(&usart_ring);
+}
+
+/*!
+    \brief      DMA0 channel 6 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void usart1_dma_tx_irq(void)
+{
+    usart_ring_dma_tx_irq_handler(&usart_ring);
+}
+
+/*!
+    \brief      run the CRC block calculation
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int crc_check(void)
+{
+    uint32_t data[2] = {0x12345678U, 0xFFFFFFFFU};
+    uint32_t value;
+
+    rcu_periph_clock_enable(RCU_CRC);
+    crc_data_register_reset();
+
+    host_sim_access_clear();
+    value = crc_block_data_calculate(data, 2U);
+    access_report("crc_block_data_calculate");
+
+    /* CRC-32/MPEG-2 of the two words, computed offline */
+    return (0x58F13D03U != value) ? 1 : 0;
+}
+
+/*!
+    \brief      compare a compiled pin map with the same pins set up by gpio_init
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int gpio_pinmap_check(void)
+{
+    static const gpio_pinmap_entry_struct board[] = {
+        {GPIOA, GPIO_PIN_9,                GPIO_MODE_AF_PP,       GPIO_OSPEED_50MHZ, RESET},
+        {GPIOA, GPIO_PIN_10,               GPIO_MODE_IN_FLOATING, 0U,                RESET},
+        {GPIOA, GPIO_PIN_0 | GPIO_PIN_1,   GPIO_MODE_AIN,         0U,                RESET},
+        {GPIOB, GPIO_PIN_6 | GPIO_PIN_7,   GPIO_MODE_AF_OD,       GPIO_OSPEED_50MHZ, RESET},
+        {GPIOB, GPIO_PIN_12,               GPIO_MODE_IPU,         0U,                RESET},
+        {GPIOC, GPIO_PIN_0 | GPIO_PIN_2,   GPIO_MODE_OUT_PP,      GPIO_OSPEED_2MHZ,  SET},
+        {GPIOC, GPIO_PIN_13,               GPIO_MODE_IPD,         0U,                RESET},
+    };
+    static const gpio_pinmap_entry_struct twice[] = {
+        {GPIOB, GPIO_PIN_3 | GPIO_PIN_4,   GPIO_MODE_OUT_PP,      GPIO_OSPEED_10MHZ, RESET},
+        {GPIOB, GPIO_PIN_4,                GPIO_MODE_IPU,         0U,                RESET},
+    };
+    static const uint32_t remap[] = {GPIO_SWJ_NONJTRST_REMAP, GPIO_TIMER2_PARTIAL_REMAP, GPIO_TIMER4CH3_IREMAP};
+    /* GPIOC of the same map, written as constants */
+    static const gpio_port_image_struct port_c = {
+        GPIOC,
+        (GPIO_PINMAP_CTL_RESET & ~(GPIO_MODE_MASK(0) | GPIO_MODE_MASK(2)))
+            | GPIO_PINMAP_CTL0(0U, GPIO_MODE_OUT_PP, GPIO_OSPEED_2MHZ) | GPIO_PINMAP_CTL0(2U, GPIO_MODE_OUT_PP, GPIO_OSPEED_2MHZ),
+        (GPIO_PINMAP_CTL_RESET & ~GPIO_MODE_MASK(5)) | GPIO_PINMAP_CTL1(13U, GPIO_MODE_IPD, 0U),
+        GPIO_PINMAP_OCTL(0U, GPIO_MODE_OUT_PP, SET) | GPIO_PINMAP_OCTL(2U, GPIO_MODE_OUT_PP, SET)
+    };
+    gpio_pinmap_image_struct image;
+    uint32_t expected[11];
+    uint32_t actual[11];
+    uint32_t i;
+    int failed = 0;
+
+    /* the board set up one call at a time */
+    host_sim_reset();
+    host_sim_access_clear();
+    gpio_init(GPIOA, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_9);
+    gpio_init(GPIOA, GPIO_MODE_IN_FLOATING, GPIO_OSPEED_50MHZ, GPIO_PIN_10);
+    gpio_init(GPIOA, GPIO_MODE_AIN, GPIO_OSPEED_50MHZ, GPIO_PIN_0 | GPIO_PIN_1);
+    gpio_init(GPIOB, GPIO_MODE_AF_OD, GPIO_OSPEED_50MHZ, GPIO_PIN_6 | GPIO_PIN_7);
+    gpio_init(GPIOB, GPIO_MODE_IPU, GPIO_OSPEED_50MHZ, GPIO_PIN_12);
+    gpio_bit_set(GPIOC, GPIO_PIN_0 | GPIO_PIN_2);
+    gpio_init(GPIOC, GPIO_MODE_OUT_PP, GPIO_OSPEED_2MHZ, GPIO_PIN_0 | GPIO_PIN_2);
+    gpio_init(GPIOC, GPIO_MODE_IPD, GPIO_OSPEED_50MHZ, GPIO_PIN_13);
+    gpio_pin_remap_config(GPIO_SWJ_NONJTRST_REMAP, ENABLE);
+    gpio_pin_remap_config(GPIO_TIMER2_PARTIAL_REMAP, ENABLE);
+    gpio_pin_remap_config(GPIO_TIMER4CH3_IREMAP, ENABLE);
+    access_report("gpio_init board");
+    for(i = 0U; i < 3U; i++){
+        expected[3U * i] = GPIO_CTL0(GPIOA + 0x400U * i);
+        expected[3U * i + 1U] = GPIO_CTL1(GPIOA + 0x400U * i);
+        expected[3U * i + 2U] = GPIO_OCTL(GPIOA + 0x400U * i);
+    }
+    /* the library writes ones to the unused SWJ_CFG code with the other remaps */
+    expected[9] = host_sim_reg_peek(AFIO + 0x04U) & ~0x0F000000U;
+    expected[10] = host_sim_reg_peek(AFIO + 0x1CU);
+
+    /* the same board from the pin table */
+    host_sim_reset();
+    failed |= (SUCCESS != gpio_pinmap_compile(board, sizeof(board) / sizeof(board[0]), remap, 3U, &image)) ? 1 : 0;
+    host_sim_access_clear();
+    gpio_pinmap_apply(&image);
+    access_report("gpio_pinmap_apply board");
+    for(i = 0U; i < 3U; i++){
+        actual[3U * i] = GPIO_CTL0(GPIOA + 0x400U * i);
+        actual[3U * i + 1U] = GPIO_CTL1(GPIOA + 0x400U * i);
+        actual[3U * i + 2U] = GPIO_OCTL(GPIOA + 0x400U * i);
+    }
+    actual[9] = host_sim_reg_peek(AFIO + 0x04U) & ~0x0F000000U;
+    actual[10] = host_sim_reg_peek(AFIO + 0x1CU);
+    failed |= (0 != memcmp(expected, actual, sizeof(expected))) ? 1 : 0;
+    failed |= (0x01000000U != (host_sim_reg_peek(AFIO + 0x04U) & 0x07000000U)) ? 1 : 0;
+
+    failed |= (0 != memcmp(&port_c, &image.port[2], sizeof(port_c))) ? 1 : 0;
+
+    /* a pin listed twice is refused */
+    failed |= (ERROR != gpio_pinmap_compile(twice, 2U, NULL, 0U, &image)) ? 1 : 0;
+
+    return failed;
+}
+
+/*!
+    \brief      check the CRC stream against a software reference
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int crc_stream_check(void)
+{
+    static uint8_t image[4099];
+    crc_stream_struct stream;
+    uint32_t seed = 1U;
+    uint32_t i, round, offset, len, chunk, done;
+    int failed = 0;
+
+    for(i = 0U; i < sizeof(image); i++){
+        seed = seed * 1103515245U + 12345U;
+        image[i] = (uint8_t)(seed >> 16);
+    }
+
+    rcu_periph_clock_enable(RCU_CRC);
+    rcu_periph_clock_enable(RCU_DMA0);
+
+    /* whole words give the same value as crc_block_data_calculate */
+    crc_stream_init(&stream);
+    crc_stream_update(&stream, "\x78\x56\x34\x12\xFF\xFF\xFF\xFF", 8U);
+    failed |= (0x58F13D03U != crc_stream_final(&stream)) ? 1 : 0;
+
+    /* random offsets and chunking, every third round through the DMA */
+    for(round = 0U; round < 64U; round++){
+        seed = seed * 1103515245U + 12345U;
+        offset = (seed >> 8) & 7U;
+        len = (seed >> 12) % (sizeof(image) - offset);
+
+        crc_stream_init(&stream);
+        if(0U == (round % 3U)){
+            crc_stream_dma_config(&stream, DMA0, DMA_CH1, 4U);
+        }
+        for(done = 0U; done < len; done += chunk){
+            seed = seed * 1103515245U + 12345U;
+            chunk = ((seed >> 16) % 700U) + 1U;
+            if(chunk > (len - done)){
+                chunk = len - done;
+            }
+            crc_stream_update_start(&stream, &image[offset + done], chunk);
+        }
+        if(crc_stream_final(&stream) != crc_stream_reference(&image[offset], len)){
+            printf("crc stream offset %u length %u mismatch\n", offset, len);
+            failed = 1;
+        }
+    }
+
+    /* bus accesses of the CPU for 4 KB, fed by the CPU and by the DMA */
+    crc_stream_init(&stream);
+    host_sim_access_clear();
+    crc_stream_update(&stream, image, 4096U);
+    access_report("crc_stream_update cpu");
+    crc_stream_dma_config(&stream, DMA0, DMA_CH1, CRC_STREAM_DMA_THRESHOLD);
+    host_sim_access_clear();
+    crc_stream_update_start(&stream, image, 4096U);
+    access_report("crc_stream_update_start dma");
+    crc_stream_wait(&stream);
+
+    return failed;
+}
+
+/*!
+    \brief      software reference of the CRC stream
+    \param[in]  data: bytes of the stream
+    \param[in]  len: number of bytes
+    \param[out] none
+    \retval     CRC value
+*/
+static uint32_t crc_stream_reference(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+    uint32_t i, byte, bit, group;
+
+    for(i = 0U; i < len; i += group){
+        /* little-endian word or partial word, most significant byte first */
+        group = ((len - i) < 4U) ? (len - i) : 4U;
+        for(byte = group; byte > 0U; byte--){
+            crc ^= (uint32_t)data[i + byte - 1U] << 24;
+            for(bit = 0U; bit < 8U; bit++){
+                crc = (0U != (crc & 0x80000000U)) ? ((crc << 1) ^ 0x04C11DB7U) : (crc << 1);
+            }
+        }
+    }
+
+    return crc;
+}
+
+/*!
+    \brief      run a memory to memory DMA transfer
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int dma_check(void)
+{
+    dma_parameter_struct dma_init_struct;
+    uint32_t i;
+
+    for(i = 0U; i < 64U; i++){
+        source_buffer[i] = i * 0x01010101U;
+    }
+
+    rcu_periph_clock_enable(RCU_DMA0);
+    dma_deinit(DMA0, DMA_CH0);
+    dma_init_struct.direction = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr = (uint32_t)destination_buffer;
+    dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_32BIT;
+    dma_init_struct.number = 64U;
+    dma_init_struct.periph_addr = (uint32_t)source_buffer;
+    dma_init_struct.periph_inc = DMA_PERIPH_INCREASE_ENABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_32BIT;
+    dma_init_struct.priority = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(DMA0, DMA_CH0, &dma_init_struct);
+    dma_circulation_disable(DMA0, DMA_CH0);
+    dma_memory_to_memory_enable(DMA0, DMA_CH0);
+
+    host_sim_access_clear();
+    dma_channel_enable(DMA0, DMA_CH0);
+    while(RESET == dma_flag_get(DMA0, DMA_CH0, DMA_FLAG_FTF)){
+    }
+    access_report("dma memory to memory");
+
+    return ((0U != dma_transfer_number_get(DMA0, DMA_CH0))
+            || (0 != memcmp(source_buffer, destination_buffer, sizeof(source_buffer)))) ? 1 : 0;
+}
+
+/*!
+    \brief      send three queued DMA jobs through the USART0 transmitter
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int dma_job_check(void)
+{
+    static dma_job_struct *slots[4];
+    static uint8_t message[24];
+    dma_parameter_struct dma_init_struct;
+    dma_job_struct empty;
+    host_sim_access_struct access;
+    uint8_t line[32];
+    uint64_t start, ticks;
+    uint32_t i, len;
+    int failed = 0;
+
+    for(i = 0U; i < sizeof(message); i++){
+        message[i] = (uint8_t)('a' + i);
+    }
+    host_sim_irq_handler_register(DMA0_Channel3_IRQn, dma_job_irq);
+    rcu_periph_clock_enable(RCU_USART0);
+    rcu_periph_clock_enable(RCU_DMA0);
+    usart_deinit(USART0);
+    usart_baudrate_set(USART0, 115200U);
+    usart_transmit_config(USART0, USART_TRANSMIT_ENABLE);
+    usart_enable(USART0);
+    usart_dma_transmit_config(USART0, USART_DENT_ENABLE);
+    failed |= (SUCCESS != dma_queue_init(&dma_queue, DMA0, DMA_CH3, slots, 4U));
+
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_inc = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number = 8U;
+    dma_init_struct.periph_addr = (uint32_t)&USART_DATA(USART0);
+    dma_init_struct.periph_inc = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.priority = DMA_PRIORITY_MEDIUM;
+    for(i = 0U; i < 3U; i++){
+        dma_init_struct.memory_addr = (uint32_t)&message[8U * i];
+        dma_job_prepare(&dma_jobs[i], &dma_init_struct, DMA_MEMORY_TO_MEMORY_DISABLE, dma_job_done);
+    }
+    dma_job_ends = 0U;
+
+    /* an idle queue starts the job with register writes only, the others just queue */
+    start = host_sim_time_get();
+    host_sim_access_clear();
+    failed |= (SUCCESS != dma_queue_submit(&dma_queue, &dma_jobs[0]));
+    access_report("dma_queue_submit idle");
+    failed |= (SUCCESS != dma_queue_submit(&dma_queue, &dma_jobs[1]));
+    failed |= (SUCCESS != dma_queue_submit(&dma_queue, &dma_jobs[2]));
+    host_sim_access_get(&access);
+    failed |= (0U != access.read) || (6U != access.write);
+    failed |= (ERROR != dma_queue_submit(&dma_queue, &dma_jobs[2])) || (3U != dma_queue_pending_get(&dma_queue));
+    /* a job without data would never end, nor would the ones behind it */
+    dma_init_struct.number = 0x10000U;
+    dma_job_prepare(&empty, &dma_init_struct, DMA_MEMORY_TO_MEMORY_DISABLE, NULL);
+    failed |= (ERROR != dma_queue_submit(&dma_queue, &empty)) || (3U != dma_queue_pending_get(&dma_queue));
+
+    /* back to back: the line never idles between jobs, so the 24 frames take
+       24 frame times plus the start of the first one */
+    for(i = 0U; (i < 1000U) && ((3U != dma_job_ends) || (0U == (host_sim_reg_peek(USART0 + 0x00U) & USART_STAT_TC))); i++){
+        host_sim_run(1U);
+    }
+    ticks = host_sim_time_get() - start;
+    failed |= (ticks > ((sizeof(message) + 1U) * HOST_SIM_USART_FRAME_TICKS));
+    len = host_sim_usart_tx_fetch(USART0, line, sizeof(line));
+    failed |= (sizeof(message) != len) || (0 != memcmp(line, message, len));
+    for(i = 0U; i < 3U; i++){
+        failed |= (i != dma_job_order[i]) || (DMA_JOB_DONE != dma_jobs[i].status);
+    }
+    failed |= (0U != dma_queue_pending_get(&dma_queue));
+
+    dma_queue_stop(&dma_queue);
+    usart_dma_transmit_config(USART0, USART_DENT_DISABLE);
+    usart_disable(USART0);
+    host_sim_irq_handler_register(DMA0_Channel3_IRQn, NULL);
+    printf("%-28s %6u ticks for %u frames %s\n", "dma_queue", (unsigned)ticks, (unsigned)sizeof(message),
+           (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      DMA job callback
+    \param[in]  job: finished job
+    \param[out] none
+    \retval     none
+*/
+static void dma_job_done(dma_job_struct *job)
+{
+    if(dma_job_ends < 3U){
+        dma_job_order[dma_job_ends] = (uint32_t)(job - dma_jobs);
+    }
+    dma_job_ends++;
+}
+
+/*!
+    \brief      DMA0 channel 3 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void dma_job_irq(void)
+{
+    dma_queue_irq_handler(&dma_queue);
+}
+
+/*!
+    \brief      compare the compact printf with the C library and time both
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int printf_check(void)
+{
+    /* fixed-point conversions have no C library counterpart, the rest must match snprintf */
+    static const struct {
+        const char *expected;
+        int32_t value;
+        int length;
+        const char *format;
+    } fixed[] = {
+        {"3.1416",       205887,      0,  "%q"},
+        {"-1.50",        -98304,      0,  "%.2q"},
+        {"  +0.250",     8192,        -1, "%+8.3hq"},
+        {"-1.000000",    INT32_MIN,   1,  "%.6lq"},
+        {"1.0000",       0x7FFFFFFF,  1,  "%lq"},
+        {"-0.5000",      -16384,      -1, "%hq"},
+        {"000012.5",     819200,      0,  "%08.1q"},
+    };
+    char ours[64];
+    char theirs[64];
+    uint64_t start;
+    uint64_t our_cycles;
+    uint64_t their_cycles;
+    uint32_t i;
+    int failed = 0;
+
+    your_snprintf(ours, sizeof(ours), "%d|%5i|%-5d|%05d|%+d|% d|%.3d|%hd|%hhu", -42, 7, 7, -42, 3, 3, 5, 70000, 300);
+    snprintf(theirs, sizeof(theirs), "%d|%5i|%-5d|%05d|%+d|% d|%.3d|%hd|%hhu", -42, 7, 7, -42, 3, 3, 5, 70000, 300);
+    failed |= strcmp(ours, theirs);
+    your_snprintf(ours, sizeof(ours), "%x|%X|%08x|%lu|%c|%-3c|%s|%.2s|%6s|%%|%.0d", 0xBEEFU, 0xBEEFU, 0x1FU,
+                  4294967295UL, 'a', 'b', "str", "str", "str", 0);
+    snprintf(theirs, sizeof(theirs), "%x|%X|%08x|%lu|%c|%-3c|%s|%.2s|%6s|%%|%.0d", 0xBEEFU, 0xBEEFU, 0x1FU,
+             4294967295UL, 'a', 'b', "str", "str", "str", 0);
+    failed |= strcmp(ours, theirs);
+    failed |= (your_snprintf(ours, 8U, "%s", "truncated output") != 16) || strcmp(ours, "truncat");
+
+    for(i = 0U; i < sizeof(fixed) / sizeof(fixed[0]); i++){
+        if(fixed[i].length > 0){
+            your_snprintf(ours, sizeof(ours), fixed[i].format, (long)fixed[i].value);
+        }else{
+            your_snprintf(ours, sizeof(ours), fixed[i].format, (int)fixed[i].value);
+        }
+        if(0 != strcmp(ours, fixed[i].expected)){
+            printf("printf %s: \"%s\", expected \"%s\"\n", fixed[i].format, ours, fixed[i].expected);
+            failed = 1;
+        }
+    }
+
+    /* host cycles per call of a typical log line */
+    start = __builtin_ia32_rdtsc();
+    for(i = 0U; i < 100000U; i++){
+        your_snprintf(ours, sizeof(ours), "ch%u adc=%5d t=%08x %s", i & 7U, (int)i - 5000, i, "ok");
+    }
+    our_cycles = (__builtin_ia32_rdtsc() - start) / 100000U;
+    start = __builtin_ia32_rdtsc();
+    for(i = 0U; i < 100000U; i++){
+        snprintf(theirs, sizeof(theirs), "ch%u adc=%5d t=%08x %s", i & 7U, (int)i - 5000, i, "ok");
+    }
+    their_cycles = (__builtin_ia32_rdtsc() - start) / 100000U;
+    printf("%-28s %6llu cycles %6llu C library\n", "your_snprintf",
+           (unsigned long long)our_cycles, (unsigned long long)their_cycles);
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      time driver calls with benchmark regions and report them
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int bench_check(void)
+{
+    static bench_region_struct region[2];
+    static char report[512];
+    uint8_t line[512];
+    bench_sink_struct sink;
+    uint32_t len;
+    int failed = 0;
+
+    bench_init();
+    bench_region_init(&region[0], "crc_block");
+    bench_region_init(&region[1], "gpio_init");
+
+    /* one sample per length, the bus time grows linearly with the length */
+    crc_data_register_reset();
+    for(len = 1U; len <= 40U; len++){
+        bench_region_start(&region[0]);
+        crc_block_data_calculate(source_buffer, len);
+        bench_region_stop(&region[0]);
+    }
+    rcu_periph_clock_enable(RCU_GPIOB);
+    for(len = 0U; len < 100U; len++){
+        bench_region_start(&region[1]);
+        gpio_init(GPIOB, GPIO_MODE_OUT_PP, GPIO_OSPEED_50MHZ, BIT(len & 15U));
+        bench_region_stop(&region[1]);
+    }
+
+    failed |= (40U != region[0].count) || (region[0].min >= region[0].max);
+    failed |= (bench_region_percentile(&region[0], 0U) != region[0].min);
+    failed |= (bench_region_percentile(&region[0], 100U) != region[0].max);
+    failed |= (bench_region_mean(&region[0]) != ((region[0].min + region[0].max) / 2U));
+    failed |= (bench_region_percentile(&region[0], 50U) != (region[0].min + (19U * (region[0].max - region[0].min) / 39U)));
+    failed |= (100U != region[1].count) || (bench_region_percentile(&region[1], 99U) > region[1].max);
+
+    /* the RAM buffer and the USART get the same text */
+    bench_sink_buffer_init(&sink, report, sizeof(report));
+    bench_report(&sink, region, 2U);
+    printf("%s", report);
+    usart_deinit(USART0);
+    usart_baudrate_set(USART0, 115200U);
+    usart_transmit_config(USART0, USART_TRANSMIT_ENABLE);
+    usart_enable(USART0);
+    bench_sink_usart_init(&sink, USART0);
+    bench_report(&sink, region, 2U);
+    while(RESET == usart_flag_get(USART0, USART_FLAG_TC)){
+    }
+    len = host_sim_usart_tx_fetch(USART0, line, sizeof(line));
+    failed |= (strlen(report) != len) || (0 != memcmp(line, report, len));
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      run queued I2C transactions against a simulated slave
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int i2c_bus_check(void)
+{
+    /* register reads of every length with a special case, the last two go through the DMA */
+    static const uint32_t read_len[] = {1U, 2U, 3U, 4U, 7U, 8U, 20U};
+    static uint8_t slave[256];
+    static i2c_xfer_struct *slots[32];
+    static i2c_xfer_struct xfer[32];
+    static uint8_t reg[16];
+    static uint8_t rx[16][32];
+    static uint8_t tx_short[3] = {0x10U, 0xC1U, 0xC2U};
+    static uint8_t tx[20];
+    uint32_t n = 0U;
+    uint32_t i, j, late;
+    int failed = 0;
+
+    for(i = 0U; i < sizeof(slave); i++){
+        slave[i] = (uint8_t)(i ^ 0x5AU);
+    }
+    host_sim_i2c_slave_attach(I2C0, 0xA0U, slave, sizeof(slave));
+    /* closer to 400 kHz against the core clock, so that a STOP outlasts an interrupt handler */
+    host_sim_i2c_byte_ticks_config(I2C0, 180U);
+    host_sim_irq_handler_register(I2C0_EV_IRQn, i2c0_ev_irq);
+    host_sim_irq_handler_register(I2C0_ER_IRQn, i2c0_er_irq);
+    host_sim_irq_handler_register(DMA0_Channel5_IRQn, i2c0_dma_irq);
+    host_sim_irq_handler_register(DMA0_Channel6_IRQn, i2c0_dma_irq);
+    host_sim_irq_handler_register(TIMER6_IRQn, i2c0_timer_irq);
+
+    rcu_periph_clock_enable(RCU_I2C0);
+    rcu_periph_clock_enable(RCU_DMA0);
+    rcu_periph_clock_enable(RCU_TIMER6);
+    i2c_clock_config(I2C0, 400000U, I2C_DTCY_2);
+    i2c_mode_addr_config(I2C0, I2C_I2CMODE_ENABLE, I2C_ADDFORMAT_7BITS, 0x72U);
+    i2c_enable(I2C0);
+    i2c_bus_init(&i2c_bus, I2C0, slots, 32U);
+    i2c_bus_dma_config(&i2c_bus, DMA0, 8U);
+    /* a byte and its acknowledge take 180 ticks, so one SCL period is 20 */
+    i2c_bus_timer_config(&i2c_bus, TIMER6, 20U);
+    i2c_callbacks = 0U;
+    i2c_irq_ticks = 0U;
+
+    /* a short write by the CPU and a long one through the DMA */
+    i2c_xfer_prepare(&xfer[n++], 0xA0U, tx_short, 3U, NULL, 0U, i2c_xfer_done);
+    for(i = 0U; i < 20U; i++){
+        tx[i] = (uint8_t)(0x80U + i);
+    }
+    tx[0] = 0x40U;
+    i2c_xfer_prepare(&xfer[n++], 0xA0U, tx, 20U, NULL, 0U, i2c_xfer_done);
+    /* nobody answers at 0x50 */
+    i2c_xfer_prepare(&xfer[n++], 0x50U, NULL, 0U, NULL, 0U, i2c_xfer_done);
+    /* each register read is followed by a plain read of one byte, which has to
+       return the byte after the last one read if no byte was read too many */
+    for(i = 0U; i < sizeof(read_len) / sizeof(read_len[0]); i++){
+        reg[i] = (uint8_t)(0x30U + (i * 0x18U));
+        i2c_xfer_prepare(&xfer[n++], 0xA0U, &reg[i], 1U, rx[2U * i], read_len[i], i2c_xfer_done);
+        i2c_xfer_prepare(&xfer[n++], 0xA0U, NULL, 0U, rx[(2U * i) + 1U], 1U, i2c_xfer_done);
+    }
+    for(i = 0U; i < n; i++){
+        failed |= (SUCCESS != i2c_bus_submit(&i2c_bus, &xfer[i]));
+    }
+    failed |= (ERROR != i2c_bus_submit(&i2c_bus, &xfer[0]));
+
+    /* a transaction ending while the STOP of the previous one is going out is
+       started by the timer rather than by an interrupt spinning on STOP */
+    for(i = 0U; (i < 100000U) && (0U != i2c_bus_pending_get(&i2c_bus)); i++){
+        host_sim_run(1U);
+    }
+    failed |= (0U == host_sim_timer_updates_get(TIMER6));
+
+    failed |= (n != i2c_callbacks);
+    failed |= (I2C_XFER_DONE != xfer[0].status) || (I2C_XFER_DONE != xfer[1].status);
+    failed |= (I2C_XFER_NACK != xfer[2].status);
+    failed |= (0xC1U != slave[0x10]) || (0xC2U != slave[0x11]) || (0x5AU ^ 0x12U) != slave[0x12];
+    for(i = 1U; i < 20U; i++){
+        failed |= ((uint8_t)(0x80U + i) != slave[0x40U + i - 1U]);
+    }
+    for(i = 0U; i < sizeof(read_len) / sizeof(read_len[0]); i++){
+        failed |= (I2C_XFER_DONE != xfer[3U + (2U * i)].status) || (I2C_XFER_DONE != xfer[4U + (2U * i)].status);
+        for(j = 0U; j < read_len[i]; j++){
+            failed |= (slave[reg[i] + j] != rx[2U * i][j]);
+        }
+        failed |= (slave[reg[i] + read_len[i]] != rx[(2U * i) + 1U][0]);
+    }
+
+    /* the DMA interrupt of a write held off well past its last byte: the BTC
+       waiting for it must not raise the event interrupt meanwhile */
+    host_sim_irq_handler_register(DMA0_Channel5_IRQn, NULL);
+    i2c_ev_calls = 0U;
+    i2c_xfer_prepare(&xfer[0], 0xA0U, tx, 20U, NULL, 0U, i2c_xfer_done);
+    failed |= (SUCCESS != i2c_bus_submit(&i2c_bus, &xfer[0]));
+    host_sim_run(40U * 180U);
+    late = i2c_ev_calls;
+    host_sim_irq_handler_register(DMA0_Channel5_IRQn, i2c0_dma_irq);
+    for(i = 0U; (i < 100000U) && (0U != i2c_bus_pending_get(&i2c_bus)); i++){
+        host_sim_run(1U);
+    }
+    failed |= (I2C_XFER_DONE != xfer[0].status) || (late > 4U);
+
+    /* the STOP of the last transaction is still going out */
+    host_sim_run(180U);
+    failed |= (0U != (I2C_STAT1(I2C0) & I2C_STAT1_I2CBSY));
+    /* no handler waits for the bus: the longest one is a few register accesses */
+    failed |= (i2c_irq_ticks > 24U);
+    host_sim_i2c_byte_ticks_config(I2C0, HOST_SIM_I2C_BYTE_TICKS);
+    /* hand TIMER6 back in its reset state */
+    host_sim_irq_handler_register(TIMER6_IRQn, NULL);
+    TIMER_DMAINTEN(TIMER6) = 0U;
+    TIMER_CTL0(TIMER6) = 0U;
+    TIMER_CAR(TIMER6) = 0U;
+    TIMER_INTF(TIMER6) = 0U;
+    printf("%-28s %6u transactions %u ticks longest interrupt %s\n", "i2c_bus", (unsigned)n, (unsigned)i2c_irq_ticks,
+           (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      I2C transaction callback
+    \param[in]  xfer: finished transaction
+    \param[out] none
+    \retval     none
+*/
+static void i2c_xfer_done(i2c_xfer_struct *xfer)
+{
+    (void)xfer;
+    i2c_callbacks++;
+}
+
+/*!
+    \brief      I2C0 event interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void i2c0_ev_irq(void)
+{
+    uint64_t start = host_sim_time_get();
+
+    i2c_ev_calls++;
+    i2c_bus_event_irq_handler(&i2c_bus);
+    i2c_irq_ticks_track(start);
+}
+
+/*!
+    \brief      I2C0 error interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void i2c0_er_irq(void)
+{
+    uint64_t start = host_sim_time_get();
+
+    i2c_bus_error_irq_handler(&i2c_bus);
+    i2c_irq_ticks_track(start);
+}
+
+/*!
+    \brief      DMA0 channel 5 and 6 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void i2c0_dma_irq(void)
+{
+    uint64_t start = host_sim_time_get();
+
+    i2c_bus_dma_irq_handler(&i2c_bus);
+    i2c_irq_ticks_track(start);
+}
+
+/*!
+    \brief      TIMER6 interrupt, looks again at the STOP of the I2C
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void i2c0_timer_irq(void)
+{
+    uint64_t start = host_sim_time_get();
+
+    i2c_bus_timer_irq_handler(&i2c_bus);
+    i2c_irq_ticks_track(start);
+}
+
+/*!
+    \brief      keep the longest run of an I2C interrupt handler
+    \param[in]  start: bus time when the handler was entered
+    \param[out] none
+    \retval     none
+*/
+static void i2c_irq_ticks_track(uint64_t start)
+{
+    uint64_t ticks = host_sim_time_get() - start;
+
+    if(ticks > i2c_irq_ticks){
+        i2c_irq_ticks = ticks;
+    }
+}
+
+/*!
+    \brief      run queued SPI transactions of three devices sharing SPI0
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int spi_bus_check(void)
+{
+    static const uint8_t flash_cmd[4] = {0x03U, 0x00U, 0x10U, 0x00U};
+    static const uint8_t flash_status_cmd = 0x05U;
+    static const uint16_t adc_cmd[2] = {0x1234U, 0x5678U};
+    static uint8_t flash[64];
+    static uint8_t adc[64];
+    static uint8_t display[64];
+    static uint8_t flash_rx[40];
+    static uint16_t adc_rx[20];
+    static uint16_t adc_tx[20];
+    static uint8_t pixels[40];
+    static spi_xfer_struct *slots[8];
+    static spi_xfer_struct xfer[6];
+    spi_parameter_struct spi_init_struct;
+    spi_device_struct flash_dev, adc_dev, display_dev;
+    uint8_t flash_ref[64];
+    uint8_t adc_ref[64];
+    uint32_t i;
+    int failed = 0;
+
+    for(i = 0U; i < 64U; i++){
+        flash[i] = flash_ref[i] = (uint8_t)(i ^ 0xA5U);
+        adc[i] = adc_ref[i] = (uint8_t)(i * 7U);
+        display[i] = 0U;
+    }
+    for(i = 0U; i < 20U; i++){
+        adc_tx[i] = (uint16_t)(0x0100U + i);
+    }
+    for(i = 0U; i < 40U; i++){
+        pixels[i] = (uint8_t)(0xE0U - i);
+    }
+    host_sim_spi_slave_attach(SPI0, GPIOA, GPIO_PIN_4, 0U, flash, sizeof(flash));
+    host_sim_spi_slave_attach(SPI0, GPIOB, GPIO_PIN_0, SPI_CTL0_CKPL | SPI_CTL0_CKPH | SPI_CTL0_FF16, adc, sizeof(adc));
+    host_sim_spi_slave_attach(SPI0, GPIOB, GPIO_PIN_1, SPI_CTL0_LF, display, sizeof(display));
+    host_sim_irq_handler_register(DMA0_Channel1_IRQn, spi0_dma_irq);
+    host_sim_irq_handler_register(DMA0_Channel2_IRQn, spi0_dma_irq);
+
+    rcu_periph_clock_enable(RCU_GPIOA);
+    rcu_periph_clock_enable(RCU_GPIOB);
+    rcu_periph_clock_enable(RCU_SPI0);
+    rcu_periph_clock_enable(RCU_DMA0);
+
+    spi_init_struct.frame_size = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.endian = SPI_ENDIAN_MSB;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE;
+    spi_init_struct.prescale = SPI_PSC_2;
+    spi_device_init(&flash_dev, &spi_init_struct, GPIOA, GPIO_PIN_4);
+    spi_init_struct.frame_size = SPI_FRAMESIZE_16BIT;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_HIGH_PH_2EDGE;
+    spi_init_struct.prescale = SPI_PSC_8;
+    spi_device_init(&adc_dev, &spi_init_struct, GPIOB, GPIO_PIN_0);
+    spi_init_struct.frame_size = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.endian = SPI_ENDIAN_LSB;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE;
+    spi_init_struct.prescale = SPI_PSC_4;
+    spi_device_init(&display_dev, &spi_init_struct, GPIOB, GPIO_PIN_1);
+
+    spi_bus_init(&spi_bus, SPI0, slots, 8U);
+    spi_bus_dma_config(&spi_bus, 16U);
+    spi_callbacks = 0U;
+    spi_irq_ticks = 0U;
+
+    /* a flash read: the polled command keeps the chip select low for the DMA data phase */
+    spi_xfer_prepare(&xfer[0], &flash_dev, flash_cmd, flash_rx, 4U, SPI_XFER_CS_KEEP, spi_xfer_done);
+    spi_xfer_prepare(&xfer[1], &flash_dev, NULL, &flash_rx[4], 32U, 0U, spi_xfer_done);
+    spi_xfer_prepare(&xfer[2], &adc_dev, adc_cmd, adc_rx, 2U, 0U, spi_xfer_done);
+    spi_xfer_prepare(&xfer[3], &display_dev, pixels, NULL, 40U, 0U, spi_xfer_done);
+    spi_xfer_prepare(&xfer[4], &adc_dev, adc_tx, adc_rx, 20U, 0U, spi_xfer_done);
+    spi_xfer_prepare(&xfer[5], &flash_dev, &flash_status_cmd, &flash_rx[36], 1U, 0U, spi_xfer_done);
+    for(i = 0U; i < 6U; i++){
+        failed |= (SUCCESS != spi_bus_submit(&spi_bus, &xfer[i]));
+    }
+    for(i = 0U; (i < 100000U) && (0U != spi_bus_pending_get(&spi_bus)); i++){
+        host_sim_run(1U);
+    }
+
+    failed |= (6U != spi_callbacks);
+    for(i = 0U; i < 6U; i++){
+        failed |= (SPI_XFER_DONE != xfer[i].status);
+    }
+    /* the flash exchanged the command, then sent on from byte 4 and got 0xFF back */
+    for(i = 0U; i < 36U; i++){
+        failed |= (flash_ref[i] != flash_rx[i]);
+    }
+    for(i = 1U; i < 36U; i++){
+        failed |= (((i < 4U) ? flash_cmd[i] : 0xFFU) != flash[i]);
+    }
+    /* a new selection starts over at byte 0, where the read command was stored */
+    failed |= (0x03U != flash_rx[36]) || (0x05U != flash[0]);
+    /* the second ADC transaction reads back the first one's frames */
+    failed |= (0x1234U != adc_rx[0]) || (0x5678U != adc_rx[1]);
+    for(i = 2U; i < 20U; i++){
+        failed |= ((uint16_t)((adc_ref[2U * i] << 8U) | adc_ref[(2U * i) + 1U]) != adc_rx[i]);
+    }
+    failed |= (0x01U != adc[0]) || (0x13U != adc[39]);
+    failed |= (0 != memcmp(display, pixels, sizeof(pixels)));
+    failed |= (0U != host_sim_spi_slave_errors_get(SPI0, GPIOA, GPIO_PIN_4));
+    failed |= (0U != host_sim_spi_slave_errors_get(SPI0, GPIOB, GPIO_PIN_0));
+    failed |= (0U != host_sim_spi_slave_errors_get(SPI0, GPIOB, GPIO_PIN_1));
+    failed |= (GPIO_PIN_4 != (GPIO_OCTL(GPIOA) & GPIO_PIN_4));
+    failed |= ((GPIO_PIN_0 | GPIO_PIN_1) != (GPIO_OCTL(GPIOB) & (GPIO_PIN_0 | GPIO_PIN_1)));
+    /* the short ADC and status transactions are chained onto the DMA, not polled in the interrupt */
+    failed |= (spi_irq_ticks > 32U);
+    printf("%-28s %6u transactions %u ticks longest interrupt %s\n", "spi_bus", 6U, (unsigned)spi_irq_ticks,
+           (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      program, erase and read a simulated SPI NOR flash
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int spi_nor_check(void)
+{
+    static uint8_t flash[0x20000];
+    static uint8_t data[600];
+    static uint8_t readback[0x1000];
+    static uint8_t cache[SPI_NOR_CACHE_LINES * 256U];
+    static spi_xfer_struct *slots[8];
+    static spi_xfer_struct filler[5];
+    spi_parameter_struct spi_init_struct;
+    spi_device_struct flash_dev, other_dev;
+    uint32_t i, services, transactions;
+    int failed = 0;
+
+    memset(flash, 0x00, sizeof(flash));
+    for(i = 0U; i < sizeof(data); i++){
+        data[i] = (uint8_t)((i * 13U) + 1U);
+    }
+    host_sim_spi_nor_attach(SPI0, GPIOA, GPIO_PIN_3, flash, sizeof(flash));
+
+    spi_init_struct.frame_size = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.endian = SPI_ENDIAN_MSB;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE;
+    spi_init_struct.prescale = SPI_PSC_2;
+    spi_device_init(&flash_dev, &spi_init_struct, GPIOA, GPIO_PIN_3);
+    spi_bus_init(&spi_bus, SPI0, slots, 8U);
+    spi_bus_dma_config(&spi_bus, 16U);
+
+    failed |= (SUCCESS != spi_nor_init(&spi_nor, &spi_bus, &flash_dev, cache, 256U));
+    failed |= (0xC84011U != spi_nor.jedec_id) || (sizeof(flash) != spi_nor.capacity);
+
+    /* one 64 KB block and two sectors; the call returns while the flash erases */
+    failed |= (SUCCESS != spi_nor_erase_start(&spi_nor, 0x00000U, 0x12000U));
+    failed |= (SPI_NOR_BUSY != spi_nor_service(&spi_nor));
+    failed |= (ERROR != spi_nor_program_start(&spi_nor, 0U, data, 1U));
+    for(services = 1U; (services < 100000U) && (SPI_NOR_BUSY == spi_nor_service(&spi_nor)); services++){
+        host_sim_run(64U);
+    }
+    failed |= (SPI_NOR_READY != spi_nor_service(&spi_nor));
+    for(i = 0U; i < 0x13000U; i++){
+        failed |= (((i < 0x12000U) ? 0xFFU : 0x00U) != flash[i]);
+    }
+
+    /* 600 bytes from the middle of a page span four page programs, the data goes
+       through the DMA; the status reads are paced by TIMER6 and the interrupts
+       move the program on, so spi_nor_service() only reports the state */
+    host_sim_irq_handler_register(TIMER6_IRQn, spi_nor_timer_irq);
+    rcu_periph_clock_enable(RCU_TIMER6);
+    spi_nor_timer_config(&spi_nor, TIMER6, 100U);
+    transactions = spi_bus.tail;
+    failed |= (SUCCESS != spi_nor_program_start(&spi_nor, 0x1D0U, data, sizeof(data)));
+    for(i = 0U; (i < 100000U) && (SPI_NOR_BUSY == spi_nor_service(&spi_nor)); i++){
+        host_sim_run(64U);
+    }
+    failed |= (SPI_NOR_READY != spi_nor_service(&spi_nor));
+    /* a page program keeps the flash busy for 400 ticks: four status reads at most each */
+    failed |= ((spi_bus.tail - transactions) > (4U * (3U + 5U))) || (0U == host_sim_timer_updates_get(TIMER6));
+    spi_nor_timer_config(&spi_nor, 0U, 0U);
+    host_sim_irq_handler_register(TIMER6_IRQn, NULL);
+    TIMER_DMAINTEN(TIMER6) = 0U;
+    TIMER_CTL0(TIMER6) = 0U;
+    TIMER_PSC(TIMER6) = 0U;
+    TIMER_CAR(TIMER6) = 0U;
+    TIMER_INTF(TIMER6) = 0U;
+    failed |= (0 != memcmp(&flash[0x1D0], data, sizeof(data)));
+    failed |= (0xFFU != flash[0x1CF]) || (0xFFU != flash[0x1D0 + sizeof(data)]);
+
+    /* with five transactions of another device in the queue a page program does not
+       fit, so nothing of it is queued and the flash stays untouched */
+    spi_device_init(&other_dev, &spi_init_struct, 0U, 0U);
+    for(i = 0U; i < 5U; i++){
+        spi_xfer_prepare(&filler[i], &other_dev, NULL, NULL, 32U, 0U, NULL);
+        failed |= (SUCCESS != spi_bus_submit(&spi_bus, &filler[i]));
+    }
+    failed |= (ERROR != spi_nor_program_start(&spi_nor, 0x3000U, data, 16U));
+    failed |= (5U != spi_bus_pending_get(&spi_bus));
+    failed |= (SPI_NOR_ERROR != spi_nor_service(&spi_nor));
+    for(i = 0U; (i < 100000U) && (0U != spi_bus_pending_get(&spi_bus)); i++){
+        host_sim_run(64U);
+    }
+    failed |= (0xFFU != flash[0x3000]);
+
+    /* the simulator only raises interrupts in host_sim_run, so the blocking reads are polled */
+    spi_bus_dma_config(&spi_bus, 0U);
+    /* small sequential reads hit the cache lines, a line costs two transactions
+       whether it is loaded on a miss or fetched ahead */
+    transactions = spi_bus.tail;
+    for(i = 0U; i < sizeof(data); i += 20U){
+        failed |= (SUCCESS != spi_nor_read(&spi_nor, 0x1D0U + i, &readback[i], 20U));
+    }
+    failed |= ((spi_bus.tail - transactions) != (2U * 4U));
+    failed |= (0 != memcmp(readback, data, sizeof(data)));
+    /* a large read goes past the cache straight into the buffer, the line after it is fetched ahead */
+    transactions = spi_bus.tail;
+    failed |= (SUCCESS != spi_nor_read(&spi_nor, 0x1000U, readback, sizeof(readback)));
+    failed |= ((spi_bus.tail - transactions) != 4U);
+    failed |= (0x2000U != spi_nor.cache_addr[spi_nor.cache_last ^ 1U]);
+    for(i = 0U; i < sizeof(readback); i++){
+        failed |= (0xFFU != readback[i]);
+    }
+    /* with the DMA the line after one read to its end is fetched while the
+       caller goes on, and the next read finds it without a transaction */
+    spi_bus_dma_config(&spi_bus, 16U);
+    failed |= (SUCCESS != spi_nor_read(&spi_nor, 0x4F0U, readback, 16U));
+    failed |= (0U == spi_bus_pending_get(&spi_bus));
+    for(i = 0U; (i < 100000U) && (0U != spi_bus_pending_get(&spi_bus)); i++){
+        host_sim_run(64U);
+    }
+    spi_bus_dma_config(&spi_bus, 0U);
+    transactions = spi_bus.tail;
+    failed |= (SUCCESS != spi_nor_read(&spi_nor, 0x500U, readback, 64U));
+    failed |= (spi_bus.tail != transactions) || (0 != memcmp(readback, &flash[0x500], 64U));
+    failed |= (ERROR != spi_nor_read(&spi_nor, sizeof(flash) - 4U, readback, 8U));
+    failed |= (0U != host_sim_spi_slave_errors_get(SPI0, GPIOA, GPIO_PIN_3));
+    printf("%-28s %6u services %s\n", "spi_nor", (unsigned)services, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      TIMER6 interrupt pacing the status reads of the SPI NOR flash
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void spi_nor_timer_irq(void)
+{
+    spi_nor_timer_irq_handler(&spi_nor);
+}
+
+/*!
+    \brief      stream I2S audio through the ping-pong buffers, on time, with a
+                slow producer and in the receive direction
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int i2s_stream_check(void)
+{
+    static uint16_t line[1024];
+    static uint16_t buffer[64];
+    i2s_stream_parameter_struct init_struct;
+    uint32_t frames, gaps, i;
+    int failed = 0;
+
+    for(i = 0U; i < 1024U; i++){
+        line[i] = (uint16_t)(i * 3U);
+    }
+    rcu_periph_clock_enable(RCU_SPI1);
+    rcu_periph_clock_enable(RCU_SPI2);
+    rcu_periph_clock_enable(RCU_DMA0);
+    rcu_periph_clock_enable(RCU_DMA1);
+    host_sim_irq_handler_register(DMA0_Channel4_IRQn, i2s_dma_irq);
+    host_sim_irq_handler_register(DMA1_Channel0_IRQn, i2s_dma_irq);
+
+    init_struct.spi_periph = SPI1;
+    init_struct.mode = I2S_MODE_MASTERTX;
+    init_struct.standard = I2S_STD_PHILLIPS;
+    init_struct.ckpl = I2S_CKPL_LOW;
+    init_struct.audiosample = I2S_AUDIOSAMPLE_48K;
+    init_struct.frameformat = I2S_FRAMEFORMAT_DT16B_CH16B;
+    init_struct.mckout = I2S_MCKOUT_DISABLE;
+    init_struct.buffer = buffer;
+    init_struct.size = 64U;
+    init_struct.callback = i2s_tx_fill;
+    init_struct.user_data = NULL;
+
+    /* every half is refilled while the DMA plays the other one: no gap, no underrun */
+    host_sim_i2s_attach(SPI1, line, 1024U);
+    i2s_next = 0U;
+    i2s_burn = 0U;
+    failed |= (SUCCESS != i2s_stream_init(&i2s_stream, &init_struct));
+    i2s_stream_start(&i2s_stream);
+    for(i = 0U; (i < 100000U) && (host_sim_i2s_frames_get(SPI1, NULL) < 900U); i++){
+        host_sim_run(16U);
+    }
+    i2s_stream_stop(&i2s_stream);
+    frames = host_sim_i2s_frames_get(SPI1, &gaps);
+    failed |= (0U != gaps) || (0U != i2s_stream.underrun) || (I2S_STREAM_IDLE != i2s_stream.state);
+    failed |= ((i2s_stream.halves * 32U) < frames);
+    for(i = 0U; i < frames; i++){
+        failed |= ((uint16_t)i != line[i]);
+    }
+
+    /* a producer slower than a half: the clock keeps running and the late halves are counted */
+    host_sim_i2s_attach(SPI1, line, 1024U);
+    i2s_burn = 300U;
+    failed |= (SUCCESS != i2s_stream_init(&i2s_stream, &init_struct));
+    i2s_stream_start(&i2s_stream);
+    for(i = 0U; (i < 100000U) && (host_sim_i2s_frames_get(SPI1, NULL) < 600U); i++){
+        host_sim_run(16U);
+    }
+    i2s_stream_stop(&i2s_stream);
+    (void)host_sim_i2s_frames_get(SPI1, &gaps);
+    failed |= (0U != gaps) || (0U == i2s_stream.underrun);
+
+    /* receive on SPI2: every word reaches the consumer once and in order */
+    for(i = 0U; i < 1024U; i++){
+        line[i] = (uint16_t)(i * 3U);
+    }
+    host_sim_i2s_attach(SPI2, line, 1024U);
+    i2s_next = 0U;
+    i2s_errors = 0U;
+    init_struct.spi_periph = SPI2;
+    init_struct.mode = I2S_MODE_MASTERRX;
+    init_struct.callback = i2s_rx_take;
+    failed |= (SUCCESS != i2s_stream_init(&i2s_stream, &init_struct));
+    i2s_stream_start(&i2s_stream);
+    for(i = 0U; (i < 100000U) && (host_sim_i2s_frames_get(SPI2, NULL) < 900U); i++){
+        host_sim_run(16U);
+    }
+    i2s_stream_stop(&i2s_stream);
+    (void)host_sim_i2s_frames_get(SPI2, &gaps);
+    failed |= (0U != gaps) || (0U != i2s_stream.overrun) || (0U != i2s_errors) || (i2s_next < 800U);
+
+    init_struct.spi_periph = SPI0;
+    failed |= (ERROR != i2s_stream_init(&i2s_stream, &init_struct));
+    printf("%-28s %6u frames %s\n", "i2s_stream", (unsigned)frames, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      transmit callback of the I2S stream, sends a counter
+    \param[in]  stream: I2S stream
+    \param[in]  len: number of words to fill
+    \param[out] data: half to fill
+    \retval     number of words filled
+*/
+static uint32_t i2s_tx_fill(i2s_stream_struct *stream, uint16_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    /* a slow producer, every register access is one bus tick */
+    for(i = 0U; i < i2s_burn; i++){
+        (void)SPI_STAT(stream->spi_periph);
+    }
+    for(i = 0U; i < len; i++){
+        data[i] = i2s_next++;
+    }
+    return len;
+}
+
+/*!
+    \brief      receive callback of the I2S stream, checks the words against the line
+    \param[in]  stream: I2S stream
+    \param[in]  data: received half
+    \param[in]  len: number of words
+    \param[out] none
+    \retval     number of words taken
+*/
+static uint32_t i2s_rx_take(i2s_stream_struct *stream, uint16_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    (void)stream;
+    for(i = 0U; i < len; i++){
+        if((uint16_t)(i2s_next * 3U) != data[i]){
+            i2s_errors++;
+        }
+        i2s_next++;
+    }
+    return len;
+}
+
+/*!
+    \brief      DMA0 channel 4 and DMA1 channel 0 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void i2s_dma_irq(void)
+{
+    i2s_stream_dma_irq_handler(&i2s_stream);
+}
+
+/*!
+    \brief      acquire an 8 channel scan group through the ping-pong frames,
+                timer triggered, with a slow consumer and back to back
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int adc_stream_check(void)
+{
+    static const uint8_t channels[8] = {
+        ADC_CHANNEL_3, ADC_CHANNEL_0, ADC_CHANNEL_7, ADC_CHANNEL_1,
+        ADC_CHANNEL_6, ADC_CHANNEL_2, ADC_CHANNEL_5, ADC_CHANNEL_4
+    };
+    static uint16_t buffer[2U * 8U * 8U];
+    adc_stream_parameter_struct init_struct;
+    uint32_t conversions, lost, phase, i;
+    int failed = 0;
+
+    rcu_periph_clock_enable(RCU_ADC0);
+    rcu_periph_clock_enable(RCU_DMA0);
+    host_sim_irq_handler_register(DMA0_Channel0_IRQn, adc_dma_irq);
+
+    init_struct.adc_periph = ADC0;
+    init_struct.mode = ADC_MODE_FREE;
+    init_struct.channels = channels;
+    init_struct.channels1 = NULL;
+    init_struct.channel_num = 8U;
+    init_struct.sample_time = ADC_SAMPLETIME_13POINT5;
+    init_struct.buffer = buffer;
+    init_struct.scans = 8U;
+    init_struct.callback = adc_frame_take;
+    init_struct.user_data = NULL;
+
+    /* a scan every 200 ticks, then a consumer once slower than a frame, then back to back scans */
+    for(phase = 0U; phase < 3U; phase++){
+        for(i = 0U; i < 8U; i++){
+            adc_expect[i] = 256U * channels[i];
+            adc_step[i] = channels[i] + 1U;
+            host_sim_adc_input_set(channels[i], adc_expect[i], adc_step[i]);
+        }
+        adc_errors = 0U;
+        adc_burn = (1U == phase) ? 2000U : 0U;
+        init_struct.trigger = (2U == phase) ? ADC0_1_EXTTRIG_REGULAR_NONE : ADC0_1_EXTTRIG_REGULAR_T1_CH1;
+        host_sim_adc_trigger_period_config(ADC0, 200U);
+        (void)host_sim_adc_conversions_get(ADC0, &lost);
+
+        failed |= (SUCCESS != adc_stream_init(&adc_stream, &init_struct));
+        adc_stream_start(&adc_stream);
+        for(i = 0U; (i < 100000U) && (adc_stream.frames < 20U); i++){
+            host_sim_run(16U);
+        }
+        adc_stream_stop(&adc_stream);
+        conversions = host_sim_adc_conversions_get(ADC0, &i);
+        lost = i - lost;
+
+        failed |= (20U != adc_stream.frames) || (ADC_STREAM_IDLE != adc_stream.state) || (0U != lost);
+        if(1U == phase){
+            failed |= (0U == adc_stream.overrun);
+        }else{
+            failed |= (0U != adc_stream.overrun) || (0U != adc_errors);
+        }
+    }
+
+    init_struct.channel_num = 17U;
+    failed |= (ERROR != adc_stream_init(&adc_stream, &init_struct));
+    printf("%-28s %6u conversions %s\n", "adc_stream", (unsigned)conversions, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      ADC stream callback, checks each channel against its simulated input
+    \param[in]  stream: ADC stream
+    \param[in]  frame: interleaved samples
+    \param[in]  scans: number of scans in the frame
+    \param[out] none
+    \retval     none
+*/
+static void adc_frame_take(adc_stream_struct *stream, const uint16_t *frame, uint32_t scans)
+{
+    uint16_t samples[8];
+    uint32_t channel, i;
+
+    /* one slow call, every register access is one bus tick */
+    for(i = 0U; i < adc_burn; i++){
+        (void)DMA_INTF(DMA0);
+    }
+    adc_burn = 0U;
+    for(channel = 0U; channel < stream->scan_size; channel++){
+        adc_stream_channel_get(stream, frame, channel, samples);
+        for(i = 0U; i < scans; i++){
+            if((adc_expect[channel] & 0x0FFFU) != samples[i]){
+                adc_errors++;
+            }
+            adc_expect[channel] += adc_step[channel];
+        }
+    }
+}
+
+/*!
+    \brief      run the ADC stream with ADC0 alone and with both ADCs in the
+                regular sync modes, check the samples and the sample rate
+                back to back; follow-up fast must about double the rate of
+                one ADC on a single channel
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int adc_dual_check(void)
+{
+    static const uint8_t channels[4] = {ADC_CHANNEL_0, ADC_CHANNEL_1, ADC_CHANNEL_2, ADC_CHANNEL_3};
+    static const uint8_t channels1[4] = {ADC_CHANNEL_4, ADC_CHANNEL_5, ADC_CHANNEL_6, ADC_CHANNEL_7};
+    static const uint32_t mode[4] = {
+        ADC_MODE_FREE, ADC_DAUL_REGULAL_FOLLOWUP_FAST, ADC_DAUL_REGULAL_FOLLOWUP_SLOW, ADC_DAUL_REGULAL_PARALLEL
+    };
+    static const char *const name[4] = {"adc_dual free", "adc_dual follow-up fast", "adc_dual follow-up slow",
+                                        "adc_dual regular parallel"};
+    static uint32_t buffer[2U * 8U * 8U];
+    adc_stream_parameter_struct init_struct;
+    uint32_t rate[4];
+    uint32_t lost, phase, i;
+    uint64_t start;
+    int failed = 0;
+
+    rcu_periph_clock_enable(RCU_ADC0);
+    rcu_periph_clock_enable(RCU_ADC1);
+    rcu_periph_clock_enable(RCU_DMA0);
+    host_sim_irq_handler_register(DMA0_Channel0_IRQn, adc_dma_irq);
+
+    init_struct.adc_periph = ADC0;
+    init_struct.channels = channels;
+    init_struct.channels1 = channels1;
+    init_struct.sample_time = ADC_SAMPLETIME_1POINT5;
+    init_struct.buffer = (uint16_t *)buffer;
+    init_struct.scans = 8U;
+    init_struct.user_data = NULL;
+
+    /* ADC0 alone on one channel, then the pair on the same channel, then the pair on eight channels */
+    for(phase = 0U; phase < 4U; phase++){
+        init_struct.mode = mode[phase];
+        init_struct.channel_num = (3U == phase) ? 4U : 1U;
+        init_struct.trigger = (2U == phase) ? ADC0_1_EXTTRIG_REGULAR_T1_CH1 : ADC0_1_EXTTRIG_REGULAR_NONE;
+        init_struct.callback = ((1U == phase) || (2U == phase)) ? adc_interleaved_take : adc_frame_take;
+        for(i = 0U; i < 4U; i++){
+            adc_expect[2U * i] = 100U * (i + 1U);
+            adc_expect[(2U * i) + 1U] = 100U * (i + 5U);
+            adc_step[2U * i] = 1U;
+            adc_step[(2U * i) + 1U] = 1U;
+            host_sim_adc_input_set(channels[i], adc_expect[2U * i], 1U);
+            host_sim_adc_input_set(channels1[i], adc_expect[(2U * i) + 1U], 1U);
+        }
+        adc_errors = 0U;
+        adc_burn = 0U;
+        host_sim_adc_trigger_period_config(ADC0, 100U);
+        (void)host_sim_adc_conversions_get(ADC0, &lost);
+
+        failed |= (SUCCESS != adc_stream_init(&adc_stream, &init_struct));
+        start = host_sim_time_get();
+        adc_stream_start(&adc_stream);
+        for(i = 0U; (i < 100000U) && (adc_stream.frames < 20U); i++){
+            host_sim_run(16U);
+        }
+        rate[phase] = (uint32_t)((1000U * 20U * adc_stream.scans * adc_stream.scan_size) / (host_sim_time_get() - start));
+        adc_stream_stop(&adc_stream);
+        (void)host_sim_adc_conversions_get(ADC0, &i);
+
+        failed |= (20U != adc_stream.frames) || (0U != adc_stream.overrun) || (0U != adc_errors) || (lost != i);
+        printf("%-28s %6u samples per 1000 ticks\n", name[phase], (unsigned)rate[phase]);
+    }
+    /* follow-up fast doubles a single channel, regular parallel doubles the scan */
+    failed |= ((10U * rate[1]) < (19U * rate[0])) || ((10U * rate[3]) < (19U * rate[0]));
+
+    /* follow-up modes take one channel, slow mode needs a trigger */
+    init_struct.mode = ADC_DAUL_REGULAL_FOLLOWUP_FAST;
+    failed |= (ERROR != adc_stream_init(&adc_stream, &init_struct));
+    init_struct.mode = ADC_DAUL_REGULAL_FOLLOWUP_SLOW;
+    init_struct.channel_num = 1U;
+    init_struct.trigger = ADC0_1_EXTTRIG_REGULAR_NONE;
+    failed |= (ERROR != adc_stream_init(&adc_stream, &init_struct));
+    printf("%-28s %6u%% of one ADC %s\n", "adc_dual follow-up fast", (unsigned)((100U * rate[1]) / rate[0]),
+           (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      ADC stream callback of the follow-up modes, both ADCs convert the
+                same input in turn, so the samples in conversion order follow
+                the input step by step
+    \param[in]  stream: ADC stream
+    \param[in]  frame: interleaved samples
+    \param[in]  scans: number of scans in the frame
+    \param[out] none
+    \retval     none
+*/
+static void adc_interleaved_take(adc_stream_struct *stream, const uint16_t *frame, uint32_t scans)
+{
+    uint16_t samples[16];
+    uint32_t i;
+
+    adc_stream_interleaved_get(stream, frame, samples);
+    for(i = 0U; i < (2U * scans); i++){
+        if((adc_expect[0] & 0x0FFFU) != samples[i]){
+            adc_errors++;
+        }
+        adc_expect[0]++;
+    }
+}
+
+/*!
+    \brief      DMA0 channel 0 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void adc_dma_irq(void)
+{
+    adc_stream_dma_irq_handler(&adc_stream);
+}
+
+/*!
+    \brief      SPI transaction callback
+    \param[in]  xfer: finished transaction
+    \param[out] none
+    \retval     none
+*/
+static void spi_xfer_done(spi_xfer_struct *xfer)
+{
+    (void)xfer;
+    spi_callbacks++;
+}
+
+/*!
+    \brief      DMA0 channel 1 and 2 interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void spi0_dma_irq(void)
+{
+    uint64_t start = host_sim_time_get();
+    uint64_t ticks;
+
+    spi_bus_dma_irq_handler(&spi_bus);
+    ticks = host_sim_time_get() - start;
+    if(ticks > spi_irq_ticks){
+        spi_irq_ticks = ticks;
+    }
+}
+
+/*!
+    \brief      compare the fixed-point DSP kernels with double precision
+                references fed the same quantized coefficients and inputs,
+                each filter run in two blocks to carry its state over
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int dsp_check(void)
+{
+    static q15_t x15[DSP_CHECK_LEN], y15[DSP_CHECK_LEN], h15[DSP_CHECK_TAPS], s15[2U * DSP_CHECK_TAPS];
+    static q31_t x31[DSP_CHECK_LEN], y31[DSP_CHECK_LEN], h31[DSP_CHECK_TAPS], s31[2U * DSP_CHECK_TAPS];
+    static q15_t c15[2U * DSP_BIQUAD_COEFF_NUM], bs15[2U * DSP_BIQUAD_STATE_NUM];
+    static q31_t c31[2U * DSP_BIQUAD_COEFF_NUM], bs31[2U * DSP_BIQUAD_STATE_NUM];
+    static q15_t fft[2U * 256U], window[10];
+    static uint16_t adc[2U * 16U];
+    static double ref[DSP_CHECK_LEN], tmp[DSP_CHECK_LEN];
+    static const char *const name[DSP_CHECK_KERNELS] = {
+        "dsp_fir_q15", "dsp_fir_q31", "dsp_biquad_q15", "dsp_biquad_q31",
+        "dsp_moving_average_q15", "dsp_cic_q15", "dsp_rms_q15", "dsp_fft_q15"
+    };
+    /* largest error allowed, in LSB of the output */
+    static const double limit[DSP_CHECK_KERNELS] = {1.0, 1.0, 4.0, 4.0, 1.0, 1.0, 1.0, 8.0};
+    dsp_fir_q15_struct fir15;
+    dsp_fir_q31_struct fir31;
+    dsp_biquad_q15_struct biquad15;
+    dsp_biquad_q31_struct biquad31;
+    dsp_moving_average_q15_struct average;
+    dsp_cic_q15_struct cic;
+    double coeff[2U * DSP_BIQUAD_COEFF_NUM];
+    double acc, w, k, norm, err[DSP_CHECK_KERNELS];
+    uint32_t seed = 12345U;
+    uint32_t i, j, n, stage;
+    int failed = 0;
+
+    for(i = 0U; i < DSP_CHECK_KERNELS; i++){
+        err[i] = 0.0;
+    }
+    /* half scale noise */
+    for(i = 0U; i < DSP_CHECK_LEN; i++){
+        seed = (seed * 1103515245U) + 12345U;
+        x31[i] = (q31_t)seed >> 1;
+        x15[i] = (q15_t)(x31[i] >> 16);
+    }
+
+    /* FIR: windowed sinc low pass at fs / 8 */
+    for(i = 0U; i < DSP_CHECK_TAPS; i++){
+        k = (double)i - ((DSP_CHECK_TAPS - 1U) / 2.0);
+        w = 0.54 - (0.46 * cos((2.0 * M_PI * i) / (DSP_CHECK_TAPS - 1U)));
+        acc = (0.0 == k) ? 0.25 : (sin(0.25 * M_PI * k) / (M_PI * k));
+        h15[i] = (q15_t)lround(acc * w * 32768.0);
+        h31[i] = (q31_t)llround(acc * w * 2147483648.0);
+    }
+    dsp_fir_q15_init(&fir15, h15, s15, DSP_CHECK_TAPS);
+    dsp_fir_q15(&fir15, x15, y15, 100U);
+    dsp_fir_q15(&fir15, &x15[100], &y15[100], DSP_CHECK_LEN - 100U);
+    dsp_fir_q31_init(&fir31, h31, s31, DSP_CHECK_TAPS);
+    dsp_fir_q31(&fir31, x31, y31, 100U);
+    dsp_fir_q31(&fir31, &x31[100], &y31[100], DSP_CHECK_LEN - 100U);
+    for(n = 0U; n < DSP_CHECK_LEN; n++){
+        acc = 0.0;
+        w = 0.0;
+        for(i = 0U; (i < DSP_CHECK_TAPS) && (i <= n); i++){
+            acc += (double)h15[i] * x15[n - i];
+            w += (double)h31[i] * x31[n - i];
+        }
+        dsp_error_update(&err[0], acc / 32768.0, y15[n]);
+        dsp_error_update(&err[1], w / 2147483648.0, y31[n]);
+    }
+
+    /* IIR: two second order sections of a Butterworth low pass at fs / 10 */
+    k = tan(M_PI / 10.0);
+    for(stage = 0U; stage < 2U; stage++){
+        w = 2.0 * cos((M_PI * ((2.0 * stage) + 1.0)) / 8.0);
+        norm = 1.0 / (1.0 + (w * k) + (k * k));
+        coeff[(5U * stage) + 0U] = k * k * norm;
+        coeff[(5U * stage) + 1U] = 2.0 * k * k * norm;
+        coeff[(5U * stage) + 2U] = k * k * norm;
+        coeff[(5U * stage) + 3U] = 2.0 * ((k * k) - 1.0) * norm;
+        coeff[(5U * stage) + 4U] = (1.0 - (w * k) + (k * k)) * norm;
+    }
+    for(i = 0U; i < (2U * DSP_BIQUAD_COEFF_NUM); i++){
+        c15[i] = (q15_t)lround(coeff[i] * 16384.0);
+        c31[i] = (q31_t)llround(coeff[i] * 1073741824.0);
+    }
+    failed |= (SUCCESS != dsp_biquad_q15_init(&biquad15, c15, bs15, 2U, 1U));
+    dsp_biquad_q15(&biquad15, x15, y15, 100U);
+    dsp_biquad_q15(&biquad15, &x15[100], &y15[100], DSP_CHECK_LEN - 100U);
+    failed |= (SUCCESS != dsp_biquad_q31_init(&biquad31, c31, bs31, 2U, 1U));
+    dsp_biquad_q31(&biquad31, x31, y31, 100U);
+    dsp_biquad_q31(&biquad31, &x31[100], &y31[100], DSP_CHECK_LEN - 100U);
+    for(j = 0U; j < 2U; j++){
+        for(n = 0U; n < DSP_CHECK_LEN; n++){
+            ref[n] = (0U == j) ? (x15[n] / 32768.0) : (x31[n] / 2147483648.0);
+        }
+        for(stage = 0U; stage < 2U; stage++){
+            for(n = 0U; n < DSP_CHECK_LEN; n++){
+                for(i = 0U; i < DSP_BIQUAD_COEFF_NUM; i++){
+                    coeff[i] = (0U == j) ? (c15[(5U * stage) + i] / 16384.0) : (c31[(5U * stage) + i] / 1073741824.0);
+                }
+                tmp[n] = coeff[0] * ref[n];
+                if(n >= 1U){
+                    tmp[n] += (coeff[1] * ref[n - 1U]) - (coeff[3] * tmp[n - 1U]);
+                }
+                if(n >= 2U){
+                    tmp[n] += (coeff[2] * ref[n - 2U]) - (coeff[4] * tmp[n - 2U]);
+                }
+            }
+            for(n = 0U; n < DSP_CHECK_LEN; n++){
+                ref[n] = tmp[n];
+            }
+        }
+        for(n = 0U; n < DSP_CHECK_LEN; n++){
+            if(0U == j){
+                dsp_error_update(&err[2], ref[n] * 32768.0, y15[n]);
+            }else{
+                dsp_error_update(&err[3], ref[n] * 2147483648.0, y31[n]);
+            }
+        }
+    }
+
+    /* moving average over 10 samples and a third order CIC decimating by 8 */
+    failed |= (SUCCESS != dsp_moving_average_q15_init(&average, window, 10U));
+    dsp_moving_average_q15(&average, x15, y15, 100U);
+    dsp_moving_average_q15(&average, &x15[100], &y15[100], DSP_CHECK_LEN - 100U);
+    for(n = 0U; n < DSP_CHECK_LEN; n++){
+        acc = 0.0;
+        for(i = 0U; (i < 10U) && (i <= n); i++){
+            acc += x15[n - i];
+        }
+        dsp_error_update(&err[4], acc / 10.0, y15[n]);
+    }
+    failed |= (SUCCESS != dsp_cic_q15_init(&cic, 3U, 8U));
+    j = dsp_cic_q15(&cic, x15, y15, 100U);
+    j += dsp_cic_q15(&cic, &x15[100], &y15[j], DSP_CHECK_LEN - 100U);
+    failed |= ((DSP_CHECK_LEN / 8U) != j);
+    for(n = 0U; n < DSP_CHECK_LEN; n++){
+        ref[n] = x15[n];
+    }
+    for(stage = 0U; stage < 3U; stage++){
+        for(n = DSP_CHECK_LEN; n > 0U; n--){
+            acc = 0.0;
+            for(i = 0U; (i < 8U) && (i < n); i++){
+                acc += ref[n - 1U - i];
+            }
+            ref[n - 1U] = acc;
+        }
+    }
+    for(n = 0U; n < j; n++){
+        dsp_error_update(&err[5], ref[(8U * n) + 7U] / 512.0, y15[n]);
+    }
+
+    /* RMS of the noise */
+    acc = 0.0;
+    for(n = 0U; n < DSP_CHECK_LEN; n++){
+        acc += (double)x15[n] * x15[n];
+    }
+    dsp_error_update(&err[6], sqrt(acc / DSP_CHECK_LEN), dsp_rms_q15(x15, DSP_CHECK_LEN));
+
+    /* 256 point FFT of two tones with noise on the imaginary part, against a DFT scaled by 1/n */
+    for(n = 0U; n < 256U; n++){
+        w = (0.5 * sin((2.0 * M_PI * 10.0 * n) / 256.0)) + (0.25 * cos((2.0 * M_PI * 37.5 * n) / 256.0));
+        fft[2U * n] = (q15_t)lround(w * 32768.0);
+        fft[(2U * n) + 1U] = (q15_t)(x15[n] / 8);
+        ref[n] = fft[2U * n];
+        tmp[n] = fft[(2U * n) + 1U];
+    }
+    failed |= (SUCCESS != dsp_fft_q15(fft, 256U));
+    for(i = 0U; i < 256U; i++){
+        acc = 0.0;
+        norm = 0.0;
+        for(n = 0U; n < 256U; n++){
+            w = (2.0 * M_PI * (double)((i * n) % 256U)) / 256.0;
+            acc += (ref[n] * cos(w)) + (tmp[n] * sin(w));
+            norm += (tmp[n] * cos(w)) - (ref[n] * sin(w));
+        }
+        dsp_error_update(&err[7], acc / 256.0, fft[2U * i]);
+        dsp_error_update(&err[7], norm / 256.0, fft[(2U * i) + 1U]);
+    }
+
+    /* one channel out of an interleaved ADC frame */
+    for(i = 0U; i < (2U * 16U); i++){
+        adc[i] = (uint16_t)((i * 131U) & 0x0FFFU);
+    }
+    dsp_q15_from_adc(&adc[1], 2U, y15, 16U);
+    for(i = 0U; i < 16U; i++){
+        failed |= (y15[i] != (q15_t)(((int32_t)adc[(2U * i) + 1U] - 2048) * 16));
+    }
+
+    failed |= (ERROR != dsp_cic_q15_init(&cic, 4U, 32U)) || (ERROR != dsp_cic_q15_init(&cic, 2U, 6U));
+    failed |= (ERROR != dsp_fft_q15(fft, 3U)) || (ERROR != dsp_fft_q15(fft, 2048U));
+    failed |= (ERROR != dsp_biquad_q15_init(&biquad15, c15, bs15, 2U, 3U));
+    failed |= (ERROR != dsp_moving_average_q15_init(&average, window, 1U));
+
+    for(i = 0U; i < DSP_CHECK_KERNELS; i++){
+        printf("%-28s %6.2f lsb max error\n", name[i], err[i]);
+        failed |= (err[i] > limit[i]);
+    }
+    printf("%-28s %6u kernels %s\n", "dsp", (unsigned)DSP_CHECK_KERNELS, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      track the largest distance between a reference and a result
+    \param[in]  err: largest distance so far
+    \param[in]  ref: reference in LSB of the result
+    \param[in]  result: fixed-point result
+    \param[out] err: updated largest distance
+    \retval     none
+*/
+static void dsp_error_update(double *err, double ref, double result)
+{
+    double d = fabs(ref - result);
+
+    if(d > *err){
+        *err = d;
+    }
+}
+
+/*!
+    \brief      play a looped table on DAC0 and stream pairs in concurrent mode
+    \param[in]  none
+    \param[out] none
+    \retval     0 on success
+*/
+static int dac_stream_check(void)
+{
+    static uint16_t table[16];
+    static uint16_t buffer[64];
+    static uint16_t capture0[1024];
+    static uint16_t capture1[1024];
+    dac_stream_parameter_struct init_struct;
+    uint32_t outputs, stale, i;
+    int failed = 0;
+
+    for(i = 0U; i < 16U; i++){
+        table[i] = (uint16_t)(i * 273U);
+    }
+    rcu_periph_clock_enable(RCU_DAC);
+    rcu_periph_clock_enable(RCU_TIMER5);
+    rcu_periph_clock_enable(RCU_TIMER6);
+    rcu_periph_clock_enable(RCU_DMA1);
+    host_sim_irq_handler_register(DMA1_Channel2_IRQn, dac_dma_irq);
+    host_sim_irq_handler_register(DMA1_Channel3_IRQn, dac_dma_irq);
+
+    /* the host runs the timers from IRC8M, the prescaler takes over when the period does not fit the 16-bit counter */
+    init_struct.output = DAC_STREAM_OUTPUT_DAC0;
+    init_struct.timer_periph = TIMER5;
+    init_struct.sample_rate = 100U;
+    init_struct.buffer = table;
+    init_struct.size = 16U;
+    init_struct.callback = NULL;
+    init_struct.user_data = NULL;
+    failed |= (SUCCESS != dac_stream_init(&dac_stream, &init_struct));
+    failed |= (100U != dac_stream.sample_rate) || (1U != TIMER_PSC(TIMER5)) || (39999U != TIMER_CAR(TIMER5));
+
+    /* a looped table: one level per timer period, the preloaded last point first */
+    host_sim_dac_attach(DAC0, capture0, 1024U);
+    init_struct.sample_rate = 250000U;
+    failed |= (SUCCESS != dac_stream_init(&dac_stream, &init_struct));
+    failed |= (250000U != dac_stream.sample_rate);
+    dac_stream_start(&dac_stream);
+    host_sim_run(32U * 200U);
+    dac_stream_stop(&dac_stream);
+    outputs = host_sim_dac_outputs_get(DAC0, &stale);
+    failed |= (0U != stale) || (DAC_STREAM_IDLE != dac_stream.state) || (0U != dac_stream.halves);
+    failed |= (outputs < 199U) || (outputs > 201U) || (outputs != host_sim_timer_updates_get(TIMER5) - 2U);
+    for(i = 0U; i < outputs; i++){
+        failed |= (table[(i + 15U) % 16U] != capture0[i]);
+    }
+
+    /* concurrent pairs refilled half by half, both DACs change on the same trigger */
+    host_sim_dac_attach(DAC0, capture0, 1024U);
+    host_sim_dac_attach(DAC1, capture1, 1024U);
+    dac_next = 0U;
+    dac_burn = 0U;
+    init_struct.output = DAC_STREAM_OUTPUT_CONCURRENT;
+    init_struct.timer_periph = TIMER6;
+    init_struct.buffer = buffer;
+    init_struct.size = 64U;
+    init_struct.callback = dac_fill;
+    failed |= (SUCCESS != dac_stream_init(&dac_stream, &init_struct));
+    dac_stream_start(&dac_stream);
+    for(i = 0U; (i < 100000U) && (host_sim_dac_outputs_get(DAC0, NULL) < 900U); i++){
+        host_sim_run(16U);
+    }
+    dac_stream_stop(&dac_stream);
+    outputs = host_sim_dac_outputs_get(DAC0, &stale);
+    failed |= (0U != stale) || (0U != dac_stream.underrun) || (outputs != host_sim_dac_outputs_get(DAC1, NULL));
+    failed |= ((dac_stream.halves * 16U) < outputs);
+    for(i = 0U; i < outputs; i++){
+        failed |= (((0U != i) ? (i - 1U) : 0U) != capture0[i]) || ((0x0FFFU - capture0[i]) != capture1[i]);
+    }
+
+    /* a producer once slower than a half: the output keeps its rate and the late half is counted */
+    failed |= (SUCCESS != dac_stream_init(&dac_stream, &init_struct));
+    dac_stream_start(&dac_stream);
+    dac_burn = 2000U;
+    host_sim_run(32U * 600U);
+    dac_stream_stop(&dac_stream);
+    failed |= (0U == dac_stream.underrun);
+
+    init_struct.size = 62U;
+    failed |= (ERROR != dac_stream_init(&dac_stream, &init_struct));
+    init_struct.size = 64U;
+    init_struct.timer_periph = TIMER1;
+    failed |= (ERROR != dac_stream_init(&dac_stream, &init_struct));
+    printf("%-28s %6u outputs %s\n", "dac_stream", (unsigned)outputs, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      DAC stream callback, DAC0 counts up and DAC1 mirrors it
+    \param[in]  stream: DAC stream
+    \param[in]  len: number of samples to fill, pairs of DAC0 and DAC1
+    \param[out] data: half to fill
+    \retval     number of samples filled
+*/
+static uint32_t dac_fill(dac_stream_struct *stream, uint16_t *data, uint32_t len)
+{
+    uint32_t i;
+
+    /* a slow producer for one half, every register access is one bus tick */
+    for(i = 0U; i < dac_burn; i++){
+        (void)DAC_CTL;
+    }
+    dac_burn = 0U;
+    (void)stream;
+    for(i = 0U; i < len; i += 2U){
+        data[i] = dac_next & 0x0FFFU;
+        data[i + 1U] = 0x0FFFU - data[i];
+        dac_next++;
+    }
+    return len;
+}
+
+/*!
+    \brief      DMA interrupt handler of the DAC stream
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void dac_dma_irq(void)
+{
+    dac_stream_dma_irq_handler(&dac_stream);
+}
+
+/*!
+    \brief      compile, load and read back CAN filter plans: one that fits and
+                stays exact, and one that has to merge to fit the 28 banks
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int can_filter_check(void)
+{
+    static const can_filter_id_struct light[] = {
+        {CAN0, CAN_FF_STANDARD, 0x100U, 0x10FU, CAN_FIFO0},
+        {CAN0, CAN_FF_STANDARD, 0x123U, 0x123U, CAN_FIFO0},
+        {CAN0, CAN_FF_STANDARD, 0x200U, 0x201U, CAN_FIFO1},
+        {CAN0, CAN_FF_STANDARD, 0x7FFU, 0x7FFU, CAN_FIFO1},
+        {CAN0, CAN_FF_EXTENDED, 0x18FF0000U, 0x18FF00FFU, CAN_FIFO0},
+        {CAN0, CAN_FF_EXTENDED, 0x01234567U, 0x01234567U, CAN_FIFO1},
+        {CAN1, CAN_FF_STANDARD, 0x300U, 0x37FU, CAN_FIFO0},
+        {CAN1, CAN_FF_STANDARD, 0x555U, 0x555U, CAN_FIFO1},
+        {CAN1, CAN_FF_EXTENDED, 0x0CF00400U, 0x0CF00400U, CAN_FIFO0},
+    };
+    static can_filter_id_struct heavy[120];
+    static can_filter_plan_struct plan;
+    can_filter_report_struct report;
+    can_filter_id_struct bad;
+    uint32_t fp, i;
+    int failed = 0;
+
+    rcu_periph_clock_enable(RCU_CAN0);
+    rcu_periph_clock_enable(RCU_CAN1);
+
+    /* few identifiers: nothing is merged and nothing else passes */
+    failed |= (SUCCESS != can_filter_compile(&plan, light, sizeof(light) / sizeof(light[0])));
+    can_filter_apply(&plan);
+    failed |= can_filter_plan_check(&plan, light, sizeof(light) / sizeof(light[0]));
+    can_filter_report(&plan, &report);
+    failed |= (0U != report.false_positive[0][0]) || (0U != report.false_positive[0][1]) ||
+              (0U != report.false_positive[1][0]) || (0U != report.false_positive[1][1]);
+    failed |= (20U != report.requested[0][0]) || (257U != report.requested[0][1]) || (129U != report.requested[1][0]);
+
+    /* scattered identifiers that need about twice the banks */
+    for(i = 0U; i < 120U; i++){
+        heavy[i].can_periph = (i < 60U) ? CAN0 : CAN1;
+        heavy[i].ff = (20U > (i % 60U)) ? CAN_FF_EXTENDED : CAN_FF_STANDARD;
+        heavy[i].first = (CAN_FF_EXTENDED == heavy[i].ff) ? (0x10000000U + (i * 0x00012345U)) :
+                                                            ((i * 0x2B3U + 0x11U) & 0x7FFU);
+        heavy[i].last = heavy[i].first;
+        heavy[i].fifo = (uint8_t)(i & 1U);
+    }
+    failed |= (SUCCESS != can_filter_compile(&plan, heavy, 120U));
+    failed |= (CAN_FILTER_BANK_NUM < (plan.can1_start_bank + plan.bank_num[1]));
+    can_filter_apply(&plan);
+    failed |= can_filter_plan_check(&plan, heavy, 120U);
+    can_filter_report(&plan, &report);
+    /* each CAN needs 10 banks for its 20 exact extended identifiers and 10 for its standard
+       ones: the 8 banks left for the standard identifiers are split evenly and no extended
+       pattern is opened; with 3 banks more CAN0 would let through 740 and CAN1 1636 */
+    fp = report.false_positive[0][0] + report.false_positive[0][1] + report.false_positive[1][0] +
+         report.false_positive[1][1];
+    failed |= (14U != plan.can1_start_bank) || (14U != plan.bank_num[1]);
+    failed |= (0U != report.false_positive[0][1]) || (0U != report.false_positive[1][1]);
+    failed |= (928U != report.false_positive[0][0]) || (1314U != report.false_positive[1][0]) || (2242U != fp);
+    for(i = 0U; i < 4U; i++){
+        printf("%-28s CAN%u %s %4u requested %9u accepted\n", (0U == i) ? "can_filter" : "", (unsigned)(i >> 1),
+               (0U != (i & 1U)) ? "ext" : "std", (unsigned)report.requested[i >> 1][i & 1U],
+               (unsigned)report.accepted[i >> 1][i & 1U]);
+    }
+
+    bad = light[0];
+    bad.last = 0x800U;
+    failed |= (ERROR != can_filter_compile(&plan, &bad, 1U));
+    bad.first = 0x10U;
+    bad.last = 0x0FU;
+    failed |= (ERROR != can_filter_compile(&plan, &bad, 1U));
+    printf("%-28s %6u banks %s\n", "can_filter", (unsigned)(plan.bank_num[0] + plan.bank_num[1]),
+           (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      check a loaded plan: every requested identifier reaches its
+                FIFO, and the standard identifiers let through are the ones
+                the report counts
+    \param[in]  plan: compiled plan
+    \param[in]  ids: identifiers it was compiled from
+    \param[in]  num: number of entries in ids
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int can_filter_plan_check(const can_filter_plan_struct *plan, const can_filter_id_struct *ids, uint32_t num)
+{
+    can_filter_report_struct report;
+    uint32_t regs[5U + (2U * CAN_FILTER_BANK_NUM)];
+    uint32_t can, accepted, id, i;
+    int failed = 0;
+
+    /* a snapshot of the filter registers, read once through the bus */
+    regs[0] = CAN_FCTL(CAN0);
+    regs[1] = CAN_FMCFG(CAN0);
+    regs[2] = CAN_FSCFG(CAN0);
+    regs[3] = CAN_FAFIFO(CAN0);
+    regs[4] = CAN_FW(CAN0);
+    for(i = 0U; i < CAN_FILTER_BANK_NUM; i++){
+        regs[5U + (2U * i)] = CAN_FDATA0(CAN0, i);
+        regs[6U + (2U * i)] = CAN_FDATA1(CAN0, i);
+    }
+    failed |= (0U != (regs[0] & CAN_FCTL_FLD)) || (plan->can1_start_bank != ((regs[0] >> 8) & 0x3FU));
+
+    for(i = 0U; i < num; i++){
+        can = (CAN0 == ids[i].can_periph) ? 0U : 1U;
+        for(id = ids[i].first; id <= ids[i].last; id++){
+            failed |= ((1U + ids[i].fifo) != can_filter_accept(regs, can, ids[i].ff, id));
+        }
+    }
+    can_filter_report(plan, &report);
+    for(can = 0U; can < 2U; can++){
+        accepted = 0U;
+        for(id = 0U; id <= CAN_SFID_MASK; id++){
+            accepted += (0U != can_filter_accept(regs, can, CAN_FF_STANDARD, id)) ? 1U : 0U;
+        }
+        failed |= (accepted != report.accepted[can][0]);
+    }
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      decide, like the CAN, whether the loaded filters accept a data frame
+    \param[in]  regs: FCTL, FMCFG, FSCFG, FAFIFO, FW and the data registers of the banks
+    \param[in]  can: 0 for CAN0, 1 for CAN1
+    \param[in]  ff: CAN_FF_STANDARD or CAN_FF_EXTENDED
+    \param[in]  id: identifier
+    \param[out] none
+    \retval     0 if rejected, 1 for FIFO0, 2 for FIFO1
+*/
+static uint32_t can_filter_accept(const uint32_t *regs, uint32_t can, uint32_t ff, uint32_t id)
+{
+    uint32_t start = (regs[0] >> 8) & 0x3FU;
+    uint32_t word32, word16, data0, data1, bank, hit;
+
+    if(CAN_FF_EXTENDED == ff){
+        word32 = (id << 3) | BIT(2);
+        word16 = ((id >> 18) << 5) | BIT(3) | ((id >> 15) & 0x7U);
+    }else{
+        word32 = id << 21;
+        word16 = id << 5;
+    }
+    for(bank = (0U == can) ? 0U : start; bank < ((0U == can) ? start : CAN_FILTER_BANK_NUM); bank++){
+        if(0U == (regs[4] & BIT(bank))){
+            continue;
+        }
+        data0 = regs[5U + (2U * bank)];
+        data1 = regs[6U + (2U * bank)];
+        if(0U != (regs[2] & BIT(bank))){
+            if(0U != (regs[1] & BIT(bank))){
+                hit = (word32 == data0) || (word32 == data1);
+            }else{
+                hit = (0U == ((word32 ^ data0) & data1));
+            }
+        }else{
+            if(0U != (regs[1] & BIT(bank))){
+                hit = (word16 == (data0 & 0xFFFFU)) || (word16 == (data0 >> 16)) ||
+                      (word16 == (data1 & 0xFFFFU)) || (word16 == (data1 >> 16));
+            }else{
+                hit = (0U == ((word16 ^ data0) & (data0 >> 16) & 0xFFFFU)) ||
+                      (0U == ((word16 ^ data1) & (data1 >> 16) & 0xFFFFU));
+            }
+        }
+        if(0U != hit){
+            return (0U != (regs[3] & BIT(bank))) ? 2U : 1U;
+        }
+    }
+
+    return 0U;
+}
+
+/*!
+    \brief      check the CAN queues against bursts on the simulated bus: back
+                to back frames into both FIFOs with a slow consumer, a ring
+                that overflows, and a transmit heap whose late urgent frame
+                stops a mailbox, also when it fills the heap
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int can_queue_check(void)
+{
+    static const can_filter_id_struct ids[] = {
+        {CAN0, CAN_FF_STANDARD, 0x000U, 0x3FFU, CAN_FIFO0},
+        {CAN0, CAN_FF_STANDARD, 0x400U, 0x7FFU, CAN_FIFO1},
+        {CAN0, CAN_FF_EXTENDED, 0x00000000U, 0x1FFFFFFFU, CAN_FIFO1},
+    };
+    static can_queue_slot_struct tx_slots[33];
+    static can_queue_frame_struct rx0_ring[64];
+    static can_queue_frame_struct rx1_ring[16];
+    static host_sim_can_frame_struct captured[64];
+    static can_filter_plan_struct plan;
+    can_queue_parameter_struct init_struct;
+    can_parameter_struct can_parameter;
+    can_queue_frame_struct frame;
+    host_sim_can_frame_struct injected;
+    uint32_t next[2] = {1U, 0U};
+    uint32_t lost, sent, accepted, num, urgent, i;
+    int failed = 0;
+
+    rcu_periph_clock_enable(RCU_CAN0);
+    host_sim_irq_handler_register(CAN0_TX_IRQn, can_tx_irq);
+    host_sim_irq_handler_register(CAN0_RX0_IRQn, can_rx0_irq);
+    host_sim_irq_handler_register(CAN0_RX1_IRQn, can_rx1_irq);
+    can_struct_para_init(CAN_INIT_STRUCT, &can_parameter);
+    can_parameter.working_mode = CAN_NORMAL_MODE;
+    can_parameter.resync_jump_width = CAN_BT_SJW_1TQ;
+    can_parameter.time_segment_1 = CAN_BT_BS1_5TQ;
+    can_parameter.time_segment_2 = CAN_BT_BS2_3TQ;
+    can_parameter.prescaler = 1U;
+    can_parameter.trans_fifo_order = ENABLE;
+    failed |= (SUCCESS != can_init(CAN0, &can_parameter));
+    failed |= (SUCCESS != can_filter_compile(&plan, ids, sizeof(ids) / sizeof(ids[0])));
+    can_filter_apply(&plan);
+
+    init_struct.can_periph = CAN0;
+    init_struct.tx_buffer = tx_slots;
+    init_struct.tx_size = 32U;
+    init_struct.rx_buffer[0] = rx0_ring;
+    init_struct.rx_size[0] = 64U;
+    init_struct.rx_buffer[1] = rx1_ring;
+    init_struct.rx_size[1] = 12U;
+    failed |= (ERROR != can_queue_init(&can_queue, &init_struct));
+    init_struct.rx_size[1] = 16U;
+    failed |= (SUCCESS != can_queue_init(&can_queue, &init_struct));
+    failed |= (0U != (CAN_CTL(CAN0) & CAN_CTL_TFO));
+
+    /* 240 back to back frames, standard into FIFO0 and extended into FIFO1, drained every 16 frame times */
+    host_sim_can_frames_get(CAN0, &lost);
+    for(i = 0U; i < 240U; i++){
+        can_queue_frame_make(&injected, (0U != (i % 3U)) ? (i & 0x3FFU) : (0x18FF0000U | i),
+                             (0U != (i % 3U)) ? CAN_FF_STANDARD : CAN_FF_EXTENDED, i);
+        failed |= (SUCCESS != host_sim_can_inject(&injected));
+    }
+    for(i = 0U; i < 400U; i++){
+        host_sim_run(HOST_SIM_CAN_FRAME_TICKS);
+        if(0U != (i % 16U)){
+            continue;
+        }
+        while(SUCCESS == can_queue_receive(&can_queue, CAN_FIFO0, &frame)){
+            failed |= (CAN_FF_STANDARD != frame.ff) || (0U == (next[0] % 3U)) || ((next[0] & 0x3FFU) != frame.id) ||
+                      ((uint8_t)next[0] != frame.data[0]) || ((uint8_t)(next[0] >> 8) != frame.data[1]) ||
+                      (8U != frame.dlen) || (0U != frame.fi);
+            next[0] += (2U == (next[0] % 3U)) ? 2U : 1U;
+        }
+        while(SUCCESS == can_queue_receive(&can_queue, CAN_FIFO1, &frame)){
+            failed |= (CAN_FF_EXTENDED != frame.ff) || ((0x18FF0000U | next[1]) != frame.id) ||
+                      ((uint8_t)next[1] != frame.data[0]);
+            next[1] += 3U;
+        }
+    }
+    failed |= (241U != next[0]) || (240U != next[1]);
+    failed |= (0U != (can_queue.rx_dropped[0] + can_queue.rx_dropped[1] + can_queue.rx_overrun[0] + can_queue.rx_overrun[1]));
+    host_sim_can_frames_get(CAN0, &num);
+    failed |= (num != lost);
+
+    /* a consumer that sleeps through 40 extended frames keeps the 16 oldest */
+    for(i = 0U; i < 40U; i++){
+        can_queue_frame_make(&injected, 0x18FF0000U | i, CAN_FF_EXTENDED, i);
+        host_sim_can_inject(&injected);
+    }
+    host_sim_run(45U * HOST_SIM_CAN_FRAME_TICKS);
+    failed |= (24U != can_queue.rx_dropped[1]) || (0U != can_queue.rx_overrun[1]);
+    for(i = 0U; SUCCESS == can_queue_receive(&can_queue, CAN_FIFO1, &frame); i++){
+        failed |= ((0x18FF0000U | i) != frame.id);
+    }
+    failed |= (16U != i);
+
+    /* 24 frames of falling priority, the six last ones twice, then an urgent one while all mailboxes are loaded */
+    host_sim_can_fetch(captured, 64U);
+    for(i = 0U; i < 24U; i++){
+        frame.id = (i < 12U) ? (0x700U - ((i / 2U) * 0x10U)) : (0x600U - ((i - 12U) * 0x10U));
+        frame.ff = (uint8_t)CAN_FF_STANDARD;
+        frame.ft = (uint8_t)CAN_FT_DATA;
+        frame.dlen = 1U;
+        frame.data[0] = (uint8_t)i;
+        failed |= (SUCCESS != can_queue_transmit(&can_queue, &frame));
+    }
+    host_sim_run(4U * HOST_SIM_CAN_FRAME_TICKS + (HOST_SIM_CAN_FRAME_TICKS / 2U));
+    sent = can_queue.tx_sent;
+    frame.id = 0x001U;
+    frame.data[0] = 0xEEU;
+    failed |= (SUCCESS != can_queue_transmit(&can_queue, &frame));
+    for(i = 0U; (i < 100U) && (0U != can_queue_tx_pending_get(&can_queue)); i++){
+        host_sim_run(HOST_SIM_CAN_FRAME_TICKS);
+    }
+    num = host_sim_can_fetch(captured, 64U);
+    failed |= (25U != num) || (25U != can_queue.tx_sent) || (0U == can_queue.tx_stopped) || (0U != can_queue.tx_failed);
+    urgent = num;
+    for(i = 0U; i < num; i++){
+        if(0x001U == GET_RFIFOMI_SFID(captured[i].mi)){
+            urgent = i;
+        }else if((i > (sent + 3U)) && (urgent != (i - 1U))){
+            /* past the frames loaded before it, the heap sends by identifier and in order within one */
+            failed |= (GET_RFIFOMI_SFID(captured[i - 1U].mi) > GET_RFIFOMI_SFID(captured[i].mi));
+            failed |= (GET_RFIFOMI_SFID(captured[i - 1U].mi) == GET_RFIFOMI_SFID(captured[i].mi))
+                      && ((captured[i - 1U].data0 & 0xFFU) > (captured[i].data0 & 0xFFU));
+        }
+    }
+    failed |= (urgent > (sent + 1U));
+
+    /* a full heap refuses frames */
+    accepted = 0U;
+    for(i = 0U; i < 48U; i++){
+        frame.id = 0x100U + i;
+        accepted += (SUCCESS == can_queue_transmit(&can_queue, &frame)) ? 1U : 0U;
+    }
+    failed |= (35U != accepted) || (13U != can_queue.tx_dropped);
+    for(i = 0U; (i < 100U) && (0U != can_queue_tx_pending_get(&can_queue)); i++){
+        host_sim_run(HOST_SIM_CAN_FRAME_TICKS);
+    }
+    failed |= ((25U + accepted) != can_queue.tx_sent);
+    host_sim_can_fetch(captured, 64U);
+
+    /* an urgent frame that fills the heap must not stop a mailbox, the stopped frame
+       would have no slot to come back to; the slot past the heap stays untouched */
+    memset(&tx_slots[32], 0xA5, sizeof(tx_slots[32]));
+    sent = can_queue.tx_sent;
+    for(i = 0U; i < 34U; i++){
+        frame.id = 0x200U + i;
+        failed |= (SUCCESS != can_queue_transmit(&can_queue, &frame));
+    }
+    frame.id = 0x001U;
+    failed |= (SUCCESS != can_queue_transmit(&can_queue, &frame));
+    failed |= (32U != can_queue.tx_num) || (0U != can_queue.mailbox_stop);
+    for(i = 0U; (i < 100U) && (0U != can_queue_tx_pending_get(&can_queue)); i++){
+        host_sim_run(HOST_SIM_CAN_FRAME_TICKS);
+    }
+    num = host_sim_can_fetch(captured, 64U);
+    failed |= (35U != num) || ((sent + 35U) != can_queue.tx_sent) || (0U != can_queue.tx_failed);
+    /* it goes out right after the three frames already in the mailboxes */
+    failed |= (num < 4U) || (0x001U != GET_RFIFOMI_SFID(captured[3].mi));
+    for(i = 0U; i < sizeof(tx_slots[32]); i++){
+        failed |= (0xA5U != ((const uint8_t *)&tx_slots[32])[i]);
+    }
+    frame.dlen = 9U;
+    failed |= (ERROR != can_queue_transmit(&can_queue, &frame));
+    frame.dlen = 1U;
+    frame.id = 0x800U;
+    failed |= (ERROR != can_queue_transmit(&can_queue, &frame));
+    can_queue_deinit(&can_queue);
+    printf("%-28s %6u frames %u stopped %s\n", "can_queue", (unsigned)(next[0] + next[1] + can_queue.tx_sent),
+           (unsigned)can_queue.tx_stopped, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      build a frame the host node sends, 8 bytes carrying a sequence number
+    \param[in]  id: identifier
+    \param[in]  ff: CAN_FF_STANDARD or CAN_FF_EXTENDED
+    \param[in]  seq: sequence number
+    \param[out] frame: frame in mailbox register layout
+    \retval     none
+*/
+static void can_queue_frame_make(host_sim_can_frame_struct *frame, uint32_t id, uint32_t ff, uint32_t seq)
+{
+    frame->mi = (CAN_FF_STANDARD == ff) ? TMI_SFID(id) : (TMI_EFID(id) | CAN_FF_EXTENDED);
+    frame->mp = 8U;
+    frame->data0 = seq & 0xFFFFU;
+    frame->data1 = ~seq;
+}
+
+/*!
+    \brief      check the CAN statistics on a bus timed by the bit timing: frame
+                lengths against an independent count, identifier rates and bus
+                load of a known burst, the latency of frames queued at once,
+                the error history and the snapshot layout
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int can_stats_check(void)
+{
+    static const can_filter_id_struct ids[] = {
+        {CAN0, CAN_FF_STANDARD, 0x000U, 0x7FFU, CAN_FIFO0},
+        {CAN0, CAN_FF_EXTENDED, 0x00000000U, 0x1FFFFFFFU, CAN_FIFO1},
+    };
+    static can_queue_slot_struct tx_slots[16];
+    static can_queue_frame_struct rx0_ring[64];
+    static can_queue_frame_struct rx1_ring[64];
+    static can_stats_id_struct table[16];
+    static can_stats_struct stats;
+    static can_filter_plan_struct plan;
+    static uint8_t snapshot[256];
+    can_queue_parameter_struct init_struct;
+    can_stats_parameter_struct stats_struct;
+    can_parameter_struct can_parameter;
+    can_queue_frame_struct frame;
+    host_sim_can_frame_struct injected;
+    const can_stats_id_struct *entry;
+    const can_stats_error_struct *sample;
+    uint32_t bits, expected, sent, len, i;
+    int failed = 0;
+
+    host_sim_can_frame_ticks_config(0U);
+    can_struct_para_init(CAN_INIT_STRUCT, &can_parameter);
+    can_parameter.working_mode = CAN_NORMAL_MODE;
+    can_parameter.resync_jump_width = CAN_BT_SJW_1TQ;
+    can_parameter.time_segment_1 = CAN_BT_BS1_5TQ;
+    can_parameter.time_segment_2 = CAN_BT_BS2_3TQ;
+    can_parameter.prescaler = 1U;
+    failed |= (SUCCESS != can_init(CAN0, &can_parameter));
+    failed |= (SUCCESS != can_filter_compile(&plan, ids, sizeof(ids) / sizeof(ids[0])));
+    can_filter_apply(&plan);
+    init_struct.can_periph = CAN0;
+    init_struct.tx_buffer = tx_slots;
+    init_struct.tx_size = 16U;
+    init_struct.rx_buffer[0] = rx0_ring;
+    init_struct.rx_size[0] = 64U;
+    init_struct.rx_buffer[1] = rx1_ring;
+    init_struct.rx_size[1] = 64U;
+    failed |= (SUCCESS != can_queue_init(&can_queue, &init_struct));
+    stats_struct.queue = &can_queue;
+    stats_struct.ids = table;
+    stats_struct.id_size = 12U;
+    failed |= (ERROR != can_stats_init(&stats, &stats_struct));
+    stats_struct.id_size = 16U;
+    failed |= (SUCCESS != can_stats_init(&stats, &stats_struct));
+    /* 9 time quanta of one APB1 clock each */
+    failed |= (0U == (CAN_CTL(CAN0) & CAN_CTL_TTC)) || (9U != stats.bit_cycles);
+
+    /* stuffed lengths counted bit by bit outside of the library */
+    memset(&frame, 0, sizeof(frame));
+    frame.ff = (uint8_t)CAN_FF_STANDARD;
+    frame.ft = (uint8_t)CAN_FT_DATA;
+    frame.dlen = 8U;
+    failed |= (124U != can_stats_frame_bits(&frame));
+    frame.id = 0x7FFU;
+    frame.ft = (uint8_t)CAN_FT_REMOTE;
+    frame.dlen = 0U;
+    failed |= (47U != can_stats_frame_bits(&frame));
+    frame.id = 0x18FF0001U;
+    frame.ff = (uint8_t)CAN_FF_EXTENDED;
+    frame.ft = (uint8_t)CAN_FT_DATA;
+    frame.dlen = 8U;
+    memset(frame.data, 0x55, sizeof(frame.data));
+    failed |= (134U != can_stats_frame_bits(&frame));
+    /* the nibble tables against the bit by bit count */
+    len = 1U;
+    for(i = 0U; i < 4000U; i++){
+        len = (len * 1103515245U) + 12345U;
+        frame.ff = (uint8_t)((0U != (len & 0x80000000U)) ? CAN_FF_EXTENDED : CAN_FF_STANDARD);
+        frame.ft = (uint8_t)((0U != (len & 0x40000000U)) ? CAN_FT_REMOTE : CAN_FT_DATA);
+        frame.id = (len >> 3) & (((uint8_t)CAN_FF_STANDARD == frame.ff) ? 0x7FFU : 0x1FFFFFFFU);
+        frame.dlen = (uint8_t)((len >> 16) % 9U);
+        for(bits = 0U; bits < 8U; bits++){
+            len = (len * 1103515245U) + 12345U;
+            /* long runs of equal bits are what the stuffing is about */
+            frame.data[bits] = (0U != (len & 0x100000U)) ? (uint8_t)(len >> 24) : (uint8_t)(0U - ((len >> 24) & 1U));
+        }
+        failed |= (can_stats_bits_reference(&frame) != can_stats_frame_bits(&frame));
+    }
+
+    /* 30 standard and 10 extended frames back to back, then as long idle: half load */
+    can_stats_period(&stats);
+    expected = 0U;
+    for(i = 0U; i < 40U; i++){
+        can_queue_frame_make(&injected, (3U != (i % 4U)) ? 0x100U : 0x18FF0001U,
+                             (3U != (i % 4U)) ? CAN_FF_STANDARD : CAN_FF_EXTENDED, i);
+        failed |= (SUCCESS != host_sim_can_inject(&injected));
+        can_stats_frame_convert(&injected, &frame);
+        expected += can_stats_frame_bits(&frame) + 3U;
+    }
+    host_sim_run(2U * expected * stats.bit_cycles);
+    can_stats_period(&stats);
+    failed |= (40U != stats.period_frames) || (2U != stats.id_num);
+    bits = (uint32_t)(((uint64_t)expected * stats.bit_cycles * 1000U) / ((uint64_t)stats.period_us * 8U));
+    failed |= ((stats.load + 1U) < bits) || (stats.load > (bits + 1U));
+    failed |= (stats.load < 480U) || (stats.load > 500U);
+    entry = can_stats_id_find(&stats, 0x100U, (uint8_t)CAN_FF_STANDARD);
+    bits = (30U * 1000000U) / stats.period_us;
+    failed |= (NULL == entry) || (30U != entry->frames) || ((entry->rate + 1U) < bits) || (entry->rate > (bits + 1U));
+    entry = can_stats_id_find(&stats, 0x18FF0001U, (uint8_t)CAN_FF_EXTENDED);
+    bits = (10U * 1000000U) / stats.period_us;
+    failed |= (NULL == entry) || (10U != entry->frames) || ((entry->rate + 1U) < bits) || (entry->rate > (bits + 1U));
+    failed |= (NULL != can_stats_id_find(&stats, 0x100U, (uint8_t)CAN_FF_EXTENDED));
+    while(SUCCESS == can_queue_receive(&can_queue, CAN_FIFO0, &frame)){
+    }
+    while(SUCCESS == can_queue_receive(&can_queue, CAN_FIFO1, &frame)){
+    }
+
+    /* six frames queued at once on an idle bus: the last one waits for the five before it */
+    memset(&frame, 0, sizeof(frame));
+    frame.ff = (uint8_t)CAN_FF_STANDARD;
+    frame.ft = (uint8_t)CAN_FT_DATA;
+    frame.dlen = 8U;
+    expected = 0U;
+    sent = 0U;
+    for(i = 0U; i < 6U; i++){
+        frame.id = 0x200U + i;
+        frame.data[0] = (uint8_t)i;
+        bits = can_stats_frame_bits(&frame);
+        expected += bits + ((0U != i) ? 3U : 0U);
+        failed |= (0U == i) && ((bits * stats.bit_cycles) > 2000U);
+        failed |= (SUCCESS != can_queue_transmit(&can_queue, &frame));
+        if(0U == i){
+            sent = bits;
+        }
+    }
+    host_sim_run((expected + 20U) * stats.bit_cycles);
+    failed |= (6U != stats.total.count) || (0U != can_queue_tx_pending_get(&can_queue));
+    failed |= (stats.total.min < sent) || (stats.total.min > (sent + 2U)) || (stats.wait.min > 2U);
+    failed |= (stats.total.max > (expected + 2U)) || ((stats.total.max + 8U) < expected);
+    failed |= (stats.irq.max >= (4U * stats.bit_cycles));
+
+    /* the error history keeps the highest counts seen in a period */
+    host_sim_reg_poke(CAN0 + 0x18U, (5U << 24) | (0x60U << 16) | (3U << 4) | CAN_ERR_WERR);
+    frame.id = 0x200U;
+    failed |= (SUCCESS != can_queue_transmit(&can_queue, &frame));
+    host_sim_run(200U * stats.bit_cycles);
+    host_sim_reg_poke(CAN0 + 0x18U, (5U << 24) | (0x20U << 16) | (3U << 4));
+    can_stats_period(&stats);
+    sample = &stats.error[(stats.error_num - 1U) & (CAN_STATS_ERROR_DEPTH - 1U)];
+    failed |= (3U != stats.error_num) || (3U != sample->period) || (0x20U != sample->tec) || (0x60U != sample->tec_max);
+    failed |= (5U != sample->rec) || (5U != sample->rec_max) || (0U != sample->state) || (3U != sample->errn);
+    host_sim_reg_poke(CAN0 + 0x18U, 0U);
+
+    /* a full identifier table counts the frames it cannot place */
+    for(i = 0U; i < 12U; i++){
+        can_queue_frame_make(&injected, 0x300U + i, CAN_FF_STANDARD, i);
+        host_sim_can_inject(&injected);
+    }
+    host_sim_run(12U * 140U * stats.bit_cycles);
+    failed |= (16U != stats.id_num) || (4U != stats.id_missed);
+
+    /* snapshot: header, 16 identifier records, 3 error records */
+    len = can_stats_snapshot(&stats, snapshot, sizeof(snapshot));
+    failed |= (252U != len) || (0x43U != snapshot[0]) || (0x53U != snapshot[1]) || (1U != snapshot[2]);
+    failed |= (16U != snapshot[3]) || (3U != snapshot[4]) || (0U != snapshot[5]);
+    failed |= (1125U != (snapshot[6] | ((uint32_t)snapshot[7] << 8))) || (3U != snapshot[8]);
+    failed |= (4U != snapshot[24]) || (7U != snapshot[44]) || (stats.load_max != (snapshot[22] | ((uint32_t)snapshot[23] << 8)));
+    for(i = 0U; i < 16U; i++){
+        bits = snapshot[100U + (8U * i)] | ((uint32_t)snapshot[101U + (8U * i)] << 8) |
+               ((uint32_t)snapshot[102U + (8U * i)] << 16) | ((uint32_t)snapshot[103U + (8U * i)] << 24);
+        entry = can_stats_id_find(&stats, bits & ~CAN_STATS_ID_EXT,
+                                  (uint8_t)((0U != (bits & CAN_STATS_ID_EXT)) ? CAN_FF_EXTENDED : CAN_FF_STANDARD));
+        failed |= (NULL == entry) || (entry->rate != (snapshot[104U + (8U * i)] | ((uint32_t)snapshot[105U + (8U * i)] << 8) |
+                                                      ((uint32_t)snapshot[106U + (8U * i)] << 16) | ((uint32_t)snapshot[107U + (8U * i)] << 24)));
+    }
+    failed |= (0x60U != snapshot[228U + 16U + 4U]) || (0x20U != snapshot[228U + 16U + 2U]);
+    failed |= (0U != can_stats_snapshot(&stats, snapshot, 99U));
+    failed |= (116U != can_stats_snapshot(&stats, snapshot, 116U)) || (0U != snapshot[3]) || (2U != snapshot[4]);
+    printf("%-28s %6u frames %u permille %s\n", "can_stats", (unsigned)stats.frames, (unsigned)stats.load_max,
+           (0 != failed) ? "failed" : "ok");
+
+    can_stats_deinit(&stats);
+    can_queue_deinit(&can_queue);
+    host_sim_can_frame_ticks_config(HOST_SIM_CAN_FRAME_TICKS);
+    while(SUCCESS == can_queue_receive(&can_queue, CAN_FIFO0, &frame)){
+    }
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      convert a frame of the host node to the layout of the CAN queues
+    \param[in]  injected: frame in mailbox register layout
+    \param[out] frame: frame
+    \retval     none
+*/
+static void can_stats_frame_convert(const host_sim_can_frame_struct *injected, can_queue_frame_struct *frame)
+{
+    uint32_t i;
+
+    frame->ff = (uint8_t)(injected->mi & CAN_TMI_FF);
+    frame->ft = (uint8_t)(injected->mi & CAN_TMI_FT);
+    frame->id = (CAN_FF_STANDARD == frame->ff) ? GET_RFIFOMI_SFID(injected->mi) : GET_RFIFOMI_EFID(injected->mi);
+    frame->dlen = (uint8_t)(injected->mp & CAN_TMP_DLENC);
+    for(i = 0U; i < 4U; i++){
+        frame->data[i] = (uint8_t)(injected->data0 >> (8U * i));
+        frame->data[4U + i] = (uint8_t)(injected->data1 >> (8U * i));
+    }
+}
+
+/*!
+    \brief      count the bits of a frame on the bus one by one: start of frame
+                to CRC with the stuff bits, and the 10 bits of the CRC
+                delimiter, ACK and end of frame
+    \param[in]  frame: frame
+    \param[out] none
+    \retval     number of bits
+*/
+static uint32_t can_stats_bits_reference(const can_queue_frame_struct *frame)
+{
+    uint8_t bit[160];
+    uint32_t rtr = ((uint8_t)CAN_FT_REMOTE == frame->ft) ? 1U : 0U;
+    uint32_t field[8][2];
+    uint32_t fields = 0U, n = 0U, crc = 0U, run = 0U, stuff = 0U, last = 2U, i, k;
+
+    if((uint8_t)CAN_FF_STANDARD == frame->ff){
+        field[fields][0] = frame->id << 3;
+        field[fields++][1] = 14U;
+    }else{
+        field[fields][0] = ((frame->id >> 18) << 2) | 0x3U;
+        field[fields++][1] = 13U;
+        field[fields][0] = frame->id & 0x3FFFFU;
+        field[fields++][1] = 18U;
+        field[fields][0] = 0U;
+        field[fields++][1] = 3U;
+    }
+    field[fields - 1U][0] |= rtr << 2;
+    field[fields][0] = frame->dlen;
+    field[fields++][1] = 4U;
+    bit[n++] = 0U;
+    for(i = 0U; i < fields; i++){
+        for(k = field[i][1]; 0U != k; k--){
+            bit[n++] = (uint8_t)((field[i][0] >> (k - 1U)) & 1U);
+        }
+    }
+    for(i = 0U; (0U == rtr) && (i < frame->dlen) && (i < 8U); i++){
+        for(k = 8U; 0U != k; k--){
+            bit[n++] = (uint8_t)((frame->data[i] >> (k - 1U)) & 1U);
+        }
+    }
+    for(i = 0U; i < n; i++){
+        crc = ((crc << 1) & 0x7FFFU) ^ ((0U != (bit[i] ^ (crc >> 14))) ? 0x4599U : 0U);
+    }
+    for(k = 15U; 0U != k; k--){
+        bit[n++] = (uint8_t)((crc >> (k - 1U)) & 1U);
+    }
+    for(i = 0U; i < n; i++){
+        run = (bit[i] == last) ? (run + 1U) : 1U;
+        last = bit[i];
+        if(5U == run){
+            stuff++;
+            last ^= 1U;
+            run = 1U;
+        }
+    }
+
+    return n + stuff + 10U;
+}
+
+/*!
+    \brief      move ISO-TP messages between sessions on CAN0 and CAN1: three
+                transfers at once with a block size and a separation time,
+                the frame sequence of a short transfer, the first frame escape,
+                an overflow, and the timeouts, flow control waits and sequence
+                errors provoked by the host node
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int can_isotp_check(void)
+{
+    static const can_filter_id_struct ids[] = {
+        {CAN0, CAN_FF_STANDARD, 0x7E8U, 0x7EFU, CAN_FIFO0},
+        {CAN1, CAN_FF_STANDARD, 0x7E0U, 0x7E7U, CAN_FIFO0},
+    };
+    static uint8_t tx_data[5000];
+    static uint8_t rx_buffer[2][3][5000];
+    static host_sim_can_frame_struct captured[32];
+    static can_filter_plan_struct plan;
+    static const uint8_t reply[5] = {0x50U, 0x03U, 0x00U, 0x32U, 0x01U};
+    static const uint8_t fc_wait[3] = {0x31U, 0x00U, 0x00U};
+    static const uint8_t first[8] = {0x10U, 0x14U, 0U, 1U, 2U, 3U, 4U, 5U};
+    static const uint8_t wrong[8] = {0x22U, 6U, 7U, 8U, 9U, 10U, 11U, 12U};
+    can_isotp_parameter_struct init_struct;
+    can_parameter_struct can_parameter;
+    can_isotp_session_struct *session;
+    uint64_t start;
+    uint32_t num, dlen, byte, cf, i, j;
+    int failed = 0;
+
+    for(i = 0U; i < sizeof(tx_data); i++){
+        tx_data[i] = (uint8_t)((i * 7U) + (i >> 8));
+    }
+    host_sim_can_frame_ticks_config(0U);
+    host_sim_irq_handler_register(CAN0_TX_IRQn, isotp0_tx_irq);
+    host_sim_irq_handler_register(CAN0_RX0_IRQn, isotp0_rx0_irq);
+    host_sim_irq_handler_register(CAN1_TX_IRQn, isotp1_tx_irq);
+    host_sim_irq_handler_register(CAN1_RX0_IRQn, isotp1_rx0_irq);
+    can_struct_para_init(CAN_INIT_STRUCT, &can_parameter);
+    can_parameter.working_mode = CAN_NORMAL_MODE;
+    can_parameter.resync_jump_width = CAN_BT_SJW_1TQ;
+    can_parameter.time_segment_1 = CAN_BT_BS1_5TQ;
+    can_parameter.time_segment_2 = CAN_BT_BS2_3TQ;
+    can_parameter.prescaler = 1U;
+    failed |= (SUCCESS != can_init(CAN0, &can_parameter));
+    failed |= (SUCCESS != can_init(CAN1, &can_parameter));
+    failed |= (SUCCESS != can_filter_compile(&plan, ids, sizeof(ids) / sizeof(ids[0])));
+    can_filter_apply(&plan);
+
+    /* CAN0 talks to 0x7E0 and 0x7E1 on CAN1, 0x7E2 has no peer */
+    memset(isotp_sessions, 0, sizeof(isotp_sessions));
+    for(i = 0U; i < 2U; i++){
+        for(j = 0U; j < 3U; j++){
+            session = &isotp_sessions[i][j];
+            session->tx_id = (0U == i) ? (0x7E0U + j) : (0x7E8U + j);
+            session->rx_id = (0U == i) ? (0x7E8U + j) : (0x7E0U + j);
+            session->ff = (uint8_t)CAN_FF_STANDARD;
+            session->padding = (0U == i) ? 0xCCU : CAN_ISOTP_PADDING_NONE;
+            session->rx_buffer = rx_buffer[i][j];
+            session->rx_size = sizeof(rx_buffer[i][j]);
+            session->tx_callback = can_isotp_tx_done;
+            session->rx_callback = can_isotp_rx_done;
+        }
+    }
+    isotp_sessions[1][0].block_size = 8U;
+    isotp_sessions[1][1].st_min = 0xF2U;
+    isotp_sessions[1][1].rx_size = 1024U;
+    init_struct.timeout_ms = 2U;
+    init_struct.session_num = 3U;
+    init_struct.can_periph = CAN0;
+    init_struct.sessions = isotp_sessions[0];
+    failed |= (SUCCESS != can_isotp_init(&can_isotp[0], &init_struct));
+    init_struct.can_periph = CAN1;
+    init_struct.sessions = isotp_sessions[1];
+    init_struct.session_num = 2U;
+    init_struct.timeout_ms = 20000U;
+    failed |= (ERROR != can_isotp_init(&can_isotp[1], &init_struct));
+    init_struct.timeout_ms = 2U;
+    isotp_sessions[1][1].rx_id = 0x7E0U;
+    failed |= (ERROR != can_isotp_init(&can_isotp[1], &init_struct));
+    isotp_sessions[1][1].rx_id = 0x7E1U;
+    failed |= (SUCCESS != can_isotp_init(&can_isotp[1], &init_struct));
+    failed |= (0U == (CAN_CTL(CAN0) & CAN_CTL_TFO));
+    memset(isotp_tx_done, 0, sizeof(isotp_tx_done));
+    memset(isotp_rx_done, 0, sizeof(isotp_rx_done));
+
+    /* 3000 bytes in blocks of 8, 700 bytes 200 us apart, a reply and a frame nobody takes, all at once */
+    start = host_sim_time_get();
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][0], tx_data, 3000U));
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][1], &tx_data[1000], 700U));
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][2], tx_data, 1U));
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[1], &isotp_sessions[1][0], reply, sizeof(reply)));
+    failed |= (ERROR != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][0], tx_data, 10U));
+    for(i = 0U; (i < 20000U) && ((1U != isotp_rx_done[1][0]) || (1U != isotp_rx_done[1][1])
+                                 || (1U != isotp_tx_done[0][0]) || (1U != isotp_tx_done[0][1])); i++){
+        can_isotp_run(100U);
+    }
+    failed |= (1U != isotp_tx_done[0][0]) || (CAN_ISOTP_OK != isotp_tx_result[0][0]);
+    failed |= (1U != isotp_tx_done[0][1]) || (CAN_ISOTP_OK != isotp_tx_result[0][1]);
+    failed |= (1U != isotp_tx_done[0][2]) || (CAN_ISOTP_OK != isotp_tx_result[0][2]);
+    failed |= (1U != isotp_tx_done[1][0]) || (CAN_ISOTP_OK != isotp_tx_result[1][0]);
+    failed |= (1U != isotp_rx_done[1][0]) || (CAN_ISOTP_OK != isotp_rx_result[1][0]) || (3000U != isotp_rx_len[1][0]);
+    failed |= (0 != memcmp(rx_buffer[1][0], tx_data, 3000U));
+    failed |= (1U != isotp_rx_done[1][1]) || (CAN_ISOTP_OK != isotp_rx_result[1][1]) || (700U != isotp_rx_len[1][1]);
+    failed |= (0 != memcmp(rx_buffer[1][1], &tx_data[1000], 700U));
+    failed |= (1U != isotp_rx_done[0][0]) || (CAN_ISOTP_OK != isotp_rx_result[0][0]) || (5U != isotp_rx_len[0][0]);
+    failed |= (0 != memcmp(rx_buffer[0][0], reply, sizeof(reply)));
+    /* 99 consecutive frames of at least 114 bits with at least 200 us between them */
+    failed |= ((isotp_rx_time[1][1] - start) < (98U * (1600U + (114U * 9U))));
+    failed |= (1U != can_isotp[1].ignored) || (0U != can_isotp[0].ignored);
+
+    /* frame by frame: 120 bytes are a first frame, 17 consecutive frames and 3 flow controls */
+    while(0U != host_sim_can_fetch(captured, 32U)){
+    }
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][0], tx_data, 120U));
+    can_isotp_run(40000U);
+    num = host_sim_can_fetch(captured, 32U);
+    failed |= (21U != num) || (2U != isotp_rx_done[1][0]) || (0 != memcmp(rx_buffer[1][0], tx_data, 120U));
+    cf = 0U;
+    for(i = 0U; (i < num) && (0 == failed); i++){
+        dlen = captured[i].mp & CAN_TMP_DLENC;
+        byte = captured[i].data0 & 0xFFU;
+        if(0U == i){
+            failed |= ((0x7E0U << 21) != captured[i].mi) || (8U != dlen) || (0x10U != byte) || (120U != ((captured[i].data0 >> 8) & 0xFFU));
+        }else if((1U == i) || (10U == i) || (19U == i)){
+            /* flow controls of CAN1 are not padded */
+            failed |= ((0x7E8U << 21) != captured[i].mi) || (3U != dlen) || (0x000830U != captured[i].data0);
+        }else{
+            cf++;
+            failed |= ((0x7E0U << 21) != captured[i].mi) || (8U != dlen) || ((0x20U | (cf & 0x0FU)) != byte);
+            failed |= (tx_data[6U + ((cf - 1U) * 7U)] != ((captured[i].data0 >> 8) & 0xFFU));
+            /* the last one carries 2 bytes and the fill */
+            failed |= (((17U == cf) ? 0xCCU : tx_data[6U + ((cf - 1U) * 7U) + 6U]) != ((captured[i].data1 >> 24) & 0xFFU));
+        }
+    }
+
+    /* 5000 bytes need the first frame escape; 2000 bytes do not fit into 1024 */
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][0], tx_data, 5000U));
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][1], tx_data, 2000U));
+    for(i = 0U; (i < 20000U) && ((3U != isotp_tx_done[0][0]) || (2U != isotp_tx_done[0][1])); i++){
+        can_isotp_run(100U);
+    }
+    failed |= (3U != isotp_rx_done[1][0]) || (CAN_ISOTP_OK != isotp_rx_result[1][0]) || (5000U != isotp_rx_len[1][0]);
+    failed |= (0 != memcmp(rx_buffer[1][0], tx_data, 5000U)) || (CAN_ISOTP_OK != isotp_tx_result[0][0]);
+    failed |= (2U != isotp_rx_done[1][1]) || (CAN_ISOTP_OVERFLOW != isotp_rx_result[1][1]) || (2000U != isotp_rx_len[1][1]);
+    failed |= (2U != isotp_tx_done[0][1]) || (CAN_ISOTP_OVERFLOW != isotp_tx_result[0][1]);
+
+    /* no flow control comes for 0x7E2: N_Bs ends the message */
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][2], tx_data, 100U));
+    can_isotp_run(8000U);
+    failed |= (1U != isotp_tx_done[0][2]);
+    can_isotp_run(16000U);
+    failed |= (2U != isotp_tx_done[0][2]) || (CAN_ISOTP_TIMEOUT != isotp_tx_result[0][2]) || (1U != isotp_sessions[0][2].tx_errors);
+
+    /* the host node answers with nine waits, one more than allowed */
+    failed |= (SUCCESS != can_isotp_transmit(&can_isotp[0], &isotp_sessions[0][2], tx_data, 100U));
+    for(i = 0U; i < 9U; i++){
+        can_isotp_inject(0x7EAU, fc_wait, sizeof(fc_wait));
+    }
+    can_isotp_run(12000U);
+    failed |= (3U != isotp_tx_done[0][2]) || (CAN_ISOTP_WAIT_LIMIT != isotp_tx_result[0][2]);
+
+    /* a consecutive frame out of sequence, then a first frame without consecutive frames */
+    can_isotp_inject(0x7E1U, first, sizeof(first));
+    can_isotp_inject(0x7E1U, wrong, sizeof(wrong));
+    can_isotp_run(4000U);
+    failed |= (3U != isotp_rx_done[1][1]) || (CAN_ISOTP_WRONG_SN != isotp_rx_result[1][1]) || (6U != isotp_rx_len[1][1]);
+    can_isotp_inject(0x7E0U, first, sizeof(first));
+    can_isotp_run(8000U);
+    failed |= (3U != isotp_rx_done[1][0]);
+    can_isotp_run(16000U);
+    failed |= (4U != isotp_rx_done[1][0]) || (CAN_ISOTP_TIMEOUT != isotp_rx_result[1][0]) || (6U != isotp_rx_len[1][0]);
+    failed |= (0U != can_isotp[0].rx_overrun[0]) || (0U != can_isotp[1].rx_overrun[0]);
+    printf("%-28s %6u messages %u errors %s\n", "can_isotp",
+           (unsigned)(isotp_sessions[0][0].tx_messages + isotp_sessions[0][1].tx_messages + isotp_sessions[0][2].tx_messages
+                      + isotp_sessions[1][0].rx_messages + isotp_sessions[1][1].rx_messages),
+           (unsigned)(isotp_sessions[0][1].tx_errors + isotp_sessions[0][2].tx_errors
+                      + isotp_sessions[1][0].rx_errors + isotp_sessions[1][1].rx_errors),
+           (0 != failed) ? "failed" : "ok");
+
+    can_isotp_deinit(&can_isotp[0]);
+    can_isotp_deinit(&can_isotp[1]);
+    host_sim_can_frame_ticks_config(HOST_SIM_CAN_FRAME_TICKS);
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      let the bus run while both ISO-TP instances are polled every
+                100 bus ticks
+    \param[in]  ticks: bus ticks
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_run(uint32_t ticks)
+{
+    uint32_t i;
+
+    for(i = 0U; i < ticks; i += 100U){
+        host_sim_run(100U);
+        can_isotp_poll(&can_isotp[0]);
+        can_isotp_poll(&can_isotp[1]);
+    }
+}
+
+/*!
+    \brief      send a standard data frame of up to 8 bytes from the host node
+    \param[in]  id: standard identifier
+    \param[in]  data: data bytes
+    \param[in]  dlen: number of data bytes
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_inject(uint32_t id, const uint8_t *data, uint32_t dlen)
+{
+    host_sim_can_frame_struct frame;
+    uint32_t i;
+
+    frame.mi = id << 21;
+    frame.mp = dlen;
+    frame.data0 = 0U;
+    frame.data1 = 0U;
+    for(i = 0U; i < dlen; i++){
+        if(i < 4U){
+            frame.data0 |= (uint32_t)data[i] << (8U * i);
+        }else{
+            frame.data1 |= (uint32_t)data[i] << (8U * (i - 4U));
+        }
+    }
+    host_sim_can_inject(&frame);
+}
+
+/*!
+    \brief      ISO-TP callback of a message sent, records its result
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  session: session
+    \param[in]  result: outcome of the message
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_tx_done(can_isotp_struct *isotp, can_isotp_session_struct *session, can_isotp_result_enum result)
+{
+    uint32_t i = (uint32_t)(isotp - can_isotp);
+    uint32_t j = (uint32_t)(session - isotp->sessions);
+
+    isotp_tx_done[i][j]++;
+    isotp_tx_result[i][j] = result;
+}
+
+/*!
+    \brief      ISO-TP callback of a message received, records its result
+    \param[in]  isotp: ISO-TP driver state
+    \param[in]  session: session
+    \param[in]  len: bytes received
+    \param[in]  result: outcome of the message
+    \param[out] none
+    \retval     none
+*/
+static void can_isotp_rx_done(can_isotp_struct *isotp, can_isotp_session_struct *session, uint32_t len,
+                              can_isotp_result_enum result)
+{
+    uint32_t i = (uint32_t)(isotp - can_isotp);
+    uint32_t j = (uint32_t)(session - isotp->sessions);
+
+    isotp_rx_done[i][j]++;
+    isotp_rx_result[i][j] = result;
+    isotp_rx_len[i][j] = len;
+    isotp_rx_time[i][j] = host_sim_time_get();
+}
+
+/*!
+    \brief      transmit interrupt handler of the ISO-TP instance on CAN0
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void isotp0_tx_irq(void)
+{
+    can_isotp_tx_irq_handler(&can_isotp[0]);
+}
+
+/*!
+    \brief      FIFO0 interrupt handler of the ISO-TP instance on CAN0
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void isotp0_rx0_irq(void)
+{
+    can_isotp_rx_irq_handler(&can_isotp[0], CAN_FIFO0);
+}
+
+/*!
+    \brief      transmit interrupt handler of the ISO-TP instance on CAN1
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void isotp1_tx_irq(void)
+{
+    can_isotp_tx_irq_handler(&can_isotp[1]);
+}
+
+/*!
+    \brief      FIFO0 interrupt handler of the ISO-TP instance on CAN1
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void isotp1_rx0_irq(void)
+{
+    can_isotp_rx_irq_handler(&can_isotp[1], CAN_FIFO0);
+}
+
+/*!
+    \brief      forward frames between CAN0 and CAN1: a translated identifier
+                straight through the mailboxes, the other direction, an
+                extended route on FIFO1, a rate limited route and a burst that
+                fills the mailboxes and the ring of CAN1; both CANs share the
+                simulated bus, so each filter only takes the frames of the host
+                node that were not translated
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int can_gateway_check(void)
+{
+    static const can_filter_id_struct ids[] = {
+        {CAN0, CAN_FF_STANDARD, 0x100U, 0x1FFU, CAN_FIFO0},
+        {CAN0, CAN_FF_EXTENDED, 0x18DA0000U, 0x18DAFFFFU, CAN_FIFO1},
+        {CAN1, CAN_FF_STANDARD, 0x200U, 0x2FFU, CAN_FIFO0},
+    };
+    static const uint8_t data[8] = {0x11U, 0x22U, 0x33U, 0x44U, 0x55U, 0x66U, 0x77U, 0x88U};
+    static can_gateway_route_struct routes[4];
+    static can_gateway_frame_struct ring[4];
+    static host_sim_can_frame_struct captured[16];
+    static can_filter_plan_struct plan;
+    can_gateway_parameter_struct init_struct;
+    can_gateway_stats_struct stats;
+    host_sim_can_frame_struct frame;
+    uint32_t num, dropped, i;
+    int failed = 0;
+
+    host_sim_can_frame_ticks_config(0U);
+    host_sim_irq_handler_register(CAN0_TX_IRQn, gateway0_tx_irq);
+    host_sim_irq_handler_register(CAN0_RX0_IRQn, gateway0_rx0_irq);
+    host_sim_irq_handler_register(CAN0_RX1_IRQn, gateway0_rx1_irq);
+    host_sim_irq_handler_register(CAN1_TX_IRQn, gateway1_tx_irq);
+    host_sim_irq_handler_register(CAN1_RX0_IRQn, gateway1_rx0_irq);
+    failed |= (SUCCESS != can_filter_compile(&plan, ids, sizeof(ids) / sizeof(ids[0])));
+    can_filter_apply(&plan);
+
+    /* 0x100-0x10F to 0x500-0x50F, 0x120 to 0x520 at 100 frames/s, 0x18DAxxF1 to 0x18DBxxF1, 0x2xx to 0x6xx */
+    memset(routes, 0, sizeof(routes));
+    routes[0].src_periph = CAN0;
+    routes[0].ff = (uint8_t)CAN_FF_STANDARD;
+    routes[0].id = 0x100U;
+    routes[0].mask = 0x7F0U;
+    routes[0].new_id = 0x500U;
+    routes[0].new_mask = 0x7F0U;
+    routes[1] = routes[0];
+    routes[1].id = 0x120U;
+    routes[1].mask = 0x7FFU;
+    routes[1].new_id = 0x520U;
+    routes[1].new_mask = 0x7FFU;
+    routes[1].rate = 100U;
+    routes[1].burst = 2U;
+    routes[2].src_periph = CAN0;
+    routes[2].ff = (uint8_t)CAN_FF_EXTENDED;
+    routes[2].id = 0x18DA00F1U;
+    routes[2].mask = 0x1FFF00FFU;
+    routes[2].new_id = 0x18DB0000U;
+    routes[2].new_mask = 0x1FFF0000U;
+    routes[3].src_periph = CAN1;
+    routes[3].ff = (uint8_t)CAN_FF_STANDARD;
+    routes[3].id = 0x200U;
+    routes[3].mask = 0x700U;
+    routes[3].new_id = 0x600U;
+    routes[3].new_mask = 0x700U;
+    init_struct.routes = routes;
+    init_struct.route_num = 4U;
+    init_struct.tx_buffer[0] = NULL;
+    init_struct.tx_size[0] = 0U;
+    init_struct.tx_buffer[1] = ring;
+    init_struct.tx_size[1] = 3U;
+    failed |= (ERROR != can_gateway_init(&can_gateway, &init_struct));
+    init_struct.tx_size[1] = 4U;
+    routes[1].burst = 0U;
+    failed |= (ERROR != can_gateway_init(&can_gateway, &init_struct));
+    routes[1].burst = 2U;
+    failed |= (SUCCESS != can_gateway_init(&can_gateway, &init_struct));
+    while(0U != host_sim_can_fetch(captured, 16U)){
+    }
+
+    /* an 8 byte frame alone on the bus goes straight through: its own 111 to 130 bits of 9 ticks
+       and the interrupt entry, at 125 ns a tick */
+    can_isotp_inject(0x103U, data, 8U);
+    host_sim_run(4000U);
+    failed |= (SUCCESS != can_gateway_stats_get(&can_gateway, 0U, &stats)) || (1U != stats.forwarded);
+    failed |= (stats.latency_min_ns < (111U * 9U * 125U)) || (stats.latency_max_ns > (140U * 9U * 125U));
+    failed |= (ERROR != can_gateway_stats_get(&can_gateway, 4U, &stats));
+
+    /* one frame the other way, an extended one and one of no route */
+    can_isotp_inject(0x2A5U, data, 2U);
+    can_isotp_inject(0x150U, data, 1U);
+    frame.mi = TMI_EFID(0x18DA00F1U) | CAN_FF_EXTENDED;
+    frame.mp = 3U;
+    frame.data0 = 0x00C0FFEEU;
+    frame.data1 = 0U;
+    host_sim_can_inject(&frame);
+    host_sim_run(12000U);
+    num = host_sim_can_fetch(captured, 16U);
+    failed |= (3U != num);
+    for(i = 0U; (i < num) && (0 == failed); i++){
+        if((0x503U << 21) == captured[i].mi){
+            failed |= (8U != captured[i].mp) || (0x44332211U != captured[i].data0) || (0x88776655U != captured[i].data1);
+        }else if((0x6A5U << 21) == captured[i].mi){
+            failed |= (2U != captured[i].mp) || (0x2211U != (captured[i].data0 & 0xFFFFU));
+        }else{
+            failed |= ((TMI_EFID(0x18DB00F1U) | CAN_FF_EXTENDED) != captured[i].mi) || (3U != captured[i].mp);
+            failed |= (0x00C0FFEEU != (captured[i].data0 & 0xFFFFFFU));
+        }
+    }
+    failed |= (2U != can_gateway.tx_direct[1]) || (1U != can_gateway.tx_direct[0]) || (1U != can_gateway.unrouted[0]);
+
+    /* 100 frames/s with a burst of 2: 2 of 5 back to back pass, one more 10 ms later */
+    for(i = 0U; i < 5U; i++){
+        can_isotp_inject(0x120U, data, 4U);
+    }
+    host_sim_run(12000U);
+    failed |= (SUCCESS != can_gateway_stats_get(&can_gateway, 1U, &stats));
+    failed |= (2U != stats.forwarded) || (3U != stats.dropped_rate);
+    host_sim_run(80000U);
+    can_isotp_inject(0x120U, data, 4U);
+    host_sim_run(4000U);
+    failed |= (SUCCESS != can_gateway_stats_get(&can_gateway, 1U, &stats));
+    failed |= (3U != stats.forwarded) || (3U != stats.dropped_rate);
+    /* an empty bucket idle for 2^32 mcycles, which the low word alone sees as no time at all, is full again */
+    routes[1].credit = 0U;
+    routes[1].last = host_sim_time_get() - 0x100000000ULL;
+    can_isotp_inject(0x120U, data, 4U);
+    host_sim_run(4000U);
+    failed |= (SUCCESS != can_gateway_stats_get(&can_gateway, 1U, &stats));
+    failed |= (4U != stats.forwarded) || (3U != stats.dropped_rate);
+    while(0U != host_sim_can_fetch(captured, 16U)){
+    }
+
+    /* the host node keeps the bus with 0x101 ahead of 0x501: 3 mailboxes and 4 ring slots fill, 5 frames drop */
+    for(i = 0U; i < 12U; i++){
+        frame.mi = 0x101U << 21;
+        frame.mp = 1U;
+        frame.data0 = i;
+        frame.data1 = 0U;
+        host_sim_can_inject(&frame);
+    }
+    host_sim_run(40000U);
+    num = host_sim_can_fetch(captured, 16U);
+    failed |= (7U != num) || (4U != can_gateway.tx_queued[1]);
+    for(i = 0U; (i < num) && (0 == failed); i++){
+        failed |= ((0x501U << 21) != captured[i].mi) || (i != captured[i].data0);
+    }
+    failed |= (SUCCESS != can_gateway_stats_get(&can_gateway, 0U, &stats));
+    failed |= (8U != stats.forwarded) || (5U != stats.dropped_busy) || (0U != stats.dropped_error);
+    failed |= (0U != can_gateway.rx_overrun[0][0]) || (0U != can_gateway.rx_overrun[1][0]);
+    dropped = stats.dropped_busy;
+    failed |= (SUCCESS != can_gateway_stats_get(&can_gateway, 1U, &stats));
+    dropped += stats.dropped_rate;
+    printf("%-28s %6u frames %u dropped %s\n", "can_gateway",
+           (unsigned)(can_gateway.tx_direct[0] + can_gateway.tx_direct[1] + can_gateway.tx_queued[1]), (unsigned)dropped,
+           (0 != failed) ? "failed" : "ok");
+
+    can_gateway_deinit(&can_gateway);
+    host_sim_can_frame_ticks_config(HOST_SIM_CAN_FRAME_TICKS);
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      write the flash through two shadows: unaligned bytes across two
+                erased pages, small writes coalesced into one flush, the same
+                data again, an append into an erased half word, changes to
+                programmed half words that need the erase and a page evicted to
+                make room; the FMC operations are counted by the simulator
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int fmc_writer_check(void)
+{
+    static fmc_writer_shadow_struct shadows[2];
+    fmc_writer_parameter_struct init;
+    host_sim_fmc_ops_struct ops, last;
+    uint8_t data[100], back[100];
+    uint32_t area = 0x08010000U;
+    uint32_t i;
+    int failed = 0;
+
+    rcu_periph_clock_enable(RCU_CRC);
+    init.start = area;
+    init.size = 4U * FMC_WRITER_PAGE_SIZE;
+    init.shadows = shadows;
+    init.shadow_num = 2U;
+    init.callback = fmc_writer_page_done;
+    failed |= (SUCCESS != fmc_writer_init(&fmc_writer, &init));
+    init.start = area + 4U;
+    failed |= (ERROR != fmc_writer_init(&fmc_writer, &init));
+    init.start = area;
+    init.shadow_num = 0U;
+    failed |= (ERROR != fmc_writer_init(&fmc_writer, &init));
+    init.shadow_num = 2U;
+    failed |= (SUCCESS != fmc_writer_init(&fmc_writer, &init));
+    for(i = 0U; i < sizeof(data); i++){
+        data[i] = (uint8_t)((i * 37U) + 1U);
+    }
+    failed |= (FMC_WRITER_RANGE != fmc_writer_write(&fmc_writer, area + init.size - 2U, data, 4U));
+    failed |= (FMC_WRITER_RANGE != fmc_writer_write(&fmc_writer, area - 1U, data, 4U));
+
+    /* 100 bytes at 0x3F2 of page 0: 4 words of page 0 and 22 of page 1, no erase */
+    host_sim_fmc_ops_get(&last);
+    host_sim_access_clear();
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area + 0x3F2U, data, sizeof(data)));
+    failed |= (FMC_WRITER_OK != fmc_writer_flush(&fmc_writer));
+    access_report("fmc_writer_flush");
+    host_sim_fmc_ops_get(&ops);
+    failed |= (26U != (ops.programs - last.programs)) || (ops.page_erases != last.page_erases);
+    failed |= (2U != fmc_writer.erases_skipped) || (0U != fmc_writer.erases) || (0U != fmc_writer.errors);
+    failed |= (0U == (FMC_CTL0 & FMC_CTL0_LK));
+    failed |= (FMC_WRITER_OK != fmc_writer_read(&fmc_writer, area + 0x3F2U, back, sizeof(back)));
+    failed |= (0 != memcmp(data, back, sizeof(data)));
+    failed |= (0xFFFFFFFFU != REG32(area + 0x3ECU)) || (0xFFFFU != (REG32(area + 0x3F0U) & 0xFFFFU));
+
+    /* 50 writes of 2 bytes into page 2 cost one flush of 25 words */
+    host_sim_fmc_ops_get(&last);
+    for(i = 0U; i < 50U; i++){
+        failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area + 0x800U + (2U * i), &data[2U * i], 2U));
+    }
+    failed |= (FMC_WRITER_OK != fmc_writer_read(&fmc_writer, area + 0x800U, back, sizeof(back)));
+    failed |= (0 != memcmp(data, back, sizeof(data)));
+    failed |= (FMC_WRITER_OK != fmc_writer_flush(&fmc_writer));
+    host_sim_fmc_ops_get(&ops);
+    failed |= (25U != (ops.programs - last.programs)) || (3U != fmc_writer.pages);
+    failed |= (3U != fmc_page_done) || (area + 0x800U != fmc_page_last.page) || (0U != fmc_page_last.erased);
+
+    /* the same data again is neither erased nor programmed */
+    host_sim_fmc_ops_get(&last);
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area + 0x3F2U, data, sizeof(data)));
+    failed |= (FMC_WRITER_OK != fmc_writer_flush(&fmc_writer));
+    host_sim_fmc_ops_get(&ops);
+    failed |= (ops.programs != last.programs) || (ops.page_erases != last.page_erases);
+    failed |= (26U != fmc_writer.skipped);
+
+    /* 2 bytes appended into the erased upper half of the last word are one half word program */
+    back[0] = 0x5AU;
+    back[1] = 0xA5U;
+    host_sim_fmc_ops_get(&last);
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area + 0x3F2U + sizeof(data), back, 2U));
+    failed |= (FMC_WRITER_OK != fmc_writer_flush(&fmc_writer));
+    host_sim_fmc_ops_get(&ops);
+    failed |= (1U != (ops.programs - last.programs)) || (ops.page_erases != last.page_erases);
+    failed |= (0xA55AU != (REG32(area + 0x454U) >> 16)) || (0U != fmc_page_last.erased);
+
+    /* even clearing bits of a programmed half word erases page 1 and programs back its 22 words */
+    back[0] = data[20] & 0x0FU;
+    host_sim_fmc_ops_get(&last);
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area + 0x3F2U + 20U, back, 1U));
+    failed |= (FMC_WRITER_OK != fmc_writer_flush(&fmc_writer));
+    host_sim_fmc_ops_get(&ops);
+    failed |= (22U != (ops.programs - last.programs)) || (1U != (ops.page_erases - last.page_erases));
+    failed |= (back[0] != (uint8_t)(REG32(area + 0x404U) >> 16)) || (0xA55AU != (REG32(area + 0x454U) >> 16));
+    data[20] = back[0];
+
+    /* setting a bit erases page 0 and programs back its 4 words */
+    back[0] = 0xFFU;
+    host_sim_fmc_ops_get(&last);
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area + 0x3F2U, back, 1U));
+    failed |= (FMC_WRITER_OK != fmc_writer_flush(&fmc_writer));
+    host_sim_fmc_ops_get(&ops);
+    failed |= (4U != (ops.programs - last.programs)) || (1U != (ops.page_erases - last.page_erases));
+    failed |= (2U != fmc_writer.erases) || (1U != fmc_page_last.erased) || (FMC_WRITER_OK != fmc_page_last.result);
+    data[0] = 0xFFU;
+    failed |= (FMC_WRITER_OK != fmc_writer_read(&fmc_writer, area + 0x3F2U, back, sizeof(back)));
+    failed |= (0 != memcmp(data, back, sizeof(data)));
+    crc_data_register_reset();
+    for(i = 0U; i < FMC_WRITER_PAGE_WORDS; i++){
+        CRC_DATA = REG32(area + (i << 2));
+    }
+    failed |= (CRC_DATA != fmc_page_last.crc);
+
+    /* pages 0 and 1 fill the shadows, page 0 is written again and page 3 evicts page 1 */
+    fmc_page_done = 0U;
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area, data, 4U));
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area + 0x400U, data, 4U));
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area, data, 4U));
+    failed |= (0U != fmc_page_done);
+    failed |= (FMC_WRITER_OK != fmc_writer_write(&fmc_writer, area + 0xC00U, data, 4U));
+    failed |= (1U != fmc_page_done) || (area + 0x400U != fmc_page_last.page);
+    failed |= (FMC_WRITER_OK != fmc_writer_flush(&fmc_writer));
+    failed |= (3U != fmc_page_done) || (0U != fmc_writer.errors);
+
+    printf("%-28s %6u words %u erases %s\n", "fmc_writer", (unsigned)fmc_writer.programmed,
+           (unsigned)fmc_writer.erases, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      FMC writer callback of a page flushed
+    \param[in]  writer: writer state
+    \param[in]  page: statistics of the page
+    \param[out] none
+    \retval     none
+*/
+static void fmc_writer_page_done(fmc_writer_struct *writer, const fmc_writer_page_struct *page)
+{
+    (void)writer;
+    fmc_page_last = *page;
+    fmc_page_done++;
+}
+
+/*!
+    \brief      keep 8 keys in 4 pages: updates until the pages are full
+                without any erase, the garbage collection in steps of at most
+                one erase, resets simulated by a new fmc_kv_init() during the
+                collection, after a record cut before its commit marker and
+                after a page header cut before its valid marker
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int fmc_kv_check(void)
+{
+    fmc_kv_parameter_struct init;
+    host_sim_fmc_ops_struct ops, last;
+    fmc_kv_result_enum result;
+    uint8_t value[FMC_KV_CHECK_LEN];
+    uint32_t address, calls, i;
+    int failed = 0;
+
+    for(i = 0U; i < FMC_KV_CHECK_KEYS; i++){
+        kv_len[i] = FMC_KV_CHECK_ABSENT;
+    }
+    init.start = FMC_KV_CHECK_PAGE(0U);
+    init.page_num = 2U;
+    init.index = kv_index;
+    init.key_num = FMC_KV_CHECK_KEYS;
+    failed |= (ERROR != fmc_kv_init(&fmc_kv, &init));
+    init.page_num = 4U;
+    failed |= (SUCCESS != fmc_kv_init(&fmc_kv, &init));
+    failed |= (4U != fmc_kv.erased) || (FMC_KV_NOT_FOUND != fmc_kv_read(&fmc_kv, 0U, value, sizeof(value), &i));
+    failed |= (FMC_KV_PARAM != fmc_kv_write(&fmc_kv, FMC_KV_CHECK_KEYS, value, 1U));
+    failed |= (FMC_KV_PARAM != fmc_kv_write(&fmc_kv, 0U, value, FMC_KV_VALUE_MAX + 1U));
+
+    /* values of 0 to 21 bytes, the same value again programs nothing, a delete */
+    for(i = 0U; i < FMC_KV_CHECK_KEYS; i++){
+        failed |= fmc_kv_check_write(i, 3U * i, 0U);
+    }
+    host_sim_fmc_ops_get(&last);
+    failed |= fmc_kv_check_write(5U, 15U, 0U);
+    host_sim_fmc_ops_get(&ops);
+    failed |= (ops.programs != last.programs) || (1U != fmc_kv.unchanged);
+    failed |= (FMC_KV_OK != fmc_kv_delete(&fmc_kv, 7U)) || (FMC_KV_NOT_FOUND != fmc_kv_delete(&fmc_kv, 7U));
+    kv_len[7] = FMC_KV_CHECK_ABSENT;
+    failed |= fmc_kv_check_verify();
+
+    /* updates fill all pages but the last erased one, and never erase */
+    host_sim_fmc_ops_get(&last);
+    for(calls = 0U; calls < 1000U; calls++){
+        if(0U != fmc_kv_check_write(1U, 8U, calls + 1U)){
+            break;
+        }
+    }
+    host_sim_fmc_ops_get(&ops);
+    failed |= (1000U == calls) || (1U != fmc_kv.erased) || (ops.page_erases != last.page_erases);
+    failed |= fmc_kv_check_verify();
+
+    /* a reset finds the same values */
+    failed |= (SUCCESS != fmc_kv_init(&fmc_kv, &init));
+    failed |= (0U != fmc_kv.torn) || (1U != fmc_kv.erased) || fmc_kv_check_verify();
+
+    /* a reset in the middle of the collection loses nothing */
+    failed |= (FMC_KV_PENDING != fmc_kv_check_step(1U)) || (1U != fmc_kv.copies);
+    failed |= (SUCCESS != fmc_kv_init(&fmc_kv, &init)) || fmc_kv_check_verify();
+    failed |= fmc_kv_check_maintain();
+    failed |= (2U > fmc_kv.erased) || (0U == fmc_kv.erases) || fmc_kv_check_verify();
+
+    /* a record cut before its commit marker leaves the previous value */
+    address = FMC_KV_CHECK_PAGE(fmc_kv.active) + fmc_kv.offset;
+    fmc_kv_check_poke(address, 2U);
+    fmc_kv_check_poke(address + 2U, 4U);
+    fmc_kv_check_poke(address + 4U, 0x1234U);
+    failed |= (SUCCESS != fmc_kv_init(&fmc_kv, &init));
+    failed |= (1U != fmc_kv.torn) || (address + 10U != FMC_KV_CHECK_PAGE(fmc_kv.active) + fmc_kv.offset);
+    failed |= fmc_kv_check_verify();
+    /* a record cut after its key: the next one follows the key */
+    address += 10U;
+    fmc_kv_check_poke(address, 3U);
+    failed |= (SUCCESS != fmc_kv_init(&fmc_kv, &init)) || (2U != fmc_kv.torn) || fmc_kv_check_verify();
+    failed |= fmc_kv_check_write(2U, 6U, 99U);
+    failed |= (SUCCESS != fmc_kv_init(&fmc_kv, &init)) || (2U != fmc_kv.torn) || fmc_kv_check_verify();
+
+    /* a page header cut before its valid marker makes the page erased again */
+    for(i = 0U; i < 4U; i++){
+        if(FMC_KV_PAGE_ERASED == fmc_kv.page_state[i]){
+            break;
+        }
+    }
+    fmc_kv_check_poke(FMC_KV_CHECK_PAGE(i), 0x4B56U);
+    fmc_kv_check_poke(FMC_KV_CHECK_PAGE(i) + 2U, 0x0100U);
+    failed |= (4U == i) || (SUCCESS != fmc_kv_init(&fmc_kv, &init)) || (FMC_KV_PAGE_DIRTY != fmc_kv.page_state[i]);
+    host_sim_fmc_ops_get(&last);
+    failed |= fmc_kv_check_maintain();
+    host_sim_fmc_ops_get(&ops);
+    failed |= (FMC_KV_PAGE_ERASED != fmc_kv.page_state[i]) || (1U > (ops.page_erases - last.page_erases));
+
+    /* the collection keeps up with a stream of updates of all the keys */
+    for(calls = 0U; calls < 400U; calls++){
+        result = fmc_kv_check_step(2U);
+        failed |= (FMC_KV_OK != result) && (FMC_KV_PENDING != result);
+        failed |= fmc_kv_check_write(calls % 7U, (calls * 5U) % FMC_KV_CHECK_LEN, calls);
+    }
+    failed |= (SUCCESS != fmc_kv_init(&fmc_kv, &init)) || fmc_kv_check_verify();
+    failed |= (FMC_KV_OK != fmc_kv_read(&fmc_kv, 6U, value, 4U, &i)) || (kv_len[6] != i);
+
+    printf("%-28s %6u writes %u copies %u erases %s\n", "fmc_kv", (unsigned)kv_writes,
+           (unsigned)kv_copies, (unsigned)kv_erases, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      write the value of a key made of its number and a version,
+                and keep it as the expected value
+    \param[in]  key: key written
+    \param[in]  len: bytes of the value
+    \param[in]  version: changes the bytes of the value
+    \param[out] none
+    \retval     0 if the store took the value
+*/
+static int fmc_kv_check_write(uint32_t key, uint32_t len, uint32_t version)
+{
+    uint8_t value[FMC_KV_CHECK_LEN];
+    uint32_t i;
+
+    for(i = 0U; i < len; i++){
+        value[i] = (uint8_t)((key << 4) + i + (7U * version));
+    }
+    if(FMC_KV_OK != fmc_kv_write(&fmc_kv, key, value, len)){
+        return 1;
+    }
+    memcpy(kv_value[key], value, len);
+    kv_len[key] = len;
+    kv_writes++;
+    return 0;
+}
+
+/*!
+    \brief      compare every key of the store with its expected value
+    \param[in]  none
+    \param[out] none
+    \retval     0 if they all match
+*/
+static int fmc_kv_check_verify(void)
+{
+    uint8_t value[FMC_KV_CHECK_LEN];
+    uint32_t key, len;
+
+    for(key = 0U; key < FMC_KV_CHECK_KEYS; key++){
+        if(FMC_KV_CHECK_ABSENT == kv_len[key]){
+            if(FMC_KV_NOT_FOUND != fmc_kv_read(&fmc_kv, key, value, sizeof(value), &len)){
+                return 1;
+            }
+        }else if((FMC_KV_OK != fmc_kv_read(&fmc_kv, key, value, sizeof(value), &len)) || (kv_len[key] != len)
+                 || (0 != memcmp(kv_value[key], value, len))){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*!
+    \brief      run the garbage collection until it has nothing left to do
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the collection ended well
+*/
+static int fmc_kv_check_maintain(void)
+{
+    fmc_kv_result_enum result = FMC_KV_PENDING;
+    uint32_t calls;
+
+    for(calls = 0U; (FMC_KV_PENDING == result) && (calls < 100U); calls++){
+        result = fmc_kv_check_step(2U);
+    }
+    return (FMC_KV_OK != result) ? 1 : 0;
+}
+
+/*!
+    \brief      do one step of the garbage collection and count its copies
+                and erases; a step erasing more than one page fails
+    \param[in]  budget: most records copied
+    \param[out] none
+    \retval     result of fmc_kv_maintain(), FMC_KV_PARAM for a step with two erases
+*/
+static fmc_kv_result_enum fmc_kv_check_step(uint32_t budget)
+{
+    host_sim_fmc_ops_struct ops, last;
+    fmc_kv_result_enum result;
+    uint32_t copies = fmc_kv.copies;
+
+    host_sim_fmc_ops_get(&last);
+    result = fmc_kv_maintain(&fmc_kv, budget);
+    host_sim_fmc_ops_get(&ops);
+    kv_copies += fmc_kv.copies - copies;
+    kv_erases += ops.page_erases - last.page_erases;
+    if(1U < (ops.page_erases - last.page_erases)){
+        return FMC_KV_PARAM;
+    }
+    return result;
+}
+
+/*!
+    \brief      set a half word of the flash behind the FMC, as a program cut
+                by a reset leaves it
+    \param[in]  address: half word address
+    \param[in]  value: contents
+    \param[out] none
+    \retval     none
+*/
+static void fmc_kv_check_poke(uint32_t address, uint16_t value)
+{
+    uint32_t word = host_sim_reg_peek(address & ~0x3U);
+    uint32_t shift = (address & 0x2U) << 3;
+
+    host_sim_reg_poke(address & ~0x3U, (word & ~((uint32_t)0xFFFFU << shift)) | ((uint32_t)value << shift));
+}
+
+/*!
+    \brief      stream records into a log of 4 pages: appends that never wait
+                for the FMC while the pages wrap and are erased from the
+                interrupt, a burst that overflows the RAM ring, the records
+                read back in order, and resets after a record cut before its
+                CRC, a page erase cut in the middle and a first record cut
+                after its sequence number
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the check passed
+*/
+static int fmc_log_check(void)
+{
+    fmc_log_parameter_struct init;
+    fmc_log_cursor_struct cursor;
+    fmc_log_record_struct record;
+    uint8_t data[FMC_LOG_CHECK_LEN], back[FMC_LOG_CHECK_LEN];
+    uint64_t start;
+    uint32_t stall = 0U;
+    uint32_t i, len, seq, count, address, page, erases;
+    int failed = 0;
+
+    rcu_periph_clock_enable(RCU_CRC);
+    host_sim_irq_handler_register(FMC_IRQn, fmc_log_irq);
+    init.start = FMC_LOG_CHECK_PAGE(0U);
+    init.page_num = 4U;
+    init.buffer = log_ring;
+    init.size = 48U;
+    failed |= (ERROR != fmc_log_init(&fmc_log, &init));
+    init.size = sizeof(log_ring) / sizeof(log_ring[0]);
+    failed |= (SUCCESS != fmc_log_init(&fmc_log, &init));
+    failed |= (0U != fmc_log.page) || (0U != fmc_log.offset) || (0U != fmc_log.erase);
+    failed |= (FMC_LOG_PARAM != fmc_log_append(&fmc_log, data, FMC_LOG_DATA_MAX + 1U));
+
+    /* 300 records of 1 to 48 bytes every 150 ticks wrap the pages twice; no append waits */
+    for(i = 0U; i < 300U; i++){
+        len = fmc_log_check_fill(data, i);
+        start = get_cycle_value();
+        failed |= (FMC_LOG_OK != fmc_log_append(&fmc_log, data, len));
+        if((uint32_t)(get_cycle_value() - start) > stall){
+            stall = (uint32_t)(get_cycle_value() - start);
+        }
+        host_sim_run(150U);
+    }
+    failed |= fmc_log_check_drain();
+    failed |= (300U != fmc_log.written) || (0U != fmc_log.dropped) || (0U != fmc_log.errors);
+    failed |= (4U > fmc_log.erases) || (stall >= (HOST_SIM_FMC_ERASE_TICKS / 4U));
+    erases = fmc_log.erases;
+
+    /* the records read back are the newest ones, in order and whole */
+    fmc_log_read_start(&fmc_log, &cursor);
+    count = 0U;
+    seq = 0U;
+    while(FMC_LOG_OK == fmc_log_read(&fmc_log, &cursor, &record, back, sizeof(back))){
+        len = fmc_log_check_fill(data, record.seq);
+        failed |= (0U != count) && (seq + 1U != record.seq);
+        failed |= (len != record.len) || (0 != memcmp(data, back, len));
+        seq = record.seq;
+        count++;
+    }
+    failed |= (299U != seq) || (40U > count);
+
+    /* a burst without the interrupt overflows the RAM ring */
+    for(i = 0U; i < 20U; i++){
+        fmc_log_append(&fmc_log, data, FMC_LOG_CHECK_LEN);
+    }
+    failed |= (0U == fmc_log.dropped) || (fmc_log_pending(&fmc_log) > (sizeof(log_ring) / sizeof(log_ring[0])));
+    failed |= fmc_log_check_drain();
+    failed |= (fmc_log.written != fmc_log.appended) || ((300U + 20U) != (fmc_log.appended + fmc_log.dropped));
+    seq = fmc_log.seq;
+
+    /* a reset finds the head and continues the sequence */
+    fmc_log_deinit(&fmc_log);
+    failed |= (0U == (FMC_CTL0 & FMC_CTL0_LK));
+    address = FMC_LOG_CHECK_PAGE(fmc_log.page) + fmc_log.offset;
+    failed |= (SUCCESS != fmc_log_init(&fmc_log, &init));
+    failed |= (seq != fmc_log.seq) || (address != FMC_LOG_CHECK_PAGE(fmc_log.page) + fmc_log.offset) || (0U != fmc_log.torn);
+
+    /* a record cut before its CRC is skipped, the next one follows it */
+    fmc_log_deinit(&fmc_log);
+    host_sim_reg_poke(address, seq);
+    host_sim_reg_poke(address + 4U, 0U);
+    host_sim_reg_poke(address + 8U, 8U | (~8U << 16));
+    host_sim_reg_poke(address + 12U, 0x12345678U);
+    failed |= (SUCCESS != fmc_log_init(&fmc_log, &init)) || (1U != fmc_log.torn) || (seq + 1U != fmc_log.seq);
+    failed |= (address + 24U != FMC_LOG_CHECK_PAGE(fmc_log.page) + fmc_log.offset);
+    len = fmc_log_check_fill(data, seq + 1U);
+    failed |= (FMC_LOG_OK != fmc_log_append(&fmc_log, data, len)) || fmc_log_check_drain();
+    fmc_log_read_start(&fmc_log, &cursor);
+    while(FMC_LOG_OK == fmc_log_read(&fmc_log, &cursor, &record, back, sizeof(back))){
+    }
+    failed |= (FMC_LOG_OK != fmc_log_read(&fmc_log, &cursor, &record, back, sizeof(back))) || (seq + 1U != record.seq);
+    failed |= (FMC_LOG_END != fmc_log_read(&fmc_log, &cursor, &record, back, sizeof(back)));
+
+    /* the erase of the next page cut in the middle, and a first record cut after its sequence number */
+    fmc_log_deinit(&fmc_log);
+    page = (fmc_log.page + 1U) % 4U;
+    host_sim_reg_poke(FMC_LOG_CHECK_PAGE(page) + 0x200U, 0U);
+    host_sim_reg_poke(FMC_LOG_CHECK_PAGE(page), 0x7FFFFFFFU);
+    failed |= (SUCCESS != fmc_log_init(&fmc_log, &init)) || (page == fmc_log.page) || (1U != fmc_log.erase);
+    failed |= fmc_log_check_drain();
+    failed |= (0U != fmc_log.erase) || (1U != fmc_log.erases) || (0xFFFFFFFFU != REG32(FMC_LOG_CHECK_PAGE(page)));
+    fmc_log_deinit(&fmc_log);
+
+    printf("%-28s %6u records %u erases %u stall %s\n", "fmc_log", (unsigned)count, (unsigned)erases,
+           (unsigned)stall, (0 != failed) ? "failed" : "ok");
+
+    return (0 != failed) ? 1 : 0;
+}
+
+/*!
+    \brief      fill the data of a record from its sequence number
+    \param[in]  seq: sequence number of the record
+    \param[out] data: FMC_LOG_CHECK_LEN bytes
+    \retval     length of the record, 1 to FMC_LOG_CHECK_LEN bytes
+*/
+static uint32_t fmc_log_check_fill(uint8_t *data, uint32_t seq)
+{
+    uint32_t len = 1U + ((seq * 7U) % FMC_LOG_CHECK_LEN);
+    uint32_t i;
+
+    for(i = 0U; i < len; i++){
+        data[i] = (uint8_t)((seq * 13U) + i);
+    }
+    return len;
+}
+
+/*!
+    \brief      let the simulator run until the RAM ring is programmed and the
+                next page erased
+    \param[in]  none
+    \param[out] none
+    \retval     0 if the log became idle
+*/
+static int fmc_log_check_drain(void)
+{
+    uint32_t i;
+
+    for(i = 0U; i < 10000U; i++){
+        if((0U == fmc_log_pending(&fmc_log)) && (0U == fmc_log.busy) && (0U == fmc_log.erase)){
+            return 0;
+        }
+        host_sim_run(64U);
+    }
+    return 1;
+}
+
+/*!
+    \brief      FMC interrupt handler of the log
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void fmc_log_irq(void)
+{
+    fmc_log_irq_handler(&fmc_log);
+}
+
+/*!
+    \brief      transmit interrupt handler of the gateway on CAN0
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void gateway0_tx_irq(void)
+{
+    can_gateway_tx_irq_handler(&can_gateway, CAN0);
+}
+
+/*!
+    \brief      FIFO0 interrupt handler of the gateway on CAN0
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void gateway0_rx0_irq(void)
+{
+    can_gateway_rx_irq_handler(&can_gateway, CAN0, CAN_FIFO0);
+}
+
+/*!
+    \brief      FIFO1 interrupt handler of the gateway on CAN0
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void gateway0_rx1_irq(void)
+{
+    can_gateway_rx_irq_handler(&can_gateway, CAN0, CAN_FIFO1);
+}
+
+/*!
+    \brief      transmit interrupt handler of the gateway on CAN1
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void gateway1_tx_irq(void)
+{
+    can_gateway_tx_irq_handler(&can_gateway, CAN1);
+}
+
+/*!
+    \brief      FIFO0 interrupt handler of the gateway on CAN1
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void gateway1_rx0_irq(void)
+{
+    can_gateway_rx_irq_handler(&can_gateway, CAN1, CAN_FIFO0);
+}
+
+/*!
+    \brief      transmit interrupt handler of the CAN queues
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void can_tx_irq(void)
+{
+    can_queue_tx_irq_handler(&can_queue);
+}
+
+/*!
+    \brief      FIFO0 interrupt handler of the CAN queues
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void can_rx0_irq(void)
+{
+    can_queue_rx_irq_handler(&can_queue, CAN_FIFO0);
+}
+
+/*!
+    \brief      FIFO1 interrupt handler of the CAN queues
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void can_rx1_irq(void)
+{
+    can_queue_rx_irq_handler(&can_queue, CAN_FIFO1);
+}
+
+/*!
+    \brief      print the register accesses of a check
+    \param[in]  name: name of the check
+    \param[out] none
+    \retval     none
+*/
+static void access_report(const char *name)
+{
+    host_sim_access_struct access;
+
+    host_sim_access_get(&access);
+    printf("%-28s %6llu reads %6llu writes\n", name,
+           (unsigned long long)access.read, (unsigned long long)access.write);
+}